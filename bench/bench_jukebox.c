@@ -0,0 +1,343 @@
+/**
+ * @file bench_jukebox.c
+ * @brief Microbenchmarks of the hot paths of the jukebox.
+ *
+ * Cases:
+ * - `fsm_fire_<fsm>`: one iteration of each FSM of the main loop while it waits (the usual case). The jukebox FSM
+ *   is fired while the buzzer plays, because with no activity at all it would put the CPU to sleep.
+ * - `parse_message`: `_parse_message()` of a command with parameter.
+ * - `command_<command>`: `_parse_message()` and `_execute_command()` of a command, LCD and USART output included.
+ * - `buzzer_set_note_frequency`: PSC/ARR computation and PWM setup of a note.
+ * - `usart_store_data` and `usart_write_data`: cost per received and per transmitted byte.
+ * - `lcd_print_str`: cost per character printed on the LCD.
+ * - `melody_pack_get_note`: decoding of a note of a compressed melody, in order, as the buzzer plays it.
+ * - `note_pwm_find` and `note_pwm_solve`: PSC/ARR of a note of melodies.h from the table, and of a frequency out of the
+ *   table solved as it comes.
+ * - `buzzer_envelope_tick`: a tick of the envelope of a note, the body of the TIM5 interrupt, every `ENVELOPE_RATE_HZ`.
+ * - `buzzer_control_tick_fx`: the same tick for a note with vibrato, slide and arpeggio, which also writes ARR.
+ * - `note_fx_tick`: the auto-reload of those effects alone, without the envelope and the registers.
+ * - `game_match`: the closest name to a guess of the game with a typo, among `BENCH_GAME_NAMES` names.
+ * - `playlist_random` and `playlist_advance_shuffle`: a random number below a bound that is not a power of 2, and the
+ *   next song of the shuffle of `BENCH_PLAYLIST_SONGS` songs, across the ends of its rounds.
+ * - `command_guess`: a wrong guess during a round of the game, as the command of the jukebox: the match among its
+ *   melodies, the score and the reply. It runs last, as it leaves the round on.
+ *
+ * The report is printed as JSON when every case has run (see bench.h).
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stdio.h>
+#include <string.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+#include "port_button.h"
+#include "port_usart.h"
+#include "port_buzzer.h"
+#include "port_lcd.h"
+
+/* Other libraries */
+#include "fsm_button.h"
+#include "fsm_usart.h"
+#include "fsm_buzzer.h"
+#include "fsm_jukebox.h"
+#include "fsm_log.h"
+#include "melody_registry.h"
+#include "melody_pack.h"
+#include "note_pwm.h"
+#include "note_fx.h"
+#include "envelope.h"
+#include "game.h"
+#include "playlist.h"
+#include "bench.h"
+
+/* Private defines ------------------------------------------------------------*/
+#define BENCH_ON_OFF_PRESS_TIME_MS 1000     /*!< Same value as ON_OFF_PRESS_TIME_MS in main.c */
+#define BENCH_NEXT_SONG_BUTTON_TIME_MS 500  /*!< Same value as NEXT_SONG_BUTTON_TIME_MS in main.c */
+#define BENCH_TX_BYTES 64                   /*!< Bytes transmitted by each sample of `usart_write_data` */
+#define BENCH_LCD_TEXT "0123456789ABCDEF"   /*!< A full row of the LCD */
+#define BENCH_PACK_MELODY_IDX 4             /*!< Longest built-in melody, packed for `melody_pack_get_note` */
+#define BENCH_PACK_BYTES 8192               /*!< Buffer of its container */
+#define BENCH_SLIDE_MS 60000                /*!< Slide of `buzzer_control_tick_fx`, longer than its samples */
+#define BENCH_FX_COUNT 1000.0               /*!< Period of the note of `note_fx_tick`, in counts of the timer */
+#define BENCH_GAME_NAMES 256                /*!< Names of `game_match`, far more than the jukebox holds */
+#define BENCH_GAME_NAME_LENGTH 24           /*!< Buffer of each of those names */
+#define BENCH_GAME_GUESS "megalovnia_7"     /*!< Guess of `game_match`, one edit away from a name */
+#define BENCH_PLAYLIST_SONGS 8              /*!< Songs of the shuffled playlist */
+#define BENCH_PLAYLIST_BOUND 7              /*!< Bound of `playlist_random`, not a power of 2 */
+#define BENCH_PLAYLIST_SEED 12345           /*!< Seed of its generator */
+#define BENCH_GAME_WRONG "zzzzzzzzzzzz"     /*!< Guess of `command_guess`, far from every name: the round goes on */
+
+/* Private functions of fsm_jukebox.c with external linkage, benchmarked directly */
+bool _parse_message(char *p_message, char *p_command, char *p_param);
+void _execute_command(fsm_jukebox_t *p_fsm_jukebox, char *p_command, char *p_param);
+
+/* Global variables ------------------------------------------------------------*/
+static fsm_t *p_fsm_button;     /*!< Button FSM */
+static fsm_t *p_fsm_usart;      /*!< USART FSM */
+static fsm_t *p_fsm_buzzer;     /*!< Buzzer FSM */
+static fsm_t *p_fsm_jukebox;    /*!< Jukebox FSM */
+static fsm_t *p_fsm_log;        /*!< Log FSM */
+static uint8_t pack_container[BENCH_PACK_BYTES];   /*!< Container of the packed melody */
+static melody_pack_t pack;      /*!< Decoder of the packed melody */
+static note_fx_state_t fx_state;    /*!< Effects of `note_fx_tick` */
+static playlist_t playlist;     /*!< Playlist of `playlist_random` and `playlist_advance_shuffle` */
+static uint32_t playlist_song = PLAYLIST_NONE;  /*!< Song of the shuffle */
+static char game_names[BENCH_GAME_NAMES][BENCH_GAME_NAME_LENGTH];  /*!< Names of `game_match` */
+static const char *p_game_names[BENCH_GAME_NAMES];  /*!< Pointers to those names */
+
+/* Notes of the octave 4, from C4 to C5 */
+static const double notes_hz[] = {261.63, 293.66, 329.63, 349.23, 392.00, 440.00, 493.88, 523.25};
+
+/* Private functions -----------------------------------------------------------*/
+/// @brief Parse and execute a command as `do_read_command()` does
+/// @param p_text Command
+static void _command(const char *p_text)
+{
+    char message[USART_INPUT_BUFFER_LENGTH];
+    char command[USART_INPUT_BUFFER_LENGTH];
+    char param[USART_INPUT_BUFFER_LENGTH];
+    /* Commands longer than the input buffer never reach the parser */
+    strncpy(message, p_text, USART_INPUT_BUFFER_LENGTH - 1);
+    message[USART_INPUT_BUFFER_LENGTH - 1] = '\0';
+    if (_parse_message(message, command, param))
+    {
+        _execute_command((fsm_jukebox_t *)p_fsm_jukebox, command, param);
+    }
+}
+
+static void _fire_button(uint32_t i) { fsm_fire(p_fsm_button); }
+static void _fire_usart(uint32_t i) { fsm_fire(p_fsm_usart); }
+static void _fire_buzzer(uint32_t i) { fsm_fire(p_fsm_buzzer); }
+static void _fire_jukebox(uint32_t i) { fsm_fire(p_fsm_jukebox); }
+
+/* With no activity the jukebox goes to sleep until an interrupt: keep it awake, as while a melody plays */
+static void _setup_jukebox(void)
+{
+    fsm_buzzer_set_action(p_fsm_buzzer, PLAY);
+}
+
+static void _parse(uint32_t i)
+{
+    char message[USART_INPUT_BUFFER_LENGTH] = "select 3";
+    char command[USART_INPUT_BUFFER_LENGTH];
+    char param[USART_INPUT_BUFFER_LENGTH];
+    _parse_message(message, command, param);
+}
+
+static void _command_play(uint32_t i) { _command("play"); }
+static void _command_next(uint32_t i) { _command("next"); }
+static void _command_select(uint32_t i) { _command("select 3"); }
+static void _command_volume(uint32_t i) { _command("volume .5"); }
+static void _command_info(uint32_t i) { _command("info"); }
+static void _command_unknown(uint32_t i) { _command("dance"); }
+
+static void _set_note(uint32_t i)
+{
+    port_buzzer_set_note_frequency(BUZZER_0_ID, notes_hz[i % (sizeof(notes_hz) / sizeof(notes_hz[0]))], 0.5);
+}
+
+static void _setup_store(void)
+{
+    port_usart_reset_input_buffer(USART_0_ID);
+}
+
+static void _store(uint32_t i)
+{
+    port_usart_store_data(USART_0_ID);
+}
+
+static void _setup_write(void)
+{
+    char data[USART_OUTPUT_BUFFER_LENGTH];
+    memset(data, EMPTY_BUFFER_CONSTANT, sizeof(data));
+    memset(data, 'x', BENCH_TX_BYTES);
+    data[BENCH_TX_BYTES] = END_CHAR_CONSTANT;
+    port_usart_copy_to_output_buffer(USART_0_ID, data, sizeof(data));
+}
+
+static void _write(uint32_t i)
+{
+    port_usart_write_data(USART_0_ID);
+}
+
+static void _setup_lcd(void)
+{
+    port_lcd_set_cursor(0, 0);
+}
+
+static void _print(uint32_t i)
+{
+    port_lcd_print_str(BENCH_LCD_TEXT);
+}
+
+static void _setup_pack(void)
+{
+    const melody_t *p_melody = melody_registry_get(BENCH_PACK_MELODY_IDX);
+    size_t size = melody_pack_encode(&p_melody, 1, pack_container, sizeof(pack_container));
+    melody_pack_open(&pack, pack_container, size, 0);
+}
+
+/* The notes are decoded in order across the samples: the stream restarts once per melody, as the buzzer does */
+static void _get_packed_note(uint32_t i)
+{
+    static uint32_t note_index;
+    double frequency;
+    uint32_t duration;
+    melody_pack_get_note(&pack, note_index, &frequency, &duration);
+    note_index = (note_index + 1) % pack.melody.melody_length;
+}
+
+static void _find_pwm(uint32_t i)
+{
+    uint32_t psc;
+    uint32_t arr;
+    note_pwm_find(SystemCoreClock, note_pwm_table[i % NOTE_PWM_TABLE_LENGTH].frequency, &psc, &arr);
+}
+
+static void _solve_pwm(uint32_t i)
+{
+    uint32_t psc;
+    uint32_t arr;
+    note_pwm_solve(SystemCoreClock, notes_hz[i % (sizeof(notes_hz) / sizeof(notes_hz[0]))], &psc, &arr);
+}
+
+static void _setup_envelope(void)
+{
+    port_buzzer_set_note_frequency(BUZZER_0_ID, notes_hz[0], 1.0);
+}
+
+/* The note has no duration: its attack and decay run in the first samples, then it is held */
+static void _control_tick(uint32_t i)
+{
+    port_buzzer_control_tick(BUZZER_0_ID);
+}
+
+static void _setup_effects(void)
+{
+    static const note_fx_t fx = {.flags = NOTE_FX_VIBRATO | NOTE_FX_SLIDE | NOTE_FX_ARPEGGIO,
+                                 .vibrato_cents = 30, .vibrato_rate = 55, .arpeggio = {4, 7}};
+    port_buzzer_set_note_frequency(BUZZER_0_ID, notes_hz[0], 1.0);
+    port_buzzer_set_note_effects(BUZZER_0_ID, &fx, notes_hz[0] * 2, BENCH_SLIDE_MS);
+}
+
+static void _setup_note_fx(void)
+{
+    static const note_fx_t fx = {.flags = NOTE_FX_VIBRATO | NOTE_FX_SLIDE | NOTE_FX_ARPEGGIO,
+                                 .vibrato_cents = 30, .vibrato_rate = 55, .arpeggio = {4, 7}};
+    note_fx_start(&fx_state, &fx, ENVELOPE_RATE_HZ, 0.5, BENCH_SLIDE_MS);
+    note_fx_set_count(&fx_state, BENCH_FX_COUNT);
+}
+
+static void _tick_note_fx(uint32_t i)
+{
+    note_fx_tick(&fx_state);
+}
+
+/* The built-in names with a number: many names share their first characters, as in a large library */
+static void _setup_game(void)
+{
+    for (uint32_t idx = 0; idx < BENCH_GAME_NAMES; idx++)
+    {
+        snprintf(game_names[idx], BENCH_GAME_NAME_LENGTH, "%s_%lu", melody_registry_get(idx % MELODIES_LENGTH)->p_name,
+                 (unsigned long)(idx / MELODIES_LENGTH));
+        p_game_names[idx] = game_names[idx];
+    }
+}
+
+static void _match_game(uint32_t i)
+{
+    uint32_t distance;
+    game_match(BENCH_GAME_GUESS, p_game_names, BENCH_GAME_NAMES, &distance);
+}
+
+static void _setup_playlist(void)
+{
+    playlist_init(&playlist, BENCH_PLAYLIST_SONGS, BENCH_PLAYLIST_SEED);
+    playlist_set_shuffle(&playlist, true);
+    playlist_set_repeat(&playlist, PLAYLIST_REPEAT_ALL);
+}
+
+static void _draw_playlist(uint32_t i)
+{
+    playlist_random(&playlist, BENCH_PLAYLIST_BOUND);
+}
+
+static void _advance_playlist(uint32_t i)
+{
+    playlist_song = playlist_advance(&playlist, playlist_song, false);
+}
+
+static void _setup_guess(void)
+{
+    _command("game");
+}
+
+static void _command_guess(uint32_t i) { _command(BENCH_GAME_WRONG); }
+
+/* The FSMs are fired first, while they still wait: the commands leave output pending in the USART FSM */
+static const bench_case_t cases[] = {
+    {"fsm_fire_button", "call", NULL, _fire_button, 1, 100},
+    {"fsm_fire_usart", "call", NULL, _fire_usart, 1, 100},
+    {"fsm_fire_buzzer", "call", NULL, _fire_buzzer, 1, 100},
+    {"fsm_fire_jukebox", "call", _setup_jukebox, _fire_jukebox, 1, 100},
+    {"parse_message", "call", NULL, _parse, 1, 100},
+    {"command_play", "command", NULL, _command_play, 1, 4},
+    {"command_next", "command", NULL, _command_next, 1, 4},
+    {"command_select", "command", NULL, _command_select, 1, 4},
+    {"command_volume", "command", NULL, _command_volume, 1, 4},
+    {"command_info", "command", NULL, _command_info, 1, 4},
+    {"command_unknown", "command", NULL, _command_unknown, 1, 4},
+    {"buzzer_set_note_frequency", "call", NULL, _set_note, 1, 100},
+    {"usart_store_data", "byte", _setup_store, _store, 1, 100},
+    {"usart_write_data", "byte", _setup_write, _write, 1, BENCH_TX_BYTES},
+    {"lcd_print_str", "char", _setup_lcd, _print, sizeof(BENCH_LCD_TEXT) - 1, 2},
+    {"melody_pack_get_note", "note", _setup_pack, _get_packed_note, 1, 100},
+    {"note_pwm_find", "call", NULL, _find_pwm, 1, 100},
+    {"note_pwm_solve", "call", NULL, _solve_pwm, 1, 100},
+    {"buzzer_envelope_tick", "tick", _setup_envelope, _control_tick, 1, 100},
+    {"buzzer_control_tick_fx", "tick", _setup_effects, _control_tick, 1, 100},
+    {"note_fx_tick", "tick", _setup_note_fx, _tick_note_fx, 1, 100},
+    {"game_match", "guess", _setup_game, _match_game, 1, 4},
+    {"playlist_random", "draw", _setup_playlist, _draw_playlist, 1, 100},
+    {"playlist_advance_shuffle", "song", NULL, _advance_playlist, 1, 100},
+    {"command_guess", "guess", _setup_guess, _command_guess, 1, 4},
+};
+
+/**
+ * @brief Benchmark entry point. The JSON report is printed on the standard output.
+ *
+ * @return int
+ */
+int main(void)
+{
+    /* Same initialization as main.c */
+    port_system_init();
+    HAL_Init();
+    bench_init();
+    port_lcd_init(2);
+    port_lcd_clear();
+    port_lcd_no_backlight();
+
+    p_fsm_button = fsm_button_new(BUTTON_0_DEBOUNCE_TIME_MS, BUTTON_0_ID);
+    p_fsm_usart = fsm_usart_new(USART_0_ID);
+    p_fsm_buzzer = fsm_buzzer_new(BUZZER_0_ID);
+    p_fsm_log = fsm_log_new();
+    p_fsm_jukebox = fsm_jukebox_new(p_fsm_button, BENCH_ON_OFF_PRESS_TIME_MS, p_fsm_usart, p_fsm_buzzer,
+                                    BENCH_NEXT_SONG_BUTTON_TIME_MS, p_fsm_log);
+
+    bench_run_suite("jukebox", cases, sizeof(cases) / sizeof(cases[0]));
+
+    port_buzzer_stop(BUZZER_0_ID);
+    fsm_destroy(p_fsm_button);
+    fsm_destroy(p_fsm_usart);
+    fsm_destroy(p_fsm_buzzer);
+    fsm_destroy(p_fsm_jukebox);
+    fsm_destroy(p_fsm_log);
+    return 0;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file bench.h
+ * @brief Header for bench.c file.
+ *
+ * Microbenchmark runner. A case is a function that performs a fixed number of operations (a command, a byte, a
+ * character...). The runner times `BENCH_SAMPLES` samples of `batch` calls each with the cycle counter of the
+ * platform, and reports the cost of one operation as JSON, so that the results of two commits can be compared.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define BENCH_SAMPLES 31        /*!< Samples of each case. Odd, so the median is one of them */
+#define BENCH_MAX_CASES 32      /*!< Maximum number of cases of a suite */
+
+/* Typedefs --------------------------------------------------------------------*/
+/// @brief Case of a suite
+typedef struct
+{
+    const char *p_name;             /*!< Name, unique in the suite */
+    const char *p_unit;             /*!< Operation measured: "call", "byte", "char"... */
+    void (*setup)(void);            /*!< Called before each sample. It can be NULL. */
+    void (*run)(uint32_t i);        /*!< Performs `ops` operations. `i` is the index of the call in the sample. */
+    uint32_t ops;                   /*!< Operations performed by each call of `run` */
+    uint32_t batch;                 /*!< Calls of `run` per sample */
+} bench_case_t;
+
+/// @brief Cost of one operation of a case, in ticks of the cycle counter
+typedef struct
+{
+    const bench_case_t *p_case; /*!< Case */
+    double min;                 /*!< Fastest sample */
+    double median;              /*!< Median sample */
+    double mean;                /*!< Mean of the samples */
+    double max;                 /*!< Slowest sample */
+} bench_result_t;
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Start the cycle counter and measure the cost of reading it
+void bench_init(void);
+
+/// @brief Run a case
+/// @param p_case Pointer to the case
+/// @param p_result Pointer to the result
+void bench_run(const bench_case_t *p_case, bench_result_t *p_result);
+
+/// @brief Run every case of a suite and print the results as JSON on the standard output
+/// @param p_suite Name of the suite
+/// @param p_cases Array of cases
+/// @param num_cases Number of cases
+void bench_run_suite(const char *p_suite, const bench_case_t *p_cases, uint32_t num_cases);
+
+#endif /* BENCH_H_ */
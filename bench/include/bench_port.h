@@ -0,0 +1,42 @@
+/**
+ * @file bench_port.h
+ * @brief Header for the platform-specific part of the benchmarks (bench/<platform>/bench_port.c).
+ *
+ * Each platform provides a free-running cycle counter: the DWT cycle counter (CYCCNT) of the Cortex-M4 on the
+ * STM32F4, and the time-stamp counter (`rdtsc`) or `clock_gettime()` on the native platform.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+#ifndef BENCH_PORT_H_
+#define BENCH_PORT_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Start the cycle counter and the peripherals that the benchmarked code needs (e.g., the I2C of the LCD)
+void bench_port_init(void);
+
+/// @brief Read the cycle counter. It wraps around: subtract two readings as `uint32_t`.
+/// @return Current value of the counter
+uint32_t bench_port_get_ticks(void);
+
+/// @brief Get the frequency of the cycle counter
+/// @return Ticks per second
+double bench_port_get_ticks_hz(void);
+
+/// @brief Get the name of the cycle counter, for the report
+/// @return Name of the counter
+const char *bench_port_get_clock_name(void);
+
+/// @brief Discard or restore the messages that the benchmarked code prints, so that they do not mix with the report
+/// @param mute true to discard them, false to restore them
+void bench_port_mute(bool mute);
+
+#endif /* BENCH_PORT_H_ */
@@ -0,0 +1,101 @@
+/**
+ * @file bench_port.c
+ * @brief Cycle counter of the benchmarks on the native platform.
+ *
+ * On x86 the time-stamp counter is read with `rdtsc` and its frequency is calibrated against `clock_gettime()`. On
+ * other hosts the counter is `clock_gettime()` itself, in nanoseconds. The ticks are host time: the virtual clock of
+ * the peripheral models says nothing about how long the code takes to run.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* clock_gettime, dup and dup2 are POSIX */
+#define _POSIX_C_SOURCE 200809L
+
+/* Includes ------------------------------------------------------------------*/
+#include <fcntl.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_PORT_RDTSC /*!< The time-stamp counter is available */
+#endif
+
+#include "bench_port.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define BENCH_PORT_CALIBRATION_NS 20000000L /*!< Time used to calibrate the time-stamp counter: 20 ms */
+
+/* Global variables ------------------------------------------------------------*/
+static double ticks_hz = 1e9;   /*!< Frequency of the counter */
+static int stdout_fd = -1;      /*!< Copy of the standard output while it is muted */
+
+/* Private functions -----------------------------------------------------------*/
+/// @brief Read the monotonic clock of the host
+/// @return Nanoseconds
+static int64_t _get_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+/* Public functions -----------------------------------------------------------*/
+void bench_port_init(void)
+{
+#ifdef BENCH_PORT_RDTSC
+    int64_t start_ns = _get_ns();
+    uint64_t start = __rdtsc();
+    while (_get_ns() - start_ns < BENCH_PORT_CALIBRATION_NS)
+    {
+    }
+    ticks_hz = (double)(__rdtsc() - start) * 1e9 / (double)(_get_ns() - start_ns);
+#endif
+}
+
+uint32_t bench_port_get_ticks(void)
+{
+#ifdef BENCH_PORT_RDTSC
+    return (uint32_t)__rdtsc();
+#else
+    return (uint32_t)_get_ns();
+#endif
+}
+
+double bench_port_get_ticks_hz(void)
+{
+    return ticks_hz;
+}
+
+const char *bench_port_get_clock_name(void)
+{
+#ifdef BENCH_PORT_RDTSC
+    return "rdtsc";
+#else
+    return "clock_gettime";
+#endif
+}
+
+void bench_port_mute(bool mute)
+{
+    fflush(stdout);
+    if (mute && stdout_fd < 0)
+    {
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd >= 0)
+        {
+            stdout_fd = dup(STDOUT_FILENO);
+            dup2(null_fd, STDOUT_FILENO);
+            close(null_fd);
+        }
+    }
+    else if (!mute && stdout_fd >= 0)
+    {
+        dup2(stdout_fd, STDOUT_FILENO);
+        close(stdout_fd);
+        stdout_fd = -1;
+    }
+}
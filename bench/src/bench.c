@@ -0,0 +1,134 @@
+/**
+ * @file bench.c
+ * @brief Microbenchmark runner and JSON report.
+ *
+ * The cost of reading the counter is measured once and subtracted from every sample. The report gives the minimum,
+ * the median, the mean and the maximum of the samples: the minimum is the cost without interrupts in the middle, and
+ * the median is the figure to compare between commits.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+
+#include "bench.h"
+#include "bench_port.h"
+
+/* Defines -------------------------------------------------------------------*/
+#ifndef BENCH_PLATFORM
+#define BENCH_PLATFORM "unknown" /*!< Platform of the build, given by CMake */
+#endif
+#ifndef BENCH_REVISION
+#define BENCH_REVISION "unknown" /*!< Git revision of the build, given by CMake */
+#endif
+
+/* Global variables ------------------------------------------------------------*/
+static uint32_t overhead; /*!< Ticks between two consecutive readings of the counter */
+
+/* Private functions -----------------------------------------------------------*/
+/// @brief Sort the samples (insertion sort: there are only BENCH_SAMPLES)
+/// @param p_samples Array of samples
+/// @param length Number of samples
+static void _sort(double *p_samples, uint32_t length)
+{
+    for (uint32_t i = 1; i < length; i++)
+    {
+        double value = p_samples[i];
+        uint32_t j = i;
+        while (j > 0 && p_samples[j - 1] > value)
+        {
+            p_samples[j] = p_samples[j - 1];
+            j--;
+        }
+        p_samples[j] = value;
+    }
+}
+
+/* Public functions -----------------------------------------------------------*/
+void bench_init(void)
+{
+    bench_port_init();
+    overhead = UINT32_MAX;
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++)
+    {
+        uint32_t start = bench_port_get_ticks();
+        uint32_t ticks = bench_port_get_ticks() - start;
+        overhead = (ticks < overhead) ? ticks : overhead;
+    }
+}
+
+void bench_run(const bench_case_t *p_case, bench_result_t *p_result)
+{
+    double samples[BENCH_SAMPLES];
+    double ops = (double)p_case->ops * p_case->batch;
+
+    for (uint32_t s = 0; s < BENCH_SAMPLES; s++)
+    {
+        if (p_case->setup)
+        {
+            p_case->setup();
+        }
+        uint32_t start = bench_port_get_ticks();
+        for (uint32_t i = 0; i < p_case->batch; i++)
+        {
+            p_case->run(i);
+        }
+        uint32_t ticks = bench_port_get_ticks() - start;
+        ticks = (ticks > overhead) ? ticks - overhead : 0;
+        samples[s] = ticks / ops;
+    }
+
+    _sort(samples, BENCH_SAMPLES);
+    double sum = 0;
+    for (uint32_t s = 0; s < BENCH_SAMPLES; s++)
+    {
+        sum += samples[s];
+    }
+    p_result->p_case = p_case;
+    p_result->min = samples[0];
+    p_result->median = samples[BENCH_SAMPLES / 2];
+    p_result->mean = sum / BENCH_SAMPLES;
+    p_result->max = samples[BENCH_SAMPLES - 1];
+}
+
+void bench_run_suite(const char *p_suite, const bench_case_t *p_cases, uint32_t num_cases)
+{
+    static bench_result_t results[BENCH_MAX_CASES];
+    if (num_cases > BENCH_MAX_CASES)
+    {
+        num_cases = BENCH_MAX_CASES;
+    }
+
+    /* Everything is measured first: the report is printed once the benchmarked code has nothing left to say */
+    bench_port_mute(true);
+    for (uint32_t c = 0; c < num_cases; c++)
+    {
+        bench_run(&p_cases[c], &results[c]);
+    }
+    bench_port_mute(false);
+
+    double hz = bench_port_get_ticks_hz();
+    printf("{\n");
+    printf("  \"suite\": \"%s\",\n", p_suite);
+    printf("  \"platform\": \"%s\",\n", BENCH_PLATFORM);
+    printf("  \"revision\": \"%s\",\n", BENCH_REVISION);
+    printf("  \"clock\": {\"name\": \"%s\", \"hz\": %.0f},\n", bench_port_get_clock_name(), hz);
+    printf("  \"samples\": %u,\n", (unsigned)BENCH_SAMPLES);
+    printf("  \"results\": [\n");
+    for (uint32_t c = 0; c < num_cases; c++)
+    {
+        const bench_result_t *p_result = &results[c];
+        printf("    {\"name\": \"%s\", \"unit\": \"%s\", \"ops\": %u, "
+               "\"min\": %.1f, \"median\": %.1f, \"mean\": %.1f, \"max\": %.1f, \"median_ns\": %.1f}%s\n",
+               p_result->p_case->p_name, p_result->p_case->p_unit,
+               (unsigned)(p_result->p_case->ops * p_result->p_case->batch), p_result->min, p_result->median,
+               p_result->mean, p_result->max, hz > 0 ? p_result->median * 1e9 / hz : 0.0,
+               (c + 1 < num_cases) ? "," : "");
+    }
+    printf("  ]\n");
+    printf("}\n");
+    fflush(stdout);
+}
@@ -0,0 +1,65 @@
+/**
+ * @file bench_port.c
+ * @brief Cycle counter of the benchmarks on the STM32F4: the DWT cycle counter (CYCCNT) of the Cortex-M4.
+ *
+ * CYCCNT counts core clock cycles and wraps around every 2^32 cycles (more than 4 minutes at 16 MHz), far longer than
+ * any sample. The LCD driver uses the I2C handle `hi2c1`, which the benchmarks define and initialize as `main.c` does.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "bench_port.h"
+#include "port_system.h"
+
+/* Global variables ------------------------------------------------------------*/
+I2C_HandleTypeDef hi2c1; /*!< I2C of the LCD */
+
+/* Private functions -----------------------------------------------------------*/
+/// @brief Configure the I2C of the LCD, as `MX_I2C1_Init()` in `main.c`
+static void _i2c1_init(void)
+{
+  hi2c1.Instance = I2C1;
+  hi2c1.Init.ClockSpeed = 100000;
+  hi2c1.Init.DutyCycle = I2C_DUTYCYCLE_2;
+  hi2c1.Init.OwnAddress1 = 0;
+  hi2c1.Init.AddressingMode = I2C_ADDRESSINGMODE_7BIT;
+  hi2c1.Init.DualAddressMode = I2C_DUALADDRESS_DISABLE;
+  hi2c1.Init.OwnAddress2 = 0;
+  hi2c1.Init.GeneralCallMode = I2C_GENERALCALL_DISABLE;
+  hi2c1.Init.NoStretchMode = I2C_NOSTRETCH_DISABLE;
+  HAL_I2C_Init(&hi2c1);
+}
+
+/* Public functions -----------------------------------------------------------*/
+void bench_port_init(void)
+{
+  _i2c1_init();
+
+  /* Enable the trace unit and start the cycle counter */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t bench_port_get_ticks(void)
+{
+  return DWT->CYCCNT;
+}
+
+double bench_port_get_ticks_hz(void)
+{
+  return (double)SystemCoreClock;
+}
+
+const char *bench_port_get_clock_name(void)
+{
+  return "DWT_CYCCNT";
+}
+
+void bench_port_mute(bool mute)
+{
+  /* printf goes to the SWO (ITM): the messages come out before the report, which is printed at the end */
+}
@@ -0,0 +1,124 @@
+/**
+ * @file envelope.h
+ * @brief Header for envelope.c file.
+ *
+ * Volume envelope of the notes of the buzzer: attack, decay, sustain and release. The port runs `envelope_tick()` from
+ * a timer interrupt at `ENVELOPE_RATE_HZ` and loads the duty cycle it returns into the compare register of the PWM, so
+ * every note rises from silence and falls back to it before its end, without the click of a step in the duty cycle.
+ *
+ * The level moves in steps of `ENVELOPE_DB_PER_LEVEL` dB, so the volume and the ramps are linear in dB, as the ear
+ * hears them. The fundamental of a square wave with duty cycle `d` has an amplitude proportional to `sin(pi * d)`: it
+ * is loudest at 50 %, and 95 % sounds as quiet as 5 %. `envelope_duty_table` holds, for each level, the duty cycle up
+ * to 50 % whose fundamental has that amplitude.
+ *
+ * The times of the configuration are those of a ramp over the whole range of levels, so a note at a lower volume gets
+ * there sooner. The step of each ramp is worked out when the envelope is configured: a tick adds or subtracts it and
+ * looks up the table, without divisions or loops.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#ifndef ENVELOPE_H_
+#define ENVELOPE_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define ENVELOPE_RATE_HZ 1000U                  /*!< Control rate: ticks per second */
+#define ENVELOPE_LEVELS 96U                     /*!< Levels above silence, the last one is the full volume */
+#define ENVELOPE_DB_PER_LEVEL 0.5               /*!< Step between two levels, in dB */
+#define ENVELOPE_FRACTION_BITS 8U               /*!< Fraction bits of the level, for ramps slower than a level per tick */
+#define ENVELOPE_DUTY_BITS 16U                  /*!< Fraction bits of the duty cycle of the table */
+
+#define ENVELOPE_DEFAULT_ATTACK_MS 5U           /*!< Attack by default */
+#define ENVELOPE_DEFAULT_DECAY_MS 100U          /*!< Decay by default */
+#define ENVELOPE_DEFAULT_SUSTAIN_DB 3U          /*!< Sustain by default */
+#define ENVELOPE_DEFAULT_RELEASE_MS 20U         /*!< Release by default */
+
+/// @brief Stages of the envelope
+enum ENVELOPE_STAGES {
+    ENVELOPE_IDLE = 0,      /*!< Silence, the envelope does not need ticks */
+    ENVELOPE_ATTACK,        /*!< From silence to the volume of the note */
+    ENVELOPE_DECAY,         /*!< From the volume of the note to the sustain */
+    ENVELOPE_SUSTAIN,       /*!< Held until the release */
+    ENVELOPE_RELEASE,       /*!< Down to silence before the end of the note */
+};
+
+/* Typedefs ------------------------------------------------------------------*/
+/// @brief Configuration of the envelope
+typedef struct {
+    uint16_t attack_ms;     /*!< Time of the attack over the whole range, 0 to start at the volume of the note */
+    uint16_t decay_ms;      /*!< Time of the decay over the whole range */
+    uint16_t release_ms;    /*!< Time of the release over the whole range, 0 to stop at the volume of the note */
+    uint8_t sustain_db;     /*!< Sustain below the volume of the note, in dB */
+} envelope_config_t;
+
+/// @brief State of the envelope of a buzzer
+typedef struct {
+    uint8_t stage;          /*!< Stage, one of `ENVELOPE_STAGES` */
+    uint16_t level;         /*!< Current level, with `ENVELOPE_FRACTION_BITS` fraction bits */
+    uint16_t peak;          /*!< Level of the note */
+    uint16_t sustain;       /*!< Level of the sustain */
+    uint16_t attenuation;   /*!< Sustain below the level of the note */
+    uint16_t attack_step;   /*!< Level added by each tick of the attack */
+    uint16_t decay_step;    /*!< Level subtracted by each tick of the decay */
+    uint16_t release_step;  /*!< Level subtracted by each tick of the release, 0 for none */
+    uint32_t gate;          /*!< Ticks left until the release, `UINT32_MAX` while the duration is unknown */
+} envelope_t;
+
+/* Global variables ------------------------------------------------------------*/
+/// @brief Duty cycle of each level, with `ENVELOPE_DUTY_BITS` fraction bits: 0 for silence, 50 % for the full volume
+extern const uint16_t envelope_duty_table[ENVELOPE_LEVELS + 1];
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Initialize an envelope in silence.
+/// @param p_envelope Pointer to the envelope
+/// @param p_config Configuration
+void envelope_init(envelope_t *p_envelope, const envelope_config_t *p_config);
+
+/// @brief Change the configuration of an envelope, from its next note.
+/// @param p_envelope Pointer to the envelope
+/// @param p_config Configuration
+void envelope_set_config(envelope_t *p_envelope, const envelope_config_t *p_config);
+
+/// @brief Get the level of a volume, evenly spaced in dB.
+/// @param volume Volume, from 0 (silence) to 1 (full volume). Other values are saturated.
+/// @return Level, from 0 to `ENVELOPE_LEVELS`
+uint32_t envelope_get_level(double volume);
+
+/// @brief Start the attack of a note. It holds until `envelope_set_gate()` or `envelope_note_off()`.
+/// @param p_envelope Pointer to the envelope
+/// @param level Level of the note, from 0 to `ENVELOPE_LEVELS`
+/// @return Duty cycle to start the note with, with `ENVELOPE_DUTY_BITS` fraction bits
+uint32_t envelope_note_on(envelope_t *p_envelope, uint32_t level);
+
+/// @brief Set the duration of the note: the release starts early enough to reach silence a tick before its end.
+/// @param p_envelope Pointer to the envelope
+/// @param duration_ms Duration of the note from its `envelope_note_on()`
+void envelope_set_gate(envelope_t *p_envelope, uint32_t duration_ms);
+
+/// @brief Start the release now.
+/// @param p_envelope Pointer to the envelope
+void envelope_note_off(envelope_t *p_envelope);
+
+/// @brief Silence the envelope at once.
+/// @param p_envelope Pointer to the envelope
+void envelope_stop(envelope_t *p_envelope);
+
+/// @brief Advance the envelope one tick of `ENVELOPE_RATE_HZ`. It costs the same in every stage: no divisions or loops.
+/// @param p_envelope Pointer to the envelope
+/// @return Duty cycle, with `ENVELOPE_DUTY_BITS` fraction bits
+uint32_t envelope_tick(envelope_t *p_envelope);
+
+/// @brief Check if the envelope needs ticks.
+/// @param p_envelope Pointer to the envelope
+/// @return true until the release reaches silence
+bool envelope_is_active(const envelope_t *p_envelope);
+
+#endif /* ENVELOPE_H_ */
@@ -0,0 +1,152 @@
+/**
+ * @file frame.h
+ * @brief Header for frame.c file.
+ *
+ * Binary command protocol of the USART, alongside the text commands. A frame is
+ *
+ * | opcode | seq | payload (0 to `FRAME_MAX_PAYLOAD` bytes) | CRC-16 (little endian) |
+ *
+ * encoded with COBS (Consistent Overhead Byte Stuffing), so that it contains no zero byte, and followed by the
+ * delimiter `FRAME_DELIMITER` (0x00). The CRC is CRC-16/CCITT-FALSE over the opcode, the sequence number and the
+ * payload. A text session becomes binary when the jukebox receives `FRAME_MAGIC` as the first byte of a message; it
+ * returns to text with `FRAME_OP_TEXT` or when the jukebox is turned off.
+ *
+ * Every request but `FRAME_OP_TEXT` is answered with the opcode ORed with `FRAME_REPLY`, the same sequence number and
+ * a status byte, followed by the data of the reply. Numbers are integers: volume and speed in percent.
+ * While the telemetry is on, the jukebox also pushes `FRAME_OP_RECORD` frames between the replies (see telemetry.h).
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#ifndef FRAME_H_
+#define FRAME_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define FRAME_DELIMITER 0x00                                /*!< End of an encoded frame */
+#define FRAME_MAGIC FRAME_DELIMITER                         /*!< First byte of a message that starts a binary session */
+#define FRAME_MAX_PAYLOAD 16                                /*!< Maximum payload of a frame */
+#define FRAME_HEADER_LENGTH 2                               /*!< Opcode and sequence number */
+#define FRAME_CRC_LENGTH 2                                  /*!< CRC-16 */
+#define FRAME_MAX_DECODED (FRAME_HEADER_LENGTH + FRAME_MAX_PAYLOAD + FRAME_CRC_LENGTH) /*!< Longest frame before COBS */
+#define FRAME_MAX_ENCODED (FRAME_MAX_DECODED + 2)           /*!< Longest encoded frame: COBS overhead and delimiter */
+#define FRAME_REPLY 0x80                                    /*!< Flag of the opcode of a reply */
+#define FRAME_UPLOAD_NOTES 3                                /*!< Notes in a `FRAME_OP_UPLOAD_DATA` frame at most */
+
+/* Enums */
+/// @brief Opcodes of the requests
+enum FRAME_OPCODES {
+    FRAME_OP_PLAY = 0x01,   /*!< Play the current melody. No payload. */
+    FRAME_OP_STOP,          /*!< Stop the melody. No payload. */
+    FRAME_OP_PAUSE,         /*!< Pause the melody. No payload. */
+    FRAME_OP_NEXT,          /*!< Play the next melody. Reply: melody index (u8). */
+    FRAME_OP_SELECT,        /*!< Play a melody. Payload: melody index (u8). */
+    FRAME_OP_VOLUME,        /*!< Set the volume. Payload: percent (u8, 0 to 100). */
+    FRAME_OP_SPEED,         /*!< Set the speed. Payload: percent (u16, at least 10). */
+    FRAME_OP_INFO,          /*!< Reply: melody index (u8), volume in percent (u8), action (u8: STOP, PLAY or PAUSE). */
+    FRAME_OP_TEXT,          /*!< End the binary session and the telemetry. No reply. */
+    FRAME_OP_TELEMETRY,     /*!< Send status records. Payload: period in ms (u16), 0 to stop (see telemetry.h). */
+    FRAME_OP_UPLOAD_BEGIN,  /*!< Start an upload (see melody_store.h). Payload: notes (u16), name (up to 14 characters). */
+    FRAME_OP_UPLOAD_DATA,   /*!< Notes of an upload. Payload: first note (u16), then up to `FRAME_UPLOAD_NOTES` notes. */
+    FRAME_OP_UPLOAD_END,    /*!< Commit an upload. Payload: CRC-16 of the notes (u16). Reply: melody index (u8). */
+    FRAME_OP_RECORD = 0x7E, /*!< Status record pushed by the jukebox, numbered by its sequence number. Not a reply. */
+    FRAME_OP_ERROR = 0x7F   /*!< Reply to a frame that cannot be decoded (bad COBS, length or CRC) */
+};
+
+/// @brief Status byte of the replies
+enum FRAME_STATUS {
+    FRAME_STATUS_OK = 0,        /*!< Request executed */
+    FRAME_STATUS_BAD_PARAM,     /*!< Wrong payload */
+    FRAME_STATUS_UNKNOWN,       /*!< Unknown opcode */
+    FRAME_STATUS_BAD_FRAME,     /*!< The frame cannot be decoded */
+    FRAME_STATUS_NO_SPACE,      /*!< The melody store is full */
+    FRAME_STATUS_FAILED         /*!< The request is valid but could not be executed (flash error) */
+};
+
+/* Typedefs ------------------------------------------------------------------*/
+/// @brief Decoded frame
+typedef struct{
+    uint8_t opcode;                     /*!< Opcode of a request, or of a reply ORed with `FRAME_REPLY` */
+    uint8_t seq;                        /*!< Sequence number, copied to the reply */
+    uint8_t length;                     /*!< Bytes of payload */
+    uint8_t payload[FRAME_MAX_PAYLOAD]; /*!< Payload */
+} frame_t;
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Compute the CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF) of a buffer.
+/// @param p_data Pointer to the data
+/// @param length Bytes of data
+/// @return CRC
+uint16_t frame_crc16(const uint8_t *p_data, size_t length);
+
+/// @brief Continue a CRC-16/CCITT-FALSE over more data, to compute it in pieces.
+/// @param crc CRC of the previous data, or 0xFFFF to start
+/// @param p_data Pointer to the data
+/// @param length Bytes of data
+/// @return CRC
+uint16_t frame_crc16_update(uint16_t crc, const uint8_t *p_data, size_t length);
+
+/// @brief Encode a buffer with COBS. The output has no zero byte and is one byte longer (plus one every 254 bytes).
+/// @param p_data Pointer to the data
+/// @param length Bytes of data
+/// @param p_out Pointer to the output, of at least `length + length / 254 + 1` bytes
+/// @return Bytes written
+size_t frame_cobs_encode(const uint8_t *p_data, size_t length, uint8_t *p_out);
+
+/// @brief Decode a COBS buffer, without the delimiter.
+/// @param p_data Pointer to the encoded data
+/// @param length Bytes of encoded data
+/// @param p_out Pointer to the output, of at least `length` bytes
+/// @param size Size of the output
+/// @return Bytes decoded, or 0 if the data is not valid COBS
+size_t frame_cobs_decode(const uint8_t *p_data, size_t length, uint8_t *p_out, size_t size);
+
+/// @brief Encode a frame: header, payload and CRC with COBS, followed by the delimiter.
+/// @param p_frame Pointer to the frame
+/// @param p_out Pointer to the output, of at least `FRAME_MAX_ENCODED` bytes
+/// @return Bytes written, delimiter included
+size_t frame_encode(const frame_t *p_frame, uint8_t *p_out);
+
+/// @brief Decode a frame received without its delimiter, checking its length and its CRC.
+/// @param p_data Pointer to the encoded frame
+/// @param length Bytes of the encoded frame
+/// @param p_frame Pointer to store the frame
+/// @return true if the frame is valid
+bool frame_decode(const uint8_t *p_data, size_t length, frame_t *p_frame);
+
+/// @brief Build the reply to a request, with the status as the first byte of the payload.
+/// @param p_request Pointer to the request
+/// @param status Status (`FRAME_STATUS_OK`...)
+/// @param p_reply Pointer to store the reply. Data can be appended with `frame_put_u8()` and `frame_put_u16()`.
+void frame_reply(const frame_t *p_request, uint8_t status, frame_t *p_reply);
+
+/// @brief Append a byte to the payload of a frame. It is ignored if the payload is full.
+/// @param p_frame Pointer to the frame
+/// @param value Value
+void frame_put_u8(frame_t *p_frame, uint8_t value);
+
+/// @brief Append a 16-bit number (little endian) to the payload of a frame. It is ignored if the payload is full.
+/// @param p_frame Pointer to the frame
+/// @param value Value
+void frame_put_u16(frame_t *p_frame, uint16_t value);
+
+/// @brief Read a 16-bit number (little endian) from the payload of a frame.
+/// @param p_frame Pointer to the frame
+/// @param offset Position in the payload
+/// @return Value, or 0 if the payload is too short
+uint16_t frame_get_u16(const frame_t *p_frame, uint8_t offset);
+
+/// @brief Get the name of an opcode, without the reply flag.
+/// @param opcode Opcode
+/// @return Name (`"play"`, `"select"`...), or `"?"` if the opcode is unknown
+const char *frame_get_opcode_name(uint8_t opcode);
+
+#endif /* FRAME_H_ */
@@ -17,10 +17,18 @@
 /* Other includes */
 #include <fsm.h>
 #include "melodies.h"
+#include "melody_stream.h"
+#include "envelope.h"
 /* HW dependent includes */
 
 
 /* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define FSM_BUZZER_Q16_ONE 65536            /*!< 1 in the Q16 fixed point of the tempo and pitch factors */
+#define FSM_BUZZER_NOMINAL_TEMPO_BPM 120    /*!< Tempo at speed 1, the durations of the melodies as written */
+#define FSM_BUZZER_MAX_TRANSPOSE 24         /*!< Largest shift of the pitch, in semitones up or down */
+#define FSM_BUZZER_SEMITONES_PER_OCTAVE 12  /*!< Semitones of an octave, which doubles the frequency */
+
 /* Enums */
 
 /// @brief FSM States
@@ -45,11 +53,22 @@ enum  	USER_ACTIONS {
 typedef struct{
     fsm_t f;                    /*!< FSM for the buzzer */
     melody_t *p_melody;         /*!< Pointer to the current melody */
+    melody_stream_t *p_stream;  /*!< Stream of the current melody, or NULL if its notes are in memory */
+    const melody_t *p_next_melody; /*!< Melody that follows the current one without a gap, or NULL */
+    bool next_started;          /*!< The next melody has taken over and the owner has not been told yet */
     uint32_t 	note_index;     /*!< Current Note Index */
     uint8_t 	buzzer_id;      /*!< Used buzzer ID */
+    uint8_t 	num_voices;     /*!< Buzzers of the melody, from `buzzer_id` on: the melody and its other tracks */
     uint8_t 	user_action;    /*!< Current User Action */
     double player_speed;        /*!< Reproduction Speed */
+    uint32_t duration_scale;    /*!< Factor of the durations in Q16, the reciprocal of the speed */
+    uint32_t pitch_ratio;       /*!< Factor of the frequencies in Q16, 2^(transpose/12) */
+    int8_t transpose;           /*!< Shift of the pitch, in semitones */
     double player_volume;     /*!< Current volume */
+    bool note_paused;           /*!< A note was paused before its end: the port keeps the time it has left */
+    bool note_watch;            /*!< Timestamp the next note */
+    bool note_watched;          /*!< The watched note has started */
+    uint32_t note_cycles;       /*!< Cycle counter when the watched note started */
 
 } fsm_buzzer_t;
 
@@ -60,13 +79,58 @@ typedef struct{
 /// @param p_melody Pointer to the melody to play 
 void    fsm_buzzer_set_melody (fsm_t *p_this, const melody_t *p_melody);
 
-/// @brief Sets speed at which melody is reproduced
+/// @brief Sets a melody streamed from the external storage to play
+/// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t struct 
+/// @param p_stream Pointer to the opened stream (see `melody_stream_open()`)
+void    fsm_buzzer_set_stream (fsm_t *p_this, melody_stream_t *p_stream);
+
+/// @brief Sets the melody that follows the current one. The first note of the next melody is staged in the port while
+/// the last note of the current one sounds, and it starts at the update event that ends it, without waiting for the
+/// player. The notes of the next melody must be in memory. It is dropped by `fsm_buzzer_set_melody()` and the others.
+/// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t struct 
+/// @param p_melody Pointer to the next melody, NULL for none: the player stops at the end of the current one
+void    fsm_buzzer_set_next_melody (fsm_t *p_this, const melody_t *p_melody);
+
+/// @brief Gets the melody that follows the current one
+/// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t struct 
+/// @return Pointer to the next melody, NULL if there is none
+const melody_t *fsm_buzzer_get_next_melody (fsm_t *p_this);
+
+/// @brief Checks if the next melody set with `fsm_buzzer_set_next_melody()` has taken over
+/// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t struct 
+/// @return True the first time it is called after the next melody started, false if not
+bool    fsm_buzzer_get_next_started (fsm_t *p_this);
+
+/// @brief Sets speed at which melody is reproduced. It applies from the next note.
 /// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t struct 
 /// @param speed Speed to set
 void 	fsm_buzzer_set_speed (fsm_t *p_this, double speed);
 
+/// @brief Sets the tempo, as a speed relative to `FSM_BUZZER_NOMINAL_TEMPO_BPM`. It applies from the next note.
+/// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t struct 
+/// @param bpm Beats per minute
+void    fsm_buzzer_set_tempo (fsm_t *p_this, uint32_t bpm);
+
+/// @brief Shifts the pitch of the melody. It applies from the next note.
+/// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t struct 
+/// @param semitones Semitones up, or down if negative, saturated at `FSM_BUZZER_MAX_TRANSPOSE`
+void    fsm_buzzer_set_transpose (fsm_t *p_this, int32_t semitones);
+
+/// @brief Gets the shift of the pitch
+/// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t struct 
+/// @return Semitones up, or down if negative
+int32_t fsm_buzzer_get_transpose (fsm_t *p_this);
+
+/// @brief Sets the volume of the player. It applies from the next note.
+/// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t struct 
+/// @param volume Volume, from 0 to 1, evenly spaced in dB up to the loudest duty cycle (see envelope.h)
 void fsm_buzzer_set_volume(fsm_t *p_this, double volume);
 
+/// @brief Sets the envelope of the notes. It applies from the next note.
+/// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t struct 
+/// @param p_config Attack, decay, sustain and release
+void fsm_buzzer_set_envelope(fsm_t *p_this, const envelope_config_t *p_config);
+
 /// @brief Sets the action to perform on the player
 /// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t struct 
 /// @param action  Action to set
@@ -77,6 +141,21 @@ void 	fsm_buzzer_set_action (fsm_t *p_this, uint8_t action);
 /// @return 
 uint8_t fsm_buzzer_get_action (fsm_t *p_this);
 
+/// @brief Gets the index of the note being played
+/// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t struct 
+/// @return Index of the note in the melody
+uint32_t fsm_buzzer_get_note_index (fsm_t *p_this);
+
+/// @brief Timestamp the next note the player starts, to measure the response time to a command
+/// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t struct 
+void    fsm_buzzer_watch_note (fsm_t *p_this);
+
+/// @brief Gets when the note watched with `fsm_buzzer_watch_note()` started
+/// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t struct 
+/// @param p_cycles Pointer to store the cycle counter when the note started (see `port_system_get_cycles()`)
+/// @return True if the note has started, false if it has not started yet
+bool    fsm_buzzer_get_watched_note (fsm_t *p_this, uint32_t *p_cycles);
+
 /// @brief Creates a new buzzer finite state machine
 /// @param buzzer_id 
 /// @return 
@@ -19,10 +19,31 @@
 
 #include "melodies.h"
 
+#include "melody_registry.h"
+
+#include "melody_store.h"
+
+#include "melody_stream.h"
+
+#include "latency.h"
+
+#include "macro.h"
+
+#include "telemetry.h"
+
+#include "playlist.h"
+
+#include "game.h"
+
+#include "settings_store.h"
+
 /* Defines and enums ----------------------------------------------------------*/
 /* Defines */
 
-#define MELODIES_MEMORY_SIZE 10
+#define START_UP_MELODY_IDX 0                       /*!< Melody played when the jukebox is turned on */
+#define SHUT_OFF_MELODY_IDX (MELODIES_LENGTH - 1)   /*!< Melody played when the jukebox is turned off */
+#define NUM_MELODIES_MAX (MELODIES_LENGTH + MELODY_STORE_MAX_MELODIES) /*!< Built-in melodies, then the uploaded ones */
+#define LCD_REFRESH_HOLD_MS 50                      /*!< The LCD shows the last change once no other comes for this long */
 
 /* Enums */
 
@@ -36,9 +57,24 @@ enum FSM_JUKEBOX{
     SHUT_OFF
 };
 
-enum GAME_STATE{
-    WAITING = 0,
-    GAMING,
+/// @brief What the LCD shows in its next update
+enum FSM_JUKEBOX_LCD_VIEW{
+    LCD_VIEW_NONE = 0,  /*!< Nothing to update */
+    LCD_VIEW_SONG,      /*!< The current melody */
+    LCD_VIEW_STATE,     /*!< A state of the buzzer or of the game */
+    LCD_VIEW_VOLUME,    /*!< The volume */
+    LCD_VIEW_GAME       /*!< A round of the game has started */
+};
+
+/// @brief Keys of the settings kept across resets (see settings_store.h)
+enum FSM_JUKEBOX_SETTING{
+    SETTING_VOLUME = 0,     /*!< Volume, in percent */
+    SETTING_SPEED,          /*!< Speed, in hundredths */
+    SETTING_MELODY,         /*!< Index of the current melody */
+    SETTING_SCORE,          /*!< Points of the game */
+    SETTING_BEST_STREAK,    /*!< Longest streak of the game */
+    SETTING_ROUNDS,         /*!< Rounds of the game played */
+    SETTING_WINS            /*!< Rounds of the game won */
 };
 
 
@@ -47,17 +83,30 @@ enum GAME_STATE{
 /// @brief Structure that contains the information of a melody
 typedef struct{
     fsm_t f;    /*!< jukebox fsm struct */
-    melody_t melodies[MELODIES_MEMORY_SIZE];    /*!< Melodies array */
-    uint8_t melody_idx; /*!< Index to current note in melody */
+    uint8_t melody_idx; /*!< Index of the current melody: in the registry (see melody_registry.h), then in the store */
     char *p_melody; /*!< Melody name pointer */
+    uint8_t lcd_pending;    /*!< View that the LCD shows in its next update (see FSM_JUKEBOX_LCD_VIEW). It is drawn after the replies, which its I2C transfers would delay */
+    char *p_lcd_state;      /*!< State shown by `LCD_VIEW_STATE` */
+    uint32_t lcd_changed_ms;    /*!< Time of the last change of the view */
+    bool in_playlist;   /*!< The current melody comes from the playlist, which prepares the one that follows */
     fsm_t *p_fsm_button;    /*!< buttons fsm */
     uint32_t on_off_press_time_ms;  /*!< Time to press to turn off and on in milis */
     fsm_t *p_fsm_usart; /*!< usart's fsm */
     fsm_t *p_fsm_buzzer;    /*!<buzzer's fsm */
+    fsm_t *p_fsm_log;   /*!< log's fsm, for the messages of the console */
     uint32_t next_song_press_time_ms;   /*!< Time to press for next song in milis */
     double speed;   /*!< Reproduction Speed */
     double volume;  /*!< Reproduction Volume */
-    uint8_t game_state; /*!< Guessing game state */
+    game_t game;    /*!< Guess-the-song game: round, score and streak */
+    char game_answer[MELODY_STORE_NAME_LENGTH];   /*!< Name of the melody to guess, copied when the round starts. The round leaves `melody_idx` and `p_melody`, which the telemetry and the settings show, alone */
+    uint32_t guard_cycles;  /*!< Cycle counter when the last command was detected */
+    latency_t latency;  /*!< Response time to the USART commands */
+    macro_table_t macros;   /*!< Macros of commands */
+    telemetry_t telemetry;  /*!< Periodic status records */
+    melody_store_t store;   /*!< Melodies uploaded through the USART */
+    melody_stream_t stream; /*!< Melody played from the external storage */
+    playlist_t playlist;    /*!< Order of the melodies: queue, repeat and shuffle */
+    settings_store_t settings;  /*!< Volume, speed, melody and scores kept in the flash */
 } fsm_jukebox_t;
 
 /* Function prototypes and explanation ---------------------------------------*/
@@ -68,8 +117,9 @@ typedef struct{
 /// @param p_fsm_usart Pointer to the USART FSM 
 /// @param p_fsm_buzzer Pointer to the buzzer FSM. 
 /// @param next_song_press_time_ms Button press time in milliseconds to change to the next song.
+/// @param p_fsm_log Pointer to the log FSM, for the messages of the console.
 /// @return A pointer to the button FSM 
-fsm_t * fsm_jukebox_new(fsm_t *p_fsm_button, uint32_t on_off_press_time_ms, fsm_t *p_fsm_usart, fsm_t *p_fsm_buzzer, uint32_t next_song_press_time_ms);
+fsm_t * fsm_jukebox_new(fsm_t *p_fsm_button, uint32_t on_off_press_time_ms, fsm_t *p_fsm_usart, fsm_t *p_fsm_buzzer, uint32_t next_song_press_time_ms, fsm_t *p_fsm_log);
 
 /// @brief Initialize a jukebox FSM. 
 /// @param p_this Pointer to the jukebox FSM 
@@ -78,6 +128,7 @@ fsm_t * fsm_jukebox_new(fsm_t *p_fsm_button, uint32_t on_off_press_time_ms, fsm_
 /// @param p_fsm_usart Pointer to the USART FSM 
 /// @param p_fsm_buzzer Pointer to the buzzer FSM. 
 /// @param next_song_press_time_ms Button press time in milliseconds to change to the next song.
-void fsm_jukebox_init(fsm_t *p_this, fsm_t *p_fsm_button, uint32_t on_off_press_time_ms, fsm_t *p_fsm_usart, fsm_t *p_fsm_buzzer, uint32_t next_song_press_time_ms);
+/// @param p_fsm_log Pointer to the log FSM, for the messages of the console.
+void fsm_jukebox_init(fsm_t *p_this, fsm_t *p_fsm_button, uint32_t on_off_press_time_ms, fsm_t *p_fsm_usart, fsm_t *p_fsm_buzzer, uint32_t next_song_press_time_ms, fsm_t *p_fsm_log);
 
 #endif /* FSM_JUKEBOX_H_ */
\ No newline at end of file
@@ -0,0 +1,118 @@
+/**
+ * @file fsm_log.h
+ * @brief Header for fsm_log.c file.
+ *
+ * Non-blocking log of the firmware. A message is formatted into a ring buffer and returns at once; the log FSM, fired
+ * in the main loop as the others, drains up to `LOG_DRAIN_CHARS` characters per pass through
+ * `port_system_log_put_char()` (SWO/ITM on the board, the standard output on the PC), and leaves the rest for the next
+ * pass when the channel is busy. A message that does not fit in the buffer is dropped and counted.
+ *
+ * The macros `LOG_ERROR()`, `LOG_WARNING()`, `LOG_INFO()` and `LOG_DEBUG()` compile to nothing above `LOG_LEVEL`,
+ * which is `LOG_LEVEL_DEBUG` by default and `LOG_LEVEL_WARNING` when `NDEBUG` is defined (release builds).
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+#ifndef FSM_LOG_H_
+#define FSM_LOG_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Other includes */
+#include "fsm.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define LOG_BUFFER_LENGTH 512   /*!< Characters waiting to be drained */
+#define LOG_LINE_LENGTH 128     /*!< Longest message, end character included. Longer ones are truncated. */
+#define LOG_DRAIN_CHARS 32      /*!< Characters drained per pass of the main loop at most */
+
+#define LOG_LEVEL_NONE 0        /*!< No message */
+#define LOG_LEVEL_ERROR 1       /*!< Failures */
+#define LOG_LEVEL_WARNING 2     /*!< Unexpected conditions the jukebox recovers from */
+#define LOG_LEVEL_INFO 3        /*!< Changes of state: on, off */
+#define LOG_LEVEL_DEBUG 4       /*!< Replies and measurements */
+
+#ifndef LOG_LEVEL
+#ifdef NDEBUG
+#define LOG_LEVEL LOG_LEVEL_WARNING /*!< Highest level compiled in */
+#else
+#define LOG_LEVEL LOG_LEVEL_DEBUG   /*!< Highest level compiled in */
+#endif
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(p_log, ...) fsm_log_printf((p_log), __VA_ARGS__)    /*!< Log a failure */
+#else
+#define LOG_ERROR(p_log, ...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARNING
+#define LOG_WARNING(p_log, ...) fsm_log_printf((p_log), __VA_ARGS__)  /*!< Log an unexpected condition */
+#else
+#define LOG_WARNING(p_log, ...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(p_log, ...) fsm_log_printf((p_log), __VA_ARGS__)     /*!< Log a change of state */
+#else
+#define LOG_INFO(p_log, ...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(p_log, ...) fsm_log_printf((p_log), __VA_ARGS__)    /*!< Log a reply or a measurement */
+#else
+#define LOG_DEBUG(p_log, ...) do {} while (0)
+#endif
+
+/* Enums */
+/// @brief Enumerates the log FSM states
+enum FSM_LOG {
+    LOG_IDLE = 0,   /*!< Initial state. Nothing to drain */
+    LOG_DRAIN       /*!< Characters waiting in the buffer */
+};
+
+/* Typedefs --------------------------------------------------------------------*/
+/// @brief Structure that defines a log FSM
+typedef struct{
+    fsm_t f;                            /*!< FSM for the log */
+    char buffer [LOG_BUFFER_LENGTH];    /*!< Ring buffer of characters */
+    uint16_t head;                      /*!< Next character to drain */
+    uint16_t count;                     /*!< Characters in the buffer */
+    uint32_t dropped;                   /*!< Messages dropped because the buffer was full */
+} fsm_log_t;
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/// @brief Creates a new log FSM
+/// @return Pointer to the new FSM
+fsm_t *fsm_log_new(void);
+
+/// @brief Initializes a log FSM with an empty buffer
+/// @param p_this Pointer to an fsm_t struct that contains an fsm_log_t
+void fsm_log_init(fsm_t *p_this);
+
+/// @brief Formats a message into the buffer, as `printf()`, without waiting for the channel. Use the `LOG_*` macros
+/// instead, so that the message is compiled out above `LOG_LEVEL`.
+/// @param p_this Pointer to an fsm_t struct that contains an fsm_log_t
+/// @param p_format Format of the message
+void fsm_log_printf(fsm_t *p_this, const char *p_format, ...);
+
+/// @brief Gets the characters waiting to be drained
+/// @param p_this Pointer to an fsm_t struct that contains an fsm_log_t
+/// @return Characters in the buffer
+uint32_t fsm_log_get_pending(fsm_t *p_this);
+
+/// @brief Gets the messages dropped because the buffer was full
+/// @param p_this Pointer to an fsm_t struct that contains an fsm_log_t
+/// @return Messages dropped since the log was initialized
+uint32_t fsm_log_get_dropped(fsm_t *p_this);
+
+/// @brief Checks if the log FSM is active: characters are waiting to be drained
+/// @param p_this Pointer to an fsm_t struct that contains an fsm_log_t
+/// @return true if active, false if not
+bool fsm_log_check_activity(fsm_t *p_this);
+
+#endif /* FSM_LOG_H_ */
@@ -21,6 +21,10 @@
 #include "port_usart.h"
 
 /* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define USART_BAUD_RATE_CONFIRM_TIME_MS 2000 /*!< Time to confirm a new baud rate before returning to the previous one */
+#define USART_TX_QUEUE_LENGTH 64 /*!< Bytes of the frames waiting for the one being sent, a byte of length each */
+
 /* Enums */
 /// @brief Enumerates the UART FSM states
 enum FSM_USART{
@@ -36,6 +40,17 @@ typedef struct{
     char in_data [USART_INPUT_BUFFER_LENGTH];       /*!< Input data */
     char out_data [USART_OUTPUT_BUFFER_LENGTH];     /*!< Output data */
     uint8_t usart_id;                               /*!< UASRT identifier */
+    uint32_t rx_cycles;                             /*!< Cycle counter when the end character of the input data arrived */
+    uint8_t in_frame [USART_FRAME_BUFFER_LENGTH];   /*!< Input frame of a binary session, without its delimiter */
+    uint8_t in_frame_length;                        /*!< Bytes of the input frame. 0 for text data */
+    uint32_t baud_rate_next;                        /*!< Baud rate to change to once the output data is sent. 0 for none */
+    uint32_t baud_rate_previous;                    /*!< Baud rate to return to if the new one is not confirmed */
+    uint32_t baud_rate_deadline;                    /*!< Time limit to confirm the new baud rate (ms). 0 if confirmed */
+    bool binary_next;                               /*!< Start a binary session once the output data is sent */
+    uint8_t tx_queue [USART_TX_QUEUE_LENGTH];       /*!< Frames waiting to be sent, each one after its length */
+    uint8_t tx_queue_head;                          /*!< Position of the first byte of the queue */
+    uint8_t tx_queue_count;                         /*!< Bytes in the queue */
+    uint16_t tx_overflows;                          /*!< Frames dropped because the queue was full */
 
 } fsm_usart_t;
 
@@ -61,16 +76,82 @@ bool fsm_usart_check_data_received(fsm_t *p_this);
 /// @param p_data Pointer to which the data will be copied
 void fsm_usart_get_in_data(fsm_t *p_this, char *p_data);
 
+/// @brief Gets the cycle counter when the end character of the input data arrived
+/// @param p_this Pointer to an fsm struct that corresponds to an UART
+/// @return Cycle counter (see `port_system_get_cycles()`)
+uint32_t fsm_usart_get_rx_cycles(fsm_t *p_this);
+
 /// @brief Copies data to he buffer
 /// @param p_this Pointer to an fsm struct that corresponds to an UART
 /// @param p_data Pointer to the data
 void fsm_usart_set_out_data(fsm_t *p_this, char *p_data);
 
+/// @brief Appends text to the data to be sent, so that the replies of a batch of commands go out together. The text
+/// that does not fit in the buffer is dropped.
+/// @param p_this Pointer to an fsm struct that corresponds to an UART
+/// @param p_data Pointer to the text
+void fsm_usart_append_out_data(fsm_t *p_this, const char *p_data);
+
+/// @brief Get the frame received in a binary session
+/// @param p_this Pointer to an fsm struct that corresponds to an UART
+/// @param p_data Pointer to which the frame will be copied, of `USART_FRAME_BUFFER_LENGTH` bytes
+/// @return Bytes of the frame, without its delimiter. 0 if the input data is text.
+uint32_t fsm_usart_get_in_frame(fsm_t *p_this, uint8_t *p_data);
+
+/// @brief Copies an encoded frame to the buffer. It must end with its delimiter, its only zero byte. While other data
+/// is being sent, the frame waits in a queue, and it is dropped if the queue is full.
+/// @param p_this Pointer to an fsm struct that corresponds to an UART
+/// @param p_data Pointer to the frame
+/// @param length Bytes of the frame, delimiter included
+void fsm_usart_set_out_frame(fsm_t *p_this, const uint8_t *p_data, uint32_t length);
+
+/// @brief Checks if the session is binary (frames) or text (messages)
+/// @param p_this Pointer to an fsm struct that corresponds to an UART
+/// @return True if the session is binary, false if not
+bool fsm_usart_get_binary(fsm_t *p_this);
+
+/// @brief Selects a binary (frames) or text (messages) session
+/// @param p_this Pointer to an fsm struct that corresponds to an UART
+/// @param binary True for a binary session, false for a text session
+void fsm_usart_set_binary(fsm_t *p_this, bool binary);
+
+/// @brief Starts a binary session once the next output data (the acknowledgement in text) is sent
+/// @param p_this Pointer to an fsm struct that corresponds to an UART
+void fsm_usart_set_binary_next(fsm_t *p_this);
+
+/// @brief Gets the messages received that did not fit in the input buffers
+/// @param p_this Pointer to an fsm struct that corresponds to an UART
+/// @return Messages lost since the USART was initialized
+uint32_t fsm_usart_get_rx_overflows(fsm_t *p_this);
+
+/// @brief Gets the frames dropped because the queue of frames to send was full
+/// @param p_this Pointer to an fsm struct that corresponds to an UART
+/// @return Frames lost since the USART was initialized
+uint32_t fsm_usart_get_tx_overflows(fsm_t *p_this);
+
+/// @brief Changes the baud rate once the next output data (the acknowledgement of the change) is sent. The new rate
+/// must be confirmed with `fsm_usart_confirm_baud_rate()` within `USART_BAUD_RATE_CONFIRM_TIME_MS`, or the USART returns to
+/// the previous one.
+/// @param p_this Pointer to an fsm struct that corresponds to an UART
+/// @param baud_rate Baud rate
+/// @return True if the rate can be obtained from the clock of the USART, false if not
+bool fsm_usart_set_baud_rate(fsm_t *p_this, uint32_t baud_rate);
+
+/// @brief Gets the baud rate, or the one it will change to
+/// @param p_this Pointer to an fsm struct that corresponds to an UART
+/// @return Baud rate
+uint32_t fsm_usart_get_baud_rate(fsm_t *p_this);
+
+/// @brief Confirms the baud rate: the other end received the data sent at the new rate and answered at it
+/// @param p_this Pointer to an fsm struct that corresponds to an UART
+/// @return True if a new rate was waiting for confirmation, false if not
+bool fsm_usart_confirm_baud_rate(fsm_t *p_this);
+
 /// @brief Resets the input buffer
 /// @param p_this Pointer to an fsm struct that corresponds to an UART
 void fsm_usart_reset_input_data(fsm_t *p_this);
 
-/// @brief Check wether the UART is active or not
+/// @brief Check wether the UART is active or not. It is also active while a new baud rate waits for confirmation.
 /// @param p_this Pointer to an fsm struct that corresponds to an UART
 /// @return true if active, flase if not
 bool fsm_usart_check_activity(fsm_t *p_this);
@@ -0,0 +1,141 @@
+/**
+ * @file game.h
+ * @brief Header for game.c file.
+ *
+ * Guess-the-song game. Each round plays an excerpt of `GAME_EXCERPT_NOTES` notes of a melody, from a random note, and
+ * every command is a guess until the right one, `give up` or, in a timed round, the end of the time.
+ *
+ * A guess need not be exact: it is compared with every name of the jukebox by the edit distance (insertions,
+ * deletions and substitutions of a character, ignoring case), and it is right if the closest name is the answer and
+ * the distance is at most a quarter of the length of the answer (`megalovnia` for `megalovania`).
+ *
+ * The distance is the bit-parallel algorithm of Myers: a column of the edit distance matrix is two bit vectors of the
+ * guess, one machine word, and each character of a name updates it with a handful of logic operations and an
+ * addition. The guess is compared up to `GAME_MAX_GUESS_LENGTH` characters, so a name costs at most one step per
+ * character and a guess costs the same with any guess. The names that cannot beat the closest one so far by their
+ * length alone are skipped, and a name is dropped as soon as the rest of it cannot bring it back.
+ *
+ * The score of a right guess is `GAME_POINTS`, minus `GAME_DISTANCE_PENALTY` per edit and `GAME_WRONG_PENALTY` per
+ * wrong guess of the round, never below `GAME_MIN_POINTS`, plus `GAME_STREAK_BONUS` per round won in a row before.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#ifndef GAME_H_
+#define GAME_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Other includes */
+#include "melodies.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define GAME_EXCERPT_NOTES 8U           /*!< Notes of the excerpt of a round */
+#define GAME_MAX_TRACKS 2U              /*!< Other voices of the excerpt, as buzzers after the first one */
+#define GAME_MAX_GUESS_LENGTH 32U       /*!< Characters of a guess compared, the bits of a word */
+#define GAME_POINTS 100U                /*!< Points of an exact guess at the first try */
+#define GAME_DISTANCE_PENALTY 25U       /*!< Points lost per edit of the guess */
+#define GAME_WRONG_PENALTY 20U          /*!< Points lost per wrong guess of the round */
+#define GAME_MIN_POINTS 10U             /*!< Fewest points of a right guess */
+#define GAME_STREAK_BONUS 10U           /*!< Points per round won in a row before */
+#define GAME_NO_MATCH 0xFFFFFFFFU       /*!< No name to match */
+
+/* Enums */
+/// @brief Result of a guess
+typedef enum {
+    GAME_WRONG = 0,     /*!< The round goes on */
+    GAME_RIGHT,         /*!< The round is won */
+    GAME_TIME_UP,       /*!< The time of the round was over: the round is lost */
+} game_result_t;
+
+/* Typedefs ------------------------------------------------------------------*/
+/// @brief State of the game
+typedef struct {
+    bool on;                                    /*!< A round is in course */
+    uint32_t answer;                            /*!< Index of the melody to guess */
+    melody_t excerpt;                           /*!< Notes played in the round, within the melody */
+    const double *tracks[GAME_MAX_TRACKS];      /*!< Other voices of the excerpt */
+    uint32_t start_ms;                          /*!< Start of the round */
+    uint32_t limit_ms;                          /*!< Time to guess, 0 for no limit */
+    uint32_t wrong;                             /*!< Wrong guesses of the round */
+    uint32_t score;                             /*!< Points of every round */
+    uint32_t streak;                            /*!< Rounds won in a row */
+    uint32_t best_streak;                       /*!< Longest streak */
+    uint32_t rounds;                            /*!< Rounds played */
+    uint32_t wins;                              /*!< Rounds won */
+} game_t;
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Initialize the game, with no round and no score.
+/// @param p_game Pointer to the game
+void game_init(game_t *p_game);
+
+/// @brief Start a round. A round in course is lost.
+/// @param p_game Pointer to the game
+/// @param p_melody Melody to guess
+/// @param answer Index of the melody
+/// @param offset First note of the excerpt. It is moved back if the excerpt would end after the melody.
+/// @param limit_ms Time to guess, 0 for no limit
+/// @param now_ms Current time
+/// @return Pointer to the excerpt, to be played
+const melody_t *game_start(game_t *p_game, const melody_t *p_melody, uint32_t answer, uint32_t offset,
+                           uint32_t limit_ms, uint32_t now_ms);
+
+/// @brief Get the edit distance between two names, ignoring case. Only the first `GAME_MAX_GUESS_LENGTH` characters
+/// of the first one count.
+/// @param p_guess Guess
+/// @param p_name Name
+/// @return Edit distance
+uint32_t game_distance(const char *p_guess, const char *p_name);
+
+/// @brief Find the name closest to a guess. On a tie, the first one.
+/// @param p_guess Guess
+/// @param pp_names Names
+/// @param num_names Number of names
+/// @param p_distance Pointer to store the edit distance to the closest name
+/// @return Index of the closest name, or `GAME_NO_MATCH` if there are no names
+uint32_t game_match(const char *p_guess, const char *const *pp_names, uint32_t num_names, uint32_t *p_distance);
+
+/// @brief Score a guess matched with `game_match()`. A right guess or the end of the time ends the round.
+/// @param p_game Pointer to the game
+/// @param match Index of the closest name
+/// @param distance Edit distance to the closest name
+/// @param answer_length Length of the name of the answer
+/// @param now_ms Current time
+/// @param p_points Pointer to store the points won, 0 if none
+/// @return Result of the guess
+game_result_t game_guess(game_t *p_game, uint32_t match, uint32_t distance, uint32_t answer_length, uint32_t now_ms,
+                         uint32_t *p_points);
+
+/// @brief End the round in course, lost.
+/// @param p_game Pointer to the game
+void game_give_up(game_t *p_game);
+
+/// @brief Check if the time of a timed round is over. It ends the round, lost.
+/// @param p_game Pointer to the game
+/// @param now_ms Current time
+/// @return true if the round has just ended
+bool game_check_time_up(game_t *p_game, uint32_t now_ms);
+
+/// @brief Check if a round is in course.
+/// @param p_game Pointer to the game
+/// @return true if a round is in course
+bool game_is_on(const game_t *p_game);
+
+/// @brief Check if a round with a time limit is in course.
+/// @param p_game Pointer to the game
+/// @return true if a timed round is in course
+bool game_is_timed(const game_t *p_game);
+
+/// @brief Get the melody to guess in the round in course, or in the last one.
+/// @param p_game Pointer to the game
+/// @return Index of the melody
+uint32_t game_get_answer(const game_t *p_game);
+
+#endif /* GAME_H_ */
@@ -0,0 +1,129 @@
+/**
+ * @file latency.h
+ * @brief Header for latency.c file.
+ *
+ * Response time of the jukebox to the USART commands. Every command is timestamped with the cycle counter of the
+ * core at four points:
+ * 1. The end character (`\n`) arrives in `USART3_IRQHandler()` (the origin of the measurements).
+ * 2. The guard `check_command_received()` of the jukebox FSM fires.
+ * 3. `_execute_command()` returns.
+ * 4. The buzzer starts the first note after the command (`port_buzzer_set_note_frequency()`).
+ *
+ * The latencies from 1 to 2, 3 and 4 are kept per command text (`play`, `next`, `select 3`...): the extremes and the
+ * mean of every measurement, and the latest `LATENCY_SAMPLES` samples for the percentiles.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define LATENCY_MAX_COMMANDS 8      /*!< Commands tracked. Once full, the rest are counted under the name "*" */
+#define LATENCY_SAMPLES 16          /*!< Latest samples kept per command and stage for the percentiles */
+#define LATENCY_NAME_LENGTH 16      /*!< Length of a command text, as the USART input buffer */
+#define LATENCY_NONE (-1)           /*!< No command started yet */
+
+/* Enums */
+/// @brief Stages measured from the arrival of the end character
+enum LATENCY_STAGES {
+    LATENCY_GUARD = 0,  /*!< The guard of the jukebox FSM fired */
+    LATENCY_EXECUTED,   /*!< The command was executed */
+    LATENCY_NOTE,       /*!< The first note after the command started */
+    LATENCY_NUM_STAGES
+};
+
+/* Typedefs ------------------------------------------------------------------*/
+/// @brief Distribution of the latency of a stage, in cycles
+typedef struct{
+    uint32_t count;                     /*!< Measurements */
+    uint32_t min;                       /*!< Shortest latency */
+    uint32_t max;                       /*!< Longest latency */
+    uint64_t sum;                       /*!< Sum of the latencies, for the mean */
+    uint32_t samples[LATENCY_SAMPLES];  /*!< Latest latencies, circular buffer */
+} latency_dist_t;
+
+/// @brief Latencies of a command
+typedef struct{
+    char name[LATENCY_NAME_LENGTH];                 /*!< Command and parameter, e.g. "select 3" */
+    latency_dist_t stages[LATENCY_NUM_STAGES];      /*!< Distribution of each stage */
+} latency_command_t;
+
+/// @brief Latency tracker
+typedef struct{
+    latency_command_t commands[LATENCY_MAX_COMMANDS];   /*!< Commands seen */
+    uint32_t num_commands;                              /*!< Commands in use */
+    int32_t current;                                    /*!< Command started last, or `LATENCY_NONE` */
+    bool note_pending;                                  /*!< The command started last waits for its first note */
+    uint32_t rx_cycles;                                 /*!< Arrival of the end character of the last command */
+} latency_t;
+
+/// @brief Summary of a distribution, in cycles
+typedef struct{
+    uint32_t count; /*!< Measurements */
+    uint32_t min;   /*!< Shortest latency */
+    uint32_t p50;   /*!< Median of the latest samples */
+    uint32_t p90;   /*!< 90th percentile of the latest samples */
+    uint32_t max;   /*!< Longest latency */
+    uint32_t mean;  /*!< Mean of every measurement */
+} latency_stats_t;
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Initialize (or clear) a latency tracker.
+/// @param p_latency Pointer to the tracker
+void latency_init(latency_t *p_latency);
+
+/// @brief Start the measurement of a command. A previous command still waiting for its first note is closed without it.
+/// @param p_latency Pointer to the tracker
+/// @param p_name Command text
+/// @param rx_cycles Cycle counter when the end character arrived
+/// @param guard_cycles Cycle counter when the guard fired
+void latency_start(latency_t *p_latency, const char *p_name, uint32_t rx_cycles, uint32_t guard_cycles);
+
+/// @brief Record the end of the execution of the command started last.
+/// @param p_latency Pointer to the tracker
+/// @param cycles Cycle counter when the command was executed
+void latency_executed(latency_t *p_latency, uint32_t cycles);
+
+/// @brief Record the first note after the command started last. Only the first call after `latency_start()` counts.
+/// @param p_latency Pointer to the tracker
+/// @param cycles Cycle counter when the note started
+void latency_note(latency_t *p_latency, uint32_t cycles);
+
+/// @brief Check if the command started last is still waiting for its first note.
+/// @param p_latency Pointer to the tracker
+/// @return true if a note is expected
+bool latency_note_pending(const latency_t *p_latency);
+
+/// @brief Get the number of commands tracked.
+/// @param p_latency Pointer to the tracker
+/// @return Number of commands
+uint32_t latency_get_num_commands(const latency_t *p_latency);
+
+/// @brief Summarize the distribution of a stage of a command.
+/// @param p_latency Pointer to the tracker
+/// @param idx Index of the command, in order of appearance
+/// @param stage Stage (`LATENCY_GUARD`, `LATENCY_EXECUTED` or `LATENCY_NOTE`)
+/// @param p_stats Pointer to store the summary
+/// @return false if the command or the stage has no measurements
+bool latency_get_stats(const latency_t *p_latency, uint32_t idx, uint32_t stage, latency_stats_t *p_stats);
+
+/// @brief Write the summary of a command in one line: `<name> n=<count> guard <p50>/<p90>/<max> exec ... note ... us`.
+/// @param p_latency Pointer to the tracker
+/// @param idx Index of the command
+/// @param clock_hz Frequency of the cycle counter
+/// @param p_buffer Buffer for the line, ended by `\n`
+/// @param length Size of the buffer
+/// @return false if the command does not exist
+bool latency_format(const latency_t *p_latency, uint32_t idx, uint32_t clock_hz, char *p_buffer, size_t length);
+
+#endif /* LATENCY_H_ */
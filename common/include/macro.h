@@ -0,0 +1,106 @@
+/**
+ * @file macro.h
+ * @brief Header for macro.c file.
+ *
+ * Named macros of text commands, stored as bytecode. `macro define <name> <commands>` compiles a `;`-separated list
+ * of commands into the opcodes of the binary protocol (frame.h), each one followed by its parameter:
+ *
+ * | Command | Bytecode |
+ * |---------|----------|
+ * | `play`, `stop`, `pause`, `next`, `info` | opcode |
+ * | `select <index or name>` | opcode, index (u8); a name is resolved when the macro is defined |
+ * | `volume <0 to 1>` | opcode, percent (u8, saturated at 100) |
+ * | `speed <factor>` | opcode, percent (u16, little endian, at least 10) |
+ *
+ * so `select 3;volume 0.3;speed 1.5;play` takes 8 bytes instead of 34. The commands are checked once, when the macro
+ * is defined; `macro run <name>` reads each opcode with its integer operand (`macro_next()`) and runs it as the binary
+ * protocol does, without text. `macro_decode()` turns an instruction back into text, only to show the macro.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#ifndef MACRO_H_
+#define MACRO_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define MACRO_MAX_MACROS 4          /*!< Macros stored at the same time */
+#define MACRO_NAME_LENGTH 9         /*!< Longest name of a macro, end character included */
+#define MACRO_CODE_LENGTH 24        /*!< Longest bytecode of a macro */
+#define MACRO_SEPARATOR ';'         /*!< Separator of the commands of a batch or a macro */
+#define MACRO_COMMAND_LENGTH 8      /*!< Longest command decoded from bytecode, end character included */
+#define MACRO_PARAM_LENGTH 8        /*!< Longest parameter decoded from bytecode, end character included */
+
+/* Typedefs ------------------------------------------------------------------*/
+/// @brief Macro compiled into bytecode
+typedef struct{
+    char name[MACRO_NAME_LENGTH];       /*!< Name. Empty if the slot is free. */
+    uint8_t length;                     /*!< Bytes of bytecode */
+    uint8_t code[MACRO_CODE_LENGTH];    /*!< Bytecode */
+} macro_t;
+
+/// @brief Macros of a jukebox
+typedef struct{
+    macro_t macros[MACRO_MAX_MACROS];   /*!< Slots */
+} macro_table_t;
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Initialize a table of macros with every slot free.
+/// @param p_table Pointer to the table
+void macro_table_init(macro_table_t *p_table);
+
+/// @brief Compile a `;`-separated list of commands into bytecode.
+/// @param p_text Pointer to the commands
+/// @param p_code Pointer to the bytecode
+/// @param size Size of the bytecode buffer
+/// @return Bytes of bytecode, or 0 if a command cannot be stored in a macro, a parameter is wrong, or the bytecode
+/// does not fit
+size_t macro_compile(const char *p_text, uint8_t *p_code, size_t size);
+
+/// @brief Read an instruction of bytecode.
+/// @param p_code Pointer to the bytecode
+/// @param length Bytes of bytecode
+/// @param offset Position of the instruction
+/// @param p_opcode Pointer to store the opcode (frame.h)
+/// @param p_operand Pointer to store the operand: index of the melody, percent of the volume or of the speed, 0 if the
+/// command has none
+/// @return Position of the next instruction, or 0 at the end of the bytecode or if it is broken
+size_t macro_next(const uint8_t *p_code, size_t length, size_t offset, uint8_t *p_opcode, uint16_t *p_operand);
+
+/// @brief Decode an instruction of bytecode into the text command and its parameter, to show the macro.
+/// @param p_code Pointer to the bytecode
+/// @param length Bytes of bytecode
+/// @param offset Position of the instruction
+/// @param p_command Pointer to store the command, of `MACRO_COMMAND_LENGTH` bytes
+/// @param p_param Pointer to store the parameter, of `MACRO_PARAM_LENGTH` bytes. Empty if the command has none.
+/// @return Position of the next instruction, or 0 at the end of the bytecode or if it is broken
+size_t macro_decode(const uint8_t *p_code, size_t length, size_t offset, char *p_command, char *p_param);
+
+/// @brief Compile and store a macro. A macro with the same name is replaced.
+/// @param p_table Pointer to the table
+/// @param p_name Name of the macro
+/// @param p_text Commands of the macro, separated by `;`
+/// @return Pointer to the macro, or NULL if the name is too long, the commands are not valid or the table is full
+const macro_t *macro_define(macro_table_t *p_table, const char *p_name, const char *p_text);
+
+/// @brief Find a macro by its name.
+/// @param p_table Pointer to the table
+/// @param p_name Name of the macro
+/// @return Pointer to the macro, or NULL if there is none with that name
+const macro_t *macro_find(const macro_table_t *p_table, const char *p_name);
+
+/// @brief Delete a macro.
+/// @param p_table Pointer to the table
+/// @param p_name Name of the macro
+/// @return true if the macro existed
+bool macro_delete(macro_table_t *p_table, const char *p_name);
+
+#endif /* MACRO_H_ */
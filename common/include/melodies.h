@@ -10,9 +10,12 @@
 /* Includes ------------------------------------------------------------------*/
 /* Standard C includes */
 #include <stdint.h>
+/* Other includes */
+#include "note_fx.h"
 
 /* Defines and enums ----------------------------------------------------------*/
 #define SILENCE 0 /*!< Silence note */
+#define MELODIES_LENGTH 8 /*!< Melodies of the registry `melodies[]` */
 
 // 3rd Octave (Tercera Octava)
 #define DO3 130.813   /*!< DO3 note frequency */
@@ -66,6 +69,9 @@ typedef struct
     double *p_notes;        /*!< Pointer to the notes of the melody */
     uint16_t *p_durations;  /*!< Pointer to the duration of each note of the melody in milliseconds */
     uint16_t melody_length; /*!< Length of the melody to play */
+    const note_fx_t *p_effects; /*!< Pointer to the effects of each note of the melody, NULL for none */
+    const double *const *p_tracks; /*!< Pointer to the notes of the other voices, on the durations of `p_notes`. NULL for none. */
+    uint8_t num_tracks;     /*!< Number of other voices in `p_tracks`, each one on its own buzzer */
 } melody_t;
 
 // Melodies must be defined in melodies.c, and declared here as extern
@@ -89,4 +95,7 @@ extern const melody_t espana_melody;
 extern const melody_t mario_melody;
 extern const melody_t iscale_melody;
 
+// Registry of the melodies, in the order of `select <index>`. Add new melodies here too (see melody_registry.h)
+extern const melody_t *const melodies[MELODIES_LENGTH];
+
 #endif /* MELODIES_H_ */
\ No newline at end of file
@@ -0,0 +1,106 @@
+/**
+ * @file melody_pack.h
+ * @brief Header for melody_pack.c file.
+ *
+ * Compressed melodies. A container holds several melodies, each one packed on its own so it can be played without
+ * the others. The buzzer decodes the notes one at a time, as it plays them: a melody is never unpacked whole, and
+ * decoding it takes the same RAM whatever its length.
+ *
+ * Each melody has a palette with its different frequencies, sorted, so the index of a frequency in the palette
+ * grows with its pitch. The notes are coded in a bit stream:
+ * - Pitch: the difference with the index of the previous note.
+ * - Duration: by runs of notes with the same duration. A run starts with a bit that tells if it takes back the
+ *   duration of the run before the previous one (the usual long-short patterns) or a new one, coded as the
+ *   difference with the previous duration, and then the notes of the run.
+ *
+ * The values are coded with Golomb-Rice codes (signed values in zigzag): a value `v` takes `(v >> k) + 1 + k` bits.
+ * The encoder chooses the best `k` for the pitches, the durations and the runs of each melody, and decoding a
+ * value takes a few shifts and masks.
+ *
+ * Layout of a container (little endian): `MELODY_PACK_MAGIC` (u32), the number of melodies (u8) and the melodies.
+ * Each melody: its size in bytes after this field (u16), the notes (u16), `k` of the pitches, durations and runs
+ * (u8 each), the entries of the palette (u8), the name ended by '\0', the palette (frequencies in mHz, u24 each) and
+ * the bit stream, from the least significant bit of each byte.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#ifndef MELODY_PACK_H_
+#define MELODY_PACK_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Other includes */
+#include "melodies.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define MELODY_PACK_MAGIC 0x4B43504DU           /*!< Mark of a container ("MPCK") */
+#define MELODY_PACK_NAME_LENGTH 16              /*!< Longest name, end character included */
+#define MELODY_PACK_MAX_PALETTE 255             /*!< Most different frequencies in a melody */
+#define MELODY_PACK_MAX_FREQUENCY_MHZ 0xFFFFFFU /*!< Highest frequency, in mHz (16.7 kHz) */
+#define MELODY_PACK_MAX_K 15                    /*!< Largest parameter of the Rice codes */
+
+/* Typedefs ------------------------------------------------------------------*/
+/// @brief Melody of a container being decoded
+typedef struct {
+    melody_t melody;                            /*!< Name and length for the players; it has no notes in memory */
+    const uint8_t *p_palette;                   /*!< Frequencies of the melody, in the container */
+    const uint8_t *p_bits;                      /*!< Bit stream, in the container */
+    uint32_t num_bits;                          /*!< Bits of the stream */
+    uint8_t palette_size;                       /*!< Entries of the palette */
+    uint8_t k_pitch;                            /*!< Rice parameter of the pitches */
+    uint8_t k_duration;                         /*!< Rice parameter of the durations */
+    uint8_t k_run;                              /*!< Rice parameter of the runs */
+    uint32_t bit;                               /*!< Next bit of the stream */
+    uint32_t next_note;                         /*!< Index of the next note to decode */
+    uint8_t pitch;                              /*!< Palette index of the last note */
+    uint16_t duration;                          /*!< Duration of the current run */
+    uint16_t other_duration;                    /*!< Duration of the run before */
+    uint32_t run_left;                          /*!< Notes left in the current run */
+    double frequency;                           /*!< Frequency of the last note */
+} melody_pack_t;
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Pack melodies in a container. The frequencies must be whole mHz, as the ones of melodies.h.
+/// @param pp_melodies Array of pointers to the melodies
+/// @param num_melodies Number of melodies, up to 255
+/// @param p_container Pointer to the buffer of the container
+/// @param size Bytes of the buffer
+/// @return Bytes of the container, or 0 if a melody cannot be packed or the buffer is too small
+size_t melody_pack_encode(const melody_t *const *pp_melodies, uint32_t num_melodies, uint8_t *p_container, size_t size);
+
+/// @brief Get the number of melodies of a container.
+/// @param p_container Pointer to the container
+/// @param size Bytes of the container
+/// @return Number of melodies, 0 if it is not a container
+uint32_t melody_pack_get_num_melodies(const uint8_t *p_container, size_t size);
+
+/// @brief Open a melody of a container, ready to decode its first note. The container must stay in memory.
+/// @param p_pack Pointer to the decoder
+/// @param p_container Pointer to the container
+/// @param size Bytes of the container
+/// @param index Index of the melody in the container, from 0
+/// @return true if the melody exists and its header is valid
+bool melody_pack_open(melody_pack_t *p_pack, const uint8_t *p_container, size_t size, uint32_t index);
+
+/// @brief Get the melody being decoded, to be given to the players with its name and length.
+/// @param p_pack Pointer to the decoder
+/// @return Pointer to the melody; its notes and durations are NULL
+const melody_t *melody_pack_get_melody(const melody_pack_t *p_pack);
+
+/// @brief Decode a note. Notes are decoded in order: going back starts again from the first one.
+/// @param p_pack Pointer to the decoder
+/// @param note_index Index of the note
+/// @param p_frequency Pointer to store the frequency in Hz
+/// @param p_duration Pointer to store the duration in ms
+/// @return true if decoded, false if the index is out of the melody or the stream is corrupt
+bool melody_pack_get_note(melody_pack_t *p_pack, uint32_t note_index, double *p_frequency, uint32_t *p_duration);
+
+#endif /* MELODY_PACK_H_ */
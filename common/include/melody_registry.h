@@ -0,0 +1,88 @@
+/**
+ * @file melody_registry.h
+ * @brief Header for melody_registry.c file.
+ *
+ * Lookup of the melodies of the jukebox (`melodies[]` in melodies.c) by name. The registry is a const table of
+ * pointers, so it stays in flash and the jukebox keeps an index into it instead of copies of the melodies.
+ *
+ * Names are found in constant time through a perfect hash: `melody_registry.py` searches, when the project is
+ * configured, the seed for which `melody_registry_hash()` sends every name to a different slot, and writes the seed
+ * and the slots to `melody_registry_index.c`. The lookup hashes the name, reads its slot and compares one name.
+ * Names are compared ignoring case.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#ifndef MELODY_REGISTRY_H_
+#define MELODY_REGISTRY_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Other includes */
+#include "melodies.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define MELODY_REGISTRY_SLOTS 16        /*!< Slots of the name index, a power of 2 of at least `MELODIES_LENGTH` */
+#define MELODY_REGISTRY_EMPTY 0xFF      /*!< Slot without melody */
+#define MELODY_REGISTRY_NOT_FOUND 0xFF  /*!< Index returned when no melody matches */
+
+/* Global variables ------------------------------------------------------------*/
+extern const uint32_t melody_registry_seed;                         /*!< Seed of the perfect hash (generated) */
+extern const uint8_t melody_registry_slots[MELODY_REGISTRY_SLOTS];  /*!< Index of the melody of each slot (generated) */
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/**
+ * @brief Hash of a name, ignoring case: FNV-1a of its lowercase characters, starting from the seed, with the high
+ * half folded into the low one.
+ *
+ * `melody_registry.py` computes the same hash; change both or none.
+ *
+ * @param p_name Name of the melody
+ * @param seed Seed of the hash
+ * @return Hash of the name
+ */
+uint32_t melody_registry_hash(const char *p_name, uint32_t seed);
+
+/**
+ * @brief Checks if a name begins with a prefix, ignoring case. The melody store compares its names the same way.
+ *
+ * @param p_name Name of the melody
+ * @param p_prefix Prefix
+ * @param p_whole Set to true if the prefix is the whole name
+ * @return true if the name begins with the prefix
+ */
+bool melody_registry_begins_with(const char *p_name, const char *p_prefix, bool *p_whole);
+
+/**
+ * @brief Gets a melody of the registry.
+ *
+ * @param melody_idx Index of the melody
+ * @return Pointer to the melody, or NULL if there is no melody with that index
+ */
+const melody_t *melody_registry_get(uint32_t melody_idx);
+
+/**
+ * @brief Finds a melody by its name, ignoring case, in constant time.
+ *
+ * @param p_name Name of the melody
+ * @return Index of the melody, or `MELODY_REGISTRY_NOT_FOUND`
+ */
+uint32_t melody_registry_find(const char *p_name);
+
+/**
+ * @brief Finds a melody by its name or by the beginning of its name, ignoring case. A whole name wins over the names
+ * it begins (`scale` is not ambiguous even if there were a `scales`); otherwise the beginning must match a single
+ * melody.
+ *
+ * @param p_prefix Name or beginning of the name of the melody
+ * @return Index of the melody, or `MELODY_REGISTRY_NOT_FOUND` if none or more than one match
+ */
+uint32_t melody_registry_find_prefix(const char *p_prefix);
+
+#endif /* MELODY_REGISTRY_H_ */
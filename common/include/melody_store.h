@@ -0,0 +1,148 @@
+/**
+ * @file melody_store.h
+ * @brief Header for melody_store.c file.
+ *
+ * Melodies uploaded through the USART, kept in the flash sector of port_flash.h. The sector is a log: every upload
+ * appends a record and nothing already written is rewritten, so an upload cut in the middle (reset, lost frames,
+ * wrong CRC) never damages the melodies stored before it. A record is
+ *
+ * | Field | Bytes | Content |
+ * |-------|-------|---------|
+ * | `length`, `magic` | 2 + 2 | Notes, and `MELODY_STORE_MAGIC`. Written first, in a single word. |
+ * | `name` | `MELODY_STORE_NAME_LENGTH` | Name, ended by `'\0'` |
+ * | `crc`, `commit` | 2 + 2 | CRC-16 of the notes as uploaded, and `MELODY_STORE_COMMITTED`. Written last. |
+ * | `deleted` | 4 | 0 once the melody is deleted or replaced, erased otherwise |
+ * | reserved | 4 | Erased |
+ * | notes | 8 per note | Frequencies in Hz (`double`), as the buzzer reads them |
+ * | durations | 2 per note | Durations in ms |
+ *
+ * padded to 8 bytes. When the board starts, the log is read from the beginning: records without the commit mark are
+ * skipped, and the melodies of the others point straight to the flash, so a melody takes no RAM but its `melody_t`.
+ * Uploading a melody with the name of a stored one replaces it once the new one is committed. The space of deleted
+ * and broken records is only recovered by erasing the whole store.
+ *
+ * An upload is `melody_store_begin()`, `melody_store_write()` in order of notes, and `melody_store_end()`. Notes are
+ * uploaded as `MELODY_STORE_NOTE_BYTES` bytes each: frequency in tenths of Hz (u16) and duration in ms (u16), both in
+ * little endian.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#ifndef MELODY_STORE_H_
+#define MELODY_STORE_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Other includes */
+#include "melodies.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define MELODY_STORE_MAX_MELODIES 8     /*!< Melodies stored at the same time */
+#define MELODY_STORE_NAME_LENGTH 16     /*!< Longest name, end character included */
+#define MELODY_STORE_NOTE_BYTES 4       /*!< Bytes of an uploaded note */
+#define MELODY_STORE_MAGIC 0x4D4CU      /*!< Mark of the first word of a record ("ML") */
+#define MELODY_STORE_COMMITTED 0xC0DEU  /*!< Mark of a complete record */
+#define MELODY_STORE_NOT_FOUND 0xFF     /*!< Index returned when no melody matches */
+
+/* Enums */
+/// @brief Result of the operations of the store
+typedef enum {
+    MELODY_STORE_OK = 0,        /*!< Done */
+    MELODY_STORE_BAD_PARAM,     /*!< Wrong name, length, note or CRC, or no upload in progress */
+    MELODY_STORE_NO_SPACE,      /*!< Not enough flash or no free melody */
+    MELODY_STORE_FLASH_ERROR    /*!< The flash could not be programmed */
+} melody_store_status_t;
+
+/* Typedefs ------------------------------------------------------------------*/
+/// @brief Header of a record in the flash
+typedef struct {
+    uint16_t length;                        /*!< Notes */
+    uint16_t magic;                         /*!< `MELODY_STORE_MAGIC` */
+    char name[MELODY_STORE_NAME_LENGTH];    /*!< Name, ended by '\0' */
+    uint16_t crc;                           /*!< CRC-16 of the notes as uploaded */
+    uint16_t commit;                        /*!< `MELODY_STORE_COMMITTED` once complete */
+    uint32_t deleted;                       /*!< 0 once deleted or replaced */
+    uint32_t reserved;                      /*!< Erased */
+} melody_store_header_t;
+
+/// @brief Uploaded melodies and upload in progress
+typedef struct {
+    melody_t melodies[MELODY_STORE_MAX_MELODIES];   /*!< Stored melodies, pointing to the flash */
+    uint32_t offsets[MELODY_STORE_MAX_MELODIES];    /*!< Position of the record of each melody */
+    uint8_t num_melodies;                           /*!< Stored melodies */
+    uint32_t end;                                   /*!< End of the log: position of the next record */
+    bool uploading;                                 /*!< An upload is in progress */
+    uint32_t upload_offset;                         /*!< Position of the record being uploaded */
+    uint16_t upload_length;                         /*!< Notes of the upload */
+    uint16_t upload_received;                       /*!< Notes received */
+    uint16_t upload_crc;                            /*!< CRC-16 of the notes received */
+} melody_store_t;
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Read the log of the flash and find the stored melodies.
+/// @param p_store Pointer to the store
+void melody_store_mount(melody_store_t *p_store);
+
+/// @brief Erase the whole store.
+/// @param p_store Pointer to the store
+/// @return `MELODY_STORE_OK` or `MELODY_STORE_FLASH_ERROR`
+melody_store_status_t melody_store_erase(melody_store_t *p_store);
+
+/// @brief Start an upload. An upload in progress is abandoned.
+/// @param p_store Pointer to the store
+/// @param p_name Name of the melody: letters, digits and '_', up to `MELODY_STORE_NAME_LENGTH - 1`
+/// @param length Notes of the melody
+/// @return `MELODY_STORE_OK`, `MELODY_STORE_BAD_PARAM`, `MELODY_STORE_NO_SPACE` or `MELODY_STORE_FLASH_ERROR`
+melody_store_status_t melody_store_begin(melody_store_t *p_store, const char *p_name, uint16_t length);
+
+/// @brief Write notes of the upload. Notes must arrive in order; notes already written (a retry) are ignored.
+/// @param p_store Pointer to the store
+/// @param first_note Index of the first note
+/// @param p_data Pointer to the notes, `MELODY_STORE_NOTE_BYTES` bytes each
+/// @param num_notes Notes
+/// @return `MELODY_STORE_OK`, `MELODY_STORE_BAD_PARAM` or `MELODY_STORE_FLASH_ERROR`
+melody_store_status_t melody_store_write(melody_store_t *p_store, uint16_t first_note, const uint8_t *p_data, uint16_t num_notes);
+
+/// @brief Commit the upload if every note arrived and the CRC matches; otherwise it is abandoned.
+/// @param p_store Pointer to the store
+/// @param crc CRC-16/CCITT-FALSE of every note as uploaded
+/// @param p_melody_idx Pointer to store the index of the melody in the store
+/// @return `MELODY_STORE_OK`, `MELODY_STORE_BAD_PARAM` or `MELODY_STORE_FLASH_ERROR`
+melody_store_status_t melody_store_end(melody_store_t *p_store, uint16_t crc, uint32_t *p_melody_idx);
+
+/// @brief Delete a melody. The following ones move one index down.
+/// @param p_store Pointer to the store
+/// @param melody_idx Index of the melody in the store
+/// @return `MELODY_STORE_OK`, `MELODY_STORE_BAD_PARAM` or `MELODY_STORE_FLASH_ERROR`
+melody_store_status_t melody_store_delete(melody_store_t *p_store, uint32_t melody_idx);
+
+/// @brief Get a melody of the store.
+/// @param p_store Pointer to the store
+/// @param melody_idx Index of the melody in the store
+/// @return Pointer to the melody, or NULL if there is no melody with that index
+const melody_t *melody_store_get(const melody_store_t *p_store, uint32_t melody_idx);
+
+/// @brief Get the number of stored melodies.
+/// @param p_store Pointer to the store
+/// @return Stored melodies
+uint32_t melody_store_get_num_melodies(const melody_store_t *p_store);
+
+/// @brief Get the free space of the store.
+/// @param p_store Pointer to the store
+/// @return Bytes left at the end of the log
+uint32_t melody_store_get_free(const melody_store_t *p_store);
+
+/// @brief Find a melody by its name or by the beginning of its name, ignoring case, as melody_registry_find_prefix().
+/// @param p_store Pointer to the store
+/// @param p_prefix Name or beginning of the name
+/// @param whole Only whole names match
+/// @return Index of the melody in the store, or `MELODY_STORE_NOT_FOUND` if none or more than one match
+uint32_t melody_store_find(const melody_store_t *p_store, const char *p_prefix, bool whole);
+
+#endif /* MELODY_STORE_H_ */
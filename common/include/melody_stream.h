@@ -0,0 +1,122 @@
+/**
+ * @file melody_stream.h
+ * @brief Header for melody_stream.c file.
+ *
+ * Melodies played straight from the external storage of port_storage.h, so their length is not limited by the memory
+ * of the MCU. The notes go through a prefetch window of two buffers of `MELODY_STREAM_CHUNK_NOTES` notes: while the
+ * buzzer plays the notes of one buffer, the DMA fills the other one with the next notes, and the roles swap when the
+ * buzzer reaches the end of the first. A melody takes the same RAM whatever its length.
+ *
+ * The next buffer is requested as soon as the buzzer starts a new one, so a read has the time of a whole buffer of
+ * notes to finish, and it needs no CPU time: the notes are there even if the main loop is held by the LCD or the
+ * USART. A note that is not there yet is a stall: the buzzer waits for it in silence. The stream counts the notes
+ * that were ready (hits), the stalls and the longest stall.
+ *
+ * A melody in the storage is a `melody_stream_header_t` followed by its notes, `MELODY_STREAM_NOTE_BYTES` bytes each:
+ * frequency in tenths of Hz (u16) and duration in ms (u16), both in little endian, as uploaded to the melody store.
+ * Melodies are stored one after the other from the start of the storage.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#ifndef MELODY_STREAM_H_
+#define MELODY_STREAM_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Other includes */
+#include "melodies.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define MELODY_STREAM_CHUNK_NOTES 16            /*!< Notes of each buffer of the prefetch window */
+#define MELODY_STREAM_NOTE_BYTES 4              /*!< Bytes of a note in the storage */
+#define MELODY_STREAM_NAME_LENGTH 16            /*!< Longest name, end character included */
+#define MELODY_STREAM_MAGIC 0x4D535452U         /*!< Mark of the header of a melody ("MSTR") */
+#define MELODY_STREAM_NO_CHUNK 0xFFFFFFFFU      /*!< First note of an empty buffer */
+
+/* Typedefs ------------------------------------------------------------------*/
+/// @brief Header of a melody in the storage
+typedef struct {
+    uint32_t magic;                             /*!< `MELODY_STREAM_MAGIC` */
+    uint32_t length;                            /*!< Notes */
+    char name[MELODY_STREAM_NAME_LENGTH];       /*!< Name, ended by '\0' */
+} melody_stream_header_t;
+
+/// @brief Buffer of the prefetch window
+typedef struct {
+    uint8_t notes[MELODY_STREAM_CHUNK_NOTES * MELODY_STREAM_NOTE_BYTES]; /*!< Notes as stored */
+    uint32_t first_note;                        /*!< Index of the first note, or `MELODY_STREAM_NO_CHUNK` */
+    bool loading;                               /*!< The DMA is filling it */
+} melody_stream_chunk_t;
+
+/// @brief Melody being streamed
+typedef struct {
+    melody_t melody;                            /*!< Name and length for the players; it has no notes in memory */
+    char name[MELODY_STREAM_NAME_LENGTH];       /*!< Name */
+    uint32_t address;                           /*!< Position of the first note in the storage */
+    melody_stream_chunk_t chunks[2];            /*!< Prefetch window */
+    uint32_t hits;                              /*!< Notes that were ready when the buzzer needed them */
+    uint32_t stalls;                            /*!< Notes the buzzer had to wait for */
+    bool stalled;                               /*!< The buzzer is waiting for a note */
+    uint32_t stall_cycles;                      /*!< Cycle counter when the current stall started */
+    uint32_t max_stall_cycles;                  /*!< Longest stall */
+} melody_stream_t;
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Initialize a stream without melody and the external storage.
+/// @param p_stream Pointer to the stream
+void melody_stream_init(melody_stream_t *p_stream);
+
+/// @brief Find a melody in the storage.
+/// @param index Position of the melody in the storage, from 0
+/// @param p_address Pointer to store the position of its header
+/// @return true if there is a melody with that index
+bool melody_stream_find(uint32_t index, uint32_t *p_address);
+
+/// @brief Open a melody of the storage and start reading its first notes. The statistics are reset.
+/// @param p_stream Pointer to the stream
+/// @param address Position of the header of the melody (see melody_stream_find())
+/// @return true if there is a valid melody at that position
+bool melody_stream_open(melody_stream_t *p_stream, uint32_t address);
+
+/// @brief Get the melody of a stream, to be given to the players with its name and length.
+/// @param p_stream Pointer to the stream
+/// @return Pointer to the melody; its notes and durations are NULL
+const melody_t *melody_stream_get_melody(const melody_stream_t *p_stream);
+
+/// @brief Check if a note is in the prefetch window. Otherwise it is counted as a stall (once) and read.
+/// @param p_stream Pointer to the stream
+/// @param note_index Index of the note
+/// @return true if the note can be taken with melody_stream_get_note()
+bool melody_stream_is_ready(melody_stream_t *p_stream, uint32_t note_index);
+
+/// @brief Take a note from the prefetch window and request the next notes if the other buffer is free.
+/// @param p_stream Pointer to the stream
+/// @param note_index Index of the note, ready (see melody_stream_is_ready())
+/// @param p_frequency Pointer to store the frequency in Hz
+/// @param p_duration Pointer to store the duration in ms
+/// @return true if the note was taken, false if it was not ready (a stall)
+bool melody_stream_get_note(melody_stream_t *p_stream, uint32_t note_index, double *p_frequency, uint32_t *p_duration);
+
+/// @brief Get the notes that were ready when the buzzer needed them.
+/// @param p_stream Pointer to the stream
+/// @return Hits since the stream was opened
+uint32_t melody_stream_get_hits(const melody_stream_t *p_stream);
+
+/// @brief Get the notes the buzzer had to wait for.
+/// @param p_stream Pointer to the stream
+/// @return Stalls since the stream was opened
+uint32_t melody_stream_get_stalls(const melody_stream_t *p_stream);
+
+/// @brief Get the longest wait for a note.
+/// @param p_stream Pointer to the stream
+/// @return Core clock cycles
+uint32_t melody_stream_get_max_stall_cycles(const melody_stream_t *p_stream);
+
+#endif /* MELODY_STREAM_H_ */
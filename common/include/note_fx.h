@@ -0,0 +1,97 @@
+/**
+ * @file note_fx.h
+ * @brief Header for note_fx.c file.
+ *
+ * Effects of a note that change its pitch while it sounds: vibrato, a slide to the pitch of the next note and an
+ * arpeggio over a chord. The port renders them from the same control-rate interrupt as the envelope (see envelope.h):
+ * each tick `note_fx_tick()` gives the auto-reload of the PWM timer, which takes it at the end of the period in course.
+ *
+ * All the floating point is in `note_fx_start()`, when the note starts: it fills a table of the relative change of the
+ * period along a cycle of the vibrato, the ratio of the period of each note of the arpeggio and the ratio of the period
+ * from a tick to the next of the slide. A tick only multiplies by them and shifts.
+ *
+ * The prescaler of the note is kept for the whole note, so that only the auto-reload changes. `note_fx_start()` gives
+ * the largest period of the effects, relative to the one of the note, for the port to pick a prescaler that keeps it
+ * in 16 bits.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#ifndef NOTE_FX_H_
+#define NOTE_FX_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define NOTE_FX_VIBRATO (1U << 0)       /*!< The pitch goes up and down around the note */
+#define NOTE_FX_SLIDE (1U << 1)         /*!< The pitch slides to the one of the next note along the note */
+#define NOTE_FX_ARPEGGIO (1U << 2)      /*!< The pitch cycles over the note and two intervals */
+
+#define NOTE_FX_SINE_LENGTH 32U         /*!< Steps of a cycle of the vibrato, a power of 2 */
+#define NOTE_FX_CHORD_LENGTH 3U         /*!< Notes of the arpeggio: the note and its two intervals */
+#define NOTE_FX_ARPEGGIO_MS 20U         /*!< Time of each note of the arpeggio */
+#define NOTE_FX_COUNT_BITS 8U           /*!< Fraction bits of the period in counts of the timer */
+
+/* Typedefs ------------------------------------------------------------------*/
+/// @brief Effects of a note, as written in a melody
+typedef struct {
+    uint8_t flags;              /*!< Effects, `NOTE_FX_*` bits. The vibrato adds up to the slide or the arpeggio. */
+    uint8_t vibrato_cents;      /*!< Depth of the vibrato, from the note to the highest pitch, in cents */
+    uint8_t vibrato_rate;       /*!< Cycles of the vibrato per second, in tenths of Hz */
+    int8_t arpeggio[NOTE_FX_CHORD_LENGTH - 1];  /*!< Semitones of the second and third notes of the chord */
+} note_fx_t;
+
+/// @brief Effects of the note that sounds, worked out when it starts
+typedef struct {
+    uint8_t flags;                                  /*!< Effects, `NOTE_FX_*` bits, 0 for none */
+    uint32_t count;                                 /*!< Period of the note in counts of the timer, slid every tick */
+    uint32_t target;                                /*!< Period at the end of the slide */
+    uint32_t slide_ratio;                           /*!< Ratio of the period from a tick to the next, Q30 */
+    uint32_t slide_ticks;                           /*!< Ticks left of the slide */
+    uint32_t vibrato_phase;                         /*!< Phase of the vibrato, a cycle in 2^32 */
+    uint32_t vibrato_step;                          /*!< Phase per tick */
+    int16_t vibrato_deltas[NOTE_FX_SINE_LENGTH];    /*!< Relative change of the period along a cycle, Q16 */
+    uint32_t chord[NOTE_FX_CHORD_LENGTH];           /*!< Ratio of the period of each note of the arpeggio, Q16 */
+    uint8_t chord_index;                            /*!< Note of the arpeggio that sounds */
+    uint16_t chord_ticks;                           /*!< Ticks of each note of the arpeggio */
+    uint16_t chord_ticks_left;                      /*!< Ticks left of the note of the arpeggio that sounds */
+} note_fx_state_t;
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Work out the effects of a note that starts. `note_fx_set_count()` must follow, with the prescaler chosen.
+/// @param p_state Pointer to the state of the effects
+/// @param p_fx Effects of the note, NULL for none
+/// @param rate_hz Ticks per second
+/// @param next_ratio Period of the next note over the one of this note, 0 if there is none to slide to
+/// @param duration_ms Duration of the note, the time of the slide
+/// @return Largest period of the effects over the one of the note, 1 or more
+double note_fx_start(note_fx_state_t *p_state, const note_fx_t *p_fx, uint32_t rate_hz, double next_ratio,
+                     uint32_t duration_ms);
+
+/// @brief Set the period of the note in counts of the timer, for the prescaler chosen.
+/// @param p_state Pointer to the state of the effects
+/// @param count Period of the note over `PSC + 1`, that is `ARR + 1` without rounding
+/// @return Auto-reload of the first tick
+uint32_t note_fx_set_count(note_fx_state_t *p_state, double count);
+
+/// @brief Advance the effects one tick. Without divisions or loops.
+/// @param p_state Pointer to the state of the effects
+/// @return Auto-reload, from 1 to 65535
+uint32_t note_fx_tick(note_fx_state_t *p_state);
+
+/// @brief Drop the effects of the note.
+/// @param p_state Pointer to the state of the effects
+void note_fx_stop(note_fx_state_t *p_state);
+
+/// @brief Check if the note has effects.
+/// @param p_state Pointer to the state of the effects
+/// @return true if the auto-reload changes along the note
+bool note_fx_is_active(const note_fx_state_t *p_state);
+
+#endif /* NOTE_FX_H_ */
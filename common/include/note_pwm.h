@@ -0,0 +1,73 @@
+/**
+ * @file note_pwm.h
+ * @brief Header for note_pwm.c file.
+ *
+ * Prescaler and auto-reload of the PWM timer of the buzzer for a frequency. The timer divides the clock by
+ * `(PSC + 1) * (ARR + 1)`, both of them 16 bits, so the best pair is the product of two factors up to 65536 that is
+ * closest to `clock / frequency`. The error is measured in cents, hundredths of a semitone, as the ear hears it.
+ *
+ * `note_pwm_solve()` tries the products in order of increasing error, from the one nearest to `clock / frequency`,
+ * and stops at the first one that factors; for that product it keeps the largest ARR, so the duty cycle of the
+ * volume has the finest steps. Only integers are divided in the search.
+ *
+ * The notes of `melodies.h` are solved once, when the project is configured: `note_pwm.py` writes their pairs for
+ * `NOTE_PWM_TABLE_CLOCK_HZ` to `note_pwm_table.c`. `note_pwm_find()` takes the pair from the table when the clock and
+ * the frequency are those of a note, and solves any other frequency, e.g. a transposed one, as it comes.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#ifndef NOTE_PWM_H_
+#define NOTE_PWM_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define NOTE_PWM_MAX_COUNT 65536U       /*!< Largest `PSC + 1` and `ARR + 1` of a 16-bit timer */
+#define NOTE_PWM_MIN_PERIOD 2U          /*!< Shortest period in clock cycles, `ARR` of at least 1 */
+#define NOTE_PWM_TABLE_LENGTH 36        /*!< Notes of the table, from `DO3` to `SI5` */
+
+/* Typedefs ------------------------------------------------------------------*/
+/// @brief Timer registers of a note
+typedef struct {
+    double frequency;                   /*!< Frequency of the note in Hz, as in melodies.h */
+    uint16_t psc;                       /*!< Prescaler */
+    uint16_t arr;                       /*!< Auto-reload */
+} note_pwm_t;
+
+/* Global variables ------------------------------------------------------------*/
+extern const uint32_t note_pwm_table_clock_hz;                      /*!< Clock of the table (generated) */
+extern const note_pwm_t note_pwm_table[NOTE_PWM_TABLE_LENGTH];      /*!< Notes by increasing frequency (generated) */
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Get the error of the frequency of a timer, in cents.
+/// @param frequency Frequency wanted, in Hz
+/// @param clock_hz Clock of the timer
+/// @param psc Prescaler
+/// @param arr Auto-reload
+/// @return Cents from the frequency wanted to the one of the timer, negative if the timer is lower
+double note_pwm_get_cents(double frequency, uint32_t clock_hz, uint32_t psc, uint32_t arr);
+
+/// @brief Solve the prescaler and auto-reload with the smallest error in cents.
+/// @param clock_hz Clock of the timer
+/// @param frequency Frequency wanted, in Hz, more than 0. Those out of the range of the timer are saturated.
+/// @param p_psc Pointer to store the prescaler
+/// @param p_arr Pointer to store the auto-reload
+void note_pwm_solve(uint32_t clock_hz, double frequency, uint32_t *p_psc, uint32_t *p_arr);
+
+/// @brief Get the prescaler and auto-reload of a frequency: from the table if it is a note of melodies.h at the clock
+/// of the table, solved otherwise.
+/// @param clock_hz Clock of the timer
+/// @param frequency Frequency wanted, in Hz, more than 0
+/// @param p_psc Pointer to store the prescaler
+/// @param p_arr Pointer to store the auto-reload
+/// @return true if taken from the table
+bool note_pwm_find(uint32_t clock_hz, double frequency, uint32_t *p_psc, uint32_t *p_arr);
+
+#endif /* NOTE_PWM_H_ */
@@ -0,0 +1,148 @@
+/**
+ * @file playlist.h
+ * @brief Header for playlist.c file.
+ *
+ * Order in which the jukebox plays its melodies. The songs are the indices from 0 to the number of melodies (see
+ * `_get_melody()` in fsm_jukebox.c). What follows a song is, in this order:
+ * 1. The same song, with `PLAYLIST_REPEAT_ONE`, unless the user skips it.
+ * 2. The first song of the queue, a ring of `PLAYLIST_QUEUE_LENGTH` songs added with `playlist_enqueue()`.
+ * 3. With shuffle, the next song of a random order of all of them, without repeats until every song has played: a
+ *    Fisher-Yates shuffle, drawn again at the end of each round. Without shuffle, the song after the current one.
+ * 4. At the end of the songs, the first one again with `PLAYLIST_REPEAT_ALL` or when the user skips, nothing with
+ *    `PLAYLIST_REPEAT_OFF`.
+ *
+ * `playlist_peek()` tells the song that follows without moving on, for the buzzer to prepare it, and
+ * `playlist_advance()` moves on to the same song when it starts.
+ *
+ * The random numbers come from a xorshift32 generator: three shifts and three XORs per number. A number below a bound
+ * takes the high half of its product with the bound, and draws again in the few cases that would make some results
+ * more likely than others. A division tells those cases, only when the low half of the product is below the bound.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#ifndef PLAYLIST_H_
+#define PLAYLIST_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define PLAYLIST_MAX_SONGS 16U      /*!< Songs of the playlist: the registry and the store */
+#define PLAYLIST_QUEUE_LENGTH 16U   /*!< Songs of the queue, a power of 2 */
+#define PLAYLIST_NONE 0xFFFFFFFFU   /*!< No song follows */
+
+/* Enums */
+/// @brief What happens at the end of a song
+typedef enum {
+    PLAYLIST_REPEAT_OFF = 0,    /*!< The next song, and nothing after the last one */
+    PLAYLIST_REPEAT_ONE,        /*!< The same song again */
+    PLAYLIST_REPEAT_ALL,        /*!< The next song, and the first one again after the last one */
+} playlist_repeat_t;
+
+/* Typedefs ------------------------------------------------------------------*/
+/// @brief Playlist of the jukebox
+typedef struct {
+    uint8_t queue[PLAYLIST_QUEUE_LENGTH];   /*!< Songs added by the user, ring buffer */
+    uint32_t head;                          /*!< Position of the first song of the queue */
+    uint32_t queue_length;                  /*!< Songs in the queue */
+    uint8_t order[PLAYLIST_MAX_SONGS];      /*!< Random order of the songs of the round in course */
+    uint32_t position;                      /*!< Position in `order` of the next song */
+    uint32_t num_songs;                     /*!< Songs of the playlist */
+    playlist_repeat_t repeat;               /*!< What happens at the end of a song */
+    bool shuffle;                           /*!< Random order */
+    uint32_t random_state;                  /*!< State of the xorshift32 generator, never 0 */
+} playlist_t;
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Initialize a playlist in order, without repeat and with the queue empty.
+/// @param p_playlist Pointer to the playlist
+/// @param num_songs Songs of the playlist, up to `PLAYLIST_MAX_SONGS`
+/// @param seed Seed of the random numbers. 0 is taken as another value.
+void playlist_init(playlist_t *p_playlist, uint32_t num_songs, uint32_t seed);
+
+/// @brief Mix a seed into the random numbers, e.g. the cycle counter when the user presses a button.
+/// @param p_playlist Pointer to the playlist
+/// @param seed Value to mix in
+void playlist_seed(playlist_t *p_playlist, uint32_t seed);
+
+/// @brief Change the number of songs. The songs of the queue that no longer exist are dropped and the shuffle starts
+/// a new round.
+/// @param p_playlist Pointer to the playlist
+/// @param num_songs Songs of the playlist, up to `PLAYLIST_MAX_SONGS`
+void playlist_set_num_songs(playlist_t *p_playlist, uint32_t num_songs);
+
+/// @brief Set what happens at the end of a song.
+/// @param p_playlist Pointer to the playlist
+/// @param repeat Repeat mode
+void playlist_set_repeat(playlist_t *p_playlist, playlist_repeat_t repeat);
+
+/// @brief Get what happens at the end of a song.
+/// @param p_playlist Pointer to the playlist
+/// @return Repeat mode
+playlist_repeat_t playlist_get_repeat(const playlist_t *p_playlist);
+
+/// @brief Play the songs in a random order, or in order. Turning it on starts a new round.
+/// @param p_playlist Pointer to the playlist
+/// @param shuffle true for a random order
+void playlist_set_shuffle(playlist_t *p_playlist, bool shuffle);
+
+/// @brief Check if the songs play in a random order.
+/// @param p_playlist Pointer to the playlist
+/// @return true if they play in a random order
+bool playlist_get_shuffle(const playlist_t *p_playlist);
+
+/// @brief Add a song at the end of the queue.
+/// @param p_playlist Pointer to the playlist
+/// @param song Song
+/// @return false if the queue is full or the song does not exist
+bool playlist_enqueue(playlist_t *p_playlist, uint32_t song);
+
+/// @brief Take the first song of the queue.
+/// @param p_playlist Pointer to the playlist
+/// @param p_song Pointer to store the song
+/// @return false if the queue is empty
+bool playlist_dequeue(playlist_t *p_playlist, uint32_t *p_song);
+
+/// @brief Empty the queue.
+/// @param p_playlist Pointer to the playlist
+void playlist_clear(playlist_t *p_playlist);
+
+/// @brief Get the number of songs of the queue.
+/// @param p_playlist Pointer to the playlist
+/// @return Songs in the queue
+uint32_t playlist_get_queue_length(const playlist_t *p_playlist);
+
+/// @brief Get a song of the queue.
+/// @param p_playlist Pointer to the playlist
+/// @param idx Position in the queue, 0 for the first one
+/// @return Song, or `PLAYLIST_NONE` if the queue is shorter
+uint32_t playlist_get_queued(const playlist_t *p_playlist, uint32_t idx);
+
+/// @brief Get the song that follows another one, without moving on. At the end of a round of the shuffle it draws the
+/// next round, which `playlist_advance()` then follows.
+/// @param p_playlist Pointer to the playlist
+/// @param current Song that plays, or `PLAYLIST_NONE`
+/// @param skip true if the user skips the song: it does not repeat and the playlist starts again after the last one
+/// @return Next song, or `PLAYLIST_NONE` if nothing follows
+uint32_t playlist_peek(playlist_t *p_playlist, uint32_t current, bool skip);
+
+/// @brief Move on to the song that follows another one: the same as `playlist_peek()` with the same parameters.
+/// @param p_playlist Pointer to the playlist
+/// @param current Song that plays, or `PLAYLIST_NONE`
+/// @param skip true if the user skips the song
+/// @return Next song, or `PLAYLIST_NONE` if nothing follows
+uint32_t playlist_advance(playlist_t *p_playlist, uint32_t current, bool skip);
+
+/// @brief Draw a random number from 0 to `bound - 1`, all of them equally likely.
+/// @param p_playlist Pointer to the playlist, owner of the generator
+/// @param bound Number of values. 0 and 1 give 0.
+/// @return Random number
+uint32_t playlist_random(playlist_t *p_playlist, uint32_t bound);
+
+#endif /* PLAYLIST_H_ */
@@ -0,0 +1,131 @@
+/**
+ * @file settings_store.h
+ * @brief Header for settings_store.c file.
+ *
+ * Settings and scores kept across resets: a key/value store of 32-bit values in the two flash sectors of the settings
+ * of port_flash.h, used in turns. The values live in RAM; a change only marks its key, and `settings_store_flush()`
+ * appends a record per marked key at the end of the log of the active sector. Nothing already written is rewritten,
+ * so a reset in the middle of a write loses that write at most. A record is
+ *
+ * | Field | Bytes | Content |
+ * |-------|-------|---------|
+ * | `key`, `length` | 1 + 1 | Key, or `SETTINGS_STORE_CHECKPOINT`, and bytes of the value. Written first. |
+ * | value | `length` | Value of the key; of a checkpoint, the mask of the keys with a value and their values |
+ * | `crc` | 2 | CRC-16/CCITT-FALSE of the rest of the record. Written last. |
+ *
+ * The sector starts with a header, and the log is split in blocks of `SETTINGS_STORE_BLOCK_SIZE` bytes. No record
+ * crosses the end of a block, and the first record of every block is a checkpoint with every value. The blocks fill in
+ * order, so the last one in use is found by a binary search on their first halfword, and mounting only reads the
+ * records from the last block that starts with a valid checkpoint: `log2(blocks)` reads and one block of records,
+ * whatever the size of the log. Records with a wrong CRC are skipped, and a broken first halfword ends its block.
+ *
+ * When the sector is full, the values are compacted into the other one: it is erased, it gets a header with the
+ * next sequence number and a checkpoint, and then the commit mark of its header. Mounting takes the committed sector
+ * with the highest sequence, so until the commit the previous sector is still the valid one.
+ *
+ * An erase stalls the CPU (see port_flash.h), so `settings_store_flush()` only erases when the caller allows it, e.g.
+ * when nothing plays; otherwise the changes wait in RAM. A record costs a few halfwords of 16 us.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#ifndef SETTINGS_STORE_H_
+#define SETTINGS_STORE_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define SETTINGS_STORE_MAX_KEYS 16U         /*!< Keys of the store, from 0 */
+#define SETTINGS_STORE_BLOCK_SIZE 1024U     /*!< Bytes of a block of the log, each one starting with a checkpoint */
+#define SETTINGS_STORE_MAGIC 0x5354U        /*!< Mark of the header of a sector ("ST") */
+#define SETTINGS_STORE_COMMITTED 0xC0DEU    /*!< Mark of a sector whose first checkpoint is complete */
+#define SETTINGS_STORE_CHECKPOINT 0xFEU     /*!< Key of a checkpoint */
+#define SETTINGS_STORE_DELAY_MS 2000U       /*!< Time without changes before they are due, so that a burst of changes takes one record */
+#define SETTINGS_STORE_NO_SECTOR 0xFFFFFFFFU /*!< No sector in use */
+
+/* Enums */
+/// @brief Result of a flush
+typedef enum {
+    SETTINGS_STORE_OK = 0,          /*!< Every change is in the flash */
+    SETTINGS_STORE_BUSY,            /*!< The changes need an erase, not allowed now: they wait in RAM */
+    SETTINGS_STORE_FLASH_ERROR      /*!< The flash could not be written: the changes are only in RAM */
+} settings_store_status_t;
+
+/// @brief State of the sector that is not in use
+typedef enum {
+    SETTINGS_STORE_SPARE_UNKNOWN = 0,   /*!< Not checked since the mount */
+    SETTINGS_STORE_SPARE_ERASED,        /*!< Erased: it can take the values without an erase */
+    SETTINGS_STORE_SPARE_USED,          /*!< Written: it needs an erase */
+} settings_store_spare_t;
+
+/* Typedefs ------------------------------------------------------------------*/
+/// @brief Header of a sector in the flash
+typedef struct {
+    uint16_t magic;         /*!< `SETTINGS_STORE_MAGIC` */
+    uint16_t commit;        /*!< `SETTINGS_STORE_COMMITTED` once the first checkpoint is complete */
+    uint32_t sequence;      /*!< Number of the sector, one more at each compaction */
+    uint32_t reserved[2];   /*!< Erased */
+} settings_store_header_t;
+
+/// @brief Values of the store and position of the log
+typedef struct {
+    uint32_t values[SETTINGS_STORE_MAX_KEYS];   /*!< Value of each key */
+    uint32_t present;                           /*!< Mask of the keys with a value */
+    uint32_t dirty;                             /*!< Mask of the keys changed since the last flush */
+    uint32_t changed_ms;                        /*!< Time of the last change */
+    uint32_t sector;                            /*!< Sector in use, or `SETTINGS_STORE_NO_SECTOR` */
+    uint32_t sequence;                          /*!< Sequence number of the sector in use */
+    uint32_t block;                             /*!< Block of the end of the log */
+    uint32_t end;                               /*!< End of the log: position of the next record */
+    bool checkpointed;                          /*!< The block of the end starts with a valid checkpoint */
+    settings_store_spare_t spare;               /*!< State of the other sector */
+    bool waiting;                               /*!< The changes wait for an erase that was not allowed */
+    uint32_t replayed;                          /*!< Records read by the last mount */
+    uint32_t written;                           /*!< Records written since the mount, checkpoints included */
+    uint32_t compactions;                       /*!< Compactions since the mount */
+} settings_store_t;
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Read the log of the flash and load the values.
+/// @param p_store Pointer to the store
+void settings_store_mount(settings_store_t *p_store);
+
+/// @brief Get the value of a key.
+/// @param p_store Pointer to the store
+/// @param key Key
+/// @param default_value Value if the key has none
+/// @return Value
+uint32_t settings_store_get(const settings_store_t *p_store, uint32_t key, uint32_t default_value);
+
+/// @brief Set the value of a key in RAM. A new value marks the key for the next flush.
+/// @param p_store Pointer to the store
+/// @param key Key, below `SETTINGS_STORE_MAX_KEYS`
+/// @param value Value
+/// @param now_ms Current time
+void settings_store_set(settings_store_t *p_store, uint32_t key, uint32_t value, uint32_t now_ms);
+
+/// @brief Check if there are changes that are not in the flash.
+/// @param p_store Pointer to the store
+/// @return true if any key is marked
+bool settings_store_is_pending(const settings_store_t *p_store);
+
+/// @brief Check if the changes are due: `SETTINGS_STORE_DELAY_MS` without a new one, and no erase to wait for.
+/// @param p_store Pointer to the store
+/// @param now_ms Current time
+/// @param can_erase true if a sector may be erased now
+/// @return true if they should be flushed
+bool settings_store_is_due(const settings_store_t *p_store, uint32_t now_ms, bool can_erase);
+
+/// @brief Write the marked keys to the flash, compacting the log into the other sector if it is full.
+/// @param p_store Pointer to the store
+/// @param can_erase true if a sector may be erased now
+/// @return `SETTINGS_STORE_OK`, `SETTINGS_STORE_BUSY` or `SETTINGS_STORE_FLASH_ERROR`
+settings_store_status_t settings_store_flush(settings_store_t *p_store, bool can_erase);
+
+#endif /* SETTINGS_STORE_H_ */
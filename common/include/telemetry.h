@@ -0,0 +1,152 @@
+/**
+ * @file telemetry.h
+ * @brief Header for telemetry.c file.
+ *
+ * Periodic status records of the jukebox, pushed as frames of the binary protocol (frame.h) with opcode
+ * `FRAME_OP_RECORD` and the number of the record as sequence number. A record holds `TELEMETRY_NUM_FIELDS` fields
+ * of 8 or 16 bits. Its payload is a byte with a bit per field, set if the field changed since the previous record,
+ * followed by the changed fields in order (16-bit fields in little endian):
+ *
+ * | Field | Bytes | Content |
+ * |-------|-------|---------|
+ * | `TELEMETRY_STATES` | 2 | States of the FSMs, a nibble each: jukebox, button, USART and buzzer from the lowest |
+ * | `TELEMETRY_MELODY` | 1 | Index of the melody |
+ * | `TELEMETRY_NOTE` | 2 | Index of the note |
+ * | `TELEMETRY_VOLUME` | 1 | Volume in percent |
+ * | `TELEMETRY_SPEED` | 2 | Speed in percent |
+ * | `TELEMETRY_RX_OVERFLOWS` | 2 | Messages received that did not fit in the input buffers |
+ * | `TELEMETRY_TX_OVERFLOWS` | 2 | Frames that did not fit in the transmission queue |
+ * | `TELEMETRY_LOOPS` | 2 | Iterations of the main loop in the last second |
+ *
+ * A record with no change takes 1 byte of payload, 7 bytes on the line. The first record and every
+ * `TELEMETRY_KEYFRAME_INTERVAL`-th one carry every field, so that a host that missed a record resynchronises.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Other includes */
+#include "frame.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define TELEMETRY_NUM_FIELDS 8                                  /*!< Fields of a record */
+#define TELEMETRY_ALL_FIELDS ((1U << TELEMETRY_NUM_FIELDS) - 1) /*!< Mask of a record with every field */
+#define TELEMETRY_MAX_PAYLOAD 15                                /*!< Payload of a record with every field: mask and fields */
+#define TELEMETRY_KEYFRAME_INTERVAL 10                          /*!< Records between records with every field */
+#define TELEMETRY_MIN_PERIOD_MS 10                              /*!< Shortest period between records */
+#define TELEMETRY_MAX_PERIOD_MS 60000                           /*!< Longest period between records */
+#define TELEMETRY_LOOPS_WINDOW_MS 1000                          /*!< Window to count the iterations of the main loop */
+
+/* Enums */
+/// @brief Fields of a record, in the order of the payload
+enum TELEMETRY_FIELDS {
+    TELEMETRY_STATES = 0,       /*!< States of the FSMs, a nibble each */
+    TELEMETRY_MELODY,           /*!< Index of the melody */
+    TELEMETRY_NOTE,             /*!< Index of the note */
+    TELEMETRY_VOLUME,           /*!< Volume in percent */
+    TELEMETRY_SPEED,            /*!< Speed in percent */
+    TELEMETRY_RX_OVERFLOWS,     /*!< Messages received that did not fit */
+    TELEMETRY_TX_OVERFLOWS,     /*!< Frames that did not fit in the transmission queue */
+    TELEMETRY_LOOPS             /*!< Iterations of the main loop per second */
+};
+
+/* Typedefs ------------------------------------------------------------------*/
+/// @brief Status record
+typedef struct{
+    uint16_t fields[TELEMETRY_NUM_FIELDS];  /*!< Fields, indexed by `TELEMETRY_FIELDS` */
+} telemetry_record_t;
+
+/// @brief Sender of records, in the jukebox
+typedef struct{
+    uint32_t period_ms;         /*!< Period between records. 0 if the telemetry is off */
+    uint32_t next_ms;           /*!< Time of the next record */
+    uint8_t seq;                /*!< Sequence number of the next record */
+    uint8_t keyframe_countdown; /*!< Records until the next one with every field */
+    telemetry_record_t last;    /*!< Last record sent */
+    uint32_t loops;             /*!< Iterations of the main loop in the current window */
+    uint32_t loops_start_ms;    /*!< Start of the current window */
+    uint16_t loops_per_s;       /*!< Iterations of the main loop per second in the last window */
+} telemetry_t;
+
+/// @brief Receiver of records, in the host
+typedef struct{
+    telemetry_record_t record;  /*!< Last record decoded */
+    bool synced;                /*!< Every field of `record` is known */
+    uint8_t seq;                /*!< Sequence number of the last record */
+    uint32_t records;           /*!< Records decoded */
+    uint32_t lost;              /*!< Records missing from the sequence */
+} telemetry_decoder_t;
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Initialize the telemetry, off.
+/// @param p_telemetry Pointer to the telemetry
+void telemetry_init(telemetry_t *p_telemetry);
+
+/// @brief Start sending records. The first one carries every field.
+/// @param p_telemetry Pointer to the telemetry
+/// @param period_ms Period between records, from `TELEMETRY_MIN_PERIOD_MS` to `TELEMETRY_MAX_PERIOD_MS`
+/// @param now_ms Current time
+/// @return true if the period is valid
+bool telemetry_start(telemetry_t *p_telemetry, uint32_t period_ms, uint32_t now_ms);
+
+/// @brief Stop sending records.
+/// @param p_telemetry Pointer to the telemetry
+void telemetry_stop(telemetry_t *p_telemetry);
+
+/// @brief Check if the telemetry is on.
+/// @param p_telemetry Pointer to the telemetry
+/// @return true if records are being sent
+bool telemetry_is_on(const telemetry_t *p_telemetry);
+
+/// @brief Count an iteration of the main loop.
+/// @param p_telemetry Pointer to the telemetry
+/// @param now_ms Current time
+void telemetry_count_loop(telemetry_t *p_telemetry, uint32_t now_ms);
+
+/// @brief Get the iterations of the main loop per second, in the last complete window.
+/// @param p_telemetry Pointer to the telemetry
+/// @return Iterations per second, saturated at `UINT16_MAX`
+uint16_t telemetry_get_loops_per_s(const telemetry_t *p_telemetry);
+
+/// @brief Check if a record is due.
+/// @param p_telemetry Pointer to the telemetry
+/// @param now_ms Current time
+/// @return true if the telemetry is on and its period has elapsed
+bool telemetry_is_due(const telemetry_t *p_telemetry, uint32_t now_ms);
+
+/// @brief Encode a record with the fields that changed since the previous one, and schedule the next record.
+/// @param p_telemetry Pointer to the telemetry
+/// @param p_record Pointer to the record
+/// @param now_ms Current time
+/// @param p_frame Pointer to store the frame
+void telemetry_encode(telemetry_t *p_telemetry, const telemetry_record_t *p_record, uint32_t now_ms, frame_t *p_frame);
+
+/// @brief Pack the states of the FSMs in the field `TELEMETRY_STATES`.
+/// @param jukebox State of the jukebox FSM
+/// @param button State of the button FSM
+/// @param usart State of the USART FSM
+/// @param buzzer State of the buzzer FSM
+/// @return Field
+uint16_t telemetry_pack_states(int jukebox, int button, int usart, int buzzer);
+
+/// @brief Initialize a decoder, waiting for a record with every field.
+/// @param p_decoder Pointer to the decoder
+void telemetry_decoder_init(telemetry_decoder_t *p_decoder);
+
+/// @brief Decode a record over the previous one.
+/// @param p_decoder Pointer to the decoder
+/// @param p_frame Pointer to the frame
+/// @return true if the frame is a record and every field is known: the record is in `p_decoder->record`
+bool telemetry_decode(telemetry_decoder_t *p_decoder, const frame_t *p_frame);
+
+#endif /* TELEMETRY_H_ */
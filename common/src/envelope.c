@@ -0,0 +1,194 @@
+/**
+ * @file envelope.c
+ * @brief Volume envelope of the notes of the buzzer, applied as the duty cycle of the PWM.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Other libraries */
+#include "envelope.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define ENVELOPE_FULL_RANGE (ENVELOPE_LEVELS << ENVELOPE_FRACTION_BITS)    /*!< Level of the full volume */
+#define ENVELOPE_LEVELS_PER_DB 2U                                           /*!< Inverse of `ENVELOPE_DB_PER_LEVEL` */
+
+/* Global variables */
+/// @brief `asin(10^(-(96 - i) * 0.5 / 20)) / pi` in Q16: the duty cycle whose fundamental is `(96 - i) * 0.5` dB below
+/// the one of 50 %
+const uint16_t envelope_duty_table[ENVELOPE_LEVELS + 1] = {
+    0, 88, 93, 99, 105, 111, 117, 124, 132, 139, 148, 156,
+    166, 176, 186, 197, 209, 221, 234, 248, 263, 278, 295, 312,
+    331, 350, 371, 393, 416, 441, 467, 495, 524, 555, 588, 623,
+    660, 699, 740, 784, 831, 880, 932, 987, 1046, 1108, 1174, 1243,
+    1317, 1395, 1478, 1566, 1659, 1757, 1862, 1972, 2090, 2214, 2346, 2485,
+    2633, 2790, 2957, 3133, 3320, 3519, 3729, 3953, 4190, 4442, 4710, 4994,
+    5297, 5618, 5960, 6324, 6712, 7125, 7566, 8038, 8541, 9081, 9660, 10282,
+    10951, 11675, 12458, 13311, 14243, 15270, 16409, 17688, 19148, 20858, 22949, 25758,
+    32768
+};
+
+/* Private functions */
+
+/**
+ * @brief Step of a ramp over the whole range.
+ *
+ * @param time_ms Time of the ramp
+ * @return Level per tick, the whole range if the ramp is shorter than a tick
+ */
+static uint16_t _step(uint32_t time_ms)
+{
+    uint32_t ticks = time_ms * ENVELOPE_RATE_HZ / 1000U;
+    if (ticks == 0)
+    {
+        return ENVELOPE_FULL_RANGE;
+    }
+    // Rounded up, so the ramp is over within its time
+    return (uint16_t)((ENVELOPE_FULL_RANGE + ticks - 1U) / ticks);
+}
+
+/* Public functions */
+void envelope_init(envelope_t *p_envelope, const envelope_config_t *p_config)
+{
+    envelope_set_config(p_envelope, p_config);
+    envelope_stop(p_envelope);
+}
+
+void envelope_set_config(envelope_t *p_envelope, const envelope_config_t *p_config)
+{
+    uint32_t attenuation = (uint32_t)p_config->sustain_db * ENVELOPE_LEVELS_PER_DB << ENVELOPE_FRACTION_BITS;
+    p_envelope->attenuation = (attenuation > ENVELOPE_FULL_RANGE) ? ENVELOPE_FULL_RANGE : (uint16_t)attenuation;
+    p_envelope->attack_step = _step(p_config->attack_ms);
+    p_envelope->decay_step = _step(p_config->decay_ms);
+    p_envelope->release_step = (p_config->release_ms == 0) ? 0 : _step(p_config->release_ms);
+}
+
+uint32_t envelope_get_level(double volume)
+{
+    if (!(volume > 0))
+    {
+        return 0;
+    }
+    if (volume >= 1.0)
+    {
+        return ENVELOPE_LEVELS;
+    }
+    return (uint32_t)(volume * ENVELOPE_LEVELS + 0.5);
+}
+
+uint32_t envelope_note_on(envelope_t *p_envelope, uint32_t level)
+{
+    if (level > ENVELOPE_LEVELS)
+    {
+        level = ENVELOPE_LEVELS;
+    }
+    p_envelope->peak = (uint16_t)(level << ENVELOPE_FRACTION_BITS);
+    p_envelope->sustain = (p_envelope->peak > p_envelope->attenuation) ? p_envelope->peak - p_envelope->attenuation : 0;
+    p_envelope->gate = UINT32_MAX;
+    p_envelope->stage = (level == 0) ? ENVELOPE_IDLE : ENVELOPE_ATTACK;
+
+    // An attack shorter than a tick starts at the volume of the note
+    p_envelope->level = 0;
+    if (p_envelope->attack_step >= ENVELOPE_FULL_RANGE)
+    {
+        p_envelope->level = p_envelope->peak;
+        p_envelope->stage = (level == 0) ? ENVELOPE_IDLE : ENVELOPE_DECAY;
+    }
+    return envelope_duty_table[p_envelope->level >> ENVELOPE_FRACTION_BITS];
+}
+
+void envelope_set_gate(envelope_t *p_envelope, uint32_t duration_ms)
+{
+    if (p_envelope->release_step == 0)
+    {
+        p_envelope->gate = UINT32_MAX;
+        return;
+    }
+
+    // The release from the volume of the note ends a tick before the note. A note shorter than that is released
+    // from its middle.
+    uint32_t ticks = (uint32_t)((uint64_t)duration_ms * ENVELOPE_RATE_HZ / 1000U);
+    uint32_t release_ticks = (p_envelope->peak + p_envelope->release_step - 1U) / p_envelope->release_step;
+    p_envelope->gate = (ticks > release_ticks + 1U) ? ticks - release_ticks - 1U : ticks / 2U;
+}
+
+void envelope_note_off(envelope_t *p_envelope)
+{
+    if (p_envelope->release_step == 0)
+    {
+        envelope_stop(p_envelope);
+        return;
+    }
+    if (p_envelope->stage != ENVELOPE_IDLE)
+    {
+        p_envelope->stage = ENVELOPE_RELEASE;
+    }
+}
+
+void envelope_stop(envelope_t *p_envelope)
+{
+    p_envelope->stage = ENVELOPE_IDLE;
+    p_envelope->level = 0;
+    p_envelope->gate = UINT32_MAX;
+}
+
+uint32_t envelope_tick(envelope_t *p_envelope)
+{
+    // The gate counts the ticks of the note until the release
+    if ((p_envelope->stage != ENVELOPE_IDLE) && (p_envelope->stage != ENVELOPE_RELEASE))
+    {
+        if (p_envelope->gate == 0)
+        {
+            p_envelope->stage = ENVELOPE_RELEASE;
+        }
+        else if (p_envelope->gate != UINT32_MAX)
+        {
+            p_envelope->gate--;
+        }
+    }
+
+    uint16_t level = p_envelope->level;
+    switch (p_envelope->stage)
+    {
+    case ENVELOPE_ATTACK:
+        level += p_envelope->attack_step;
+        if (level >= p_envelope->peak)
+        {
+            level = p_envelope->peak;
+            p_envelope->stage = ENVELOPE_DECAY;
+        }
+        break;
+    case ENVELOPE_DECAY:
+        if (level > p_envelope->sustain + p_envelope->decay_step)
+        {
+            level -= p_envelope->decay_step;
+        }
+        else
+        {
+            level = p_envelope->sustain;
+            p_envelope->stage = ENVELOPE_SUSTAIN;
+        }
+        break;
+    case ENVELOPE_RELEASE:
+        if (level > p_envelope->release_step)
+        {
+            level -= p_envelope->release_step;
+        }
+        else
+        {
+            level = 0;
+            p_envelope->stage = ENVELOPE_IDLE;
+        }
+        break;
+    default:
+        break;
+    }
+    p_envelope->level = level;
+    return envelope_duty_table[level >> ENVELOPE_FRACTION_BITS];
+}
+
+bool envelope_is_active(const envelope_t *p_envelope)
+{
+    return p_envelope->stage != ENVELOPE_IDLE;
+}
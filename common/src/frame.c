@@ -0,0 +1,197 @@
+/**
+ * @file frame.c
+ * @brief Binary command protocol of the USART: COBS framing and CRC-16.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <string.h>
+
+/* Other libraries */
+#include "frame.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define FRAME_CRC_INIT 0xFFFF       /*!< Initial value of the CRC-16/CCITT-FALSE */
+#define FRAME_CRC_POLY 0x1021       /*!< Polynomial of the CRC-16/CCITT-FALSE */
+#define FRAME_COBS_MAX_CODE 0xFF    /*!< Longest COBS block: 254 bytes without zeros */
+
+/* Private variables */
+
+/// @brief Names of the opcodes, indexed by opcode
+static const char *opcode_names[] = {
+    [FRAME_OP_PLAY] = "play",
+    [FRAME_OP_STOP] = "stop",
+    [FRAME_OP_PAUSE] = "pause",
+    [FRAME_OP_NEXT] = "next",
+    [FRAME_OP_SELECT] = "select",
+    [FRAME_OP_VOLUME] = "volume",
+    [FRAME_OP_SPEED] = "speed",
+    [FRAME_OP_INFO] = "info",
+    [FRAME_OP_TEXT] = "text",
+    [FRAME_OP_TELEMETRY] = "telemetry",
+    [FRAME_OP_UPLOAD_BEGIN] = "upload begin",
+    [FRAME_OP_UPLOAD_DATA] = "upload data",
+    [FRAME_OP_UPLOAD_END] = "upload end",
+};
+
+/* Public functions */
+uint16_t frame_crc16(const uint8_t *p_data, size_t length)
+{
+    return frame_crc16_update(FRAME_CRC_INIT, p_data, length);
+}
+
+uint16_t frame_crc16_update(uint16_t crc, const uint8_t *p_data, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)p_data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ FRAME_CRC_POLY) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t frame_cobs_encode(const uint8_t *p_data, size_t length, uint8_t *p_out)
+{
+    size_t out = 1;         // Next output byte
+    size_t code_idx = 0;    // Position of the code of the current block
+    uint8_t code = 1;       // Length of the current block plus one
+    for (size_t i = 0; i < length; i++)
+    {
+        if (p_data[i] == 0)
+        {
+            p_out[code_idx] = code;
+            code_idx = out++;
+            code = 1;
+            continue;
+        }
+        p_out[out++] = p_data[i];
+        if (++code == FRAME_COBS_MAX_CODE)
+        {
+            p_out[code_idx] = code;
+            code_idx = out++;
+            code = 1;
+        }
+    }
+    p_out[code_idx] = code;
+    return out;
+}
+
+size_t frame_cobs_decode(const uint8_t *p_data, size_t length, uint8_t *p_out, size_t size)
+{
+    size_t in = 0;
+    size_t out = 0;
+    while (in < length)
+    {
+        uint8_t code = p_data[in++];
+        if (code == 0)
+        {
+            return 0;
+        }
+        for (uint8_t i = 1; i < code; i++)
+        {
+            if ((in >= length) || (out >= size) || (p_data[in] == 0))
+            {
+                return 0;
+            }
+            p_out[out++] = p_data[in++];
+        }
+        // Every block but the longest ones and the last one ends with a zero
+        if ((code != FRAME_COBS_MAX_CODE) && (in < length))
+        {
+            if (out >= size)
+            {
+                return 0;
+            }
+            p_out[out++] = 0;
+        }
+    }
+    return out;
+}
+
+size_t frame_encode(const frame_t *p_frame, uint8_t *p_out)
+{
+    uint8_t decoded[FRAME_MAX_DECODED];
+    uint8_t length = (p_frame->length < FRAME_MAX_PAYLOAD) ? p_frame->length : FRAME_MAX_PAYLOAD;
+    decoded[0] = p_frame->opcode;
+    decoded[1] = p_frame->seq;
+    memcpy(&decoded[FRAME_HEADER_LENGTH], p_frame->payload, length);
+    size_t used = FRAME_HEADER_LENGTH + length;
+    uint16_t crc = frame_crc16(decoded, used);
+    decoded[used++] = (uint8_t)(crc & 0xFF);
+    decoded[used++] = (uint8_t)(crc >> 8);
+
+    size_t encoded = frame_cobs_encode(decoded, used, p_out);
+    p_out[encoded++] = FRAME_DELIMITER;
+    return encoded;
+}
+
+bool frame_decode(const uint8_t *p_data, size_t length, frame_t *p_frame)
+{
+    uint8_t decoded[FRAME_MAX_DECODED];
+    size_t used = frame_cobs_decode(p_data, length, decoded, sizeof(decoded));
+    if (used < FRAME_HEADER_LENGTH + FRAME_CRC_LENGTH)
+    {
+        return false;
+    }
+    used -= FRAME_CRC_LENGTH;
+    uint16_t crc = (uint16_t)decoded[used] | ((uint16_t)decoded[used + 1] << 8);
+    if (crc != frame_crc16(decoded, used))
+    {
+        return false;
+    }
+    p_frame->opcode = decoded[0];
+    p_frame->seq = decoded[1];
+    p_frame->length = (uint8_t)(used - FRAME_HEADER_LENGTH);
+    memcpy(p_frame->payload, &decoded[FRAME_HEADER_LENGTH], p_frame->length);
+    return true;
+}
+
+void frame_reply(const frame_t *p_request, uint8_t status, frame_t *p_reply)
+{
+    p_reply->opcode = p_request->opcode | FRAME_REPLY;
+    p_reply->seq = p_request->seq;
+    p_reply->length = 0;
+    frame_put_u8(p_reply, status);
+}
+
+void frame_put_u8(frame_t *p_frame, uint8_t value)
+{
+    if (p_frame->length < FRAME_MAX_PAYLOAD)
+    {
+        p_frame->payload[p_frame->length++] = value;
+    }
+}
+
+void frame_put_u16(frame_t *p_frame, uint16_t value)
+{
+    if (p_frame->length + 2 <= FRAME_MAX_PAYLOAD)
+    {
+        p_frame->payload[p_frame->length++] = (uint8_t)(value & 0xFF);
+        p_frame->payload[p_frame->length++] = (uint8_t)(value >> 8);
+    }
+}
+
+uint16_t frame_get_u16(const frame_t *p_frame, uint8_t offset)
+{
+    if (offset + 2 > p_frame->length)
+    {
+        return 0;
+    }
+    return (uint16_t)p_frame->payload[offset] | ((uint16_t)p_frame->payload[offset + 1] << 8);
+}
+
+const char *frame_get_opcode_name(uint8_t opcode)
+{
+    opcode &= (uint8_t)~FRAME_REPLY;
+    if ((opcode < sizeof(opcode_names) / sizeof(opcode_names[0])) && (opcode_names[opcode] != NULL))
+    {
+        return opcode_names[opcode];
+    }
+    return "?";
+}
@@ -10,35 +10,185 @@
 /* Standard C libraries */
 #include <stdlib.h>
 /* Other libraries */
+#include "port_system.h"
 #include "port_buzzer.h"
 #include "fsm_buzzer.h"
 #include "melodies.h"
+#include "melody_stream.h"
+
+/* Private variables */
+/// @brief Frequency ratio of each semitone of an octave, 2^(k/12), in Q16
+static const uint32_t semitone_ratios[FSM_BUZZER_SEMITONES_PER_OCTAVE] = {
+    65536, 69433, 73562, 77936, 82570, 87480, 92682, 98193, 104032, 110218, 116772, 123715
+};
+
 /* State machine input or transition functions */
 
 
 /* State machine output or action functions */
 
 
-/// @brief Start a note by setting the PWM frequency and the timer duration. 
+/// @brief Set the pitch effects of the current note, if the melody has them. Only the melodies in memory have effects.
+/// The slide goes to the next note, transposed as this one, unless it is the last note or a silence.
+/// @param p_fsm Pointer to an fsm_buzzer_t.
+/// @param duration Duration of the note, with the tempo applied.
+static void _start_note_effects(fsm_buzzer_t *p_fsm, uint32_t duration){
+    const note_fx_t *p_effects = p_fsm->p_melody->p_effects;
+    if(p_effects==NULL){
+        port_buzzer_set_note_effects(p_fsm->buzzer_id, NULL, 0, duration);
+        return;
+    }
+    const note_fx_t *p_fx = &p_effects[p_fsm->note_index];
+    double next_freq = 0;
+    if((p_fx->flags & NOTE_FX_SLIDE) && (p_fsm->note_index + 1U < p_fsm->p_melody->melody_length)){
+        next_freq = p_fsm->p_melody->p_notes[p_fsm->note_index + 1U] * (double)p_fsm->pitch_ratio * (1.0 / FSM_BUZZER_Q16_ONE);
+    }
+    port_buzzer_set_note_effects(p_fsm->buzzer_id, p_fx, next_freq, duration);
+}
+
+/// @brief Apply the tempo to the duration of a note.
+/// @param p_fsm Pointer to an fsm_buzzer_t.
+/// @param duration Duration of the note as written, in milliseconds.
+/// @return Duration to play, in milliseconds.
+static uint32_t _scale_duration(fsm_buzzer_t *p_fsm, uint32_t duration){
+    uint64_t scaled = ((uint64_t)duration * p_fsm->duration_scale + FSM_BUZZER_Q16_ONE / 2) >> 16;
+    return (scaled > UINT32_MAX) ? UINT32_MAX : (uint32_t)scaled;
+}
+
+/// @brief Get the buzzers a melody in memory plays on, from `buzzer_id` on.
+/// @param p_fsm Pointer to an fsm_buzzer_t.
+/// @param p_melody Pointer to the melody.
+/// @return Number of voices, 1 or more.
+static uint8_t _get_melody_voices(fsm_buzzer_t *p_fsm, const melody_t *p_melody){
+    if(p_melody->p_tracks==NULL){
+        return 1;
+    }
+    uint32_t num_voices = 1U + p_melody->num_tracks;
+    uint32_t free_voices = BUZZERS_LENGTH - p_fsm->buzzer_id;
+    return (uint8_t)((num_voices < free_voices) ? num_voices : free_voices);
+}
+
+/// @brief Get the buzzers the current melody plays on: one for the melody and one for each of its other tracks, as
+/// long as there are buzzers left after `buzzer_id`. Streamed melodies have a single track.
+/// @param p_fsm Pointer to an fsm_buzzer_t.
+/// @return Number of voices, 1 or more.
+static uint8_t _get_num_voices(fsm_buzzer_t *p_fsm){
+    if(p_fsm->p_stream!=NULL){
+        return 1;
+    }
+    return _get_melody_voices(p_fsm, p_fsm->p_melody);
+}
+
+/// @brief Silence every voice of the melody.
+/// @param p_fsm Pointer to an fsm_buzzer_t.
+static void _stop_voices(fsm_buzzer_t *p_fsm){
+    for(uint32_t voice = 0; voice < p_fsm->num_voices; voice++){
+        port_buzzer_stop(p_fsm->buzzer_id + voice);
+    }
+}
+
+/// @brief Stage the first note of the next melody in the port, with the tempo, the transpose and the volume of now.
+/// @param p_fsm Pointer to an fsm_buzzer_t.
+static void _stage_next_melody(fsm_buzzer_t *p_fsm){
+    const melody_t *p_next = p_fsm->p_next_melody;
+    port_buzzer_clear_stage(p_fsm->buzzer_id);
+    if(p_next->melody_length==0){
+        return;
+    }
+    double ratio = (double)p_fsm->pitch_ratio * (1.0 / FSM_BUZZER_Q16_ONE);
+    uint8_t num_voices = _get_melody_voices(p_fsm, p_next);
+    port_buzzer_stage_note(p_fsm->buzzer_id, p_next->p_notes[0] * ratio, p_fsm->player_volume);
+    for(uint32_t track = 1; track < num_voices; track++){
+        port_buzzer_stage_note(p_fsm->buzzer_id + track, p_next->p_tracks[track - 1][0] * ratio, p_fsm->player_volume);
+    }
+    port_buzzer_stage_duration(p_fsm->buzzer_id, _scale_duration(p_fsm, p_next->p_durations[0]));
+}
+
+/// @brief Make the next melody the current one.
+/// @param p_fsm Pointer to an fsm_buzzer_t.
+static void _take_next_melody(fsm_buzzer_t *p_fsm){
+    p_fsm->p_melody = (melody_t *)p_fsm->p_next_melody;
+    p_fsm->p_next_melody = NULL;
+    p_fsm->p_stream = NULL;
+    p_fsm->note_index = 0;
+    p_fsm->next_started = true;
+}
+
+/// @brief Drop the next melody and its staged note.
+/// @param p_fsm Pointer to an fsm_buzzer_t.
+static void _drop_next_melody(fsm_buzzer_t *p_fsm){
+    p_fsm->p_next_melody = NULL;
+    p_fsm->next_started = false;
+    port_buzzer_clear_stage(p_fsm->buzzer_id);
+}
+
+/// @brief Start a note by setting the PWM frequency and the timer duration. With other tracks, the note of each one
+/// is armed on its buzzer and they all start with the timer duration. The tempo and the transpose are applied
+/// with the Q16 factors worked out by their setters, so a change is heard from the next note and costs no division.
 /// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t. 
 /// @param freq Frequency of the note to play. 
 /// @param duration Duration of the note to play. 
 static void _start_note 	(fsm_t *p_this, double freq, uint32_t duration){   
     fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
 
-    duration = (uint32_t)((double)duration/p_fsm->player_speed);
-    port_buzzer_set_note_frequency(p_fsm->buzzer_id, freq, p_fsm->player_volume);
+    duration = _scale_duration(p_fsm, duration);
+    freq = freq * (double)p_fsm->pitch_ratio * (1.0 / FSM_BUZZER_Q16_ONE);
+    p_fsm->num_voices = _get_num_voices(p_fsm);
+    if(p_fsm->num_voices > 1){
+        // Every voice waits for the note duration timer, to start at the same clock edge
+        port_buzzer_arm_note(p_fsm->buzzer_id, freq, p_fsm->player_volume);
+        for(uint32_t track = 1; track < p_fsm->num_voices; track++){
+            double track_freq = p_fsm->p_melody->p_tracks[track - 1][p_fsm->note_index];
+            track_freq = track_freq * (double)p_fsm->pitch_ratio * (1.0 / FSM_BUZZER_Q16_ONE);
+            port_buzzer_arm_note(p_fsm->buzzer_id + track, track_freq, p_fsm->player_volume);
+        }
+    }
+    else{
+        port_buzzer_set_note_frequency(p_fsm->buzzer_id, freq, p_fsm->player_volume);
+    }
+    _start_note_effects(p_fsm, duration);
+    if(p_fsm->note_watch){
+        p_fsm->note_cycles = port_system_get_cycles();
+        p_fsm->note_watch = false;
+        p_fsm->note_watched = true;
+    }
     port_buzzer_set_note_duration(p_fsm->buzzer_id, duration);
+    // The first note of the next melody is staged during the last one, for the port to start it without a gap
+    if((p_fsm->p_next_melody!=NULL)&&(p_fsm->note_index + 1U == p_fsm->p_melody->melody_length)){
+        _stage_next_melody(p_fsm);
+    }
 }
 
 
+/// @brief Check if the current note can be played: always for a melody in memory, once read for a streamed one.
+/// @param p_fsm Pointer to an fsm_buzzer_t.
+/// @return True if the note is available.
+static bool _is_note_ready(fsm_buzzer_t *p_fsm){
+    if(p_fsm->p_stream==NULL){
+        return true;
+    }
+    return melody_stream_is_ready(p_fsm->p_stream, p_fsm->note_index);
+}
+
+/// @brief Get the current note of the melody, from memory or from the stream.
+/// @param p_fsm Pointer to an fsm_buzzer_t.
+/// @param p_freq Pointer to store the frequency of the note.
+/// @param p_duration Pointer to store the duration of the note.
+static void _get_note(fsm_buzzer_t *p_fsm, double *p_freq, uint32_t *p_duration){
+    if(p_fsm->p_stream!=NULL){
+        melody_stream_get_note(p_fsm->p_stream, p_fsm->note_index, p_freq, p_duration);
+        return;
+    }
+    *p_freq = p_fsm->p_melody->p_notes[p_fsm->note_index];
+    *p_duration = p_fsm->p_melody->p_durations[p_fsm->note_index];
+}
 
 /// @brief Check a melody is set to start. 
 /// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t. 
 /// @return 
 static bool check_melody_start 	(fsm_t *p_this){
     fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
-    return !((p_fsm->p_melody)==NULL);
+    return !((p_fsm->p_melody)==NULL)&&_is_note_ready(p_fsm);
 }
 
 /// @brief Check if the player is set to start. 
@@ -46,7 +196,7 @@ static bool check_melody_start 	(fsm_t *p_this){
 /// @return 
 static bool check_player_start(fsm_t *p_this){
     fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
-    return !((p_fsm->p_melody)==NULL)&&(p_fsm->user_action==1);
+    return !((p_fsm->p_melody)==NULL)&&(p_fsm->user_action==1)&&_is_note_ready(p_fsm);
 }
 
 /// @brief Check if it has been reached the end of the melody. 
@@ -68,6 +218,22 @@ static bool check_note_end 	(fsm_t *p_this){
     return port_buzzer_get_note_timeout(p_fsm->buzzer_id);;
 }
 
+/// @brief Check if the port has started the staged first note of the next melody, at the end of the last note.
+/// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t. 
+/// @return 
+static bool check_next_melody_started(fsm_t *p_this){
+    fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
+    return port_buzzer_get_staged_start(p_fsm->buzzer_id);
+}
+
+/// @brief Check if the melody has ended and there is a next melody to play: its first note was not staged in time.
+/// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t. 
+/// @return 
+static bool check_next_melody(fsm_t *p_this){
+    fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
+    return (p_fsm->p_next_melody!=NULL)&&(p_fsm->user_action == PLAY)&&check_end_melody(p_this);
+}
+
 /// @brief Check if the player is set to pause. 
 /// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t. 
 /// @return 
@@ -82,7 +248,8 @@ static bool check_pause(fsm_t *p_this){
 static bool check_play_note(fsm_t *p_this) {
     fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
 
-    return (p_fsm->user_action == 1)&&(!(p_fsm->note_index>=p_fsm->p_melody->melody_length));
+    // A streamed note that is not read yet keeps the player here, in silence, until it arrives
+    return (p_fsm->user_action == 1)&&(!(p_fsm->note_index>=p_fsm->p_melody->melody_length))&&_is_note_ready(p_fsm);
 
 }
 
@@ -105,12 +272,20 @@ static bool check_resume(fsm_t *p_this){
 }
 
 
+/// @brief Check if the player is set to play and a note was paused before its end.
+/// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t. 
+/// @return 
+static bool check_resume_note(fsm_t *p_this){
+    fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
+
+    return (p_fsm->user_action == PLAY)&&p_fsm->note_paused;
+}
 
 /// @brief Stop the player. 
 /// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t. 
 static void do_end_melody 	(fsm_t *p_this){
     fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
-    port_buzzer_stop(p_fsm->buzzer_id);
+    _stop_voices(p_fsm);
     p_fsm->note_index = 0;
     p_fsm->user_action = 0;
 }
@@ -119,8 +294,9 @@ static void do_end_melody 	(fsm_t *p_this){
 /// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t. 
 static void do_melody_start(fsm_t *p_this){
     fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
-    double freq = *(p_fsm->p_melody->p_notes);
-    uint32_t duration = *(p_fsm->p_melody->p_durations);
+    double freq;
+    uint32_t duration;
+    _get_note(p_fsm, &freq, &duration);
     _start_note(p_this,freq, duration);
     p_fsm->note_index++;
 
@@ -130,7 +306,7 @@ static void do_melody_start(fsm_t *p_this){
 /// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t. 
 static void do_note_end (fsm_t *p_this){
     fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
-    port_buzzer_stop(p_fsm->buzzer_id);
+    _stop_voices(p_fsm);
 
 }
 
@@ -138,21 +314,61 @@ static void do_note_end (fsm_t *p_this){
 /// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t. 
 static void do_pause (fsm_t *p_this){
     fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
-    port_buzzer_stop(p_fsm->buzzer_id);
+    _stop_voices(p_fsm);
+
+}
+
+/// @brief Pause the player in the middle of a note: the port keeps the count of the note duration timer.
+/// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t. 
+static void do_pause_note (fsm_t *p_this){
+    fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
+    port_buzzer_pause_note(p_fsm->buzzer_id);
+    p_fsm->note_paused = true;
+}
 
+/// @brief Resume the note paused in the middle, for the time it had left.
+/// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t. 
+static void do_resume_note (fsm_t *p_this){
+    fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
+    port_buzzer_resume_note(p_fsm->buzzer_id);
+    p_fsm->note_paused = false;
 }
 
 /// @brief Update the player with a new note. 
 /// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t. 
 static void do_play_note(fsm_t *p_this){
     fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
-    double freq = (p_fsm->p_melody->p_notes[p_fsm->note_index]);
-    uint32_t duration = (p_fsm->p_melody->p_durations[p_fsm->note_index]);
+    double freq;
+    uint32_t duration;
+    _get_note(p_fsm, &freq, &duration);
     _start_note(p_this,freq, duration);
     p_fsm->note_index++;
 
 }
 
+/// @brief Go on with the next melody, whose first note the port has just started.
+/// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t. 
+static void do_next_melody_started(fsm_t *p_this){
+    fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
+    _take_next_melody(p_fsm);
+    p_fsm->num_voices = _get_num_voices(p_fsm);
+    _start_note_effects(p_fsm, _scale_duration(p_fsm, p_fsm->p_melody->p_durations[0]));
+    if(p_fsm->note_watch){
+        p_fsm->note_cycles = port_system_get_cycles();
+        p_fsm->note_watch = false;
+        p_fsm->note_watched = true;
+    }
+    p_fsm->note_index++;
+}
+
+/// @brief Start the next melody after the end of the current one.
+/// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t. 
+static void do_next_melody(fsm_t *p_this){
+    fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
+    _take_next_melody(p_fsm);
+    do_play_note(p_this);
+}
+
 /// @brief Start the player. 
 /// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t. 
 static void do_player_start(fsm_t *p_this){
@@ -163,18 +379,22 @@ static void do_player_start(fsm_t *p_this){
 /// @param p_this Pointer to an fsm_t struct than contains an fsm_buzzer_t. 
 static void do_player_stop(fsm_t *p_this) {
     fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
-    port_buzzer_stop(p_fsm->buzzer_id);
+    _stop_voices(p_fsm);
     p_fsm->note_index = 0;
 }
 
 /// @brief Buzzer FSM matrix
 static fsm_trans_t fsm_trans_buzzer[] = {
     {WAIT_START, check_player_start, WAIT_NOTE, do_player_start},
+    {WAIT_NOTE , check_next_melody_started, WAIT_NOTE, do_next_melody_started },
     {WAIT_NOTE , check_note_end, PLAY_NOTE, do_note_end },
+    {WAIT_NOTE , check_pause, PAUSE_NOTE, do_pause_note },
     {PLAY_NOTE, check_player_stop, WAIT_START, do_player_stop },
     {PLAY_NOTE, check_play_note, WAIT_NOTE, do_play_note },
     {PLAY_NOTE, check_pause, PAUSE_NOTE, do_pause },
+    {PLAY_NOTE, check_next_melody, WAIT_NOTE, do_next_melody },
     {PLAY_NOTE, check_end_melody, WAIT_MELODY, do_end_melody },
+    {PAUSE_NOTE, check_resume_note, WAIT_NOTE, do_resume_note },
     {PAUSE_NOTE, check_resume, PLAY_NOTE, NULL },
     {WAIT_MELODY, check_melody_start, WAIT_NOTE, do_melody_start },
     {-1, NULL, -1, NULL },
@@ -197,12 +417,26 @@ void fsm_buzzer_init(fsm_t *p_this, uint32_t buzzer_id){
     /* TO-DO alumnos */
     
     p_fsm->buzzer_id = buzzer_id;
+    p_fsm->num_voices = 1;
     p_fsm->p_melody = NULL;
+    p_fsm->p_stream = NULL;
+    p_fsm->p_next_melody = NULL;
+    p_fsm->next_started = false;
     p_fsm->note_index = 0;
     p_fsm->user_action = 0;
     p_fsm->player_speed = 1.0;
+    p_fsm->duration_scale = FSM_BUZZER_Q16_ONE;
+    p_fsm->pitch_ratio = FSM_BUZZER_Q16_ONE;
+    p_fsm->transpose = 0;
     p_fsm->player_volume = 0.5;
-    port_buzzer_init(buzzer_id);
+    p_fsm->note_paused = false;
+    p_fsm->note_watch = false;
+    p_fsm->note_watched = false;
+    p_fsm->note_cycles = 0;
+    // The buzzers after this one play the other tracks of the melodies
+    for(uint32_t id = buzzer_id; id < BUZZERS_LENGTH; id++){
+        port_buzzer_init(id);
+    }
 
 
 }
@@ -211,32 +445,116 @@ void fsm_buzzer_init(fsm_t *p_this, uint32_t buzzer_id){
 void fsm_buzzer_set_melody(fsm_t *p_this, const melody_t *p_melody){
     fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
     p_fsm->p_melody = (melody_t *)p_melody;
+    p_fsm->p_stream = NULL;
+    _drop_next_melody(p_fsm);
+    p_fsm->note_paused = false;
+}
 
+void fsm_buzzer_set_stream(fsm_t *p_this, melody_stream_t *p_stream){
+    fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
+    p_fsm->p_melody = (melody_t *)melody_stream_get_melody(p_stream);
+    p_fsm->p_stream = p_stream;
+    _drop_next_melody(p_fsm);
+    p_fsm->note_paused = false;
 }
 
 
+void fsm_buzzer_set_next_melody(fsm_t *p_this, const melody_t *p_melody){
+    fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
+    p_fsm->p_next_melody = p_melody;
+    port_buzzer_clear_stage(p_fsm->buzzer_id);
+    // Set during the last note: it is staged at once
+    if((p_melody!=NULL)&&(p_fsm->p_melody!=NULL)&&(fsm_get_state(p_this)==WAIT_NOTE)&&
+       (p_fsm->note_index==p_fsm->p_melody->melody_length)&&!p_fsm->note_paused){
+        _stage_next_melody(p_fsm);
+    }
+}
+
+const melody_t *fsm_buzzer_get_next_melody(fsm_t *p_this){
+    fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
+    return p_fsm->p_next_melody;
+}
+
+bool fsm_buzzer_get_next_started(fsm_t *p_this){
+    fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
+    bool started = p_fsm->next_started;
+    p_fsm->next_started = false;
+    return started;
+}
+
 void fsm_buzzer_set_speed(fsm_t *p_this, double speed){
     fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
     p_fsm->player_speed = speed;
+    // The only division of the tempo: the notes multiply by its reciprocal
+    double scale = (speed > 0) ? FSM_BUZZER_Q16_ONE / speed + 0.5 : (double)UINT32_MAX;
+    p_fsm->duration_scale = (scale >= (double)UINT32_MAX) ? UINT32_MAX : (uint32_t)scale;
+}
+
+void fsm_buzzer_set_tempo(fsm_t *p_this, uint32_t bpm){
+    fsm_buzzer_set_speed(p_this, (double)bpm / FSM_BUZZER_NOMINAL_TEMPO_BPM);
+}
+
+void fsm_buzzer_set_transpose(fsm_t *p_this, int32_t semitones){
+    fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
+    if(semitones > FSM_BUZZER_MAX_TRANSPOSE) semitones = FSM_BUZZER_MAX_TRANSPOSE;
+    if(semitones < -FSM_BUZZER_MAX_TRANSPOSE) semitones = -FSM_BUZZER_MAX_TRANSPOSE;
+    p_fsm->transpose = (int8_t)semitones;
+
+    // Semitone within the octave from the table, then whole octaves as shifts, from the lowest one up
+    uint32_t steps = (uint32_t)(semitones + FSM_BUZZER_MAX_TRANSPOSE);
+    uint32_t octaves = steps / FSM_BUZZER_SEMITONES_PER_OCTAVE;
+    uint32_t lowest = FSM_BUZZER_MAX_TRANSPOSE / FSM_BUZZER_SEMITONES_PER_OCTAVE;
+    p_fsm->pitch_ratio = (semitone_ratios[steps % FSM_BUZZER_SEMITONES_PER_OCTAVE] << octaves) >> lowest;
+}
+
+int32_t fsm_buzzer_get_transpose(fsm_t *p_this){
+    fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
+    return p_fsm->transpose;
 }
 
 void fsm_buzzer_set_action(fsm_t *p_this, uint8_t action){
     fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
     p_fsm->user_action = action;
-    if(action==0) p_fsm->note_index=0;
+    if(action==0){
+        p_fsm->note_index=0;
+        p_fsm->note_paused=false;
+        // The melody does not go on into the next one
+        port_buzzer_clear_stage(p_fsm->buzzer_id);
+    }
 }
 
 void fsm_buzzer_set_volume(fsm_t *p_this, double volume){
     fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
-    if (volume == 1.0) volume = 0.95;
     p_fsm->player_volume = volume;
 }
 
+void fsm_buzzer_set_envelope(fsm_t *p_this, const envelope_config_t *p_config){
+    fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
+    port_buzzer_set_envelope(p_fsm->buzzer_id, p_config);
+}
+
 uint8_t fsm_buzzer_get_action(fsm_t *p_this){
     fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
     return p_fsm->user_action;
 }
 
+uint32_t fsm_buzzer_get_note_index(fsm_t *p_this){
+    fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
+    return p_fsm->note_index;
+}
+
+void fsm_buzzer_watch_note(fsm_t *p_this){
+    fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
+    p_fsm->note_watch = true;
+    p_fsm->note_watched = false;
+}
+
+bool fsm_buzzer_get_watched_note(fsm_t *p_this, uint32_t *p_cycles){
+    fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
+    *p_cycles = p_fsm->note_cycles;
+    return p_fsm->note_watched;
+}
+
 bool fsm_buzzer_check_activity(fsm_t *p_this) {
     fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
     return p_fsm->user_action==PLAY;
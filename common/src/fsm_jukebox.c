@@ -15,18 +15,28 @@
 
 #include <stdlib.h>
 
+#include <ctype.h>  // isdigit
+
 // Other includes
 
 #include <fsm.h>
 
 #include "fsm_jukebox.h"
 
+#include "frame.h"
+
+#include "macro.h"
+
+#include "telemetry.h"
+
 #include "fsm_button.h"
 
 #include "fsm_usart.h"
 
 #include "fsm_buzzer.h"
 
+#include "fsm_log.h"
+
 #include "port_system.h"
 
 #include "port_usart.h"
@@ -38,14 +48,40 @@
 #define MIN(a, b) ((a) < (b) ? (a) : (b)) /*!< Macro to get the minimum of two values. */
 
 /* Private functions */
+/**
+ * @brief Get the next token of a text separated by spaces.
+ *
+ * Same behaviour as `strtok(p_text, " ")`, but the position is kept by the caller instead of in a hidden static
+ * variable, so several jukeboxes can parse messages at the same time.
+ *
+ * @param pp_text Pointer to the position in the text. It is moved after the token.
+ * @return Pointer to the token, or `NULL` if there are no more tokens.
+ */
+static char *_next_token(char **pp_text)
+{
+    char *p_token = *pp_text + strspn(*pp_text, " "); // Skip the leading spaces
+    if (*p_token == '\0')
+    {
+        *pp_text = p_token;
+        return NULL;
+    }
+    char *p_end = p_token + strcspn(p_token, " ");
+    if (*p_end != '\0')
+    {
+        *p_end++ = '\0';
+    }
+    *pp_text = p_end;
+    return p_token;
+}
+
 /**
  * @brief Parse the message received by the USART.
  * 
  * Given data received by the USART, this function parses the message and extracts the command and the parameter (if available).
  * 
- * > 1. Split the message by space using function `strtok()` \n
+ * > 1. Split the message by space using function `_next_token()` \n
  * > 2. If there's a token (command), copy it to the `p_command` variable. Otherwise, return `false` \n
- * > 3. Extract the parameter (if available). To do so, get the next token using function `strtok()`. If there's a token, copy it to the `p_param` variable. Otherwise, copy an empty string to the `p_param` variable \n
+ * > 3. Extract the parameter (if available). To do so, get the next token using function `_next_token()`. If there's a token, copy it to the `p_param` variable. Otherwise, copy an empty string to the `p_param` variable \n
  * > 4. Return `true` indicating that the message has been parsed correctly \n
  * 
  * @param p_message Pointer to the message received by the USART.
@@ -56,7 +92,7 @@
  */
 bool _parse_message(char *p_message, char *p_command, char *p_param)
 {
-    char *p_token = strtok(p_message, " "); // Split the message by space
+    char *p_token = _next_token(&p_message); // Split the message by space
 
     // If there's a token (command), copy it to the command variable
     if (p_token != NULL)
@@ -71,7 +107,7 @@ bool _parse_message(char *p_message, char *p_command, char *p_param)
     }
 
     // Extract the parameter (if available)
-    p_token = strtok(NULL, " "); // Get the next token
+    p_token = _next_token(&p_message); // Get the next token
 
     if (p_token != NULL)
     {
@@ -83,10 +119,24 @@ bool _parse_message(char *p_message, char *p_command, char *p_param)
     }
     return true;
 }
-void _send(fsm_t *p_fsm_usart, char* message){
-    printf(message);
-    fsm_usart_set_out_data(p_fsm_usart, message);
+/// @brief Send a text message through the USART and copy it to the log.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param message Message, ended by `\n`.
+void _send(fsm_jukebox_t * p_fsm_jukebox, char* message){
+    LOG_DEBUG(p_fsm_jukebox->p_fsm_log, "%s", message);
+    // In a binary session the text messages would be taken as broken frames: only the console gets them
+    if(!fsm_usart_get_binary(p_fsm_jukebox->p_fsm_usart)){
+        fsm_usart_append_out_data(p_fsm_jukebox->p_fsm_usart, message);
+    }
+}
 
+/// @brief Send a frame of the binary protocol through the USART.
+/// @param p_fsm_usart Pointer to the USART FSM.
+/// @param p_frame Pointer to the frame.
+void _send_frame(fsm_t *p_fsm_usart, const frame_t *p_frame){
+    uint8_t encoded[FRAME_MAX_ENCODED];
+    size_t length = frame_encode(p_frame, encoded);
+    fsm_usart_set_out_frame(p_fsm_usart, encoded, length);
 }
 
 
@@ -112,30 +162,453 @@ void _show_vol(char* volume){
     port_lcd_print_str(volume);
     port_lcd_print_str("%");
 }
-//
-static uint32_t _random(uint32_t min, uint32_t max){
-    if(1>=max|| max == 0)
-        return 1;
-    return (uint32_t)((rand()%max));
-//    return (uint32_t)(min + rand() / (RAND_MAX / (max - min + 1) + 1));
+
+/// @brief Show on the LCD that a round of the game has started.
+void _show_game(){
+    port_lcd_clear();
+    port_lcd_set_cursor(0,0);
+    port_lcd_print_str("Try to guess");
+    port_lcd_set_cursor(0,1);
+    port_lcd_print_str("the song");
+    port_lcd_set_cursor(0,0);
 }
 
-/// @brief Check if any of the elements of the system is active. 
+/// @brief Change what the LCD shows. The LCD blocks on I2C for milliseconds: it is updated once the changes stop for
+/// `LCD_REFRESH_HOLD_MS`, never before the reply to a command.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param view View (see FSM_JUKEBOX_LCD_VIEW).
+/// @param p_state State shown by `LCD_VIEW_STATE`, NULL for the other views.
+static void _set_lcd_view(fsm_jukebox_t * p_fsm_jukebox, uint8_t view, char * p_state){
+    p_fsm_jukebox->lcd_pending = view;
+    p_fsm_jukebox->p_lcd_state = p_state;
+    p_fsm_jukebox->lcd_changed_ms = port_system_get_millis();
+}
+/// @brief Get a melody of the jukebox: the built-in melodies, then the uploaded ones.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param melody_idx Index of the melody.
+/// @return Pointer to the melody, or NULL if there is no melody with that index.
+static const melody_t * _get_melody(fsm_jukebox_t * p_fsm_jukebox, uint32_t melody_idx){
+    if(melody_idx < MELODIES_LENGTH){
+        return melody_registry_get(melody_idx);
+    }
+    return melody_store_get(&p_fsm_jukebox->store, melody_idx - MELODIES_LENGTH);
+}
+
+/// @brief Get the number of melodies of the jukebox, built-in and uploaded.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @return Number of melodies.
+static uint32_t _get_num_melodies(fsm_jukebox_t * p_fsm_jukebox){
+    return MELODIES_LENGTH + melody_store_get_num_melodies(&p_fsm_jukebox->store);
+}
+
+/// @brief Find a melody by its name or by the beginning of its name. The built-in melodies are searched first.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param p_prefix Name or beginning of the name.
+/// @param whole Only whole names match.
+/// @return Index of the melody, or `MELODY_REGISTRY_NOT_FOUND`.
+static uint32_t _find_melody(fsm_jukebox_t * p_fsm_jukebox, const char * p_prefix, bool whole){
+    uint32_t melody_idx = whole ? melody_registry_find(p_prefix) : melody_registry_find_prefix(p_prefix);
+    if(melody_idx != MELODY_REGISTRY_NOT_FOUND){
+        return melody_idx;
+    }
+    melody_idx = melody_store_find(&p_fsm_jukebox->store, p_prefix, whole);
+    return (melody_idx == MELODY_STORE_NOT_FOUND) ? MELODY_REGISTRY_NOT_FOUND : MELODIES_LENGTH + melody_idx;
+}
+
+/// @brief Prepare the melody that follows the current one in the playlist, for the buzzer to go on with it without a
+/// gap. Nothing is prepared if the playlist ends with the current one.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+static void _queue_next_song(fsm_jukebox_t * p_fsm_jukebox){
+    playlist_set_num_songs(&p_fsm_jukebox->playlist, _get_num_melodies(p_fsm_jukebox));
+    uint32_t melody_idx = playlist_peek(&p_fsm_jukebox->playlist, p_fsm_jukebox->melody_idx, false);
+    const melody_t* melody = (melody_idx == PLAYLIST_NONE) ? NULL : _get_melody(p_fsm_jukebox, melody_idx);
+    fsm_buzzer_set_next_melody(p_fsm_jukebox->p_fsm_buzzer, melody);
+    p_fsm_jukebox->in_playlist = true;
+}
+
+/// @brief Play the next melody. The buzzer starts it first: the message is queued and the LCD, which blocks on I2C,
+/// shows it in the next pass.
 /// @param p_fsm_jukebox Pointer to an fsm_t struct that contains an fsm_jukebox_t. 
 void _set_next_song(fsm_jukebox_t * p_fsm_jukebox){
     fsm_buzzer_set_action(p_fsm_jukebox->p_fsm_buzzer, STOP);
-    (p_fsm_jukebox->melody_idx) +=1;
-    if((p_fsm_jukebox->melody_idx >= MELODIES_MEMORY_SIZE) ||
-    (p_fsm_jukebox->melodies[p_fsm_jukebox->melody_idx].melody_length <= 0)){
-        p_fsm_jukebox->melody_idx = 0;
-    }
-    p_fsm_jukebox->p_melody = p_fsm_jukebox->melodies[p_fsm_jukebox->melody_idx].p_name;
+    // The user skips the song: it is not repeated and the playlist starts again after the last one
+    playlist_set_num_songs(&p_fsm_jukebox->playlist, _get_num_melodies(p_fsm_jukebox));
+    p_fsm_jukebox->melody_idx = playlist_advance(&p_fsm_jukebox->playlist, p_fsm_jukebox->melody_idx, true);
+    const melody_t* melody = _get_melody(p_fsm_jukebox, p_fsm_jukebox->melody_idx);
+    p_fsm_jukebox->p_melody = melody->p_name;
+    fsm_buzzer_set_melody(p_fsm_jukebox->p_fsm_buzzer, melody);
+    fsm_buzzer_set_action(p_fsm_jukebox->p_fsm_buzzer, PLAY);
+    _queue_next_song(p_fsm_jukebox);
     char msg[USART_OUTPUT_BUFFER_LENGTH];
     sprintf(msg, "Now playing: %s :) \n", p_fsm_jukebox->p_melody);
-    _send(p_fsm_jukebox->p_fsm_usart, msg);
-    fsm_buzzer_set_melody(p_fsm_jukebox->p_fsm_buzzer, &p_fsm_jukebox->melodies[p_fsm_jukebox->melody_idx]);
+    _send(p_fsm_jukebox, msg);
+    _set_lcd_view(p_fsm_jukebox, LCD_VIEW_SONG, NULL);
+}
+
+/// @brief Play a melody from the start.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param melody_idx Index of the melody (see _get_melody()).
+/// @return true if the melody exists, false if not.
+static bool _select_melody(fsm_jukebox_t * p_fsm_jukebox, uint32_t melody_idx){
+    const melody_t* melody = _get_melody(p_fsm_jukebox, melody_idx);
+    if(melody == NULL){
+        return false;
+    }
+    fsm_buzzer_set_action(p_fsm_jukebox->p_fsm_buzzer, STOP);
+    p_fsm_jukebox->melody_idx = melody_idx;
+    fsm_buzzer_set_melody(p_fsm_jukebox->p_fsm_buzzer, melody);
+    p_fsm_jukebox->p_melody = melody->p_name;
     fsm_buzzer_set_action(p_fsm_jukebox->p_fsm_buzzer, PLAY);
-    _show_song(p_fsm_jukebox->p_melody);
+    _queue_next_song(p_fsm_jukebox);
+    _set_lcd_view(p_fsm_jukebox, LCD_VIEW_SONG, NULL);
+    return true;
+}
+
+/// @brief Set the volume of the buzzer and show it on the LCD, after the reply.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param volume Volume, from 0 to 1.
+/// @return Volume in percent, as shown on the LCD.
+static int _set_volume(fsm_jukebox_t * p_fsm_jukebox, double volume){
+    fsm_buzzer_set_volume(p_fsm_jukebox->p_fsm_buzzer, volume);
+    (p_fsm_jukebox->volume) = volume;
+    _set_lcd_view(p_fsm_jukebox, LCD_VIEW_VOLUME, NULL);
+    return (int)((p_fsm_jukebox->volume)*100);
+}
+
+/// @brief Play, stop or pause the buzzer and show it on the LCD, after the reply.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param action `PLAY`, `STOP` or `PAUSE`.
+static void _set_action(fsm_jukebox_t * p_fsm_jukebox, uint8_t action){
+    fsm_buzzer_set_action(p_fsm_jukebox->p_fsm_buzzer, action);
+    if(action == PLAY){
+        _set_lcd_view(p_fsm_jukebox, LCD_VIEW_SONG, NULL);
+    } else{
+        _set_lcd_view(p_fsm_jukebox, LCD_VIEW_STATE, (action == STOP) ? "STOP" : "PAUSE");
+    }
+}
+
+/// @brief Set the speed of the buzzer.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param speed Factor of the nominal speed, 0.1 or more.
+static void _set_speed(fsm_jukebox_t * p_fsm_jukebox, double speed){
+    (p_fsm_jukebox->speed) = speed;
+    fsm_buzzer_set_speed(p_fsm_jukebox->p_fsm_buzzer, p_fsm_jukebox->speed);
+}
+
+/// @brief Reply to a text command that sets the volume.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param percent Volume in percent.
+static void _send_volume(fsm_jukebox_t * p_fsm_jukebox, int percent){
+    char msg[USART_OUTPUT_BUFFER_LENGTH];
+    sprintf(msg, "Current volume: %d%%\n", percent);
+    _send(p_fsm_jukebox, msg);
+}
+
+/// @brief Reply to a text command `info`.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+static void _send_info(fsm_jukebox_t * p_fsm_jukebox){
+    char msg[USART_OUTPUT_BUFFER_LENGTH];
+    sprintf(msg, "Playing: %s\n", p_fsm_jukebox->p_melody);
+    _send(p_fsm_jukebox, msg);
+}
+
+/// @brief Value of each setting until it is changed: volume at 50 %, nominal speed, first melody and no score.
+static const uint32_t setting_defaults[] = {
+    [SETTING_VOLUME] = 50,
+    [SETTING_SPEED] = 100,
+};
+
+/// @brief Get a setting kept in the flash, or its default value.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param key Key of the setting.
+/// @return Value of the setting.
+static uint32_t _get_setting(fsm_jukebox_t * p_fsm_jukebox, uint32_t key){
+    uint32_t default_value = (key < sizeof(setting_defaults) / sizeof(setting_defaults[0])) ? setting_defaults[key] : 0;
+    return settings_store_get(&p_fsm_jukebox->settings, key, default_value);
+}
+
+/// @brief Mark a setting if it has changed. A default value is not written until the setting has another one.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param key Key of the setting.
+/// @param value Current value.
+/// @param now_ms Current time.
+static void _update_setting(fsm_jukebox_t * p_fsm_jukebox, uint32_t key, uint32_t value, uint32_t now_ms){
+    if(value != _get_setting(p_fsm_jukebox, key)){
+        settings_store_set(&p_fsm_jukebox->settings, key, value, now_ms);
+    }
+}
+
+/// @brief Load the settings kept in the flash: volume, speed, melody and scores of the game. A melody that is not
+/// there any more goes back to the first one.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+static void _restore_settings(fsm_jukebox_t * p_fsm_jukebox){
+    settings_store_mount(&p_fsm_jukebox->settings);
+    p_fsm_jukebox->volume = _get_setting(p_fsm_jukebox, SETTING_VOLUME) / 100.0;
+    fsm_buzzer_set_volume(p_fsm_jukebox->p_fsm_buzzer, p_fsm_jukebox->volume);
+    p_fsm_jukebox->speed = _get_setting(p_fsm_jukebox, SETTING_SPEED) / 100.0;
+    uint32_t melody_idx = _get_setting(p_fsm_jukebox, SETTING_MELODY);
+    p_fsm_jukebox->melody_idx = (_get_melody(p_fsm_jukebox, melody_idx) == NULL) ? 0 : melody_idx;
+    p_fsm_jukebox->game.score = _get_setting(p_fsm_jukebox, SETTING_SCORE);
+    p_fsm_jukebox->game.best_streak = _get_setting(p_fsm_jukebox, SETTING_BEST_STREAK);
+    p_fsm_jukebox->game.rounds = _get_setting(p_fsm_jukebox, SETTING_ROUNDS);
+    p_fsm_jukebox->game.wins = _get_setting(p_fsm_jukebox, SETTING_WINS);
+}
+
+/// @brief Mark the settings that have changed. It is called at the end of the actions that can change them: the
+/// commands, the next melody and the end of a round of the game. Unchanged ones cost a comparison.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param now_ms Current time.
+static void _update_settings(fsm_jukebox_t * p_fsm_jukebox, uint32_t now_ms){
+    _update_setting(p_fsm_jukebox, SETTING_VOLUME, (uint32_t)((p_fsm_jukebox->volume)*100 + 0.5), now_ms);
+    _update_setting(p_fsm_jukebox, SETTING_SPEED, (uint32_t)((p_fsm_jukebox->speed)*100 + 0.5), now_ms);
+    _update_setting(p_fsm_jukebox, SETTING_MELODY, p_fsm_jukebox->melody_idx, now_ms);
+    _update_setting(p_fsm_jukebox, SETTING_SCORE, p_fsm_jukebox->game.score, now_ms);
+    _update_setting(p_fsm_jukebox, SETTING_BEST_STREAK, p_fsm_jukebox->game.best_streak, now_ms);
+    _update_setting(p_fsm_jukebox, SETTING_ROUNDS, p_fsm_jukebox->game.rounds, now_ms);
+    _update_setting(p_fsm_jukebox, SETTING_WINS, p_fsm_jukebox->game.wins, now_ms);
+}
+
+/// @brief Write the changed settings to the flash. An erase stalls the CPU, so it is only allowed with the buzzer
+/// quiet; otherwise the changes wait.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param can_erase true if a sector may be erased now.
+static void _save_settings(fsm_jukebox_t * p_fsm_jukebox, bool can_erase){
+    if(settings_store_flush(&p_fsm_jukebox->settings, can_erase) == SETTINGS_STORE_FLASH_ERROR){
+        LOG_ERROR(p_fsm_jukebox->p_fsm_log, "Settings not saved: flash error\n");
+    }
+}
+
+/// @brief Negotiate the baud rate of the USART. `baud <rate>` is acknowledged at the current rate and the USART
+/// changes right after; the host then sends `baud` at the new rate to confirm it. Without the confirmation, the USART
+/// returns to the previous rate after `USART_BAUD_RATE_CONFIRM_TIME_MS`. `baud` alone reports the rate.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param p_param Baud rate, or " " for none.
+static void _set_baud_rate(fsm_jukebox_t * p_fsm_jukebox, char * p_param){
+    char msg[USART_OUTPUT_BUFFER_LENGTH];
+    if(!strcmp(p_param, " ")){
+        fsm_usart_confirm_baud_rate(p_fsm_jukebox->p_fsm_usart);
+        sprintf(msg, "Baud rate: %lu\n", (unsigned long)fsm_usart_get_baud_rate(p_fsm_jukebox->p_fsm_usart));
+        _send(p_fsm_jukebox, msg);
+        return;
+    }
+    uint32_t baud_rate = strtoul(p_param, NULL, 10);
+    if(!fsm_usart_set_baud_rate(p_fsm_jukebox->p_fsm_usart, baud_rate)){
+        _send(p_fsm_jukebox, "Error: Baud rate not available :(\n");
+        return;
+    }
+    sprintf(msg, "Baud rate: %lu, send baud to confirm\n", (unsigned long)baud_rate);
+    _send(p_fsm_jukebox, msg);
+}
+
+/// @brief Set the tempo of the melodies, as a speed relative to `FSM_BUZZER_NOMINAL_TEMPO_BPM`, from the next note.
+/// `tempo` alone reports it.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param p_param Beats per minute, or " " for none.
+static void _set_tempo(fsm_jukebox_t * p_fsm_jukebox, char * p_param){
+    char msg[USART_OUTPUT_BUFFER_LENGTH];
+    if(strcmp(p_param, " ")){
+        double bpm = atof(p_param);
+        if(bpm <= 0){
+            _send(p_fsm_jukebox, "Error: Tempo not valid :(\n");
+            return;
+        }
+        (p_fsm_jukebox->speed) = MAX(bpm / FSM_BUZZER_NOMINAL_TEMPO_BPM, 0.1);
+        fsm_buzzer_set_speed(p_fsm_jukebox->p_fsm_buzzer, p_fsm_jukebox->speed);
+    }
+    sprintf(msg, "Tempo: %d bpm\n", (int)((p_fsm_jukebox->speed) * FSM_BUZZER_NOMINAL_TEMPO_BPM + 0.5));
+    _send(p_fsm_jukebox, msg);
+}
+
+/// @brief Shift the pitch of the melodies by semitones, from the next note. `transpose` alone reports it.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param p_param Semitones, negative to go down, or " " for none.
+static void _set_transpose(fsm_jukebox_t * p_fsm_jukebox, char * p_param){
+    char msg[USART_OUTPUT_BUFFER_LENGTH];
+    if(strcmp(p_param, " ")){
+        fsm_buzzer_set_transpose(p_fsm_jukebox->p_fsm_buzzer, atoi(p_param));
+    }
+    sprintf(msg, "Transpose: %+d semitones\n", (int)fsm_buzzer_get_transpose(p_fsm_jukebox->p_fsm_buzzer));
+    _send(p_fsm_jukebox, msg);
+}
+
+/// @brief Record the first note played after the last command, if it has already started.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+void _update_latency(fsm_jukebox_t * p_fsm_jukebox){
+    uint32_t cycles;
+    if(latency_note_pending(&p_fsm_jukebox->latency) && fsm_buzzer_get_watched_note(p_fsm_jukebox->p_fsm_buzzer, &cycles)){
+        latency_note(&p_fsm_jukebox->latency, cycles);
+    }
+}
+
+/// @brief Report the latency of the commands: every command on the console and the selected one through the USART.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param p_param Index of the command to send through the USART, in order of appearance.
+void _show_latency(fsm_jukebox_t * p_fsm_jukebox, char * p_param){
+    char msg[USART_OUTPUT_BUFFER_LENGTH];
+    _update_latency(p_fsm_jukebox);
+    for(uint32_t idx = 0; idx < latency_get_num_commands(&p_fsm_jukebox->latency); idx++){
+        latency_format(&p_fsm_jukebox->latency, idx, SystemCoreClock, msg, sizeof(msg));
+        LOG_DEBUG(p_fsm_jukebox->p_fsm_log, "%s", msg);
+    }
+    if(latency_format(&p_fsm_jukebox->latency, atoi(p_param), SystemCoreClock, msg, sizeof(msg))){
+        fsm_usart_append_out_data(p_fsm_jukebox->p_fsm_usart, msg);
+        return;
+    }
+    _send(p_fsm_jukebox, "Error: No latency measurements :(\n");
+}
+
+/// @brief Prepare again the melody that follows the current one, after a change of the playlist.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+static void _requeue_next_song(fsm_jukebox_t * p_fsm_jukebox){
+    if(p_fsm_jukebox->in_playlist){
+        _queue_next_song(p_fsm_jukebox);
+    }
+}
+
+/// @brief Execute the `queue` command: `queue <melody>` adds a melody, by index or by name, at the end of the queue,
+/// and `queue` alone lists the queue.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param p_param Pointer to the parameter of the command.
+static void _execute_queue(fsm_jukebox_t * p_fsm_jukebox, char * p_param){
+    char msg[USART_OUTPUT_BUFFER_LENGTH];
+    playlist_t *p_playlist = &p_fsm_jukebox->playlist;
+    if(!strcmp(p_param, " ")){
+        uint32_t length = playlist_get_queue_length(p_playlist);
+        size_t n = (size_t)sprintf(msg, "Queue:%s", (length == 0) ? " empty" : "");
+        for(uint32_t i = 0; i < length; i++){
+            const char *p_name = _get_melody(p_fsm_jukebox, playlist_get_queued(p_playlist, i))->p_name;
+            // Only the names that fit in a message
+            if(n + 1 + strlen(p_name) + 2 > sizeof(msg)){
+                break;
+            }
+            n += (size_t)sprintf(msg + n, " %s", p_name);
+        }
+        sprintf(msg + n, "\n");
+        _send(p_fsm_jukebox, msg);
+        return;
+    }
+    uint32_t melody_idx = isdigit((unsigned char)p_param[0]) ? (uint32_t)atoi(p_param) : _find_melody(p_fsm_jukebox, p_param, false);
+    const melody_t* melody = _get_melody(p_fsm_jukebox, melody_idx);
+    if(melody == NULL){
+        _send(p_fsm_jukebox, "Error: Melody not found :(\n");
+        return;
+    }
+    playlist_set_num_songs(p_playlist, _get_num_melodies(p_fsm_jukebox));
+    if(!playlist_enqueue(p_playlist, melody_idx)){
+        _send(p_fsm_jukebox, "Error: Queue full :(\n");
+        return;
+    }
+    sprintf(msg, "Queued: %s, %lu in queue\n", melody->p_name, (unsigned long)playlist_get_queue_length(p_playlist));
+    _send(p_fsm_jukebox, msg);
+    _requeue_next_song(p_fsm_jukebox);
+}
+
+/// @brief Set what happens at the end of a melody: `repeat off`, `repeat one` or `repeat all`.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param p_param Pointer to the parameter of the command.
+static void _set_repeat(fsm_jukebox_t * p_fsm_jukebox, char * p_param){
+    static const char *const names[] = {"off", "one", "all"};
+    for(uint32_t i = 0; i < sizeof(names) / sizeof(names[0]); i++){
+        if(!strcmp(p_param, names[i])){
+            char msg[USART_OUTPUT_BUFFER_LENGTH];
+            playlist_set_repeat(&p_fsm_jukebox->playlist, (playlist_repeat_t)i);
+            sprintf(msg, "Repeat: %s\n", names[i]);
+            _send(p_fsm_jukebox, msg);
+            _requeue_next_song(p_fsm_jukebox);
+            return;
+        }
+    }
+    _send(p_fsm_jukebox, "Error: Command not found :(\n");
+}
+
+/// @brief Play the melodies in a random order, without repeats until all of them have played: `shuffle on` or
+/// `shuffle off`.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param p_param Pointer to the parameter of the command.
+static void _set_shuffle(fsm_jukebox_t * p_fsm_jukebox, char * p_param){
+    bool on = !strcmp(p_param, "on");
+    if(!on && strcmp(p_param, "off")){
+        _send(p_fsm_jukebox, "Error: Command not found :(\n");
+        return;
+    }
+    // The moment of the command is one more source of randomness
+    playlist_seed(&p_fsm_jukebox->playlist, port_system_get_cycles());
+    playlist_set_num_songs(&p_fsm_jukebox->playlist, _get_num_melodies(p_fsm_jukebox));
+    playlist_set_shuffle(&p_fsm_jukebox->playlist, on);
+    _send(p_fsm_jukebox, on ? "Shuffle: on\n" : "Shuffle: off\n");
+    _requeue_next_song(p_fsm_jukebox);
+}
+
+/// @brief Tell the answer of a round of the game that has run out of time.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+static void _send_time_up(fsm_jukebox_t * p_fsm_jukebox){
+    char msg[USART_OUTPUT_BUFFER_LENGTH];
+    sprintf(msg, "Time is up! The correct answer was %s\n", p_fsm_jukebox->game_answer);
+    _send(p_fsm_jukebox, msg);
+    _set_lcd_view(p_fsm_jukebox, LCD_VIEW_STATE, "TIME IS UP");
+}
+
+/// @brief Start a round of the game (see game.h): an excerpt of a random melody, from a random note. `game` has no
+/// time limit, `game <seconds>` has one.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param p_param Pointer to the parameter of the command.
+static void _start_game(fsm_jukebox_t * p_fsm_jukebox, char * p_param){
+    uint32_t limit_s = isdigit((unsigned char)p_param[0]) ? (uint32_t)atoi(p_param) : 0;
+    char msg[USART_OUTPUT_BUFFER_LENGTH];
+    if(limit_s > 0){
+        sprintf(msg, "Gaming: %lu s to guess\n", (unsigned long)limit_s);
+    } else{
+        sprintf(msg, "Gaming\n");
+    }
+    _send(p_fsm_jukebox, msg);
+    uint32_t melody_selected = playlist_random(&p_fsm_jukebox->playlist, _get_num_melodies(p_fsm_jukebox));
+    const melody_t* melody = _get_melody(p_fsm_jukebox, melody_selected);
+    if(melody == NULL){
+        return;
+    }
+    uint32_t offset = playlist_random(&p_fsm_jukebox->playlist, melody->melody_length);
+    const melody_t* excerpt = game_start(&p_fsm_jukebox->game, melody, melody_selected, offset, limit_s * 1000,
+                                         port_system_get_millis());
+    _set_lcd_view(p_fsm_jukebox, LCD_VIEW_GAME, NULL);
+    snprintf(p_fsm_jukebox->game_answer, sizeof(p_fsm_jukebox->game_answer), "%s", melody->p_name);
+    fsm_buzzer_set_action(p_fsm_jukebox->p_fsm_buzzer, STOP);
+    p_fsm_jukebox->in_playlist = false;
+    fsm_buzzer_set_melody(p_fsm_jukebox->p_fsm_buzzer, excerpt);
+    fsm_buzzer_set_action(p_fsm_jukebox->p_fsm_buzzer, PLAY);
+}
+
+/// @brief Take a command as a guess of the round of the game in course. The closest name of all the melodies is
+/// found with the edit distance (see game.h), so small typos still win.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param p_guess Pointer to the guess.
+static void _guess_song(fsm_jukebox_t * p_fsm_jukebox, char * p_guess){
+    const char *names[NUM_MELODIES_MAX];
+    uint32_t num_melodies = _get_num_melodies(p_fsm_jukebox);
+    for(uint32_t idx = 0; idx < num_melodies; idx++){
+        names[idx] = _get_melody(p_fsm_jukebox, idx)->p_name;
+    }
+    uint32_t distance;
+    uint32_t match = game_match(p_guess, names, num_melodies, &distance);
+    uint32_t points;
+    game_result_t result = game_guess(&p_fsm_jukebox->game, match, distance, strlen(p_fsm_jukebox->game_answer),
+                                      port_system_get_millis(), &points);
+    char msg[USART_OUTPUT_BUFFER_LENGTH];
+    if(result == GAME_TIME_UP){
+        _send_time_up(p_fsm_jukebox);
+        return;
+    }
+    if(result == GAME_RIGHT){
+        sprintf(msg, "The correct answer was %s. So your guess is correct! :)\n", p_fsm_jukebox->game_answer);
+        _send(p_fsm_jukebox, msg);
+        sprintf(msg, "+%lu points. Score: %lu, streak: %lu\n", (unsigned long)points,
+                (unsigned long)p_fsm_jukebox->game.score, (unsigned long)p_fsm_jukebox->game.streak);
+        _send(p_fsm_jukebox, msg);
+        _set_lcd_view(p_fsm_jukebox, LCD_VIEW_STATE, "YOU WIN!");
+        return;
+    }
+    sprintf(msg, "So your guess is incorrect! Remember you can give up at any time with the command <give up>\n");
+    _set_lcd_view(p_fsm_jukebox, LCD_VIEW_STATE, "Failed Guess");
+    _send(p_fsm_jukebox, msg);
 }
 
 /// @brief Execute the command received by the USART. 
@@ -145,63 +618,45 @@ void _set_next_song(fsm_jukebox_t * p_fsm_jukebox){
 void _execute_command(fsm_jukebox_t * p_fsm_jukebox, char * p_command, char * p_param){
 
     if((!strcmp(p_command,"give"))&&(!strcmp(p_param,"up"))){
-        p_fsm_jukebox->game_state=WAITING;
+        game_give_up(&p_fsm_jukebox->game);
         char msg[USART_OUTPUT_BUFFER_LENGTH];
-        sprintf(msg, "The correct answer was %s. Im dissapointed in you for not keeping on trying\n", p_fsm_jukebox->p_melody);
-        _send(p_fsm_jukebox->p_fsm_usart, msg);
+        sprintf(msg, "The correct answer was %s. Im dissapointed in you for not keeping on trying\n", p_fsm_jukebox->game_answer);
+        _send(p_fsm_jukebox, msg);
         return;
     }
 
-    if(p_fsm_jukebox->game_state==GAMING) {
-        char msg[USART_OUTPUT_BUFFER_LENGTH];
-        if(!strcmp(p_command,p_fsm_jukebox->p_melody)){
-            sprintf(msg, "The correct answer was %s. So your guess is correct! :)\n", p_fsm_jukebox->p_melody);
-            _send(p_fsm_jukebox->p_fsm_usart, msg);
-            _show_state("YOU WIN!");
-            p_fsm_jukebox->game_state=WAITING;
-            return;
-        } else{
-            sprintf(msg, "So your guess is incorrect! Remember you can give up at any time with the command <give up>\n");
-            _show_state("Failed Guess");
-            _send(p_fsm_jukebox->p_fsm_usart, msg);
-            return;
-        }
+    if(game_is_on(&p_fsm_jukebox->game)) {
+        _guess_song(p_fsm_jukebox, p_command);
+        return;
     }
     if(!strcmp(p_command,"play")){
-        fsm_buzzer_set_action(p_fsm_jukebox->p_fsm_buzzer, PLAY);
-        _show_song(p_fsm_jukebox->p_melody);
+        _set_action(p_fsm_jukebox, PLAY);
         return;
     }
     if(!strcmp(p_command,"stop")){
-        fsm_buzzer_set_action(p_fsm_jukebox->p_fsm_buzzer, STOP);
-        _show_state("STOP");
+        _set_action(p_fsm_jukebox, STOP);
         return;
     }
     if(!strcmp(p_command,"pause")){
-        fsm_buzzer_set_action(p_fsm_jukebox->p_fsm_buzzer, PAUSE);
-        _show_state("PAUSE");
+        _set_action(p_fsm_jukebox, PAUSE);
         return;
     }
     if(!strcmp(p_command,"speed")){
         double param = atof(p_param);
-        fsm_buzzer_set_speed(p_fsm_jukebox->p_fsm_buzzer, MAX(param, 0.1));
-        (p_fsm_jukebox->volume) = MAX(param, 0.1);
+        _set_speed(p_fsm_jukebox, MAX(param, 0.1));
         return;
     }
-    if(!strcmp(p_command,"volume")){
-        double param = atof(p_param);
-        fsm_buzzer_set_volume(p_fsm_jukebox->p_fsm_buzzer, MIN(param, 1.0));
-        (p_fsm_jukebox->volume) = MIN(param, 1.0);
-        char buffer[3];
-        sprintf(buffer, "%d", (int)((p_fsm_jukebox->volume)*100));
-        _show_vol(buffer);
-        char msg[USART_OUTPUT_BUFFER_LENGTH];
-        sprintf(msg, "Current volume: %s%%\n", buffer);
-        _send(p_fsm_jukebox->p_fsm_usart, msg);
+    if(!strcmp(p_command,"tempo")){
+        _set_tempo(p_fsm_jukebox, p_param);
         return;
     }
-    if(!strcmp(p_command,"next")){
-        _set_next_song(p_fsm_jukebox);
+    if(!strcmp(p_command,"transpose")){
+        _set_transpose(p_fsm_jukebox, p_param);
+        return;
+    }
+    if(!strcmp(p_command,"volume")){
+        double param = atof(p_param);
+        _send_volume(p_fsm_jukebox, _set_volume(p_fsm_jukebox, MIN(param, 1.0)));
         return;
     }
     if(!strcmp(p_command,"next")){
@@ -209,56 +664,215 @@ void _execute_command(fsm_jukebox_t * p_fsm_jukebox, char * p_command, char * p_
         return;
     }
     if(!strcmp(p_command,"select")){
-        uint32_t melody_selected = atoi(p_param);
-        if(p_fsm_jukebox->melodies[melody_selected].melody_length > 0){
-            
-            fsm_buzzer_set_action(p_fsm_jukebox->p_fsm_buzzer, STOP);
-            p_fsm_jukebox->melody_idx = melody_selected;
-            const melody_t* melody = &p_fsm_jukebox->melodies[p_fsm_jukebox->melody_idx];
-            fsm_buzzer_set_melody(p_fsm_jukebox->p_fsm_buzzer, melody);
-            p_fsm_jukebox->p_melody = p_fsm_jukebox->melodies[p_fsm_jukebox->melody_idx].p_name;
-            fsm_buzzer_set_action(p_fsm_jukebox->p_fsm_buzzer, PLAY);
-            _show_song(p_fsm_jukebox->p_melody);
+        // By index, by name or by the beginning of the name: `select 2`, `select Tetris`, `select tet`
+        uint32_t melody_idx = isdigit((unsigned char)p_param[0]) ? (uint32_t)atoi(p_param) : _find_melody(p_fsm_jukebox, p_param, false);
+        if(_select_melody(p_fsm_jukebox, melody_idx)){
             return;
         }
-        _send(p_fsm_jukebox->p_fsm_usart, "Error: Melody not found :(\n");
+        _send(p_fsm_jukebox, "Error: Melody not found :(\n");
         return;
     }
-    if(!strcmp(p_command,"info")){
-        char msg[USART_OUTPUT_BUFFER_LENGTH];
-        sprintf(msg, "Playing: %s\n", p_fsm_jukebox->p_melody);
-        _send(p_fsm_jukebox->p_fsm_usart, msg);
+    if(!strcmp(p_command,"queue")){
+        _execute_queue(p_fsm_jukebox, p_param);
         return;
     }
-    if(!strcmp(p_command,"game")){
+    if(!strcmp(p_command,"dequeue")){
+        uint32_t melody_idx;
         char msg[USART_OUTPUT_BUFFER_LENGTH];
-        sprintf(msg, "Gaming\n");
-        _send(p_fsm_jukebox->p_fsm_usart, msg);
-        uint32_t melody_selected = _random(0,7);
-        if(p_fsm_jukebox->melodies[melody_selected].melody_length > 0){
-            port_lcd_clear();
-            port_lcd_set_cursor(0,0);
-            port_lcd_print_str("Try to guess");
-            port_lcd_set_cursor(0,1);
-            port_lcd_print_str("the song");
-            port_lcd_set_cursor(0,0);
-            fsm_buzzer_set_action(p_fsm_jukebox->p_fsm_buzzer, STOP);
-            p_fsm_jukebox->melody_idx = melody_selected;
-            const melody_t* melody = &p_fsm_jukebox->melodies[p_fsm_jukebox->melody_idx];
-            fsm_buzzer_set_melody(p_fsm_jukebox->p_fsm_buzzer, melody);
-            p_fsm_jukebox->p_melody = p_fsm_jukebox->melodies[p_fsm_jukebox->melody_idx].p_name;
-            fsm_buzzer_set_action(p_fsm_jukebox->p_fsm_buzzer, PLAY);
-            p_fsm_jukebox->game_state = GAMING;
+        if(!playlist_dequeue(&p_fsm_jukebox->playlist, &melody_idx)){
+            _send(p_fsm_jukebox, "Error: Queue empty :(\n");
             return;
         }
+        sprintf(msg, "Dequeued: %s\n", _get_melody(p_fsm_jukebox, melody_idx)->p_name);
+        _send(p_fsm_jukebox, msg);
+        _requeue_next_song(p_fsm_jukebox);
+        return;
+    }
+    if(!strcmp(p_command,"clear")){
+        playlist_clear(&p_fsm_jukebox->playlist);
+        _send(p_fsm_jukebox, "Queue cleared\n");
+        _requeue_next_song(p_fsm_jukebox);
+        return;
+    }
+    if(!strcmp(p_command,"repeat")){
+        _set_repeat(p_fsm_jukebox, p_param);
+        return;
+    }
+    if(!strcmp(p_command,"shuffle")){
+        _set_shuffle(p_fsm_jukebox, p_param);
+        return;
+    }
+    if(!strcmp(p_command,"info")){
+        _send_info(p_fsm_jukebox);
+        return;
+    }
+    if(!strcmp(p_command,"baud")){
+        _set_baud_rate(p_fsm_jukebox, p_param);
+        return;
+    }
+    if(!strcmp(p_command,"latency")){
+        _show_latency(p_fsm_jukebox, p_param);
+        return;
+    }
+    if(!strcmp(p_command,"game")){
+        _start_game(p_fsm_jukebox, p_param);
         return;
     }
 
-    _send(p_fsm_jukebox->p_fsm_usart, "Error: Command not found :(\n");
+    _send(p_fsm_jukebox, "Error: Command not found :(\n");
     fsm_usart_reset_input_data(p_fsm_jukebox->p_fsm_usart);
     return;
 }
 
+/// @brief Stop the current melody if it is an uploaded one and go back to the first melody. Deleting, replacing or
+/// erasing uploaded melodies moves them in the store, so the buzzer must not keep playing them.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+static void _leave_store(fsm_jukebox_t * p_fsm_jukebox){
+    if(p_fsm_jukebox->melody_idx < MELODIES_LENGTH){
+        // The next melody may be an uploaded one, or the first one of the store
+        if(p_fsm_jukebox->in_playlist){
+            _queue_next_song(p_fsm_jukebox);
+        }
+        return;
+    }
+    fsm_buzzer_set_action(p_fsm_jukebox->p_fsm_buzzer, STOP);
+    p_fsm_jukebox->melody_idx = 0;
+    p_fsm_jukebox->in_playlist = false;
+    fsm_buzzer_set_melody(p_fsm_jukebox->p_fsm_buzzer, melody_registry_get(0));
+    p_fsm_jukebox->p_melody = melody_registry_get(0)->p_name;
+}
+
+/// @brief Status of a reply for a result of the melody store.
+/// @param status Result of the store.
+/// @return Status of the reply (see frame.h).
+static uint8_t _get_store_status(melody_store_status_t status){
+    switch(status){
+    case MELODY_STORE_OK:
+        return FRAME_STATUS_OK;
+    case MELODY_STORE_NO_SPACE:
+        return FRAME_STATUS_NO_SPACE;
+    case MELODY_STORE_FLASH_ERROR:
+        return FRAME_STATUS_FAILED;
+    default:
+        return FRAME_STATUS_BAD_PARAM;
+    }
+}
+
+/// @brief Execute a request of an upload (see melody_store.h). The uploaded melody gets the index
+/// `MELODIES_LENGTH` + its index in the store.
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param p_request Pointer to the request.
+/// @param p_reply Pointer to the reply, with status OK.
+static void _execute_upload(fsm_jukebox_t * p_fsm_jukebox, const frame_t * p_request, frame_t * p_reply){
+    melody_store_status_t status = MELODY_STORE_BAD_PARAM;
+    uint32_t melody_idx;
+    if(p_request->length < 2){
+        p_reply->payload[0] = FRAME_STATUS_BAD_PARAM;
+        return;
+    }
+    uint16_t value = frame_get_u16(p_request, 0);
+    uint16_t data_length = p_request->length - 2;
+    switch(p_request->opcode){
+    case FRAME_OP_UPLOAD_BEGIN:{
+        char name[MELODY_STORE_NAME_LENGTH] = {0};
+        memcpy(name, &p_request->payload[2], MIN(data_length, MELODY_STORE_NAME_LENGTH - 1));
+        if(strlen(name) == data_length){
+            status = melody_store_begin(&p_fsm_jukebox->store, name, value);
+        }
+        break;
+    }
+    case FRAME_OP_UPLOAD_DATA:
+        if((data_length > 0) && (data_length <= FRAME_UPLOAD_NOTES * MELODY_STORE_NOTE_BYTES) &&
+        (data_length % MELODY_STORE_NOTE_BYTES == 0)){
+            status = melody_store_write(&p_fsm_jukebox->store, value, &p_request->payload[2], data_length / MELODY_STORE_NOTE_BYTES);
+        }
+        break;
+    default:
+        status = melody_store_end(&p_fsm_jukebox->store, value, &melody_idx);
+        if(status == MELODY_STORE_OK){
+            _leave_store(p_fsm_jukebox); // The melody may have replaced the one being played
+            frame_put_u8(p_reply, MELODIES_LENGTH + melody_idx);
+            LOG_INFO(p_fsm_jukebox->p_fsm_log, "Uploaded melody %lu: %s", (unsigned long)(MELODIES_LENGTH + melody_idx),
+                     melody_store_get(&p_fsm_jukebox->store, melody_idx)->p_name);
+        }
+        break;
+    }
+    p_reply->payload[0] = _get_store_status(status);
+}
+
+/// @brief Execute a request of the binary protocol and send its reply (see frame.h).
+/// @param p_fsm_jukebox Pointer to the Jukebox FSM.
+/// @param p_request Pointer to the request.
+void _execute_frame(fsm_jukebox_t * p_fsm_jukebox, const frame_t * p_request){
+    frame_t reply;
+    frame_reply(p_request, FRAME_STATUS_OK, &reply);
+    switch(p_request->opcode){
+    case FRAME_OP_PLAY:
+        _set_action(p_fsm_jukebox, PLAY);
+        break;
+    case FRAME_OP_STOP:
+        _set_action(p_fsm_jukebox, STOP);
+        break;
+    case FRAME_OP_PAUSE:
+        _set_action(p_fsm_jukebox, PAUSE);
+        break;
+    case FRAME_OP_NEXT:
+        _set_next_song(p_fsm_jukebox);
+        frame_put_u8(&reply, p_fsm_jukebox->melody_idx);
+        break;
+    case FRAME_OP_SELECT:
+        if((p_request->length < 1) || !_select_melody(p_fsm_jukebox, p_request->payload[0])){
+            reply.payload[0] = FRAME_STATUS_BAD_PARAM;
+        }
+        break;
+    case FRAME_OP_VOLUME:
+        if((p_request->length < 1) || (p_request->payload[0] > 100)){
+            reply.payload[0] = FRAME_STATUS_BAD_PARAM;
+            break;
+        }
+        _set_volume(p_fsm_jukebox, p_request->payload[0] / 100.0);
+        break;
+    case FRAME_OP_SPEED:
+        if((p_request->length < 2) || (frame_get_u16(p_request, 0) < 10)){
+            reply.payload[0] = FRAME_STATUS_BAD_PARAM;
+            break;
+        }
+        _set_speed(p_fsm_jukebox, frame_get_u16(p_request, 0) / 100.0);
+        break;
+    case FRAME_OP_INFO:
+        frame_put_u8(&reply, p_fsm_jukebox->melody_idx);
+        frame_put_u8(&reply, (uint8_t)((p_fsm_jukebox->volume)*100 + 0.5));
+        frame_put_u8(&reply, fsm_buzzer_get_action(p_fsm_jukebox->p_fsm_buzzer));
+        break;
+    case FRAME_OP_TELEMETRY:
+        if(p_request->length < 2){
+            reply.payload[0] = FRAME_STATUS_BAD_PARAM;
+            break;
+        }
+        if(frame_get_u16(p_request, 0) == 0){
+            telemetry_stop(&p_fsm_jukebox->telemetry);
+            break;
+        }
+        if(!telemetry_start(&p_fsm_jukebox->telemetry, frame_get_u16(p_request, 0), port_system_get_millis())){
+            reply.payload[0] = FRAME_STATUS_BAD_PARAM;
+        }
+        break;
+    case FRAME_OP_UPLOAD_BEGIN:
+    case FRAME_OP_UPLOAD_DATA:
+    case FRAME_OP_UPLOAD_END:
+        _execute_upload(p_fsm_jukebox, p_request, &reply);
+        break;
+    case FRAME_OP_TEXT:
+        telemetry_stop(&p_fsm_jukebox->telemetry); // Records cannot be sent in a text session
+        fsm_usart_set_binary(p_fsm_jukebox->p_fsm_usart, false);
+        return;
+    default:
+        reply.payload[0] = FRAME_STATUS_UNKNOWN;
+        break;
+    }
+    _send_frame(p_fsm_jukebox->p_fsm_usart, &reply);
+}
+
 /* State machine input or transition functions */
 
 /// @brief Check if the button has been pressed for the required time to turn ON the Jukebox. 
@@ -290,7 +904,28 @@ static bool check_melody_finished(fsm_t * p_this){
 /// @return 
 static bool check_command_received(fsm_t * p_this){
     fsm_jukebox_t *p_fsm = (fsm_jukebox_t *)(p_this);
-    return fsm_usart_check_data_received(p_fsm->p_fsm_usart);
+    bool received = fsm_usart_check_data_received(p_fsm->p_fsm_usart);
+    if(received){
+        p_fsm->guard_cycles = port_system_get_cycles(); // Second timestamp of the command latency
+    }
+    return received;
+}
+
+/// @brief Check if the buzzer has gone on with the next melody at the end of the current one. 
+/// @param p_this Pointer to an fsm_t struct that contains an fsm_jukebox_t. 
+/// @return 
+static bool check_next_song_started(fsm_t * p_this){
+    fsm_jukebox_t *p_fsm = (fsm_jukebox_t *)(p_this);
+    return fsm_buzzer_get_next_started(p_fsm->p_fsm_buzzer);
+}
+
+/// @brief Check if the LCD has a change to show and no other has come for `LCD_REFRESH_HOLD_MS`. 
+/// @param p_this Pointer to an fsm_t struct that contains an fsm_jukebox_t. 
+/// @return 
+static bool check_show_lcd(fsm_t * p_this){
+    fsm_jukebox_t *p_fsm = (fsm_jukebox_t *)(p_this);
+    return (p_fsm->lcd_pending != LCD_VIEW_NONE) &&
+           ((port_system_get_millis() - p_fsm->lcd_changed_ms) >= LCD_REFRESH_HOLD_MS);
 }
 
 /// @brief Check if the button has been pressed for the required time to load the next song. 
@@ -312,7 +947,12 @@ static bool check_activity(fsm_t * p_this){
     return (
         (fsm_button_check_activity(p_fsm->p_fsm_button)) ||
         (fsm_usart_check_activity(p_fsm->p_fsm_usart)) ||
-        (fsm_buzzer_check_activity(p_fsm->p_fsm_buzzer))
+        (fsm_buzzer_check_activity(p_fsm->p_fsm_buzzer)) ||
+        (fsm_log_check_activity(p_fsm->p_fsm_log)) ||
+        (telemetry_is_on(&p_fsm->telemetry)) ||
+        (game_is_timed(&p_fsm->game)) ||
+        (settings_store_is_pending(&p_fsm->settings)) ||
+        (p_fsm->lcd_pending != LCD_VIEW_NONE)
     );
 }
 
@@ -323,6 +963,51 @@ static bool check_no_activity(fsm_t * p_this){
     return !check_activity(p_this);
 }
 
+/// @brief Check if a telemetry record is due. It is checked once per pass in WAIT_COMMAND, so it also counts the
+/// iterations of the main loop.
+/// @param p_this Pointer to an fsm_t struct that contains an fsm_jukebox_t.
+/// @return 
+static bool check_telemetry_due(fsm_t * p_this){
+    fsm_jukebox_t *p_fsm = (fsm_jukebox_t *)(p_this);
+    if(!telemetry_is_on(&p_fsm->telemetry)){
+        return false;
+    }
+    uint32_t now_ms = port_system_get_millis();
+    telemetry_count_loop(&p_fsm->telemetry, now_ms);
+    return telemetry_is_due(&p_fsm->telemetry, now_ms);
+}
+
+/// @brief Check if the time of a timed round of the game is over.
+/// @param p_this Pointer to an fsm_t struct that contains an fsm_jukebox_t.
+/// @return 
+static bool check_game_time_up(fsm_t * p_this){
+    fsm_jukebox_t *p_fsm = (fsm_jukebox_t *)(p_this);
+    return game_is_timed(&p_fsm->game) && game_check_time_up(&p_fsm->game, port_system_get_millis());
+}
+
+/// @brief Check if settings marked as changed are due to be written. It is checked once per pass in WAIT_COMMAND.
+/// @param p_this Pointer to an fsm_t struct that contains an fsm_jukebox_t.
+/// @return 
+static bool check_settings_due(fsm_t * p_this){
+    fsm_jukebox_t *p_fsm = (fsm_jukebox_t *)(p_this);
+    return settings_store_is_due(&p_fsm->settings, port_system_get_millis(), !fsm_buzzer_check_activity(p_fsm->p_fsm_buzzer));
+}
+
+/// @brief Check if the telemetry, a timed round of the game, settings not yet written or a change of the LCD are the
+/// only activity left: nothing to do until the next record, the end of the round, the write or the update. A record being sent does not count, as every byte ends with the TX interrupt.
+/// @param p_this Pointer to an fsm_t struct that contains an fsm_jukebox_t.
+/// @return 
+static bool check_telemetry_idle(fsm_t * p_this){
+    fsm_jukebox_t *p_fsm = (fsm_jukebox_t *)(p_this);
+    return (
+        ((telemetry_is_on(&p_fsm->telemetry)) || (game_is_timed(&p_fsm->game)) ||
+         (settings_store_is_pending(&p_fsm->settings)) || (p_fsm->lcd_pending != LCD_VIEW_NONE)) &&
+        !(fsm_button_check_activity(p_fsm->p_fsm_button)) &&
+        !(fsm_usart_check_data_received(p_fsm->p_fsm_usart)) &&
+        !(fsm_buzzer_check_activity(p_fsm->p_fsm_buzzer))
+    );
+}
+
 /* State machine output or action functions */
 
 /// @brief Initialize the Jukebox by playing the intro melody, at the beginning of the program. 
@@ -331,24 +1016,32 @@ static void do_start_up(fsm_t * p_this){
     fsm_jukebox_t *p_fsm = (fsm_jukebox_t *)(p_this);
     fsm_button_reset_duration(p_fsm->p_fsm_button);
     fsm_usart_enable_rx_interrupt(p_fsm->p_fsm_usart);
+    // The intro melody at its own speed: the saved one applies from the first melody of the jukebox
     fsm_buzzer_set_speed(p_fsm->p_fsm_buzzer, 1.0);
-    fsm_buzzer_set_melody(p_fsm->p_fsm_buzzer, &(p_fsm->melodies[0]));
+    fsm_buzzer_set_transpose(p_fsm->p_fsm_buzzer, 0);
+    fsm_buzzer_set_melody(p_fsm->p_fsm_buzzer, melody_registry_get(START_UP_MELODY_IDX));
     fsm_buzzer_set_action(p_fsm->p_fsm_buzzer, PLAY);
+    p_fsm->in_playlist = false;
+    // The cycle at which the user turns the jukebox on is never the same: a new shuffle every time
+    playlist_seed(&p_fsm->playlist, port_system_get_cycles());
     port_lcd_clear();
     port_lcd_set_cursor(0, 0);
     port_lcd_print_str("JUKEBOX ON");
     port_lcd_set_cursor(0, 1);
     port_lcd_print_str(":D");
     port_lcd_backlight();
-    printf("Jukebox ON :) \n");
+    LOG_INFO(p_fsm->p_fsm_log, "Jukebox ON :) \n");
 }
 
 /// @brief After playing the intro melody, start the Jukebox. 
 /// @param p_this 
 static void do_start_jukebox(fsm_t * p_this){
     fsm_jukebox_t *p_fsm = (fsm_jukebox_t *)(p_this);
-    (p_fsm->melody_idx) = 0;
-    (p_fsm->p_melody) = ((p_fsm->melodies[0]).p_name);
+    // Back to the melody and the speed of the last session
+    const melody_t* melody = _get_melody(p_fsm, p_fsm->melody_idx);
+    (p_fsm->p_melody) = melody->p_name;
+    fsm_buzzer_set_melody(p_fsm->p_fsm_buzzer, melody);
+    fsm_buzzer_set_speed(p_fsm->p_fsm_buzzer, p_fsm->speed);
 }
 
 /// @brief Shut off systems
@@ -357,10 +1050,14 @@ static void do_shut_off(fsm_t * p_this){
     fsm_jukebox_t *p_fsm = (fsm_jukebox_t *)(p_this);
     fsm_button_reset_duration(p_fsm->p_fsm_button);
     fsm_buzzer_set_action(p_fsm->p_fsm_buzzer, STOP);
-    _send(p_fsm->p_fsm_usart, "Jukebox OFF :( \n");
+    telemetry_stop(&p_fsm->telemetry);
+    game_give_up(&p_fsm->game);
+    p_fsm->lcd_pending = LCD_VIEW_NONE;
+    _send(p_fsm, "Jukebox OFF :( \n");
     fsm_buzzer_set_speed(p_fsm->p_fsm_buzzer, 1.0);
-    p_fsm->melody_idx = 0;
-    fsm_buzzer_set_melody(p_fsm->p_fsm_buzzer, &(p_fsm->melodies[7])); // Elegir canción de apagado
+    fsm_buzzer_set_transpose(p_fsm->p_fsm_buzzer, 0);
+    p_fsm->in_playlist = false;
+    fsm_buzzer_set_melody(p_fsm->p_fsm_buzzer, melody_registry_get(SHUT_OFF_MELODY_IDX));
     fsm_buzzer_set_action(p_fsm->p_fsm_buzzer, PLAY);
     port_lcd_clear();
     port_lcd_set_cursor(0, 0);
@@ -368,6 +1065,7 @@ static void do_shut_off(fsm_t * p_this){
     port_lcd_set_cursor(0, 1);
     port_lcd_print_str(":(");
     port_lcd_backlight();
+    _update_settings(p_fsm, port_system_get_millis());
 }
 
 /// @brief Stop jukebox system
@@ -377,9 +1075,13 @@ static void do_stop_jukebox(fsm_t * p_this){
     fsm_button_reset_duration(p_fsm->p_fsm_button);
     fsm_usart_disable_rx_interrupt(p_fsm->p_fsm_usart);
     fsm_usart_disable_tx_interrupt(p_fsm->p_fsm_usart);
+    fsm_usart_set_binary(p_fsm->p_fsm_usart, false); // The next session starts as text
     port_lcd_clear();
     port_lcd_no_backlight();
     fsm_buzzer_set_action(p_fsm->p_fsm_buzzer, STOP);
+    // Nothing plays: the settings are written now, erase included
+    _update_settings(p_fsm, port_system_get_millis());
+    _save_settings(p_fsm, true);
 }
 
 /// @brief Load the next song. 
@@ -388,21 +1090,423 @@ static void do_load_next_song(fsm_t * p_this){
     fsm_jukebox_t *p_fsm = (fsm_jukebox_t *)(p_this);
     _set_next_song(p_fsm);
     fsm_button_reset_duration(p_fsm->p_fsm_button);
+    _update_settings(p_fsm, port_system_get_millis());
 }
+/// @brief The buzzer has gone on with the next melody: follow it and prepare the one after it. The message and the LCD
+/// come after the first note, which has already started.
+/// @param p_this 
+static void do_next_song_started(fsm_t * p_this){
+    fsm_jukebox_t *p_fsm = (fsm_jukebox_t *)(p_this);
+    // The melody prepared by _queue_next_song(): the playlist moves on to it
+    uint32_t melody_idx = playlist_advance(&p_fsm->playlist, p_fsm->melody_idx, false);
+    if(melody_idx != PLAYLIST_NONE){
+        p_fsm->melody_idx = melody_idx;
+    }
+    p_fsm->p_melody = _get_melody(p_fsm, p_fsm->melody_idx)->p_name;
+    _queue_next_song(p_fsm);
+    char msg[USART_OUTPUT_BUFFER_LENGTH];
+    sprintf(msg, "Now playing: %s :) \n", p_fsm->p_melody);
+    _send(p_fsm, msg);
+    _set_lcd_view(p_fsm, LCD_VIEW_SONG, NULL);
+    _update_settings(p_fsm, port_system_get_millis());
+}
+
+/// @brief Show the last change on the LCD. 
+/// @param p_this 
+static void do_show_lcd(fsm_t * p_this){
+    fsm_jukebox_t *p_fsm = (fsm_jukebox_t *)(p_this);
+    uint8_t view = p_fsm->lcd_pending;
+    p_fsm->lcd_pending = LCD_VIEW_NONE;
+    if(view == LCD_VIEW_SONG){
+        _show_song(p_fsm->p_melody);
+    } else if(view == LCD_VIEW_STATE){
+        _show_state(p_fsm->p_lcd_state);
+    } else if(view == LCD_VIEW_GAME){
+        _show_game();
+    } else{
+        char buffer[12];
+        sprintf(buffer, "%d", (int)((p_fsm->volume)*100));
+        _show_vol(buffer);
+    }
+}
+
+/// @brief Start the measurement of the latency of a command.
+/// @param p_fsm Pointer to the Jukebox FSM.
+/// @param p_name Command text.
+static void _start_latency(fsm_jukebox_t * p_fsm, const char * p_name){
+    _update_latency(p_fsm);
+    latency_start(&p_fsm->latency, p_name, fsm_usart_get_rx_cycles(p_fsm->p_fsm_usart), p_fsm->guard_cycles);
+    fsm_buzzer_watch_note(p_fsm->p_fsm_buzzer);
+}
+
+/// @brief Decode and execute a frame of a binary session. Broken frames are answered with `FRAME_OP_ERROR`.
+/// @param p_fsm Pointer to the Jukebox FSM.
+/// @param p_data Pointer to the frame, without its delimiter.
+/// @param length Bytes of the frame.
+static void _read_frame(fsm_jukebox_t * p_fsm, const uint8_t * p_data, uint32_t length){
+    frame_t request;
+    if(!frame_decode(p_data, length, &request)){
+        frame_t reply;
+        request.opcode = FRAME_OP_ERROR;
+        request.seq = 0;
+        frame_reply(&request, FRAME_STATUS_BAD_FRAME, &reply);
+        _send_frame(p_fsm->p_fsm_usart, &reply);
+        return;
+    }
+    char name[LATENCY_NAME_LENGTH];
+    snprintf(name, sizeof(name), "#%s", frame_get_opcode_name(request.opcode));
+    _start_latency(p_fsm, name);
+    _execute_frame(p_fsm, &request);
+    latency_executed(&p_fsm->latency, port_system_get_cycles());
+}
+
+/// @brief Execute a text command and measure its response time.
+/// @param p_fsm Pointer to the Jukebox FSM.
+/// @param p_command Pointer to the command.
+/// @param p_param Pointer to the parameter of the command, or " " for none.
+static void _run_command(fsm_jukebox_t * p_fsm, char * p_command, char * p_param){
+    // Measure the response time of every command but the one that reports it
+    bool measured = strcmp(p_command, "latency");
+    if(measured){
+        char name[2 * (USART_INPUT_BUFFER_LENGTH + 1)]; // Command, space, parameter and end character
+        if(strcmp(p_param, " ")){
+            snprintf(name, sizeof(name), "%s %s", p_command, p_param);
+        } else{
+            snprintf(name, sizeof(name), "%s", p_command);
+        }
+        _start_latency(p_fsm, name);
+    }
+    _execute_command(p_fsm, p_command, p_param);
+    if(measured){
+        latency_executed(&p_fsm->latency, port_system_get_cycles());
+    }
+}
+
+/// @brief Skip a word at the start of a text, after any spaces.
+/// @param p_text Pointer to the text.
+/// @param p_word Pointer to the word.
+/// @return Pointer to the text after the word, or NULL if the text does not start with it.
+static char * _skip_word(char * p_text, const char * p_word){
+    size_t length = strlen(p_word);
+    p_text += strspn(p_text, " ");
+    if(strncmp(p_text, p_word, length) || ((p_text[length] != ' ') && (p_text[length] != '\0'))){
+        return NULL;
+    }
+    return p_text + length;
+}
+
+/// @brief Execute an instruction of a macro (see macro.h) with the same helpers as `_execute_frame()`, and the replies
+/// of the text commands. Its response time is measured under the name of the command.
+/// @param p_fsm Pointer to the Jukebox FSM.
+/// @param opcode Opcode of the instruction.
+/// @param operand Index of the melody, percent of the volume or of the speed.
+static void _execute_instruction(fsm_jukebox_t * p_fsm, uint8_t opcode, uint16_t operand){
+    _start_latency(p_fsm, frame_get_opcode_name(opcode));
+    switch(opcode){
+    case FRAME_OP_PLAY:
+        _set_action(p_fsm, PLAY);
+        break;
+    case FRAME_OP_STOP:
+        _set_action(p_fsm, STOP);
+        break;
+    case FRAME_OP_PAUSE:
+        _set_action(p_fsm, PAUSE);
+        break;
+    case FRAME_OP_NEXT:
+        _set_next_song(p_fsm);
+        break;
+    case FRAME_OP_SELECT:
+        if(!_select_melody(p_fsm, operand)){
+            _send(p_fsm, "Error: Melody not found :(\n");
+        }
+        break;
+    case FRAME_OP_VOLUME:
+        _send_volume(p_fsm, _set_volume(p_fsm, operand / 100.0));
+        break;
+    case FRAME_OP_SPEED:
+        _set_speed(p_fsm, operand / 100.0);
+        break;
+    case FRAME_OP_INFO:
+        _send_info(p_fsm);
+        break;
+    default:
+        break;
+    }
+    latency_executed(&p_fsm->latency, port_system_get_cycles());
+}
+
+/// @brief Execute a macro command (see macro.h): `define <name> <commands>`, `run <name>`, `show <name>` or
+/// `delete <name>`. The instructions of a macro run as a batch, each one with its own reply and response time.
+/// @param p_fsm Pointer to the Jukebox FSM.
+/// @param p_text Pointer to the text after `macro`.
+static void _execute_macro(fsm_jukebox_t * p_fsm, char * p_text){
+    char msg[USART_OUTPUT_BUFFER_LENGTH];
+    char *p_action = _next_token(&p_text);
+    char *p_name = _next_token(&p_text);
+    if((p_action == NULL) || (p_name == NULL)){
+        _send(p_fsm, "Error: Command not found :(\n");
+        return;
+    }
+    if(!strcmp(p_action, "define")){
+        const macro_t *p_macro = macro_define(&p_fsm->macros, p_name, p_text);
+        if(p_macro == NULL){
+            _send(p_fsm, "Error: Macro not valid :(\n");
+            return;
+        }
+        sprintf(msg, "Macro %s: %u bytes\n", p_macro->name, (unsigned)p_macro->length);
+        _send(p_fsm, msg);
+        return;
+    }
+    if(!strcmp(p_action, "run")){
+        const macro_t *p_macro = macro_find(&p_fsm->macros, p_name);
+        if(p_macro == NULL){
+            _send(p_fsm, "Error: Macro not found :(\n");
+            return;
+        }
+        uint8_t opcode;
+        uint16_t operand;
+        size_t offset = 0;
+        while((offset = macro_next(p_macro->code, p_macro->length, offset, &opcode, &operand)) != 0){
+            _execute_instruction(p_fsm, opcode, operand);
+        }
+        return;
+    }
+    if(!strcmp(p_action, "show")){
+        const macro_t *p_macro = macro_find(&p_fsm->macros, p_name);
+        if(p_macro == NULL){
+            _send(p_fsm, "Error: Macro not found :(\n");
+            return;
+        }
+        // The text of a macro fits in a command line, so it fits in a reply: the newline is kept anyway
+        char p_command[MACRO_COMMAND_LENGTH];
+        char p_param[MACRO_PARAM_LENGTH];
+        const char *p_separator = " ";
+        size_t used = snprintf(msg, sizeof(msg) - 1, "Macro %s:", p_macro->name);
+        size_t offset = 0;
+        while(((offset = macro_decode(p_macro->code, p_macro->length, offset, p_command, p_param)) != 0) &&
+              (used < sizeof(msg) - 1)){
+            used += snprintf(&msg[used], sizeof(msg) - 1 - used, "%s%s%s%s", p_separator, p_command,
+                             p_param[0] ? " " : "", p_param);
+            p_separator = ";";
+        }
+        used = MIN(used, sizeof(msg) - 2);
+        msg[used] = '\n';
+        msg[used + 1] = '\0';
+        _send(p_fsm, msg);
+        return;
+    }
+    if(!strcmp(p_action, "delete")){
+        if(!macro_delete(&p_fsm->macros, p_name)){
+            _send(p_fsm, "Error: Macro not found :(\n");
+            return;
+        }
+        sprintf(msg, "Macro %s deleted\n", p_name);
+        _send(p_fsm, msg);
+        return;
+    }
+    _send(p_fsm, "Error: Command not found :(\n");
+}
+
+/// @brief Execute a telemetry command (see telemetry.h): `on <period_ms>` or `off`. Records are binary frames, so
+/// `on` is acknowledged in text and the session becomes binary right after; the host ends it with `FRAME_OP_TEXT`.
+/// @param p_fsm Pointer to the Jukebox FSM.
+/// @param p_text Pointer to the text after `telemetry`.
+static void _execute_telemetry(fsm_jukebox_t * p_fsm, char * p_text){
+    char msg[USART_OUTPUT_BUFFER_LENGTH];
+    char *p_action = _next_token(&p_text);
+    char *p_period = _next_token(&p_text);
+    if((p_action != NULL) && !strcmp(p_action, "off") && (p_period == NULL)){
+        telemetry_stop(&p_fsm->telemetry);
+        _send(p_fsm, "Telemetry: off\n");
+        return;
+    }
+    if((p_action == NULL) || strcmp(p_action, "on") || (p_period == NULL)){
+        _send(p_fsm, "Error: Command not found :(\n");
+        return;
+    }
+    char *p_end;
+    unsigned long period_ms = strtoul(p_period, &p_end, 10);
+    if((*p_end != '\0') || (period_ms > TELEMETRY_MAX_PERIOD_MS) ||
+    !telemetry_start(&p_fsm->telemetry, period_ms, port_system_get_millis())){
+        _send(p_fsm, "Error: Telemetry period not valid :(\n");
+        return;
+    }
+    sprintf(msg, "Telemetry: %lu ms\n", period_ms);
+    _send(p_fsm, msg);
+    fsm_usart_set_binary_next(p_fsm->p_fsm_usart);
+}
+
+/// @brief Execute a command of the melody store (see melody_store.h): `store` reports the uploaded melodies and the
+/// free space, `store delete <name>` deletes a melody and `store erase` erases every uploaded melody. Melodies are
+/// uploaded through the binary protocol.
+/// @param p_fsm Pointer to the Jukebox FSM.
+/// @param p_text Pointer to the text after `store`.
+static void _execute_store(fsm_jukebox_t * p_fsm, char * p_text){
+    char msg[USART_OUTPUT_BUFFER_LENGTH];
+    char *p_action = _next_token(&p_text);
+    char *p_name = _next_token(&p_text);
+    if(p_action == NULL){
+        sprintf(msg, "Store: %lu melodies, %lu bytes free\n", (unsigned long)melody_store_get_num_melodies(&p_fsm->store),
+                (unsigned long)melody_store_get_free(&p_fsm->store));
+        _send(p_fsm, msg);
+        return;
+    }
+    if(!strcmp(p_action, "erase") && (p_name == NULL)){
+        _leave_store(p_fsm);
+        if(melody_store_erase(&p_fsm->store) != MELODY_STORE_OK){
+            _send(p_fsm, "Error: Store not erased :(\n");
+            return;
+        }
+        _send(p_fsm, "Store erased\n");
+        return;
+    }
+    if(!strcmp(p_action, "delete") && (p_name != NULL)){
+        uint32_t melody_idx = melody_store_find(&p_fsm->store, p_name, true);
+        if(melody_idx == MELODY_STORE_NOT_FOUND){
+            _send(p_fsm, "Error: Melody not found :(\n");
+            return;
+        }
+        if(melody_store_delete(&p_fsm->store, melody_idx) != MELODY_STORE_OK){
+            _send(p_fsm, "Error: Melody not deleted :(\n");
+            return;
+        }
+        _leave_store(p_fsm);
+        sprintf(msg, "Melody %s deleted\n", p_name);
+        _send(p_fsm, msg);
+        return;
+    }
+    _send(p_fsm, "Error: Command not found :(\n");
+}
+
+/// @brief Execute a command of the external storage (see melody_stream.h): `stream <n>` plays the melody `n` of the
+/// storage, from 0, through the prefetch window, so it can be longer than the memory of the MCU.
+/// @param p_fsm Pointer to the Jukebox FSM.
+/// @param p_text Pointer to the text after `stream`.
+static void _execute_stream(fsm_jukebox_t * p_fsm, char * p_text){
+    char msg[USART_OUTPUT_BUFFER_LENGTH];
+    char *p_index = _next_token(&p_text);
+    unsigned long index = 0;
+    if(p_index != NULL){
+        char *p_end;
+        index = strtoul(p_index, &p_end, 10);
+        if((*p_end != '\0') || (_next_token(&p_text) != NULL)){
+            _send(p_fsm, "Error: Command not found :(\n");
+            return;
+        }
+    }
+    uint32_t address;
+    if(!melody_stream_find(index, &address)){
+        _send(p_fsm, "Error: Melody not found :(\n");
+        return;
+    }
+    // Stopped first: the buzzer must not take notes from the stream while it is opened again
+    fsm_buzzer_set_action(p_fsm->p_fsm_buzzer, STOP);
+    if(!melody_stream_open(&p_fsm->stream, address)){
+        _send(p_fsm, "Error: Melody not found :(\n");
+        return;
+    }
+    const melody_t *p_melody = melody_stream_get_melody(&p_fsm->stream);
+    fsm_buzzer_set_stream(p_fsm->p_fsm_buzzer, &p_fsm->stream);
+    p_fsm->in_playlist = false;
+    fsm_buzzer_set_action(p_fsm->p_fsm_buzzer, PLAY);
+    p_fsm->p_melody = p_melody->p_name;
+    _set_lcd_view(p_fsm, LCD_VIEW_SONG, NULL);
+    sprintf(msg, "Streaming: %s, %lu notes\n", p_melody->p_name, (unsigned long)p_melody->melody_length);
+    _send(p_fsm, msg);
+}
+
+/// @brief Execute a line of text: a batch of commands separated by `;`, in order and in the same pass of the FSM, so
+/// no note is played and no reply is sent until the whole batch has run. Their replies are sent together.
+/// @param p_fsm Pointer to the Jukebox FSM.
+/// @param p_line Pointer to the line.
+static void _execute_line(fsm_jukebox_t * p_fsm, char * p_line){
+    char p_command[USART_INPUT_BUFFER_LENGTH + 1];
+    char p_param[USART_INPUT_BUFFER_LENGTH + 1];
+    while(p_line != NULL){
+        char *p_macro = _skip_word(p_line, "macro");
+        // A macro definition takes the rest of the line, separators included
+        char *p_next = (p_macro && _skip_word(p_macro, "define")) ? NULL : strchr(p_line, MACRO_SEPARATOR);
+        if(p_next != NULL){
+            *p_next++ = '\0';
+        }
+        char *p_telemetry = _skip_word(p_line, "telemetry");
+        char *p_store = _skip_word(p_line, "store");
+        char *p_stream = _skip_word(p_line, "stream");
+        if(p_macro != NULL){
+            _execute_macro(p_fsm, p_macro);
+        } else if(p_telemetry != NULL){
+            _execute_telemetry(p_fsm, p_telemetry);
+        } else if(p_store != NULL){
+            _execute_store(p_fsm, p_store);
+        } else if(p_stream != NULL){
+            _execute_stream(p_fsm, p_stream);
+        } else if(_parse_message(p_line, p_command, p_param)){
+            _run_command(p_fsm, p_command, p_param);
+        }
+        p_line = p_next;
+    }
+}
+
 /// @brief Read the command received by the USART. 
 /// @param p_this 
 static void do_read_command(fsm_t * p_this){
     fsm_jukebox_t *p_fsm = (fsm_jukebox_t *)(p_this);
-    char p_message[USART_INPUT_BUFFER_LENGTH];
-    char p_command[USART_INPUT_BUFFER_LENGTH];
-    char p_param[USART_INPUT_BUFFER_LENGTH];
-    fsm_usart_get_in_data(p_fsm->p_fsm_usart, p_message);
-    bool valid = _parse_message(p_message, p_command, p_param);
-    if(valid){
-        _execute_command(p_fsm, p_command, p_param);
+    char p_message[USART_INPUT_BUFFER_LENGTH + 1];
+    uint8_t p_frame[USART_FRAME_BUFFER_LENGTH];
+    uint32_t frame_length = fsm_usart_get_in_frame(p_fsm->p_fsm_usart, p_frame);
+    if(frame_length > 0){
+        _read_frame(p_fsm, p_frame, frame_length);
+        fsm_usart_reset_input_data(p_fsm->p_fsm_usart);
+    } else{
+        fsm_usart_get_in_data(p_fsm->p_fsm_usart, p_message);
+        p_message[USART_INPUT_BUFFER_LENGTH] = EMPTY_BUFFER_CONSTANT; // A full buffer has no end character
+        _execute_line(p_fsm, p_message);
+        fsm_usart_reset_input_data(p_fsm->p_fsm_usart);
+        memset(p_message, EMPTY_BUFFER_CONSTANT, USART_INPUT_BUFFER_LENGTH);
     }
-    fsm_usart_reset_input_data(p_fsm->p_fsm_usart);
-    memset(p_message, EMPTY_BUFFER_CONSTANT, USART_INPUT_BUFFER_LENGTH);
+    // Any command may have changed the volume, the speed, the melody or the game
+    _update_settings(p_fsm, port_system_get_millis());
+}
+
+/// @brief Send a telemetry record with the fields that changed since the previous one.
+/// @param p_this 
+static void do_send_telemetry(fsm_t * p_this){
+    fsm_jukebox_t *p_fsm = (fsm_jukebox_t *)(p_this);
+    telemetry_record_t record;
+    record.fields[TELEMETRY_STATES] = telemetry_pack_states(fsm_get_state(p_this), fsm_get_state(p_fsm->p_fsm_button),
+                                                            fsm_get_state(p_fsm->p_fsm_usart), fsm_get_state(p_fsm->p_fsm_buzzer));
+    record.fields[TELEMETRY_MELODY] = p_fsm->melody_idx;
+    record.fields[TELEMETRY_NOTE] = (uint16_t)MIN(fsm_buzzer_get_note_index(p_fsm->p_fsm_buzzer), UINT16_MAX);
+    record.fields[TELEMETRY_VOLUME] = (uint16_t)((p_fsm->volume)*100 + 0.5);
+    record.fields[TELEMETRY_SPEED] = (uint16_t)((p_fsm->speed)*100 + 0.5);
+    record.fields[TELEMETRY_RX_OVERFLOWS] = (uint16_t)MIN(fsm_usart_get_rx_overflows(p_fsm->p_fsm_usart), UINT16_MAX);
+    record.fields[TELEMETRY_TX_OVERFLOWS] = (uint16_t)MIN(fsm_usart_get_tx_overflows(p_fsm->p_fsm_usart), UINT16_MAX);
+    record.fields[TELEMETRY_LOOPS] = telemetry_get_loops_per_s(&p_fsm->telemetry);
+    frame_t frame;
+    telemetry_encode(&p_fsm->telemetry, &record, port_system_get_millis(), &frame);
+    _send_frame(p_fsm->p_fsm_usart, &frame);
+}
+
+/// @brief The time of the round of the game is over: tell the answer.
+/// @param p_this 
+static void do_game_time_up(fsm_t * p_this){
+    fsm_jukebox_t *p_fsm = (fsm_jukebox_t *)(p_this);
+    _send_time_up(p_fsm);
+    _update_settings(p_fsm, port_system_get_millis());
+}
+
+/// @brief Write the settings that have changed.
+/// @param p_this 
+static void do_save_settings(fsm_t * p_this){
+    fsm_jukebox_t *p_fsm = (fsm_jukebox_t *)(p_this);
+    _save_settings(p_fsm, !fsm_buzzer_check_activity(p_fsm->p_fsm_buzzer));
+}
+
+/// @brief Start the low power mode until the next interrupt while the telemetry or a timed round of the game is on:
+/// the SysTick keeps running, so the Jukebox wakes up at least once per millisecond to check the time.
+/// @param p_this 
+static void do_sleep_telemetry(fsm_t * p_this){
+    port_system_power_sleep();
 }
 
 /// @brief Start the low power mode while the Jukebox is OFF. 
@@ -442,27 +1546,33 @@ static fsm_trans_t fsm_trans_jukebox[] = {
     {SLEEP_WHILE_OFF, check_activity, OFF, NULL},
     {OFF, check_on, START_UP, do_start_up},
     {START_UP, check_melody_finished, WAIT_COMMAND, do_start_jukebox},
+    {WAIT_COMMAND, check_telemetry_due, WAIT_COMMAND, do_send_telemetry},
+    {WAIT_COMMAND, check_game_time_up, WAIT_COMMAND, do_game_time_up},
+    {WAIT_COMMAND, check_settings_due, WAIT_COMMAND, do_save_settings},
     {WAIT_COMMAND, check_off, SHUT_OFF, do_shut_off},
     {SHUT_OFF, check_melody_finished, OFF, do_stop_jukebox},
+    {WAIT_COMMAND, check_next_song_started, WAIT_COMMAND, do_next_song_started},
     {WAIT_COMMAND, check_next_song_button, WAIT_COMMAND, do_load_next_song},
     {WAIT_COMMAND, check_command_received, WAIT_COMMAND, do_read_command},
+    {WAIT_COMMAND, check_show_lcd, WAIT_COMMAND, do_show_lcd},
     {WAIT_COMMAND, check_no_activity, SLEEP_WHILE_ON, do_sleep_wait_command},
+    {WAIT_COMMAND, check_telemetry_idle, WAIT_COMMAND, do_sleep_telemetry},
     {SLEEP_WHILE_ON, check_no_activity, SLEEP_WHILE_ON, do_sleep_while_on},
     {SLEEP_WHILE_ON, check_activity, WAIT_COMMAND, NULL},
     {-1, NULL, -1, NULL },
 };
 
 /* Public functions */
-fsm_t *fsm_jukebox_new(fsm_t *p_fsm_button, uint32_t on_off_press_time_ms, fsm_t *p_fsm_usart, fsm_t *p_fsm_buzzer, uint32_t next_song_press_time_ms)
+fsm_t *fsm_jukebox_new(fsm_t *p_fsm_button, uint32_t on_off_press_time_ms, fsm_t *p_fsm_usart, fsm_t *p_fsm_buzzer, uint32_t next_song_press_time_ms, fsm_t *p_fsm_log)
 {
     fsm_t *p_fsm = malloc(sizeof(fsm_jukebox_t));
 
-    fsm_jukebox_init(p_fsm, p_fsm_button, on_off_press_time_ms, p_fsm_usart, p_fsm_buzzer, next_song_press_time_ms);
+    fsm_jukebox_init(p_fsm, p_fsm_button, on_off_press_time_ms, p_fsm_usart, p_fsm_buzzer, next_song_press_time_ms, p_fsm_log);
     
     return p_fsm;
 }
 
-void fsm_jukebox_init(fsm_t *p_this, fsm_t *p_fsm_button, uint32_t on_off_press_time_ms, fsm_t *p_fsm_usart, fsm_t *p_fsm_buzzer, uint32_t next_song_press_time_ms){
+void fsm_jukebox_init(fsm_t *p_this, fsm_t *p_fsm_button, uint32_t on_off_press_time_ms, fsm_t *p_fsm_usart, fsm_t *p_fsm_buzzer, uint32_t next_song_press_time_ms, fsm_t *p_fsm_log){
     fsm_init(p_this, fsm_trans_jukebox);
     fsm_jukebox_t *p_fsm = (fsm_jukebox_t *)(p_this);
     p_fsm->p_fsm_button = p_fsm_button;
@@ -470,17 +1580,24 @@ void fsm_jukebox_init(fsm_t *p_this, fsm_t *p_fsm_button, uint32_t on_off_press_
     p_fsm->p_fsm_usart = p_fsm_usart;
     p_fsm->p_fsm_buzzer = p_fsm_buzzer;
     p_fsm->next_song_press_time_ms = next_song_press_time_ms;
-    p_fsm->game_state = WAITING;
-    p_fsm->melody_idx = 0;
-    memset(p_fsm->melodies, EMPTY_BUFFER_CONSTANT, sizeof(p_fsm->melodies));
-    p_fsm->melodies[0] = scale_melody;
-    p_fsm->melodies[1] = happy_birthday_melody;
-    p_fsm->melodies[2] = tetris_melody;
-    p_fsm->melodies[3] = megalovania_melody;
-    p_fsm->melodies[4] = sailor_melody;
-    p_fsm->melodies[5] = espana_melody;
-    p_fsm->melodies[6] = mario_melody;
-    p_fsm->melodies[7] = iscale_melody;
-    p_fsm->volume = 0.5;
+    p_fsm->p_fsm_log = p_fsm_log;
+    game_init(&p_fsm->game);
+    p_fsm->game_answer[0] = '\0';
+    p_fsm->lcd_pending = LCD_VIEW_NONE;
+    p_fsm->p_lcd_state = NULL;
+    p_fsm->lcd_changed_ms = 0;
+    p_fsm->in_playlist = false;
+    p_fsm->guard_cycles = 0;
+    latency_init(&p_fsm->latency);
+    macro_table_init(&p_fsm->macros);
+    telemetry_init(&p_fsm->telemetry);
+    melody_store_mount(&p_fsm->store);
+    melody_stream_init(&p_fsm->stream);
+    // After the store: the saved melody may be an uploaded one
+    _restore_settings(p_fsm);
+    p_fsm->p_melody = _get_melody(p_fsm, p_fsm->melody_idx)->p_name;
+    // The melodies follow each other until the user stops them
+    playlist_init(&p_fsm->playlist, _get_num_melodies(p_fsm), port_system_get_cycles());
+    playlist_set_repeat(&p_fsm->playlist, PLAYLIST_REPEAT_ALL);
 }
 
@@ -0,0 +1,108 @@
+/**
+ * @file fsm_log.c
+ * @brief Log FSM main file.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fsm_log.h"
+#include "port_system.h"
+
+/* State machine input or transition functions */
+
+/// @brief Check if there are characters to drain
+/// @param p_this Pointer to an fsm_t struct that contains an fsm_log_t
+/// @return true if the buffer is not empty
+static bool check_pending(fsm_t *p_this){
+    fsm_log_t *p_fsm = (fsm_log_t *)(p_this);
+    return p_fsm->count > 0;
+}
+
+/// @brief Check if every character has been drained
+/// @param p_this Pointer to an fsm_t struct that contains an fsm_log_t
+/// @return true if the buffer is empty
+static bool check_empty(fsm_t *p_this){
+    return !check_pending(p_this);
+}
+
+/* State machine output or action functions */
+
+/// @brief Drain up to `LOG_DRAIN_CHARS` characters, while the channel takes them
+/// @param p_this Pointer to an fsm_t struct that contains an fsm_log_t
+static void do_drain(fsm_t *p_this){
+    fsm_log_t *p_fsm = (fsm_log_t *)(p_this);
+    for(uint32_t i = 0; (i < LOG_DRAIN_CHARS) && (p_fsm->count > 0); i++){
+        if(!port_system_log_put_char(p_fsm->buffer[p_fsm->head])){
+            return; // Busy: the rest waits for the next pass
+        }
+        p_fsm->head = (p_fsm->head + 1) % LOG_BUFFER_LENGTH;
+        p_fsm->count--;
+    }
+}
+
+static fsm_trans_t fsm_trans_log[] = {
+    {LOG_IDLE, check_pending, LOG_DRAIN, do_drain },
+    {LOG_DRAIN, check_pending, LOG_DRAIN, do_drain },
+    {LOG_DRAIN, check_empty, LOG_IDLE, NULL },
+    {-1, NULL, -1, NULL },
+}; /*!< Array that contains the transitions table for the FSM */
+
+/* Public functions */
+void fsm_log_printf(fsm_t *p_this, const char *p_format, ...){
+    fsm_log_t *p_fsm = (fsm_log_t *)(p_this);
+    char line[LOG_LINE_LENGTH];
+    va_list args;
+    va_start(args, p_format);
+    int length = vsnprintf(line, sizeof(line), p_format, args);
+    va_end(args);
+    if(length <= 0){
+        return;
+    }
+    if(length >= LOG_LINE_LENGTH){
+        length = LOG_LINE_LENGTH - 1;
+    }
+    // The whole message or nothing: half a line would be harder to read than a missing one
+    if((uint32_t)length > (uint32_t)(LOG_BUFFER_LENGTH - p_fsm->count)){
+        p_fsm->dropped++;
+        return;
+    }
+    uint32_t tail = p_fsm->head + p_fsm->count;
+    for(int i = 0; i < length; i++){
+        p_fsm->buffer[tail++ % LOG_BUFFER_LENGTH] = line[i];
+    }
+    p_fsm->count += (uint16_t)length;
+}
+
+uint32_t fsm_log_get_pending(fsm_t *p_this){
+    fsm_log_t *p_fsm = (fsm_log_t *)(p_this);
+    return p_fsm->count;
+}
+
+uint32_t fsm_log_get_dropped(fsm_t *p_this){
+    fsm_log_t *p_fsm = (fsm_log_t *)(p_this);
+    return p_fsm->dropped;
+}
+
+bool fsm_log_check_activity(fsm_t *p_this){
+    return check_pending(p_this);
+}
+
+void fsm_log_init(fsm_t *p_this){
+    fsm_log_t *p_fsm = (fsm_log_t *)(p_this);
+    fsm_init(p_this, fsm_trans_log);
+    p_fsm->head = 0;
+    p_fsm->count = 0;
+    p_fsm->dropped = 0;
+}
+
+fsm_t *fsm_log_new(void){
+    fsm_t *p_fsm = malloc(sizeof(fsm_log_t)); /* Do malloc to reserve memory of all other FSM elements, although it is interpreted as fsm_t (the first element of the structure) */
+    fsm_log_init(p_fsm);
+    return p_fsm;
+}
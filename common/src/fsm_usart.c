@@ -12,9 +12,52 @@
 #include <stdlib.h>
 
 /* Other libraries */
+#include "port_system.h"
 #include "port_usart.h"
 #include "fsm_usart.h"
 
+/* Private functions */
+
+/// @brief Changes the baud rate and starts the time to confirm it
+/// @param p_fsm Pointer to the UART FSM
+static void _change_baud_rate(fsm_usart_t *p_fsm){
+    p_fsm->baud_rate_previous = port_usart_get_baud_rate(p_fsm->usart_id);
+    port_usart_set_baud_rate(p_fsm->usart_id, p_fsm->baud_rate_next);
+    p_fsm->baud_rate_next = 0;
+    p_fsm->baud_rate_deadline = port_system_get_millis() + USART_BAUD_RATE_CONFIRM_TIME_MS;
+    if (p_fsm->baud_rate_deadline == 0){
+        p_fsm->baud_rate_deadline = 1; // 0 means confirmed
+    }
+}
+
+/// @brief Adds a frame to the queue of frames to send
+/// @param p_fsm Pointer to the UART FSM
+/// @param p_data Pointer to the frame
+/// @param length Bytes of the frame
+static void _queue_push(fsm_usart_t *p_fsm, const uint8_t *p_data, uint32_t length){
+    if((length == 0) || (length >= USART_OUTPUT_BUFFER_LENGTH) || (length + 1 > (uint32_t)(USART_TX_QUEUE_LENGTH - p_fsm->tx_queue_count))){
+        p_fsm->tx_overflows++;
+        return;
+    }
+    uint32_t tail = p_fsm->tx_queue_head + p_fsm->tx_queue_count;
+    p_fsm->tx_queue[tail++ % USART_TX_QUEUE_LENGTH] = (uint8_t)length;
+    for(uint32_t i = 0; i < length; i++){
+        p_fsm->tx_queue[tail++ % USART_TX_QUEUE_LENGTH] = p_data[i];
+    }
+    p_fsm->tx_queue_count += (uint8_t)(length + 1);
+}
+
+/// @brief Moves the first frame of the queue to the output data
+/// @param p_fsm Pointer to the UART FSM
+static void _queue_pop(fsm_usart_t *p_fsm){
+    uint32_t length = p_fsm->tx_queue[p_fsm->tx_queue_head];
+    for(uint32_t i = 0; i < length; i++){
+        p_fsm->out_data[i] = (char)p_fsm->tx_queue[(p_fsm->tx_queue_head + 1 + i) % USART_TX_QUEUE_LENGTH];
+    }
+    p_fsm->tx_queue_head = (uint8_t)((p_fsm->tx_queue_head + 1 + length) % USART_TX_QUEUE_LENGTH);
+    p_fsm->tx_queue_count -= (uint8_t)(length + 1);
+}
+
 /* State machine input or transition functions */
 
 /// @brief Checks if there is received data
@@ -41,13 +84,27 @@ static bool check_tx_end(fsm_t *p_this){
     return port_usart_tx_done(p_fsm->usart_id);
 }
 
+/// @brief Checks if a new baud rate was not confirmed in time
+/// @param p_this Pointer to an fsm struct that corresponds to an UART
+/// @return True if the time to confirm it is over, false if not
+static bool check_baud_rate_timeout(fsm_t *p_this){
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    return (p_fsm->baud_rate_deadline != 0) && ((int32_t)(port_system_get_millis() - p_fsm->baud_rate_deadline) >= 0);
+}
+
 /* State machine output or action functions */
 
 /// @brief Gets received data
 /// @param p_this Pointer to an fsm struct that corresponds to an UART
 static void do_get_data_rx(fsm_t *p_this){
     fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
-    port_usart_get_from_input_buffer(p_fsm->usart_id, p_fsm->in_data);
+    if(port_usart_get_binary(p_fsm->usart_id)){
+        p_fsm->in_frame_length = port_usart_get_from_frame_buffer(p_fsm->usart_id, p_fsm->in_frame);
+    } else{
+        port_usart_get_from_input_buffer(p_fsm->usart_id, p_fsm->in_data);
+        p_fsm->in_frame_length = 0;
+    }
+    p_fsm->rx_cycles = port_usart_get_rx_end_cycles(p_fsm->usart_id);
     port_usart_reset_input_buffer(p_fsm->usart_id);
     p_fsm->data_received = true;
 }
@@ -69,6 +126,25 @@ static void do_tx_end(fsm_t *p_this){
     fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
     port_usart_reset_output_buffer(p_fsm->usart_id);
     memset(p_fsm->out_data, EMPTY_BUFFER_CONSTANT, USART_OUTPUT_BUFFER_LENGTH);
+    // The data sent was the acknowledgement of the new baud rate or of the binary session
+    if(p_fsm->baud_rate_next){
+        _change_baud_rate(p_fsm);
+    }
+    if(p_fsm->binary_next){
+        port_usart_set_binary(p_fsm->usart_id, true);
+        p_fsm->binary_next = false;
+    }
+    if(p_fsm->tx_queue_count > 0){
+        _queue_pop(p_fsm);
+    }
+}
+
+/// @brief Returns to the previous baud rate: the other end did not confirm the new one
+/// @param p_this Pointer to an fsm struct that corresponds to an UART
+static void do_restore_baud_rate(fsm_t *p_this){
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    port_usart_set_baud_rate(p_fsm->usart_id, p_fsm->baud_rate_previous);
+    p_fsm->baud_rate_deadline = 0;
 }
 
 /// @brief Array containing the transition table for the UART FSM
@@ -76,6 +152,7 @@ static fsm_trans_t fsm_trans_usart[] = {
     {WAIT_DATA, check_data_tx, SEND_DATA, do_set_data_tx},
     {WAIT_DATA, check_data_rx, WAIT_DATA, do_get_data_rx},
     {SEND_DATA, check_tx_end, WAIT_DATA, do_tx_end},
+    {WAIT_DATA, check_baud_rate_timeout, WAIT_DATA, do_restore_baud_rate},
     {-1, NULL, -1, NULL },
 };
 
@@ -85,13 +162,88 @@ void fsm_usart_get_in_data(fsm_t *p_this, char *p_data){
     memcpy(p_data, p_fsm->in_data, USART_INPUT_BUFFER_LENGTH);
 }
 
+uint32_t fsm_usart_get_rx_cycles(fsm_t *p_this){
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    return p_fsm->rx_cycles;
+}
+
 void fsm_usart_set_out_data(fsm_t *p_this, char *p_data){
     fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
     // Ensure to reset the output data before setting a new one
     memset(p_fsm->out_data, EMPTY_BUFFER_CONSTANT, USART_OUTPUT_BUFFER_LENGTH);
-    memcpy(p_fsm->out_data, p_data, USART_OUTPUT_BUFFER_LENGTH);
+    // The messages are usually shorter than the buffer; a longer one is cut, and the memset above ends it
+    strncpy(p_fsm->out_data, p_data, USART_OUTPUT_BUFFER_LENGTH - 1);
 }
 
+void fsm_usart_append_out_data(fsm_t *p_this, const char *p_data){
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    const char *p_end = memchr(p_fsm->out_data, EMPTY_BUFFER_CONSTANT, USART_OUTPUT_BUFFER_LENGTH);
+    size_t length = p_end ? (size_t)(p_end - p_fsm->out_data) : USART_OUTPUT_BUFFER_LENGTH;
+    strncpy(&p_fsm->out_data[length], p_data, USART_OUTPUT_BUFFER_LENGTH - length);
+}
+
+uint32_t fsm_usart_get_in_frame(fsm_t *p_this, uint8_t *p_data){
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    memcpy(p_data, p_fsm->in_frame, p_fsm->in_frame_length);
+    return p_fsm->in_frame_length;
+}
+
+void fsm_usart_set_out_frame(fsm_t *p_this, const uint8_t *p_data, uint32_t length){
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    // A reply must not overwrite the telemetry record being sent, nor overtake the frames waiting for it
+    if((p_fsm->f.current_state == SEND_DATA) || (p_fsm->out_data[0] != EMPTY_BUFFER_CONSTANT) || (p_fsm->tx_queue_count > 0)){
+        _queue_push(p_fsm, p_data, length);
+        return;
+    }
+    memset(p_fsm->out_data, EMPTY_BUFFER_CONSTANT, USART_OUTPUT_BUFFER_LENGTH);
+    memcpy(p_fsm->out_data, p_data, (length < USART_OUTPUT_BUFFER_LENGTH) ? length : USART_OUTPUT_BUFFER_LENGTH);
+}
+
+bool fsm_usart_get_binary(fsm_t *p_this){
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    return port_usart_get_binary(p_fsm->usart_id);
+}
+
+void fsm_usart_set_binary(fsm_t *p_this, bool binary){
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    port_usart_set_binary(p_fsm->usart_id, binary);
+}
+
+void fsm_usart_set_binary_next(fsm_t *p_this){
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    p_fsm->binary_next = true;
+}
+
+uint32_t fsm_usart_get_rx_overflows(fsm_t *p_this){
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    return port_usart_get_rx_overflows(p_fsm->usart_id);
+}
+
+uint32_t fsm_usart_get_tx_overflows(fsm_t *p_this){
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    return p_fsm->tx_overflows;
+}
+
+bool fsm_usart_set_baud_rate(fsm_t *p_this, uint32_t baud_rate){
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    if(!port_usart_check_baud_rate(p_fsm->usart_id, baud_rate)){
+        return false;
+    }
+    p_fsm->baud_rate_next = baud_rate;
+    return true;
+}
+
+uint32_t fsm_usart_get_baud_rate(fsm_t *p_this){
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    return p_fsm->baud_rate_next ? p_fsm->baud_rate_next : port_usart_get_baud_rate(p_fsm->usart_id);
+}
+
+bool fsm_usart_confirm_baud_rate(fsm_t *p_this){
+    fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
+    bool pending = (p_fsm->baud_rate_deadline != 0);
+    p_fsm->baud_rate_deadline = 0;
+    return pending;
+}
 
 fsm_t *fsm_usart_new(uint32_t usart_id){
     fsm_t *p_fsm = malloc(sizeof(fsm_usart_t)); /* Do malloc to reserve memory of all other FSM elements, although it is interpreted as fsm_t (the first element of the structure) */
@@ -105,9 +257,19 @@ void fsm_usart_init(fsm_t *p_this, uint32_t usart_id){
     fsm_init(p_this, fsm_trans_usart);
     p_fsm->usart_id = usart_id;
     p_fsm->data_received = false;
+    p_fsm->rx_cycles = 0;
+    p_fsm->in_frame_length = 0;
+    p_fsm->baud_rate_next = 0;
+    p_fsm->baud_rate_previous = 0;
+    p_fsm->baud_rate_deadline = 0;
+    p_fsm->binary_next = false;
+    p_fsm->tx_queue_head = 0;
+    p_fsm->tx_queue_count = 0;
+    p_fsm->tx_overflows = 0;
     memset(p_fsm->in_data, EMPTY_BUFFER_CONSTANT, USART_INPUT_BUFFER_LENGTH);
     memset(p_fsm->out_data, EMPTY_BUFFER_CONSTANT, USART_OUTPUT_BUFFER_LENGTH);
     port_usart_init(p_fsm->usart_id);
+    port_usart_set_binary(p_fsm->usart_id, false);
 }
 
 bool fsm_usart_check_data_received(fsm_t *p_this){
@@ -118,6 +280,7 @@ bool fsm_usart_check_data_received(fsm_t *p_this){
 void fsm_usart_reset_input_data(fsm_t *p_this){
     fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
     memset(p_fsm->in_data, EMPTY_BUFFER_CONSTANT, USART_INPUT_BUFFER_LENGTH);
+    p_fsm->in_frame_length = 0;
     p_fsm->data_received = false;
 }
 
@@ -144,5 +307,5 @@ void fsm_usart_enable_tx_interrupt(fsm_t *p_this){
 
 bool fsm_usart_check_activity(fsm_t *p_this){
     fsm_usart_t *p_fsm = (fsm_usart_t *)(p_this);
-    return ((((p_fsm->f).current_state)==SEND_DATA)||(p_fsm->data_received));
+    return ((((p_fsm->f).current_state)==SEND_DATA)||(p_fsm->data_received)||(p_fsm->baud_rate_deadline != 0));
 }
\ No newline at end of file
@@ -0,0 +1,271 @@
+/**
+ * @file game.c
+ * @brief Guess-the-song game: excerpts, fuzzy guesses and score.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <string.h>
+
+/* Other libraries */
+#include "game.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define GAME_SYMBOLS 38U                /*!< Symbols of the names: 26 letters, 10 digits, '_' and any other one */
+#define GAME_OTHER_SYMBOL 37U           /*!< Symbol of a character that is not in the names, equal to none */
+#define GAME_TOLERANCE_DIVIDER 4U       /*!< A guess is right with up to one edit per this many characters */
+
+/* Private functions ----------------------------------------------------------*/
+/**
+ * @brief Get the symbol of a character, ignoring case.
+ *
+ * @param c Character
+ * @return Symbol, from 0 to `GAME_SYMBOLS - 1`
+ */
+static uint32_t _get_symbol(char c)
+{
+    // Upper and lower case letters only differ in bit 5: no call to tolower() per character
+    uint32_t u = (unsigned char)c;
+    uint32_t letter = (u | 0x20U) - 'a';
+    if (letter < 26U)
+    {
+        return letter;
+    }
+    uint32_t digit = u - '0';
+    if (digit < 10U)
+    {
+        return 26U + digit;
+    }
+    return (u == '_') ? 36U : GAME_OTHER_SYMBOL;
+}
+
+/**
+ * @brief Get the positions of each symbol in the guess, a bit per character: the only work that depends on the guess.
+ *
+ * @param p_guess Guess
+ * @param p_peq Array of `GAME_SYMBOLS` words to store the positions
+ * @return Characters of the guess compared, up to `GAME_MAX_GUESS_LENGTH`
+ */
+static uint32_t _prepare_guess(const char *p_guess, uint32_t *p_peq)
+{
+    memset(p_peq, 0, GAME_SYMBOLS * sizeof(uint32_t));
+    uint32_t length = 0;
+    while ((p_guess[length] != '\0') && (length < GAME_MAX_GUESS_LENGTH))
+    {
+        p_peq[_get_symbol(p_guess[length])] |= 1UL << length;
+        length++;
+    }
+    p_peq[GAME_OTHER_SYMBOL] = 0;
+    return length;
+}
+
+/**
+ * @brief Get the edit distance of a prepared guess to a name, unless it cannot be below a bound.
+ *
+ * Each character of the name is a column of the matrix of the edit distance: `pv` and `mv` mark the rows that grow and
+ * drop by one from the row above, and the distance of the whole guess is kept in `score`. The top row grows by one per
+ * character, as the whole name is compared.
+ *
+ * @param p_peq Positions of the symbols in the guess
+ * @param guess_length Characters of the guess, from 1 to `GAME_MAX_GUESS_LENGTH`
+ * @param p_name Name
+ * @param name_length Characters of the name
+ * @param bound Distance to beat
+ * @return Edit distance, or `bound` if it is not below it
+ */
+static uint32_t _get_distance(const uint32_t *p_peq, uint32_t guess_length, const char *p_name, uint32_t name_length,
+                              uint32_t bound)
+{
+    uint32_t last = 1UL << (guess_length - 1);
+    uint32_t pv = (guess_length == GAME_MAX_GUESS_LENGTH) ? 0xFFFFFFFFU : (last << 1) - 1U;
+    uint32_t mv = 0;
+    uint32_t score = guess_length;
+    for (uint32_t j = 0; j < name_length; j++)
+    {
+        uint32_t eq = p_peq[_get_symbol(p_name[j])];
+        uint32_t xv = eq | mv;
+        uint32_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint32_t ph = mv | ~(xh | pv);
+        uint32_t mh = pv & xh;
+        if (ph & last)
+        {
+            score++;
+        }
+        else if (mh & last)
+        {
+            score--;
+        }
+        ph = (ph << 1) | 1U;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+        // Each character left takes one off the distance at most
+        uint32_t left = name_length - 1 - j;
+        if ((score > left) && (score - left >= bound))
+        {
+            return bound;
+        }
+    }
+    return score;
+}
+
+/**
+ * @brief End the round in course.
+ *
+ * @param p_game Pointer to the game
+ * @param won true if the round is won
+ */
+static void _end_round(game_t *p_game, bool won)
+{
+    p_game->on = false;
+    p_game->rounds++;
+    if (won)
+    {
+        p_game->wins++;
+        p_game->streak++;
+        p_game->best_streak = (p_game->streak > p_game->best_streak) ? p_game->streak : p_game->best_streak;
+    }
+    else
+    {
+        p_game->streak = 0;
+    }
+}
+
+/* Public functions -----------------------------------------------------------*/
+void game_init(game_t *p_game)
+{
+    memset(p_game, 0, sizeof(game_t));
+}
+
+const melody_t *game_start(game_t *p_game, const melody_t *p_melody, uint32_t answer, uint32_t offset,
+                           uint32_t limit_ms, uint32_t now_ms)
+{
+    if (p_game->on)
+    {
+        _end_round(p_game, false);
+    }
+    uint32_t length = (p_melody->melody_length < GAME_EXCERPT_NOTES) ? p_melody->melody_length : GAME_EXCERPT_NOTES;
+    if (offset + length > p_melody->melody_length)
+    {
+        offset = p_melody->melody_length - length;
+    }
+
+    // The excerpt points into the melody: no copy of the notes
+    melody_t *p_excerpt = &p_game->excerpt;
+    *p_excerpt = *p_melody;
+    p_excerpt->p_notes = p_melody->p_notes + offset;
+    p_excerpt->p_durations = p_melody->p_durations + offset;
+    p_excerpt->melody_length = (uint16_t)length;
+    p_excerpt->p_effects = (p_melody->p_effects == NULL) ? NULL : p_melody->p_effects + offset;
+    p_excerpt->num_tracks = (p_melody->num_tracks < GAME_MAX_TRACKS) ? p_melody->num_tracks : GAME_MAX_TRACKS;
+    for (uint32_t track = 0; track < p_excerpt->num_tracks; track++)
+    {
+        p_game->tracks[track] = p_melody->p_tracks[track] + offset;
+    }
+    p_excerpt->p_tracks = (p_excerpt->num_tracks == 0) ? NULL : p_game->tracks;
+
+    p_game->on = true;
+    p_game->answer = answer;
+    p_game->start_ms = now_ms;
+    p_game->limit_ms = limit_ms;
+    p_game->wrong = 0;
+    return p_excerpt;
+}
+
+uint32_t game_distance(const char *p_guess, const char *p_name)
+{
+    uint32_t peq[GAME_SYMBOLS];
+    uint32_t guess_length = _prepare_guess(p_guess, peq);
+    uint32_t name_length = strlen(p_name);
+    if (guess_length == 0)
+    {
+        return name_length;
+    }
+    return _get_distance(peq, guess_length, p_name, name_length, guess_length + name_length + 1);
+}
+
+uint32_t game_match(const char *p_guess, const char *const *pp_names, uint32_t num_names, uint32_t *p_distance)
+{
+    uint32_t peq[GAME_SYMBOLS];
+    uint32_t guess_length = _prepare_guess(p_guess, peq);
+    uint32_t best = GAME_NO_MATCH;
+    uint32_t best_distance = GAME_NO_MATCH;
+    for (uint32_t idx = 0; idx < num_names; idx++)
+    {
+        uint32_t name_length = strlen(pp_names[idx]);
+        // The distance is at least the difference of the lengths
+        uint32_t difference = (name_length > guess_length) ? name_length - guess_length : guess_length - name_length;
+        if (difference >= best_distance)
+        {
+            continue;
+        }
+        uint32_t distance = (guess_length == 0) ? name_length
+                                                : _get_distance(peq, guess_length, pp_names[idx], name_length,
+                                                                best_distance);
+        if (distance < best_distance)
+        {
+            best = idx;
+            best_distance = distance;
+        }
+    }
+    *p_distance = best_distance;
+    return best;
+}
+
+game_result_t game_guess(game_t *p_game, uint32_t match, uint32_t distance, uint32_t answer_length, uint32_t now_ms,
+                         uint32_t *p_points)
+{
+    *p_points = 0;
+    if (game_check_time_up(p_game, now_ms))
+    {
+        return GAME_TIME_UP;
+    }
+    if ((match != p_game->answer) || (distance > answer_length / GAME_TOLERANCE_DIVIDER))
+    {
+        p_game->wrong++;
+        return GAME_WRONG;
+    }
+    uint32_t penalty = distance * GAME_DISTANCE_PENALTY + p_game->wrong * GAME_WRONG_PENALTY;
+    uint32_t points = (penalty + GAME_MIN_POINTS > GAME_POINTS) ? GAME_MIN_POINTS : GAME_POINTS - penalty;
+    points += p_game->streak * GAME_STREAK_BONUS;
+    p_game->score += points;
+    *p_points = points;
+    _end_round(p_game, true);
+    return GAME_RIGHT;
+}
+
+void game_give_up(game_t *p_game)
+{
+    if (p_game->on)
+    {
+        _end_round(p_game, false);
+    }
+}
+
+bool game_check_time_up(game_t *p_game, uint32_t now_ms)
+{
+    if (!game_is_timed(p_game) || (now_ms - p_game->start_ms < p_game->limit_ms))
+    {
+        return false;
+    }
+    _end_round(p_game, false);
+    return true;
+}
+
+bool game_is_on(const game_t *p_game)
+{
+    return p_game->on;
+}
+
+bool game_is_timed(const game_t *p_game)
+{
+    return p_game->on && (p_game->limit_ms > 0);
+}
+
+uint32_t game_get_answer(const game_t *p_game)
+{
+    return p_game->answer;
+}
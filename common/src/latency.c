@@ -0,0 +1,193 @@
+/**
+ * @file latency.c
+ * @brief Latency tracker of the USART commands.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <string.h>
+#include <stdio.h>
+
+/* Other libraries */
+#include "latency.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define LATENCY_OTHERS_NAME "*" /*!< Name of the entry that collects the commands that do not fit */
+
+/* Private functions */
+
+/// @brief Find the entry of a command, creating it if it is new.
+/// @param p_latency Pointer to the tracker
+/// @param p_name Command text
+/// @return Index of the entry
+static uint32_t _find_command(latency_t *p_latency, const char *p_name)
+{
+    uint32_t idx;
+    for (idx = 0; idx < p_latency->num_commands; idx++)
+    {
+        if (!strncmp(p_latency->commands[idx].name, p_name, LATENCY_NAME_LENGTH - 1))
+        {
+            return idx;
+        }
+    }
+    // The last entry is kept for the commands that do not fit
+    if (p_latency->num_commands == LATENCY_MAX_COMMANDS - 1)
+    {
+        p_name = LATENCY_OTHERS_NAME;
+    }
+    else if (p_latency->num_commands == LATENCY_MAX_COMMANDS)
+    {
+        return LATENCY_MAX_COMMANDS - 1;
+    }
+    idx = p_latency->num_commands++;
+    strncpy(p_latency->commands[idx].name, p_name, LATENCY_NAME_LENGTH - 1);
+    p_latency->commands[idx].name[LATENCY_NAME_LENGTH - 1] = '\0';
+    return idx;
+}
+
+/// @brief Add a measurement to a distribution.
+/// @param p_dist Pointer to the distribution
+/// @param cycles Latency
+static void _add_sample(latency_dist_t *p_dist, uint32_t cycles)
+{
+    if ((p_dist->count == 0) || (cycles < p_dist->min))
+    {
+        p_dist->min = cycles;
+    }
+    if (cycles > p_dist->max)
+    {
+        p_dist->max = cycles;
+    }
+    p_dist->sum += cycles;
+    p_dist->samples[p_dist->count % LATENCY_SAMPLES] = cycles;
+    p_dist->count++;
+}
+
+/// @brief Convert cycles to microseconds.
+/// @param cycles Cycles
+/// @param clock_hz Frequency of the cycle counter
+/// @return Microseconds
+static unsigned long _to_us(uint32_t cycles, uint32_t clock_hz)
+{
+    return (unsigned long)(((uint64_t)cycles * 1000000U) / clock_hz);
+}
+
+/* Public functions */
+void latency_init(latency_t *p_latency)
+{
+    memset(p_latency, 0, sizeof(latency_t));
+    p_latency->current = LATENCY_NONE;
+}
+
+void latency_start(latency_t *p_latency, const char *p_name, uint32_t rx_cycles, uint32_t guard_cycles)
+{
+    uint32_t idx = _find_command(p_latency, p_name);
+    p_latency->current = (int32_t)idx;
+    p_latency->note_pending = true;
+    p_latency->rx_cycles = rx_cycles;
+    _add_sample(&p_latency->commands[idx].stages[LATENCY_GUARD], guard_cycles - rx_cycles);
+}
+
+void latency_executed(latency_t *p_latency, uint32_t cycles)
+{
+    if (p_latency->current != LATENCY_NONE)
+    {
+        _add_sample(&p_latency->commands[p_latency->current].stages[LATENCY_EXECUTED], cycles - p_latency->rx_cycles);
+    }
+}
+
+void latency_note(latency_t *p_latency, uint32_t cycles)
+{
+    if (latency_note_pending(p_latency))
+    {
+        _add_sample(&p_latency->commands[p_latency->current].stages[LATENCY_NOTE], cycles - p_latency->rx_cycles);
+        p_latency->note_pending = false;
+    }
+}
+
+bool latency_note_pending(const latency_t *p_latency)
+{
+    return (p_latency->current != LATENCY_NONE) && p_latency->note_pending;
+}
+
+uint32_t latency_get_num_commands(const latency_t *p_latency)
+{
+    return p_latency->num_commands;
+}
+
+bool latency_get_stats(const latency_t *p_latency, uint32_t idx, uint32_t stage, latency_stats_t *p_stats)
+{
+    if ((idx >= p_latency->num_commands) || (stage >= LATENCY_NUM_STAGES))
+    {
+        return false;
+    }
+    const latency_dist_t *p_dist = &p_latency->commands[idx].stages[stage];
+    if (p_dist->count == 0)
+    {
+        return false;
+    }
+
+    // Sort the latest samples (insertion sort: there are only LATENCY_SAMPLES)
+    uint32_t sorted[LATENCY_SAMPLES];
+    uint32_t length = (p_dist->count < LATENCY_SAMPLES) ? p_dist->count : LATENCY_SAMPLES;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        uint32_t value = p_dist->samples[i];
+        uint32_t j = i;
+        while ((j > 0) && (sorted[j - 1] > value))
+        {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = value;
+    }
+
+    p_stats->count = p_dist->count;
+    p_stats->min = p_dist->min;
+    p_stats->p50 = sorted[length / 2];
+    p_stats->p90 = sorted[(length * 9) / 10];
+    p_stats->max = p_dist->max;
+    p_stats->mean = (uint32_t)(p_dist->sum / p_dist->count);
+    return true;
+}
+
+bool latency_format(const latency_t *p_latency, uint32_t idx, uint32_t clock_hz, char *p_buffer, size_t length)
+{
+    static const char *stage_names[LATENCY_NUM_STAGES] = {"guard", "exec", "note"};
+    if (idx >= p_latency->num_commands)
+    {
+        return false;
+    }
+
+    latency_stats_t stats = {0};
+    latency_get_stats(p_latency, idx, LATENCY_GUARD, &stats);
+    int used = snprintf(p_buffer, length, "%s n=%lu", p_latency->commands[idx].name, (unsigned long)stats.count);
+    for (uint32_t stage = 0; stage < LATENCY_NUM_STAGES; stage++)
+    {
+        if ((used < 0) || ((size_t)used >= length))
+        {
+            break;
+        }
+        if (latency_get_stats(p_latency, idx, stage, &stats))
+        {
+            used += snprintf(p_buffer + used, length - used, " %s %lu/%lu/%lu", stage_names[stage],
+                             _to_us(stats.p50, clock_hz), _to_us(stats.p90, clock_hz), _to_us(stats.max, clock_hz));
+        }
+        else
+        {
+            used += snprintf(p_buffer + used, length - used, " %s -", stage_names[stage]);
+        }
+    }
+    if ((used >= 0) && ((size_t)used < length))
+    {
+        used += snprintf(p_buffer + used, length - used, " us\n");
+    }
+    if ((used < 0) || ((size_t)used >= length))
+    {
+        p_buffer[length - 2] = '\n'; // Truncated: keep the end character of the line
+    }
+    return true;
+}
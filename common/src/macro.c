@@ -0,0 +1,281 @@
+/**
+ * @file macro.c
+ * @brief Named macros of text commands, compiled into the opcodes of the binary protocol.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Other libraries */
+#include "macro.h"
+#include "frame.h"
+#include "melody_registry.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define MACRO_TEXT_PARAM_LENGTH 16  /*!< Longest parameter of a command in the text of a macro, end character included */
+#define MACRO_MIN_SPEED 10          /*!< Lowest speed, in percent, as the text command saturates it */
+
+/* Private functions */
+/**
+ * @brief Get the opcode of a text command.
+ *
+ * @param p_command Pointer to the command, not ended by `'\0'`
+ * @param length Characters of the command
+ * @return Opcode, or 0 if the command cannot be stored in a macro
+ */
+static uint8_t _get_opcode(const char *p_command, size_t length)
+{
+    for (uint8_t opcode = FRAME_OP_PLAY; opcode <= FRAME_OP_INFO; opcode++)
+    {
+        const char *p_name = frame_get_opcode_name(opcode);
+        if ((strlen(p_name) == length) && !strncmp(p_name, p_command, length))
+        {
+            return opcode;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Compile a command and its parameter.
+ *
+ * @param opcode Opcode of the command
+ * @param p_param Pointer to the parameter, or NULL if there is none
+ * @param p_code Pointer to the bytecode of the command: opcode and up to 2 bytes of parameter
+ * @return Bytes of bytecode, or 0 if the parameter is wrong
+ */
+static size_t _compile_command(uint8_t opcode, const char *p_param, uint8_t *p_code)
+{
+    bool takes_param = (opcode == FRAME_OP_SELECT) || (opcode == FRAME_OP_VOLUME) || (opcode == FRAME_OP_SPEED);
+    if (takes_param != (p_param != NULL))
+    {
+        return 0;
+    }
+    p_code[0] = opcode;
+    if (!takes_param)
+    {
+        return 1;
+    }
+
+    char *p_end;
+    if (opcode == FRAME_OP_SELECT)
+    {
+        unsigned long index;
+        if (isdigit((unsigned char)p_param[0]))
+        {
+            index = strtoul(p_param, &p_end, 10);
+            if ((*p_end != '\0') || (index > UINT8_MAX))
+            {
+                return 0;
+            }
+        }
+        else
+        {
+            // A name is resolved now, so that the macro runs as fast as with the index
+            index = melody_registry_find_prefix(p_param);
+            if (index == MELODY_REGISTRY_NOT_FOUND)
+            {
+                return 0;
+            }
+        }
+        p_code[1] = (uint8_t)index;
+        return 2;
+    }
+    double value = strtod(p_param, &p_end);
+    if ((*p_end != '\0') || (value < 0))
+    {
+        return 0;
+    }
+    if (opcode == FRAME_OP_VOLUME)
+    {
+        p_code[1] = (value >= 1.0) ? 100 : (uint8_t)(value * 100 + 0.5);
+        return 2;
+    }
+    double percent = value * 100 + 0.5;
+    if (percent > UINT16_MAX)
+    {
+        return 0;
+    }
+    uint16_t speed = (percent < MACRO_MIN_SPEED) ? MACRO_MIN_SPEED : (uint16_t)percent;
+    p_code[1] = (uint8_t)(speed & 0xFF);
+    p_code[2] = (uint8_t)(speed >> 8);
+    return 3;
+}
+
+/**
+ * @brief Find the slot of a macro.
+ *
+ * @param p_table Pointer to the table
+ * @param p_name Name of the macro
+ * @return Index of the slot, or `MACRO_MAX_MACROS` if there is no macro with that name
+ */
+static uint32_t _find_slot(const macro_table_t *p_table, const char *p_name)
+{
+    for (uint32_t i = 0; i < MACRO_MAX_MACROS; i++)
+    {
+        if ((p_table->macros[i].name[0] != '\0') && !strcmp(p_table->macros[i].name, p_name))
+        {
+            return i;
+        }
+    }
+    return MACRO_MAX_MACROS;
+}
+
+/* Public functions */
+void macro_table_init(macro_table_t *p_table)
+{
+    memset(p_table, 0, sizeof(macro_table_t));
+}
+
+size_t macro_compile(const char *p_text, uint8_t *p_code, size_t size)
+{
+    size_t length = 0;
+    while (*p_text != '\0')
+    {
+        // Command and optional parameter, up to the separator. Empty commands are skipped.
+        p_text += strspn(p_text, " ");
+        const char *p_command = p_text;
+        size_t command_length = strcspn(p_text, " ;");
+        p_text += command_length;
+        p_text += strspn(p_text, " ");
+        const char *p_param = p_text;
+        size_t param_length = strcspn(p_text, " ;");
+        p_text += param_length;
+        p_text += strspn(p_text, " ");
+        if ((*p_text != '\0') && (*p_text != MACRO_SEPARATOR))
+        {
+            return 0; // More than one parameter
+        }
+        if (*p_text == MACRO_SEPARATOR)
+        {
+            p_text++;
+        }
+        if (command_length == 0)
+        {
+            continue;
+        }
+
+        char param[MACRO_TEXT_PARAM_LENGTH];
+        if (param_length >= sizeof(param))
+        {
+            return 0;
+        }
+        memcpy(param, p_param, param_length);
+        param[param_length] = '\0';
+
+        uint8_t instruction[3];
+        uint8_t opcode = _get_opcode(p_command, command_length);
+        size_t instruction_length = opcode ? _compile_command(opcode, param_length ? param : NULL, instruction) : 0;
+        if ((instruction_length == 0) || (length + instruction_length > size))
+        {
+            return 0;
+        }
+        memcpy(&p_code[length], instruction, instruction_length);
+        length += instruction_length;
+    }
+    return length;
+}
+
+size_t macro_next(const uint8_t *p_code, size_t length, size_t offset, uint8_t *p_opcode, uint16_t *p_operand)
+{
+    if (offset >= length)
+    {
+        return 0;
+    }
+    uint8_t opcode = p_code[offset];
+    size_t param_length = (opcode == FRAME_OP_SPEED) ? 2 : ((opcode == FRAME_OP_SELECT) || (opcode == FRAME_OP_VOLUME)) ? 1 : 0;
+    if ((opcode < FRAME_OP_PLAY) || (opcode > FRAME_OP_INFO) || (offset + 1 + param_length > length))
+    {
+        return 0;
+    }
+
+    const uint8_t *p_data = &p_code[offset + 1];
+    *p_opcode = opcode;
+    *p_operand = (param_length == 0) ? 0 : (param_length == 1) ? p_data[0] : (uint16_t)(p_data[0] | (p_data[1] << 8));
+    return offset + 1 + param_length;
+}
+
+size_t macro_decode(const uint8_t *p_code, size_t length, size_t offset, char *p_command, char *p_param)
+{
+    uint8_t opcode;
+    uint16_t operand;
+    size_t next = macro_next(p_code, length, offset, &opcode, &operand);
+    if (next == 0)
+    {
+        return 0;
+    }
+
+    snprintf(p_command, MACRO_COMMAND_LENGTH, "%s", frame_get_opcode_name(opcode));
+    switch (opcode)
+    {
+    case FRAME_OP_SELECT:
+        snprintf(p_param, MACRO_PARAM_LENGTH, "%u", (unsigned)operand);
+        break;
+    case FRAME_OP_VOLUME:
+    case FRAME_OP_SPEED:
+        snprintf(p_param, MACRO_PARAM_LENGTH, "%u.%02u", (unsigned)(operand / 100), (unsigned)(operand % 100));
+        break;
+    default:
+        p_param[0] = '\0';
+        break;
+    }
+    return next;
+}
+
+const macro_t *macro_define(macro_table_t *p_table, const char *p_name, const char *p_text)
+{
+    size_t name_length = strlen(p_name);
+    if ((name_length == 0) || (name_length >= MACRO_NAME_LENGTH))
+    {
+        return NULL;
+    }
+    uint8_t code[MACRO_CODE_LENGTH];
+    size_t length = macro_compile(p_text, code, sizeof(code));
+    if (length == 0)
+    {
+        return NULL;
+    }
+
+    // Replace the macro with the same name, or take a free slot
+    uint32_t slot = _find_slot(p_table, p_name);
+    for (uint32_t i = 0; (slot == MACRO_MAX_MACROS) && (i < MACRO_MAX_MACROS); i++)
+    {
+        if (p_table->macros[i].name[0] == '\0')
+        {
+            slot = i;
+        }
+    }
+    if (slot == MACRO_MAX_MACROS)
+    {
+        return NULL;
+    }
+    macro_t *p_macro = &p_table->macros[slot];
+    memcpy(p_macro->name, p_name, name_length + 1);
+    memcpy(p_macro->code, code, length);
+    p_macro->length = (uint8_t)length;
+    return p_macro;
+}
+
+const macro_t *macro_find(const macro_table_t *p_table, const char *p_name)
+{
+    uint32_t slot = _find_slot(p_table, p_name);
+    return (slot < MACRO_MAX_MACROS) ? &p_table->macros[slot] : NULL;
+}
+
+bool macro_delete(macro_table_t *p_table, const char *p_name)
+{
+    uint32_t slot = _find_slot(p_table, p_name);
+    if (slot == MACRO_MAX_MACROS)
+    {
+        return false;
+    }
+    memset(&p_table->macros[slot], 0, sizeof(macro_t));
+    return true;
+}
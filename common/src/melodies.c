@@ -30,6 +30,20 @@ static const double happy_birthday_notes[HAPPY_BIRTHDAY_LENGTH] = {
 static const uint16_t happy_birthday_durations[HAPPY_BIRTHDAY_LENGTH] = {
     300, 100, 400, 400, 400, 800, 300, 100, 400, 400, 400, 800, 300, 100, 400, 400, 400, 400, 400, 300, 100, 400, 400, 400, 800};
 
+/**
+ * @brief Happy Birthday harmony and bass notes.
+ *
+ * The other voices of the Happy Birthday song, on the second and third buzzers. They follow the durations of the
+ * melody: each note sounds with the note of the melody at the same position. The chords are F, C and Bb.
+ */
+static const double happy_birthday_harmony[HAPPY_BIRTHDAY_LENGTH] = {
+    0, 0, LA3, LA3, LA3, SOL3, SOL3, SOL3, SOL3, SOL3, MI4, DO4, LA3, LA3, LA4, FA4, DO4, RE4, LAs3, RE4, RE4, FA4, DO4, MI4, LA3};
+
+static const double happy_birthday_bass[HAPPY_BIRTHDAY_LENGTH] = {
+    0, 0, FA3, FA3, FA3, DO3, DO3, DO3, DO3, DO3, DO3, FA3, FA3, FA3, FA3, FA3, FA3, LAs3, LAs3, LAs3, LAs3, FA3, FA3, DO3, FA3};
+
+static const double *const happy_birthday_tracks[] = {happy_birthday_harmony, happy_birthday_bass};
+
 /**
  * @brief Happy Birthday melody struct.
  *
@@ -39,7 +53,9 @@ static const uint16_t happy_birthday_durations[HAPPY_BIRTHDAY_LENGTH] = {
 const melody_t happy_birthday_melody = {.p_name = "happy_birthday",
                                         .p_notes = (double *)happy_birthday_notes,
                                         .p_durations = (uint16_t *)happy_birthday_durations,
-                                        .melody_length = HAPPY_BIRTHDAY_LENGTH};
+                                        .melody_length = HAPPY_BIRTHDAY_LENGTH,
+                                        .p_tracks = happy_birthday_tracks,
+                                        .num_tracks = 2};
 
 // Tetris melody
 #define TETRIS_LENGTH 40 /*!< Tetris melody length */
@@ -307,3 +323,21 @@ const melody_t iscale_melody = {.p_name = "iscale",
                                .p_notes = (double *)iscale_melody_notes,
                                .p_durations = (uint16_t *)iscale_melody_durations,
                                .melody_length = ISCALE_MELODY_LENGTH};
+
+/* Registry ------------------------------------------------------------------*/
+/**
+ * @brief Melodies of the jukebox, in the order of `select <index>`.
+ *
+ * The first one is played when the jukebox is turned on and the last one when it is turned off. The names must be
+ * different, also ignoring case: `melody_registry.py` reads this table to build the name index (see melody_registry.h).
+ */
+const melody_t *const melodies[] = {
+    &scale_melody,
+    &happy_birthday_melody,
+    &tetris_melody,
+    &megalovania_melody,
+    &sailor_melody,
+    &espana_melody,
+    &mario_melody,
+    &iscale_melody,
+};
@@ -0,0 +1,618 @@
+/**
+ * @file melody_pack.c
+ * @brief Compressed melodies, decoded one note at a time.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <math.h>
+#include <string.h>
+
+/* Other libraries */
+#include "melody_pack.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define MELODY_PACK_HEADER_BYTES 5              /*!< Magic and number of melodies */
+#define MELODY_PACK_MELODY_HEADER_BYTES 6       /*!< Notes, the three `k` and the entries of the palette */
+#define MELODY_PACK_FREQUENCY_BYTES 3           /*!< Bytes of an entry of the palette */
+#define MELODY_PACK_MAX_RECORD 0xFFFFU          /*!< Largest melody, after its size */
+#define MELODY_PACK_MAX_UNARY 0xFFFFU           /*!< Longest unary part of a Rice code */
+
+/* Typedefs ------------------------------------------------------------------*/
+/// @brief Values coded in the bit stream, each one with its own Rice parameter
+typedef enum
+{
+    FIELD_PITCH = 0,
+    FIELD_DURATION,
+    FIELD_RUN,
+    NUM_FIELDS
+} melody_pack_field_t;
+
+/// @brief Encoder of the notes of a melody. Without output it only counts the bits of each field for every `k`.
+typedef struct
+{
+    uint8_t *p_data;                                /*!< Bit stream, or NULL to count */
+    size_t size;                                    /*!< Bytes available for the stream */
+    uint32_t bit;                                   /*!< Next bit of the stream */
+    uint8_t k[NUM_FIELDS];                          /*!< Rice parameters */
+    uint64_t cost[NUM_FIELDS][MELODY_PACK_MAX_K + 1]; /*!< Bits of each field for each `k` */
+} melody_pack_encoder_t;
+
+/* Private functions */
+
+/**
+ * @brief Map a signed value to an unsigned one: 0, -1, 1, -2, 2... are 0, 1, 2, 3, 4...
+ *
+ * @param value Signed value
+ * @return Unsigned value
+ */
+static uint32_t _zigzag(int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+/**
+ * @brief Inverse of _zigzag().
+ *
+ * @param value Unsigned value
+ * @return Signed value
+ */
+static int32_t _unzigzag(uint32_t value)
+{
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+/**
+ * @brief Write bits to the stream, from the least significant one.
+ *
+ * @param p_encoder Pointer to the encoder
+ * @param value Bits
+ * @param num_bits Number of bits
+ * @return false if the stream does not fit
+ */
+static bool _put_bits(melody_pack_encoder_t *p_encoder, uint32_t value, uint32_t num_bits)
+{
+    for (uint32_t i = 0; i < num_bits; i++, p_encoder->bit++)
+    {
+        if ((p_encoder->bit >> 3) >= p_encoder->size)
+        {
+            return false;
+        }
+        if ((value >> i) & 1)
+        {
+            p_encoder->p_data[p_encoder->bit >> 3] |= (uint8_t)(1U << (p_encoder->bit & 7));
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Code a value of a field: its Rice code, or its cost for every `k` when counting.
+ *
+ * @param p_encoder Pointer to the encoder
+ * @param field Field of the value
+ * @param value Value
+ * @return false if the stream does not fit
+ */
+static bool _put_value(melody_pack_encoder_t *p_encoder, melody_pack_field_t field, uint32_t value)
+{
+    if (p_encoder->p_data == NULL)
+    {
+        for (uint32_t k = 0; k <= MELODY_PACK_MAX_K; k++)
+        {
+            uint32_t unary = value >> k;
+            p_encoder->cost[field][k] += (unary > MELODY_PACK_MAX_UNARY) ? UINT32_MAX : (unary + 1 + k);
+        }
+        return true;
+    }
+    uint32_t k = p_encoder->k[field];
+    for (uint32_t unary = value >> k; unary > 0; unary--)
+    {
+        if (!_put_bits(p_encoder, 1, 1))
+        {
+            return false;
+        }
+    }
+    return _put_bits(p_encoder, 0, 1) && _put_bits(p_encoder, value & ((1U << k) - 1), k);
+}
+
+/**
+ * @brief Code a flag. It costs a bit whatever the parameters, so it is not counted.
+ *
+ * @param p_encoder Pointer to the encoder
+ * @param flag Flag
+ * @return false if the stream does not fit
+ */
+static bool _put_flag(melody_pack_encoder_t *p_encoder, bool flag)
+{
+    return (p_encoder->p_data == NULL) || _put_bits(p_encoder, flag, 1);
+}
+
+/**
+ * @brief Find the palette index of a frequency.
+ *
+ * @param p_palette Sorted frequencies, in mHz
+ * @param palette_size Entries of the palette
+ * @param frequency_mhz Frequency
+ * @return Index, or `palette_size` if it is not there
+ */
+static uint32_t _find_frequency(const uint32_t *p_palette, uint32_t palette_size, uint32_t frequency_mhz)
+{
+    uint32_t low = 0;
+    uint32_t high = palette_size;
+    while (low < high)
+    {
+        uint32_t middle = (low + high) / 2;
+        if (p_palette[middle] < frequency_mhz)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return ((low < palette_size) && (p_palette[low] == frequency_mhz)) ? low : palette_size;
+}
+
+/**
+ * @brief Get a frequency in whole mHz.
+ *
+ * @param frequency Frequency in Hz
+ * @param p_frequency_mhz Pointer to store the frequency in mHz
+ * @return false if it has a fraction of mHz or it is out of range, as it would not be decoded as it is
+ */
+static bool _get_frequency_mhz(double frequency, uint32_t *p_frequency_mhz)
+{
+    if (!(frequency >= 0.0) || (frequency * 1000.0 > MELODY_PACK_MAX_FREQUENCY_MHZ))
+    {
+        return false;
+    }
+    *p_frequency_mhz = (uint32_t)lround(frequency * 1000.0);
+    return (*p_frequency_mhz / 1000.0) == frequency;
+}
+
+/**
+ * @brief Build the palette of a melody: its different frequencies, sorted.
+ *
+ * @param p_melody Pointer to the melody
+ * @param p_palette Pointer to store the palette, `MELODY_PACK_MAX_PALETTE` entries
+ * @param p_palette_size Pointer to store the entries of the palette
+ * @return false if a frequency cannot be packed or there are too many
+ */
+static bool _build_palette(const melody_t *p_melody, uint32_t *p_palette, uint32_t *p_palette_size)
+{
+    uint32_t size = 0;
+    for (uint32_t i = 0; i < p_melody->melody_length; i++)
+    {
+        uint32_t frequency_mhz;
+        if (!_get_frequency_mhz(p_melody->p_notes[i], &frequency_mhz))
+        {
+            return false;
+        }
+        uint32_t index = _find_frequency(p_palette, size, frequency_mhz);
+        if (index < size)
+        {
+            continue;
+        }
+        if (size == MELODY_PACK_MAX_PALETTE)
+        {
+            return false;
+        }
+        // Insertion keeps it sorted
+        for (index = size; (index > 0) && (p_palette[index - 1] > frequency_mhz); index--)
+        {
+            p_palette[index] = p_palette[index - 1];
+        }
+        p_palette[index] = frequency_mhz;
+        size++;
+    }
+    *p_palette_size = size;
+    return true;
+}
+
+/**
+ * @brief Code the notes of a melody, as melody_pack_get_note() decodes them.
+ *
+ * @param p_encoder Pointer to the encoder
+ * @param p_melody Pointer to the melody
+ * @param p_palette Palette of the melody
+ * @param palette_size Entries of the palette
+ * @return false if a frequency cannot be packed or the stream does not fit
+ */
+static bool _put_notes(melody_pack_encoder_t *p_encoder, const melody_t *p_melody, const uint32_t *p_palette,
+                       uint32_t palette_size)
+{
+    int32_t pitch = 0;
+    uint16_t duration = 0;
+    uint16_t other_duration = 0;
+    uint32_t i = 0;
+    while (i < p_melody->melody_length)
+    {
+        uint16_t run_duration = p_melody->p_durations[i];
+        uint32_t run = 1;
+        while ((i + run < p_melody->melody_length) && (p_melody->p_durations[i + run] == run_duration))
+        {
+            run++;
+        }
+        for (uint32_t j = i; j < i + run; j++)
+        {
+            uint32_t frequency_mhz;
+            if (!_get_frequency_mhz(p_melody->p_notes[j], &frequency_mhz))
+            {
+                return false;
+            }
+            int32_t index = (int32_t)_find_frequency(p_palette, palette_size, frequency_mhz);
+            if (!_put_value(p_encoder, FIELD_PITCH, _zigzag(index - pitch)))
+            {
+                return false;
+            }
+            pitch = index;
+            if (j > i)
+            {
+                continue;
+            }
+            // First note of a run: its duration and its notes
+            bool back = (run_duration == other_duration);
+            if (!_put_flag(p_encoder, back))
+            {
+                return false;
+            }
+            if (!back && !_put_value(p_encoder, FIELD_DURATION, _zigzag((int32_t)run_duration - (int32_t)duration)))
+            {
+                return false;
+            }
+            other_duration = duration;
+            duration = run_duration;
+            if (!_put_value(p_encoder, FIELD_RUN, run - 1))
+            {
+                return false;
+            }
+        }
+        i += run;
+    }
+    return true;
+}
+
+/**
+ * @brief Pack a melody after its size.
+ *
+ * @param p_melody Pointer to the melody
+ * @param p_data Pointer to the buffer
+ * @param size Bytes of the buffer
+ * @return Bytes of the melody, 0 if it cannot be packed or it does not fit
+ */
+static size_t _encode_melody(const melody_t *p_melody, uint8_t *p_data, size_t size)
+{
+    static const melody_pack_encoder_t empty = {0};
+    uint32_t palette[MELODY_PACK_MAX_PALETTE];
+    uint32_t palette_size;
+    size_t name_length = strlen(p_melody->p_name) + 1;
+    if ((name_length > MELODY_PACK_NAME_LENGTH) || !_build_palette(p_melody, palette, &palette_size))
+    {
+        return 0;
+    }
+    size_t header_bytes = MELODY_PACK_MELODY_HEADER_BYTES + name_length + palette_size * MELODY_PACK_FREQUENCY_BYTES;
+    if (header_bytes > size)
+    {
+        return 0;
+    }
+
+    // First pass: the best parameter of each field
+    melody_pack_encoder_t encoder = empty;
+    _put_notes(&encoder, p_melody, palette, palette_size);
+    for (uint32_t field = 0; field < NUM_FIELDS; field++)
+    {
+        for (uint32_t k = 1; k <= MELODY_PACK_MAX_K; k++)
+        {
+            if (encoder.cost[field][k] < encoder.cost[field][encoder.k[field]])
+            {
+                encoder.k[field] = (uint8_t)k;
+            }
+        }
+    }
+
+    // Second pass: the stream
+    memset(p_data, 0, size);
+    encoder.p_data = p_data + header_bytes;
+    encoder.size = size - header_bytes;
+    if (!_put_notes(&encoder, p_melody, palette, palette_size))
+    {
+        return 0;
+    }
+    p_data[0] = (uint8_t)p_melody->melody_length;
+    p_data[1] = (uint8_t)(p_melody->melody_length >> 8);
+    p_data[2] = encoder.k[FIELD_PITCH];
+    p_data[3] = encoder.k[FIELD_DURATION];
+    p_data[4] = encoder.k[FIELD_RUN];
+    p_data[5] = (uint8_t)palette_size;
+    memcpy(&p_data[MELODY_PACK_MELODY_HEADER_BYTES], p_melody->p_name, name_length);
+    uint8_t *p_entry = &p_data[MELODY_PACK_MELODY_HEADER_BYTES + name_length];
+    for (uint32_t i = 0; i < palette_size; i++, p_entry += MELODY_PACK_FREQUENCY_BYTES)
+    {
+        p_entry[0] = (uint8_t)palette[i];
+        p_entry[1] = (uint8_t)(palette[i] >> 8);
+        p_entry[2] = (uint8_t)(palette[i] >> 16);
+    }
+    return header_bytes + (encoder.bit + 7) / 8;
+}
+
+/**
+ * @brief Read bits of the stream, from the least significant one.
+ *
+ * @param p_pack Pointer to the decoder
+ * @param num_bits Number of bits, up to `MELODY_PACK_MAX_K`
+ * @param p_value Pointer to store the bits
+ * @return false if the stream ends before
+ */
+static bool _get_bits(melody_pack_t *p_pack, uint32_t num_bits, uint32_t *p_value)
+{
+    if (p_pack->bit + num_bits > p_pack->num_bits)
+    {
+        return false;
+    }
+    // The bits are in 3 bytes at most: read them at once
+    uint32_t first = p_pack->bit >> 3;
+    uint32_t last = (p_pack->bit + num_bits + 7) >> 3;
+    uint32_t window = 0;
+    for (uint32_t byte = first; byte < last; byte++)
+    {
+        window |= (uint32_t)p_pack->p_bits[byte] << ((byte - first) * 8);
+    }
+    *p_value = (window >> (p_pack->bit & 7)) & ((1U << num_bits) - 1);
+    p_pack->bit += num_bits;
+    return true;
+}
+
+/**
+ * @brief Read a Rice code.
+ *
+ * @param p_pack Pointer to the decoder
+ * @param k Parameter of the code
+ * @param p_value Pointer to store the value
+ * @return false if the stream ends before
+ */
+static bool _get_value(melody_pack_t *p_pack, uint32_t k, uint32_t *p_value)
+{
+    uint32_t unary = 0;
+    for (;;)
+    {
+        if (p_pack->bit >= p_pack->num_bits)
+        {
+            return false;
+        }
+        uint32_t bit = (p_pack->p_bits[p_pack->bit >> 3] >> (p_pack->bit & 7)) & 1;
+        p_pack->bit++;
+        if (!bit)
+        {
+            break;
+        }
+        unary++;
+    }
+    uint32_t remainder;
+    if (!_get_bits(p_pack, k, &remainder))
+    {
+        return false;
+    }
+    *p_value = (unary << k) | remainder;
+    return true;
+}
+
+/**
+ * @brief Go back to the first note.
+ *
+ * @param p_pack Pointer to the decoder
+ */
+static void _rewind(melody_pack_t *p_pack)
+{
+    p_pack->bit = 0;
+    p_pack->next_note = 0;
+    p_pack->pitch = 0;
+    p_pack->duration = 0;
+    p_pack->other_duration = 0;
+    p_pack->run_left = 0;
+    p_pack->frequency = -1.0; // No note decoded: the first one always reads the palette
+}
+
+/**
+ * @brief Decode the next note.
+ *
+ * @param p_pack Pointer to the decoder
+ * @return false if the stream is corrupt
+ */
+static bool _decode_note(melody_pack_t *p_pack)
+{
+    uint32_t value;
+    if (!_get_value(p_pack, p_pack->k_pitch, &value))
+    {
+        return false;
+    }
+    int32_t pitch = (int32_t)p_pack->pitch + _unzigzag(value);
+    if ((pitch < 0) || (pitch >= p_pack->palette_size))
+    {
+        return false;
+    }
+    if (p_pack->run_left == 0)
+    {
+        if (!_get_bits(p_pack, 1, &value))
+        {
+            return false;
+        }
+        uint16_t duration = p_pack->other_duration;
+        if (!value)
+        {
+            if (!_get_value(p_pack, p_pack->k_duration, &value))
+            {
+                return false;
+            }
+            int32_t new_duration = (int32_t)p_pack->duration + _unzigzag(value);
+            if ((new_duration < 0) || (new_duration > UINT16_MAX))
+            {
+                return false;
+            }
+            duration = (uint16_t)new_duration;
+        }
+        p_pack->other_duration = p_pack->duration;
+        p_pack->duration = duration;
+        if (!_get_value(p_pack, p_pack->k_run, &value))
+        {
+            return false;
+        }
+        p_pack->run_left = value + 1;
+    }
+    p_pack->run_left--;
+    // Repeated notes keep their frequency: the division is only done for a new pitch
+    if (((uint8_t)pitch != p_pack->pitch) || (p_pack->frequency < 0.0))
+    {
+        const uint8_t *p_entry = &p_pack->p_palette[pitch * MELODY_PACK_FREQUENCY_BYTES];
+        uint32_t frequency_mhz = p_entry[0] | ((uint32_t)p_entry[1] << 8) | ((uint32_t)p_entry[2] << 16);
+        p_pack->frequency = frequency_mhz / 1000.0;
+    }
+    p_pack->pitch = (uint8_t)pitch;
+    p_pack->next_note++;
+    return true;
+}
+
+/**
+ * @brief Read a little endian u16.
+ *
+ * @param p_data Pointer to the bytes
+ * @return Value
+ */
+static uint16_t _get_u16(const uint8_t *p_data)
+{
+    return (uint16_t)(p_data[0] | (p_data[1] << 8));
+}
+
+/* Public functions */
+size_t melody_pack_encode(const melody_t *const *pp_melodies, uint32_t num_melodies, uint8_t *p_container, size_t size)
+{
+    if ((num_melodies > UINT8_MAX) || (size < MELODY_PACK_HEADER_BYTES))
+    {
+        return 0;
+    }
+    uint32_t magic = MELODY_PACK_MAGIC;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        p_container[i] = (uint8_t)(magic >> (8 * i));
+    }
+    p_container[4] = (uint8_t)num_melodies;
+    size_t length = MELODY_PACK_HEADER_BYTES;
+    for (uint32_t i = 0; i < num_melodies; i++)
+    {
+        if (size - length < 2)
+        {
+            return 0;
+        }
+        size_t available = size - length - 2;
+        size_t record = _encode_melody(pp_melodies[i], &p_container[length + 2],
+                                       (available > MELODY_PACK_MAX_RECORD) ? MELODY_PACK_MAX_RECORD : available);
+        if (record == 0)
+        {
+            return 0;
+        }
+        p_container[length] = (uint8_t)record;
+        p_container[length + 1] = (uint8_t)(record >> 8);
+        length += 2 + record;
+    }
+    return length;
+}
+
+uint32_t melody_pack_get_num_melodies(const uint8_t *p_container, size_t size)
+{
+    if ((size < MELODY_PACK_HEADER_BYTES) ||
+        ((_get_u16(p_container) | ((uint32_t)_get_u16(&p_container[2]) << 16)) != MELODY_PACK_MAGIC))
+    {
+        return 0;
+    }
+    return p_container[4];
+}
+
+bool melody_pack_open(melody_pack_t *p_pack, const uint8_t *p_container, size_t size, uint32_t index)
+{
+    if (index >= melody_pack_get_num_melodies(p_container, size))
+    {
+        return false;
+    }
+    size_t position = MELODY_PACK_HEADER_BYTES;
+    for (uint32_t i = 0; i < index; i++)
+    {
+        if (size - position < 2)
+        {
+            return false;
+        }
+        position += 2 + _get_u16(&p_container[position]);
+        if (position > size)
+        {
+            return false;
+        }
+    }
+    if ((size - position < 2) || (_get_u16(&p_container[position]) > size - position - 2))
+    {
+        return false;
+    }
+    const uint8_t *p_record = &p_container[position + 2];
+    const uint8_t *p_end = p_record + _get_u16(&p_container[position]);
+    if (p_end - p_record < MELODY_PACK_MELODY_HEADER_BYTES)
+    {
+        return false;
+    }
+    const char *p_name = (const char *)&p_record[MELODY_PACK_MELODY_HEADER_BYTES];
+    size_t name_length = 0;
+    while (((const uint8_t *)p_name + name_length < p_end) && (name_length < MELODY_PACK_NAME_LENGTH) &&
+           p_name[name_length])
+    {
+        name_length++;
+    }
+    const uint8_t *p_palette = (const uint8_t *)p_name + name_length + 1;
+    if ((name_length == MELODY_PACK_NAME_LENGTH) || (p_palette > p_end) ||
+        ((size_t)(p_end - p_palette) < (size_t)p_record[5] * MELODY_PACK_FREQUENCY_BYTES) || (p_record[2] > MELODY_PACK_MAX_K) ||
+        (p_record[3] > MELODY_PACK_MAX_K) || (p_record[4] > MELODY_PACK_MAX_K))
+    {
+        return false;
+    }
+
+    memset(p_pack, 0, sizeof(melody_pack_t));
+    p_pack->melody.p_name = (char *)p_name;
+    p_pack->melody.melody_length = _get_u16(p_record);
+    p_pack->k_pitch = p_record[2];
+    p_pack->k_duration = p_record[3];
+    p_pack->k_run = p_record[4];
+    p_pack->palette_size = p_record[5];
+    p_pack->p_palette = p_palette;
+    p_pack->p_bits = p_palette + p_pack->palette_size * MELODY_PACK_FREQUENCY_BYTES;
+    p_pack->num_bits = (uint32_t)(p_end - p_pack->p_bits) * 8;
+    _rewind(p_pack);
+    return true;
+}
+
+const melody_t *melody_pack_get_melody(const melody_pack_t *p_pack)
+{
+    return &p_pack->melody;
+}
+
+bool melody_pack_get_note(melody_pack_t *p_pack, uint32_t note_index, double *p_frequency, uint32_t *p_duration)
+{
+    if (note_index >= p_pack->melody.melody_length)
+    {
+        return false;
+    }
+    if (note_index + 1 < p_pack->next_note)
+    {
+        _rewind(p_pack);
+    }
+    while (p_pack->next_note <= note_index)
+    {
+        if (!_decode_note(p_pack))
+        {
+            _rewind(p_pack);
+            return false;
+        }
+    }
+    *p_frequency = p_pack->frequency;
+    *p_duration = p_pack->duration;
+    return true;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file melody_registry.c
+ * @brief Lookup of the melodies of the jukebox by name.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <ctype.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Other libraries */
+#include "melody_registry.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define FNV_OFFSET_BASIS 2166136261U    /*!< Initial value of the FNV-1a hash */
+#define FNV_PRIME 16777619U             /*!< Multiplier of the FNV-1a hash */
+
+/* Public functions */
+uint32_t melody_registry_hash(const char *p_name, uint32_t seed)
+{
+    uint32_t hash = FNV_OFFSET_BASIS ^ seed;
+    for (; *p_name != '\0'; p_name++)
+    {
+        hash ^= (uint8_t)tolower((unsigned char)*p_name);
+        hash *= FNV_PRIME;
+    }
+    // The low bits of FNV-1a depend only on the low bits of the seed: fold the high half so every seed counts
+    return hash ^ (hash >> 16);
+}
+
+bool melody_registry_begins_with(const char *p_name, const char *p_prefix, bool *p_whole)
+{
+    while (*p_prefix != '\0')
+    {
+        if (tolower((unsigned char)*p_name) != tolower((unsigned char)*p_prefix))
+        {
+            return false;
+        }
+        p_name++;
+        p_prefix++;
+    }
+    *p_whole = (*p_name == '\0');
+    return true;
+}
+
+const melody_t *melody_registry_get(uint32_t melody_idx)
+{
+    return (melody_idx < MELODIES_LENGTH) ? melodies[melody_idx] : NULL;
+}
+
+uint32_t melody_registry_find(const char *p_name)
+{
+    uint32_t slot = melody_registry_hash(p_name, melody_registry_seed) & (MELODY_REGISTRY_SLOTS - 1);
+    uint8_t melody_idx = melody_registry_slots[slot];
+    bool whole;
+    if ((melody_idx == MELODY_REGISTRY_EMPTY) || !melody_registry_begins_with(melodies[melody_idx]->p_name, p_name, &whole) || !whole)
+    {
+        return MELODY_REGISTRY_NOT_FOUND;
+    }
+    return melody_idx;
+}
+
+uint32_t melody_registry_find_prefix(const char *p_prefix)
+{
+    if (*p_prefix == '\0')
+    {
+        return MELODY_REGISTRY_NOT_FOUND;
+    }
+    uint32_t melody_idx = melody_registry_find(p_prefix);
+    if (melody_idx != MELODY_REGISTRY_NOT_FOUND)
+    {
+        return melody_idx;
+    }
+    // Few melodies, and only the names typed by hand get here: a scan is enough
+    for (uint32_t idx = 0; idx < MELODIES_LENGTH; idx++)
+    {
+        bool whole;
+        if (!melody_registry_begins_with(melodies[idx]->p_name, p_prefix, &whole))
+        {
+            continue;
+        }
+        if (melody_idx != MELODY_REGISTRY_NOT_FOUND)
+        {
+            return MELODY_REGISTRY_NOT_FOUND; // Ambiguous
+        }
+        melody_idx = idx;
+    }
+    return melody_idx;
+}
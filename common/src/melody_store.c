@@ -0,0 +1,325 @@
+/**
+ * @file melody_store.c
+ * @brief Log-structured store of the melodies uploaded through the USART.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <ctype.h>
+#include <stddef.h>
+#include <string.h>
+
+/* HW dependent libraries */
+#include "port_flash.h"
+
+/* Other libraries */
+#include "melody_store.h"
+#include "melody_registry.h"
+#include "frame.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define MELODY_STORE_ERASED_16 0xFFFFU      /*!< Erased halfword */
+#define MELODY_STORE_ERASED_32 0xFFFFFFFFU  /*!< Erased word */
+#define MELODY_STORE_ALIGN 8                /*!< Alignment of the records, as the notes are `double` */
+#define MELODY_STORE_BATCH 8                /*!< Notes converted and programmed at a time */
+#define MELODY_STORE_CRC_INIT 0xFFFF        /*!< Initial value of the CRC-16/CCITT-FALSE */
+
+/* Private functions */
+
+/**
+ * @brief Bytes of a record, padding included.
+ *
+ * @param length Notes
+ * @return Bytes
+ */
+static uint32_t _record_size(uint16_t length)
+{
+    uint32_t size = sizeof(melody_store_header_t) + (uint32_t)length * (sizeof(double) + sizeof(uint16_t));
+    return (size + MELODY_STORE_ALIGN - 1) & ~(uint32_t)(MELODY_STORE_ALIGN - 1);
+}
+
+/**
+ * @brief Check a name: letters, digits and '_', so that it is a single word of the text commands.
+ *
+ * @param p_name Name
+ * @return true if valid
+ */
+static bool _is_valid_name(const char *p_name)
+{
+    size_t length = strlen(p_name);
+    if ((length == 0) || (length >= MELODY_STORE_NAME_LENGTH))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++)
+    {
+        if (!isalnum((unsigned char)p_name[i]) && (p_name[i] != '_'))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Point a melody to its record in the flash.
+ *
+ * @param p_store Pointer to the store
+ * @param melody_idx Index of the melody in the store
+ * @param offset Position of the record
+ */
+static void _set_melody(melody_store_t *p_store, uint32_t melody_idx, uint32_t offset)
+{
+    const uint8_t *p_record = port_flash_get_store() + offset;
+    const melody_store_header_t *p_header = (const melody_store_header_t *)p_record;
+    melody_t *p_melody = &p_store->melodies[melody_idx];
+    p_melody->p_name = (char *)p_header->name;
+    p_melody->p_notes = (double *)(p_record + sizeof(melody_store_header_t));
+    p_melody->p_durations = (uint16_t *)(p_record + sizeof(melody_store_header_t) + p_header->length * sizeof(double));
+    p_melody->melody_length = p_header->length;
+    p_store->offsets[melody_idx] = offset;
+}
+
+/**
+ * @brief Add a committed record: it replaces the melody with its name, or takes a free melody.
+ *
+ * @param p_store Pointer to the store
+ * @param offset Position of the record
+ * @return Index of the melody in the store, or `MELODY_STORE_NOT_FOUND` if there is no free melody
+ */
+static uint32_t _add_melody(melody_store_t *p_store, uint32_t offset)
+{
+    const melody_store_header_t *p_header = (const melody_store_header_t *)(port_flash_get_store() + offset);
+    uint32_t melody_idx = melody_store_find(p_store, p_header->name, true);
+    if (melody_idx == MELODY_STORE_NOT_FOUND)
+    {
+        if (p_store->num_melodies == MELODY_STORE_MAX_MELODIES)
+        {
+            return MELODY_STORE_NOT_FOUND;
+        }
+        melody_idx = p_store->num_melodies++;
+    }
+    _set_melody(p_store, melody_idx, offset);
+    return melody_idx;
+}
+
+/**
+ * @brief Mark a record as deleted.
+ *
+ * @param offset Position of the record
+ * @return true if programmed
+ */
+static bool _delete_record(uint32_t offset)
+{
+    const uint32_t deleted = 0;
+    return port_flash_program(offset + offsetof(melody_store_header_t, deleted), &deleted, sizeof(deleted));
+}
+
+/* Public functions */
+void melody_store_mount(melody_store_t *p_store)
+{
+    memset(p_store, 0, sizeof(melody_store_t));
+    const uint8_t *p_flash = port_flash_get_store();
+    uint32_t offset = 0;
+    while (offset + sizeof(melody_store_header_t) <= PORT_FLASH_STORE_SIZE)
+    {
+        melody_store_header_t header;
+        memcpy(&header, &p_flash[offset], sizeof(header));
+        if (header.length == MELODY_STORE_ERASED_16)
+        {
+            break; // End of the log
+        }
+        // The length is programmed before the mark: a record cut right after it can still be skipped
+        if ((header.magic != MELODY_STORE_MAGIC) && (header.magic != MELODY_STORE_ERASED_16))
+        {
+            offset = PORT_FLASH_STORE_SIZE; // Unknown content: nothing else can be appended until it is erased
+            break;
+        }
+        uint32_t size = _record_size(header.length);
+        if (size > PORT_FLASH_STORE_SIZE - offset)
+        {
+            offset = PORT_FLASH_STORE_SIZE;
+            break;
+        }
+        bool named = memchr(header.name, '\0', MELODY_STORE_NAME_LENGTH) != NULL;
+        if ((header.magic == MELODY_STORE_MAGIC) && (header.commit == MELODY_STORE_COMMITTED) &&
+            (header.deleted == MELODY_STORE_ERASED_32) && named)
+        {
+            _add_melody(p_store, offset);
+        }
+        offset += size;
+    }
+    p_store->end = offset;
+}
+
+melody_store_status_t melody_store_erase(melody_store_t *p_store)
+{
+    bool erased = port_flash_erase_store();
+    melody_store_mount(p_store);
+    return erased ? MELODY_STORE_OK : MELODY_STORE_FLASH_ERROR;
+}
+
+melody_store_status_t melody_store_begin(melody_store_t *p_store, const char *p_name, uint16_t length)
+{
+    p_store->uploading = false; // The record of an upload in progress stays uncommitted
+    if (!_is_valid_name(p_name) || (length == 0) || (length == MELODY_STORE_ERASED_16))
+    {
+        return MELODY_STORE_BAD_PARAM;
+    }
+    uint32_t size = _record_size(length);
+    if ((size > PORT_FLASH_STORE_SIZE - p_store->end) ||
+        ((p_store->num_melodies == MELODY_STORE_MAX_MELODIES) && (melody_store_find(p_store, p_name, true) == MELODY_STORE_NOT_FOUND)))
+    {
+        return MELODY_STORE_NO_SPACE;
+    }
+
+    // The record takes its space now: if the upload is abandoned, the next one goes after it
+    uint32_t offset = p_store->end;
+    p_store->end += size;
+    const uint16_t first_word[] = {length, MELODY_STORE_MAGIC};
+    char name[MELODY_STORE_NAME_LENGTH] = {0};
+    strcpy(name, p_name);
+    if (!port_flash_program(offset, first_word, sizeof(first_word)) ||
+        !port_flash_program(offset + offsetof(melody_store_header_t, name), name, sizeof(name)))
+    {
+        return MELODY_STORE_FLASH_ERROR;
+    }
+    p_store->uploading = true;
+    p_store->upload_offset = offset;
+    p_store->upload_length = length;
+    p_store->upload_received = 0;
+    p_store->upload_crc = MELODY_STORE_CRC_INIT;
+    return MELODY_STORE_OK;
+}
+
+melody_store_status_t melody_store_write(melody_store_t *p_store, uint16_t first_note, const uint8_t *p_data, uint16_t num_notes)
+{
+    if (!p_store->uploading || ((uint32_t)first_note + num_notes > p_store->upload_length))
+    {
+        return MELODY_STORE_BAD_PARAM;
+    }
+    if (first_note + num_notes <= p_store->upload_received)
+    {
+        return MELODY_STORE_OK; // Already written: the host did not get the reply and sent them again
+    }
+    if (first_note != p_store->upload_received)
+    {
+        return MELODY_STORE_BAD_PARAM;
+    }
+
+    uint32_t notes_offset = p_store->upload_offset + sizeof(melody_store_header_t);
+    uint32_t durations_offset = notes_offset + p_store->upload_length * sizeof(double);
+    for (uint16_t done = 0; done < num_notes; done += MELODY_STORE_BATCH)
+    {
+        uint16_t batch = ((num_notes - done) < MELODY_STORE_BATCH) ? (num_notes - done) : MELODY_STORE_BATCH;
+        double notes[MELODY_STORE_BATCH];
+        uint16_t durations[MELODY_STORE_BATCH];
+        for (uint16_t i = 0; i < batch; i++)
+        {
+            const uint8_t *p_note = &p_data[(done + i) * MELODY_STORE_NOTE_BYTES];
+            notes[i] = (uint16_t)(p_note[0] | (p_note[1] << 8)) / 10.0;
+            durations[i] = (uint16_t)(p_note[2] | (p_note[3] << 8));
+        }
+        uint16_t note = first_note + done;
+        if (!port_flash_program(notes_offset + note * sizeof(double), notes, batch * sizeof(double)) ||
+            !port_flash_program(durations_offset + note * sizeof(uint16_t), durations, batch * sizeof(uint16_t)))
+        {
+            p_store->uploading = false;
+            return MELODY_STORE_FLASH_ERROR;
+        }
+    }
+    p_store->upload_crc = frame_crc16_update(p_store->upload_crc, p_data, num_notes * MELODY_STORE_NOTE_BYTES);
+    p_store->upload_received += num_notes;
+    return MELODY_STORE_OK;
+}
+
+melody_store_status_t melody_store_end(melody_store_t *p_store, uint16_t crc, uint32_t *p_melody_idx)
+{
+    if (!p_store->uploading)
+    {
+        return MELODY_STORE_BAD_PARAM;
+    }
+    p_store->uploading = false;
+    if ((p_store->upload_received != p_store->upload_length) || (crc != p_store->upload_crc))
+    {
+        return MELODY_STORE_BAD_PARAM;
+    }
+
+    // The commit mark goes after the CRC: a record is complete once the mark is there
+    uint32_t offset = p_store->upload_offset;
+    const uint16_t last_word[] = {crc, MELODY_STORE_COMMITTED};
+    if (!port_flash_program(offset + offsetof(melody_store_header_t, crc), last_word, sizeof(last_word)))
+    {
+        return MELODY_STORE_FLASH_ERROR;
+    }
+    const melody_store_header_t *p_header = (const melody_store_header_t *)(port_flash_get_store() + offset);
+    uint32_t melody_idx = melody_store_find(p_store, p_header->name, true);
+    if ((melody_idx != MELODY_STORE_NOT_FOUND) && !_delete_record(p_store->offsets[melody_idx]))
+    {
+        return MELODY_STORE_FLASH_ERROR;
+    }
+    *p_melody_idx = _add_melody(p_store, offset);
+    return MELODY_STORE_OK;
+}
+
+melody_store_status_t melody_store_delete(melody_store_t *p_store, uint32_t melody_idx)
+{
+    if (melody_idx >= p_store->num_melodies)
+    {
+        return MELODY_STORE_BAD_PARAM;
+    }
+    if (!_delete_record(p_store->offsets[melody_idx]))
+    {
+        return MELODY_STORE_FLASH_ERROR;
+    }
+    p_store->num_melodies--;
+    for (uint32_t idx = melody_idx; idx < p_store->num_melodies; idx++)
+    {
+        p_store->melodies[idx] = p_store->melodies[idx + 1];
+        p_store->offsets[idx] = p_store->offsets[idx + 1];
+    }
+    return MELODY_STORE_OK;
+}
+
+const melody_t *melody_store_get(const melody_store_t *p_store, uint32_t melody_idx)
+{
+    return (melody_idx < p_store->num_melodies) ? &p_store->melodies[melody_idx] : NULL;
+}
+
+uint32_t melody_store_get_num_melodies(const melody_store_t *p_store)
+{
+    return p_store->num_melodies;
+}
+
+uint32_t melody_store_get_free(const melody_store_t *p_store)
+{
+    return PORT_FLASH_STORE_SIZE - p_store->end;
+}
+
+uint32_t melody_store_find(const melody_store_t *p_store, const char *p_prefix, bool whole)
+{
+    uint32_t found = MELODY_STORE_NOT_FOUND;
+    uint32_t matches = 0;
+    if (*p_prefix == '\0')
+    {
+        return MELODY_STORE_NOT_FOUND;
+    }
+    for (uint32_t idx = 0; idx < p_store->num_melodies; idx++)
+    {
+        bool is_whole;
+        if (!melody_registry_begins_with(p_store->melodies[idx].p_name, p_prefix, &is_whole))
+        {
+            continue;
+        }
+        if (is_whole)
+        {
+            return idx;
+        }
+        found = idx;
+        matches++;
+    }
+    return (!whole && (matches == 1)) ? found : MELODY_STORE_NOT_FOUND;
+}
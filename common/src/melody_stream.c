@@ -0,0 +1,197 @@
+/**
+ * @file melody_stream.c
+ * @brief Melodies played from the external storage through a prefetch window.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stddef.h>
+#include <string.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+#include "port_storage.h"
+
+/* Other libraries */
+#include "melody_stream.h"
+
+/* Private functions */
+
+/**
+ * @brief Read the header of a melody and check it.
+ *
+ * @param address Position of the header
+ * @param p_header Pointer to store the header
+ * @return true if there is a melody at that position and all its notes are in the storage
+ */
+static bool _read_header(uint32_t address, melody_stream_header_t *p_header)
+{
+    uint32_t size = port_storage_get_size();
+    if ((address > size) || (size - address < sizeof(melody_stream_header_t)) ||
+        !port_storage_read(address, p_header, sizeof(melody_stream_header_t)))
+    {
+        return false;
+    }
+    uint32_t max_notes = (size - address - sizeof(melody_stream_header_t)) / MELODY_STREAM_NOTE_BYTES;
+    p_header->name[MELODY_STREAM_NAME_LENGTH - 1] = '\0';
+    return (p_header->magic == MELODY_STREAM_MAGIC) && (p_header->length > 0) && (p_header->length <= max_notes);
+}
+
+/**
+ * @brief Mark the buffers whose read has finished. A single read is in progress at a time.
+ *
+ * @param p_stream Pointer to the stream
+ */
+static void _update(melody_stream_t *p_stream)
+{
+    if (port_storage_is_busy())
+    {
+        return;
+    }
+    p_stream->chunks[0].loading = false;
+    p_stream->chunks[1].loading = false;
+}
+
+/**
+ * @brief Start reading a buffer of notes. Buffer `k % 2` holds the notes from `k * MELODY_STREAM_CHUNK_NOTES`.
+ *
+ * @param p_stream Pointer to the stream
+ * @param first_note Index of the first note, a multiple of `MELODY_STREAM_CHUNK_NOTES`
+ */
+static void _load(melody_stream_t *p_stream, uint32_t first_note)
+{
+    melody_stream_chunk_t *p_chunk = &p_stream->chunks[(first_note / MELODY_STREAM_CHUNK_NOTES) % 2];
+    if ((p_chunk->first_note == first_note) || p_chunk->loading || port_storage_is_busy())
+    {
+        return; // Already there, or the storage is busy: it is requested again with the next note
+    }
+    uint32_t num_notes = p_stream->melody.melody_length - first_note;
+    if (num_notes > MELODY_STREAM_CHUNK_NOTES)
+    {
+        num_notes = MELODY_STREAM_CHUNK_NOTES;
+    }
+    p_chunk->first_note = first_note;
+    p_chunk->loading = port_storage_start_read(p_stream->address + first_note * MELODY_STREAM_NOTE_BYTES,
+                                               p_chunk->notes, num_notes * MELODY_STREAM_NOTE_BYTES);
+    if (!p_chunk->loading)
+    {
+        p_chunk->first_note = MELODY_STREAM_NO_CHUNK;
+    }
+}
+
+/* Public functions */
+void melody_stream_init(melody_stream_t *p_stream)
+{
+    memset(p_stream, 0, sizeof(melody_stream_t));
+    p_stream->melody.p_name = p_stream->name;
+    p_stream->chunks[0].first_note = MELODY_STREAM_NO_CHUNK;
+    p_stream->chunks[1].first_note = MELODY_STREAM_NO_CHUNK;
+    port_storage_init();
+}
+
+bool melody_stream_find(uint32_t index, uint32_t *p_address)
+{
+    uint32_t address = 0;
+    melody_stream_header_t header;
+    for (uint32_t i = 0; i < index; i++)
+    {
+        if (!_read_header(address, &header))
+        {
+            return false;
+        }
+        address += sizeof(melody_stream_header_t) + header.length * MELODY_STREAM_NOTE_BYTES;
+    }
+    *p_address = address;
+    return _read_header(address, &header);
+}
+
+bool melody_stream_open(melody_stream_t *p_stream, uint32_t address)
+{
+    melody_stream_header_t header;
+    // The header is read once any read in progress has finished, so no buffer is written behind our back
+    if (!_read_header(address, &header))
+    {
+        return false;
+    }
+    melody_stream_init(p_stream);
+    memcpy(p_stream->name, header.name, MELODY_STREAM_NAME_LENGTH);
+    p_stream->melody.melody_length = header.length;
+    p_stream->address = address + sizeof(melody_stream_header_t);
+    _load(p_stream, 0);
+    return true;
+}
+
+const melody_t *melody_stream_get_melody(const melody_stream_t *p_stream)
+{
+    return &p_stream->melody;
+}
+
+bool melody_stream_is_ready(melody_stream_t *p_stream, uint32_t note_index)
+{
+    _update(p_stream);
+    const melody_stream_chunk_t *p_chunk = &p_stream->chunks[(note_index / MELODY_STREAM_CHUNK_NOTES) % 2];
+    uint32_t first_note = note_index - note_index % MELODY_STREAM_CHUNK_NOTES;
+    if ((p_chunk->first_note == first_note) && !p_chunk->loading)
+    {
+        return true;
+    }
+    if (!p_stream->stalled)
+    {
+        p_stream->stalled = true;
+        p_stream->stalls++;
+        p_stream->stall_cycles = port_system_get_cycles();
+    }
+    _load(p_stream, first_note); // A jump in the melody, or the prefetch could not start
+    return false;
+}
+
+bool melody_stream_get_note(melody_stream_t *p_stream, uint32_t note_index, double *p_frequency, uint32_t *p_duration)
+{
+    if (!melody_stream_is_ready(p_stream, note_index))
+    {
+        return false;
+    }
+    if (p_stream->stalled)
+    {
+        uint32_t stall_cycles = port_system_get_cycles() - p_stream->stall_cycles;
+        if (stall_cycles > p_stream->max_stall_cycles)
+        {
+            p_stream->max_stall_cycles = stall_cycles;
+        }
+        p_stream->stalled = false;
+    }
+    else
+    {
+        p_stream->hits++;
+    }
+    const melody_stream_chunk_t *p_chunk = &p_stream->chunks[(note_index / MELODY_STREAM_CHUNK_NOTES) % 2];
+    const uint8_t *p_note = &p_chunk->notes[(note_index % MELODY_STREAM_CHUNK_NOTES) * MELODY_STREAM_NOTE_BYTES];
+    *p_frequency = (uint16_t)(p_note[0] | (p_note[1] << 8)) / 10.0;
+    *p_duration = (uint16_t)(p_note[2] | (p_note[3] << 8));
+
+    // Prefetch: the other buffer gets the next notes while these ones play
+    uint32_t next_note = note_index - note_index % MELODY_STREAM_CHUNK_NOTES + MELODY_STREAM_CHUNK_NOTES;
+    if (next_note < p_stream->melody.melody_length)
+    {
+        _load(p_stream, next_note);
+    }
+    return true;
+}
+
+uint32_t melody_stream_get_hits(const melody_stream_t *p_stream)
+{
+    return p_stream->hits;
+}
+
+uint32_t melody_stream_get_stalls(const melody_stream_t *p_stream)
+{
+    return p_stream->stalls;
+}
+
+uint32_t melody_stream_get_max_stall_cycles(const melody_stream_t *p_stream)
+{
+    return p_stream->max_stall_cycles;
+}
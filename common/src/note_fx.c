@@ -0,0 +1,141 @@
+/**
+ * @file note_fx.c
+ * @brief Vibrato, slide and arpeggio of a note, rendered as the auto-reload of the PWM timer at the control rate.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <math.h>
+#include <string.h>
+
+/* Other libraries */
+#include "note_fx.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define NOTE_FX_Q16_ONE 65536.0                 /*!< 1 in Q16 */
+#define NOTE_FX_Q30_ONE 1073741824.0            /*!< 1 in Q30 */
+#define NOTE_FX_PHASE_ONE 4294967296.0          /*!< A cycle of the vibrato */
+#define NOTE_FX_SINE_BITS 5U                    /*!< log2 of `NOTE_FX_SINE_LENGTH` */
+#define NOTE_FX_MAX_ARR 65535U                  /*!< Largest auto-reload of a 16-bit timer */
+#define NOTE_FX_CENTS_PER_OCTAVE 1200.0         /*!< Cents of an octave */
+#define NOTE_FX_SEMITONES_PER_OCTAVE 12.0       /*!< Semitones of an octave */
+#define NOTE_FX_PI 3.14159265358979323846       /*!< Pi, not in the C standard library */
+
+/* Public functions */
+double note_fx_start(note_fx_state_t *p_state, const note_fx_t *p_fx, uint32_t rate_hz, double next_ratio,
+                     uint32_t duration_ms)
+{
+    memset(p_state, 0, sizeof(note_fx_state_t));
+    if (p_fx == NULL)
+    {
+        return 1.0;
+    }
+    p_state->flags = p_fx->flags;
+    if (!(next_ratio > 0))
+    {
+        p_state->flags &= ~NOTE_FX_SLIDE;
+    }
+    double longest = 1.0;
+
+    if (p_state->flags & NOTE_FX_VIBRATO)
+    {
+        // A higher pitch is a shorter period
+        for (uint32_t i = 0; i < NOTE_FX_SINE_LENGTH; i++)
+        {
+            double cents = p_fx->vibrato_cents * sin(2.0 * NOTE_FX_PI * i / NOTE_FX_SINE_LENGTH);
+            double delta = pow(2.0, -cents / NOTE_FX_CENTS_PER_OCTAVE) - 1.0;
+            p_state->vibrato_deltas[i] = (int16_t)lround(delta * NOTE_FX_Q16_ONE);
+        }
+        p_state->vibrato_step = (uint32_t)(p_fx->vibrato_rate * NOTE_FX_PHASE_ONE / (10.0 * rate_hz));
+        longest *= pow(2.0, p_fx->vibrato_cents / NOTE_FX_CENTS_PER_OCTAVE);
+    }
+
+    if (p_state->flags & NOTE_FX_ARPEGGIO)
+    {
+        double chord_longest = 1.0;
+        p_state->chord[0] = (uint32_t)NOTE_FX_Q16_ONE;
+        for (uint32_t i = 1; i < NOTE_FX_CHORD_LENGTH; i++)
+        {
+            double ratio = pow(2.0, -p_fx->arpeggio[i - 1] / NOTE_FX_SEMITONES_PER_OCTAVE);
+            p_state->chord[i] = (uint32_t)lround(ratio * NOTE_FX_Q16_ONE);
+            chord_longest = fmax(chord_longest, ratio);
+        }
+        uint32_t ticks = NOTE_FX_ARPEGGIO_MS * rate_hz / 1000U;
+        p_state->chord_ticks = (ticks == 0) ? 1U : (uint16_t)ticks;
+        p_state->chord_ticks_left = p_state->chord_ticks;
+        longest *= chord_longest;
+    }
+
+    if (p_state->flags & NOTE_FX_SLIDE)
+    {
+        // The same ratio every tick: the pitch slides evenly in cents
+        uint32_t ticks = (uint32_t)((uint64_t)duration_ms * rate_hz / 1000U);
+        p_state->slide_ticks = (ticks == 0) ? 1U : ticks;
+        p_state->slide_ratio = (uint32_t)lround(pow(next_ratio, 1.0 / p_state->slide_ticks) * NOTE_FX_Q30_ONE);
+        longest *= fmax(1.0, next_ratio);
+    }
+    return longest;
+}
+
+uint32_t note_fx_set_count(note_fx_state_t *p_state, double count)
+{
+    double scale = (double)(1U << NOTE_FX_COUNT_BITS);
+    if (p_state->flags & NOTE_FX_SLIDE)
+    {
+        // The ratio of the whole slide, as the ticks will apply it
+        double next_ratio = pow((double)p_state->slide_ratio / NOTE_FX_Q30_ONE, p_state->slide_ticks);
+        p_state->target = (uint32_t)lround(count * next_ratio * scale);
+    }
+    p_state->count = (uint32_t)lround(count * scale);
+    uint32_t arr = (uint32_t)lround(count) - 1U;
+    return (arr > NOTE_FX_MAX_ARR) ? NOTE_FX_MAX_ARR : arr;
+}
+
+uint32_t note_fx_tick(note_fx_state_t *p_state)
+{
+    if (p_state->slide_ticks > 0)
+    {
+        // The last tick lands on the pitch of the next note, without the rounding of the previous ones
+        p_state->slide_ticks--;
+        p_state->count = (p_state->slide_ticks == 0) ? p_state->target
+                                                      : (uint32_t)(((uint64_t)p_state->count * p_state->slide_ratio) >> 30);
+    }
+
+    uint64_t count = p_state->count;
+    if (p_state->flags & NOTE_FX_ARPEGGIO)
+    {
+        if (--p_state->chord_ticks_left == 0)
+        {
+            p_state->chord_ticks_left = p_state->chord_ticks;
+            p_state->chord_index = (p_state->chord_index + 1U == NOTE_FX_CHORD_LENGTH) ? 0 : p_state->chord_index + 1U;
+        }
+        count = (count * p_state->chord[p_state->chord_index]) >> 16;
+    }
+    if (p_state->flags & NOTE_FX_VIBRATO)
+    {
+        p_state->vibrato_phase += p_state->vibrato_step;
+        int64_t delta = p_state->vibrato_deltas[p_state->vibrato_phase >> (32U - NOTE_FX_SINE_BITS)];
+        count = (uint64_t)((int64_t)count + (((int64_t)count * delta) >> 16));
+    }
+
+    uint32_t arr = (uint32_t)((count + (1U << (NOTE_FX_COUNT_BITS - 1U))) >> NOTE_FX_COUNT_BITS) - 1U;
+    if (arr < 1U)
+    {
+        return 1U;
+    }
+    return (arr > NOTE_FX_MAX_ARR) ? NOTE_FX_MAX_ARR : arr;
+}
+
+void note_fx_stop(note_fx_state_t *p_state)
+{
+    p_state->flags = 0;
+    p_state->slide_ticks = 0;
+}
+
+bool note_fx_is_active(const note_fx_state_t *p_state)
+{
+    return p_state->flags != 0;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file note_pwm.c
+ * @brief Prescaler and auto-reload of the PWM timer of the buzzer with the smallest pitch error.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <math.h>
+#include <stddef.h>
+
+/* Other libraries */
+#include "note_pwm.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define NOTE_PWM_MAX_PERIOD (NOTE_PWM_MAX_COUNT * (NOTE_PWM_MAX_COUNT - 1U))  /*!< Longest period that fits 32 bits */
+#define NOTE_PWM_CENTS_PER_OCTAVE 1200.0                                    /*!< Cents of an octave */
+
+/* Private functions */
+
+/**
+ * @brief Split a period in prescaler and auto-reload, with the largest auto-reload.
+ *
+ * @param period Period in clock cycles
+ * @param p_psc Pointer to store the prescaler
+ * @param p_arr Pointer to store the auto-reload
+ * @return true if the period is the product of two factors up to `NOTE_PWM_MAX_COUNT`
+ */
+static bool _factor(uint32_t period, uint32_t *p_psc, uint32_t *p_arr)
+{
+    // The smallest factor is at most the square root, and at least what keeps the other one in 16 bits
+    uint32_t prescaler = (period - 1U) / NOTE_PWM_MAX_COUNT + 1U;
+    for (; prescaler <= period / prescaler; prescaler++)
+    {
+        if (period % prescaler == 0)
+        {
+            *p_psc = prescaler - 1U;
+            *p_arr = period / prescaler - 1U;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Public functions */
+double note_pwm_get_cents(double frequency, uint32_t clock_hz, uint32_t psc, uint32_t arr)
+{
+    double timer_hz = (double)clock_hz / (((double)psc + 1.0) * ((double)arr + 1.0));
+    return NOTE_PWM_CENTS_PER_OCTAVE * log2(timer_hz / frequency);
+}
+
+void note_pwm_solve(uint32_t clock_hz, double frequency, uint32_t *p_psc, uint32_t *p_arr)
+{
+    double ticks = (frequency > 0) ? (double)clock_hz / frequency : (double)NOTE_PWM_MAX_PERIOD;
+    if (ticks > (double)NOTE_PWM_MAX_PERIOD)
+    {
+        ticks = (double)NOTE_PWM_MAX_PERIOD;
+    }
+    if (ticks < (double)NOTE_PWM_MIN_PERIOD)
+    {
+        ticks = (double)NOTE_PWM_MIN_PERIOD;
+    }
+
+    // Periods on both sides of the ideal one, the nearest in cents first: ticks / below against above / ticks
+    uint32_t below = (uint32_t)ticks;
+    uint32_t above = below + 1U;
+    while (true)
+    {
+        bool has_below = (below >= NOTE_PWM_MIN_PERIOD);
+        bool has_above = (above <= NOTE_PWM_MAX_PERIOD);
+        if (has_below && (!has_above || (ticks * ticks <= (double)below * (double)above)))
+        {
+            if (_factor(below, p_psc, p_arr))
+            {
+                return;
+            }
+            below--;
+        }
+        else
+        {
+            if (_factor(above, p_psc, p_arr))
+            {
+                return;
+            }
+            above++;
+        }
+    }
+}
+
+bool note_pwm_find(uint32_t clock_hz, double frequency, uint32_t *p_psc, uint32_t *p_arr)
+{
+    if (clock_hz == note_pwm_table_clock_hz)
+    {
+        size_t first = 0;
+        size_t last = NOTE_PWM_TABLE_LENGTH;
+        while (first < last)
+        {
+            size_t middle = (first + last) / 2;
+            if (note_pwm_table[middle].frequency < frequency)
+            {
+                first = middle + 1;
+            }
+            else
+            {
+                last = middle;
+            }
+        }
+        if ((first < NOTE_PWM_TABLE_LENGTH) && (note_pwm_table[first].frequency == frequency))
+        {
+            *p_psc = note_pwm_table[first].psc;
+            *p_arr = note_pwm_table[first].arr;
+            return true;
+        }
+    }
+    note_pwm_solve(clock_hz, frequency, p_psc, p_arr);
+    return false;
+}
@@ -0,0 +1,276 @@
+/**
+ * @file playlist.c
+ * @brief Order of the songs of the jukebox: queue, repeat and shuffle.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <string.h>
+
+/* Other libraries */
+#include "playlist.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define PLAYLIST_SEED_MIX 0x9E3779B9U   /*!< Odd constant that spreads the bits of a seed (2^32 over the golden ratio) */
+#define PLAYLIST_SEED_ROUNDS 4U         /*!< Numbers drawn after a seed, so that close seeds give unrelated numbers */
+
+/* Private functions ----------------------------------------------------------*/
+/**
+ * @brief Draw the next number of the xorshift32 generator.
+ *
+ * @param p_playlist Pointer to the playlist
+ * @return Random number, never 0
+ */
+static uint32_t _next_random(playlist_t *p_playlist)
+{
+    uint32_t x = p_playlist->random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    p_playlist->random_state = x;
+    return x;
+}
+
+/**
+ * @brief Draw a new round of the shuffle: a Fisher-Yates shuffle of every song, from the first position.
+ *
+ * @param p_playlist Pointer to the playlist
+ * @param avoid Song that must not be the first one, the one that plays, or `PLAYLIST_NONE`
+ */
+static void _shuffle(playlist_t *p_playlist, uint32_t avoid)
+{
+    uint32_t num_songs = p_playlist->num_songs;
+    for (uint32_t i = 0; i < num_songs; i++)
+    {
+        p_playlist->order[i] = (uint8_t)i;
+    }
+    for (uint32_t i = num_songs; i > 1; i--)
+    {
+        uint32_t j = playlist_random(p_playlist, i);
+        uint8_t song = p_playlist->order[i - 1];
+        p_playlist->order[i - 1] = p_playlist->order[j];
+        p_playlist->order[j] = song;
+    }
+    // No song twice in a row across two rounds: the first one swaps with any other one
+    if ((num_songs > 1) && (p_playlist->order[0] == avoid))
+    {
+        uint32_t j = 1 + playlist_random(p_playlist, num_songs - 1);
+        p_playlist->order[0] = p_playlist->order[j];
+        p_playlist->order[j] = (uint8_t)avoid;
+    }
+    p_playlist->position = 0;
+}
+
+/* Public functions -----------------------------------------------------------*/
+void playlist_init(playlist_t *p_playlist, uint32_t num_songs, uint32_t seed)
+{
+    memset(p_playlist, 0, sizeof(playlist_t));
+    p_playlist->num_songs = (num_songs > PLAYLIST_MAX_SONGS) ? PLAYLIST_MAX_SONGS : num_songs;
+    p_playlist->position = p_playlist->num_songs;
+    p_playlist->repeat = PLAYLIST_REPEAT_OFF;
+    p_playlist->random_state = PLAYLIST_SEED_MIX;
+    playlist_seed(p_playlist, seed);
+}
+
+void playlist_seed(playlist_t *p_playlist, uint32_t seed)
+{
+    p_playlist->random_state ^= seed * PLAYLIST_SEED_MIX;
+    if (p_playlist->random_state == 0)
+    {
+        p_playlist->random_state = PLAYLIST_SEED_MIX;
+    }
+    for (uint32_t i = 0; i < PLAYLIST_SEED_ROUNDS; i++)
+    {
+        _next_random(p_playlist);
+    }
+}
+
+void playlist_set_num_songs(playlist_t *p_playlist, uint32_t num_songs)
+{
+    num_songs = (num_songs > PLAYLIST_MAX_SONGS) ? PLAYLIST_MAX_SONGS : num_songs;
+    if (num_songs == p_playlist->num_songs)
+    {
+        return;
+    }
+    p_playlist->num_songs = num_songs;
+    // The queue keeps its order without the songs that are gone
+    uint32_t length = p_playlist->queue_length;
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        uint8_t song = p_playlist->queue[(p_playlist->head + i) & (PLAYLIST_QUEUE_LENGTH - 1)];
+        if (song < num_songs)
+        {
+            p_playlist->queue[(p_playlist->head + kept) & (PLAYLIST_QUEUE_LENGTH - 1)] = song;
+            kept++;
+        }
+    }
+    p_playlist->queue_length = kept;
+    if (p_playlist->shuffle)
+    {
+        _shuffle(p_playlist, PLAYLIST_NONE);
+    }
+}
+
+void playlist_set_repeat(playlist_t *p_playlist, playlist_repeat_t repeat)
+{
+    p_playlist->repeat = repeat;
+}
+
+playlist_repeat_t playlist_get_repeat(const playlist_t *p_playlist)
+{
+    return p_playlist->repeat;
+}
+
+void playlist_set_shuffle(playlist_t *p_playlist, bool shuffle)
+{
+    if (shuffle && !p_playlist->shuffle)
+    {
+        _shuffle(p_playlist, PLAYLIST_NONE);
+    }
+    p_playlist->shuffle = shuffle;
+}
+
+bool playlist_get_shuffle(const playlist_t *p_playlist)
+{
+    return p_playlist->shuffle;
+}
+
+bool playlist_enqueue(playlist_t *p_playlist, uint32_t song)
+{
+    if ((song >= p_playlist->num_songs) || (p_playlist->queue_length == PLAYLIST_QUEUE_LENGTH))
+    {
+        return false;
+    }
+    p_playlist->queue[(p_playlist->head + p_playlist->queue_length) & (PLAYLIST_QUEUE_LENGTH - 1)] = (uint8_t)song;
+    p_playlist->queue_length++;
+    return true;
+}
+
+bool playlist_dequeue(playlist_t *p_playlist, uint32_t *p_song)
+{
+    if (p_playlist->queue_length == 0)
+    {
+        return false;
+    }
+    *p_song = p_playlist->queue[p_playlist->head];
+    p_playlist->head = (p_playlist->head + 1) & (PLAYLIST_QUEUE_LENGTH - 1);
+    p_playlist->queue_length--;
+    return true;
+}
+
+void playlist_clear(playlist_t *p_playlist)
+{
+    p_playlist->head = 0;
+    p_playlist->queue_length = 0;
+}
+
+uint32_t playlist_get_queue_length(const playlist_t *p_playlist)
+{
+    return p_playlist->queue_length;
+}
+
+uint32_t playlist_get_queued(const playlist_t *p_playlist, uint32_t idx)
+{
+    if (idx >= p_playlist->queue_length)
+    {
+        return PLAYLIST_NONE;
+    }
+    return p_playlist->queue[(p_playlist->head + idx) & (PLAYLIST_QUEUE_LENGTH - 1)];
+}
+
+uint32_t playlist_peek(playlist_t *p_playlist, uint32_t current, bool skip)
+{
+    if (!skip && (p_playlist->repeat == PLAYLIST_REPEAT_ONE) && (current < p_playlist->num_songs))
+    {
+        return current;
+    }
+    if (p_playlist->queue_length > 0)
+    {
+        return p_playlist->queue[p_playlist->head];
+    }
+    uint32_t num_songs = p_playlist->num_songs;
+    if (num_songs == 0)
+    {
+        return PLAYLIST_NONE;
+    }
+    bool wrap = skip || (p_playlist->repeat != PLAYLIST_REPEAT_OFF);
+
+    if (p_playlist->shuffle)
+    {
+        // A song chosen by the user may be the next one of the round: it is not played twice in a row
+        if ((p_playlist->position < num_songs) && (p_playlist->order[p_playlist->position] == current))
+        {
+            uint32_t left = num_songs - p_playlist->position - 1;
+            if (left == 0)
+            {
+                p_playlist->position = num_songs;
+            }
+            else
+            {
+                uint32_t j = p_playlist->position + 1 + playlist_random(p_playlist, left);
+                p_playlist->order[p_playlist->position] = p_playlist->order[j];
+                p_playlist->order[j] = (uint8_t)current;
+            }
+        }
+        if (p_playlist->position >= num_songs)
+        {
+            if (!wrap)
+            {
+                return PLAYLIST_NONE;
+            }
+            _shuffle(p_playlist, current);
+        }
+        return p_playlist->order[p_playlist->position];
+    }
+
+    if ((current == PLAYLIST_NONE) || (current + 1 >= num_songs))
+    {
+        return ((current == PLAYLIST_NONE) || wrap) ? 0 : PLAYLIST_NONE;
+    }
+    return current + 1;
+}
+
+uint32_t playlist_advance(playlist_t *p_playlist, uint32_t current, bool skip)
+{
+    uint32_t next = playlist_peek(p_playlist, current, skip);
+    if ((next == PLAYLIST_NONE) || (!skip && (p_playlist->repeat == PLAYLIST_REPEAT_ONE) && (current == next)))
+    {
+        return next;
+    }
+    uint32_t song;
+    if (playlist_dequeue(p_playlist, &song))
+    {
+        return next;
+    }
+    if (p_playlist->shuffle)
+    {
+        p_playlist->position++;
+    }
+    return next;
+}
+
+uint32_t playlist_random(playlist_t *p_playlist, uint32_t bound)
+{
+    if (bound <= 1)
+    {
+        return 0;
+    }
+    // The high half of the product is below the bound. The low half tells the few draws that would favour some
+    // results: those below 2^32 mod bound, checked with a division only when the low half is below the bound.
+    uint64_t product = (uint64_t)_next_random(p_playlist) * bound;
+    uint32_t low = (uint32_t)product;
+    if (low < bound)
+    {
+        uint32_t threshold = (0U - bound) % bound;
+        while (low < threshold)
+        {
+            product = (uint64_t)_next_random(p_playlist) * bound;
+            low = (uint32_t)product;
+        }
+    }
+    return (uint32_t)(product >> 32);
+}
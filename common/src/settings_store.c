@@ -0,0 +1,424 @@
+/**
+ * @file settings_store.c
+ * @brief Log-structured key/value store of the settings, wear-leveled over two flash sectors.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stddef.h>
+#include <string.h>
+
+/* HW dependent libraries */
+#include "port_flash.h"
+
+/* Other libraries */
+#include "settings_store.h"
+#include "frame.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define SETTINGS_STORE_ERASED_16 0xFFFFU        /*!< Erased halfword */
+#define SETTINGS_STORE_ERASED_32 0xFFFFFFFFU    /*!< Erased word */
+#define SETTINGS_STORE_NUM_BLOCKS (PORT_FLASH_SETTINGS_SIZE / SETTINGS_STORE_BLOCK_SIZE) /*!< Blocks of a sector */
+#define SETTINGS_STORE_RECORD_HEAD 2U           /*!< Bytes of `key` and `length` */
+#define SETTINGS_STORE_RECORD_EXTRA 4U          /*!< Bytes of a record besides its value */
+#define SETTINGS_STORE_VALUE_RECORD (SETTINGS_STORE_RECORD_EXTRA + sizeof(uint32_t)) /*!< Bytes of a record of a key */
+#define SETTINGS_STORE_MAX_RECORD (SETTINGS_STORE_RECORD_EXTRA + (1 + SETTINGS_STORE_MAX_KEYS) * sizeof(uint32_t)) /*!< Bytes of the largest checkpoint */
+
+/* Private functions */
+
+/**
+ * @brief Position of the first record of a block: after the header in the first one.
+ *
+ * @param block Block
+ * @return Position in the sector
+ */
+static uint32_t _block_start(uint32_t block)
+{
+    return (block == 0) ? sizeof(settings_store_header_t) : block * SETTINGS_STORE_BLOCK_SIZE;
+}
+
+/**
+ * @brief Read a halfword of a sector.
+ *
+ * @param p_sector Sector
+ * @param offset Position, even
+ * @return Halfword
+ */
+static uint16_t _read_16(const uint8_t *p_sector, uint32_t offset)
+{
+    uint16_t halfword;
+    memcpy(&halfword, p_sector + offset, sizeof(halfword));
+    return halfword;
+}
+
+/**
+ * @brief Check the record at a position of a block.
+ *
+ * @param p_sector Sector
+ * @param offset Position of the record
+ * @param block_end End of its block
+ * @param p_size Pointer to store the bytes of the record, if its first halfword is valid
+ * @return 1 if the record is valid, 0 if its CRC is wrong, -1 if there are no more records in the block
+ */
+static int _check_record(const uint8_t *p_sector, uint32_t offset, uint32_t block_end, uint32_t *p_size)
+{
+    if ((offset + SETTINGS_STORE_RECORD_EXTRA > block_end) ||
+        (_read_16(p_sector, offset) == SETTINGS_STORE_ERASED_16))
+    {
+        return -1;
+    }
+    uint8_t key = p_sector[offset];
+    uint8_t length = p_sector[offset + 1];
+    // A first halfword cut by a reset may take any value: it ends the block
+    bool valid_key = (key < SETTINGS_STORE_MAX_KEYS) ? (length == sizeof(uint32_t))
+                                                     : ((key == SETTINGS_STORE_CHECKPOINT) && (length >= sizeof(uint32_t)));
+    uint32_t size = SETTINGS_STORE_RECORD_EXTRA + length;
+    if (!valid_key || (length % sizeof(uint32_t)) || (size > SETTINGS_STORE_MAX_RECORD) || (offset + size > block_end))
+    {
+        return -1;
+    }
+    *p_size = size;
+    uint16_t crc = _read_16(p_sector, offset + SETTINGS_STORE_RECORD_HEAD + length);
+    return (frame_crc16(p_sector + offset, SETTINGS_STORE_RECORD_HEAD + length) == crc) ? 1 : 0;
+}
+
+/**
+ * @brief Load the values of a valid record.
+ *
+ * @param p_store Pointer to the store
+ * @param p_record Record
+ */
+static void _apply_record(settings_store_t *p_store, const uint8_t *p_record)
+{
+    const uint8_t *p_value = p_record + SETTINGS_STORE_RECORD_HEAD;
+    if (p_record[0] != SETTINGS_STORE_CHECKPOINT)
+    {
+        memcpy(&p_store->values[p_record[0]], p_value, sizeof(uint32_t));
+        p_store->present |= 1UL << p_record[0];
+        return;
+    }
+    // A checkpoint replaces every value
+    uint32_t present;
+    memcpy(&present, p_value, sizeof(present));
+    uint32_t length = p_record[1] / sizeof(uint32_t) - 1;
+    p_store->present = 0;
+    for (uint32_t key = 0; (key < SETTINGS_STORE_MAX_KEYS) && (length > 0); key++)
+    {
+        if (present & (1UL << key))
+        {
+            p_value += sizeof(uint32_t);
+            memcpy(&p_store->values[key], p_value, sizeof(uint32_t));
+            p_store->present |= 1UL << key;
+            length--;
+        }
+    }
+}
+
+/**
+ * @brief Check if a block of the sector in use starts with a valid checkpoint.
+ *
+ * @param p_sector Sector
+ * @param block Block
+ * @return true if it does
+ */
+static bool _has_checkpoint(const uint8_t *p_sector, uint32_t block)
+{
+    uint32_t start = _block_start(block);
+    uint32_t size;
+    return (_check_record(p_sector, start, (block + 1) * SETTINGS_STORE_BLOCK_SIZE, &size) == 1) &&
+           (p_sector[start] == SETTINGS_STORE_CHECKPOINT);
+}
+
+/**
+ * @brief Load the valid records of a block, in order.
+ *
+ * @param p_store Pointer to the store
+ * @param p_sector Sector
+ * @param block Block
+ * @return Position after the last record, or the end of the block if a broken record ends it
+ */
+static uint32_t _replay_block(settings_store_t *p_store, const uint8_t *p_sector, uint32_t block)
+{
+    uint32_t block_end = (block + 1) * SETTINGS_STORE_BLOCK_SIZE;
+    uint32_t offset = _block_start(block);
+    uint32_t size;
+    int result;
+    while ((result = _check_record(p_sector, offset, block_end, &size)) >= 0)
+    {
+        if (result == 1)
+        {
+            _apply_record(p_store, p_sector + offset);
+            p_store->replayed++;
+        }
+        offset += size;
+    }
+    // Erased from here on, or a broken record that hides where the next one would start
+    bool erased = (offset + sizeof(uint16_t) > block_end) ||
+                  (_read_16(p_sector, offset) == SETTINGS_STORE_ERASED_16);
+    return erased ? offset : block_end;
+}
+
+/**
+ * @brief Program a record at the end of the log. The end moves past it even if the flash fails, as it may be half
+ * written.
+ *
+ * @param p_store Pointer to the store
+ * @param sector Sector
+ * @param key Key, or `SETTINGS_STORE_CHECKPOINT`
+ * @param p_value Value
+ * @param length Bytes of the value, a multiple of 4
+ * @return true if programmed
+ */
+static bool _write_record(settings_store_t *p_store, uint32_t sector, uint8_t key, const uint32_t *p_value,
+                          uint32_t length)
+{
+    uint8_t record[SETTINGS_STORE_MAX_RECORD];
+    record[0] = key;
+    record[1] = (uint8_t)length;
+    memcpy(&record[SETTINGS_STORE_RECORD_HEAD], p_value, length);
+    uint16_t crc = frame_crc16(record, SETTINGS_STORE_RECORD_HEAD + length);
+    memcpy(&record[SETTINGS_STORE_RECORD_HEAD + length], &crc, sizeof(crc));
+    uint32_t size = SETTINGS_STORE_RECORD_EXTRA + length;
+    bool ok = port_flash_program_settings(sector, p_store->end, record, size);
+    p_store->end += size;
+    p_store->written++;
+    return ok;
+}
+
+/**
+ * @brief Write a checkpoint with every value at the end of the log. The marks of the keys are cleared.
+ *
+ * @param p_store Pointer to the store
+ * @param sector Sector
+ * @return true if programmed
+ */
+static bool _write_checkpoint(settings_store_t *p_store, uint32_t sector)
+{
+    uint32_t value[1 + SETTINGS_STORE_MAX_KEYS];
+    uint32_t length = 1;
+    value[0] = p_store->present;
+    for (uint32_t key = 0; key < SETTINGS_STORE_MAX_KEYS; key++)
+    {
+        if (p_store->present & (1UL << key))
+        {
+            value[length++] = p_store->values[key];
+        }
+    }
+    p_store->dirty = 0;
+    return _write_record(p_store, sector, SETTINGS_STORE_CHECKPOINT, value, length * sizeof(uint32_t));
+}
+
+/**
+ * @brief Check if a sector is erased, reading it by words until a written one.
+ *
+ * @param sector Sector
+ * @return true if every byte is erased
+ */
+static bool _is_erased(uint32_t sector)
+{
+    const uint8_t *p_sector = port_flash_get_settings(sector);
+    for (uint32_t offset = 0; offset < PORT_FLASH_SETTINGS_SIZE; offset += sizeof(uint32_t))
+    {
+        uint32_t word;
+        memcpy(&word, p_sector + offset, sizeof(word));
+        if (word != SETTINGS_STORE_ERASED_32)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Move the values to the other sector: header, checkpoint and then the commit mark. The sector in use is left
+ * as it is, valid until the commit.
+ *
+ * @param p_store Pointer to the store
+ * @param can_erase true if the other sector may be erased now
+ * @return `SETTINGS_STORE_OK`, `SETTINGS_STORE_BUSY` or `SETTINGS_STORE_FLASH_ERROR`
+ */
+static settings_store_status_t _compact(settings_store_t *p_store, bool can_erase)
+{
+    uint32_t target = (p_store->sector == SETTINGS_STORE_NO_SECTOR) ? 0 : 1 - p_store->sector;
+    if (p_store->spare == SETTINGS_STORE_SPARE_UNKNOWN)
+    {
+        // Once per mount: a new board has both sectors erased and needs no erase
+        p_store->spare = _is_erased(target) ? SETTINGS_STORE_SPARE_ERASED : SETTINGS_STORE_SPARE_USED;
+    }
+    if (p_store->spare == SETTINGS_STORE_SPARE_USED)
+    {
+        if (!can_erase)
+        {
+            p_store->waiting = true;
+            return SETTINGS_STORE_BUSY;
+        }
+        p_store->spare = SETTINGS_STORE_SPARE_UNKNOWN;
+        if (!port_flash_erase_settings(target))
+        {
+            p_store->dirty = 0;
+            return SETTINGS_STORE_FLASH_ERROR;
+        }
+    }
+
+    settings_store_header_t header;
+    memset(&header, 0xFF, sizeof(header));
+    header.magic = SETTINGS_STORE_MAGIC;
+    header.sequence = p_store->sequence + 1;
+    uint16_t commit = SETTINGS_STORE_COMMITTED;
+    uint32_t previous = p_store->sector;
+    uint32_t previous_sequence = p_store->sequence;
+    p_store->sector = target;
+    p_store->sequence = header.sequence;
+    p_store->block = 0;
+    p_store->end = _block_start(0);
+    p_store->checkpointed = true;
+    // The sector left holds the log, unless this is the first one of the board
+    p_store->spare = (previous == SETTINGS_STORE_NO_SECTOR) ? SETTINGS_STORE_SPARE_UNKNOWN : SETTINGS_STORE_SPARE_USED;
+    p_store->compactions++;
+    p_store->waiting = false;
+    bool ok = port_flash_program_settings(target, 0, &header, sizeof(header)) && _write_checkpoint(p_store, target) &&
+              port_flash_program_settings(target, offsetof(settings_store_header_t, commit), &commit, sizeof(commit));
+    if (!ok)
+    {
+        // The previous sector is still the valid one in the flash
+        p_store->sector = previous;
+        p_store->sequence = previous_sequence;
+        p_store->block = SETTINGS_STORE_NUM_BLOCKS;
+        p_store->dirty = 0;
+        return SETTINGS_STORE_FLASH_ERROR;
+    }
+    return SETTINGS_STORE_OK;
+}
+
+/* Public functions -----------------------------------------------------------*/
+void settings_store_mount(settings_store_t *p_store)
+{
+    memset(p_store, 0, sizeof(settings_store_t));
+    p_store->sector = SETTINGS_STORE_NO_SECTOR;
+    for (uint32_t sector = 0; sector < PORT_FLASH_SETTINGS_SECTORS; sector++)
+    {
+        const settings_store_header_t *p_header = (const settings_store_header_t *)port_flash_get_settings(sector);
+        if ((p_header->magic == SETTINGS_STORE_MAGIC) && (p_header->commit == SETTINGS_STORE_COMMITTED) &&
+            ((p_store->sector == SETTINGS_STORE_NO_SECTOR) || (p_header->sequence > p_store->sequence)))
+        {
+            p_store->sector = sector;
+            p_store->sequence = p_header->sequence;
+        }
+    }
+    if (p_store->sector == SETTINGS_STORE_NO_SECTOR)
+    {
+        return;
+    }
+    const uint8_t *p_sector = port_flash_get_settings(p_store->sector);
+
+    // The blocks in use are the first ones: the last one is the last whose first halfword is written
+    uint32_t low = 0;
+    uint32_t high = SETTINGS_STORE_NUM_BLOCKS - 1;
+    while (low < high)
+    {
+        uint32_t middle = (low + high + 1) / 2;
+        if (_read_16(p_sector, _block_start(middle)) != SETTINGS_STORE_ERASED_16)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+    // The first block always has its checkpoint, written before the commit
+    uint32_t first = low;
+    while ((first > 0) && !_has_checkpoint(p_sector, first))
+    {
+        first--;
+    }
+    for (uint32_t block = first; block <= low; block++)
+    {
+        p_store->end = _replay_block(p_store, p_sector, block);
+    }
+    // A block whose checkpoint was cut is not written again: the next record starts the next block
+    p_store->checkpointed = _has_checkpoint(p_sector, low);
+    p_store->block = p_store->checkpointed ? low : low + 1;
+}
+
+uint32_t settings_store_get(const settings_store_t *p_store, uint32_t key, uint32_t default_value)
+{
+    if ((key >= SETTINGS_STORE_MAX_KEYS) || !(p_store->present & (1UL << key)))
+    {
+        return default_value;
+    }
+    return p_store->values[key];
+}
+
+void settings_store_set(settings_store_t *p_store, uint32_t key, uint32_t value, uint32_t now_ms)
+{
+    if ((key >= SETTINGS_STORE_MAX_KEYS) ||
+        ((p_store->present & (1UL << key)) && (p_store->values[key] == value)))
+    {
+        return;
+    }
+    p_store->values[key] = value;
+    p_store->present |= 1UL << key;
+    p_store->dirty |= 1UL << key;
+    p_store->changed_ms = now_ms;
+}
+
+bool settings_store_is_pending(const settings_store_t *p_store)
+{
+    return p_store->dirty != 0;
+}
+
+bool settings_store_is_due(const settings_store_t *p_store, uint32_t now_ms, bool can_erase)
+{
+    return (p_store->dirty != 0) && (now_ms - p_store->changed_ms >= SETTINGS_STORE_DELAY_MS) &&
+           (can_erase || !p_store->waiting);
+}
+
+settings_store_status_t settings_store_flush(settings_store_t *p_store, bool can_erase)
+{
+    if (p_store->sector == SETTINGS_STORE_NO_SECTOR)
+    {
+        return (p_store->dirty == 0) ? SETTINGS_STORE_OK : _compact(p_store, can_erase);
+    }
+    while (p_store->dirty != 0)
+    {
+        uint32_t block_end = (p_store->block + 1) * SETTINGS_STORE_BLOCK_SIZE;
+        if (p_store->checkpointed && (p_store->end + SETTINGS_STORE_VALUE_RECORD > block_end))
+        {
+            // The block is full: the next one starts with a checkpoint
+            p_store->block++;
+            p_store->checkpointed = false;
+        }
+        if (p_store->block >= SETTINGS_STORE_NUM_BLOCKS)
+        {
+            return _compact(p_store, can_erase);
+        }
+        bool ok;
+        if (!p_store->checkpointed)
+        {
+            p_store->end = _block_start(p_store->block);
+            p_store->checkpointed = true;
+            ok = _write_checkpoint(p_store, p_store->sector);
+        }
+        else
+        {
+            // One record per key: the lowest one marked first
+            uint32_t key = 0;
+            while (!(p_store->dirty & (1UL << key)))
+            {
+                key++;
+            }
+            p_store->dirty &= ~(1UL << key);
+            ok = _write_record(p_store, p_store->sector, (uint8_t)key, &p_store->values[key], sizeof(uint32_t));
+        }
+        if (!ok)
+        {
+            p_store->dirty = 0;
+            return SETTINGS_STORE_FLASH_ERROR;
+        }
+    }
+    return SETTINGS_STORE_OK;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file telemetry.c
+ * @brief Periodic status records of the jukebox, delta-encoded in frames of the binary protocol.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <string.h>
+
+/* Other libraries */
+#include "telemetry.h"
+
+/* Private variables */
+
+/// @brief Bytes of each field, indexed by `TELEMETRY_FIELDS`
+static const uint8_t field_bytes[TELEMETRY_NUM_FIELDS] = {
+    [TELEMETRY_STATES] = 2,
+    [TELEMETRY_MELODY] = 1,
+    [TELEMETRY_NOTE] = 2,
+    [TELEMETRY_VOLUME] = 1,
+    [TELEMETRY_SPEED] = 2,
+    [TELEMETRY_RX_OVERFLOWS] = 2,
+    [TELEMETRY_TX_OVERFLOWS] = 2,
+    [TELEMETRY_LOOPS] = 2,
+};
+
+/* Public functions */
+void telemetry_init(telemetry_t *p_telemetry)
+{
+    memset(p_telemetry, 0, sizeof(telemetry_t));
+}
+
+bool telemetry_start(telemetry_t *p_telemetry, uint32_t period_ms, uint32_t now_ms)
+{
+    if ((period_ms < TELEMETRY_MIN_PERIOD_MS) || (period_ms > TELEMETRY_MAX_PERIOD_MS))
+    {
+        return false;
+    }
+    p_telemetry->period_ms = period_ms;
+    p_telemetry->next_ms = now_ms;
+    p_telemetry->keyframe_countdown = 0;
+    p_telemetry->loops = 0;
+    p_telemetry->loops_start_ms = now_ms;
+    return true;
+}
+
+void telemetry_stop(telemetry_t *p_telemetry)
+{
+    p_telemetry->period_ms = 0;
+}
+
+bool telemetry_is_on(const telemetry_t *p_telemetry)
+{
+    return p_telemetry->period_ms != 0;
+}
+
+void telemetry_count_loop(telemetry_t *p_telemetry, uint32_t now_ms)
+{
+    p_telemetry->loops++;
+    uint32_t elapsed = now_ms - p_telemetry->loops_start_ms;
+    if (elapsed >= TELEMETRY_LOOPS_WINDOW_MS)
+    {
+        uint32_t loops_per_s = (uint32_t)((uint64_t)p_telemetry->loops * 1000U / elapsed);
+        p_telemetry->loops_per_s = (loops_per_s > UINT16_MAX) ? UINT16_MAX : (uint16_t)loops_per_s;
+        p_telemetry->loops = 0;
+        p_telemetry->loops_start_ms = now_ms;
+    }
+}
+
+uint16_t telemetry_get_loops_per_s(const telemetry_t *p_telemetry)
+{
+    return p_telemetry->loops_per_s;
+}
+
+bool telemetry_is_due(const telemetry_t *p_telemetry, uint32_t now_ms)
+{
+    return telemetry_is_on(p_telemetry) && ((int32_t)(now_ms - p_telemetry->next_ms) >= 0);
+}
+
+void telemetry_encode(telemetry_t *p_telemetry, const telemetry_record_t *p_record, uint32_t now_ms, frame_t *p_frame)
+{
+    uint8_t mask = 0;
+    for (uint32_t i = 0; i < TELEMETRY_NUM_FIELDS; i++)
+    {
+        if ((p_telemetry->keyframe_countdown == 0) || (p_record->fields[i] != p_telemetry->last.fields[i]))
+        {
+            mask |= (uint8_t)(1U << i);
+        }
+    }
+
+    p_frame->opcode = FRAME_OP_RECORD;
+    p_frame->seq = p_telemetry->seq++;
+    p_frame->length = 0;
+    frame_put_u8(p_frame, mask);
+    for (uint32_t i = 0; i < TELEMETRY_NUM_FIELDS; i++)
+    {
+        if (!(mask & (1U << i)))
+        {
+            continue;
+        }
+        if (field_bytes[i] == 1)
+        {
+            frame_put_u8(p_frame, (uint8_t)p_record->fields[i]);
+        }
+        else
+        {
+            frame_put_u16(p_frame, p_record->fields[i]);
+        }
+    }
+
+    p_telemetry->last = *p_record;
+    p_telemetry->keyframe_countdown = (p_telemetry->keyframe_countdown == 0) ? TELEMETRY_KEYFRAME_INTERVAL - 1 : p_telemetry->keyframe_countdown - 1;
+    // Keep the period, unless the records are late: then skip the ones missed instead of sending a burst
+    p_telemetry->next_ms += p_telemetry->period_ms;
+    if ((int32_t)(now_ms - p_telemetry->next_ms) >= 0)
+    {
+        p_telemetry->next_ms = now_ms + p_telemetry->period_ms;
+    }
+}
+
+uint16_t telemetry_pack_states(int jukebox, int button, int usart, int buzzer)
+{
+    return (uint16_t)((jukebox & 0xF) | ((button & 0xF) << 4) | ((usart & 0xF) << 8) | ((buzzer & 0xF) << 12));
+}
+
+void telemetry_decoder_init(telemetry_decoder_t *p_decoder)
+{
+    memset(p_decoder, 0, sizeof(telemetry_decoder_t));
+}
+
+bool telemetry_decode(telemetry_decoder_t *p_decoder, const frame_t *p_frame)
+{
+    if ((p_frame->opcode != FRAME_OP_RECORD) || (p_frame->length < 1))
+    {
+        return false;
+    }
+    uint8_t mask = p_frame->payload[0];
+    uint8_t offset = 1;
+    telemetry_record_t record = p_decoder->record;
+    for (uint32_t i = 0; i < TELEMETRY_NUM_FIELDS; i++)
+    {
+        if (!(mask & (1U << i)))
+        {
+            continue;
+        }
+        if (offset + field_bytes[i] > p_frame->length)
+        {
+            return false; // Shorter than its mask
+        }
+        record.fields[i] = (field_bytes[i] == 1) ? p_frame->payload[offset] : frame_get_u16(p_frame, offset);
+        offset += field_bytes[i];
+    }
+
+    // A missing record leaves the fields it changed unknown until the next record with every field
+    if (p_decoder->records > 0)
+    {
+        uint8_t gap = (uint8_t)(p_frame->seq - p_decoder->seq - 1);
+        p_decoder->lost += gap;
+        if (gap)
+        {
+            p_decoder->synced = false;
+        }
+    }
+    if (mask == TELEMETRY_ALL_FIELDS)
+    {
+        p_decoder->synced = true;
+    }
+    p_decoder->record = record;
+    p_decoder->seq = p_frame->seq;
+    p_decoder->records++;
+    return p_decoder->synced;
+}
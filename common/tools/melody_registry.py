@@ -0,0 +1,86 @@
+"""Generate the perfect-hash name index of the melody registry.
+
+Reads the names of the melodies and the registry `melodies[]` from melodies.c, searches the seed for which
+`melody_registry_hash()` (melody_registry.c) sends every name to a different slot, and writes the seed and the
+slots as a C file. CMake runs it when the project is configured and again whenever melodies.c changes.
+
+usage: melody_registry.py <melodies.c> <melody_registry.h> <output.c>
+"""
+
+import re
+import sys
+
+FNV_OFFSET_BASIS = 2166136261
+FNV_PRIME = 16777619
+EMPTY = 0xFF
+MAX_SEED = 1 << 20
+
+
+def fnv1a(name, seed):
+    """Same hash as melody_registry_hash(): FNV-1a of the lowercase name, starting from the seed, with the high
+    half folded into the low one."""
+    h = FNV_OFFSET_BASIS ^ seed
+    for c in name.lower().encode():
+        h ^= c
+        h = (h * FNV_PRIME) & 0xFFFFFFFF
+    return h ^ (h >> 16)
+
+
+def fail(message):
+    sys.exit('melody_registry.py: ' + message)
+
+
+def read_registry(source):
+    names = dict(re.findall(r'const\s+melody_t\s+(\w+)\s*=\s*\{\s*\.p_name\s*=\s*"([^"]+)"', source))
+    table = re.search(r'const\s+melody_t\s*\*\s*const\s+melodies\s*\[[^\]]*\]\s*=\s*\{([^}]*)\}', source)
+    if table is None:
+        fail('registry melodies[] not found')
+    registry = []
+    for melody in re.findall(r'&\s*(\w+)', table.group(1)):
+        if melody not in names:
+            fail('name of ' + melody + ' not found')
+        registry.append(names[melody])
+    lowercase = [name.lower() for name in registry]
+    if len(set(lowercase)) != len(lowercase):
+        fail('two melodies have the same name')
+    return registry
+
+
+def main():
+    if len(sys.argv) != 4:
+        sys.exit(__doc__)
+    with open(sys.argv[1]) as f:
+        registry = read_registry(f.read())
+    with open(sys.argv[2]) as f:
+        slots = int(re.search(r'#define\s+MELODY_REGISTRY_SLOTS\s+(\d+)', f.read()).group(1))
+    if len(registry) > slots or slots & (slots - 1):
+        fail('MELODY_REGISTRY_SLOTS must be a power of 2 of at least %d' % len(registry))
+
+    for seed in range(MAX_SEED):
+        index = [EMPTY] * slots
+        for melody_idx, name in enumerate(registry):
+            slot = fnv1a(name, seed) & (slots - 1)
+            if index[slot] != EMPTY:
+                break
+            index[slot] = melody_idx
+        else:
+            break
+    else:
+        fail('no perfect hash found, increase MELODY_REGISTRY_SLOTS')
+
+    with open(sys.argv[3], 'w') as f:
+        f.write('/**\n')
+        f.write(' * @file melody_registry_index.c\n')
+        f.write(' * @brief Perfect-hash index of the melody names. Generated by melody_registry.py from melodies.c, do not edit.\n')
+        f.write(' */\n\n')
+        f.write('#include "melody_registry.h"\n\n')
+        f.write('const uint32_t melody_registry_seed = %uU;\n\n' % seed)
+        f.write('const uint8_t melody_registry_slots[MELODY_REGISTRY_SLOTS] = {\n')
+        for slot, melody_idx in enumerate(index):
+            comment = registry[melody_idx] if melody_idx != EMPTY else 'empty'
+            f.write('    0x%02X, /* %2d: %s */\n' % (melody_idx, slot, comment))
+        f.write('};\n')
+
+
+if __name__ == '__main__':
+    main()
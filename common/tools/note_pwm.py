@@ -0,0 +1,83 @@
+"""Generate the table of timer registers of the notes of melodies.h.
+
+Reads the note frequencies of melodies.h and, for the clock of the timer, solves the prescaler and auto-reload with
+the smallest error in cents as note_pwm_solve() (note_pwm.c) does, and writes them as a C file. CMake runs it when
+the project is configured and again whenever melodies.h changes.
+
+usage: note_pwm.py <melodies.h> <note_pwm.h> <clock_hz> <output.c>
+"""
+
+import math
+import re
+import sys
+
+MAX_COUNT = 65536
+MIN_PERIOD = 2
+MAX_PERIOD = MAX_COUNT * (MAX_COUNT - 1)
+
+
+def fail(message):
+    sys.exit('note_pwm.py: ' + message)
+
+
+def factor(period):
+    """Same split as _factor(): the smallest prescaler that keeps the auto-reload in 16 bits."""
+    prescaler = (period - 1) // MAX_COUNT + 1
+    while prescaler <= period // prescaler:
+        if period % prescaler == 0:
+            return prescaler - 1, period // prescaler - 1
+        prescaler += 1
+    return None
+
+
+def solve(clock_hz, frequency):
+    """Same search as note_pwm_solve(): the periods nearest to the ideal one in cents, until one factors."""
+    ticks = min(max(clock_hz / frequency, float(MIN_PERIOD)), float(MAX_PERIOD))
+    below = int(ticks)
+    above = below + 1
+    while True:
+        has_below = below >= MIN_PERIOD
+        has_above = above <= MAX_PERIOD
+        if has_below and (not has_above or ticks * ticks <= float(below) * float(above)):
+            registers = factor(below)
+            below -= 1
+        else:
+            registers = factor(above)
+            above += 1
+        if registers:
+            return registers
+
+
+def cents(frequency, clock_hz, psc, arr):
+    return 1200.0 * math.log2(clock_hz / ((psc + 1) * (arr + 1)) / frequency)
+
+
+def main():
+    if len(sys.argv) != 5:
+        sys.exit(__doc__)
+    with open(sys.argv[1]) as f:
+        notes = re.findall(r'#define\s+(\w+)\s+(\d+\.\d+)\s*/\*!<\s*\S+ note frequency', f.read())
+    with open(sys.argv[2]) as f:
+        length = int(re.search(r'#define\s+NOTE_PWM_TABLE_LENGTH\s+(\d+)', f.read()).group(1))
+    clock_hz = int(sys.argv[3])
+    notes = sorted((float(value), name) for name, value in notes)
+    if len(notes) != length:
+        fail('melodies.h has %d notes, NOTE_PWM_TABLE_LENGTH is %d' % (len(notes), length))
+
+    with open(sys.argv[4], 'w') as f:
+        f.write('/**\n')
+        f.write(' * @file note_pwm_table.c\n')
+        f.write(' * @brief Timer registers of the notes of melodies.h. Generated by note_pwm.py, do not edit.\n')
+        f.write(' */\n\n')
+        f.write('#include "note_pwm.h"\n\n')
+        f.write('const uint32_t note_pwm_table_clock_hz = %uU;\n\n' % clock_hz)
+        f.write('const note_pwm_t note_pwm_table[NOTE_PWM_TABLE_LENGTH] = {\n')
+        for frequency, name in notes:
+            psc, arr = solve(clock_hz, frequency)
+            f.write('    {%r, %u, %u}, /* %s, %+.4f cents */\n'
+                    % (frequency, psc, arr, name, cents(frequency, clock_hz, psc, arr)))
+        f.write('};\n')
+
+
+if __name__ == '__main__':
+    main()
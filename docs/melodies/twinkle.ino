@@ -0,0 +1,42 @@
+/*
+ * Twinkle, twinkle, little star on a buzzer in pin 8.
+ */
+#define BUZZER_PIN 8
+#define TEMPO_MS 500              // A quarter note
+const float GAP = 0.1;            // Silence between notes, as a part of the note
+
+void setup() {
+  tone(BUZZER_PIN, NOTE_C4, TEMPO_MS * (1 - GAP));
+  delay(TEMPO_MS);
+  tone(BUZZER_PIN, NOTE_C4, TEMPO_MS * (1 - GAP));
+  delay(TEMPO_MS);
+  tone(BUZZER_PIN, NOTE_G4, TEMPO_MS * (1 - GAP));
+  delay(TEMPO_MS);
+  tone(BUZZER_PIN, NOTE_G4, TEMPO_MS * (1 - GAP));
+  delay(TEMPO_MS);
+  tone(BUZZER_PIN, NOTE_A4, TEMPO_MS * (1 - GAP));
+  delay(TEMPO_MS);
+  tone(BUZZER_PIN, NOTE_A4, TEMPO_MS * (1 - GAP));
+  delay(TEMPO_MS);
+  tone(BUZZER_PIN, NOTE_G4);
+  delay(2 * TEMPO_MS);
+  noTone(BUZZER_PIN);
+  delay(TEMPO_MS / 2);            /* A rest */
+  tone(BUZZER_PIN, NOTE_F4, TEMPO_MS * (1 - GAP));
+  delay(TEMPO_MS);
+  tone(BUZZER_PIN, NOTE_F4, TEMPO_MS * (1 - GAP));
+  delay(TEMPO_MS);
+  tone(BUZZER_PIN, NOTE_E4, TEMPO_MS * (1 - GAP));
+  delay(TEMPO_MS);
+  tone(BUZZER_PIN, NOTE_E4, TEMPO_MS * (1 - GAP));
+  delay(TEMPO_MS);
+  tone(BUZZER_PIN, NOTE_D4, TEMPO_MS * (1 - GAP));
+  delay(TEMPO_MS);
+  tone(BUZZER_PIN, NOTE_D4, TEMPO_MS * (1 - GAP));
+  delay(TEMPO_MS);
+  tone(BUZZER_PIN, NOTE_C4, 2 * TEMPO_MS);
+  delay(2 * TEMPO_MS);
+}
+
+void loop() {
+}
@@ -0,0 +1,91 @@
+/**
+ * @file jukebox_client.h
+ * @brief Header for jukebox_client.c file.
+ *
+ * Host side of the USART protocols of the jukebox (see `frame.h`), independent of the transport: the client writes
+ * through a callback and is fed the bytes received one by one. In a text session a reply is a line ended by `\n`; in a
+ * binary session it is a frame. Requests are numbered by the client, so that a reply can be matched to its request.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+#ifndef JUKEBOX_CLIENT_H_
+#define JUKEBOX_CLIENT_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Other includes */
+#include "frame.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define JUKEBOX_CLIENT_LINE_LENGTH 128 /*!< Longest text reply kept, longer lines are truncated */
+
+/* Typedefs --------------------------------------------------------------------*/
+/// @brief Transport: write bytes to the jukebox
+typedef void (*jukebox_client_write_cb_t)(void *p_arg, const uint8_t *p_data, size_t length);
+
+/// @brief Client of a jukebox
+typedef struct
+{
+    jukebox_client_write_cb_t write;            /*!< Transport */
+    void *p_arg;                                /*!< Pointer passed to the transport */
+    bool binary;                                /*!< Binary session */
+    uint8_t seq;                                /*!< Sequence number of the last request */
+    uint8_t rx[FRAME_MAX_ENCODED];              /*!< Frame being received */
+    size_t rx_length;                           /*!< Bytes in `rx` */
+    char line[JUKEBOX_CLIENT_LINE_LENGTH];      /*!< Text reply being received, then the last one */
+    size_t line_length;                         /*!< Characters in `line` */
+    frame_t reply;                              /*!< Last frame received */
+    uint32_t bad_frames;                        /*!< Frames dropped for their COBS, length or CRC */
+    uint64_t bytes_sent;                        /*!< Bytes written to the transport */
+    uint64_t bytes_received;                    /*!< Bytes fed to the client */
+} jukebox_client_t;
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Initialize a client in a text session
+/// @param p_client Pointer to the client
+/// @param write Transport
+/// @param p_arg Pointer passed to the transport
+void jukebox_client_init(jukebox_client_t *p_client, jukebox_client_write_cb_t write, void *p_arg);
+
+/// @brief Start a binary session (`FRAME_MAGIC`) or return to text (`FRAME_OP_TEXT`). The jukebox must be idle.
+/// @param p_client Pointer to the client
+/// @param binary true for a binary session
+void jukebox_client_set_binary(jukebox_client_t *p_client, bool binary);
+
+/// @brief Send a text command, without its end character
+/// @param p_client Pointer to the client
+/// @param p_command Command, e.g. `"volume 0.5"`
+void jukebox_client_send_text(jukebox_client_t *p_client, const char *p_command);
+
+/// @brief Send a request of a binary session. Its sequence number is set by the client.
+/// @param p_client Pointer to the client
+/// @param p_request Pointer to the request (opcode and payload)
+/// @return Sequence number of the request
+uint8_t jukebox_client_send_request(jukebox_client_t *p_client, frame_t *p_request);
+
+/// @brief Process a byte received from the jukebox
+/// @param p_client Pointer to the client
+/// @param byte Byte received
+/// @return true if it completed a reply: a valid frame in a binary session, a line in a text session
+bool jukebox_client_feed(jukebox_client_t *p_client, uint8_t byte);
+
+/// @brief Get the last frame received
+/// @param p_client Pointer to the client
+/// @return Pointer to the frame
+const frame_t *jukebox_client_get_reply(const jukebox_client_t *p_client);
+
+/// @brief Get the last line received, with its end character
+/// @param p_client Pointer to the client
+/// @return Line
+const char *jukebox_client_get_line(const jukebox_client_t *p_client);
+
+#endif /* JUKEBOX_CLIENT_H_ */
@@ -0,0 +1,52 @@
+/**
+ * @file jukebox_serial.h
+ * @brief Header for jukebox_serial.c file.
+ *
+ * Serial port transport of the client (POSIX `termios`): raw mode, 8 data bits, no parity, 1 stop bit.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+#ifndef JUKEBOX_SERIAL_H_
+#define JUKEBOX_SERIAL_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stddef.h>
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Open and configure a serial port
+/// @param p_path Device, e.g. `/dev/ttyACM0`
+/// @param baud Baud rate (one of the standard rates, up to 1000000 where the system has it)
+/// @return File descriptor, or -1 on error
+int jukebox_serial_open(const char *p_path, uint32_t baud);
+
+/// @brief Change the baud rate of an open serial port, after the pending output is sent
+/// @param fd File descriptor
+/// @param baud Baud rate
+/// @return 0, or -1 on error
+int jukebox_serial_set_baud(int fd, uint32_t baud);
+
+/// @brief Transport of the client (`jukebox_client_write_cb_t`): write every byte to the port
+/// @param p_arg Pointer to the file descriptor
+/// @param p_data Pointer to the bytes
+/// @param length Number of bytes
+void jukebox_serial_write(void *p_arg, const uint8_t *p_data, size_t length);
+
+/// @brief Read the bytes available, waiting for them up to a timeout
+/// @param fd File descriptor
+/// @param p_data Pointer to the buffer
+/// @param length Size of the buffer
+/// @param timeout_ms Longest wait
+/// @return Bytes read, 0 on timeout, -1 on error
+int jukebox_serial_read(int fd, uint8_t *p_data, size_t length, uint32_t timeout_ms);
+
+/// @brief Close a serial port
+/// @param fd File descriptor
+void jukebox_serial_close(int fd);
+
+#endif /* JUKEBOX_SERIAL_H_ */
@@ -0,0 +1,106 @@
+/**
+ * @file melody_import.h
+ * @brief Header for melody_import.c file.
+ *
+ * Readers of the melody formats of `jukebox_import`. Each one turns a file into a monophonic list of notes, with
+ * the frequency in Hz and the duration in ms, not yet fitted to the buzzer:
+ * - Standard MIDI File (format 0 or 1): the voice (track and channel) that sounds the longest is kept, drums
+ *   excluded. Where its notes overlap the highest one sounds, and a lower note that starts under a higher one is
+ *   dropped. The tempo changes of every track apply.
+ * - RTTTL (`name:d=4,o=5,b=120:8c6,8p,...`): one melody per line.
+ * - Arduino sketch: the calls to `tone()`, `noTone()`, `delay()` and `delayMicroseconds()` are played in the order
+ *   they are written; loops are not unrolled. The arguments can use numbers, the `NOTE_*` constants of `pitches.h`
+ *   and the constants of the sketch (`#define` or `const`), with `+ - * /` and parentheses.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+#ifndef MELODY_IMPORT_H_
+#define MELODY_IMPORT_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Other includes */
+#include "melody_pack.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define MELODY_IMPORT_DRUM_CHANNEL 9    /*!< MIDI channel of the drums (channel 10 for the musicians) */
+#define MELODY_IMPORT_MAX_SYMBOLS 512   /*!< Most constants of a sketch */
+
+/* Enums */
+/// @brief Formats of the melody files
+typedef enum {
+    MELODY_IMPORT_UNKNOWN = 0,          /*!< Not a melody file */
+    MELODY_IMPORT_MIDI,                 /*!< `.mid`, `.midi` */
+    MELODY_IMPORT_RTTTL,                /*!< `.rtttl`, `.rtx`, `.txt` */
+    MELODY_IMPORT_SKETCH,               /*!< `.ino` */
+} melody_import_format_t;
+
+/* Typedefs ------------------------------------------------------------------*/
+/// @brief Note read from a file
+typedef struct {
+    double frequency;                   /*!< Frequency in Hz, 0 for a silence */
+    double duration_ms;                 /*!< Duration in ms */
+} melody_import_note_t;
+
+/// @brief Melody read from a file
+typedef struct {
+    char name[MELODY_PACK_NAME_LENGTH]; /*!< Name: lowercase letters, digits and `_` */
+    melody_import_note_t *p_notes;      /*!< Notes, allocated as they are added */
+    uint32_t num_notes;                 /*!< Notes of the melody */
+    uint32_t capacity;                  /*!< Notes that fit in `p_notes` */
+} melody_import_t;
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Get the format of a file from its extension.
+/// @param p_path Path of the file
+/// @return Format, `MELODY_IMPORT_UNKNOWN` if it is not a melody file
+melody_import_format_t melody_import_get_format(const char *p_path);
+
+/// @brief Set the name of a melody from any text, e.g. a file name: lowercase, other characters as `_`.
+/// @param p_melody Pointer to the melody
+/// @param p_text Text, it is cut at the first `.` or `:` and at `MELODY_PACK_NAME_LENGTH - 1` characters
+void melody_import_set_name(melody_import_t *p_melody, const char *p_text);
+
+/// @brief Add a note at the end of a melody. A silence after a silence lengthens it.
+/// @param p_melody Pointer to the melody
+/// @param frequency Frequency in Hz, 0 for a silence
+/// @param duration_ms Duration in ms. Notes of no duration are not added.
+/// @return true if added, false if out of memory
+bool melody_import_add_note(melody_import_t *p_melody, double frequency, double duration_ms);
+
+/// @brief Free the notes of a melody.
+/// @param p_melody Pointer to the melody
+void melody_import_free(melody_import_t *p_melody);
+
+/// @brief Read the dominant voice of a Standard MIDI File.
+/// @param p_data Contents of the file
+/// @param size Bytes of the file
+/// @param p_melody Pointer to the melody, empty
+/// @param pp_error Pointer to store the reason of an error
+/// @return true if a melody was read
+bool melody_import_midi(const uint8_t *p_data, size_t size, melody_import_t *p_melody, const char **pp_error);
+
+/// @brief Read a melody in RTTTL. Its name is the one of the RTTTL.
+/// @param p_text Line of text
+/// @param p_melody Pointer to the melody, empty
+/// @param pp_error Pointer to store the reason of an error
+/// @return true if a melody was read
+bool melody_import_rtttl(const char *p_text, melody_import_t *p_melody, const char **pp_error);
+
+/// @brief Read the melody of an Arduino sketch.
+/// @param p_text Contents of the sketch, ended by '\0'
+/// @param p_melody Pointer to the melody, empty
+/// @param pp_error Pointer to store the reason of an error
+/// @return true if a melody was read
+bool melody_import_sketch(const char *p_text, melody_import_t *p_melody, const char **pp_error);
+
+#endif /* MELODY_IMPORT_H_ */
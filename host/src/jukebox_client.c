@@ -0,0 +1,136 @@
+/**
+ * @file jukebox_client.c
+ * @brief Host client of the USART protocols of the jukebox.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
+#include "jukebox_client.h"
+
+/* Private functions -----------------------------------------------------------*/
+/// @brief Write bytes through the transport
+/// @param p_client Pointer to the client
+/// @param p_data Pointer to the bytes
+/// @param length Number of bytes
+static void _write(jukebox_client_t *p_client, const uint8_t *p_data, size_t length)
+{
+    p_client->write(p_client->p_arg, p_data, length);
+    p_client->bytes_sent += length;
+}
+
+/// @brief Process a byte of a binary session
+/// @param p_client Pointer to the client
+/// @param byte Byte received
+/// @return true if it completed a valid frame
+static bool _feed_frame(jukebox_client_t *p_client, uint8_t byte)
+{
+    if (byte != FRAME_DELIMITER)
+    {
+        if (p_client->rx_length < sizeof(p_client->rx))
+        {
+            p_client->rx[p_client->rx_length] = byte;
+        }
+        p_client->rx_length++; // Counted anyway, so that a frame too long is dropped
+        return false;
+    }
+    size_t length = p_client->rx_length;
+    p_client->rx_length = 0;
+    if (length == 0)
+    {
+        return false;
+    }
+    if ((length > sizeof(p_client->rx)) || !frame_decode(p_client->rx, length, &p_client->reply))
+    {
+        p_client->bad_frames++;
+        return false;
+    }
+    return true;
+}
+
+/// @brief Process a character of a text session
+/// @param p_client Pointer to the client
+/// @param byte Character received
+/// @return true if it completed a line
+static bool _feed_line(jukebox_client_t *p_client, uint8_t byte)
+{
+    if (p_client->line_length == 0)
+    {
+        p_client->line[0] = '\0'; // Start of a new line: forget the previous one
+    }
+    if (p_client->line_length < sizeof(p_client->line) - 1)
+    {
+        p_client->line[p_client->line_length++] = (char)byte;
+        p_client->line[p_client->line_length] = '\0';
+    }
+    if (byte != '\n')
+    {
+        return false;
+    }
+    p_client->line_length = 0;
+    return true;
+}
+
+/* Public functions ------------------------------------------------------------*/
+void jukebox_client_init(jukebox_client_t *p_client, jukebox_client_write_cb_t write, void *p_arg)
+{
+    memset(p_client, 0, sizeof(jukebox_client_t));
+    p_client->write = write;
+    p_client->p_arg = p_arg;
+}
+
+void jukebox_client_set_binary(jukebox_client_t *p_client, bool binary)
+{
+    if (binary == p_client->binary)
+    {
+        return;
+    }
+    if (binary)
+    {
+        uint8_t magic = FRAME_MAGIC;
+        _write(p_client, &magic, 1);
+    }
+    else
+    {
+        frame_t request = {.opcode = FRAME_OP_TEXT};
+        jukebox_client_send_request(p_client, &request);
+    }
+    p_client->binary = binary;
+    p_client->rx_length = 0;
+    p_client->line_length = 0;
+}
+
+void jukebox_client_send_text(jukebox_client_t *p_client, const char *p_command)
+{
+    _write(p_client, (const uint8_t *)p_command, strlen(p_command));
+    uint8_t end = '\n';
+    _write(p_client, &end, 1);
+}
+
+uint8_t jukebox_client_send_request(jukebox_client_t *p_client, frame_t *p_request)
+{
+    uint8_t encoded[FRAME_MAX_ENCODED];
+    p_request->seq = ++p_client->seq;
+    size_t length = frame_encode(p_request, encoded);
+    _write(p_client, encoded, length);
+    return p_request->seq;
+}
+
+bool jukebox_client_feed(jukebox_client_t *p_client, uint8_t byte)
+{
+    p_client->bytes_received++;
+    return p_client->binary ? _feed_frame(p_client, byte) : _feed_line(p_client, byte);
+}
+
+const frame_t *jukebox_client_get_reply(const jukebox_client_t *p_client)
+{
+    return &p_client->reply;
+}
+
+const char *jukebox_client_get_line(const jukebox_client_t *p_client)
+{
+    return p_client->line;
+}
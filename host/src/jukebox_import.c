@@ -0,0 +1,648 @@
+/**
+ * @file jukebox_import.c
+ * @brief Melody importer: `jukebox_import [options] <file or directory>...`
+ *
+ * Converts Standard MIDI Files (`.mid`, `.midi`), RTTTL (`.rtttl`, `.rtx`, `.txt`, one melody per line) and Arduino
+ * sketches (`.ino`) into melodies for the buzzer (see `melody_import.h` for what is read of each format). The
+ * directories are searched recursively and their files are converted in parallel, one per task of a pool of threads
+ * (`sim_pool.h`); the melodies keep the order of the paths, so the output does not depend on the threads.
+ *
+ * The notes are fitted to the buzzer: each frequency becomes the one the PWM timer produces
+ * (`port_buzzer_get_note_frequency()`), in whole mHz, and the durations are rounded to whole ms from the start of the
+ * melody, so rounding does not add up along it. Notes that round to 0 ms are dropped, and silences are merged.
+ *
+ * - `-c <file>`: write the melodies as a C source file like `melodies.c`, with a `melody_t` for each one.
+ * - `-o <file>`: write the melodies as a container of compressed melodies (`melody_pack.h`).
+ * - `-j <threads>`: threads of the pool (default: one per processor).
+ *
+ * The exit status is not zero if a file cannot be converted. The other files are converted and written anyway.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* opendir, strdup and strtok_r are POSIX */
+#define _DEFAULT_SOURCE
+
+/* Includes ------------------------------------------------------------------*/
+#include <ctype.h>
+#include <dirent.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "melody_import.h"
+#include "melody_pack.h"
+#include "sim_pool.h"
+#include "port_system.h"
+#include "port_buzzer.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define IMPORT_MAX_MELODIES UINT8_MAX       /*!< Most melodies of a container */
+#define IMPORT_VALUES_PER_LINE 10           /*!< Values per line of the arrays of the C source */
+#define IMPORT_PACK_NOTE_BYTES 8            /*!< Bound of the packed bytes of a note */
+#define IMPORT_PACK_MELODY_BYTES 1024       /*!< Bound of the packed bytes of the header and palette of a melody */
+
+/* Typedefs --------------------------------------------------------------------*/
+/// @brief File to convert: a task of the pool
+typedef struct
+{
+    char *p_path;                   /*!< Path of the file */
+    melody_import_format_t format;  /*!< Format of the file */
+    melody_import_t *p_melodies;    /*!< Melodies read */
+    uint32_t num_melodies;          /*!< Melodies read */
+    const char *p_error;            /*!< Reason of the error, or NULL */
+} import_job_t;
+
+/// @brief Files to convert
+typedef struct
+{
+    import_job_t *p_jobs;           /*!< Files */
+    uint32_t num_jobs;              /*!< Files */
+    uint32_t capacity;              /*!< Files that fit in `p_jobs` */
+} import_batch_t;
+
+/// @brief Melody fitted to the buzzer
+typedef struct
+{
+    melody_t melody;                /*!< Melody, with its own arrays */
+    const char *p_path;             /*!< File it comes from */
+    uint32_t duration_ms;           /*!< Duration */
+} import_output_t;
+
+/* Private functions -----------------------------------------------------------*/
+/**
+ * @brief Add a file to the batch.
+ *
+ * @param p_batch Pointer to the batch
+ * @param p_path Path of the file
+ * @param format Format of the file
+ * @return true if added
+ */
+static bool _add_file(import_batch_t *p_batch, const char *p_path, melody_import_format_t format)
+{
+    if (p_batch->num_jobs == p_batch->capacity)
+    {
+        uint32_t capacity = p_batch->capacity ? 2 * p_batch->capacity : 16;
+        import_job_t *p_jobs = realloc(p_batch->p_jobs, capacity * sizeof(import_job_t));
+        if (!p_jobs)
+        {
+            return false;
+        }
+        p_batch->p_jobs = p_jobs;
+        p_batch->capacity = capacity;
+    }
+    import_job_t *p_job = &p_batch->p_jobs[p_batch->num_jobs];
+    *p_job = (import_job_t){.p_path = strdup(p_path), .format = format};
+    if (!p_job->p_path)
+    {
+        return false;
+    }
+    p_batch->num_jobs++;
+    return true;
+}
+
+/**
+ * @brief Add the melody files of a directory and its subdirectories to the batch.
+ *
+ * @param p_batch Pointer to the batch
+ * @param p_path Path of the directory
+ * @return true on success
+ */
+static bool _add_directory(import_batch_t *p_batch, const char *p_path)
+{
+    DIR *p_dir = opendir(p_path);
+    if (!p_dir)
+    {
+        return false;
+    }
+    bool ok = true;
+    struct dirent *p_entry;
+    while (ok && (p_entry = readdir(p_dir)))
+    {
+        if (p_entry->d_name[0] == '.')
+        {
+            continue;
+        }
+        size_t length = strlen(p_path) + strlen(p_entry->d_name) + 2;
+        char *p_child = malloc(length);
+        if (!p_child)
+        {
+            ok = false;
+            break;
+        }
+        snprintf(p_child, length, "%s/%s", p_path, p_entry->d_name);
+        struct stat info;
+        if (!stat(p_child, &info) && S_ISDIR(info.st_mode))
+        {
+            ok = _add_directory(p_batch, p_child);
+        }
+        else if (melody_import_get_format(p_child) != MELODY_IMPORT_UNKNOWN)
+        {
+            ok = _add_file(p_batch, p_child, melody_import_get_format(p_child));
+        }
+        free(p_child);
+    }
+    closedir(p_dir);
+    return ok;
+}
+
+static int _compare_jobs(const void *p_a, const void *p_b)
+{
+    return strcmp(((const import_job_t *)p_a)->p_path, ((const import_job_t *)p_b)->p_path);
+}
+
+/**
+ * @brief Read a whole file, ended by '\0'.
+ *
+ * @param p_path Path of the file
+ * @param p_size Pointer to store the bytes of the file
+ * @return Contents to be freed, or NULL
+ */
+static char *_read_file(const char *p_path, size_t *p_size)
+{
+    FILE *p_file = fopen(p_path, "rb");
+    if (!p_file)
+    {
+        return NULL;
+    }
+    char *p_data = NULL;
+    long size = (fseek(p_file, 0, SEEK_END) == 0) ? ftell(p_file) : -1;
+    if ((size >= 0) && (fseek(p_file, 0, SEEK_SET) == 0) && (p_data = malloc((size_t)size + 1)))
+    {
+        if (fread(p_data, 1, (size_t)size, p_file) != (size_t)size)
+        {
+            free(p_data);
+            p_data = NULL;
+        }
+        else
+        {
+            p_data[size] = '\0';
+            *p_size = (size_t)size;
+        }
+    }
+    fclose(p_file);
+    return p_data;
+}
+
+/**
+ * @brief Add an empty melody to the melodies of a file.
+ *
+ * @param p_job Pointer to the file
+ * @return Pointer to the melody, or NULL if out of memory
+ */
+static melody_import_t *_new_melody(import_job_t *p_job)
+{
+    melody_import_t *p_melodies = realloc(p_job->p_melodies, (p_job->num_melodies + 1) * sizeof(melody_import_t));
+    if (!p_melodies)
+    {
+        return NULL;
+    }
+    p_job->p_melodies = p_melodies;
+    melody_import_t *p_melody = &p_melodies[p_job->num_melodies++];
+    memset(p_melody, 0, sizeof(*p_melody));
+    return p_melody;
+}
+
+/**
+ * @brief Convert a file: a task of the pool.
+ *
+ * @param p_arg Pointer to the batch
+ * @param worker Index of the worker
+ * @param task Index of the file
+ */
+static void _convert(void *p_arg, uint32_t worker, uint32_t task)
+{
+    import_job_t *p_job = &((import_batch_t *)p_arg)->p_jobs[task];
+    size_t size;
+    char *p_data = _read_file(p_job->p_path, &size);
+    if (!p_data)
+    {
+        p_job->p_error = "cannot read the file";
+        return;
+    }
+    const char *p_base = strrchr(p_job->p_path, '/');
+    p_base = p_base ? p_base + 1 : p_job->p_path;
+
+    if (p_job->format == MELODY_IMPORT_RTTTL)
+    {
+        char *p_save;
+        for (char *p_line = strtok_r(p_data, "\r\n", &p_save); p_line && !p_job->p_error;
+             p_line = strtok_r(NULL, "\r\n", &p_save))
+        {
+            p_line += strspn(p_line, " \t");
+            if (!*p_line || (*p_line == '#'))
+            {
+                continue;
+            }
+            melody_import_t *p_melody = _new_melody(p_job);
+            if (!p_melody)
+            {
+                p_job->p_error = "out of memory";
+            }
+            else if (!melody_import_rtttl(p_line, p_melody, &p_job->p_error) && !p_job->p_error)
+            {
+                p_job->p_error = "wrong RTTTL";
+            }
+        }
+        if (!p_job->num_melodies && !p_job->p_error)
+        {
+            p_job->p_error = "no melodies";
+        }
+    }
+    else
+    {
+        melody_import_t *p_melody = _new_melody(p_job);
+        bool ok = false;
+        if (!p_melody)
+        {
+            p_job->p_error = "out of memory";
+        }
+        else if (p_job->format == MELODY_IMPORT_MIDI)
+        {
+            ok = melody_import_midi((const uint8_t *)p_data, size, p_melody, &p_job->p_error);
+        }
+        else
+        {
+            ok = melody_import_sketch(p_data, p_melody, &p_job->p_error);
+        }
+        if (ok)
+        {
+            p_job->p_error = NULL;
+            melody_import_set_name(p_melody, p_base);
+        }
+    }
+    free(p_data);
+}
+
+/**
+ * @brief Frequency that the buzzer plays for a desired one, in whole mHz.
+ *
+ * @param frequency Desired frequency in Hz, 0 for a silence
+ * @return Frequency of the PWM timer, 0 for a silence or a frequency that cannot be stored
+ */
+static double _timer_frequency(double frequency)
+{
+    if ((frequency <= 0) || (frequency * 1000 > MELODY_PACK_MAX_FREQUENCY_MHZ))
+    {
+        return 0;
+    }
+    port_buzzer_set_note_frequency(BUZZER_0_ID, frequency, 0);
+    double timer_frequency = port_buzzer_get_note_frequency(BUZZER_0_ID);
+    port_buzzer_stop(BUZZER_0_ID);
+    return round(timer_frequency * 1000) / 1000;
+}
+
+/**
+ * @brief Add a note to a melody fitted to the buzzer. A silence after a silence lengthens it.
+ *
+ * @param p_output Pointer to the melody
+ * @param p_capacity Pointer to the notes that fit in its arrays
+ * @param frequency Frequency
+ * @param duration_ms Duration, up to UINT16_MAX
+ * @return true if added, false if out of memory
+ */
+static bool _add_output_note(import_output_t *p_output, uint32_t *p_capacity, double frequency, uint32_t duration_ms)
+{
+    melody_t *p_melody = &p_output->melody;
+    uint32_t last = p_melody->melody_length - 1;
+    if ((frequency == 0) && p_melody->melody_length && (p_melody->p_notes[last] == 0) &&
+        (p_melody->p_durations[last] + duration_ms <= UINT16_MAX))
+    {
+        p_melody->p_durations[last] += duration_ms;
+        return true;
+    }
+    if (p_melody->melody_length == *p_capacity)
+    {
+        uint32_t capacity = *p_capacity ? 2 * *p_capacity : 64;
+        double *p_notes = realloc(p_melody->p_notes, capacity * sizeof(double));
+        p_melody->p_notes = p_notes ? p_notes : p_melody->p_notes;
+        uint16_t *p_durations = realloc(p_melody->p_durations, capacity * sizeof(uint16_t));
+        p_melody->p_durations = p_durations ? p_durations : p_melody->p_durations;
+        if (!p_notes || !p_durations)
+        {
+            return false;
+        }
+        *p_capacity = capacity;
+    }
+    p_melody->p_notes[p_melody->melody_length] = frequency;
+    p_melody->p_durations[p_melody->melody_length] = (uint16_t)duration_ms;
+    p_melody->melody_length++;
+    return true;
+}
+
+/**
+ * @brief Fit a melody to the buzzer.
+ *
+ * @param p_input Pointer to the melody read
+ * @param p_output Pointer to the melody fitted, empty
+ * @return true on success, false if out of memory or longer than `UINT16_MAX` notes
+ */
+static bool _quantize(const melody_import_t *p_input, import_output_t *p_output)
+{
+    uint32_t capacity = 0;
+    double time_ms = 0;
+    uint32_t rounded_ms = 0;
+    double last_frequency = -1;
+    double timer_frequency = 0;
+    for (uint32_t i = 0; i < p_input->num_notes; i++)
+    {
+        const melody_import_note_t *p_note = &p_input->p_notes[i];
+        // Round the end of each note from the start of the melody, not each duration
+        time_ms += p_note->duration_ms;
+        uint32_t end_ms = (uint32_t)llround(time_ms);
+        uint32_t duration_ms = end_ms - rounded_ms;
+        rounded_ms = end_ms;
+        if (p_note->frequency != last_frequency)
+        {
+            last_frequency = p_note->frequency;
+            timer_frequency = _timer_frequency(p_note->frequency);
+        }
+        while (duration_ms)
+        {
+            uint32_t part_ms = (duration_ms > UINT16_MAX) ? UINT16_MAX : duration_ms;
+            if ((p_output->melody.melody_length == UINT16_MAX) ||
+                !_add_output_note(p_output, &capacity, timer_frequency, part_ms))
+            {
+                return false;
+            }
+            duration_ms -= part_ms;
+        }
+    }
+    p_output->duration_ms = rounded_ms;
+    return p_output->melody.melody_length > 0;
+}
+
+/**
+ * @brief Make the name of a melody different from the names of the melodies before it: `name_2`, `name_3`...
+ *
+ * @param p_outputs Melodies
+ * @param index Index of the melody
+ */
+static void _unique_name(import_output_t *p_outputs, uint32_t index)
+{
+    char *p_name = p_outputs[index].melody.p_name;
+    char base[MELODY_PACK_NAME_LENGTH];
+    strcpy(base, p_name);
+    for (uint32_t suffix = 2;; suffix++)
+    {
+        bool used = false;
+        for (uint32_t m = 0; (m < index) && !used; m++)
+        {
+            used = !strcmp(p_outputs[m].melody.p_name, p_name);
+        }
+        if (!used)
+        {
+            return;
+        }
+        char number[12];
+        int digits = snprintf(number, sizeof(number), "_%u", (unsigned)suffix);
+        int length = (int)strlen(base);
+        if (length + digits > MELODY_PACK_NAME_LENGTH - 1)
+        {
+            length = MELODY_PACK_NAME_LENGTH - 1 - digits;
+        }
+        snprintf(p_name, MELODY_PACK_NAME_LENGTH, "%.*s%s", length, base, number);
+    }
+}
+
+/**
+ * @brief Write the melodies as a C source file like `melodies.c`.
+ *
+ * @param p_path Path of the file
+ * @param p_outputs Melodies
+ * @param num_outputs Number of melodies
+ * @return true if written
+ */
+static bool _write_c(const char *p_path, const import_output_t *p_outputs, uint32_t num_outputs)
+{
+    FILE *p_file = fopen(p_path, "w");
+    if (!p_file)
+    {
+        return false;
+    }
+    fprintf(p_file, "/**\n * @file %s\n * @brief Melodies imported by jukebox_import.\n *\n", strrchr(p_path, '/') ?
+            strrchr(p_path, '/') + 1 : p_path);
+    fprintf(p_file, " * Declare them in melodies.h and add them to the registry `melodies[]`:\n *\n");
+    for (uint32_t m = 0; m < num_outputs; m++)
+    {
+        const char *p_name = p_outputs[m].melody.p_name;
+        fprintf(p_file, " *     extern const melody_t %s%s_melody;\n", isdigit((unsigned char)p_name[0]) ? "_" : "",
+                p_name);
+    }
+    fprintf(p_file, " */\n\n/* Includes ------------------------------------------------------------------*/\n");
+    fprintf(p_file, "#include \"melodies.h\"\n\n/* Melodies ------------------------------------------------------------------*/\n");
+    for (uint32_t m = 0; m < num_outputs; m++)
+    {
+        const melody_t *p_melody = &p_outputs[m].melody;
+        char id[MELODY_PACK_NAME_LENGTH + 1];
+        char upper[MELODY_PACK_NAME_LENGTH + 1];
+        snprintf(id, sizeof(id), "%s%s", isdigit((unsigned char)p_melody->p_name[0]) ? "_" : "", p_melody->p_name);
+        for (size_t i = 0; i <= strlen(id); i++)
+        {
+            upper[i] = (char)toupper((unsigned char)id[i]);
+        }
+        fprintf(p_file, "// Melody %s, imported from %s\n", p_melody->p_name, p_outputs[m].p_path);
+        fprintf(p_file, "#define %s_LENGTH %u /*!< %s melody length */\n\n", upper, (unsigned)p_melody->melody_length,
+                p_melody->p_name);
+        fprintf(p_file, "/**\n * @brief %s melody notes, in Hz as the buzzer plays them.\n */\n", p_melody->p_name);
+        fprintf(p_file, "static const double %s_notes[%s_LENGTH] = {", id, upper);
+        for (uint32_t i = 0; i < p_melody->melody_length; i++)
+        {
+            fprintf(p_file, "%s%.3f%s", (i % IMPORT_VALUES_PER_LINE) ? " " : "\n    ", p_melody->p_notes[i],
+                    (i + 1 < p_melody->melody_length) ? "," : "");
+        }
+        fprintf(p_file, "};\n\n/**\n * @brief %s melody durations in miliseconds.\n */\n", p_melody->p_name);
+        fprintf(p_file, "static const uint16_t %s_durations[%s_LENGTH] = {", id, upper);
+        for (uint32_t i = 0; i < p_melody->melody_length; i++)
+        {
+            fprintf(p_file, "%s%u%s", (i % IMPORT_VALUES_PER_LINE) ? " " : "\n    ", (unsigned)p_melody->p_durations[i],
+                    (i + 1 < p_melody->melody_length) ? "," : "");
+        }
+        fprintf(p_file, "};\n\n/**\n * @brief %s melody struct.\n */\n", p_melody->p_name);
+        fprintf(p_file, "const melody_t %s_melody = {.p_name = \"%s\",\n", id, p_melody->p_name);
+        fprintf(p_file, "    .p_notes = (double *)%s_notes,\n    .p_durations = (uint16_t *)%s_durations,\n", id, id);
+        fprintf(p_file, "    .melody_length = %s_LENGTH};\n\n", upper);
+    }
+    return fclose(p_file) == 0;
+}
+
+/**
+ * @brief Write the melodies as a container of compressed melodies.
+ *
+ * @param p_path Path of the file
+ * @param p_outputs Melodies
+ * @param num_outputs Number of melodies
+ * @return Bytes of the container, 0 if it cannot be packed or written
+ */
+static size_t _write_pack(const char *p_path, const import_output_t *p_outputs, uint32_t num_outputs)
+{
+    if (num_outputs > IMPORT_MAX_MELODIES)
+    {
+        return 0;
+    }
+    const melody_t *melodies_arr[IMPORT_MAX_MELODIES];
+    size_t bound = 8;
+    for (uint32_t m = 0; m < num_outputs; m++)
+    {
+        melodies_arr[m] = &p_outputs[m].melody;
+        bound += IMPORT_PACK_MELODY_BYTES + (size_t)p_outputs[m].melody.melody_length * IMPORT_PACK_NOTE_BYTES;
+    }
+    uint8_t *p_container = malloc(bound);
+    size_t size = p_container ? melody_pack_encode(melodies_arr, num_outputs, p_container, bound) : 0;
+    FILE *p_file = size ? fopen(p_path, "wb") : NULL;
+    if (!p_file || (fwrite(p_container, 1, size, p_file) != size) || fclose(p_file))
+    {
+        size = 0;
+    }
+    free(p_container);
+    return size;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *p_source = NULL;
+    const char *p_binary = NULL;
+    uint32_t workers = sim_pool_get_cpus();
+    import_batch_t batch = {0};
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = (i + 1 < argc);
+        struct stat info;
+        if (!strcmp(argv[i], "-c") && has_value)
+        {
+            p_source = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-o") && has_value)
+        {
+            p_binary = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-j") && has_value)
+        {
+            workers = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if ((argv[i][0] != '-') && !stat(argv[i], &info) && S_ISDIR(info.st_mode))
+        {
+            if (!_add_directory(&batch, argv[i]))
+            {
+                fprintf(stderr, "%s: cannot read the directory %s\n", argv[0], argv[i]);
+                return 1;
+            }
+        }
+        else if ((argv[i][0] != '-') && (melody_import_get_format(argv[i]) != MELODY_IMPORT_UNKNOWN))
+        {
+            if (!_add_file(&batch, argv[i], melody_import_get_format(argv[i])))
+            {
+                return 1;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [-c melodies.c] [-o melodies.bin] [-j threads] <file or directory>...\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (!batch.num_jobs || !workers || (workers > SIM_POOL_MAX_WORKERS))
+    {
+        fprintf(stderr, "%s: give melody files (.mid, .midi, .rtttl, .rtx, .txt, .ino) and 1 to %u threads\n", argv[0],
+                SIM_POOL_MAX_WORKERS);
+        return 1;
+    }
+    qsort(batch.p_jobs, batch.num_jobs, sizeof(import_job_t), _compare_jobs);
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    sim_pool_run(workers, batch.num_jobs, _convert, &batch, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    // Fit the melodies to the buzzer in order: the timer of the simulated board is shared
+    port_system_init();
+    uint32_t total = 0;
+    for (uint32_t j = 0; j < batch.num_jobs; j++)
+    {
+        total += batch.p_jobs[j].num_melodies;
+    }
+    import_output_t *p_outputs = calloc(total ? total : 1, sizeof(import_output_t));
+    uint32_t num_outputs = 0;
+    uint32_t failed = 0;
+    for (uint32_t j = 0; p_outputs && (j < batch.num_jobs); j++)
+    {
+        import_job_t *p_job = &batch.p_jobs[j];
+        if (p_job->p_error)
+        {
+            fprintf(stderr, "%s: %s\n", p_job->p_path, p_job->p_error);
+            failed++;
+        }
+        for (uint32_t m = 0; !p_job->p_error && (m < p_job->num_melodies); m++)
+        {
+            import_output_t *p_output = &p_outputs[num_outputs];
+            p_output->p_path = p_job->p_path;
+            p_output->melody.p_name = malloc(MELODY_PACK_NAME_LENGTH);
+            if (!p_output->melody.p_name || !_quantize(&p_job->p_melodies[m], p_output))
+            {
+                fprintf(stderr, "%s: %s is empty or longer than %u notes\n", p_job->p_path, p_job->p_melodies[m].name,
+                        UINT16_MAX);
+                failed++;
+                free(p_output->melody.p_name);
+                free(p_output->melody.p_notes);
+                free(p_output->melody.p_durations);
+                memset(p_output, 0, sizeof(*p_output));
+                continue;
+            }
+            strcpy(p_output->melody.p_name, p_job->p_melodies[m].name);
+            _unique_name(p_outputs, num_outputs);
+            printf("%-16s %6u notes %8.2f s  %s\n", p_output->melody.p_name, (unsigned)p_output->melody.melody_length,
+                   p_output->duration_ms / 1000.0, p_job->p_path);
+            num_outputs++;
+        }
+    }
+    printf("%u files, %u melodies, %u errors, read in %.1f ms with %u threads\n", (unsigned)batch.num_jobs,
+           (unsigned)num_outputs, (unsigned)failed,
+           (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6, (unsigned)workers);
+
+    int status = (failed || !p_outputs) ? 1 : 0;
+    if (p_source && !_write_c(p_source, p_outputs, num_outputs))
+    {
+        fprintf(stderr, "%s: cannot write %s\n", argv[0], p_source);
+        status = 1;
+    }
+    if (p_binary)
+    {
+        size_t size = _write_pack(p_binary, p_outputs, num_outputs);
+        if (size)
+        {
+            printf("%s: %zu bytes\n", p_binary, size);
+        }
+        else
+        {
+            fprintf(stderr, "%s: cannot pack the melodies in %s\n", argv[0], p_binary);
+            status = 1;
+        }
+    }
+
+    for (uint32_t m = 0; m < num_outputs; m++)
+    {
+        free(p_outputs[m].melody.p_name);
+        free(p_outputs[m].melody.p_notes);
+        free(p_outputs[m].melody.p_durations);
+    }
+    free(p_outputs);
+    for (uint32_t j = 0; j < batch.num_jobs; j++)
+    {
+        for (uint32_t m = 0; m < batch.p_jobs[j].num_melodies; m++)
+        {
+            melody_import_free(&batch.p_jobs[j].p_melodies[m]);
+        }
+        free(batch.p_jobs[j].p_melodies);
+        free(batch.p_jobs[j].p_path);
+    }
+    free(batch.p_jobs);
+    return status;
+}
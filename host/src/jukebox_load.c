@@ -0,0 +1,405 @@
+/**
+ * @file jukebox_load.c
+ * @brief Load generator of the USART protocols: `jukebox_load [options]`
+ *
+ * Sends commands to a jukebox in a closed loop (the next one leaves when the reply to the previous one arrives) and
+ * prints the commands per second and the bytes on the line per command. The commands are the same in both protocols:
+ * `volume`, `info` and `next`, all of them with a reply.
+ *
+ * - `-p <device>`: serial port of the board, e.g. `/dev/ttyACM0`. The board must be on.
+ * - `-b <baud>`: baud rate of the serial port (default 9600).
+ * - `--sim`: simulated board on the virtual clock instead of a serial port. It is turned on before the test.
+ * - `-m text|binary|compare`: protocol, or both one after the other (default `compare`).
+ * - `-n <commands>`: commands per protocol (default 200).
+ * - `--baud <rate>`: change the baud rate of the jukebox with the `baud` command before the test. The port follows it
+ *   after the acknowledgement, and the new rate is confirmed with a second `baud`.
+ *
+ * The exit status is not zero if a reply is missing or wrong.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* fdopen, dup, usleep and clock_gettime are POSIX */
+#define _DEFAULT_SOURCE
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "jukebox_client.h"
+#include "jukebox_serial.h"
+#include "sim_jukebox.h"
+#include "port_system.h"
+#include "port_usart.h"
+#include "port_button.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define LOAD_DEFAULT_BAUD 9600          /*!< Default baud rate of the serial port */
+#define LOAD_DEFAULT_COMMANDS 200       /*!< Default commands per protocol */
+#define LOAD_TIMEOUT_MS 1000            /*!< Longest wait for a reply */
+#define LOAD_SETTLE_MS 50               /*!< Wait for the jukebox to change its protocol */
+#define LOAD_BAUD_SETTLE_MS 10          /*!< Wait for the jukebox to change its baud rate */
+#define LOAD_POWER_ON_PRESS_MS 1200     /*!< Press that turns the simulated jukebox on */
+#define LOAD_POWER_ON_WAIT_MS 4000      /*!< End of the start-up melody */
+
+/* Typedefs --------------------------------------------------------------------*/
+/// @brief Command of the load, in both protocols
+typedef struct
+{
+    const char *p_text;     /*!< Text command */
+    const char *p_reply;    /*!< Start of its text reply */
+    uint8_t opcode;         /*!< Opcode of the request */
+    int16_t param;          /*!< Byte of payload, or -1 for none */
+} load_command_t;
+
+/// @brief Jukebox under test
+typedef struct
+{
+    jukebox_client_t client;    /*!< Client */
+    bool sim;                   /*!< Simulated board */
+    sim_jukebox_t board;        /*!< Simulated board */
+    int fd;                     /*!< Serial port */
+    bool reply;                 /*!< A reply was completed since the last request */
+} load_target_t;
+
+/// @brief Outcome of the load in a protocol
+typedef struct
+{
+    uint32_t commands;  /*!< Commands sent */
+    uint32_t errors;    /*!< Replies missing or wrong */
+    double elapsed_s;   /*!< Time of the test */
+    uint64_t sent;      /*!< Bytes sent */
+    uint64_t received;  /*!< Bytes received */
+} load_result_t;
+
+/* Private variables -----------------------------------------------------------*/
+/// @brief Commands sent in a loop
+static const load_command_t commands[] = {
+    {"volume 0.4", "Current volume: 40%", FRAME_OP_VOLUME, 40},
+    {"info", "Playing: ", FRAME_OP_INFO, -1},
+    {"next", "Now playing: ", FRAME_OP_NEXT, -1},
+    {"volume 0.7", "Current volume: 70%", FRAME_OP_VOLUME, 70},
+};
+
+static FILE *p_report; /*!< Standard output of the process, before the firmware output was discarded */
+
+/* Private functions -----------------------------------------------------------*/
+/// @brief Transport of the simulated board: the bytes arrive on the RX line of the USART
+static void _sim_write(void *p_arg, const uint8_t *p_data, size_t length)
+{
+    port_sim_usart_inject(USART_0, p_data, length, port_sim_get_cycles());
+    ((load_target_t *)p_arg)->board.halted = false; // The bytes will wake the CPU up
+}
+
+/// @brief Capture the bytes transmitted by the simulated board
+static void _sim_on_tx(void *p_arg, USART_TypeDef *p_usart, uint8_t byte, uint64_t cycles)
+{
+    load_target_t *p_target = (load_target_t *)p_arg;
+    if ((p_usart == USART_0) && jukebox_client_feed(&p_target->client, byte))
+    {
+        p_target->reply = true;
+    }
+}
+
+/// @brief Time of the test: virtual for the simulated board
+/// @param p_target Pointer to the jukebox
+/// @return Seconds
+static double _now(const load_target_t *p_target)
+{
+    if (p_target->sim)
+    {
+        return (double)port_sim_get_cycles() / PORT_SIM_CORE_CLOCK_HZ;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/// @brief Wait for the next reply
+/// @param p_target Pointer to the jukebox
+/// @param timeout_ms Longest wait
+/// @return true if a reply arrived
+static bool _wait_reply(load_target_t *p_target, uint32_t timeout_ms)
+{
+    if (p_target->sim)
+    {
+        uint64_t limit = port_sim_get_cycles() + PORT_SIM_MS_TO_CYCLES(timeout_ms);
+        while (!p_target->reply && !p_target->board.halted && (port_sim_get_cycles() < limit))
+        {
+            sim_jukebox_step(&p_target->board, limit);
+        }
+    }
+    else
+    {
+        double limit = _now(p_target) + timeout_ms / 1000.0;
+        while (!p_target->reply && (_now(p_target) < limit))
+        {
+            uint8_t data[64];
+            int length = jukebox_serial_read(p_target->fd, data, sizeof(data), timeout_ms);
+            for (int i = 0; i < length; i++)
+            {
+                p_target->reply |= jukebox_client_feed(&p_target->client, data[i]);
+            }
+        }
+    }
+    bool reply = p_target->reply;
+    p_target->reply = false;
+    return reply;
+}
+
+/// @brief Let the jukebox run for a while, ignoring its output
+/// @param p_target Pointer to the jukebox
+/// @param ms Time
+static void _settle(load_target_t *p_target, uint32_t ms)
+{
+    if (p_target->sim)
+    {
+        sim_jukebox_run_until(&p_target->board, port_sim_get_cycles() + PORT_SIM_MS_TO_CYCLES(ms));
+    }
+    else
+    {
+        usleep(ms * 1000U);
+    }
+    p_target->reply = false;
+}
+
+/// @brief Event: release the user button of the simulated board
+static void _on_release(void *p_arg, uint32_t data)
+{
+    port_sim_gpio_set_input(BUTTON_0_GPIO, BUTTON_0_PIN, HIGH);
+}
+
+/// @brief Send a command and check its reply
+/// @param p_target Pointer to the jukebox
+/// @param p_command Pointer to the command
+/// @return true if the right reply arrived
+static bool _send_command(load_target_t *p_target, const load_command_t *p_command)
+{
+    if (!p_target->client.binary)
+    {
+        jukebox_client_send_text(&p_target->client, p_command->p_text);
+        return _wait_reply(p_target, LOAD_TIMEOUT_MS) &&
+               !strncmp(jukebox_client_get_line(&p_target->client), p_command->p_reply, strlen(p_command->p_reply));
+    }
+    frame_t request = {.opcode = p_command->opcode};
+    if (p_command->param >= 0)
+    {
+        frame_put_u8(&request, (uint8_t)p_command->param);
+    }
+    uint8_t seq = jukebox_client_send_request(&p_target->client, &request);
+    if (!_wait_reply(p_target, LOAD_TIMEOUT_MS))
+    {
+        return false;
+    }
+    const frame_t *p_reply = jukebox_client_get_reply(&p_target->client);
+    return (p_reply->seq == seq) && (p_reply->opcode == (p_command->opcode | FRAME_REPLY)) &&
+           (p_reply->length > 0) && (p_reply->payload[0] == FRAME_STATUS_OK);
+}
+
+/// @brief Negotiate a new baud rate: request, switch after the acknowledgement and confirm at the new rate
+/// @param p_target Pointer to the jukebox
+/// @param baud Baud rate
+/// @return true if the jukebox confirmed the rate
+static bool _set_baud_rate(load_target_t *p_target, uint32_t baud)
+{
+    char command[32];
+    char reply[48];
+    snprintf(command, sizeof(command), "baud %u", (unsigned)baud);
+    snprintf(reply, sizeof(reply), "Baud rate: %u, send baud to confirm", (unsigned)baud);
+    jukebox_client_send_text(&p_target->client, command);
+    if (!_wait_reply(p_target, LOAD_TIMEOUT_MS) || strncmp(jukebox_client_get_line(&p_target->client), reply, strlen(reply)))
+    {
+        return false;
+    }
+
+    /* The simulated line follows the BRR of the board by itself */
+    if (!p_target->sim && jukebox_serial_set_baud(p_target->fd, baud))
+    {
+        return false;
+    }
+    _settle(p_target, LOAD_BAUD_SETTLE_MS);
+
+    snprintf(reply, sizeof(reply), "Baud rate: %u\n", (unsigned)baud);
+    jukebox_client_send_text(&p_target->client, "baud");
+    return _wait_reply(p_target, LOAD_TIMEOUT_MS) && !strcmp(jukebox_client_get_line(&p_target->client), reply);
+}
+
+/// @brief Run the load in a protocol
+/// @param p_target Pointer to the jukebox
+/// @param binary Binary protocol
+/// @param count Commands to send
+/// @param p_result Pointer to the outcome
+static void _run(load_target_t *p_target, bool binary, uint32_t count, load_result_t *p_result)
+{
+    memset(p_result, 0, sizeof(load_result_t));
+    jukebox_client_set_binary(&p_target->client, binary);
+    _settle(p_target, LOAD_SETTLE_MS);
+
+    uint64_t sent = p_target->client.bytes_sent;
+    uint64_t received = p_target->client.bytes_received;
+    double start = _now(p_target);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (!_send_command(p_target, &commands[i % (sizeof(commands) / sizeof(commands[0]))]))
+        {
+            p_result->errors++;
+        }
+        p_result->commands++;
+    }
+    p_result->elapsed_s = _now(p_target) - start;
+    p_result->sent = p_target->client.bytes_sent - sent;
+    p_result->received = p_target->client.bytes_received - received;
+
+    jukebox_client_set_binary(&p_target->client, false);
+    _settle(p_target, LOAD_SETTLE_MS);
+}
+
+/// @brief Print the outcome of the load in a protocol
+/// @param p_name Protocol
+/// @param p_result Pointer to the outcome
+/// @return Commands per second
+static double _print_result(const char *p_name, const load_result_t *p_result)
+{
+    double rate = p_result->elapsed_s > 0 ? p_result->commands / p_result->elapsed_s : 0;
+    double bytes = (double)(p_result->sent + p_result->received);
+    fprintf(p_report, "%-7s %5u commands in %8.3f s: %8.1f commands/s, %5.1f bytes/command (%.1f sent, %.1f received), %.0f bytes/s, %u errors\n",
+            p_name, (unsigned)p_result->commands, p_result->elapsed_s, rate, bytes / p_result->commands,
+            (double)p_result->sent / p_result->commands, (double)p_result->received / p_result->commands,
+            p_result->elapsed_s > 0 ? bytes / p_result->elapsed_s : 0, (unsigned)p_result->errors);
+    return rate;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *p_device = NULL;
+    uint32_t baud = LOAD_DEFAULT_BAUD;
+    uint32_t count = LOAD_DEFAULT_COMMANDS;
+    uint32_t jukebox_baud = 0;
+    bool sim = false;
+    bool text = true;
+    bool binary = true;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = (i + 1 < argc);
+        if (!strcmp(argv[i], "-p") && has_value)
+        {
+            p_device = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-b") && has_value)
+        {
+            baud = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-n") && has_value)
+        {
+            count = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-m") && has_value)
+        {
+            i++;
+            text = strcmp(argv[i], "binary");
+            binary = strcmp(argv[i], "text");
+        }
+        else if (!strcmp(argv[i], "--baud") && has_value)
+        {
+            jukebox_baud = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "--sim"))
+        {
+            sim = true;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s (-p device [-b baud] | --sim) [-m text|binary|compare] [-n commands] [--baud rate]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((sim == (p_device != NULL)) || !count)
+    {
+        fprintf(stderr, "%s: select either a serial port or the simulated board, and at least one command\n", argv[0]);
+        return 1;
+    }
+
+    static load_target_t target;
+    target.sim = sim;
+    p_report = stdout;
+    if (sim)
+    {
+        /* Keep the report, discard the messages of the firmware */
+        fflush(stdout);
+        int report_fd = dup(STDOUT_FILENO);
+        p_report = (report_fd >= 0) ? fdopen(report_fd, "w") : NULL;
+        if (!p_report || !freopen("/dev/null", "w", stdout))
+        {
+            fprintf(stderr, "%s: cannot redirect the standard output\n", argv[0]);
+            return 1;
+        }
+        jukebox_client_init(&target.client, _sim_write, &target);
+        port_sim_reset();
+        port_sim_usart_set_tx_hook(_sim_on_tx, &target);
+        sim_jukebox_init(&target.board);
+
+        /* Turn it on and wait for the start-up melody */
+        port_sim_gpio_set_input(BUTTON_0_GPIO, BUTTON_0_PIN, LOW);
+        port_sim_schedule(port_sim_get_cycles() + PORT_SIM_MS_TO_CYCLES(LOAD_POWER_ON_PRESS_MS), _on_release, NULL, 0);
+        _settle(&target, LOAD_POWER_ON_WAIT_MS);
+    }
+    else
+    {
+        target.fd = jukebox_serial_open(p_device, baud);
+        if (target.fd < 0)
+        {
+            fprintf(stderr, "%s: cannot open %s at %u baud\n", argv[0], p_device, (unsigned)baud);
+            return 1;
+        }
+        jukebox_client_init(&target.client, jukebox_serial_write, &target.fd);
+    }
+
+    if (jukebox_baud)
+    {
+        if (!_set_baud_rate(&target, jukebox_baud))
+        {
+            fprintf(stderr, "%s: the jukebox did not change to %u baud\n", argv[0], (unsigned)jukebox_baud);
+            return 1;
+        }
+        fprintf(p_report, "baud rate: %u\n", (unsigned)jukebox_baud);
+    }
+
+    load_result_t result;
+    uint32_t errors = 0;
+    double text_rate = 0;
+    double binary_rate = 0;
+    if (text)
+    {
+        _run(&target, false, count, &result);
+        text_rate = _print_result("text", &result);
+        errors += result.errors;
+    }
+    if (binary)
+    {
+        _run(&target, true, count, &result);
+        binary_rate = _print_result("binary", &result);
+        errors += result.errors;
+    }
+    if (text && binary && (text_rate > 0))
+    {
+        fprintf(p_report, "binary/text: %.2fx commands/s\n", binary_rate / text_rate);
+    }
+
+    if (sim)
+    {
+        sim_jukebox_destroy(&target.board);
+        port_sim_usart_set_tx_hook(NULL, NULL);
+    }
+    else
+    {
+        jukebox_serial_close(target.fd);
+    }
+    fflush(p_report);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file jukebox_loopback.c
+ * @brief Throughput of a serial port with its TX and RX lines joined: `jukebox_loopback -p <device> [options]`
+ *
+ * Writes a pattern, reads it back and checks it, and prints the effective bytes per second next to the limit of the
+ * baud rate (10 bits per byte). It measures the adapter and the cable before the baud rate of the jukebox is raised.
+ *
+ * - `-p <device>`: serial port, e.g. `/dev/ttyUSB0`, with a jumper between TX and RX.
+ * - `-b <baud>`: baud rate (default 115200).
+ * - `-n <bytes>`: bytes to send (default 65536).
+ *
+ * The exit status is not zero if a byte is lost or wrong.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* clock_gettime is POSIX */
+#define _DEFAULT_SOURCE
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "jukebox_serial.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define LOOPBACK_DEFAULT_BAUD 115200    /*!< Default baud rate */
+#define LOOPBACK_DEFAULT_BYTES 65536    /*!< Default bytes to send */
+#define LOOPBACK_CHUNK 256              /*!< Bytes written before reading them back */
+#define LOOPBACK_TIMEOUT_MS 500         /*!< Longest wait for a byte */
+
+/* Private functions -----------------------------------------------------------*/
+/// @brief Monotonic time
+/// @return Seconds
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *p_device = NULL;
+    uint32_t baud = LOOPBACK_DEFAULT_BAUD;
+    uint32_t count = LOOPBACK_DEFAULT_BYTES;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = (i + 1 < argc);
+        if (!strcmp(argv[i], "-p") && has_value)
+        {
+            p_device = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-b") && has_value)
+        {
+            baud = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-n") && has_value)
+        {
+            count = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s -p device [-b baud] [-n bytes]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (!p_device || !count)
+    {
+        fprintf(stderr, "%s: select a serial port and at least one byte\n", argv[0]);
+        return 1;
+    }
+
+    int fd = jukebox_serial_open(p_device, baud);
+    if (fd < 0)
+    {
+        fprintf(stderr, "%s: cannot open %s at %u baud\n", argv[0], p_device, (unsigned)baud);
+        return 1;
+    }
+
+    /* Chunks keep the bytes in flight below the buffers of the adapter */
+    uint32_t received = 0;
+    uint32_t errors = 0;
+    double start = _now();
+    while (received < count)
+    {
+        uint8_t tx[LOOPBACK_CHUNK];
+        uint32_t length = (count - received < LOOPBACK_CHUNK) ? count - received : LOOPBACK_CHUNK;
+        for (uint32_t i = 0; i < length; i++)
+        {
+            tx[i] = (uint8_t)((received + i) * 31U + 7U);
+        }
+        jukebox_serial_write(&fd, tx, length);
+
+        uint32_t got = 0;
+        while (got < length)
+        {
+            uint8_t rx[LOOPBACK_CHUNK];
+            int n = jukebox_serial_read(fd, rx, length - got, LOOPBACK_TIMEOUT_MS);
+            if (n <= 0)
+            {
+                break;
+            }
+            for (int i = 0; i < n; i++)
+            {
+                errors += (rx[i] != tx[got + (uint32_t)i]);
+            }
+            got += (uint32_t)n;
+        }
+        received += length;
+        if (got < length)
+        {
+            errors += length - got;
+            fprintf(stderr, "%s: %u bytes lost, is TX joined to RX?\n", argv[0], (unsigned)(length - got));
+            break;
+        }
+    }
+    double elapsed = _now() - start;
+    jukebox_serial_close(fd);
+
+    double rate = elapsed > 0 ? received / elapsed : 0;
+    printf("%u bytes in %.3f s at %u baud: %.0f bytes/s (%.1f%% of %u bytes/s), %u errors\n",
+           (unsigned)received, elapsed, (unsigned)baud, rate, 100.0 * rate / (baud / 10.0), (unsigned)(baud / 10),
+           (unsigned)errors);
+    return errors ? 1 : 0;
+}
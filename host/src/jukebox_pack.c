@@ -0,0 +1,172 @@
+/**
+ * @file jukebox_pack.c
+ * @brief Melody packer: `jukebox_pack [options]`
+ *
+ * Packs the built-in melodies (see `melody_registry.h`) in a container of compressed melodies (see `melody_pack.h`),
+ * decodes it again note by note as the buzzer does and prints, for each melody, its bytes as arrays (a `double` and
+ * a `uint16_t` per note), its packed bytes and the compression ratio.
+ *
+ * - `-o <file>`: write the container as a binary file, e.g. for the external storage.
+ * - `-c <file>`: write the container as a C source file with the array `melody_pack_container`.
+ *
+ * The exit status is not zero if a melody cannot be packed or does not decode to the same notes.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "melody_registry.h"
+#include "melody_pack.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define PACK_MAX_BYTES 65536                /*!< Largest container */
+#define PACK_C_BYTES_PER_LINE 16            /*!< Bytes per line of the C array */
+
+/* Global variables ------------------------------------------------------------*/
+static uint8_t container[PACK_MAX_BYTES];   /*!< Container of the melodies */
+
+/* Private functions -----------------------------------------------------------*/
+/**
+ * @brief Bytes of a melody as arrays of notes and durations.
+ *
+ * @param p_melody Pointer to the melody
+ * @return Bytes
+ */
+static size_t _raw_bytes(const melody_t *p_melody)
+{
+    return (size_t)p_melody->melody_length * (sizeof(p_melody->p_notes[0]) + sizeof(p_melody->p_durations[0]));
+}
+
+/**
+ * @brief Decode a melody of the container and compare it with the original one.
+ *
+ * @param p_melody Pointer to the original melody
+ * @param size Bytes of the container
+ * @param index Index of the melody in the container
+ * @return true if every note is the same
+ */
+static bool _check(const melody_t *p_melody, size_t size, uint32_t index)
+{
+    static melody_pack_t pack;
+    if (!melody_pack_open(&pack, container, size, index) ||
+        strcmp(melody_pack_get_melody(&pack)->p_name, p_melody->p_name) ||
+        (melody_pack_get_melody(&pack)->melody_length != p_melody->melody_length))
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < p_melody->melody_length; i++)
+    {
+        double frequency;
+        uint32_t duration;
+        if (!melody_pack_get_note(&pack, i, &frequency, &duration) || (frequency != p_melody->p_notes[i]) ||
+            (duration != p_melody->p_durations[i]))
+        {
+            fprintf(stderr, "%s: note %u does not match\n", p_melody->p_name, (unsigned)i);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Write the container as a C source file.
+ *
+ * @param p_path Path of the file
+ * @param size Bytes of the container
+ * @return true if written
+ */
+static bool _write_c(const char *p_path, size_t size)
+{
+    FILE *p_file = fopen(p_path, "w");
+    if (!p_file)
+    {
+        return false;
+    }
+    fprintf(p_file, "/* Compressed melodies, written by jukebox_pack (see melody_pack.h) */\n");
+    fprintf(p_file, "#include <stdint.h>\n#include <stddef.h>\n\n");
+    fprintf(p_file, "const uint8_t melody_pack_container[%zu] = {", size);
+    for (size_t i = 0; i < size; i++)
+    {
+        fprintf(p_file, "%s0x%02X,", (i % PACK_C_BYTES_PER_LINE) ? " " : "\n    ", container[i]);
+    }
+    fprintf(p_file, "\n};\n\nconst size_t melody_pack_container_size = %zu;\n", size);
+    return fclose(p_file) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *p_binary = NULL;
+    const char *p_source = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = (i + 1 < argc);
+        if (!strcmp(argv[i], "-o") && has_value)
+        {
+            p_binary = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-c") && has_value)
+        {
+            p_source = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [-o container.bin] [-c container.c]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const melody_t *melodies[MELODIES_LENGTH];
+    for (uint32_t m = 0; m < MELODIES_LENGTH; m++)
+    {
+        melodies[m] = melody_registry_get(m);
+    }
+    size_t size = melody_pack_encode(melodies, MELODIES_LENGTH, container, sizeof(container));
+    if (size == 0)
+    {
+        fprintf(stderr, "%s: the melodies cannot be packed\n", argv[0]);
+        return 1;
+    }
+
+    size_t total_raw = 0;
+    size_t position = 5;    // After the magic and the number of melodies
+    printf("%-16s %6s %8s %8s %7s %9s\n", "melody", "notes", "raw", "packed", "ratio", "bits/note");
+    for (uint32_t m = 0; m < MELODIES_LENGTH; m++)
+    {
+        if (!_check(melodies[m], size, m))
+        {
+            fprintf(stderr, "%s: %s does not decode to the same notes\n", argv[0], melodies[m]->p_name);
+            return 1;
+        }
+        // Each melody starts with its size, without the two bytes of the size
+        size_t packed = 2 + (size_t)(container[position] | (container[position + 1] << 8));
+        position += packed;
+        size_t raw = _raw_bytes(melodies[m]);
+        printf("%-16s %6u %8zu %8zu %6.2fx %9.2f\n", melodies[m]->p_name, (unsigned)melodies[m]->melody_length, raw,
+               packed, (double)raw / packed, 8.0 * packed / melodies[m]->melody_length);
+        total_raw += raw;
+    }
+    printf("%-16s %6s %8zu %8zu %6.2fx\n", "total", "", total_raw, size, (double)total_raw / size);
+
+    if (p_binary)
+    {
+        FILE *p_file = fopen(p_binary, "wb");
+        if (!p_file || (fwrite(container, 1, size, p_file) != size) || fclose(p_file))
+        {
+            fprintf(stderr, "%s: cannot write %s\n", argv[0], p_binary);
+            return 1;
+        }
+    }
+    if (p_source && !_write_c(p_source, size))
+    {
+        fprintf(stderr, "%s: cannot write %s\n", argv[0], p_source);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file jukebox_serial.c
+ * @brief Serial port transport of the jukebox client.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* cfmakeraw and the baud rates above 38400 are not in POSIX */
+#define _DEFAULT_SOURCE
+
+/* Includes ------------------------------------------------------------------*/
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "jukebox_serial.h"
+
+/* Private functions -----------------------------------------------------------*/
+/// @brief Translate a baud rate to its `termios` constant
+/// @param baud Baud rate
+/// @return Constant, or B0 if the rate is not supported
+static speed_t _get_speed(uint32_t baud)
+{
+    switch (baud)
+    {
+    case 9600:
+        return B9600;
+    case 19200:
+        return B19200;
+    case 38400:
+        return B38400;
+    case 57600:
+        return B57600;
+    case 115200:
+        return B115200;
+    case 230400:
+        return B230400;
+#ifdef B460800
+    case 460800:
+        return B460800;
+#endif
+#ifdef B500000
+    case 500000:
+        return B500000;
+#endif
+#ifdef B1000000
+    case 1000000:
+        return B1000000;
+#endif
+    default:
+        return B0;
+    }
+}
+
+/* Public functions ------------------------------------------------------------*/
+int jukebox_serial_open(const char *p_path, uint32_t baud)
+{
+    speed_t speed = _get_speed(baud);
+    if (speed == B0)
+    {
+        return -1;
+    }
+    int fd = open(p_path, O_RDWR | O_NOCTTY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    struct termios tty;
+    if (tcgetattr(fd, &tty))
+    {
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tty);
+    tty.c_cflag |= CLOCAL | CREAD;
+    tty.c_cflag &= ~(CSTOPB | CRTSCTS);
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 0;
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+    if (tcsetattr(fd, TCSANOW, &tty))
+    {
+        close(fd);
+        return -1;
+    }
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+int jukebox_serial_set_baud(int fd, uint32_t baud)
+{
+    speed_t speed = _get_speed(baud);
+    struct termios tty;
+    if ((speed == B0) || tcgetattr(fd, &tty))
+    {
+        return -1;
+    }
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+    /* The bytes already written leave at the old rate */
+    return tcsetattr(fd, TCSADRAIN, &tty) ? -1 : 0;
+}
+
+void jukebox_serial_write(void *p_arg, const uint8_t *p_data, size_t length)
+{
+    int fd = *(int *)p_arg;
+    while (length > 0)
+    {
+        ssize_t written = write(fd, p_data, length);
+        if (written <= 0)
+        {
+            return;
+        }
+        p_data += written;
+        length -= (size_t)written;
+    }
+}
+
+int jukebox_serial_read(int fd, uint8_t *p_data, size_t length, uint32_t timeout_ms)
+{
+    struct pollfd pfd = {.fd = fd, .events = POLLIN};
+    int ready = poll(&pfd, 1, (int)timeout_ms);
+    if (ready <= 0)
+    {
+        return ready;
+    }
+    return (int)read(fd, p_data, length);
+}
+
+void jukebox_serial_close(int fd)
+{
+    close(fd);
+}
@@ -0,0 +1,316 @@
+/**
+ * @file jukebox_telemetry.c
+ * @brief Telemetry recorder: `jukebox_telemetry [options]`
+ *
+ * Starts the telemetry of a jukebox in a binary session (`FRAME_OP_TELEMETRY`), decodes its records (see
+ * `telemetry.h`) and writes them as CSV, one row per record, ready to be plotted. At the end it stops the telemetry,
+ * returns to a text session and prints the records received, the records lost and the bytes per record on the line.
+ *
+ * - `-p <device>`: serial port of the board, e.g. `/dev/ttyACM0`. The board must be on.
+ * - `-b <baud>`: baud rate of the serial port (default 9600).
+ * - `--sim`: simulated board on the virtual clock instead of a serial port. It is turned on before the recording.
+ * - `-t <ms>`: period of the records (default 100).
+ * - `-d <seconds>`: length of the recording (default 5).
+ * - `-o <file>`: CSV file. Without it the records are only counted.
+ *
+ * The exit status is not zero if the jukebox rejects the period, no record arrives or a record is lost.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* fdopen, dup, usleep and clock_gettime are POSIX */
+#define _DEFAULT_SOURCE
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "jukebox_client.h"
+#include "jukebox_serial.h"
+#include "telemetry.h"
+#include "sim_jukebox.h"
+#include "port_system.h"
+#include "port_usart.h"
+#include "port_button.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define TELEMETRY_DEFAULT_BAUD 9600         /*!< Default baud rate of the serial port */
+#define TELEMETRY_DEFAULT_PERIOD_MS 100     /*!< Default period of the records */
+#define TELEMETRY_DEFAULT_DURATION_S 5      /*!< Default length of the recording */
+#define TELEMETRY_TIMEOUT_MS 1000           /*!< Longest wait for a reply */
+#define TELEMETRY_SETTLE_MS 50              /*!< Wait for the jukebox to change its protocol */
+#define TELEMETRY_POWER_ON_PRESS_MS 1200    /*!< Press that turns the simulated jukebox on */
+#define TELEMETRY_POWER_ON_WAIT_MS 4000     /*!< End of the start-up melody */
+
+/* Typedefs --------------------------------------------------------------------*/
+/// @brief Jukebox being recorded
+typedef struct
+{
+    jukebox_client_t client;        /*!< Client */
+    bool sim;                       /*!< Simulated board */
+    sim_jukebox_t board;            /*!< Simulated board */
+    int fd;                         /*!< Serial port */
+    bool reply;                     /*!< A reply was completed since the last request */
+    telemetry_decoder_t decoder;    /*!< Decoder of the records */
+    uint64_t record_bytes;          /*!< Bytes of the records on the line, delimiters included */
+    double start_s;                 /*!< Time of the request of the telemetry */
+    FILE *p_csv;                    /*!< CSV file, or NULL */
+} telemetry_target_t;
+
+/* Private variables -----------------------------------------------------------*/
+static FILE *p_report; /*!< Standard output of the process, before the firmware output was discarded */
+
+/* Private functions -----------------------------------------------------------*/
+/// @brief Time of the recording: virtual for the simulated board
+/// @param p_target Pointer to the jukebox
+/// @return Seconds
+static double _now(const telemetry_target_t *p_target)
+{
+    if (p_target->sim)
+    {
+        return (double)port_sim_get_cycles() / PORT_SIM_CORE_CLOCK_HZ;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/// @brief Process a frame received: decode a record, or take note of a reply
+/// @param p_target Pointer to the jukebox
+static void _on_frame(telemetry_target_t *p_target)
+{
+    const frame_t *p_frame = jukebox_client_get_reply(&p_target->client);
+    if (p_frame->opcode != FRAME_OP_RECORD)
+    {
+        p_target->reply = true;
+        return;
+    }
+    uint8_t encoded[FRAME_MAX_ENCODED];
+    p_target->record_bytes += frame_encode(p_frame, encoded);
+    if (!telemetry_decode(&p_target->decoder, p_frame) || !p_target->p_csv)
+    {
+        return;
+    }
+    const uint16_t *p_fields = p_target->decoder.record.fields;
+    uint16_t states = p_fields[TELEMETRY_STATES];
+    fprintf(p_target->p_csv, "%.3f,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n", _now(p_target) - p_target->start_s,
+            (unsigned)p_frame->seq, states & 0xFU, (states >> 4) & 0xFU, (states >> 8) & 0xFU, (states >> 12) & 0xFU,
+            p_fields[TELEMETRY_MELODY], p_fields[TELEMETRY_NOTE], p_fields[TELEMETRY_VOLUME], p_fields[TELEMETRY_SPEED],
+            p_fields[TELEMETRY_RX_OVERFLOWS], p_fields[TELEMETRY_TX_OVERFLOWS], p_fields[TELEMETRY_LOOPS]);
+}
+
+/// @brief Transport of the simulated board: the bytes arrive on the RX line of the USART
+static void _sim_write(void *p_arg, const uint8_t *p_data, size_t length)
+{
+    port_sim_usart_inject(USART_0, p_data, length, port_sim_get_cycles());
+    ((telemetry_target_t *)p_arg)->board.halted = false; // The bytes will wake the CPU up
+}
+
+/// @brief Capture the bytes transmitted by the simulated board
+static void _sim_on_tx(void *p_arg, USART_TypeDef *p_usart, uint8_t byte, uint64_t cycles)
+{
+    telemetry_target_t *p_target = (telemetry_target_t *)p_arg;
+    if ((p_usart == USART_0) && jukebox_client_feed(&p_target->client, byte))
+    {
+        _on_frame(p_target);
+    }
+}
+
+/// @brief Receive until a reply arrives or the time is over. Records are decoded as they arrive.
+/// @param p_target Pointer to the jukebox
+/// @param ms Longest wait
+/// @param until_reply Stop at the first reply
+/// @return true if a reply arrived
+static bool _receive(telemetry_target_t *p_target, uint32_t ms, bool until_reply)
+{
+    if (p_target->sim)
+    {
+        uint64_t limit = port_sim_get_cycles() + PORT_SIM_MS_TO_CYCLES(ms);
+        while (!(until_reply && p_target->reply) && !p_target->board.halted && (port_sim_get_cycles() < limit))
+        {
+            sim_jukebox_step(&p_target->board, limit);
+        }
+    }
+    else
+    {
+        double limit = _now(p_target) + ms / 1000.0;
+        while (!(until_reply && p_target->reply) && (_now(p_target) < limit))
+        {
+            uint8_t data[64];
+            int length = jukebox_serial_read(p_target->fd, data, sizeof(data), ms);
+            for (int i = 0; i < length; i++)
+            {
+                if (jukebox_client_feed(&p_target->client, data[i]))
+                {
+                    _on_frame(p_target);
+                }
+            }
+        }
+    }
+    bool reply = p_target->reply;
+    p_target->reply = false;
+    return reply;
+}
+
+/// @brief Start or stop the telemetry
+/// @param p_target Pointer to the jukebox
+/// @param period_ms Period of the records, 0 to stop
+/// @return true if the jukebox accepted the request
+static bool _request_telemetry(telemetry_target_t *p_target, uint16_t period_ms)
+{
+    frame_t request = {.opcode = FRAME_OP_TELEMETRY};
+    frame_put_u16(&request, period_ms);
+    uint8_t seq = jukebox_client_send_request(&p_target->client, &request);
+    if (!_receive(p_target, TELEMETRY_TIMEOUT_MS, true))
+    {
+        return false;
+    }
+    const frame_t *p_reply = jukebox_client_get_reply(&p_target->client);
+    return (p_reply->seq == seq) && (p_reply->opcode == (FRAME_OP_TELEMETRY | FRAME_REPLY)) &&
+           (p_reply->length > 0) && (p_reply->payload[0] == FRAME_STATUS_OK);
+}
+
+/// @brief Event: release the user button of the simulated board
+static void _on_release(void *p_arg, uint32_t data)
+{
+    port_sim_gpio_set_input(BUTTON_0_GPIO, BUTTON_0_PIN, HIGH);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *p_device = NULL;
+    const char *p_csv = NULL;
+    uint32_t baud = TELEMETRY_DEFAULT_BAUD;
+    uint32_t period_ms = TELEMETRY_DEFAULT_PERIOD_MS;
+    uint32_t duration_s = TELEMETRY_DEFAULT_DURATION_S;
+    bool sim = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = (i + 1 < argc);
+        if (!strcmp(argv[i], "-p") && has_value)
+        {
+            p_device = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-b") && has_value)
+        {
+            baud = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-t") && has_value)
+        {
+            period_ms = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-d") && has_value)
+        {
+            duration_s = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-o") && has_value)
+        {
+            p_csv = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--sim"))
+        {
+            sim = true;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s (-p device [-b baud] | --sim) [-t period_ms] [-d seconds] [-o file.csv]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((sim == (p_device != NULL)) || !duration_s || (period_ms < TELEMETRY_MIN_PERIOD_MS) || (period_ms > TELEMETRY_MAX_PERIOD_MS))
+    {
+        fprintf(stderr, "%s: select either a serial port or the simulated board, a period from %u to %u ms and a duration\n",
+                argv[0], TELEMETRY_MIN_PERIOD_MS, TELEMETRY_MAX_PERIOD_MS);
+        return 1;
+    }
+
+    static telemetry_target_t target;
+    target.sim = sim;
+    telemetry_decoder_init(&target.decoder);
+    if (p_csv)
+    {
+        target.p_csv = fopen(p_csv, "w");
+        if (!target.p_csv)
+        {
+            fprintf(stderr, "%s: cannot create %s\n", argv[0], p_csv);
+            return 1;
+        }
+        fprintf(target.p_csv, "time_s,seq,jukebox,button,usart,buzzer,melody,note,volume,speed,rx_overflows,tx_overflows,loops_per_s\n");
+    }
+    p_report = stdout;
+    if (sim)
+    {
+        /* Keep the report, discard the messages of the firmware */
+        fflush(stdout);
+        int report_fd = dup(STDOUT_FILENO);
+        p_report = (report_fd >= 0) ? fdopen(report_fd, "w") : NULL;
+        if (!p_report || !freopen("/dev/null", "w", stdout))
+        {
+            fprintf(stderr, "%s: cannot redirect the standard output\n", argv[0]);
+            return 1;
+        }
+        jukebox_client_init(&target.client, _sim_write, &target);
+        port_sim_reset();
+        port_sim_usart_set_tx_hook(_sim_on_tx, &target);
+        sim_jukebox_init(&target.board);
+
+        /* Turn it on and wait for the start-up melody */
+        port_sim_gpio_set_input(BUTTON_0_GPIO, BUTTON_0_PIN, LOW);
+        port_sim_schedule(port_sim_get_cycles() + PORT_SIM_MS_TO_CYCLES(TELEMETRY_POWER_ON_PRESS_MS), _on_release, NULL, 0);
+        _receive(&target, TELEMETRY_POWER_ON_WAIT_MS, false);
+    }
+    else
+    {
+        target.fd = jukebox_serial_open(p_device, baud);
+        if (target.fd < 0)
+        {
+            fprintf(stderr, "%s: cannot open %s at %u baud\n", argv[0], p_device, (unsigned)baud);
+            return 1;
+        }
+        jukebox_client_init(&target.client, jukebox_serial_write, &target.fd);
+    }
+
+    jukebox_client_set_binary(&target.client, true);
+    _receive(&target, TELEMETRY_SETTLE_MS, false);
+    target.start_s = _now(&target);
+    bool started = _request_telemetry(&target, (uint16_t)period_ms);
+    if (started)
+    {
+        _receive(&target, duration_s * 1000U, false);
+    }
+    bool stopped = _request_telemetry(&target, 0);
+    jukebox_client_set_binary(&target.client, false);
+    _receive(&target, TELEMETRY_SETTLE_MS, false);
+
+    uint32_t records = target.decoder.records;
+    uint32_t lost = target.decoder.lost;
+    fprintf(p_report, "%u records in %u s every %u ms, %u lost, %.1f bytes/record (%u with every field)\n",
+            (unsigned)records, (unsigned)duration_s, (unsigned)period_ms, (unsigned)lost,
+            records ? (double)target.record_bytes / records : 0.0, FRAME_HEADER_LENGTH + TELEMETRY_MAX_PAYLOAD + FRAME_CRC_LENGTH + 2);
+    if (!started || !stopped)
+    {
+        fprintf(p_report, "the jukebox did not %s the telemetry\n", started ? "stop" : "start");
+    }
+
+    if (target.p_csv)
+    {
+        fclose(target.p_csv);
+    }
+    if (sim)
+    {
+        sim_jukebox_destroy(&target.board);
+        port_sim_usart_set_tx_hook(NULL, NULL);
+    }
+    else
+    {
+        jukebox_serial_close(target.fd);
+    }
+    fflush(p_report);
+    return (started && stopped && records && !lost) ? 0 : 1;
+}
@@ -0,0 +1,401 @@
+/**
+ * @file jukebox_upload.c
+ * @brief Melody uploader: `jukebox_upload [options]`
+ *
+ * Uploads a melody to the store of a jukebox in a binary session (`FRAME_OP_UPLOAD_BEGIN`, `FRAME_OP_UPLOAD_DATA`
+ * and `FRAME_OP_UPLOAD_END`, see `melody_store.h`) and plays it with `FRAME_OP_SELECT`. A request without reply is
+ * sent again: the jukebox ignores notes it already has. At the end it prints the notes and bytes per second on the
+ * line and, for the simulated board, the time the flash was busy.
+ *
+ * - `-p <device>`: serial port of the board, e.g. `/dev/ttyACM0`. The board must be on.
+ * - `-b <baud>`: baud rate of the serial port (default 9600).
+ * - `--sim`: simulated board on the virtual clock instead of a serial port. It is turned on before the upload.
+ * - `-f <file>`: melody, a note per line: frequency in Hz and duration in ms. Lines starting with `#` are skipped.
+ *   Without it, a chromatic scale of `UPLOAD_DEFAULT_NOTES` notes is uploaded.
+ * - `-n <name>`: name of the melody (default `upload`). A stored melody with the same name is replaced.
+ *
+ * The exit status is not zero if the jukebox rejects the upload or does not play the melody.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* fdopen, dup and clock_gettime are POSIX */
+#define _DEFAULT_SOURCE
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "jukebox_client.h"
+#include "jukebox_serial.h"
+#include "melody_store.h"
+#include "sim_jukebox.h"
+#include "port_system.h"
+#include "port_usart.h"
+#include "port_button.h"
+#include "port_flash.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define UPLOAD_DEFAULT_BAUD 9600            /*!< Default baud rate of the serial port */
+#define UPLOAD_DEFAULT_NAME "upload"        /*!< Default name of the melody */
+#define UPLOAD_DEFAULT_NOTES 96             /*!< Notes of the default melody */
+#define UPLOAD_MAX_NOTES 4096               /*!< Longest melody read from a file */
+#define UPLOAD_TIMEOUT_MS 1000              /*!< Longest wait for a reply */
+#define UPLOAD_RETRIES 3                    /*!< Times a request is sent again without reply */
+#define UPLOAD_SETTLE_MS 50                 /*!< Wait for the jukebox to change its protocol */
+#define UPLOAD_POWER_ON_PRESS_MS 1200       /*!< Press that turns the simulated jukebox on */
+#define UPLOAD_POWER_ON_WAIT_MS 4000        /*!< End of the start-up melody */
+
+/* Typedefs --------------------------------------------------------------------*/
+/// @brief Jukebox receiving the melody
+typedef struct
+{
+    jukebox_client_t client;        /*!< Client */
+    bool sim;                       /*!< Simulated board */
+    sim_jukebox_t board;            /*!< Simulated board */
+    int fd;                         /*!< Serial port */
+    bool reply;                     /*!< A reply was completed since the last request */
+    uint64_t bytes;                 /*!< Bytes of the requests on the line, delimiters included */
+} upload_target_t;
+
+/* Private variables -----------------------------------------------------------*/
+static FILE *p_report; /*!< Standard output of the process, before the firmware output was discarded */
+static uint8_t notes[UPLOAD_MAX_NOTES * MELODY_STORE_NOTE_BYTES]; /*!< Notes as uploaded */
+
+/* Private functions -----------------------------------------------------------*/
+/// @brief Time of the upload: virtual for the simulated board
+/// @param p_target Pointer to the jukebox
+/// @return Seconds
+static double _now(const upload_target_t *p_target)
+{
+    if (p_target->sim)
+    {
+        return (double)port_sim_get_cycles() / PORT_SIM_CORE_CLOCK_HZ;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/// @brief Transport of the simulated board: the bytes arrive on the RX line of the USART
+static void _sim_write(void *p_arg, const uint8_t *p_data, size_t length)
+{
+    port_sim_usart_inject(USART_0, p_data, length, port_sim_get_cycles());
+    ((upload_target_t *)p_arg)->board.halted = false; // The bytes will wake the CPU up
+}
+
+/// @brief Capture the bytes transmitted by the simulated board
+static void _sim_on_tx(void *p_arg, USART_TypeDef *p_usart, uint8_t byte, uint64_t cycles)
+{
+    upload_target_t *p_target = (upload_target_t *)p_arg;
+    if ((p_usart == USART_0) && jukebox_client_feed(&p_target->client, byte))
+    {
+        p_target->reply = true;
+    }
+}
+
+/// @brief Receive until a reply arrives or the time is over
+/// @param p_target Pointer to the jukebox
+/// @param ms Longest wait
+/// @param until_reply Stop at the first reply
+/// @return true if a reply arrived
+static bool _receive(upload_target_t *p_target, uint32_t ms, bool until_reply)
+{
+    if (p_target->sim)
+    {
+        uint64_t limit = port_sim_get_cycles() + PORT_SIM_MS_TO_CYCLES(ms);
+        while (!(until_reply && p_target->reply) && !p_target->board.halted && (port_sim_get_cycles() < limit))
+        {
+            sim_jukebox_step(&p_target->board, limit);
+        }
+    }
+    else
+    {
+        double limit = _now(p_target) + ms / 1000.0;
+        while (!(until_reply && p_target->reply) && (_now(p_target) < limit))
+        {
+            uint8_t data[64];
+            int length = jukebox_serial_read(p_target->fd, data, sizeof(data), ms);
+            for (int i = 0; i < length; i++)
+            {
+                if (jukebox_client_feed(&p_target->client, data[i]))
+                {
+                    p_target->reply = true;
+                }
+            }
+        }
+    }
+    bool reply = p_target->reply;
+    p_target->reply = false;
+    return reply;
+}
+
+/// @brief Send a request and wait for its reply, sending it again if no reply arrives
+/// @param p_target Pointer to the jukebox
+/// @param p_request Pointer to the request
+/// @return Pointer to the reply, or NULL if none arrived or the jukebox rejected the request
+static const frame_t *_request(upload_target_t *p_target, frame_t *p_request)
+{
+    for (uint32_t attempt = 0; attempt < UPLOAD_RETRIES; attempt++)
+    {
+        uint8_t seq = jukebox_client_send_request(&p_target->client, p_request);
+        uint8_t encoded[FRAME_MAX_ENCODED];
+        p_target->bytes += frame_encode(p_request, encoded);
+        while (_receive(p_target, UPLOAD_TIMEOUT_MS, true))
+        {
+            const frame_t *p_reply = jukebox_client_get_reply(&p_target->client);
+            if ((p_reply->seq != seq) || (p_reply->opcode != (p_request->opcode | FRAME_REPLY)))
+            {
+                continue; // Reply to a request sent before
+            }
+            if ((p_reply->length == 0) || (p_reply->payload[0] != FRAME_STATUS_OK))
+            {
+                fprintf(p_report, "the jukebox rejected %s: status %u\n", frame_get_opcode_name(p_request->opcode),
+                        p_reply->length ? (unsigned)p_reply->payload[0] : 0U);
+                return NULL;
+            }
+            return p_reply;
+        }
+    }
+    fprintf(p_report, "no reply to %s\n", frame_get_opcode_name(p_request->opcode));
+    return NULL;
+}
+
+/// @brief Read a melody: a note per line, frequency in Hz and duration in ms
+/// @param p_path Path of the file
+/// @return Notes read, or 0 if the file cannot be read or a line is not valid
+static uint16_t _read_melody(const char *p_path)
+{
+    FILE *p_file = fopen(p_path, "r");
+    if (!p_file)
+    {
+        return 0;
+    }
+    char line[128];
+    uint16_t num_notes = 0;
+    while (fgets(line, sizeof(line), p_file))
+    {
+        double frequency;
+        unsigned duration;
+        if ((line[0] == '#') || (strspn(line, " \t\r\n") == strlen(line)))
+        {
+            continue;
+        }
+        if ((num_notes == UPLOAD_MAX_NOTES) || (sscanf(line, "%lf %u", &frequency, &duration) != 2) ||
+            (frequency < 0) || (frequency * 10 > UINT16_MAX) || (duration > UINT16_MAX))
+        {
+            fclose(p_file);
+            return 0;
+        }
+        uint16_t decihertz = (uint16_t)lround(frequency * 10);
+        uint8_t *p_note = &notes[num_notes++ * MELODY_STORE_NOTE_BYTES];
+        p_note[0] = decihertz & 0xFF;
+        p_note[1] = decihertz >> 8;
+        p_note[2] = duration & 0xFF;
+        p_note[3] = duration >> 8;
+    }
+    fclose(p_file);
+    return num_notes;
+}
+
+/// @brief Fill the default melody: a chromatic scale from A3, with a silence every octave
+/// @return Notes
+static uint16_t _default_melody(void)
+{
+    for (uint16_t i = 0; i < UPLOAD_DEFAULT_NOTES; i++)
+    {
+        uint16_t decihertz = ((i % 13) == 12) ? 0 : (uint16_t)lround(2200.0 * pow(2.0, (i - i / 13) / 12.0));
+        uint16_t duration = 125;
+        uint8_t *p_note = &notes[i * MELODY_STORE_NOTE_BYTES];
+        p_note[0] = decihertz & 0xFF;
+        p_note[1] = decihertz >> 8;
+        p_note[2] = duration & 0xFF;
+        p_note[3] = duration >> 8;
+    }
+    return UPLOAD_DEFAULT_NOTES;
+}
+
+/// @brief Upload the melody
+/// @param p_target Pointer to the jukebox
+/// @param p_name Name of the melody
+/// @param num_notes Notes
+/// @param p_melody_idx Pointer to store the index of the melody in the jukebox
+/// @return true if the jukebox committed it
+static bool _upload(upload_target_t *p_target, const char *p_name, uint16_t num_notes, uint8_t *p_melody_idx)
+{
+    frame_t request = {.opcode = FRAME_OP_UPLOAD_BEGIN};
+    frame_put_u16(&request, num_notes);
+    for (const char *p_char = p_name; *p_char != '\0'; p_char++)
+    {
+        frame_put_u8(&request, (uint8_t)*p_char);
+    }
+    if (!_request(p_target, &request))
+    {
+        return false;
+    }
+    for (uint16_t note = 0; note < num_notes; note += FRAME_UPLOAD_NOTES)
+    {
+        request = (frame_t){.opcode = FRAME_OP_UPLOAD_DATA};
+        frame_put_u16(&request, note);
+        for (uint16_t i = note; (i < num_notes) && (i < note + FRAME_UPLOAD_NOTES); i++)
+        {
+            for (uint32_t byte = 0; byte < MELODY_STORE_NOTE_BYTES; byte++)
+            {
+                frame_put_u8(&request, notes[i * MELODY_STORE_NOTE_BYTES + byte]);
+            }
+        }
+        if (!_request(p_target, &request))
+        {
+            return false;
+        }
+    }
+    request = (frame_t){.opcode = FRAME_OP_UPLOAD_END};
+    frame_put_u16(&request, frame_crc16(notes, num_notes * MELODY_STORE_NOTE_BYTES));
+    const frame_t *p_reply = _request(p_target, &request);
+    if (!p_reply || (p_reply->length < 2))
+    {
+        return false;
+    }
+    *p_melody_idx = p_reply->payload[1];
+    return true;
+}
+
+/// @brief Event: release the user button of the simulated board
+static void _on_release(void *p_arg, uint32_t data)
+{
+    port_sim_gpio_set_input(BUTTON_0_GPIO, BUTTON_0_PIN, HIGH);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *p_device = NULL;
+    const char *p_file = NULL;
+    const char *p_name = UPLOAD_DEFAULT_NAME;
+    uint32_t baud = UPLOAD_DEFAULT_BAUD;
+    bool sim = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = (i + 1 < argc);
+        if (!strcmp(argv[i], "-p") && has_value)
+        {
+            p_device = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-b") && has_value)
+        {
+            baud = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-f") && has_value)
+        {
+            p_file = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-n") && has_value)
+        {
+            p_name = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--sim"))
+        {
+            sim = true;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s (-p device [-b baud] | --sim) [-f melody.txt] [-n name]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((sim == (p_device != NULL)) || (strlen(p_name) > FRAME_MAX_PAYLOAD - 2))
+    {
+        fprintf(stderr, "%s: select either a serial port or the simulated board, and a name of up to %u characters\n",
+                argv[0], FRAME_MAX_PAYLOAD - 2);
+        return 1;
+    }
+    uint16_t num_notes = p_file ? _read_melody(p_file) : _default_melody();
+    if (num_notes == 0)
+    {
+        fprintf(stderr, "%s: cannot read the notes of %s\n", argv[0], p_file);
+        return 1;
+    }
+
+    static upload_target_t target;
+    target.sim = sim;
+    p_report = stdout;
+    if (sim)
+    {
+        /* Keep the report, discard the messages of the firmware */
+        fflush(stdout);
+        int report_fd = dup(STDOUT_FILENO);
+        p_report = (report_fd >= 0) ? fdopen(report_fd, "w") : NULL;
+        if (!p_report || !freopen("/dev/null", "w", stdout))
+        {
+            fprintf(stderr, "%s: cannot redirect the standard output\n", argv[0]);
+            return 1;
+        }
+        jukebox_client_init(&target.client, _sim_write, &target);
+        port_sim_reset();
+        port_sim_usart_set_tx_hook(_sim_on_tx, &target);
+        sim_jukebox_init(&target.board);
+
+        /* Turn it on and wait for the start-up melody */
+        port_sim_gpio_set_input(BUTTON_0_GPIO, BUTTON_0_PIN, LOW);
+        port_sim_schedule(port_sim_get_cycles() + PORT_SIM_MS_TO_CYCLES(UPLOAD_POWER_ON_PRESS_MS), _on_release, NULL, 0);
+        _receive(&target, UPLOAD_POWER_ON_WAIT_MS, false);
+    }
+    else
+    {
+        target.fd = jukebox_serial_open(p_device, baud);
+        if (target.fd < 0)
+        {
+            fprintf(stderr, "%s: cannot open %s at %u baud\n", argv[0], p_device, (unsigned)baud);
+            return 1;
+        }
+        jukebox_client_init(&target.client, jukebox_serial_write, &target.fd);
+    }
+
+    jukebox_client_set_binary(&target.client, true);
+    _receive(&target, UPLOAD_SETTLE_MS, false);
+    uint64_t busy_cycles = sim ? port_flash_get_busy_cycles() : 0;
+    double start_s = _now(&target);
+    uint8_t melody_idx = 0;
+    bool uploaded = _upload(&target, p_name, num_notes, &melody_idx);
+    double upload_s = _now(&target) - start_s;
+    busy_cycles = sim ? port_flash_get_busy_cycles() - busy_cycles : 0;
+
+    bool played = false;
+    if (uploaded)
+    {
+        frame_t request = {.opcode = FRAME_OP_SELECT};
+        frame_put_u8(&request, melody_idx);
+        played = (_request(&target, &request) != NULL);
+    }
+    jukebox_client_set_binary(&target.client, false);
+    _receive(&target, UPLOAD_SETTLE_MS, false);
+
+    if (uploaded)
+    {
+        fprintf(p_report, "%s: melody %u, %u notes in %.2f s, %.0f notes/s, %.0f bytes/s on the line", p_name,
+                (unsigned)melody_idx, (unsigned)num_notes, upload_s, num_notes / upload_s, target.bytes / upload_s);
+        if (sim)
+        {
+            fprintf(p_report, ", flash busy %.1f ms (%.1f us/note)", busy_cycles * 1e3 / PORT_SIM_CORE_CLOCK_HZ,
+                    busy_cycles * 1e6 / PORT_SIM_CORE_CLOCK_HZ / num_notes);
+        }
+        fprintf(p_report, "\n");
+    }
+    if (sim)
+    {
+        sim_jukebox_destroy(&target.board);
+        port_sim_usart_set_tx_hook(NULL, NULL);
+    }
+    else
+    {
+        jukebox_serial_close(target.fd);
+    }
+    fflush(p_report);
+    return (uploaded && played) ? 0 : 1;
+}
@@ -0,0 +1,1287 @@
+/**
+ * @file melody_import.c
+ * @brief Readers of the melody formats of `jukebox_import`: Standard MIDI Files, RTTTL and Arduino sketches.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* strdup and strcasecmp are POSIX */
+#define _DEFAULT_SOURCE
+
+/* Includes ------------------------------------------------------------------*/
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "melody_import.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define IMPORT_FIRST_CAPACITY 64            /*!< Notes allocated for the first note of a melody */
+#define IMPORT_A4_KEY 69                    /*!< MIDI key of A4 */
+#define IMPORT_A4_HZ 440.0                  /*!< Frequency of A4 */
+#define IMPORT_SEMITONES 12                 /*!< Semitones of an octave */
+#define MIDI_HEADER_BYTES 14                /*!< `MThd`, its length (6) and the header */
+#define MIDI_CHANNELS 16                    /*!< Channels of each track */
+#define MIDI_KEYS 128                       /*!< Keys of each channel */
+#define MIDI_DEFAULT_TEMPO_US 500000U       /*!< Quarter note until the first tempo change: 120 bpm */
+#define MIDI_META_TEMPO 0x51                /*!< Meta event of a tempo change */
+#define MIDI_META_END_OF_TRACK 0x2F         /*!< Meta event of the end of a track */
+#define RTTTL_DEFAULT_DURATION 4            /*!< Duration of a note without it, as a fraction of a whole note */
+#define RTTTL_DEFAULT_OCTAVE 6              /*!< Octave of a note without it */
+#define RTTTL_DEFAULT_BPM 63                /*!< Quarter notes per minute */
+#define SKETCH_NAME_LENGTH 32               /*!< Longest name of a constant of a sketch */
+
+/* Typedefs --------------------------------------------------------------------*/
+/// @brief Note of a MIDI file, in ticks
+typedef struct
+{
+    uint32_t start;             /*!< Tick of the note on */
+    uint32_t end;               /*!< Tick of the note off */
+    uint32_t voice;             /*!< Track and channel: `track * MIDI_CHANNELS + channel` */
+    uint8_t key;                /*!< Key, 69 is A4 */
+} midi_note_t;
+
+/// @brief Tempo change of a MIDI file
+typedef struct
+{
+    uint32_t tick;              /*!< Tick of the change */
+    uint32_t us_per_quarter;    /*!< Microseconds per quarter note from the change on */
+    uint32_t order;             /*!< Order in the file, to keep it among changes of the same tick */
+    double ms;                  /*!< Time of the change */
+} midi_tempo_t;
+
+/// @brief Contents of a MIDI file
+typedef struct
+{
+    midi_note_t *p_notes;       /*!< Notes of every track */
+    uint32_t num_notes;         /*!< Notes */
+    uint32_t notes_capacity;    /*!< Notes that fit in `p_notes` */
+    midi_tempo_t *p_tempos;     /*!< Tempo changes of every track */
+    uint32_t num_tempos;        /*!< Tempo changes */
+    uint32_t tempos_capacity;   /*!< Tempo changes that fit in `p_tempos` */
+    uint32_t ticks_per_quarter; /*!< Ticks per quarter note, 0 for SMPTE time */
+    double ms_per_tick;         /*!< Duration of a tick for SMPTE time */
+} midi_t;
+
+/// @brief Constant of a sketch
+typedef struct
+{
+    char name[SKETCH_NAME_LENGTH];  /*!< Name */
+    double value;                   /*!< Value */
+} sketch_symbol_t;
+
+/// @brief Sketch being played
+typedef struct
+{
+    sketch_symbol_t symbols[MELODY_IMPORT_MAX_SYMBOLS]; /*!< Constants */
+    uint32_t num_symbols;                               /*!< Constants found */
+    melody_import_t *p_melody;                          /*!< Melody being written */
+    double now_ms;                                      /*!< Time of the sketch */
+    bool playing;                                       /*!< A tone is sounding */
+    double frequency;                                   /*!< Frequency of the tone */
+    double start_ms;                                    /*!< Start of the tone */
+    double end_ms;                                      /*!< End of the tone, INFINITY until `noTone()` */
+    double last_end_ms;                                 /*!< End of the last tone added to the melody */
+} sketch_t;
+
+/// @brief Expression of a sketch being evaluated
+typedef struct
+{
+    const char *p;              /*!< Next character */
+    const char *p_end;          /*!< End of the expression */
+    const sketch_t *p_sketch;   /*!< Constants */
+    bool ok;                    /*!< false if something could not be evaluated */
+} sketch_expr_t;
+
+/* Private functions -----------------------------------------------------------*/
+/**
+ * @brief Make room for one more element of an array that grows by doubling.
+ *
+ * @param pp_array Pointer to the array
+ * @param p_capacity Pointer to the elements that fit
+ * @param count Elements in use
+ * @param element_size Bytes of an element
+ * @return true if there is room
+ */
+static bool _grow(void **pp_array, uint32_t *p_capacity, uint32_t count, size_t element_size)
+{
+    if (count < *p_capacity)
+    {
+        return true;
+    }
+    uint32_t capacity = *p_capacity ? 2 * *p_capacity : IMPORT_FIRST_CAPACITY;
+    void *p_array = realloc(*pp_array, (size_t)capacity * element_size);
+    if (!p_array)
+    {
+        return false;
+    }
+    *pp_array = p_array;
+    *p_capacity = capacity;
+    return true;
+}
+
+/**
+ * @brief Frequency of a key of the equal temperament.
+ *
+ * @param key MIDI key, 69 is A4
+ * @return Frequency in Hz
+ */
+static double _key_frequency(int32_t key)
+{
+    return IMPORT_A4_HZ * pow(2.0, (double)(key - IMPORT_A4_KEY) / IMPORT_SEMITONES);
+}
+
+/**
+ * @brief Semitone of a note name in its octave.
+ *
+ * @param letter Name of the note: `c` to `b`, and `h` as in German for `b`
+ * @return Semitone from C, -1 if it is not a note
+ */
+static int32_t _semitone(char letter)
+{
+    static const int8_t semitones[] = {9, 11, 0, 2, 4, 5, 7, 11}; // a, b, c, d, e, f, g, h
+    letter = (char)tolower((unsigned char)letter);
+    return ((letter >= 'a') && (letter <= 'h')) ? semitones[letter - 'a'] : -1;
+}
+
+/* MIDI ------------------------------------------------------------------------*/
+/// @brief Read a big-endian value of up to 4 bytes
+static uint32_t _get_be(const uint8_t *p_data, uint32_t bytes)
+{
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < bytes; i++)
+    {
+        value = (value << 8) | p_data[i];
+    }
+    return value;
+}
+
+/**
+ * @brief Read a variable-length quantity: 7 bits per byte, the high bit set in all but the last one.
+ *
+ * @param pp Pointer to the next byte, it is advanced
+ * @param p_end End of the data
+ * @param p_value Pointer to store the value
+ * @return true if read, false if it runs out of the data or takes more than 4 bytes
+ */
+static bool _get_varlen(const uint8_t **pp, const uint8_t *p_end, uint32_t *p_value)
+{
+    uint32_t value = 0;
+    for (uint32_t i = 0; (i < 4) && (*pp < p_end); i++)
+    {
+        uint8_t byte = *(*pp)++;
+        value = (value << 7) | (byte & 0x7F);
+        if (!(byte & 0x80))
+        {
+            *p_value = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief End the note that sounds on a key of a voice, if any.
+ *
+ * @param p_midi Pointer to the contents of the file
+ * @param p_open Pointer to the index plus one of the note that sounds, 0 if none
+ * @param tick Tick of the end
+ */
+static void _midi_note_off(midi_t *p_midi, uint32_t *p_open, uint32_t tick)
+{
+    if (*p_open)
+    {
+        p_midi->p_notes[*p_open - 1].end = tick;
+        *p_open = 0;
+    }
+}
+
+/**
+ * @brief Read the notes and tempo changes of a track.
+ *
+ * @param p_midi Pointer to the contents of the file
+ * @param p Start of the events
+ * @param p_end End of the events
+ * @param track Index of the track
+ * @return true if read, false if the track is corrupt or out of memory
+ */
+static bool _midi_track(midi_t *p_midi, const uint8_t *p, const uint8_t *p_end, uint32_t track)
+{
+    uint32_t open[MIDI_CHANNELS][MIDI_KEYS] = {0};
+    uint32_t tick = 0;
+    uint8_t running_status = 0;
+    while (p < p_end)
+    {
+        uint32_t delta;
+        if (!_get_varlen(&p, p_end, &delta) || (p >= p_end))
+        {
+            return false;
+        }
+        tick += delta;
+        uint8_t status = *p;
+        if (status & 0x80)
+        {
+            p++;
+        }
+        else if (running_status)
+        {
+            status = running_status;
+        }
+        else
+        {
+            return false;
+        }
+
+        uint32_t length;
+        if (status == 0xFF)
+        {
+            if (p >= p_end)
+            {
+                return false;
+            }
+            uint8_t type = *p++;
+            if (!_get_varlen(&p, p_end, &length) || ((uint32_t)(p_end - p) < length))
+            {
+                return false;
+            }
+            if ((type == MIDI_META_TEMPO) && (length == 3))
+            {
+                if (!_grow((void **)&p_midi->p_tempos, &p_midi->tempos_capacity, p_midi->num_tempos,
+                           sizeof(midi_tempo_t)))
+                {
+                    return false;
+                }
+                p_midi->p_tempos[p_midi->num_tempos] = (midi_tempo_t){.tick = tick, .us_per_quarter = _get_be(p, 3),
+                                                                      .order = p_midi->num_tempos};
+                p_midi->num_tempos++;
+            }
+            p += length;
+            if (type == MIDI_META_END_OF_TRACK)
+            {
+                break;
+            }
+        }
+        else if ((status == 0xF0) || (status == 0xF7))
+        {
+            if (!_get_varlen(&p, p_end, &length) || ((uint32_t)(p_end - p) < length))
+            {
+                return false;
+            }
+            p += length;
+        }
+        else if (status > 0xF0)
+        {
+            // System messages other than SysEx are not stored in files
+            return false;
+        }
+        else
+        {
+            running_status = status;
+            uint8_t type = status >> 4;
+            uint8_t channel = status & 0x0F;
+            uint32_t data_bytes = ((type == 0xC) || (type == 0xD)) ? 1 : 2;
+            if ((uint32_t)(p_end - p) < data_bytes)
+            {
+                return false;
+            }
+            uint8_t key = p[0] & 0x7F;
+            uint8_t velocity = (data_bytes == 2) ? (p[1] & 0x7F) : 0;
+            p += data_bytes;
+            if ((type == 0x9) || (type == 0x8))
+            {
+                // A note on with no velocity is a note off; a note on of a key that sounds ends it first
+                _midi_note_off(p_midi, &open[channel][key], tick);
+                if ((type == 0x9) && velocity)
+                {
+                    if (!_grow((void **)&p_midi->p_notes, &p_midi->notes_capacity, p_midi->num_notes,
+                               sizeof(midi_note_t)))
+                    {
+                        return false;
+                    }
+                    p_midi->p_notes[p_midi->num_notes] = (midi_note_t){.start = tick, .end = tick, .key = key,
+                                                                       .voice = track * MIDI_CHANNELS + channel};
+                    open[channel][key] = ++p_midi->num_notes;
+                }
+            }
+        }
+    }
+    // Notes still sounding end with the track
+    for (uint32_t channel = 0; channel < MIDI_CHANNELS; channel++)
+    {
+        for (uint32_t key = 0; key < MIDI_KEYS; key++)
+        {
+            _midi_note_off(p_midi, &open[channel][key], tick);
+        }
+    }
+    return true;
+}
+
+static int _compare_tempos(const void *p_a, const void *p_b)
+{
+    const midi_tempo_t *p_first = p_a;
+    const midi_tempo_t *p_second = p_b;
+    if (p_first->tick != p_second->tick)
+    {
+        return (p_first->tick < p_second->tick) ? -1 : 1;
+    }
+    return (p_first->order < p_second->order) ? -1 : (p_first->order > p_second->order);
+}
+
+/* Notes by start, and the highest first among notes that start together */
+static int _compare_notes(const void *p_a, const void *p_b)
+{
+    const midi_note_t *p_first = p_a;
+    const midi_note_t *p_second = p_b;
+    if (p_first->start != p_second->start)
+    {
+        return (p_first->start < p_second->start) ? -1 : 1;
+    }
+    return (int)p_second->key - (int)p_first->key;
+}
+
+/**
+ * @brief Time of a tick, with the tempo changes before it.
+ *
+ * @param p_midi Pointer to the contents of the file, tempo changes sorted and timed
+ * @param tick Tick
+ * @return Time in ms
+ */
+static double _midi_ms(const midi_t *p_midi, uint32_t tick)
+{
+    if (!p_midi->ticks_per_quarter)
+    {
+        return tick * p_midi->ms_per_tick;
+    }
+    // Last change at or before the tick: the first one is always at tick 0
+    uint32_t low = 0;
+    uint32_t high = p_midi->num_tempos;
+    while (high - low > 1)
+    {
+        uint32_t middle = (low + high) / 2;
+        if (p_midi->p_tempos[middle].tick <= tick)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    const midi_tempo_t *p_tempo = &p_midi->p_tempos[low];
+    return p_tempo->ms + (double)(tick - p_tempo->tick) * p_tempo->us_per_quarter / (1000.0 * p_midi->ticks_per_quarter);
+}
+
+/**
+ * @brief Sort the tempo changes and compute the time of each one.
+ *
+ * @param p_midi Pointer to the contents of the file
+ * @return true on success, false if out of memory
+ */
+static bool _midi_time_tempos(midi_t *p_midi)
+{
+    if (!_grow((void **)&p_midi->p_tempos, &p_midi->tempos_capacity, p_midi->num_tempos, sizeof(midi_tempo_t)))
+    {
+        return false;
+    }
+    // The default tempo, before any change at tick 0
+    p_midi->p_tempos[p_midi->num_tempos++] = (midi_tempo_t){.tick = 0, .us_per_quarter = MIDI_DEFAULT_TEMPO_US,
+                                                             .order = 0};
+    for (uint32_t i = 0; i < p_midi->num_tempos - 1; i++)
+    {
+        p_midi->p_tempos[i].order++;
+    }
+    qsort(p_midi->p_tempos, p_midi->num_tempos, sizeof(midi_tempo_t), _compare_tempos);
+    for (uint32_t i = 1; i < p_midi->num_tempos; i++)
+    {
+        const midi_tempo_t *p_previous = &p_midi->p_tempos[i - 1];
+        p_midi->p_tempos[i].ms = p_previous->ms + (double)(p_midi->p_tempos[i].tick - p_previous->tick) *
+                                                      p_previous->us_per_quarter / (1000.0 * p_midi->ticks_per_quarter);
+    }
+    return true;
+}
+
+/**
+ * @brief Choose the voice that sounds the longest, drums excluded. Between voices that sound as long, the highest.
+ *
+ * @param p_midi Pointer to the contents of the file
+ * @param num_tracks Tracks of the file
+ * @return Voice, or UINT32_MAX if there is no note out of the drums
+ */
+static uint32_t _midi_dominant_voice(const midi_t *p_midi, uint32_t num_tracks)
+{
+    uint32_t num_voices = num_tracks * MIDI_CHANNELS;
+    uint64_t *p_ticks = calloc(num_voices, sizeof(uint64_t));
+    uint64_t *p_keys = calloc(num_voices, sizeof(uint64_t));
+    uint32_t *p_count = calloc(num_voices, sizeof(uint32_t));
+    uint32_t best = UINT32_MAX;
+    if (p_ticks && p_keys && p_count)
+    {
+        for (uint32_t i = 0; i < p_midi->num_notes; i++)
+        {
+            const midi_note_t *p_note = &p_midi->p_notes[i];
+            p_ticks[p_note->voice] += p_note->end - p_note->start;
+            p_keys[p_note->voice] += p_note->key;
+            p_count[p_note->voice]++;
+        }
+        for (uint32_t voice = 0; voice < num_voices; voice++)
+        {
+            if (!p_count[voice] || (voice % MIDI_CHANNELS == MELODY_IMPORT_DRUM_CHANNEL))
+            {
+                continue;
+            }
+            // Mean keys compared without division: keys[v] / count[v] > keys[best] / count[best]
+            if ((best == UINT32_MAX) || (p_ticks[voice] > p_ticks[best]) ||
+                ((p_ticks[voice] == p_ticks[best]) && (p_keys[voice] * p_count[best] > p_keys[best] * p_count[voice])))
+            {
+                best = voice;
+            }
+        }
+    }
+    free(p_ticks);
+    free(p_keys);
+    free(p_count);
+    return best;
+}
+
+/**
+ * @brief Add a note of a MIDI file to the melody, with the silence since the previous one.
+ *
+ * @param p_midi Pointer to the contents of the file
+ * @param p_melody Pointer to the melody
+ * @param p_last_end Pointer to the tick where the previous note ended, it is updated
+ * @param p_note Pointer to the note
+ * @param start Tick where the note starts to sound
+ * @param end Tick where the note is cut
+ * @return true if added
+ */
+static bool _midi_add(const midi_t *p_midi, melody_import_t *p_melody, uint32_t *p_last_end, const midi_note_t *p_note,
+                      uint32_t start, uint32_t end)
+{
+    bool ok = true;
+    if (p_melody->num_notes)
+    {
+        ok = melody_import_add_note(p_melody, 0, _midi_ms(p_midi, start) - _midi_ms(p_midi, *p_last_end));
+    }
+    *p_last_end = end;
+    return ok && melody_import_add_note(p_melody, _key_frequency(p_note->key),
+                                        _midi_ms(p_midi, end) - _midi_ms(p_midi, start));
+}
+
+/**
+ * @brief Turn the notes of a voice into a monophonic melody: the highest note sounds.
+ *
+ * @param p_midi Pointer to the contents of the file, notes sorted
+ * @param voice Voice to keep
+ * @param p_melody Pointer to the melody
+ * @return true on success, false if out of memory
+ */
+static bool _midi_skyline(const midi_t *p_midi, uint32_t voice, melody_import_t *p_melody)
+{
+    const midi_note_t *p_current = NULL;
+    uint32_t start = 0;
+    uint32_t last_end = 0;
+    for (uint32_t i = 0; i < p_midi->num_notes; i++)
+    {
+        const midi_note_t *p_next = &p_midi->p_notes[i];
+        if ((p_next->voice != voice) || (p_next->end == p_next->start))
+        {
+            continue;
+        }
+        if (!p_current)
+        {
+            p_current = p_next;
+            start = p_next->start;
+        }
+        else if (p_next->start >= p_current->end)
+        {
+            if (!_midi_add(p_midi, p_melody, &last_end, p_current, start, p_current->end))
+            {
+                return false;
+            }
+            p_current = p_next;
+            start = p_next->start;
+        }
+        else if (p_next->key > p_current->key)
+        {
+            // A higher note cuts the one that sounds
+            if ((p_next->start > start) && !_midi_add(p_midi, p_melody, &last_end, p_current, start, p_next->start))
+            {
+                return false;
+            }
+            p_current = p_next;
+            start = p_next->start;
+        }
+    }
+    return !p_current || _midi_add(p_midi, p_melody, &last_end, p_current, start, p_current->end);
+}
+
+/* Sketches --------------------------------------------------------------------*/
+static double _expr_sum(sketch_expr_t *p_expr);
+
+static void _expr_skip_spaces(sketch_expr_t *p_expr)
+{
+    while ((p_expr->p < p_expr->p_end) && isspace((unsigned char)*p_expr->p))
+    {
+        p_expr->p++;
+    }
+}
+
+static bool _is_name_char(char c)
+{
+    return isalnum((unsigned char)c) || (c == '_');
+}
+
+/**
+ * @brief Check if a word is a type of the Arduino language, for declarations and casts.
+ *
+ * @param p_word Start of the word
+ * @param length Characters of the word
+ * @return true if it is a type or a qualifier
+ */
+static bool _is_type(const char *p_word, size_t length)
+{
+    static const char *const types[] = {"const", "static", "unsigned", "signed", "int", "long", "short", "float",
+                                        "double", "byte", "word", "char", "uint8_t", "uint16_t", "uint32_t",
+                                        "int8_t", "int16_t", "int32_t", "volatile"};
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+    {
+        if ((strlen(types[i]) == length) && !strncmp(types[i], p_word, length))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Value of a name: a constant of the sketch or a `NOTE_*` of `pitches.h` (e.g. `NOTE_CS4`, rounded to Hz).
+ *
+ * @param p_sketch Pointer to the sketch
+ * @param p_name Start of the name
+ * @param length Characters of the name
+ * @param p_value Pointer to store the value
+ * @return true if the name has a value
+ */
+static bool _lookup(const sketch_t *p_sketch, const char *p_name, size_t length, double *p_value)
+{
+    for (uint32_t i = p_sketch->num_symbols; i-- > 0;)
+    {
+        if ((strlen(p_sketch->symbols[i].name) == length) && !strncmp(p_sketch->symbols[i].name, p_name, length))
+        {
+            *p_value = p_sketch->symbols[i].value;
+            return true;
+        }
+    }
+    if ((length < 7) || (length > 8) || strncmp(p_name, "NOTE_", 5))
+    {
+        return false;
+    }
+    int32_t semitone = isupper((unsigned char)p_name[5]) ? _semitone(p_name[5]) : -1;
+    bool sharp = (length == 8) && (p_name[6] == 'S');
+    char octave = p_name[length - 1];
+    if ((semitone < 0) || (p_name[5] == 'H') || ((length == 8) && !sharp) || !isdigit((unsigned char)octave))
+    {
+        return false;
+    }
+    *p_value = round(_key_frequency(IMPORT_SEMITONES * (octave - '0' + 1) + semitone + sharp));
+    return true;
+}
+
+static double _expr_factor(sketch_expr_t *p_expr)
+{
+    _expr_skip_spaces(p_expr);
+    if (p_expr->p >= p_expr->p_end)
+    {
+        p_expr->ok = false;
+        return 0;
+    }
+    char c = *p_expr->p;
+    if ((c == '-') || (c == '+'))
+    {
+        p_expr->p++;
+        double value = _expr_factor(p_expr);
+        return (c == '-') ? -value : value;
+    }
+    if (c == '(')
+    {
+        p_expr->p++;
+        // A cast, e.g. (int)
+        const char *p_word = p_expr->p;
+        while ((p_expr->p < p_expr->p_end) && _is_name_char(*p_expr->p))
+        {
+            p_expr->p++;
+        }
+        if ((p_expr->p > p_word) && _is_type(p_word, p_expr->p - p_word) && (p_expr->p < p_expr->p_end) &&
+            (*p_expr->p == ')'))
+        {
+            p_expr->p++;
+            return _expr_factor(p_expr);
+        }
+        p_expr->p = p_word;
+        double value = _expr_sum(p_expr);
+        _expr_skip_spaces(p_expr);
+        if ((p_expr->p >= p_expr->p_end) || (*p_expr->p != ')'))
+        {
+            p_expr->ok = false;
+            return 0;
+        }
+        p_expr->p++;
+        return value;
+    }
+    if (isdigit((unsigned char)c) || (c == '.'))
+    {
+        char *p_after;
+        double value = (double)strtod(p_expr->p, &p_after);
+        p_expr->p = p_after;
+        // Suffixes of the literals: 10UL, 1.5f
+        while ((p_expr->p < p_expr->p_end) && isalpha((unsigned char)*p_expr->p))
+        {
+            p_expr->p++;
+        }
+        return value;
+    }
+    const char *p_name = p_expr->p;
+    while ((p_expr->p < p_expr->p_end) && _is_name_char(*p_expr->p))
+    {
+        p_expr->p++;
+    }
+    double value = 0;
+    if ((p_expr->p == p_name) || !_lookup(p_expr->p_sketch, p_name, p_expr->p - p_name, &value))
+    {
+        p_expr->ok = false;
+    }
+    return value;
+}
+
+static double _expr_product(sketch_expr_t *p_expr)
+{
+    double value = _expr_factor(p_expr);
+    for (;;)
+    {
+        _expr_skip_spaces(p_expr);
+        if ((p_expr->p >= p_expr->p_end) || ((*p_expr->p != '*') && (*p_expr->p != '/')))
+        {
+            return value;
+        }
+        char op = *p_expr->p++;
+        double factor = _expr_factor(p_expr);
+        value = (op == '*') ? value * factor : value / factor;
+    }
+}
+
+static double _expr_sum(sketch_expr_t *p_expr)
+{
+    double value = _expr_product(p_expr);
+    for (;;)
+    {
+        _expr_skip_spaces(p_expr);
+        if ((p_expr->p >= p_expr->p_end) || ((*p_expr->p != '+') && (*p_expr->p != '-')))
+        {
+            return value;
+        }
+        char op = *p_expr->p++;
+        double term = _expr_product(p_expr);
+        value = (op == '+') ? value + term : value - term;
+    }
+}
+
+/**
+ * @brief Evaluate an expression of a sketch.
+ *
+ * @param p_sketch Pointer to the sketch
+ * @param p_start Start of the expression
+ * @param p_end End of the expression
+ * @param p_value Pointer to store the value
+ * @return true if all of it could be evaluated
+ */
+static bool _eval(const sketch_t *p_sketch, const char *p_start, const char *p_end, double *p_value)
+{
+    sketch_expr_t expr = {.p = p_start, .p_end = p_end, .p_sketch = p_sketch, .ok = true};
+    *p_value = _expr_sum(&expr);
+    _expr_skip_spaces(&expr);
+    return expr.ok && (expr.p == p_end) && isfinite(*p_value);
+}
+
+/**
+ * @brief Add a constant to a sketch, if its value can be evaluated.
+ *
+ * @param p_sketch Pointer to the sketch
+ * @param p_name Start of the name
+ * @param length Characters of the name
+ * @param p_start Start of the value
+ * @param p_end End of the value
+ */
+static void _define(sketch_t *p_sketch, const char *p_name, size_t length, const char *p_start, const char *p_end)
+{
+    double value;
+    if ((length < SKETCH_NAME_LENGTH) && (p_sketch->num_symbols < MELODY_IMPORT_MAX_SYMBOLS) &&
+        _eval(p_sketch, p_start, p_end, &value))
+    {
+        sketch_symbol_t *p_symbol = &p_sketch->symbols[p_sketch->num_symbols++];
+        memcpy(p_symbol->name, p_name, length);
+        p_symbol->name[length] = '\0';
+        p_symbol->value = value;
+    }
+}
+
+/**
+ * @brief Blank the comments and the literal strings and characters of a sketch, keeping the lines.
+ *
+ * @param p_text Text of the sketch, it is modified
+ */
+static void _strip(char *p_text)
+{
+    for (char *p = p_text; *p; p++)
+    {
+        if ((p[0] == '/') && (p[1] == '/'))
+        {
+            while (*p && (*p != '\n'))
+            {
+                *p++ = ' ';
+            }
+            if (!*p)
+            {
+                return;
+            }
+        }
+        else if ((p[0] == '/') && (p[1] == '*'))
+        {
+            while (*p && !((p[0] == '*') && (p[1] == '/')))
+            {
+                *p = (*p == '\n') ? '\n' : ' ';
+                p++;
+            }
+            if (!*p)
+            {
+                return;
+            }
+            p[0] = p[1] = ' ';
+            p++;
+        }
+        else if ((*p == '"') || (*p == '\''))
+        {
+            char quote = *p;
+            *p++ = ' ';
+            while (*p && (*p != quote) && (*p != '\n'))
+            {
+                if ((*p == '\\') && p[1])
+                {
+                    *p++ = ' ';
+                }
+                *p++ = ' ';
+            }
+            if (!*p)
+            {
+                return;
+            }
+            *p = ' ';
+        }
+    }
+}
+
+/**
+ * @brief Read the constants of a sketch: `#define NAME value` and `<type> NAME = value;`.
+ *
+ * @param p_sketch Pointer to the sketch
+ * @param p_text Text of the sketch, without comments
+ */
+static void _read_symbols(sketch_t *p_sketch, const char *p_text)
+{
+    for (const char *p = p_text; *p;)
+    {
+        if (!_is_name_char(*p) && (*p != '#'))
+        {
+            p++;
+            continue;
+        }
+        const char *p_word = p++;
+        while (_is_name_char(*p))
+        {
+            p++;
+        }
+        size_t length = p - p_word;
+        if ((length == 7) && !strncmp(p_word, "#define", 7))
+        {
+            const char *p_name = p;
+            while ((*p_name == ' ') || (*p_name == '\t'))
+            {
+                p_name++;
+            }
+            const char *p_value = p_name;
+            while (_is_name_char(*p_value))
+            {
+                p_value++;
+            }
+            const char *p_end = strchr(p_value, '\n');
+            p_end = p_end ? p_end : p_value + strlen(p_value);
+            if ((p_value > p_name) && (*p_value != '('))
+            {
+                _define(p_sketch, p_name, p_value - p_name, p_value, p_end);
+            }
+            p = p_end;
+        }
+        else if (_is_type(p_word, length))
+        {
+            // The name after the last word of the type, then '=', the value and ';'
+            const char *p_name = p;
+            size_t name_length;
+            for (;;)
+            {
+                while (isspace((unsigned char)*p_name))
+                {
+                    p_name++;
+                }
+                const char *p_after = p_name;
+                while (_is_name_char(*p_after))
+                {
+                    p_after++;
+                }
+                name_length = p_after - p_name;
+                if (!name_length || !_is_type(p_name, name_length))
+                {
+                    break;
+                }
+                p_name = p_after;
+            }
+            const char *p_equal = p_name + name_length;
+            while ((*p_equal == ' ') || (*p_equal == '\t'))
+            {
+                p_equal++;
+            }
+            const char *p_end = (*p_equal == '=') ? strchr(p_equal, ';') : NULL;
+            if (name_length && p_end)
+            {
+                _define(p_sketch, p_name, name_length, p_equal + 1, p_end);
+            }
+            p = p_name + name_length;
+        }
+    }
+}
+
+/**
+ * @brief End the tone that sounds, at a time or at its own end if it comes first.
+ *
+ * @param p_sketch Pointer to the sketch
+ * @param at_ms Time
+ * @return true on success, false if out of memory
+ */
+static bool _sketch_stop(sketch_t *p_sketch, double at_ms)
+{
+    if (!p_sketch->playing)
+    {
+        return true;
+    }
+    p_sketch->playing = false;
+    double end_ms = fmin(at_ms, p_sketch->end_ms);
+    if (end_ms <= p_sketch->start_ms)
+    {
+        return true;
+    }
+    bool ok = true;
+    if (p_sketch->p_melody->num_notes)
+    {
+        ok = melody_import_add_note(p_sketch->p_melody, 0, p_sketch->start_ms - p_sketch->last_end_ms);
+    }
+    p_sketch->last_end_ms = end_ms;
+    return ok && melody_import_add_note(p_sketch->p_melody, p_sketch->frequency, end_ms - p_sketch->start_ms);
+}
+
+/**
+ * @brief Play a call of the sketch. The pins are not evaluated: a sketch has a single buzzer.
+ *
+ * @param p_sketch Pointer to the sketch
+ * @param p_function Name of the function
+ * @param pp_args Start of each argument
+ * @param pp_args_end End of each argument
+ * @param num_args Number of arguments
+ * @param pp_error Pointer to store the reason of an error
+ * @return true on success
+ */
+static bool _sketch_call(sketch_t *p_sketch, const char *p_function, const char *const *pp_args,
+                         const char *const *pp_args_end, uint32_t num_args, const char **pp_error)
+{
+    bool is_tone = !strcmp(p_function, "tone");
+    bool is_no_tone = !strcmp(p_function, "noTone");
+    if ((is_tone && (num_args != 2) && (num_args != 3)) || (!is_tone && (num_args != 1)))
+    {
+        *pp_error = "wrong number of arguments of tone(), noTone() or delay()";
+        return false;
+    }
+    double args[3];
+    for (uint32_t i = (is_tone ? 1 : 0); (i < num_args) && !is_no_tone; i++)
+    {
+        if (!_eval(p_sketch, pp_args[i], pp_args_end[i], &args[i]) || (args[i] < 0))
+        {
+            *pp_error = "an argument of tone() or delay() is not a constant";
+            return false;
+        }
+    }
+
+    if (is_tone || is_no_tone)
+    {
+        if (!_sketch_stop(p_sketch, p_sketch->now_ms))
+        {
+            *pp_error = "out of memory";
+            return false;
+        }
+        if (is_tone)
+        {
+            p_sketch->playing = true;
+            p_sketch->frequency = args[1];
+            p_sketch->start_ms = p_sketch->now_ms;
+            p_sketch->end_ms = (num_args == 3) ? p_sketch->now_ms + args[2] : INFINITY;
+        }
+    }
+    else
+    {
+        p_sketch->now_ms += !strcmp(p_function, "delay") ? args[0] : args[0] / 1000.0;
+    }
+    return true;
+}
+
+/* Public functions -----------------------------------------------------------*/
+melody_import_format_t melody_import_get_format(const char *p_path)
+{
+    const char *p_dot = strrchr(p_path, '.');
+    if (!p_dot || strchr(p_dot, '/'))
+    {
+        return MELODY_IMPORT_UNKNOWN;
+    }
+    if (!strcasecmp(p_dot, ".mid") || !strcasecmp(p_dot, ".midi"))
+    {
+        return MELODY_IMPORT_MIDI;
+    }
+    if (!strcasecmp(p_dot, ".rtttl") || !strcasecmp(p_dot, ".rtx") || !strcasecmp(p_dot, ".txt"))
+    {
+        return MELODY_IMPORT_RTTTL;
+    }
+    if (!strcasecmp(p_dot, ".ino"))
+    {
+        return MELODY_IMPORT_SKETCH;
+    }
+    return MELODY_IMPORT_UNKNOWN;
+}
+
+void melody_import_set_name(melody_import_t *p_melody, const char *p_text)
+{
+    uint32_t length = 0;
+    while (isspace((unsigned char)*p_text))
+    {
+        p_text++;
+    }
+    for (; *p_text && (*p_text != '.') && (*p_text != ':') && (length < MELODY_PACK_NAME_LENGTH - 1); p_text++)
+    {
+        p_melody->name[length++] = isalnum((unsigned char)*p_text) ? (char)tolower((unsigned char)*p_text) : '_';
+    }
+    p_melody->name[length] = '\0';
+    if (!length)
+    {
+        strcpy(p_melody->name, "melody");
+    }
+}
+
+bool melody_import_add_note(melody_import_t *p_melody, double frequency, double duration_ms)
+{
+    if (!(duration_ms > 0))
+    {
+        return true;
+    }
+    if ((frequency == 0) && p_melody->num_notes && (p_melody->p_notes[p_melody->num_notes - 1].frequency == 0))
+    {
+        p_melody->p_notes[p_melody->num_notes - 1].duration_ms += duration_ms;
+        return true;
+    }
+    if (!_grow((void **)&p_melody->p_notes, &p_melody->capacity, p_melody->num_notes, sizeof(melody_import_note_t)))
+    {
+        return false;
+    }
+    p_melody->p_notes[p_melody->num_notes++] = (melody_import_note_t){.frequency = frequency,
+                                                                      .duration_ms = duration_ms};
+    return true;
+}
+
+void melody_import_free(melody_import_t *p_melody)
+{
+    free(p_melody->p_notes);
+    p_melody->p_notes = NULL;
+    p_melody->num_notes = 0;
+    p_melody->capacity = 0;
+}
+
+bool melody_import_midi(const uint8_t *p_data, size_t size, melody_import_t *p_melody, const char **pp_error)
+{
+    if ((size < MIDI_HEADER_BYTES) || memcmp(p_data, "MThd", 4) || (_get_be(&p_data[4], 4) < 6))
+    {
+        *pp_error = "not a Standard MIDI File";
+        return false;
+    }
+    uint32_t format = _get_be(&p_data[8], 2);
+    uint32_t num_tracks = _get_be(&p_data[10], 2);
+    uint32_t division = _get_be(&p_data[12], 2);
+    if ((format > 1) || !num_tracks || !division)
+    {
+        *pp_error = "only MIDI files of format 0 and 1 are supported";
+        return false;
+    }
+    midi_t midi = {0};
+    if (division & 0x8000)
+    {
+        // SMPTE: frames per second (negative) and ticks per frame
+        int32_t fps = -(int8_t)(division >> 8);
+        uint32_t ticks_per_frame = division & 0xFF;
+        if ((fps <= 0) || !ticks_per_frame)
+        {
+            *pp_error = "wrong time division";
+            return false;
+        }
+        midi.ms_per_tick = 1000.0 / (fps * ticks_per_frame);
+    }
+    else
+    {
+        midi.ticks_per_quarter = division;
+    }
+
+    bool ok = true;
+    *pp_error = "corrupt track";
+    size_t position = 8 + _get_be(&p_data[4], 4);
+    uint32_t track = 0;
+    while (ok && (track < num_tracks) && (size - position >= 8))
+    {
+        uint32_t length = _get_be(&p_data[position + 4], 4);
+        if (length > size - position - 8)
+        {
+            ok = false;
+            break;
+        }
+        // Chunks other than tracks are skipped
+        if (!memcmp(&p_data[position], "MTrk", 4))
+        {
+            ok = _midi_track(&midi, &p_data[position + 8], &p_data[position + 8 + length], track++);
+        }
+        position += 8 + length;
+    }
+    if (ok && midi.ticks_per_quarter)
+    {
+        *pp_error = "out of memory";
+        ok = _midi_time_tempos(&midi);
+    }
+    uint32_t voice = ok ? _midi_dominant_voice(&midi, num_tracks) : UINT32_MAX;
+    if (ok && (voice == UINT32_MAX))
+    {
+        *pp_error = "no notes out of the drums";
+        ok = false;
+    }
+    if (ok)
+    {
+        *pp_error = "out of memory";
+        qsort(midi.p_notes, midi.num_notes, sizeof(midi_note_t), _compare_notes);
+        ok = _midi_skyline(&midi, voice, p_melody);
+    }
+    free(midi.p_notes);
+    free(midi.p_tempos);
+    return ok;
+}
+
+bool melody_import_rtttl(const char *p_text, melody_import_t *p_melody, const char **pp_error)
+{
+    const char *p_settings = strchr(p_text, ':');
+    const char *p_notes = p_settings ? strchr(p_settings + 1, ':') : NULL;
+    if (!p_notes)
+    {
+        *pp_error = "an RTTTL melody is name:settings:notes";
+        return false;
+    }
+    melody_import_set_name(p_melody, p_text);
+
+    uint32_t default_duration = RTTTL_DEFAULT_DURATION;
+    uint32_t default_octave = RTTTL_DEFAULT_OCTAVE;
+    uint32_t bpm = RTTTL_DEFAULT_BPM;
+    for (const char *p = p_settings + 1; p < p_notes;)
+    {
+        while ((p < p_notes) && ((*p == ' ') || (*p == ',')))
+        {
+            p++;
+        }
+        if (p >= p_notes)
+        {
+            break;
+        }
+        char key = (char)tolower((unsigned char)*p++);
+        while (*p == ' ')
+        {
+            p++;
+        }
+        char *p_after;
+        unsigned long value = (*p == '=') ? strtoul(p + 1, &p_after, 10) : 0;
+        if (!value || ((key != 'd') && (key != 'o') && (key != 'b')))
+        {
+            *pp_error = "wrong RTTTL settings";
+            return false;
+        }
+        *(key == 'd' ? &default_duration : (key == 'o' ? &default_octave : &bpm)) = (uint32_t)value;
+        p = p_after;
+    }
+
+    for (const char *p = p_notes + 1;;)
+    {
+        while ((*p == ' ') || (*p == ','))
+        {
+            p++;
+        }
+        if (!*p || (*p == '\r') || (*p == '\n'))
+        {
+            break;
+        }
+        char *p_after;
+        unsigned long duration = isdigit((unsigned char)*p) ? strtoul(p, &p_after, 10) : default_duration;
+        p = isdigit((unsigned char)*p) ? p_after : p;
+        char letter = (char)tolower((unsigned char)*p++);
+        int32_t semitone = _semitone(letter);
+        if (((semitone < 0) && (letter != 'p')) || !duration)
+        {
+            *pp_error = "wrong RTTTL note";
+            return false;
+        }
+        if (*p == '#')
+        {
+            semitone++;
+            p++;
+        }
+        bool dotted = false;
+        if (*p == '.')
+        {
+            dotted = true;
+            p++;
+        }
+        unsigned long octave = isdigit((unsigned char)*p) ? strtoul(p, &p_after, 10) : default_octave;
+        p = isdigit((unsigned char)*p) ? p_after : p;
+        if (*p == '.')
+        {
+            dotted = true;
+            p++;
+        }
+        if (*p && (*p != ',') && (*p != ' ') && (*p != '\r') && (*p != '\n'))
+        {
+            *pp_error = "wrong RTTTL note";
+            return false;
+        }
+        // A whole note lasts four beats
+        double duration_ms = 4 * 60000.0 / ((double)bpm * duration) * (dotted ? 1.5 : 1.0);
+        double frequency = (letter == 'p') ? 0 : _key_frequency(IMPORT_SEMITONES * ((int32_t)octave + 1) + semitone);
+        if (!melody_import_add_note(p_melody, frequency, duration_ms))
+        {
+            *pp_error = "out of memory";
+            return false;
+        }
+    }
+    if (!p_melody->num_notes)
+    {
+        *pp_error = "no notes";
+        return false;
+    }
+    return true;
+}
+
+bool melody_import_sketch(const char *p_text, melody_import_t *p_melody, const char **pp_error)
+{
+    char *p_code = strdup(p_text);
+    sketch_t *p_sketch = calloc(1, sizeof(sketch_t));
+    if (!p_code || !p_sketch)
+    {
+        free(p_code);
+        free(p_sketch);
+        *pp_error = "out of memory";
+        return false;
+    }
+    _strip(p_code);
+    _read_symbols(p_sketch, p_code);
+    p_sketch->p_melody = p_melody;
+
+    static const char *const functions[] = {"tone", "noTone", "delay", "delayMicroseconds"};
+    bool ok = true;
+    for (const char *p = p_code; ok && *p;)
+    {
+        if (!_is_name_char(*p))
+        {
+            p++;
+            continue;
+        }
+        const char *p_word = p;
+        while (_is_name_char(*p))
+        {
+            p++;
+        }
+        const char *p_function = NULL;
+        for (size_t i = 0; i < sizeof(functions) / sizeof(functions[0]); i++)
+        {
+            if ((strlen(functions[i]) == (size_t)(p - p_word)) && !strncmp(functions[i], p_word, p - p_word))
+            {
+                p_function = functions[i];
+            }
+        }
+        const char *p_open = p;
+        while (isspace((unsigned char)*p_open))
+        {
+            p_open++;
+        }
+        if (!p_function || (*p_open != '('))
+        {
+            continue;
+        }
+
+        // Arguments, split by the commas out of parentheses
+        const char *args[3];
+        const char *args_end[3];
+        uint32_t num_args = 0;
+        uint32_t depth = 0;
+        const char *p_arg = p_open + 1;
+        for (p = p_arg; *p; p++)
+        {
+            if (*p == '(')
+            {
+                depth++;
+            }
+            else if ((*p == ')') && depth)
+            {
+                depth--;
+            }
+            else if ((*p == ',') || (*p == ')'))
+            {
+                if (num_args < 3)
+                {
+                    args[num_args] = p_arg;
+                    args_end[num_args] = p;
+                }
+                num_args++;
+                p_arg = p + 1;
+                if (*p == ')')
+                {
+                    break;
+                }
+            }
+        }
+        if (*p != ')')
+        {
+            *pp_error = "unbalanced parentheses";
+            ok = false;
+        }
+        ok = ok && _sketch_call(p_sketch, p_function, args, args_end, num_args, pp_error);
+    }
+    if (ok && !_sketch_stop(p_sketch, p_sketch->now_ms))
+    {
+        *pp_error = "out of memory";
+        ok = false;
+    }
+    if (ok && !p_melody->num_notes)
+    {
+        *pp_error = "no calls to tone()";
+        ok = false;
+    }
+    free(p_sketch);
+    free(p_code);
+    return ok;
+}
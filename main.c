@@ -32,6 +32,8 @@
 
 #include "fsm_jukebox.h"
 
+#include "fsm_log.h"
+
 #include "fsm_nec.h"
 
 #include "port_lcd.h"
@@ -76,7 +78,9 @@ int main(void)
 
     fsm_t* p_fsm_user_buzzer = fsm_buzzer_new(BUZZER_0_ID);
 
-    fsm_t* p_fsm_user_jukebox = fsm_jukebox_new(p_fsm_user_button, ON_OFF_PRESS_TIME_MS, p_fsm_user_usart, p_fsm_user_buzzer, NEXT_SONG_BUTTON_TIME_MS);
+    fsm_t* p_fsm_log = fsm_log_new();
+
+    fsm_t* p_fsm_user_jukebox = fsm_jukebox_new(p_fsm_user_button, ON_OFF_PRESS_TIME_MS, p_fsm_user_usart, p_fsm_user_buzzer, NEXT_SONG_BUTTON_TIME_MS, p_fsm_log);
 
     /* Infinite loop */
     while (1)
@@ -86,6 +90,7 @@ int main(void)
         fsm_fire(p_fsm_user_usart);
         fsm_fire(p_fsm_user_buzzer);
         fsm_fire(p_fsm_user_jukebox);
+        fsm_fire(p_fsm_log);
 
     } // End of while(1)
     // Nunca deberíamos llegar aquí
@@ -0,0 +1,107 @@
+/**
+ * @file port_flash.h
+ * @brief Header for port_flash.c file (native platform).
+ *
+ * Flash sectors of the melody store (see melody_store.h) and of the settings (see settings_store.h), modeled in the
+ * RAM of each board. As on the STM32F4, they are written by halfwords, which can only clear bits, and erased as a
+ * whole; each operation charges its typical time to the virtual clock. The sectors can be backed by a file, so that
+ * they survive the process as they survive a reset of the board.
+ *
+ * The power can be cut after a number of operations, to test what a reset in the middle of a write leaves: the
+ * operation at the cut is left half done (the first byte of a halfword, the first half of a sector) and the later
+ * ones do nothing, until the board is reset with `port_sim_reset()`.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#ifndef PORT_FLASH_H_
+#define PORT_FLASH_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* HW dependent includes */
+#include "port_sim.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+/// @brief Bytes of the store, as the sector of the STM32F4 port
+#define PORT_FLASH_STORE_SIZE (128U * 1024U)
+
+/// @brief Sectors of the settings, as in the STM32F4 port
+#define PORT_FLASH_SETTINGS_SECTORS 2U
+
+/// @brief Bytes of each sector of the settings
+#define PORT_FLASH_SETTINGS_SIZE (128U * 1024U)
+
+/// @brief Value of an erased byte
+#define PORT_FLASH_ERASED 0xFFU
+
+/// @brief Time to program a halfword: 16 us (STM32F446 datasheet, typical)
+#define PORT_FLASH_PROGRAM_CYCLES (16U * (PORT_SIM_CORE_CLOCK_HZ / 1000000U))
+
+/// @brief Time to erase a 128 KB sector with x32 parallelism: 1 s (STM32F446 datasheet, typical)
+#define PORT_FLASH_ERASE_CYCLES PORT_SIM_CORE_CLOCK_HZ
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/// @brief Get the store of the selected board.
+/// @return Pointer to the first byte of the store
+const uint8_t *port_flash_get_store(void);
+
+/// @brief Erase the store: every byte becomes `PORT_FLASH_ERASED`.
+/// @return true
+bool port_flash_erase_store(void);
+
+/// @brief Program bytes of the store, a halfword at a time. Programming can only clear bits.
+/// @param offset Position in the store, even
+/// @param p_data Pointer to the data
+/// @param length Bytes to program, even
+/// @return true if programmed, false if out of the store or misaligned
+bool port_flash_program(uint32_t offset, const void *p_data, uint32_t length);
+
+/// @brief Get a sector of the settings of the selected board.
+/// @param sector Sector, from 0 to `PORT_FLASH_SETTINGS_SECTORS - 1`
+/// @return Pointer to the first byte of the sector
+const uint8_t *port_flash_get_settings(uint32_t sector);
+
+/// @brief Erase a sector of the settings: every byte becomes `PORT_FLASH_ERASED`.
+/// @param sector Sector, from 0 to `PORT_FLASH_SETTINGS_SECTORS - 1`
+/// @return true if erased, false if the sector does not exist or the power is cut
+bool port_flash_erase_settings(uint32_t sector);
+
+/// @brief Program bytes of a sector of the settings, a halfword at a time. Programming can only clear bits.
+/// @param sector Sector, from 0 to `PORT_FLASH_SETTINGS_SECTORS - 1`
+/// @param offset Position in the sector, even
+/// @param p_data Pointer to the data
+/// @param length Bytes to program, even
+/// @return true if programmed, false if out of the sector, misaligned or the power is cut
+bool port_flash_program_settings(uint32_t sector, uint32_t offset, const void *p_data, uint32_t length);
+
+/// @brief Back the flash of the selected board by a file: the store, then the sectors of the settings. A file of that
+/// size is loaded; otherwise it is created with the current content. Every later erase and program is written through.
+/// @param p_path Path of the file, or NULL to close the current one
+/// @return true if the file could be opened or created
+bool port_flash_set_file(const char *p_path);
+
+/// @brief Get the virtual time spent erasing and programming the flash of the selected board.
+/// @return Core clock cycles
+uint64_t port_flash_get_busy_cycles(void);
+
+/// @brief Get the sectors erased in the selected board, the store and the settings.
+/// @return Erases since the last reset
+uint32_t port_flash_get_erases(void);
+
+/// @brief Cut the power of the selected board in the middle of an operation, a halfword program or a sector erase: a
+/// cut program only writes the low byte, and a cut erase the first half of the sector. Nothing changes after it.
+/// @param operations Operations until the cut one, included, or 0 to never cut it
+void port_flash_cut_power(uint32_t operations);
+
+/// @brief Check if the power of the selected board has been cut.
+/// @return true if the flash no longer changes
+bool port_flash_is_power_cut(void);
+
+#endif /* PORT_FLASH_H_ */
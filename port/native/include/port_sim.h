@@ -0,0 +1,506 @@
+/**
+ * @file port_sim.h
+ * @brief Header for port_sim.c file.
+ *
+ * Register model of the STM32F446RE peripherals used by the port layer, driven by a discrete-event virtual clock.
+ * Time only advances when the simulated CPU polls a peripheral, waits for an interrupt or when the simulation harness
+ * jumps to the next pending event, so long runs take a fraction of their real duration.
+ *
+ * Every simulated board is a context (`port_sim_ctx_t`): registers, virtual clock, peripheral models and the state of
+ * the drivers. Each thread works on the context it selected with port_sim_ctx_select(), or on a default one created on
+ * first use, so independent boards can run in parallel threads with the drivers and ISRs unchanged.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#ifndef PORT_SIM_H_
+#define PORT_SIM_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+/// @brief Frequency of the simulated core clock (HSI) in Hz
+#define PORT_SIM_CORE_CLOCK_HZ 16000000U
+
+/// @brief Cycles charged to the virtual clock each time the CPU polls a peripheral flag
+#define PORT_SIM_POLL_CYCLES 16U
+
+/// @brief Maximum number of scripted events that can be pending at the same time
+#define PORT_SIM_MAX_EVENTS 512U
+
+/// @brief Maximum number of drivers that keep state in a context (see port_sim_ctx_state())
+#define PORT_SIM_MAX_STATES 8U
+
+/// @brief Number of NVIC interrupt lines modeled
+#define PORT_SIM_NVIC_LINES 96U
+
+/// @brief Time value meaning "no pending event"
+#define PORT_SIM_NEVER UINT64_MAX
+
+/// @brief Convert milliseconds to core clock cycles
+#define PORT_SIM_MS_TO_CYCLES(ms) ((uint64_t)(ms) * (PORT_SIM_CORE_CLOCK_HZ / 1000U))
+
+/// @brief Convert core clock cycles to microseconds
+#define PORT_SIM_CYCLES_TO_US(c) ((c) / (PORT_SIM_CORE_CLOCK_HZ / 1000000U))
+
+/* Interrupt numbers (same values as in stm32f446xx.h) */
+/// @brief Interrupt lines of the modeled peripherals
+typedef enum
+{
+    SysTick_IRQn = -1,     /*!< System tick exception */
+    EXTI0_IRQn = 6,        /*!< EXTI line 0 */
+    DMA1_Stream1_IRQn = 12, /*!< DMA1 stream 1 global interrupt */
+    DMA1_Stream3_IRQn = 14, /*!< DMA1 stream 3 global interrupt */
+    EXTI9_5_IRQn = 23,     /*!< EXTI lines 5 to 9 */
+    TIM1_UP_TIM10_IRQn = 25, /*!< TIM1 update and TIM10 global interrupt */
+    TIM2_IRQn = 28,        /*!< TIM2 global interrupt */
+    TIM3_IRQn = 29,        /*!< TIM3 global interrupt */
+    TIM4_IRQn = 30,        /*!< TIM4 global interrupt */
+    USART1_IRQn = 37,      /*!< USART1 global interrupt */
+    USART3_IRQn = 39,      /*!< USART3 global interrupt */
+    EXTI15_10_IRQn = 40,   /*!< EXTI lines 10 to 15 */
+    TIM8_UP_TIM13_IRQn = 44, /*!< TIM8 update and TIM13 global interrupt */
+    TIM5_IRQn = 50,        /*!< TIM5 global interrupt */
+    USART6_IRQn = 71       /*!< USART6 global interrupt */
+} IRQn_Type;
+
+/* Register bits (same names and positions as in stm32f446xx.h) */
+#define TIM_CR1_CEN (1U << 0)       /*!< Counter enable */
+#define TIM_CR1_ARPE (1U << 7)      /*!< Auto-reload preload enable */
+#define TIM_CR2_MMS (7U << 4)       /*!< Master mode selection */
+#define TIM_CR2_MMS_0 (1U << 4)     /*!< Master mode 001: the counter enable is the trigger output (TRGO) */
+#define TIM_SMCR_SMS (7U << 0)      /*!< Slave mode selection */
+#define TIM_SMCR_SMS_1 (1U << 1)    /*!< Slave mode bit 1 */
+#define TIM_SMCR_SMS_2 (1U << 2)    /*!< Slave mode bit 2: with bit 1, trigger mode (110) */
+#define TIM_SMCR_TS (7U << 4)       /*!< Trigger selection */
+#define TIM_SMCR_TS_0 (1U << 4)     /*!< Trigger selection 001: internal trigger 1 (ITR1) */
+#define TIM_DIER_UIE (1U << 0)      /*!< Update interrupt enable */
+#define TIM_SR_UIF (1U << 0)        /*!< Update interrupt flag */
+#define TIM_EGR_UG (1U << 0)        /*!< Update generation */
+#define TIM_CCMR1_OC1PE (1U << 3)   /*!< Output compare 1 preload enable */
+#define TIM_CCER_CC1E (1U << 0)     /*!< Capture/compare 1 output enable */
+#define TIM_BDTR_MOE (1U << 15)     /*!< Main output enable, only in the advanced timers TIM1 and TIM8 */
+
+#define USART_SR_ORE (1U << 3)      /*!< Overrun error */
+#define USART_SR_IDLE (1U << 4)     /*!< Idle line detected */
+#define USART_SR_RXNE (1U << 5)     /*!< Read data register not empty */
+#define USART_SR_TC (1U << 6)       /*!< Transmission complete */
+#define USART_SR_TXE (1U << 7)      /*!< Transmit data register empty */
+#define USART_CR1_RE (1U << 2)      /*!< Receiver enable */
+#define USART_CR1_TE (1U << 3)      /*!< Transmitter enable */
+#define USART_CR1_IDLEIE (1U << 4)  /*!< IDLE interrupt enable */
+#define USART_CR1_RXNEIE (1U << 5)  /*!< RXNE interrupt enable */
+#define USART_CR1_TCIE (1U << 6)    /*!< Transmission complete interrupt enable */
+#define USART_CR1_TXEIE (1U << 7)   /*!< TXE interrupt enable */
+#define USART_CR1_PCE (1U << 10)    /*!< Parity control enable */
+#define USART_CR1_M (1U << 12)      /*!< Word length */
+#define USART_CR1_UE (1U << 13)     /*!< USART enable */
+#define USART_CR1_OVER8 (1U << 15)  /*!< Oversampling mode */
+#define USART_CR2_STOP (3U << 12)   /*!< Stop bits */
+#define USART_CR3_DMAR (1U << 6)    /*!< DMA enable receiver */
+
+#define DMA_SxCR_EN (1U << 0)           /*!< Stream enable */
+#define DMA_SxCR_HTIE (1U << 3)         /*!< Half transfer interrupt enable */
+#define DMA_SxCR_TCIE (1U << 4)         /*!< Transfer complete interrupt enable */
+#define DMA_SxCR_DIR (3U << 6)          /*!< Data transfer direction (00: peripheral to memory) */
+#define DMA_SxCR_CIRC (1U << 8)         /*!< Circular mode */
+#define DMA_SxCR_MINC (1U << 10)        /*!< Memory increment mode */
+#define DMA_SxCR_CHSEL_Pos 25U          /*!< Channel selection */
+#define DMA_SxCR_CHSEL (7U << 25)       /*!< Channel selection */
+#define DMA_LISR_HTIF1 (1U << 10)       /*!< Stream 1 half transfer interrupt flag */
+#define DMA_LISR_TCIF1 (1U << 11)       /*!< Stream 1 transfer complete interrupt flag */
+#define DMA_LIFCR_CHTIF1 (1U << 10)     /*!< Stream 1 clear half transfer interrupt flag */
+#define DMA_LIFCR_CTCIF1 (1U << 11)     /*!< Stream 1 clear transfer complete interrupt flag */
+#define DMA_LISR_TCIF3 (1U << 27)       /*!< Stream 3 transfer complete interrupt flag */
+#define DMA_LIFCR_CTCIF3 (1U << 27)     /*!< Stream 3 clear transfer complete interrupt flag */
+
+#define RCC_AHB1ENR_GPIOAEN (1U << 0)   /*!< GPIOA clock enable */
+#define RCC_AHB1ENR_GPIOBEN (1U << 1)   /*!< GPIOB clock enable */
+#define RCC_AHB1ENR_GPIOCEN (1U << 2)   /*!< GPIOC clock enable */
+#define RCC_AHB1ENR_DMA1EN (1U << 21)   /*!< DMA1 clock enable */
+#define RCC_APB1ENR_TIM2EN (1U << 0)    /*!< TIM2 clock enable */
+#define RCC_APB1ENR_TIM3EN (1U << 1)    /*!< TIM3 clock enable */
+#define RCC_APB1ENR_TIM4EN (1U << 2)    /*!< TIM4 clock enable */
+#define RCC_APB1ENR_TIM5EN (1U << 3)    /*!< TIM5 clock enable */
+#define RCC_APB1ENR_USART3EN (1U << 18) /*!< USART3 clock enable */
+#define RCC_APB2ENR_TIM1EN (1U << 0)    /*!< TIM1 clock enable */
+#define RCC_APB2ENR_TIM8EN (1U << 1)    /*!< TIM8 clock enable */
+#define RCC_APB2ENR_USART1EN (1U << 4)  /*!< USART1 clock enable */
+#define RCC_APB2ENR_USART6EN (1U << 5)  /*!< USART6 clock enable */
+#define RCC_APB2ENR_SYSCFGEN (1U << 14) /*!< SYSCFG clock enable */
+#define RCC_CFGR_PPRE1_Pos 10U          /*!< APB1 prescaler position */
+#define RCC_CFGR_PPRE1 (7U << 10)       /*!< APB1 prescaler */
+#define RCC_CFGR_PPRE2_Pos 13U          /*!< APB2 prescaler position */
+#define RCC_CFGR_PPRE2 (7U << 13)       /*!< APB2 prescaler */
+
+#define SysTick_CTRL_ENABLE_Msk (1U << 0)   /*!< SysTick counter enable */
+#define SysTick_CTRL_TICKINT_Msk (1U << 1)  /*!< SysTick exception request enable */
+
+/* Typedefs --------------------------------------------------------------------*/
+/// @brief Model of a GPIO port
+typedef struct
+{
+    volatile uint32_t MODER;    /*!< Mode register */
+    volatile uint32_t OTYPER;   /*!< Output type register */
+    volatile uint32_t OSPEEDR;  /*!< Output speed register */
+    volatile uint32_t PUPDR;    /*!< Pull-up/pull-down register */
+    volatile uint32_t IDR;      /*!< Input data register */
+    volatile uint32_t ODR;      /*!< Output data register */
+    volatile uint32_t BSRR;     /*!< Bit set/reset register */
+    volatile uint32_t LCKR;     /*!< Configuration lock register */
+    volatile uint32_t AFR[2];   /*!< Alternate function registers */
+} GPIO_TypeDef;
+
+/// @brief Model of a general purpose timer
+typedef struct
+{
+    volatile uint32_t CR1;      /*!< Control register 1 */
+    volatile uint32_t CR2;      /*!< Control register 2 */
+    volatile uint32_t SMCR;     /*!< Slave mode control register */
+    volatile uint32_t DIER;     /*!< DMA/interrupt enable register */
+    volatile uint32_t SR;       /*!< Status register */
+    volatile uint32_t EGR;      /*!< Event generation register */
+    volatile uint32_t CCMR1;    /*!< Capture/compare mode register 1 */
+    volatile uint32_t CCMR2;    /*!< Capture/compare mode register 2 */
+    volatile uint32_t CCER;     /*!< Capture/compare enable register */
+    volatile uint32_t CNT;      /*!< Counter */
+    volatile uint32_t PSC;      /*!< Prescaler */
+    volatile uint32_t ARR;      /*!< Auto-reload register */
+    volatile uint32_t RCR;      /*!< Repetition counter register */
+    volatile uint32_t CCR1;     /*!< Capture/compare register 1 */
+    volatile uint32_t CCR2;     /*!< Capture/compare register 2 */
+    volatile uint32_t CCR3;     /*!< Capture/compare register 3 */
+    volatile uint32_t CCR4;     /*!< Capture/compare register 4 */
+    volatile uint32_t BDTR;     /*!< Break and dead-time register, only in the advanced timers */
+} TIM_TypeDef;
+
+/// @brief Model of a USART
+typedef struct
+{
+    volatile uint32_t SR;       /*!< Status register */
+    volatile uint32_t DR;       /*!< Data register */
+    volatile uint32_t BRR;      /*!< Baud rate register */
+    volatile uint32_t CR1;      /*!< Control register 1 */
+    volatile uint32_t CR2;      /*!< Control register 2 */
+    volatile uint32_t CR3;      /*!< Control register 3 */
+    volatile uint32_t GTPR;     /*!< Guard time and prescaler register */
+} USART_TypeDef;
+
+/// @brief Model of a DMA stream. The address registers hold host pointers, so they are as wide as a pointer
+typedef struct
+{
+    volatile uint32_t CR;       /*!< Configuration register */
+    volatile uint32_t NDTR;     /*!< Number of data items left to transfer */
+    volatile uintptr_t PAR;     /*!< Peripheral address register */
+    volatile uintptr_t M0AR;    /*!< Memory 0 address register */
+    volatile uintptr_t M1AR;    /*!< Memory 1 address register */
+    volatile uint32_t FCR;      /*!< FIFO control register */
+} DMA_Stream_TypeDef;
+
+/// @brief Model of the interrupt registers of a DMA controller
+typedef struct
+{
+    volatile uint32_t LISR;     /*!< Low interrupt status register (streams 0 to 3) */
+    volatile uint32_t HISR;     /*!< High interrupt status register (streams 4 to 7) */
+    volatile uint32_t LIFCR;    /*!< Low interrupt flag clear register */
+    volatile uint32_t HIFCR;    /*!< High interrupt flag clear register */
+} DMA_TypeDef;
+
+/// @brief Model of the external interrupt controller
+typedef struct
+{
+    volatile uint32_t IMR;      /*!< Interrupt mask register */
+    volatile uint32_t EMR;      /*!< Event mask register */
+    volatile uint32_t RTSR;     /*!< Rising trigger selection register */
+    volatile uint32_t FTSR;     /*!< Falling trigger selection register */
+    volatile uint32_t SWIER;    /*!< Software interrupt event register */
+    volatile uint32_t PR;       /*!< Pending register */
+} EXTI_TypeDef;
+
+/// @brief Model of the reset and clock control registers touched by the drivers
+typedef struct
+{
+    volatile uint32_t CFGR;     /*!< Clock configuration register: out of reset every bus runs at the core clock */
+    volatile uint32_t AHB1ENR;  /*!< AHB1 peripheral clock enable register */
+    volatile uint32_t APB1ENR;  /*!< APB1 peripheral clock enable register */
+    volatile uint32_t APB2ENR;  /*!< APB2 peripheral clock enable register */
+} RCC_TypeDef;
+
+/// @brief Model of the SysTick timer
+typedef struct
+{
+    volatile uint32_t CTRL;     /*!< Control and status register */
+    volatile uint32_t LOAD;     /*!< Reload value register */
+    volatile uint32_t VAL;      /*!< Current value register */
+} SysTick_Type;
+
+/// @brief Peripheral registers of a simulated board
+typedef struct
+{
+    GPIO_TypeDef gpioa;     /*!< GPIOA model */
+    GPIO_TypeDef gpiob;     /*!< GPIOB model */
+    GPIO_TypeDef gpioc;     /*!< GPIOC model */
+    TIM_TypeDef tim1;       /*!< TIM1 model */
+    TIM_TypeDef tim2;       /*!< TIM2 model */
+    TIM_TypeDef tim3;       /*!< TIM3 model */
+    TIM_TypeDef tim4;       /*!< TIM4 model */
+    TIM_TypeDef tim5;       /*!< TIM5 model */
+    TIM_TypeDef tim8;       /*!< TIM8 model */
+    USART_TypeDef usart1;   /*!< USART1 model */
+    USART_TypeDef usart3;   /*!< USART3 model */
+    USART_TypeDef usart6;   /*!< USART6 model */
+    DMA_TypeDef dma1;       /*!< DMA1 interrupt registers */
+    DMA_Stream_TypeDef dma1_stream[8]; /*!< DMA1 streams */
+    EXTI_TypeDef exti;      /*!< EXTI model */
+    RCC_TypeDef rcc;        /*!< RCC model */
+    SysTick_Type systick;   /*!< SysTick model */
+} port_sim_regs_t;
+
+/// @brief Simulated board: registers, virtual clock, peripheral models and state of the drivers
+typedef struct port_sim_ctx port_sim_ctx_t;
+
+/// @brief State that a driver keeps in every context, created and initialized on first use in each context
+typedef struct
+{
+    size_t size;                    /*!< Bytes of state */
+    void (*init)(void *p_state);    /*!< Initialization, called with the owning context selected (may be NULL) */
+} port_sim_state_t;
+
+/// @brief Callback of a scripted event
+typedef void (*port_sim_event_cb_t)(void *p_arg, uint32_t data);
+
+/// @brief Callback invoked for every byte that leaves a USART TX line
+typedef void (*port_sim_usart_tx_cb_t)(void *p_arg, USART_TypeDef *p_usart, uint8_t byte, uint64_t cycles);
+
+/// @brief Callback invoked when the CPU waits for an interrupt and no event is left that could raise one
+typedef void (*port_sim_idle_cb_t)(void *p_arg);
+
+/* Peripheral instances of the selected context (same names as in stm32f446xx.h) */
+#define GPIOA (&port_sim_regs()->gpioa)     /*!< GPIOA instance */
+#define GPIOB (&port_sim_regs()->gpiob)     /*!< GPIOB instance */
+#define GPIOC (&port_sim_regs()->gpioc)     /*!< GPIOC instance */
+#define TIM1 (&port_sim_regs()->tim1)       /*!< TIM1 instance */
+#define TIM2 (&port_sim_regs()->tim2)       /*!< TIM2 instance */
+#define TIM3 (&port_sim_regs()->tim3)       /*!< TIM3 instance */
+#define TIM4 (&port_sim_regs()->tim4)       /*!< TIM4 instance */
+#define TIM5 (&port_sim_regs()->tim5)       /*!< TIM5 instance */
+#define TIM8 (&port_sim_regs()->tim8)       /*!< TIM8 instance */
+#define USART1 (&port_sim_regs()->usart1)   /*!< USART1 instance */
+#define USART3 (&port_sim_regs()->usart3)   /*!< USART3 instance */
+#define USART6 (&port_sim_regs()->usart6)   /*!< USART6 instance */
+#define DMA1 (&port_sim_regs()->dma1)       /*!< DMA1 instance */
+#define DMA1_Stream1 (&port_sim_regs()->dma1_stream[1]) /*!< DMA1 stream 1 instance */
+#define DMA1_Stream3 (&port_sim_regs()->dma1_stream[3]) /*!< DMA1 stream 3 instance */
+#define EXTI (&port_sim_regs()->exti)       /*!< EXTI instance */
+#define RCC (&port_sim_regs()->rcc)         /*!< RCC instance */
+#define SysTick (&port_sim_regs()->systick) /*!< SysTick instance */
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/// @brief Create a board out of reset
+/// @return Pointer to the new context, NULL if out of memory
+port_sim_ctx_t *port_sim_ctx_new(void);
+
+/// @brief Destroy a board. It must not be selected in any thread
+/// @param p_ctx Context
+void port_sim_ctx_destroy(port_sim_ctx_t *p_ctx);
+
+/// @brief Select the board that the calling thread works on
+/// @param p_ctx Context, or NULL for the default context of the thread
+void port_sim_ctx_select(port_sim_ctx_t *p_ctx);
+
+/// @brief Get the board selected by the calling thread
+/// @return Pointer to the context
+port_sim_ctx_t *port_sim_ctx_current(void);
+
+/// @brief Get the registers of the board selected by the calling thread
+/// @return Pointer to the registers
+port_sim_regs_t *port_sim_regs(void);
+
+/// @brief Get the state of a driver in the board selected by the calling thread
+/// @param p_desc Descriptor of the state. Its address identifies the driver
+/// @return Pointer to the state, zero-filled and initialized the first time
+void *port_sim_ctx_state(const port_sim_state_t *p_desc);
+
+/// @brief Reset the virtual clock, the pending events, every peripheral model and the state of the drivers
+void port_sim_reset(void);
+
+/// @brief Get the virtual time
+/// @return Core clock cycles elapsed since the last reset
+uint64_t port_sim_get_cycles(void);
+
+/// @brief Get the time spent by the CPU waiting for interrupts
+/// @return Core clock cycles spent in sleep mode since the last reset
+uint64_t port_sim_get_sleep_cycles(void);
+
+/// @brief Get the number of interrupt service routines served
+/// @return ISRs served since the last reset
+uint32_t port_sim_get_isr_count(void);
+
+/// @brief Get the number of times an interrupt woke the CPU out of port_sim_wait_for_interrupt()
+/// @return Wakeups since the last reset
+uint32_t port_sim_get_wakeups(void);
+
+/// @brief Get the number of times the handler of an interrupt line ran
+/// @param irq Interrupt number (not the SysTick)
+/// @return ISRs of the line since the last reset
+uint32_t port_sim_get_irq_count(IRQn_Type irq);
+
+/// @brief Get the CPU time spent in the handler of an interrupt line: entry and exit plus what the handler charges
+/// @param irq Interrupt number (not the SysTick)
+/// @return Core clock cycles since the last reset
+uint64_t port_sim_get_irq_cycles(IRQn_Type irq);
+
+/// @brief Register the function called when the CPU sleeps and nothing is left to wake it up
+/// @param cb Callback (NULL to end the process, the default)
+/// @param p_arg Pointer passed to the callback
+void port_sim_set_idle_hook(port_sim_idle_cb_t cb, void *p_arg);
+
+/// @brief Report that the CPU sleeps with nothing left to wake it up. Calls the idle hook or ends the process
+void port_sim_idle(void);
+
+/// @brief Charge CPU time to the virtual clock, serving the interrupts that become due meanwhile
+/// @param cycles Core clock cycles spent by the CPU
+void port_sim_run_cpu(uint32_t cycles);
+
+/// @brief Model the `WFI` instruction: jump to the next event that raises an enabled interrupt and serve it
+/// @param limit Virtual time at which to give up waiting
+/// @return true if an interrupt woke the CPU, false if nothing happened before `limit`
+bool port_sim_wait_for_interrupt(uint64_t limit);
+
+/// @brief Advance the virtual clock to a given time, serving every event and interrupt due until then
+/// @param cycles Target virtual time
+void port_sim_advance_to(uint64_t cycles);
+
+/// @brief Get the time of the next peripheral event other than the SysTick
+/// @return Virtual time of the next event, or `PORT_SIM_NEVER`
+uint64_t port_sim_next_event(void);
+
+/// @brief Schedule a callback at a given virtual time
+/// @param cycles Virtual time of the event
+/// @param cb Callback to run
+/// @param p_arg Pointer passed to the callback
+/// @param data Value passed to the callback
+/// @return true if the event was queued, false if the queue is full
+bool port_sim_schedule(uint64_t cycles, port_sim_event_cb_t cb, void *p_arg, uint32_t data);
+
+/// @brief Set an interrupt line as pending. It is served as soon as it is enabled and the CPU is not in an ISR
+/// @param irq Interrupt number
+void port_sim_nvic_set_pending(IRQn_Type irq);
+
+/// @brief Serve the pending and enabled interrupts
+void port_sim_nvic_dispatch(void);
+
+/// @brief Check if the CPU is executing an interrupt service routine
+/// @return true if inside an ISR
+bool port_sim_in_isr(void);
+
+/// @brief Check if the CPU is stopped in port_sim_wait_for_interrupt()
+/// @return true while events are processed on behalf of a sleeping CPU
+bool port_sim_is_sleeping(void);
+
+/// @brief Select the GPIO port connected to an EXTI line (SYSCFG_EXTICR model)
+/// @param p_port GPIO port
+/// @param pin Pin/line (0 to 15)
+void port_sim_exti_set_source(GPIO_TypeDef *p_port, uint8_t pin);
+
+/// @brief Drive the level of an input pin from outside the MCU. Raises the EXTI line if configured for that edge
+/// @param p_port GPIO port
+/// @param pin Pin/line (0 to 15)
+/// @param level New level of the pin
+void port_sim_gpio_set_input(GPIO_TypeDef *p_port, uint8_t pin, bool level);
+
+/// @brief Reconcile the timer model with its registers after the driver wrote them (enable, `UG`, stop). A timer whose
+/// counter enable is its trigger output (`MMS` 001) starts, as it starts, the timers in trigger mode (`SMS` 110) that
+/// select it as their internal trigger.
+/// @param p_tim Timer instance
+void port_sim_tim_sync(TIM_TypeDef *p_tim);
+
+/// @brief Get the virtual time at which the counter of a timer was last started or restarted from 0
+/// @param p_tim Timer instance
+/// @return Virtual time in core clock cycles, 0 if it never started
+uint64_t port_sim_tim_get_start_cycles(TIM_TypeDef *p_tim);
+
+/// @brief Get the frequency of the PWM output of a timer
+/// @param p_tim Timer instance
+/// @return Output frequency in Hz, 0 if the timer or its channel 1 output are disabled, or the main output of an
+/// advanced timer
+double port_sim_tim_get_output_hz(TIM_TypeDef *p_tim);
+
+/// @brief Model a CPU write to the data register of a USART (TX)
+/// @param p_usart USART instance
+/// @param byte Byte to send
+void port_sim_usart_write_dr(USART_TypeDef *p_usart, uint8_t byte);
+
+/// @brief Model a CPU read of the data register of a USART (RX). Clears RXNE
+/// @param p_usart USART instance
+/// @return Last byte received
+uint8_t port_sim_usart_read_dr(USART_TypeDef *p_usart);
+
+/// @brief Reconcile the USART model after the driver changed its interrupt enables
+/// @param p_usart USART instance
+void port_sim_usart_sync(USART_TypeDef *p_usart);
+
+/// @brief Get the duration of a frame (start + 8 data + stop bits) at the configured baud rate
+/// @param p_usart USART instance
+/// @return Core clock cycles per byte
+uint32_t port_sim_usart_byte_cycles(USART_TypeDef *p_usart);
+
+/// @brief Schedule bytes arriving on the RX line of a USART, back to back at the configured baud rate
+/// @param p_usart USART instance
+/// @param p_data Bytes to receive
+/// @param length Number of bytes
+/// @param cycles Virtual time at which the first byte is complete
+/// @return Virtual time at which the last byte is complete
+uint64_t port_sim_usart_inject(USART_TypeDef *p_usart, const uint8_t *p_data, size_t length, uint64_t cycles);
+
+/// @brief Register the function that receives every byte transmitted by the USARTs
+/// @param cb Callback (NULL to discard the output)
+/// @param p_arg Pointer passed to the callback
+void port_sim_usart_set_tx_hook(port_sim_usart_tx_cb_t cb, void *p_arg);
+
+/// @brief Configure the SysTick to interrupt every `ticks` core clock cycles
+/// @param ticks Reload value plus one
+/// @return 0 on success
+uint32_t SysTick_Config(uint32_t ticks);
+
+/// @brief Enable an interrupt line
+/// @param irq Interrupt number
+void NVIC_EnableIRQ(IRQn_Type irq);
+
+/// @brief Disable an interrupt line
+/// @param irq Interrupt number
+void NVIC_DisableIRQ(IRQn_Type irq);
+
+/// @brief Set the priority of an interrupt line (not modeled: interrupts are served in number order)
+/// @param irq Interrupt number
+/// @param priority Encoded priority
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority);
+
+/// @brief Get the priority of an interrupt line
+/// @param irq Interrupt number
+/// @return Encoded priority
+uint32_t NVIC_GetPriority(IRQn_Type irq);
+
+/// @brief Set the priority grouping
+/// @param group Priority group
+void NVIC_SetPriorityGrouping(uint32_t group);
+
+/// @brief Get the priority grouping
+/// @return Priority group
+uint32_t NVIC_GetPriorityGrouping(void);
+
+/// @brief Encode a preemption priority and subpriority
+/// @param group Priority group
+/// @param preempt Preemption priority
+/// @param sub Subpriority
+/// @return Encoded priority
+uint32_t NVIC_EncodePriority(uint32_t group, uint32_t preempt, uint32_t sub);
+
+#endif /* PORT_SIM_H_ */
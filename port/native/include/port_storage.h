@@ -0,0 +1,75 @@
+/**
+ * @file port_storage.h
+ * @brief Header for port_storage.c file (native platform).
+ *
+ * External storage of the streamed melodies (see melody_stream.h), backed by a file. As the SPI flash of the STM32F4
+ * port, a read takes the time of the command, the address and the data on a `PORT_STORAGE_SPI_HZ` clock, plus an
+ * access time that can be raised to model a slower device (an SD card); the data are copied into the buffer and the
+ * transfer complete flag of the reception stream is raised at the end of that time.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#ifndef PORT_STORAGE_H_
+#define PORT_STORAGE_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* HW dependent includes */
+#include "port_sim.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define PORT_STORAGE_SPI_HZ 4000000U        /*!< Clock of the SPI: PCLK1 / 4, as the STM32F4 port */
+#define PORT_STORAGE_COMMAND_BYTES 4U       /*!< READ command and 24-bit address */
+#define STORAGE_DMA_RX DMA1_Stream3         /*!< DMA stream of the reception, as the STM32F4 port */
+#define STORAGE_DMA_IRQ DMA1_Stream3_IRQn   /*!< Interrupt of the end of a read */
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/// @brief Enable the interrupt of the end of a read.
+void port_storage_init(void);
+
+/// @brief Get the size of the storage of the selected board.
+/// @return Bytes of its file, 0 without file
+uint32_t port_storage_get_size(void);
+
+/// @brief Start reading the storage. The data are complete once port_storage_is_busy() returns false.
+/// @param address Position of the first byte
+/// @param p_data Pointer to the buffer, that must stay valid until the end of the read
+/// @param length Bytes to read, from 1 to 65535
+/// @return true if the read started, false if another one is in progress or it is out of the storage
+bool port_storage_start_read(uint32_t address, void *p_data, uint32_t length);
+
+/// @brief Read the storage and wait for the end of the read, after the one in progress. The time is charged to the CPU.
+/// @param address Position of the first byte
+/// @param p_data Pointer to the buffer
+/// @param length Bytes to read, from 1 to 65535
+/// @return true if read, false if it is out of the storage
+bool port_storage_read(uint32_t address, void *p_data, uint32_t length);
+
+/// @brief Check if a read is in progress.
+/// @return true until the interrupt of the end of the read
+bool port_storage_is_busy(void);
+
+/// @brief End a read. Called by the interrupt of the end of a read.
+void port_storage_end_read(void);
+
+/// @brief Back the storage of the selected board by a file, read only.
+/// @param p_path Path of the file, or NULL to close the current one
+/// @return true if the file could be opened
+bool port_storage_set_file(const char *p_path);
+
+/// @brief Set the time from the command to the first byte, to model slower devices.
+/// @param cycles Core clock cycles (0 by default, as a NOR flash)
+void port_storage_set_access_cycles(uint32_t cycles);
+
+/// @brief Get the number of reads of the selected board.
+/// @return Reads since the last reset
+uint32_t port_storage_get_reads(void);
+
+#endif /* PORT_STORAGE_H_ */
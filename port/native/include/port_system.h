@@ -0,0 +1,253 @@
+/**
+ * @file port_system.h
+ * @brief Header for port_system.c file (native platform).
+ *
+ * Same API as the STM32F4 port. The peripherals are the register models of `port_sim.h`, so the common code and the
+ * interrupt service routines of `interr.c` build unchanged on the host.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+#ifndef PORT_SYSTEM_H_
+#define PORT_SYSTEM_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* HW dependent includes */
+#include "port_sim.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define BIT_POS_TO_MASK(x) (0x01 << (x))                                                                /*!< Convert the index of a bit into a mask by left shifting */
+#define BASE_MASK_TO_POS(m, p) ((m) << (p))                                                             /*!< Move a mask defined in the LSBs to upper positions by shifting left p bits */
+#define GET_PIN_IRQN(pin) (pin >= 10 ? EXTI15_10_IRQn : (pin >= 5 ? EXTI9_5_IRQn : (EXTI0_IRQn + pin))) /*!< Compute the IRQ number associated to a GPIO pin */
+
+/* Timer configuration */
+#define TICK_FREQ_1KHZ 1U                            /*!< Freqency in kHz of the System tick */
+#define NVIC_PRIORITY_GROUP_0 ((uint32_t)0x00000007) /*!< 0 bit  for pre-emption priority, \
+                                                         4 bits for subpriority */
+#define NVIC_PRIORITY_GROUP_4 ((uint32_t)0x00000003) /*!< 4 bits for pre-emption priority, \
+                                                         0 bit  for subpriority */
+
+/* GPIOs */
+#define HIGH true /*!< Logic 1 */
+#define LOW false /*!< Logic 0 */
+
+#define GPIO_MODE_IN 0x00        /*!< GPIO as input */
+#define GPIO_MODE_OUT 0x01       /*!< GPIO as output */
+#define GPIO_MODE_ALTERNATE 0x02 /*!< GPIO as alternate function */
+#define GPIO_MODE_ANALOG 0x03    /*!< GPIO as analog */
+
+#define GPIO_PUPDR_NOPULL 0x00 /*!< GPIO no pull up or down */
+#define GPIO_PUPDR_PUP 0x01    /*!< GPIO pull up */
+#define GPIO_PUPDR_PDOWN 0x02  /*!< GPIO pull down */
+
+/* Interruption */
+#define TRIGGER_RISING_EDGE 0x01U                                      /*!< Interrupt mask for detecting rising edge */
+#define TRIGGER_FALLING_EDGE 0x02U                                     /*!< Interrupt mask for detecting falling edge */
+#define TRIGGER_BOTH_EDGE (TRIGGER_RISING_EDGE | TRIGGER_FALLING_EDGE) /*!< Interrupt mask for detecting both rising and falling edges */
+#define TRIGGER_ENABLE_EVENT_REQ 0x04U                                 /*!< Interrupt mask to enable event requests */
+#define TRIGGER_ENABLE_INTERR_REQ 0x08U                                /*!< Interrupt mask to enable interrupt request */
+
+/* Board pins */
+#define LD2_Pin 5             /*!< User LED pin */
+#define LD2_GPIO_Port GPIOA   /*!< User LED port */
+
+/* HAL stand-ins used by main.c and interr.c ---------------------------------*/
+#define I2C1 ((void *)0)                       /*!< I2C1 instance (the LCD model does not use it) */
+#define I2C_DUTYCYCLE_2 0U                     /*!< Fast mode duty cycle Tlow/Thigh = 2 */
+#define I2C_ADDRESSINGMODE_7BIT 0x00004000U    /*!< 7-bit addressing */
+#define I2C_DUALADDRESS_DISABLE 0U             /*!< Dual addressing disabled */
+#define I2C_GENERALCALL_DISABLE 0U             /*!< General call disabled */
+#define I2C_NOSTRETCH_DISABLE 0U               /*!< Clock stretching enabled */
+
+/// @brief HAL status
+typedef enum
+{
+    HAL_OK = 0,     /*!< Success */
+    HAL_ERROR = 1   /*!< Failure */
+} HAL_StatusTypeDef;
+
+/// @brief I2C configuration, as in the HAL
+typedef struct
+{
+    uint32_t ClockSpeed;        /*!< Clock frequency */
+    uint32_t DutyCycle;         /*!< Fast mode duty cycle */
+    uint32_t OwnAddress1;       /*!< First own address */
+    uint32_t AddressingMode;    /*!< 7 or 10 bit addressing */
+    uint32_t DualAddressMode;   /*!< Dual addressing mode */
+    uint32_t OwnAddress2;       /*!< Second own address */
+    uint32_t GeneralCallMode;   /*!< General call mode */
+    uint32_t NoStretchMode;     /*!< Clock stretching mode */
+} I2C_InitTypeDef;
+
+/// @brief I2C handle, as in the HAL
+typedef struct
+{
+    void *Instance;         /*!< Peripheral registers */
+    I2C_InitTypeDef Init;   /*!< Configuration */
+} I2C_HandleTypeDef;
+
+/// @brief Global interrupt disable (the model has no PRIMASK: used only before an endless loop)
+#define __disable_irq() ((void)0)
+
+/* Hooks of the peripheral models ---------------------------------------------*/
+/* The drivers of the STM32F4 port run on the models: these hooks tell them what the hardware notices by itself */
+#define PORT_MODEL_TIM_SYNC(p_tim) port_sim_tim_sync(p_tim)                                        /*!< The driver wrote the registers of a timer */
+#define PORT_MODEL_USART_SYNC(p_usart) port_sim_usart_sync(p_usart)                                /*!< The driver changed the interrupt enables of a USART */
+#define PORT_MODEL_USART_READ_DR(p_usart) port_sim_usart_read_dr(p_usart)                          /*!< Read of the data register of a USART */
+#define PORT_MODEL_USART_WRITE_DR(p_usart, data) port_sim_usart_write_dr(p_usart, (uint8_t)(data)) /*!< Write of the data register of a USART */
+#define PORT_MODEL_RUN_CPU(cycles) port_sim_run_cpu(cycles)                                        /*!< CPU time spent by the driver */
+#define PORT_MODEL_POLL() port_sim_run_cpu(PORT_SIM_POLL_CYCLES)                                   /*!< An iteration of a polling loop */
+
+/// @brief Define the array of elements of a driver. Each board context has its own copy, initialized the first time
+/// it is used; `getter` returns it, and the header of the driver names it after `name`.
+#define PORT_BOARD_ARRAY(type, name, getter, length, ...)                                                    \
+  static const port_sim_state_t name##_state;                                                                \
+  type *getter(void)                                                                                         \
+  {                                                                                                          \
+    return (type *)port_sim_ctx_state(&name##_state);                                                        \
+  }                                                                                                          \
+  static void name##_init(void *p_state)                                                                     \
+  {                                                                                                          \
+    type initial[length] = __VA_ARGS__;                                                                      \
+    memcpy(p_state, initial, sizeof(initial));                                                               \
+  }                                                                                                          \
+  static const port_sim_state_t name##_state = {.size = sizeof(type) * (length), .init = name##_init}
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/// @brief Configure the NVIC and the SysTick to interrupt every millisecond
+/// @return Init status
+size_t port_system_init(void);
+
+/// @brief Get the count of the System tick in milliseconds
+/// @return uint32_t
+uint32_t port_system_get_millis(void);
+
+/// @brief Sets the number of milliseconds since the system started.
+/// @warning This function must be used only by the SysTick_Handler() ISR in file `interr.c`.
+/// @param ms New number of milliseconds since the system started.
+void port_system_set_millis(uint32_t ms);
+
+/// @brief Get the cycle counter of the core: the virtual clock of the peripheral models. It runs at `SystemCoreClock`
+/// and wraps around every 2^32 cycles, as the DWT CYCCNT of the target.
+/// @return uint32_t
+uint32_t port_system_get_cycles(void);
+
+/// @brief Write a character of the log without waiting (see fsm_log.h): to the standard output
+/// @param c Character
+/// @return true if the character was taken, false if the channel is busy
+bool port_system_log_put_char(char c);
+
+/// @brief Wait for some milliseconds
+/// @param ms Number of milliseconds to wait
+void port_system_delay_ms(uint32_t ms);
+
+/// @brief Wait for some milliseconds from a time reference.
+/// @note It also updates the time reference to the system time at return.
+/// @param p_t Pointer to the time reference
+/// @param ms Number of milliseconds to wait
+void port_system_delay_until_ms(uint32_t *p_t, uint32_t ms);
+
+/// @brief Configure the mode and pull of a GPIO
+/// @param p_port Port of the GPIO (CMSIS struct like)
+/// @param pin Pin/line of the GPIO (index from 0 to 15)
+/// @param mode Input, output, alternate, or analog
+/// @param pupd Pull-up, pull-down, or no-pull
+void port_system_gpio_config(GPIO_TypeDef *p_port, uint8_t pin, uint8_t mode, uint8_t pupd);
+
+/// @brief Configure the alternate function of a GPIO
+/// @param p_port Port of the GPIO (CMSIS struct like)
+/// @param pin Pin/line of the GPIO (index from 0 to 15)
+/// @param alternate Alternate function number (values from 0 to 15)
+void port_system_gpio_config_alternate(GPIO_TypeDef *p_port, uint8_t pin, uint8_t alternate);
+
+/// @brief Configure the external interruption or event of a GPIO
+/// @param p_port Port of the GPIO (CMSIS struct like)
+/// @param pin Pin/line of the GPIO (index from 0 to 15)
+/// @param mode Trigger mode can be a combination (OR) of: (i) direction: rising edge (0x01), falling edge (0x02), (ii)  event request (0x04), or (iii) interrupt request (0x08).
+void port_system_gpio_config_exti(GPIO_TypeDef *p_port, uint8_t pin, uint32_t mode);
+
+/// @brief Enable interrupts of a GPIO line (pin)
+/// @param pin Pin/line of the GPIO (index from 0 to 15)
+/// @param priority Priority level (from highest priority: 0, to lowest priority: 15)
+/// @param subpriority Subpriority level (from highest priority: 0, to lowest priority: 15)
+void port_system_gpio_exti_enable(uint8_t pin, uint8_t priority, uint8_t subpriority);
+
+/// @brief Disable interrupts of a GPIO line (pin)
+/// @param pin Pin/line of the GPIO (index from 0 to 15)
+void port_system_gpio_exti_disable(uint8_t pin);
+
+/// @brief Read the digital value of a GPIO
+/// @param p_port
+/// @param pin
+/// @return The digital value of a GPIO
+bool port_system_gpio_read(GPIO_TypeDef * p_port, uint8_t pin);
+
+/// @brief Write the digital value of a GPIO
+/// @param p_port
+/// @param pin
+/// @param value
+void port_system_gpio_write(GPIO_TypeDef * p_port, uint8_t pin, bool value);
+
+/// @brief Toggle the value of a GPIO
+/// @param p_port
+/// @param pin
+void port_system_gpio_toggle(GPIO_TypeDef * p_port, uint8_t pin);
+
+/// @brief Put system in Stop Mode
+void port_system_power_stop();
+
+/// @brief Put system in Sleep Mode
+void port_system_power_sleep();
+
+/// @brief Stop SysTick interrupts
+void port_system_systick_suspend();
+
+/// @brief Resume SysTick interrupts
+void port_system_systick_resume();
+
+/// @brief Switch to low power consumption mode
+/// @param  void
+void port_system_sleep(void);
+
+/// @brief HAL initialization (nothing to do on the host)
+/// @return HAL_OK
+HAL_StatusTypeDef HAL_Init(void);
+
+/// @brief HAL millisecond tick, incremented by the SysTick ISR
+void HAL_IncTick(void);
+
+/// @brief Get the HAL millisecond tick
+/// @return Milliseconds since HAL_Init()
+uint32_t HAL_GetTick(void);
+
+/// @brief I2C initialization (the LCD model does not use the bus)
+/// @param hi2c I2C handle
+/// @return HAL_OK
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c);
+
+/// @brief Blocking I2C write: the bytes go to the LCD model (see port_hd44780.c)
+/// @param hi2c I2C handle
+/// @param DevAddress Address of the device
+/// @param pData Bytes to write
+/// @param Size Number of bytes
+/// @param Timeout Timeout in milliseconds (the model always answers)
+/// @return HAL_OK
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+
+/// @brief Frequency of the System clock
+extern uint32_t SystemCoreClock;
+
+/// @brief Shifts of the APB prescalers, indexed by the PPRE field of RCC->CFGR
+extern const uint8_t APBPrescTable[8];
+
+#endif /* PORT_SYSTEM_H_ */
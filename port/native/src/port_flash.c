@@ -0,0 +1,244 @@
+/**
+ * @file port_flash.c
+ * @brief Flash sectors of the melody store and of the settings for the native platform, optionally backed by a file.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stdio.h>
+#include <string.h>
+
+/* HW dependent libraries */
+#include "port_flash.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define FLASH_SETTINGS_OFFSET PORT_FLASH_STORE_SIZE /*!< Position of the settings in the model, after the store */
+#define FLASH_SIZE (PORT_FLASH_STORE_SIZE + PORT_FLASH_SETTINGS_SECTORS * PORT_FLASH_SETTINGS_SIZE) /*!< Bytes of the model */
+
+/* Typedefs -------------------------------------------------------------------*/
+/// @brief Flash sectors of a board
+typedef struct
+{
+  uint8_t memory[FLASH_SIZE]; /*!< Content of the store, then of the sectors of the settings */
+  FILE *p_file;               /*!< File that backs the sectors, or NULL */
+  uint64_t busy_cycles;       /*!< Time spent erasing and programming */
+  uint32_t erases;            /*!< Sectors erased */
+  uint32_t operations_left;   /*!< Operations before the power is cut, 0 for no cut */
+  bool power_cut;             /*!< The power is cut: the flash no longer changes */
+} flash_state_t;
+
+/// @brief Outcome of an operation with respect to the power
+typedef enum
+{
+  FLASH_DONE = 0, /*!< Done in full */
+  FLASH_CUT,      /*!< The power is cut in the middle: half done */
+  FLASH_OFF,      /*!< The power was already cut: not done */
+} flash_power_t;
+
+/* Private functions */
+
+/// @brief Initial value of the sector of a board: erased
+/// @param p_state Sector
+static void _flash_init(void *p_state)
+{
+  memset(((flash_state_t *)p_state)->memory, PORT_FLASH_ERASED, FLASH_SIZE);
+}
+
+/// @brief Flash sector in each board context
+static const port_sim_state_t flash_state = {.size = sizeof(flash_state_t), .init = _flash_init};
+
+/// @brief Get the flash sector of the board selected by the calling thread
+static inline flash_state_t *_flash(void)
+{
+  return (flash_state_t *)port_sim_ctx_state(&flash_state);
+}
+
+/// @brief Write a range of the sector through to its file, if any
+/// @param p_flash Sector
+/// @param offset Position of the range
+/// @param length Bytes of the range
+static void _write_through(flash_state_t *p_flash, uint32_t offset, uint32_t length)
+{
+  if (p_flash->p_file && !fseek(p_flash->p_file, (long)offset, SEEK_SET))
+  {
+    fwrite(&p_flash->memory[offset], 1, length, p_flash->p_file);
+    fflush(p_flash->p_file);
+  }
+}
+
+/// @brief Charge the time of an operation: the CPU stalls while it fetches from the flash being written
+/// @param p_flash Sector
+/// @param cycles Time of the operation
+static void _busy(flash_state_t *p_flash, uint32_t cycles)
+{
+  p_flash->busy_cycles += cycles;
+  port_sim_run_cpu(cycles);
+}
+
+/// @brief Count an operation towards the cut of the power
+/// @param p_flash Sectors
+/// @return Outcome of the operation
+static flash_power_t _power(flash_state_t *p_flash)
+{
+  if (p_flash->power_cut)
+  {
+    return FLASH_OFF;
+  }
+  if ((p_flash->operations_left > 0) && (--p_flash->operations_left == 0))
+  {
+    p_flash->power_cut = true;
+    return FLASH_CUT;
+  }
+  return FLASH_DONE;
+}
+
+/// @brief Erase a sector of the model
+/// @param base Position of the sector in the model
+/// @param size Bytes of the sector
+/// @return true if erased in full
+static bool _erase(uint32_t base, uint32_t size)
+{
+  flash_state_t *p_flash = _flash();
+  flash_power_t power = _power(p_flash);
+  if (power == FLASH_OFF)
+  {
+    return false;
+  }
+  uint32_t erased = (power == FLASH_CUT) ? size / 2 : size;
+  memset(&p_flash->memory[base], PORT_FLASH_ERASED, erased);
+  _write_through(p_flash, base, erased);
+  p_flash->erases++;
+  _busy(p_flash, PORT_FLASH_ERASE_CYCLES);
+  return power == FLASH_DONE;
+}
+
+/// @brief Program bytes of a sector of the model, a halfword at a time
+/// @param base Position of the sector in the model
+/// @param size Bytes of the sector
+/// @param offset Position in the sector, even
+/// @param p_data Pointer to the data
+/// @param length Bytes to program, even
+/// @return true if programmed in full
+static bool _program(uint32_t base, uint32_t size, uint32_t offset, const void *p_data, uint32_t length)
+{
+  if ((offset % 2) || (length % 2) || (offset > size) || (length > size - offset))
+  {
+    return false;
+  }
+  flash_state_t *p_flash = _flash();
+  const uint8_t *p_bytes = (const uint8_t *)p_data;
+  uint8_t *p_memory = &p_flash->memory[base + offset];
+  flash_power_t power = FLASH_DONE;
+  uint32_t i = 0;
+  for (; (i < length) && (power == FLASH_DONE); i += 2)
+  {
+    power = _power(p_flash);
+    if (power != FLASH_OFF)
+    {
+      p_memory[i] &= p_bytes[i]; // A 1 cannot be written over a 0
+    }
+    if (power == FLASH_DONE)
+    {
+      p_memory[i + 1] &= p_bytes[i + 1];
+    }
+  }
+  _write_through(p_flash, base + offset, i);
+  _busy(p_flash, (i / 2) * PORT_FLASH_PROGRAM_CYCLES);
+  return power == FLASH_DONE;
+}
+
+/* Public functions */
+const uint8_t *port_flash_get_store(void)
+{
+  return _flash()->memory;
+}
+
+bool port_flash_erase_store(void)
+{
+  return _erase(0, PORT_FLASH_STORE_SIZE);
+}
+
+bool port_flash_program(uint32_t offset, const void *p_data, uint32_t length)
+{
+  return _program(0, PORT_FLASH_STORE_SIZE, offset, p_data, length);
+}
+
+const uint8_t *port_flash_get_settings(uint32_t sector)
+{
+  return &_flash()->memory[FLASH_SETTINGS_OFFSET + sector * PORT_FLASH_SETTINGS_SIZE];
+}
+
+bool port_flash_erase_settings(uint32_t sector)
+{
+  if (sector >= PORT_FLASH_SETTINGS_SECTORS)
+  {
+    return false;
+  }
+  return _erase(FLASH_SETTINGS_OFFSET + sector * PORT_FLASH_SETTINGS_SIZE, PORT_FLASH_SETTINGS_SIZE);
+}
+
+bool port_flash_program_settings(uint32_t sector, uint32_t offset, const void *p_data, uint32_t length)
+{
+  if (sector >= PORT_FLASH_SETTINGS_SECTORS)
+  {
+    return false;
+  }
+  return _program(FLASH_SETTINGS_OFFSET + sector * PORT_FLASH_SETTINGS_SIZE, PORT_FLASH_SETTINGS_SIZE, offset, p_data,
+                  length);
+}
+
+bool port_flash_set_file(const char *p_path)
+{
+  flash_state_t *p_flash = _flash();
+  if (p_flash->p_file)
+  {
+    fclose(p_flash->p_file);
+    p_flash->p_file = NULL;
+  }
+  if (!p_path)
+  {
+    return true;
+  }
+  FILE *p_file = fopen(p_path, "r+b");
+  if (p_file)
+  {
+    bool whole = !fseek(p_file, 0, SEEK_END) && (ftell(p_file) == FLASH_SIZE) && !fseek(p_file, 0, SEEK_SET);
+    if (whole && (fread(p_flash->memory, 1, FLASH_SIZE, p_file) == FLASH_SIZE))
+    {
+      p_flash->p_file = p_file;
+      return true;
+    }
+    fclose(p_file);
+  }
+  p_flash->p_file = fopen(p_path, "w+b");
+  if (!p_flash->p_file)
+  {
+    return false;
+  }
+  _write_through(p_flash, 0, FLASH_SIZE);
+  return true;
+}
+
+uint64_t port_flash_get_busy_cycles(void)
+{
+  return _flash()->busy_cycles;
+}
+
+uint32_t port_flash_get_erases(void)
+{
+  return _flash()->erases;
+}
+
+void port_flash_cut_power(uint32_t operations)
+{
+  flash_state_t *p_flash = _flash();
+  p_flash->operations_left = operations;
+  p_flash->power_cut = false;
+}
+
+bool port_flash_is_power_cut(void)
+{
+  return _flash()->power_cut;
+}
@@ -0,0 +1,157 @@
+/**
+ * @file port_hd44780.c
+ * @brief Model of the LCD of the native platform: an HD44780 behind a PCF8574 I2C expander.
+ *
+ * The LCD driver of the STM32F4 port writes the expander with HAL_I2C_Master_Transmit(). Here each byte costs the time
+ * of a blocking 100 kHz I2C transfer and feeds a model of the HD44780, so the text on the display can be checked from
+ * the host.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#include <string.h>
+
+#include "port_lcd.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define I2C_BYTE_CYCLES 3200U   /*!< START + address + data + ACKs + STOP at 100 kHz: 20 bit times of 10 us */
+#define LCD_DDRAM_ROW_LENGTH 40 /*!< DDRAM bytes of each row */
+#define LCD_DDRAM_ROW_1 0x40    /*!< DDRAM address of the second row */
+
+/* Typedefs -------------------------------------------------------------------*/
+/// @brief State of the HD44780 controller model
+typedef struct
+{
+    bool four_bit;                                  /*!< 4-bit interface selected */
+    bool low_nibble;                                /*!< Next latched nibble is the low one */
+    uint8_t high_nibble;                            /*!< High nibble latched */
+    uint8_t last_expander;                          /*!< Last byte written to the expander */
+    uint8_t address;                                /*!< Address counter */
+    bool cgram;                                     /*!< Data writes go to the CGRAM */
+    bool increment;                                 /*!< Entry mode: increment the address */
+    char ddram[2][LCD_DDRAM_ROW_LENGTH];            /*!< Display data RAM */
+    char row_text[LCD_COLUMNS + 1];                 /*!< Buffer returned by port_lcd_get_row() */
+} lcd_model_t;
+
+/* Global variables ------------------------------------------------------------*/
+/// @brief I2C handle of the expander. main.c defines it; the simulator and the tests do not link main.c
+I2C_HandleTypeDef hi2c1 __attribute__((weak));
+
+/// @brief Power-on state of the controller
+/// @param p_state Model
+static void _lcd_init(void *p_state)
+{
+  lcd_model_t *p_lcd = (lcd_model_t *)p_state;
+  memset(p_lcd->ddram, ' ', sizeof(p_lcd->ddram));
+  p_lcd->increment = true;
+}
+
+/// @brief LCD model in each board context
+static const port_sim_state_t lcd_state = {.size = sizeof(lcd_model_t), .init = _lcd_init};
+
+/// @brief Model of the board selected by the calling thread
+#define lcd (*(lcd_model_t *)port_sim_ctx_state(&lcd_state))
+
+/* Private functions */
+
+/// @brief Execute an instruction or a data write in the HD44780 model
+/// @param value Instruction or character
+/// @param rs Register select: true for data
+static void _execute(uint8_t value, bool rs)
+{
+  if (rs)
+  {
+    if (!lcd.cgram)
+    {
+      uint8_t row = (lcd.address >= LCD_DDRAM_ROW_1) ? 1 : 0;
+      uint8_t col = lcd.address - (row ? LCD_DDRAM_ROW_1 : 0);
+      if (col < LCD_DDRAM_ROW_LENGTH)
+      {
+        lcd.ddram[row][col] = (char)value;
+      }
+    }
+    lcd.address = lcd.increment ? lcd.address + 1 : lcd.address - 1;
+    return;
+  }
+  if (value & LCD_SETDDRAMADDR)
+  {
+    lcd.address = value & 0x7F;
+    lcd.cgram = false;
+  }
+  else if (value & LCD_SETCGRAMADDR)
+  {
+    lcd.address = value & 0x3F;
+    lcd.cgram = true;
+  }
+  else if (value & LCD_FUNCTIONSET)
+  {
+    lcd.four_bit = !(value & LCD_8BITMODE);
+  }
+  else if (value & (LCD_CURSORSHIFT | LCD_DISPLAYCONTROL))
+  {
+    /* Display shift, cursor and blink are not modeled */
+  }
+  else if (value & LCD_ENTRYMODESET)
+  {
+    lcd.increment = value & LCD_ENTRYLEFT;
+  }
+  else if (value & LCD_RETURNHOME)
+  {
+    lcd.address = 0;
+    lcd.cgram = false;
+  }
+  else if (value & LCD_CLEARDISPLAY)
+  {
+    memset(lcd.ddram, ' ', sizeof(lcd.ddram));
+    lcd.address = 0;
+    lcd.cgram = false;
+    lcd.increment = true;
+  }
+}
+
+/* Public functions */
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+  for (uint16_t i = 0; i < Size; i++)
+  {
+    uint8_t data = pData[i];
+    /* Blocking transfer */
+    port_sim_run_cpu(I2C_BYTE_CYCLES);
+    /* The controller latches D7-D4 on the falling edge of E */
+    if ((lcd.last_expander & ENABLE) && !(data & ENABLE))
+    {
+      uint8_t nibble = data & 0xF0;
+      bool rs = data & RS;
+      if (!lcd.four_bit)
+      {
+        _execute(nibble, rs);
+      }
+      else if (!lcd.low_nibble)
+      {
+        lcd.high_nibble = nibble;
+        lcd.low_nibble = true;
+      }
+      else
+      {
+        lcd.low_nibble = false;
+        _execute(lcd.high_nibble | (nibble >> 4), rs);
+      }
+    }
+    lcd.last_expander = data;
+  }
+  return HAL_OK;
+}
+
+const char *port_lcd_get_row(uint8_t row)
+{
+  memcpy(lcd.row_text, lcd.ddram[row ? 1 : 0], LCD_COLUMNS);
+  lcd.row_text[LCD_COLUMNS] = '\0';
+  return lcd.row_text;
+}
+
+bool port_lcd_get_backlight(void)
+{
+  return lcd.last_expander & LCD_BACKLIGHT;
+}
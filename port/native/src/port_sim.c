@@ -0,0 +1,1286 @@
+/**
+ * @file port_sim.c
+ * @brief Discrete-event register model of the STM32F446RE peripherals used by the jukebox.
+ *
+ * The model keeps a virtual clock in core clock cycles and a queue of scripted events. Peripherals do not tick:
+ * timers, the SysTick and the USART shift registers compute when their next event happens, and the clock jumps from
+ * one event to the next. Interrupt lines are level sensitive, as in the NVIC: a line is pending while its flag and its
+ * enable bit are both set, and it is served as soon as the CPU is in thread mode. ISRs are not nested.
+ *
+ * All the state of a board lives in its context, so the functions below act on the context selected by the calling
+ * thread. The drivers keep their RAM (the `*_arr` tables, the tick counter...) in the same context through
+ * port_sim_ctx_state().
+ *
+ * Simplifications:
+ * - Writing `UG` reloads the counter and the preloaded registers but does not raise `UIF` (as with `URS` set).
+ * - The EXTI pending bits of a line group are cleared when its ISR returns.
+ * - Priorities only order the interrupts that are pending at the same time.
+ * - DMA1 is the only DMA controller, and only its peripheral-to-memory transfers from a USART data register are
+ *   modeled (USART3_RX on stream 1). A transfer takes no time and the FIFO is bypassed.
+ * - `IDLE` is set one frame after the last byte of a burst injected on the RX line.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* HW dependent libraries */
+#include "port_sim.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define NUM_TIMERS 6           /*!< Timers modeled: TIM2, TIM3, TIM4, TIM5, and TIM1 and TIM8 as PWM only */
+#define NUM_ITR 4              /*!< Internal trigger inputs of a timer, ITR0 to ITR3 */
+#define SMS_TRIGGER (TIM_SMCR_SMS_2 | TIM_SMCR_SMS_1) /*!< Slave mode 110: the trigger starts the counter */
+#define NUM_USARTS 3           /*!< USARTs modeled: USART1, USART3 and USART6 */
+#define NUM_DMA_STREAMS 8      /*!< Streams of DMA1 */
+#define DMA_FLAG_HT (1U << 4)  /*!< Half transfer flag, relative to the flags of a stream */
+#define DMA_FLAG_TC (1U << 5)  /*!< Transfer complete flag, relative to the flags of a stream */
+#define ISR_OVERHEAD_CYCLES 24 /*!< Exception entry plus exit on a Cortex-M4 with no FPU context */
+#define ISR_STORM_LIMIT 100000 /*!< Back to back ISRs after which the model reports an interrupt that is never cleared */
+
+/* Typedefs --------------------------------------------------------------------*/
+/// @brief Scripted event
+typedef struct
+{
+    uint64_t cycles;         /*!< Virtual time of the event */
+    uint32_t seq;            /*!< Insertion order, to keep events at the same time in FIFO order */
+    port_sim_event_cb_t cb;  /*!< Callback */
+    void *p_arg;             /*!< Callback argument */
+    uint32_t data;           /*!< Callback data */
+} sim_event_t;
+
+/// @brief Timer model
+typedef struct
+{
+    TIM_TypeDef *p_tim;      /*!< Registers */
+    IRQn_Type irq;           /*!< Interrupt line */
+    bool running;            /*!< The counter is enabled */
+    uint32_t psc;            /*!< Active (shadow) prescaler */
+    uint32_t arr;            /*!< Active (shadow) auto-reload */
+    uint64_t origin;         /*!< Virtual time at which the counter was 0 in the current period */
+    uint32_t cnt_published;  /*!< Last value written by the model to `CNT`, to detect writes from the driver */
+    uint64_t started;        /*!< Virtual time at which the counter was last started or restarted from 0 */
+    bool advanced;           /*!< TIM1 or TIM8: the output also needs `MOE` */
+    TIM_TypeDef *p_itr[NUM_ITR]; /*!< Timer connected to each internal trigger input */
+} sim_tim_t;
+
+/// @brief USART model
+typedef struct
+{
+    USART_TypeDef *p_usart;  /*!< Registers */
+    IRQn_Type irq;           /*!< Interrupt line */
+    uint64_t shift_end;      /*!< Virtual time at which the TX shift register becomes empty */
+    bool tdr_full;           /*!< A byte written to DR waits for the shift register */
+    uint8_t tdr;             /*!< Byte waiting in the transmit data register */
+    uint64_t rx_line_free;   /*!< Virtual time at which the last injected byte completes */
+    uint64_t rx_last;        /*!< Virtual time at which the last byte was received */
+} sim_usart_t;
+
+/// @brief DMA stream model
+typedef struct
+{
+    DMA_Stream_TypeDef *p_stream; /*!< Registers */
+    IRQn_Type irq;                /*!< Interrupt line */
+    uint32_t flags_pos;           /*!< Position of the flags of the stream in `LISR`/`HISR` */
+    bool enabled;                 /*!< Last value seen of `EN` */
+    uint32_t ndtr_reload;         /*!< Items programmed when the stream was enabled, reloaded in circular mode */
+} sim_dma_t;
+
+/// @brief Full state of the simulated MCU
+typedef struct
+{
+    uint64_t now;                               /*!< Virtual time in core clock cycles */
+    uint64_t sleep_cycles;                      /*!< Cycles spent waiting for interrupts */
+    uint32_t isr_count;                         /*!< ISRs served since reset */
+    uint32_t wakeups;                           /*!< Interrupts that woke the CPU up since reset */
+    uint32_t irq_count[PORT_SIM_NVIC_LINES];    /*!< ISRs served per interrupt line */
+    uint64_t irq_cycles[PORT_SIM_NVIC_LINES];   /*!< CPU time spent in the ISRs of each interrupt line */
+    uint32_t seq;                               /*!< Event insertion counter */
+    sim_event_t heap[PORT_SIM_MAX_EVENTS];      /*!< Scripted events, binary min-heap */
+    uint32_t heap_len;                          /*!< Number of scripted events */
+    uint32_t nvic_enabled[PORT_SIM_NVIC_LINES / 32];  /*!< NVIC enable bits */
+    uint8_t nvic_priority[PORT_SIM_NVIC_LINES]; /*!< NVIC priorities */
+    uint32_t priority_group;                    /*!< NVIC priority grouping */
+    bool systick_pending;                       /*!< SysTick exception pending */
+    bool systick_tickint;                       /*!< Last value seen of TICKINT */
+    uint64_t systick_origin;                    /*!< Virtual time of a SysTick reload */
+    uint64_t systick_last;                      /*!< Last SysTick reload already accounted for */
+    bool in_isr;                                /*!< The CPU is in handler mode */
+    bool sleeping;                              /*!< The CPU is waiting for an interrupt */
+    GPIO_TypeDef *exti_source[16];              /*!< Port selected for each EXTI line */
+    sim_tim_t tims[NUM_TIMERS];                 /*!< Timer models */
+    sim_usart_t usarts[NUM_USARTS];             /*!< USART models */
+    sim_dma_t dmas[NUM_DMA_STREAMS];            /*!< DMA1 stream models */
+} sim_t;
+
+/// @brief Hooks of the harness. They are not hardware: a reset keeps them
+typedef struct
+{
+    port_sim_usart_tx_cb_t tx_hook;     /*!< Sink of the transmitted bytes */
+    void *p_tx_arg;                     /*!< Argument of `tx_hook` */
+    port_sim_idle_cb_t idle_hook;       /*!< Called when the CPU sleeps with nothing left to wake it */
+    void *p_idle_arg;                   /*!< Argument of `idle_hook` */
+} sim_hooks_t;
+
+/// @brief Simulated board
+struct port_sim_ctx
+{
+    port_sim_regs_t regs;                                   /*!< Peripheral registers */
+    sim_t sim;                                              /*!< Clock and peripheral models */
+    sim_hooks_t hooks;                                      /*!< Hooks of the harness */
+    const port_sim_state_t *p_descs[PORT_SIM_MAX_STATES];   /*!< Drivers with state in this board */
+    void *p_states[PORT_SIM_MAX_STATES];                    /*!< State of each driver */
+};
+
+/* Global variables ------------------------------------------------------------*/
+/// @brief Interrupt lines with a handler in the port, in ascending order: the only ones worth scanning
+static const IRQn_Type irq_lines[] = {EXTI0_IRQn, DMA1_Stream1_IRQn, DMA1_Stream3_IRQn, EXTI9_5_IRQn, EXTI15_10_IRQn,
+                                      TIM2_IRQn, TIM3_IRQn, TIM4_IRQn, USART1_IRQn, USART3_IRQn, TIM5_IRQn, USART6_IRQn};
+
+/// @brief Interrupt line of each stream of DMA1
+static const IRQn_Type dma1_irqs[NUM_DMA_STREAMS] = {11, 12, 13, 14, 15, 16, 17, 47};
+
+/// @brief Position of the flags of each stream in `LISR` (streams 0 to 3) and `HISR` (streams 4 to 7)
+static const uint32_t dma_flags_pos[NUM_DMA_STREAMS] = {0, 6, 16, 22, 0, 6, 16, 22};
+
+static _Thread_local port_sim_ctx_t *p_ctx_current; /*!< Board selected by the thread */
+static _Thread_local port_sim_ctx_t *p_ctx_default; /*!< Board used by threads that never select one */
+
+/* Interrupt handlers. They are weak so that a binary only links the ISRs it defines (see interr.c) */
+extern void SysTick_Handler(void) __attribute__((weak));
+extern void EXTI0_IRQHandler(void) __attribute__((weak));
+extern void DMA1_Stream1_IRQHandler(void) __attribute__((weak));
+extern void DMA1_Stream3_IRQHandler(void) __attribute__((weak));
+extern void EXTI9_5_IRQHandler(void) __attribute__((weak));
+extern void EXTI15_10_IRQHandler(void) __attribute__((weak));
+extern void TIM2_IRQHandler(void) __attribute__((weak));
+extern void TIM3_IRQHandler(void) __attribute__((weak));
+extern void TIM4_IRQHandler(void) __attribute__((weak));
+extern void TIM5_IRQHandler(void) __attribute__((weak));
+extern void USART1_IRQHandler(void) __attribute__((weak));
+extern void USART3_IRQHandler(void) __attribute__((weak));
+extern void USART6_IRQHandler(void) __attribute__((weak));
+
+/* Private functions -----------------------------------------------------------*/
+/// @brief Get the board selected by the calling thread, creating its default board on first use
+static inline port_sim_ctx_t *_ctx(void)
+{
+    if (!p_ctx_current)
+    {
+        if (!p_ctx_default)
+        {
+            p_ctx_default = port_sim_ctx_new();
+            if (!p_ctx_default)
+            {
+                fprintf(stderr, "port_sim: out of memory\n");
+                abort();
+            }
+        }
+        p_ctx_current = p_ctx_default;
+    }
+    return p_ctx_current;
+}
+
+/// @brief Get the clock and peripheral models of the selected board
+static inline sim_t *_sim(void)
+{
+    return &_ctx()->sim;
+}
+
+/// @brief Get the handler of an interrupt line
+/// @param irq Interrupt number
+/// @return Pointer to the ISR, NULL if the binary does not define it
+static void (*_handler(IRQn_Type irq))(void)
+{
+    switch (irq)
+    {
+    case EXTI0_IRQn:
+        return EXTI0_IRQHandler;
+    case DMA1_Stream1_IRQn:
+        return DMA1_Stream1_IRQHandler;
+    case DMA1_Stream3_IRQn:
+        return DMA1_Stream3_IRQHandler;
+    case EXTI9_5_IRQn:
+        return EXTI9_5_IRQHandler;
+    case EXTI15_10_IRQn:
+        return EXTI15_10_IRQHandler;
+    case TIM2_IRQn:
+        return TIM2_IRQHandler;
+    case TIM3_IRQn:
+        return TIM3_IRQHandler;
+    case TIM4_IRQn:
+        return TIM4_IRQHandler;
+    case TIM5_IRQn:
+        return TIM5_IRQHandler;
+    case USART1_IRQn:
+        return USART1_IRQHandler;
+    case USART3_IRQn:
+        return USART3_IRQHandler;
+    case USART6_IRQn:
+        return USART6_IRQHandler;
+    default:
+        return NULL;
+    }
+}
+
+/// @brief Get the EXTI lines that share an interrupt line
+/// @param irq Interrupt number
+/// @return Mask of EXTI lines, 0 if `irq` is not an EXTI interrupt
+static uint32_t _exti_lines(IRQn_Type irq)
+{
+    if (irq == EXTI15_10_IRQn)
+    {
+        return 0xFC00U;
+    }
+    if (irq == EXTI9_5_IRQn)
+    {
+        return 0x03E0U;
+    }
+    if (irq >= EXTI0_IRQn && irq <= EXTI0_IRQn + 4)
+    {
+        return 1U << (irq - EXTI0_IRQn);
+    }
+    return 0;
+}
+
+static sim_tim_t *_tim(TIM_TypeDef *p_tim)
+{
+    for (uint32_t i = 0; i < NUM_TIMERS; i++)
+    {
+        if (_sim()->tims[i].p_tim == p_tim)
+        {
+            return &_sim()->tims[i];
+        }
+    }
+    return NULL;
+}
+
+static sim_usart_t *_usart(USART_TypeDef *p_usart)
+{
+    for (uint32_t i = 0; i < NUM_USARTS; i++)
+    {
+        if (_sim()->usarts[i].p_usart == p_usart)
+        {
+            return &_sim()->usarts[i];
+        }
+    }
+    return NULL;
+}
+
+/// @brief Get the interrupt status register of a DMA1 stream
+/// @param stream Stream number
+/// @return Pointer to `LISR` or `HISR`
+static volatile uint32_t *_dma_isr(uint32_t stream)
+{
+    return (stream < 4) ? &DMA1->LISR : &DMA1->HISR;
+}
+
+/// @brief Level of the request line of a peripheral interrupt
+/// @param irq Interrupt number
+/// @return true if the peripheral requests the interrupt
+static bool _irq_level(IRQn_Type irq)
+{
+    sim_t *p_sim = _sim();
+    uint32_t lines = _exti_lines(irq);
+    if (lines)
+    {
+        return (EXTI->PR & EXTI->IMR & lines) != 0;
+    }
+    for (uint32_t i = 0; i < NUM_TIMERS; i++)
+    {
+        if (p_sim->tims[i].irq == irq)
+        {
+            TIM_TypeDef *p_tim = p_sim->tims[i].p_tim;
+            return (p_tim->SR & TIM_SR_UIF) && (p_tim->DIER & TIM_DIER_UIE);
+        }
+    }
+    for (uint32_t i = 0; i < NUM_USARTS; i++)
+    {
+        if (p_sim->usarts[i].irq == irq)
+        {
+            uint32_t sr = p_sim->usarts[i].p_usart->SR;
+            uint32_t cr1 = p_sim->usarts[i].p_usart->CR1;
+            return ((sr & (USART_SR_RXNE | USART_SR_ORE)) && (cr1 & USART_CR1_RXNEIE)) ||
+                   ((sr & USART_SR_TXE) && (cr1 & USART_CR1_TXEIE)) ||
+                   ((sr & USART_SR_TC) && (cr1 & USART_CR1_TCIE)) ||
+                   ((sr & USART_SR_IDLE) && (cr1 & USART_CR1_IDLEIE));
+        }
+    }
+    for (uint32_t i = 0; i < NUM_DMA_STREAMS; i++)
+    {
+        if (p_sim->dmas[i].irq == irq)
+        {
+            uint32_t flags = *_dma_isr(i) >> p_sim->dmas[i].flags_pos;
+            uint32_t cr = p_sim->dmas[i].p_stream->CR;
+            return ((flags & DMA_FLAG_TC) && (cr & DMA_SxCR_TCIE)) ||
+                   ((flags & DMA_FLAG_HT) && (cr & DMA_SxCR_HTIE));
+        }
+    }
+    return false;
+}
+
+static bool _nvic_is_enabled(IRQn_Type irq)
+{
+    return (irq >= 0) && (_sim()->nvic_enabled[irq / 32] & (1U << (irq % 32)));
+}
+
+static uint64_t _systick_period(void)
+{
+    return (uint64_t)SysTick->LOAD + 1U;
+}
+
+/// @brief Last SysTick reload at or before the current virtual time
+static uint64_t _systick_latest(void)
+{
+    sim_t *p_sim = _sim();
+    uint64_t period = _systick_period();
+    return p_sim->systick_origin + ((p_sim->now - p_sim->systick_origin) / period) * period;
+}
+
+/// @brief Next SysTick exception, if the SysTick is counting and its exception is enabled
+static uint64_t _systick_next(void)
+{
+    if (!(SysTick->CTRL & SysTick_CTRL_ENABLE_Msk) || !(SysTick->CTRL & SysTick_CTRL_TICKINT_Msk))
+    {
+        return PORT_SIM_NEVER;
+    }
+    uint64_t latest = _systick_latest();
+    return (latest > _sim()->systick_last) ? latest : latest + _systick_period();
+}
+
+static uint64_t _tim_period(sim_tim_t *p_m)
+{
+    return ((uint64_t)p_m->psc + 1U) * ((uint64_t)p_m->arr + 1U);
+}
+
+/// @brief Next update event of a timer, only if it can raise an interrupt
+static uint64_t _tim_next(sim_tim_t *p_m)
+{
+    if (!p_m->running || !(p_m->p_tim->DIER & TIM_DIER_UIE))
+    {
+        return PORT_SIM_NEVER;
+    }
+    return p_m->origin + _tim_period(p_m);
+}
+
+static uint32_t _tim_count(sim_tim_t *p_m)
+{
+    if (!p_m->running)
+    {
+        return p_m->p_tim->CNT;
+    }
+    return (uint32_t)(((_sim()->now - p_m->origin) % _tim_period(p_m)) / ((uint64_t)p_m->psc + 1U));
+}
+
+static void _tim_reconcile(sim_tim_t *p_m);
+
+/// @brief Start the timers in trigger mode that select a timer as their internal trigger, when its counter enable
+/// rises (master mode 001)
+/// @param p_master Timer that has just started
+static void _tim_trigger(sim_tim_t *p_master)
+{
+    if ((p_master->p_tim->CR2 & TIM_CR2_MMS) != TIM_CR2_MMS_0)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < NUM_TIMERS; i++)
+    {
+        sim_tim_t *p_m = &_sim()->tims[i];
+        TIM_TypeDef *p_tim = p_m->p_tim;
+        uint32_t ts = (p_tim->SMCR & TIM_SMCR_TS) / TIM_SMCR_TS_0;
+        if (((p_tim->SMCR & TIM_SMCR_SMS) == SMS_TRIGGER) && (ts < NUM_ITR) && (p_m->p_itr[ts] == p_master->p_tim) &&
+            !(p_tim->CR1 & TIM_CR1_CEN))
+        {
+            p_tim->CR1 |= TIM_CR1_CEN;
+            _tim_reconcile(p_m);
+        }
+    }
+}
+
+/// @brief Bring a timer model up to date with its registers and with the virtual clock
+static void _tim_reconcile(sim_tim_t *p_m)
+{
+    sim_t *p_sim = _sim();
+    TIM_TypeDef *p_tim = p_m->p_tim;
+
+    /* Counter written by the driver since the last reconciliation */
+    if (p_tim->CNT != p_m->cnt_published)
+    {
+        p_m->origin = p_sim->now - (uint64_t)p_tim->CNT * ((uint64_t)p_m->psc + 1U);
+    }
+    if (p_tim->EGR & TIM_EGR_UG)
+    {
+        p_tim->EGR = 0;
+        p_tim->CNT = 0;
+        p_m->psc = p_tim->PSC;
+        p_m->arr = p_tim->ARR;
+        p_m->origin = p_sim->now;
+        p_m->started = p_sim->now;
+    }
+
+    bool enabled = p_tim->CR1 & TIM_CR1_CEN;
+    bool starts = enabled && !p_m->running;
+    if (starts)
+    {
+        p_m->running = true;
+        p_m->origin = p_sim->now - (uint64_t)p_tim->CNT * ((uint64_t)p_m->psc + 1U);
+        p_m->started = p_m->origin;
+    }
+    else if (!enabled && p_m->running)
+    {
+        p_tim->CNT = _tim_count(p_m);
+        p_m->running = false;
+    }
+
+    /* Update events elapsed since the last reconciliation */
+    if (p_m->running && p_sim->now >= p_m->origin + _tim_period(p_m))
+    {
+        uint64_t periods = (p_sim->now - p_m->origin) / _tim_period(p_m);
+        p_m->origin += periods * _tim_period(p_m);
+        p_tim->SR |= TIM_SR_UIF;
+        /* Preloaded registers are transferred at the update event */
+        p_m->psc = p_tim->PSC;
+        p_m->arr = p_tim->ARR;
+    }
+    p_tim->CNT = _tim_count(p_m);
+    p_m->cnt_published = p_tim->CNT;
+    if (starts)
+    {
+        _tim_trigger(p_m);
+    }
+}
+
+/// @brief Bring a USART model up to date with its registers and with the virtual clock
+static void _usart_reconcile(sim_usart_t *p_m)
+{
+    sim_t *p_sim = _sim();
+    USART_TypeDef *p_usart = p_m->p_usart;
+
+    if (p_m->tdr_full && p_sim->now >= p_m->shift_end)
+    {
+        /* The waiting byte moves to the shift register */
+        uint32_t byte_cycles = port_sim_usart_byte_cycles(p_usart);
+        p_m->tdr_full = false;
+        p_m->shift_end += byte_cycles;
+        if (_ctx()->hooks.tx_hook)
+        {
+            _ctx()->hooks.tx_hook(_ctx()->hooks.p_tx_arg, p_usart, p_m->tdr, p_m->shift_end);
+        }
+    }
+    /* TXE is read-only: it reflects the transmit data register whatever the driver wrote */
+    if (p_m->tdr_full)
+    {
+        p_usart->SR &= ~USART_SR_TXE;
+    }
+    else
+    {
+        p_usart->SR |= USART_SR_TXE;
+    }
+    if (!p_m->tdr_full && p_sim->now >= p_m->shift_end)
+    {
+        p_usart->SR |= USART_SR_TC;
+    }
+}
+
+static uint64_t _usart_next(sim_usart_t *p_m)
+{
+    if (p_m->tdr_full)
+    {
+        return p_m->shift_end;
+    }
+    if (!(p_m->p_usart->SR & USART_SR_TC) && (p_m->p_usart->CR1 & USART_CR1_TCIE))
+    {
+        return p_m->shift_end;
+    }
+    return PORT_SIM_NEVER;
+}
+
+/// @brief Bring the DMA models up to date with their registers: flags cleared by the driver, streams enabled
+static void _dma_reconcile(void)
+{
+    sim_t *p_sim = _sim();
+    DMA1->LISR &= ~DMA1->LIFCR;
+    DMA1->HISR &= ~DMA1->HIFCR;
+    DMA1->LIFCR = 0;
+    DMA1->HIFCR = 0;
+    for (uint32_t i = 0; i < NUM_DMA_STREAMS; i++)
+    {
+        sim_dma_t *p_m = &p_sim->dmas[i];
+        bool enabled = p_m->p_stream->CR & DMA_SxCR_EN;
+        if (enabled && !p_m->enabled)
+        {
+            p_m->ndtr_reload = p_m->p_stream->NDTR;
+        }
+        p_m->enabled = enabled;
+    }
+}
+
+/// @brief Find the enabled stream that reads the data register of a USART
+/// @param p_usart USART instance
+/// @return Pointer to the stream model, NULL if none
+static sim_dma_t *_dma_rx(USART_TypeDef *p_usart)
+{
+    sim_t *p_sim = _sim();
+    for (uint32_t i = 0; i < NUM_DMA_STREAMS; i++)
+    {
+        DMA_Stream_TypeDef *p_stream = p_sim->dmas[i].p_stream;
+        if (p_sim->dmas[i].enabled && (p_stream->PAR == (uintptr_t)&p_usart->DR) && !(p_stream->CR & DMA_SxCR_DIR))
+        {
+            return &p_sim->dmas[i];
+        }
+    }
+    return NULL;
+}
+
+/// @brief Transfer a received byte to memory
+/// @param p_m Stream model
+/// @param byte Byte read from the data register
+static void _dma_transfer(sim_dma_t *p_m, uint8_t byte)
+{
+    DMA_Stream_TypeDef *p_stream = p_m->p_stream;
+    uint32_t stream = (uint32_t)(p_m - _sim()->dmas);
+    uint32_t offset = (p_stream->CR & DMA_SxCR_MINC) ? p_m->ndtr_reload - p_stream->NDTR : 0;
+    ((uint8_t *)p_stream->M0AR)[offset] = byte;
+    p_stream->NDTR--;
+    if (p_stream->NDTR == p_m->ndtr_reload / 2)
+    {
+        *_dma_isr(stream) |= DMA_FLAG_HT << p_m->flags_pos;
+    }
+    if (p_stream->NDTR == 0)
+    {
+        *_dma_isr(stream) |= DMA_FLAG_TC << p_m->flags_pos;
+        if (p_stream->CR & DMA_SxCR_CIRC)
+        {
+            p_stream->NDTR = p_m->ndtr_reload;
+        }
+        else
+        {
+            p_stream->CR &= ~DMA_SxCR_EN;
+            p_m->enabled = false;
+        }
+    }
+}
+
+static void _reconcile_all(void)
+{
+    sim_t *p_sim = _sim();
+    bool tickint = SysTick->CTRL & SysTick_CTRL_TICKINT_Msk;
+    if (tickint && !p_sim->systick_tickint && (SysTick->CTRL & SysTick_CTRL_ENABLE_Msk))
+    {
+        /* Reloads that happened while TICKINT was clear did not request the exception */
+        p_sim->systick_last = _systick_latest();
+    }
+    p_sim->systick_tickint = tickint;
+    for (uint32_t i = 0; i < NUM_TIMERS; i++)
+    {
+        _tim_reconcile(&p_sim->tims[i]);
+    }
+    for (uint32_t i = 0; i < NUM_USARTS; i++)
+    {
+        _usart_reconcile(&p_sim->usarts[i]);
+    }
+    _dma_reconcile();
+}
+
+static void _heap_swap(uint32_t a, uint32_t b)
+{
+    sim_t *p_sim = _sim();
+    sim_event_t tmp = p_sim->heap[a];
+    p_sim->heap[a] = p_sim->heap[b];
+    p_sim->heap[b] = tmp;
+}
+
+static bool _heap_less(uint32_t a, uint32_t b)
+{
+    sim_t *p_sim = _sim();
+    return (p_sim->heap[a].cycles < p_sim->heap[b].cycles) ||
+           ((p_sim->heap[a].cycles == p_sim->heap[b].cycles) && (p_sim->heap[a].seq < p_sim->heap[b].seq));
+}
+
+static sim_event_t _heap_pop(void)
+{
+    sim_t *p_sim = _sim();
+    sim_event_t top = p_sim->heap[0];
+    p_sim->heap[0] = p_sim->heap[--p_sim->heap_len];
+    uint32_t i = 0;
+    for (;;)
+    {
+        uint32_t l = 2 * i + 1;
+        uint32_t r = l + 1;
+        uint32_t min = i;
+        if (l < p_sim->heap_len && _heap_less(l, min))
+        {
+            min = l;
+        }
+        if (r < p_sim->heap_len && _heap_less(r, min))
+        {
+            min = r;
+        }
+        if (min == i)
+        {
+            break;
+        }
+        _heap_swap(i, min);
+        i = min;
+    }
+    return top;
+}
+
+/// @brief Run everything that is due at the current virtual time
+static void _process_due(void)
+{
+    sim_t *p_sim = _sim();
+    while (p_sim->heap_len && p_sim->heap[0].cycles <= p_sim->now)
+    {
+        sim_event_t ev = _heap_pop();
+        ev.cb(ev.p_arg, ev.data);
+    }
+    if (_systick_next() <= p_sim->now)
+    {
+        /* Reloads missed while an ISR ran collapse into one pending exception, as in the SCB */
+        p_sim->systick_last = _systick_latest();
+        p_sim->systick_pending = true;
+    }
+}
+
+/// @brief Serve the pending interrupts, highest priority first
+static void _dispatch(void)
+{
+    sim_t *p_sim = _sim();
+    if (p_sim->in_isr)
+    {
+        return;
+    }
+    uint32_t served = 0;
+    for (;;)
+    {
+        _reconcile_all();
+        void (*p_isr)(void) = NULL;
+        IRQn_Type irq = SysTick_IRQn;
+        if (p_sim->systick_pending)
+        {
+            p_sim->systick_pending = false;
+            p_isr = SysTick_Handler;
+        }
+        else
+        {
+            int best = -1;
+            for (uint32_t n = 0; n < sizeof(irq_lines) / sizeof(irq_lines[0]); n++)
+            {
+                int i = (int)irq_lines[n];
+                if (_nvic_is_enabled((IRQn_Type)i) && _irq_level((IRQn_Type)i) &&
+                    (best < 0 || p_sim->nvic_priority[i] < p_sim->nvic_priority[best]))
+                {
+                    best = i;
+                }
+            }
+            if (best < 0)
+            {
+                return;
+            }
+            irq = (IRQn_Type)best;
+            p_isr = _handler(irq);
+        }
+        if (++served > ISR_STORM_LIMIT)
+        {
+            fprintf(stderr, "port_sim: IRQ %d is never cleared by its handler\n", irq);
+            abort();
+        }
+        p_sim->in_isr = true;
+        uint64_t start = p_sim->now;
+        p_sim->now += ISR_OVERHEAD_CYCLES;
+        if (p_isr)
+        {
+            p_isr();
+        }
+        EXTI->PR &= ~_exti_lines(irq);
+        p_sim->isr_count++;
+        if (irq >= 0)
+        {
+            p_sim->irq_count[irq]++;
+            p_sim->irq_cycles[irq] += p_sim->now - start;
+        }
+        p_sim->in_isr = false;
+    }
+}
+
+static uint64_t _next_event(void)
+{
+    sim_t *p_sim = _sim();
+    uint64_t next = p_sim->heap_len ? p_sim->heap[0].cycles : PORT_SIM_NEVER;
+    uint64_t t = _systick_next();
+    next = t < next ? t : next;
+    for (uint32_t i = 0; i < NUM_TIMERS; i++)
+    {
+        t = _tim_next(&p_sim->tims[i]);
+        next = t < next ? t : next;
+    }
+    for (uint32_t i = 0; i < NUM_USARTS; i++)
+    {
+        t = _usart_next(&p_sim->usarts[i]);
+        next = t < next ? t : next;
+    }
+    return next;
+}
+
+/// @brief End of the frame that follows the last byte received: the line is idle
+static void _rx_idle(void *p_arg, uint32_t data)
+{
+    USART_TypeDef *p_usart = (USART_TypeDef *)p_arg;
+    sim_usart_t *p_m = _usart(p_usart);
+    if (p_m && (p_usart->CR1 & USART_CR1_UE) && (p_usart->CR1 & USART_CR1_RE) &&
+        (_sim()->now >= p_m->rx_last + port_sim_usart_byte_cycles(p_usart)))
+    {
+        p_usart->SR |= USART_SR_IDLE;
+    }
+}
+
+static void _rx_byte(void *p_arg, uint32_t data)
+{
+    USART_TypeDef *p_usart = (USART_TypeDef *)p_arg;
+    if (!(p_usart->CR1 & USART_CR1_UE) || !(p_usart->CR1 & USART_CR1_RE))
+    {
+        return;
+    }
+    sim_usart_t *p_m = _usart(p_usart);
+    if (p_m)
+    {
+        p_m->rx_last = _sim()->now;
+        if (_sim()->now >= p_m->rx_line_free)
+        {
+            /* Last byte of the burst */
+            port_sim_schedule(_sim()->now + port_sim_usart_byte_cycles(p_usart), _rx_idle, p_arg, 0);
+        }
+    }
+    _dma_reconcile();
+    sim_dma_t *p_dma = (p_usart->CR3 & USART_CR3_DMAR) ? _dma_rx(p_usart) : NULL;
+    if (p_dma)
+    {
+        /* The request is served at once, so RXNE is never seen by the CPU */
+        _dma_transfer(p_dma, (uint8_t)data);
+        return;
+    }
+    if (p_usart->SR & USART_SR_RXNE)
+    {
+        /* The previous byte was not read: the new one is lost */
+        p_usart->SR |= USART_SR_ORE;
+        return;
+    }
+    p_usart->DR = data & 0xFFU;
+    p_usart->SR |= USART_SR_RXNE;
+}
+
+/// @brief Release the state of the drivers: it is initialized again on next use, as RAM at power-on
+static void _free_states(port_sim_ctx_t *p_ctx)
+{
+    for (uint32_t i = 0; i < PORT_SIM_MAX_STATES; i++)
+    {
+        free(p_ctx->p_states[i]);
+        p_ctx->p_states[i] = NULL;
+        p_ctx->p_descs[i] = NULL;
+    }
+}
+
+/* Public functions -----------------------------------------------------------*/
+port_sim_ctx_t *port_sim_ctx_new(void)
+{
+    port_sim_ctx_t *p_ctx = calloc(1, sizeof(port_sim_ctx_t));
+    if (!p_ctx)
+    {
+        return NULL;
+    }
+    /* Power-on reset, with the new board selected */
+    port_sim_ctx_t *p_previous = p_ctx_current;
+    p_ctx_current = p_ctx;
+    port_sim_reset();
+    p_ctx_current = p_previous;
+    return p_ctx;
+}
+
+void port_sim_ctx_destroy(port_sim_ctx_t *p_ctx)
+{
+    if (!p_ctx)
+    {
+        return;
+    }
+    if (p_ctx_current == p_ctx)
+    {
+        p_ctx_current = NULL;
+    }
+    if (p_ctx_default == p_ctx)
+    {
+        p_ctx_default = NULL;
+    }
+    _free_states(p_ctx);
+    free(p_ctx);
+}
+
+void port_sim_ctx_select(port_sim_ctx_t *p_ctx)
+{
+    p_ctx_current = p_ctx;
+}
+
+port_sim_ctx_t *port_sim_ctx_current(void)
+{
+    return _ctx();
+}
+
+port_sim_regs_t *port_sim_regs(void)
+{
+    return &_ctx()->regs;
+}
+
+void *port_sim_ctx_state(const port_sim_state_t *p_desc)
+{
+    port_sim_ctx_t *p_ctx = _ctx();
+    uint32_t i;
+    for (i = 0; i < PORT_SIM_MAX_STATES && p_ctx->p_descs[i]; i++)
+    {
+        if (p_ctx->p_descs[i] == p_desc)
+        {
+            return p_ctx->p_states[i];
+        }
+    }
+    if (i == PORT_SIM_MAX_STATES)
+    {
+        fprintf(stderr, "port_sim: too many drivers with state, raise PORT_SIM_MAX_STATES\n");
+        abort();
+    }
+    void *p_state = calloc(1, p_desc->size);
+    if (!p_state)
+    {
+        fprintf(stderr, "port_sim: out of memory\n");
+        abort();
+    }
+    p_ctx->p_descs[i] = p_desc;
+    p_ctx->p_states[i] = p_state;
+    if (p_desc->init)
+    {
+        p_desc->init(p_state);
+    }
+    return p_state;
+}
+
+void port_sim_reset(void)
+{
+    _free_states(_ctx());
+    memset(_sim(), 0, sizeof(sim_t));
+    GPIO_TypeDef *ports[] = {GPIOA, GPIOB, GPIOC};
+    for (uint32_t i = 0; i < sizeof(ports) / sizeof(ports[0]); i++)
+    {
+        memset((void *)ports[i], 0, sizeof(GPIO_TypeDef));
+        ports[i]->IDR = 0xFFFFU; /* Nothing attached: the pins read high (pull-ups of the board) */
+    }
+    TIM_TypeDef *tims[NUM_TIMERS] = {TIM2, TIM3, TIM4, TIM5, TIM1, TIM8};
+    IRQn_Type tim_irqs[NUM_TIMERS] = {TIM2_IRQn, TIM3_IRQn, TIM4_IRQn, TIM5_IRQn, TIM1_UP_TIM10_IRQn, TIM8_UP_TIM13_IRQn};
+    /* Internal trigger connections of RM0390 */
+    TIM_TypeDef *tim_itrs[NUM_TIMERS][NUM_ITR] = {
+        {TIM1, TIM8, TIM3, TIM4}, {TIM1, TIM2, TIM5, TIM4}, {TIM1, TIM2, TIM3, TIM8},
+        {TIM2, TIM3, TIM4, TIM8}, {TIM5, TIM2, TIM3, TIM4}, {TIM1, TIM2, TIM4, TIM5}};
+    for (uint32_t i = 0; i < NUM_TIMERS; i++)
+    {
+        memset((void *)tims[i], 0, sizeof(TIM_TypeDef));
+        tims[i]->ARR = 0xFFFFU;
+        _sim()->tims[i].p_tim = tims[i];
+        _sim()->tims[i].irq = tim_irqs[i];
+        _sim()->tims[i].arr = 0xFFFFU;
+        _sim()->tims[i].advanced = (tims[i] == TIM1) || (tims[i] == TIM8);
+        memcpy(_sim()->tims[i].p_itr, tim_itrs[i], sizeof(tim_itrs[i]));
+    }
+    USART_TypeDef *usarts[NUM_USARTS] = {USART1, USART3, USART6};
+    IRQn_Type usart_irqs[NUM_USARTS] = {USART1_IRQn, USART3_IRQn, USART6_IRQn};
+    for (uint32_t i = 0; i < NUM_USARTS; i++)
+    {
+        memset((void *)usarts[i], 0, sizeof(USART_TypeDef));
+        usarts[i]->SR = USART_SR_TXE | USART_SR_TC;
+        _sim()->usarts[i].p_usart = usarts[i];
+        _sim()->usarts[i].irq = usart_irqs[i];
+    }
+    memset((void *)DMA1, 0, sizeof(DMA_TypeDef));
+    for (uint32_t i = 0; i < NUM_DMA_STREAMS; i++)
+    {
+        memset((void *)&port_sim_regs()->dma1_stream[i], 0, sizeof(DMA_Stream_TypeDef));
+        _sim()->dmas[i].p_stream = &port_sim_regs()->dma1_stream[i];
+        _sim()->dmas[i].irq = dma1_irqs[i];
+        _sim()->dmas[i].flags_pos = dma_flags_pos[i];
+    }
+    memset((void *)EXTI, 0, sizeof(EXTI_TypeDef));
+    memset((void *)RCC, 0, sizeof(RCC_TypeDef));
+    memset((void *)SysTick, 0, sizeof(SysTick_Type));
+}
+
+uint64_t port_sim_get_cycles(void)
+{
+    return _sim()->now;
+}
+
+uint64_t port_sim_get_sleep_cycles(void)
+{
+    return _sim()->sleep_cycles;
+}
+
+uint32_t port_sim_get_isr_count(void)
+{
+    return _sim()->isr_count;
+}
+
+uint32_t port_sim_get_wakeups(void)
+{
+    return _sim()->wakeups;
+}
+
+uint32_t port_sim_get_irq_count(IRQn_Type irq)
+{
+    return (irq >= 0 && (uint32_t)irq < PORT_SIM_NVIC_LINES) ? _sim()->irq_count[irq] : 0;
+}
+
+uint64_t port_sim_get_irq_cycles(IRQn_Type irq)
+{
+    return (irq >= 0 && (uint32_t)irq < PORT_SIM_NVIC_LINES) ? _sim()->irq_cycles[irq] : 0;
+}
+
+void port_sim_set_idle_hook(port_sim_idle_cb_t cb, void *p_arg)
+{
+    _ctx()->hooks.idle_hook = cb;
+    _ctx()->hooks.p_idle_arg = p_arg;
+}
+
+void port_sim_idle(void)
+{
+    if (_ctx()->hooks.idle_hook)
+    {
+        _ctx()->hooks.idle_hook(_ctx()->hooks.p_idle_arg);
+        return;
+    }
+    printf("port_sim: nothing left to wake the CPU at %llu ms\n", (unsigned long long)(_sim()->now / PORT_SIM_MS_TO_CYCLES(1)));
+    exit(0);
+}
+
+void port_sim_run_cpu(uint32_t cycles)
+{
+    port_sim_advance_to(_sim()->now + cycles);
+}
+
+void port_sim_advance_to(uint64_t cycles)
+{
+    sim_t *p_sim = _sim();
+    _reconcile_all();
+    _dispatch();
+    for (;;)
+    {
+        uint64_t next = _next_event();
+        if (next > cycles)
+        {
+            break;
+        }
+        if (next > p_sim->now)
+        {
+            p_sim->now = next;
+        }
+        _reconcile_all();
+        _process_due();
+        _dispatch();
+    }
+    if (cycles > p_sim->now)
+    {
+        p_sim->now = cycles;
+        _reconcile_all();
+    }
+}
+
+bool port_sim_wait_for_interrupt(uint64_t limit)
+{
+    sim_t *p_sim = _sim();
+    uint32_t isr_count = p_sim->isr_count;
+    _reconcile_all();
+    _dispatch();
+    p_sim->sleeping = true;
+    while (p_sim->isr_count == isr_count)
+    {
+        uint64_t next = _next_event();
+        if (next > limit || next == PORT_SIM_NEVER)
+        {
+            if (limit != PORT_SIM_NEVER && limit > p_sim->now)
+            {
+                p_sim->sleep_cycles += limit - p_sim->now;
+                p_sim->now = limit;
+            }
+            p_sim->sleeping = false;
+            return false;
+        }
+        if (next > p_sim->now)
+        {
+            p_sim->sleep_cycles += next - p_sim->now;
+            p_sim->now = next;
+        }
+        _reconcile_all();
+        _process_due();
+        p_sim->sleeping = false;
+        _dispatch();
+        p_sim->sleeping = (p_sim->isr_count == isr_count);
+    }
+    p_sim->sleeping = false;
+    p_sim->wakeups++;
+    return true;
+}
+
+uint64_t port_sim_next_event(void)
+{
+    _reconcile_all();
+    return _next_event();
+}
+
+bool port_sim_schedule(uint64_t cycles, port_sim_event_cb_t cb, void *p_arg, uint32_t data)
+{
+    sim_t *p_sim = _sim();
+    if (p_sim->heap_len >= PORT_SIM_MAX_EVENTS)
+    {
+        return false;
+    }
+    uint32_t i = p_sim->heap_len++;
+    p_sim->heap[i] = (sim_event_t){.cycles = cycles, .seq = p_sim->seq++, .cb = cb, .p_arg = p_arg, .data = data};
+    while (i > 0 && _heap_less(i, (i - 1) / 2))
+    {
+        _heap_swap(i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+    return true;
+}
+
+void port_sim_nvic_set_pending(IRQn_Type irq)
+{
+    if (irq == SysTick_IRQn)
+    {
+        _sim()->systick_pending = true;
+        return;
+    }
+    /* Software triggered EXTI lines are the only peripheral requests that can be forced */
+    EXTI->PR |= _exti_lines(irq);
+}
+
+void port_sim_nvic_dispatch(void)
+{
+    _dispatch();
+}
+
+bool port_sim_in_isr(void)
+{
+    return _sim()->in_isr;
+}
+
+bool port_sim_is_sleeping(void)
+{
+    return _sim()->sleeping;
+}
+
+void port_sim_exti_set_source(GPIO_TypeDef *p_port, uint8_t pin)
+{
+    _sim()->exti_source[pin & 0x0FU] = p_port;
+}
+
+void port_sim_gpio_set_input(GPIO_TypeDef *p_port, uint8_t pin, bool level)
+{
+    uint32_t mask = 1U << pin;
+    bool old = p_port->IDR & mask;
+    if (old == level)
+    {
+        return;
+    }
+    if (level)
+    {
+        p_port->IDR |= mask;
+    }
+    else
+    {
+        p_port->IDR &= ~mask;
+    }
+    if (_sim()->exti_source[pin] == p_port && ((level && (EXTI->RTSR & mask)) || (!level && (EXTI->FTSR & mask))))
+    {
+        EXTI->PR |= mask;
+    }
+}
+
+void port_sim_tim_sync(TIM_TypeDef *p_tim)
+{
+    sim_tim_t *p_m = _tim(p_tim);
+    if (p_m)
+    {
+        _tim_reconcile(p_m);
+    }
+}
+
+uint64_t port_sim_tim_get_start_cycles(TIM_TypeDef *p_tim)
+{
+    sim_tim_t *p_m = _tim(p_tim);
+    if (!p_m)
+    {
+        return 0;
+    }
+    _tim_reconcile(p_m);
+    return p_m->started;
+}
+
+double port_sim_tim_get_output_hz(TIM_TypeDef *p_tim)
+{
+    sim_tim_t *p_m = _tim(p_tim);
+    if (!p_m || !(p_tim->CR1 & TIM_CR1_CEN) || !(p_tim->CCER & TIM_CCER_CC1E) ||
+        (p_m->advanced && !(p_tim->BDTR & TIM_BDTR_MOE)))
+    {
+        return 0.0;
+    }
+    _tim_reconcile(p_m);
+    return (double)PORT_SIM_CORE_CLOCK_HZ / (double)_tim_period(p_m);
+}
+
+void port_sim_usart_write_dr(USART_TypeDef *p_usart, uint8_t byte)
+{
+    sim_usart_t *p_m = _usart(p_usart);
+    p_usart->DR = byte;
+    if (!p_m || !(p_usart->CR1 & USART_CR1_UE) || !(p_usart->CR1 & USART_CR1_TE))
+    {
+        return;
+    }
+    _usart_reconcile(p_m);
+    p_usart->SR &= ~USART_SR_TC;
+    if (_sim()->now >= p_m->shift_end)
+    {
+        /* Shift register empty: the byte goes straight to the line */
+        p_m->shift_end = _sim()->now + port_sim_usart_byte_cycles(p_usart);
+        if (_ctx()->hooks.tx_hook)
+        {
+            _ctx()->hooks.tx_hook(_ctx()->hooks.p_tx_arg, p_usart, byte, p_m->shift_end);
+        }
+    }
+    else if (!p_m->tdr_full)
+    {
+        p_m->tdr_full = true;
+        p_m->tdr = byte;
+        p_usart->SR &= ~USART_SR_TXE;
+    }
+    else
+    {
+        /* Writing DR while TXE is clear overwrites the waiting byte */
+        p_m->tdr = byte;
+    }
+}
+
+uint8_t port_sim_usart_read_dr(USART_TypeDef *p_usart)
+{
+    p_usart->SR &= ~(USART_SR_RXNE | USART_SR_ORE | USART_SR_IDLE);
+    return (uint8_t)(p_usart->DR & 0xFFU);
+}
+
+void port_sim_usart_sync(USART_TypeDef *p_usart)
+{
+    sim_usart_t *p_m = _usart(p_usart);
+    if (p_m)
+    {
+        _usart_reconcile(p_m);
+    }
+}
+
+uint32_t port_sim_usart_byte_cycles(USART_TypeDef *p_usart)
+{
+    /* With 16x oversampling one bit lasts BRR core clock cycles (PCLK1 = HCLK = HSI) */
+    uint32_t brr = p_usart->BRR ? p_usart->BRR : 1U;
+    if (p_usart->CR1 & USART_CR1_OVER8)
+    {
+        brr = ((brr & 0xFFF0U) | ((brr & 0x7U) << 1)) / 2U;
+    }
+    return 10U * brr;
+}
+
+uint64_t port_sim_usart_inject(USART_TypeDef *p_usart, const uint8_t *p_data, size_t length, uint64_t cycles)
+{
+    sim_usart_t *p_m = _usart(p_usart);
+    uint32_t byte_cycles = port_sim_usart_byte_cycles(p_usart);
+    uint64_t t = cycles;
+    if (p_m && p_m->rx_line_free + byte_cycles > t)
+    {
+        t = p_m->rx_line_free + byte_cycles;
+    }
+    for (size_t i = 0; i < length; i++)
+    {
+        port_sim_schedule(t, _rx_byte, (void *)p_usart, p_data[i]);
+        if (i + 1 < length)
+        {
+            t += byte_cycles;
+        }
+    }
+    if (p_m)
+    {
+        p_m->rx_line_free = t;
+    }
+    return t;
+}
+
+void port_sim_usart_set_tx_hook(port_sim_usart_tx_cb_t cb, void *p_arg)
+{
+    _ctx()->hooks.tx_hook = cb;
+    _ctx()->hooks.p_tx_arg = p_arg;
+}
+
+uint32_t SysTick_Config(uint32_t ticks)
+{
+    SysTick->LOAD = ticks - 1U;
+    SysTick->VAL = 0;
+    SysTick->CTRL = SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_TICKINT_Msk;
+    _sim()->systick_origin = _sim()->now;
+    _sim()->systick_last = _sim()->now;
+    _sim()->systick_tickint = true;
+    return 0;
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq)
+{
+    if (irq >= 0)
+    {
+        _sim()->nvic_enabled[irq / 32] |= 1U << (irq % 32);
+    }
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq)
+{
+    if (irq >= 0)
+    {
+        _sim()->nvic_enabled[irq / 32] &= ~(1U << (irq % 32));
+    }
+}
+
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority)
+{
+    if (irq >= 0)
+    {
+        _sim()->nvic_priority[irq] = (uint8_t)priority;
+    }
+}
+
+uint32_t NVIC_GetPriority(IRQn_Type irq)
+{
+    return (irq >= 0) ? _sim()->nvic_priority[irq] : 0;
+}
+
+void NVIC_SetPriorityGrouping(uint32_t group)
+{
+    _sim()->priority_group = group & 0x07U;
+}
+
+uint32_t NVIC_GetPriorityGrouping(void)
+{
+    return _sim()->priority_group;
+}
+
+uint32_t NVIC_EncodePriority(uint32_t group, uint32_t preempt, uint32_t sub)
+{
+    /* 4 priority bits, as in the STM32F4 */
+    uint32_t preempt_bits = (7U - group) > 4U ? 4U : (7U - group);
+    uint32_t sub_bits = (group + 4U) < 7U ? 0U : (group - 7U + 4U);
+    return ((preempt & ((1U << preempt_bits) - 1U)) << sub_bits) | (sub & ((1U << sub_bits) - 1U));
+}
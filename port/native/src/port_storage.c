@@ -0,0 +1,183 @@
+/**
+ * @file port_storage.c
+ * @brief External storage of the streamed melodies for the native platform, backed by a file.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stdio.h>
+#include <string.h>
+
+/* HW dependent libraries */
+#include "port_storage.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define STORAGE_MAX_READ 0xFFFFU /*!< Longest read, as the NDTR of a DMA stream */
+
+/* Typedefs -------------------------------------------------------------------*/
+/// @brief Storage of a board
+typedef struct
+{
+  FILE *p_file;             /*!< File that backs the storage, or NULL */
+  uint32_t size;            /*!< Bytes of the file */
+  uint32_t access_cycles;   /*!< Time from the command to the first byte */
+  bool busy;                /*!< A read is in progress */
+  uint32_t address;         /*!< Position of the read in progress */
+  void *p_data;             /*!< Buffer of the read in progress */
+  uint32_t length;          /*!< Bytes of the read in progress */
+  uint64_t end_cycles;      /*!< Cycle counter at the end of the read in progress */
+  uint32_t reads;           /*!< Reads since the last reset */
+} storage_state_t;
+
+/* Private functions */
+
+/// @brief Storage in each board context
+static const port_sim_state_t storage_state = {.size = sizeof(storage_state_t), .init = NULL};
+
+/// @brief Get the storage of the board selected by the calling thread
+static inline storage_state_t *_storage(void)
+{
+  return (storage_state_t *)port_sim_ctx_state(&storage_state);
+}
+
+/// @brief Time of a read: access, then the command, the address and the data on the SPI clock
+/// @param p_storage Storage
+/// @param length Bytes of data
+/// @return Core clock cycles
+static uint32_t _read_cycles(const storage_state_t *p_storage, uint32_t length)
+{
+  return p_storage->access_cycles + (PORT_STORAGE_COMMAND_BYTES + length) * 8U * (PORT_SIM_CORE_CLOCK_HZ / PORT_STORAGE_SPI_HZ);
+}
+
+/// @brief Check a read and count it
+/// @param p_storage Storage
+/// @param address Position of the first byte
+/// @param length Bytes to read
+/// @return true if it can start
+static bool _begin_read(storage_state_t *p_storage, uint32_t address, uint32_t length)
+{
+  if (p_storage->busy || (length == 0) || (length > STORAGE_MAX_READ) || (address > p_storage->size) ||
+      (length > p_storage->size - address))
+  {
+    return false;
+  }
+  p_storage->reads++;
+  return true;
+}
+
+/// @brief Copy bytes of the file
+/// @param p_storage Storage
+/// @param address Position of the first byte
+/// @param p_data Pointer to the buffer
+/// @param length Bytes to copy
+static void _copy(storage_state_t *p_storage, uint32_t address, void *p_data, uint32_t length)
+{
+  if (fseek(p_storage->p_file, (long)address, SEEK_SET) || (fread(p_data, 1, length, p_storage->p_file) != length))
+  {
+    memset(p_data, 0xFF, length); // Reads as an erased flash
+  }
+}
+
+/// @brief Event: end of the transfer of a read. The data arrive at once and the stream flags the transfer complete.
+static void _on_read_done(void *p_arg, uint32_t data)
+{
+  storage_state_t *p_storage = _storage();
+  _copy(p_storage, p_storage->address, p_storage->p_data, p_storage->length);
+  DMA1->LISR |= DMA_LISR_TCIF3;
+}
+
+/* Public functions */
+void port_storage_init(void)
+{
+  NVIC_SetPriority(STORAGE_DMA_IRQ, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 2, 2));
+  NVIC_EnableIRQ(STORAGE_DMA_IRQ);
+}
+
+uint32_t port_storage_get_size(void)
+{
+  return _storage()->size;
+}
+
+bool port_storage_start_read(uint32_t address, void *p_data, uint32_t length)
+{
+  storage_state_t *p_storage = _storage();
+  if (!_begin_read(p_storage, address, length))
+  {
+    return false;
+  }
+  p_storage->busy = true;
+  p_storage->address = address;
+  p_storage->p_data = p_data;
+  p_storage->length = length;
+  STORAGE_DMA_RX->CR |= DMA_SxCR_TCIE;
+  p_storage->end_cycles = port_sim_get_cycles() + _read_cycles(p_storage, length);
+  if (!port_sim_schedule(p_storage->end_cycles, _on_read_done, NULL, 0))
+  {
+    p_storage->busy = false;
+    return false;
+  }
+  return true;
+}
+
+bool port_storage_read(uint32_t address, void *p_data, uint32_t length)
+{
+  storage_state_t *p_storage = _storage();
+  if (p_storage->busy)
+  {
+    port_sim_run_cpu((uint32_t)(p_storage->end_cycles - port_sim_get_cycles()) + 1U); // The read in progress ends and its interrupt is served
+  }
+  if (!_begin_read(p_storage, address, length))
+  {
+    return false;
+  }
+  port_sim_run_cpu(_read_cycles(p_storage, length)); // The CPU waits for the end of the read
+  _copy(p_storage, address, p_data, length);
+  return true;
+}
+
+bool port_storage_is_busy(void)
+{
+  return _storage()->busy;
+}
+
+void port_storage_end_read(void)
+{
+  DMA1->LIFCR = DMA_LIFCR_CTCIF3;
+  STORAGE_DMA_RX->CR &= ~DMA_SxCR_TCIE;
+  _storage()->busy = false;
+}
+
+bool port_storage_set_file(const char *p_path)
+{
+  storage_state_t *p_storage = _storage();
+  if (p_storage->p_file)
+  {
+    fclose(p_storage->p_file);
+    p_storage->p_file = NULL;
+    p_storage->size = 0;
+  }
+  if (!p_path)
+  {
+    return true;
+  }
+  p_storage->p_file = fopen(p_path, "rb");
+  if (!p_storage->p_file || fseek(p_storage->p_file, 0, SEEK_END))
+  {
+    return false;
+  }
+  long size = ftell(p_storage->p_file);
+  p_storage->size = (size > 0) ? (uint32_t)size : 0;
+  return true;
+}
+
+void port_storage_set_access_cycles(uint32_t cycles)
+{
+  _storage()->access_cycles = cycles;
+}
+
+uint32_t port_storage_get_reads(void)
+{
+  return _storage()->reads;
+}
@@ -0,0 +1,250 @@
+/**
+ * @file port_system.c
+ * @brief System functions of the native platform, on top of the register models of port_sim.c.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+
+#include "port_system.h"
+
+/* Typedefs -------------------------------------------------------------------*/
+/// @brief Tick counters of a board
+typedef struct
+{
+  volatile uint32_t msTicks; /*!< Variable to store millisecond ticks. Modified in the SysTick ISR */
+  volatile uint32_t uwTick;  /*!< HAL millisecond ticks */
+} system_ticks_t;
+
+/* GLOBAL VARIABLES */
+/// @brief Tick counters in each board context
+static const port_sim_state_t ticks_state = {.size = sizeof(system_ticks_t), .init = NULL};
+
+#define msTicks (((system_ticks_t *)port_sim_ctx_state(&ticks_state))->msTicks) /*!< Millisecond ticks of the selected board */
+#define uwTick (((system_ticks_t *)port_sim_ctx_state(&ticks_state))->uwTick)   /*!< HAL ticks of the selected board */
+
+/* Every board runs at the same frequency, so the clock is shared and never written */
+uint32_t SystemCoreClock = PORT_SIM_CORE_CLOCK_HZ; /*!< Frequency of the System clock */
+const uint8_t APBPrescTable[8] = {0, 0, 0, 0, 1, 2, 3, 4}; /*!< Shifts of the APB prescalers */
+
+//------------------------------------------------------
+// SYSTEM CONFIGURATION
+//------------------------------------------------------
+size_t port_system_init()
+{
+  /* The peripheral models come out of reset before main(): they are not reset here, as on the target */
+  /* Set Interrupt Group Priority */
+  NVIC_SetPriorityGrouping(NVIC_PRIORITY_GROUP_4);
+
+  /* Configure the SysTick IRQ priority. It must be the highest (lower number: 0)*/
+  NVIC_SetPriority(SysTick_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 0U, 0U));
+
+  SysTick_Config(SystemCoreClock / (1000U / TICK_FREQ_1KHZ)); /* Set Systick to 1 ms */
+
+  return 0;
+}
+
+HAL_StatusTypeDef HAL_Init(void)
+{
+  return HAL_OK;
+}
+
+void HAL_IncTick(void)
+{
+  uwTick++;
+}
+
+uint32_t HAL_GetTick(void)
+{
+  return uwTick;
+}
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c)
+{
+  return HAL_OK;
+}
+
+//------------------------------------------------------
+// TIMER RELATED FUNCTIONS
+//------------------------------------------------------
+uint32_t port_system_get_millis()
+{
+  /* Polling the tick costs CPU time: this is what makes busy loops advance the virtual clock */
+  port_sim_run_cpu(PORT_SIM_POLL_CYCLES);
+  return msTicks;
+}
+
+void port_system_set_millis(uint32_t ms)
+{
+  msTicks = ms;
+}
+
+uint32_t port_system_get_cycles(void)
+{
+  /* Reading the counter is not charged to the CPU: the measurements do not change what they measure */
+  return (uint32_t)port_sim_get_cycles();
+}
+
+bool port_system_log_put_char(char c)
+{
+  putchar(c);
+  return true;
+}
+
+void port_system_delay_ms(uint32_t ms)
+{
+  uint32_t tickstart = port_system_get_millis();
+
+  while ((port_system_get_millis() - tickstart) < ms)
+  {
+    /* Only an interrupt can change the tick: jump to the next event instead of polling until it arrives */
+    uint64_t next = port_sim_next_event();
+    if (next == PORT_SIM_NEVER)
+    {
+      port_sim_idle();
+      return;
+    }
+    port_sim_advance_to(next);
+  }
+}
+
+void port_system_delay_until_ms(uint32_t *p_t, uint32_t ms)
+{
+  uint32_t until = *p_t + ms;
+  uint32_t now = port_system_get_millis();
+  if (until > now)
+  {
+    port_system_delay_ms(until - now);
+  }
+  *p_t = port_system_get_millis();
+}
+
+void port_system_systick_suspend(){
+  SysTick->CTRL &= ~SysTick_CTRL_TICKINT_Msk;
+}
+
+void port_system_systick_resume(){
+  SysTick->CTRL |= SysTick_CTRL_TICKINT_Msk;
+}
+
+//------------------------------------------------------
+// GPIO RELATED FUNCTIONS
+//------------------------------------------------------
+void port_system_gpio_config(GPIO_TypeDef *p_port, uint8_t pin, uint8_t mode, uint8_t pupd)
+{
+  if (p_port == GPIOA)
+  {
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN; /* GPIOA_CLK_ENABLE */
+  }
+  else if (p_port == GPIOB)
+  {
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOBEN; /* GPIOB_CLK_ENABLE */
+  }
+  else if (p_port == GPIOC)
+  {
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOCEN; /* GPIOC_CLK_ENABLE */
+  }
+
+  /* Clean ( &=~ ) by displacing the base register and set the configuration ( |= ) */
+  p_port->MODER &= ~(0x03U << (pin * 2U));
+  p_port->MODER |= (mode << (pin * 2U));
+
+  p_port->PUPDR &= ~(0x03U << (pin * 2U));
+  p_port->PUPDR |= (pupd << (pin * 2U));
+}
+
+void port_system_gpio_config_exti(GPIO_TypeDef *p_port, uint8_t pin, uint32_t mode)
+{
+  /* SYSCFG external interrupt configuration register */
+  port_sim_exti_set_source(p_port, pin);
+
+  /* Rising trigger selection register (EXTI_RTSR) */
+  EXTI->RTSR &= ~BIT_POS_TO_MASK(pin);
+  if (mode & TRIGGER_RISING_EDGE)
+  {
+    EXTI->RTSR |= BIT_POS_TO_MASK(pin);
+  }
+
+  /* Falling trigger selection register (EXTI_FTSR) */
+  EXTI->FTSR &= ~BIT_POS_TO_MASK(pin);
+  if (mode & TRIGGER_FALLING_EDGE)
+  {
+    EXTI->FTSR |= BIT_POS_TO_MASK(pin);
+  }
+
+  /* Event mask register (EXTI_EMR) */
+  EXTI->EMR &= ~BIT_POS_TO_MASK(pin);
+  if (mode & TRIGGER_ENABLE_EVENT_REQ)
+  {
+    EXTI->EMR |= BIT_POS_TO_MASK(pin);
+  }
+
+  /* Interrupt mask register (EXTI_IMR) */
+  EXTI->IMR &= ~BIT_POS_TO_MASK(pin);
+  if (mode & TRIGGER_ENABLE_INTERR_REQ)
+  {
+    EXTI->IMR |= BIT_POS_TO_MASK(pin);
+  }
+}
+
+void port_system_gpio_exti_enable(uint8_t pin, uint8_t priority, uint8_t subpriority)
+{
+  NVIC_SetPriority(GET_PIN_IRQN(pin), NVIC_EncodePriority(NVIC_GetPriorityGrouping(), priority, subpriority));
+  NVIC_EnableIRQ(GET_PIN_IRQN(pin));
+}
+
+void port_system_gpio_exti_disable(uint8_t pin)
+{
+  NVIC_DisableIRQ(GET_PIN_IRQN(pin));
+}
+
+void port_system_gpio_config_alternate(GPIO_TypeDef *p_port, uint8_t pin, uint8_t alternate)
+{
+  uint32_t base_mask = 0x0FU;
+  uint32_t displacement = (pin % 8) * 4;
+
+  p_port->AFR[(uint8_t)(pin / 8)] &= ~(base_mask << displacement);
+  p_port->AFR[(uint8_t)(pin / 8)] |= (alternate << displacement);
+}
+
+bool port_system_gpio_read(GPIO_TypeDef * p_port, uint8_t pin){
+  return (bool)(p_port->IDR & BIT_POS_TO_MASK(pin));
+}
+
+void port_system_gpio_write(GPIO_TypeDef * p_port, uint8_t pin, bool value){
+  /* No BSRR side effects in the model: drive ODR directly */
+  if (!value) p_port->ODR &= ~BIT_POS_TO_MASK(pin);
+  if (value) p_port->ODR |= BIT_POS_TO_MASK(pin);
+  /* Output pins read back what they drive */
+  if (((p_port->MODER >> (pin * 2U)) & 0x03U) == GPIO_MODE_OUT)
+  {
+    port_sim_gpio_set_input(p_port, pin, value);
+  }
+}
+
+void port_system_gpio_toggle(GPIO_TypeDef * p_port, uint8_t pin){
+  port_system_gpio_write(p_port, pin, !port_system_gpio_read(p_port, pin));
+}
+
+// ------------------------------------------------------
+// POWER RELATED FUNCTIONS
+// ------------------------------------------------------
+
+void port_system_power_stop(){
+  port_system_power_sleep();
+}
+
+void port_system_power_sleep(){
+  if (!port_sim_wait_for_interrupt(PORT_SIM_NEVER))
+  {
+    port_sim_idle();
+  }
+}
+
+void port_system_sleep(void){
+  port_system_systick_suspend(); // Call function to stop systick
+  port_system_power_sleep(); // Call function to lower consumption
+}
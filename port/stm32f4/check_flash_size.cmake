@@ -0,0 +1,9 @@
+# Fail the build if a program image does not fit in the flash left to the program.
+# Usage: cmake -DIMAGE=<binary image> -DLIMIT=<bytes> -DNAME=<target> -P check_flash_size.cmake
+# The binary image spans from the first to the last byte loaded in the flash, so its size is what the program takes.
+FILE(SIZE ${IMAGE} IMAGE_SIZE)
+MATH(EXPR LIMIT_SIZE "${LIMIT}")
+IF(IMAGE_SIZE GREATER LIMIT_SIZE)
+    MESSAGE(FATAL_ERROR "${NAME} takes ${IMAGE_SIZE} bytes of flash, more than the ${LIMIT_SIZE} bytes before the settings and the melody store (see port_flash.h)")
+ENDIF()
+MESSAGE(STATUS "${NAME} takes ${IMAGE_SIZE} of ${LIMIT_SIZE} bytes of flash")
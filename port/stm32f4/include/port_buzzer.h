@@ -18,12 +18,30 @@
 
 #include "port_system.h"
 
+/* Other includes */
+
+#include "envelope.h"
+#include "note_fx.h"
+
 /* Defines and enums ----------------------------------------------------------*/
 /* Defines */
 
+/// @brief Voices, each on channel 1 of its own PWM timer. They share the note duration timer, TIM2, which starts them
+/// with its trigger output so that they stay in phase.
+#define BUZZERS_LENGTH 3
+
 #define BUZZER_0_ID 0
 #define BUZZER_0_GPIO GPIOA
 #define BUZZER_0_PIN 6
+#define BUZZER_0_TIM TIM3
+#define BUZZER_1_ID 1
+#define BUZZER_1_GPIO GPIOA
+#define BUZZER_1_PIN 8
+#define BUZZER_1_TIM TIM1
+#define BUZZER_2_ID 2
+#define BUZZER_2_GPIO GPIOC
+#define BUZZER_2_PIN 6
+#define BUZZER_2_TIM TIM8
 #define BUZZER_PWM_DC 0.5
 
 /* Typedefs --------------------------------------------------------------------*/
@@ -32,7 +50,22 @@ typedef struct{
     GPIO_TypeDef *p_port;   /*!< Pointer to the GPIO struct to which the button is connected */
     uint8_t pin;            /*!< Pin to which the buzzer is connected */
     uint8_t alt_func;       /*!< Alternate function for PMW */
+    TIM_TypeDef *p_tim;     /*!< PWM timer, output on its channel 1 */
+    bool armed;             /*!< The PWM waits for the trigger of the note duration timer to start */
     bool note_end;          /*< Falg to indicate the note has finished >*/ 
+    uint32_t paused_cnt;    /*!< Count of the note duration timer when the note was paused */
+    bool paused_pwm;        /*!< The PWM was sounding when the note was paused, it was not a silence */
+    envelope_t envelope;    /*!< Volume envelope, advanced by the control timer */
+    note_fx_state_t fx;     /*!< Pitch effects of the note, advanced by the control timer */
+    bool staged;            /*!< The voice sounds in the staged note, it is not a silence */
+    uint32_t staged_psc;    /*!< PSC of the PWM of the staged note */
+    uint32_t staged_arr;    /*!< ARR of the PWM of the staged note */
+    uint32_t staged_level;  /*!< Level of the envelope of the staged note */
+    bool stage_ready;       /*!< The staged note starts at the end of the current one, from this voice on */
+    bool stage_started;     /*!< The staged note has started and the player has not been told yet */
+    uint32_t staged_duration_ms;    /*!< Duration of the staged note */
+    uint32_t staged_duration_psc;   /*!< PSC of the note duration timer for the staged note */
+    uint32_t staged_duration_arr;   /*!< ARR of the note duration timer for the staged note */
 } port_buzzer_hw_t;         
 
 
@@ -47,7 +80,7 @@ extern port_buzzer_hw_t buzzers_arr[];
 /// @param buzzer_id The unique identifier of the buzzer
 void port_buzzer_init(uint32_t buzzer_id);
 
-/// @brief Stops the PMW to stop the buzzer
+/// @brief Stops the PMW to stop the buzzer, and the note duration timer. The control timer stops with the last voice.
 /// @param buzzer_id The unique identifier of the buzzer
 void port_buzzer_stop(uint32_t buzzer_id); 	
 
@@ -56,14 +89,94 @@ void port_buzzer_stop(uint32_t buzzer_id);
 /// @return True if note has ended, false if not
 bool port_buzzer_get_note_timeout(uint32_t buzzer_id);
 
-/// @brief Sets the timer that controls the note duration to the desired one
+/// @brief Sets the timer that controls the note duration to the desired one, and the release of the envelopes to end
+/// with it. The timer is shared by all the voices: the voices armed with `port_buzzer_arm_note()` start with it, at the
+/// same clock edge.
 /// @param buzzer_id  The unique identifier of the buzzer
 /// @param duration_ms Desired duration
 void port_buzzer_set_note_duration(uint32_t buzzer_id, uint32_t duration_ms);
 
-/// @brief Set PMW period to match desired frequency
+/// @brief Set PMW period to match desired frequency and start the attack of the envelope
 /// @param buzzer_id The unique identifier of the buzzer
 /// @param frequency_hz The desired frequency
+/// @param volume Volume of the note, from 0 to 1, evenly spaced in dB (see envelope.h)
 void port_buzzer_set_note_frequency(uint32_t buzzer_id, double frequency_hz, double volume);
 
+/// @brief Set the PWM of a voice as `port_buzzer_set_note_frequency()`, but armed: it starts with the note duration
+/// timer, in `port_buzzer_set_note_duration()`, together with the other armed voices
+/// @param buzzer_id The unique identifier of the buzzer
+/// @param frequency_hz The desired frequency, 0 to keep the voice silent during the note
+/// @param volume Volume of the note, from 0 to 1, evenly spaced in dB (see envelope.h)
+void port_buzzer_arm_note(uint32_t buzzer_id, double frequency_hz, double volume);
+
+/// @brief Pause the current note: stop the PWM and the note duration timer, keeping the count of the latter. All the
+/// voices pause, as they share the timer.
+/// @param buzzer_id The unique identifier of the buzzer
+void port_buzzer_pause_note(uint32_t buzzer_id);
+
+/// @brief Resume the paused note: the PWM at the same frequency and the note duration timer from the count where it
+/// was paused, so the note lasts what it had left, to a tick of the timer. The voices that were sounding start again
+/// with the trigger of the timer, still in phase.
+/// @param buzzer_id The unique identifier of the buzzer
+void port_buzzer_resume_note(uint32_t buzzer_id);
+
+/// @brief Get the time left of the current note, from the count of the note duration timer
+/// @param buzzer_id The unique identifier of the buzzer
+/// @return Time left in microseconds, 0 if the note has ended
+uint32_t port_buzzer_get_note_remaining_us(uint32_t buzzer_id);
+
+/// @brief Get the frequency the PWM timer produces, which is the desired one rounded to its PSC and ARR
+/// @param buzzer_id The unique identifier of the buzzer
+/// @return Frequency in Hz, 0 if the buzzer is stopped. An armed voice gives the frequency it will start at.
+double port_buzzer_get_note_frequency(uint32_t buzzer_id);
+
+/// @brief Set the envelope of the next notes
+/// @param buzzer_id The unique identifier of the buzzer
+/// @param p_config Attack, decay, sustain and release
+void port_buzzer_set_envelope(uint32_t buzzer_id, const envelope_config_t *p_config);
+
+/// @brief Set the pitch effects of the note that has just started. Called between `port_buzzer_set_note_frequency()`
+/// and `port_buzzer_set_note_duration()`. The prescaler grows if the effects take the period beyond 16 bits.
+/// @param buzzer_id The unique identifier of the buzzer
+/// @param p_fx Effects of the note, NULL for none
+/// @param next_frequency_hz Frequency of the next note, where the slide ends, 0 if there is none
+/// @param duration_ms Duration of the note
+void port_buzzer_set_note_effects(uint32_t buzzer_id, const note_fx_t *p_fx, double next_frequency_hz,
+                                  uint32_t duration_ms);
+
+/// @brief Stage the PWM of a voice for the note that follows the current one, with its timer values worked out now.
+/// `port_buzzer_stage_duration()` makes the stage ready.
+/// @param buzzer_id The unique identifier of the buzzer
+/// @param frequency_hz The desired frequency, 0 to keep the voice silent during the staged note
+/// @param volume Volume of the note, from 0 to 1, evenly spaced in dB (see envelope.h)
+void port_buzzer_stage_note(uint32_t buzzer_id, double frequency_hz, double volume);
+
+/// @brief Stage the duration of the note that follows the current one and make the stage ready: instead of ending
+/// the current note, the update event of the note duration timer starts the staged voices from `buzzer_id` on, and
+/// silences the others, without waiting for the player.
+/// @param buzzer_id The unique identifier of the buzzer
+/// @param duration_ms Duration of the staged note
+void port_buzzer_stage_duration(uint32_t buzzer_id, uint32_t duration_ms);
+
+/// @brief Start the staged note, if it is ready. Called by the interrupt of the note duration timer, TIM2, before the
+/// note end flags are set.
+/// @param buzzer_id The unique identifier of the buzzer
+/// @return true if the staged note has started, and the current note does not end
+bool port_buzzer_start_staged_note(uint32_t buzzer_id);
+
+/// @brief Check if the staged note has started, once
+/// @param buzzer_id The unique identifier of the buzzer
+/// @return true the first time it is called after the staged note started
+bool port_buzzer_get_staged_start(uint32_t buzzer_id);
+
+/// @brief Drop the staged note: the current note ends as usual
+/// @param buzzer_id The unique identifier of the buzzer
+void port_buzzer_clear_stage(uint32_t buzzer_id);
+
+/// @brief Advance the envelope and the pitch effects a tick and load the auto-reload and the duty cycle into the PWM.
+/// Called for each voice by the interrupt of the control timer, TIM5, at `ENVELOPE_RATE_HZ`, which stops once the
+/// releases of all the voices reach silence.
+/// @param buzzer_id The unique identifier of the buzzer
+void port_buzzer_control_tick(uint32_t buzzer_id);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+/**
+ * @file port_flash.h
+ * @brief Header for port_flash.c file.
+ *
+ * Flash sectors reserved for the melody store (see melody_store.h) and for the settings (see settings_store.h). The
+ * sectors are memory mapped, so they are read in place; they are written by halfwords, which can only clear bits, and
+ * erased as a whole. The program must stay in sectors 0 to 4, the first 128 KB: the build fails otherwise (see
+ * check_flash_size.cmake).
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#ifndef PORT_FLASH_H_
+#define PORT_FLASH_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* HW dependent includes */
+#include "stm32f4xx.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+/// @brief Sector of the store: the last one of the 512 KB of the STM32F446RE. The program must not reach it: the build
+/// checks that it ends before the settings, and port_flash.c that the settings end before the store.
+#define PORT_FLASH_STORE_SECTOR 7
+
+/// @brief Address of the store
+#define PORT_FLASH_STORE_ADDRESS 0x08060000U
+
+/// @brief Bytes of the store
+#define PORT_FLASH_STORE_SIZE (128U * 1024U)
+
+/// @brief First sector of the settings: sectors 5 and 6, between the program and the store
+#define PORT_FLASH_SETTINGS_SECTOR 5
+
+/// @brief Sectors of the settings, used in turns
+#define PORT_FLASH_SETTINGS_SECTORS 2U
+
+/// @brief Address of the first sector of the settings
+#define PORT_FLASH_SETTINGS_ADDRESS 0x08020000U
+
+/// @brief Bytes of each sector of the settings
+#define PORT_FLASH_SETTINGS_SIZE (128U * 1024U)
+
+/// @brief Value of an erased byte
+#define PORT_FLASH_ERASED 0xFFU
+
+/// @brief Keys that unlock the control register (FLASH_KEYR)
+#define PORT_FLASH_KEY_1 0x45670123U
+#define PORT_FLASH_KEY_2 0xCDEF89ABU /*!< Second key */
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/// @brief Get the store, mapped in memory.
+/// @return Pointer to the first byte of the store
+const uint8_t *port_flash_get_store(void);
+
+/// @brief Erase the store: every byte becomes `PORT_FLASH_ERASED`. The CPU stalls for about 1 s if it runs from flash.
+/// @return true if the sector was erased, false if the flash reported an error
+bool port_flash_erase_store(void);
+
+/// @brief Program bytes of the store, a halfword at a time (about 16 us each). Programming can only clear bits.
+/// @param offset Position in the store, even
+/// @param p_data Pointer to the data
+/// @param length Bytes to program, even
+/// @return true if programmed, false if out of the store, misaligned or the flash reported an error
+bool port_flash_program(uint32_t offset, const void *p_data, uint32_t length);
+
+/// @brief Get a sector of the settings, mapped in memory.
+/// @param sector Sector, from 0 to `PORT_FLASH_SETTINGS_SECTORS - 1`
+/// @return Pointer to the first byte of the sector
+const uint8_t *port_flash_get_settings(uint32_t sector);
+
+/// @brief Erase a sector of the settings: every byte becomes `PORT_FLASH_ERASED`. The CPU stalls for about 1 s if it
+/// runs from flash.
+/// @param sector Sector, from 0 to `PORT_FLASH_SETTINGS_SECTORS - 1`
+/// @return true if the sector was erased, false if it does not exist or the flash reported an error
+bool port_flash_erase_settings(uint32_t sector);
+
+/// @brief Program bytes of a sector of the settings, a halfword at a time (about 16 us each).
+/// @param sector Sector, from 0 to `PORT_FLASH_SETTINGS_SECTORS - 1`
+/// @param offset Position in the sector, even
+/// @param p_data Pointer to the data
+/// @param length Bytes to program, even
+/// @return true if programmed, false if out of the sector, misaligned or the flash reported an error
+bool port_flash_program_settings(uint32_t sector, uint32_t offset, const void *p_data, uint32_t length);
+
+#endif /* PORT_FLASH_H_ */
@@ -59,6 +59,22 @@
 /// @brief I2C address shifted one bit to the left as a 7 bit address is expected
 #define DEVICE_ADDR     (0x27 << 1)
 
+/// @brief Identifier of the display
+#define LCD_0_ID 0
+
+/// @brief Structure to define the state of the driver of a display
+typedef struct
+{
+  uint8_t dpFunction;   /*!< Function set of the display */
+  uint8_t dpControl;    /*!< Display control */
+  uint8_t dpMode;       /*!< Entry mode */
+  uint8_t dpRows;       /*!< Number of rows */
+  uint8_t dpBacklight;  /*!< Backlight bit of the expander */
+} port_lcd_hw_t;
+
+/// @brief Array of elements with the state of the displays
+extern port_lcd_hw_t lcds_arr[];
+
 /// @brief Initializes lcd screen
 /// @param rows 
 void port_lcd_init(uint8_t rows);
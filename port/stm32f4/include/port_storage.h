@@ -0,0 +1,71 @@
+/**
+ * @file port_storage.h
+ * @brief Header for port_storage.c file.
+ *
+ * External SPI NOR flash (W25Q series or compatible) that holds the streamed melodies (see melody_stream.h). It is
+ * read with the READ command (0x03): the command and the address are sent by polling and the data arrive through
+ * DMA, so the CPU is free while a read is in progress. A single read can be in progress.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+#ifndef PORT_STORAGE_H_
+#define PORT_STORAGE_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* HW dependent includes */
+#include "stm32f4xx.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define STORAGE_SPI SPI2                    /*!< SPI of the external flash */
+#define STORAGE_GPIO GPIOB                  /*!< GPIO port of the pins of the SPI */
+#define STORAGE_PIN_CS 12                   /*!< Chip select (PB12), driven by software */
+#define STORAGE_PIN_SCK 13                  /*!< Clock (PB13) */
+#define STORAGE_PIN_MISO 14                 /*!< Data from the flash (PB14) */
+#define STORAGE_PIN_MOSI 15                 /*!< Data to the flash (PB15) */
+#define STORAGE_AF 5                        /*!< Alternate function of SPI2 */
+#define STORAGE_DMA_RX DMA1_Stream3         /*!< DMA stream of the reception (SPI2_RX, channel 0) */
+#define STORAGE_DMA_TX DMA1_Stream4         /*!< DMA stream of the dummy bytes (SPI2_TX, channel 0) */
+#define STORAGE_DMA_CHANNEL 0               /*!< DMA channel of both streams */
+#define STORAGE_DMA_IRQ DMA1_Stream3_IRQn   /*!< Interrupt of the end of a read */
+#define STORAGE_SIZE (16U * 1024U * 1024U)  /*!< Bytes of the flash (W25Q128) */
+#define STORAGE_CMD_READ 0x03U              /*!< Read data command */
+#define STORAGE_DUMMY 0xFFU                 /*!< Byte sent while receiving */
+
+/* Function prototypes and explanation -------------------------------------------------*/
+
+/// @brief Configure the SPI, its pins and its DMA streams. The SPI clock is PCLK1 / 4.
+void port_storage_init(void);
+
+/// @brief Get the size of the storage.
+/// @return Bytes
+uint32_t port_storage_get_size(void);
+
+/// @brief Start reading the storage. The data are complete once port_storage_is_busy() returns false.
+/// @param address Position of the first byte
+/// @param p_data Pointer to the buffer, that must stay valid until the end of the read
+/// @param length Bytes to read, from 1 to 65535
+/// @return true if the read started, false if another one is in progress or it is out of the storage
+bool port_storage_start_read(uint32_t address, void *p_data, uint32_t length);
+
+/// @brief Read the storage and wait for the end of the read. A read in progress is finished first.
+/// @param address Position of the first byte
+/// @param p_data Pointer to the buffer
+/// @param length Bytes to read, from 1 to 65535
+/// @return true if read, false if it is out of the storage
+bool port_storage_read(uint32_t address, void *p_data, uint32_t length);
+
+/// @brief Check if a read is in progress.
+/// @return true while the DMA receives the data
+bool port_storage_is_busy(void);
+
+/// @brief End a read: release the chip select. Called by the interrupt of the DMA stream of the reception.
+void port_storage_end_read(void);
+
+#endif /* PORT_STORAGE_H_ */
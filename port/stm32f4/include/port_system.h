@@ -74,6 +74,20 @@
 #define SWO_Pin GPIO_PIN_3
 #define SWO_GPIO_Port GPIOB
 
+/* Hooks of the peripheral models ---------------------------------------------*/
+/* The drivers of this port also run on the register models of the native platform, which define these hooks to learn
+   what the hardware notices by itself (see port/native/include/port_system.h). On the target they are no more than
+   the register access. */
+#define PORT_MODEL_TIM_SYNC(p_tim) ((void)0)                                /*!< The driver wrote the registers of a timer */
+#define PORT_MODEL_USART_SYNC(p_usart) ((void)0)                            /*!< The driver changed the interrupt enables of a USART */
+#define PORT_MODEL_USART_READ_DR(p_usart) ((p_usart) -> DR)                 /*!< Read of the data register of a USART */
+#define PORT_MODEL_USART_WRITE_DR(p_usart, data) ((p_usart) -> DR = (data)) /*!< Write of the data register of a USART */
+#define PORT_MODEL_RUN_CPU(cycles) ((void)0)                                /*!< CPU time spent by the driver */
+#define PORT_MODEL_POLL() ((void)0)                                         /*!< An iteration of a polling loop */
+
+/// @brief Define the array of elements of a driver. The native platform keeps a copy in each board context.
+#define PORT_BOARD_ARRAY(type, name, getter, length, ...) type name[length] = __VA_ARGS__
+
 /* Function prototypes and explanation -------------------------------------------------*/
 
 /**
@@ -119,6 +133,16 @@ uint32_t port_system_get_millis(void);
 º */
 void port_system_set_millis(uint32_t ms);
 
+/// @brief Get the cycle counter of the core (DWT CYCCNT). It runs at `SystemCoreClock` and wraps around every 2^32 cycles.
+/// @return uint32_t
+uint32_t port_system_get_cycles(void);
+
+/// @brief Write a character of the log without waiting (see fsm_log.h): to the stimulus port 0 of the ITM (SWO). Without
+/// a debugger the ITM is off and the character is discarded, as `ITM_SendChar()` does.
+/// @param c Character
+/// @return true if the character was taken, false if the FIFO of the ITM is full
+bool port_system_log_put_char(char c);
+
 /**
  * @brief Wait for some milliseconds
  *
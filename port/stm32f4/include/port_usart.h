@@ -42,8 +42,30 @@
 /// @brief USART 0 alternate function for RX
 #define USART_0_AF_RX 7
  
-/// @brief USART input data length
-#define USART_INPUT_BUFFER_LENGTH 10
+/// @brief USART 0 baud rate at start-up
+#define USART_0_BAUD_RATE 9600
+
+/// @brief USART 0 receives through circular DMA and the IDLE interrupt: one interrupt per burst instead of one per byte
+#define USART_0_RX_DMA true
+
+/// @brief DMA stream of the reception of USART 0 (USART3_RX is request 4 of DMA1 stream 1)
+#define USART_0_DMA_STREAM DMA1_Stream1
+
+/// @brief DMA channel (request) of the reception of USART 0
+#define USART_0_DMA_CHANNEL 4
+
+/// @brief Interrupt of the DMA stream of USART 0
+#define USART_0_DMA_IRQ DMA1_Stream1_IRQn
+
+/// @brief Length of the circular buffer of the DMA reception. The half and full transfer interrupts empty it when a
+/// burst is longer than half of it.
+#define USART_RX_DMA_BUFFER_LENGTH 128
+
+/// @brief Largest error of the baud rate obtained from the clock of the USART, in thousandths of the requested one
+#define USART_BAUD_RATE_MAX_ERROR 20
+
+/// @brief USART input data length: a batch of commands or a macro definition takes a whole line
+#define USART_INPUT_BUFFER_LENGTH 64
 
 /// @brief USART output data length
 #define USART_OUTPUT_BUFFER_LENGTH 100
@@ -54,6 +76,12 @@
 /// @brief Char that indicates data ends
 #define END_CHAR_CONSTANT 0xA
 
+/// @brief Byte that ends a frame of the binary protocol. As the first byte of a message, it starts a binary session.
+#define USART_FRAME_DELIMITER 0x0
+
+/// @brief USART input frame length (longest encoded frame of the binary protocol, without the delimiter)
+#define USART_FRAME_BUFFER_LENGTH 24
+
 /* Typedefs --------------------------------------------------------------------*/
 /// @brief Structure that defines HW of a UART
 typedef struct{
@@ -64,9 +92,21 @@ typedef struct{
     uint8_t pin_rx;                                     /*!< RX pin */
     uint8_t alt_func_tx;                                /*!< Alternate function for the TX pin */
     uint8_t alt_func_rx;                                /*!< Alternate function for the RX pin */
+    uint32_t baud_rate;                                 /*!< Baud rate */
+    bool rx_dma;                                        /*!< Reception through circular DMA and the IDLE interrupt */
+    DMA_Stream_TypeDef* p_dma_stream;                   /*!< DMA stream of the reception */
+    uint8_t dma_channel;                                /*!< DMA channel of the reception */
+    IRQn_Type dma_irq;                                  /*!< Interrupt of the DMA stream */
+    uint8_t rx_dma_buffer [USART_RX_DMA_BUFFER_LENGTH]; /*!< Circular buffer written by the DMA */
+    uint8_t rx_dma_idx;                                 /*!< Next byte of the circular buffer to process */
     char input_buffer [USART_INPUT_BUFFER_LENGTH];      /*!< Input buffer */
     uint8_t i_idx;                                      /*!< Input buffer index */
     bool read_complete;                                 /*!< Flag to indicate if read is complete */
+    uint32_t rx_end_cycles;                             /*!< Cycle counter when the end character arrived */
+    bool binary;                                        /*!< Binary session: frames ended by `USART_FRAME_DELIMITER` */
+    uint8_t frame_buffer [USART_FRAME_BUFFER_LENGTH];   /*!< Input frame of the binary session */
+    uint8_t frame_length;                               /*!< Bytes of the input frame */
+    uint32_t rx_overflows;                              /*!< Messages received that did not fit in the input buffers */
     char output_buffer [USART_OUTPUT_BUFFER_LENGTH];    /*!< Output buffer */
     uint8_t o_idx;                                      /*!< Output buffer index  */
     bool write_complete;                                /*!< Flag to indicate if write is complete */
@@ -82,6 +122,30 @@ extern port_usart_hw_t usart_arr[];
 /// @param usart_id USART identifier
 void port_usart_init(uint32_t usart_id);
 
+/// @brief Compute the value of the BRR register for a baud rate, with 16x oversampling: the clock divided by the rate,
+/// with 4 bits of fraction.
+/// @param pclk_hz Clock of the USART
+/// @param baud_rate Baud rate
+/// @return BRR value, or 0 if the rate cannot be obtained within `USART_BAUD_RATE_MAX_ERROR`
+uint32_t port_usart_compute_brr(uint32_t pclk_hz, uint32_t baud_rate);
+
+/// @brief Checks if the USART can work at a baud rate with the current clock of its bus
+/// @param usart_id USART identifier
+/// @param baud_rate Baud rate
+/// @return True if the rate can be obtained within `USART_BAUD_RATE_MAX_ERROR`
+bool port_usart_check_baud_rate(uint32_t usart_id, uint32_t baud_rate);
+
+/// @brief Changes the baud rate. It waits for the byte being sent to leave the line.
+/// @param usart_id USART identifier
+/// @param baud_rate Baud rate
+/// @return True if the rate was changed, false if it cannot be obtained (the rate is kept)
+bool port_usart_set_baud_rate(uint32_t usart_id, uint32_t baud_rate);
+
+/// @brief Gets the baud rate
+/// @param usart_id USART identifier
+/// @return Baud rate, as requested
+uint32_t port_usart_get_baud_rate(uint32_t usart_id);
+
 /// @brief Checks if TX has ended
 /// @param usart_id USART identifier
 /// @return True if TX han ended, false if not
@@ -92,11 +156,39 @@ bool port_usart_tx_done(uint32_t usart_id);
 /// @return True if RX has ended, false if not
 bool port_usart_rx_done(uint32_t usart_id);
 
+/// @brief Get the cycle counter when the end character of the last message arrived. It is stored by the USART ISR.
+/// @param usart_id USART identifier
+/// @return Cycle counter (see `port_system_get_cycles()`)
+uint32_t port_usart_get_rx_end_cycles(uint32_t usart_id);
+
 /// @brief Copies data in the input buffer
 /// @param usart_id USART identifier
 /// @param p_buffer Pointer to where data will be copied
 void port_usart_get_from_input_buffer(uint32_t usart_id, char *p_buffer);
 
+/// @brief Copies the frame received in a binary session, without its delimiter
+/// @param usart_id USART identifier
+/// @param p_buffer Pointer to where the frame will be copied, of `USART_FRAME_BUFFER_LENGTH` bytes
+/// @return Bytes of the frame
+uint32_t port_usart_get_from_frame_buffer(uint32_t usart_id, uint8_t *p_buffer);
+
+/// @brief Gets the messages received that did not fit in the input buffers: text messages that wrapped around the
+/// input buffer and frames longer than the frame buffer
+/// @param usart_id USART identifier
+/// @return Messages lost since the USART was initialized
+uint32_t port_usart_get_rx_overflows(uint32_t usart_id);
+
+/// @brief Select the framing of the session: text messages ended by `END_CHAR_CONSTANT` or binary frames ended by
+/// `USART_FRAME_DELIMITER`. A text session also becomes binary when a message starts with `USART_FRAME_DELIMITER`.
+/// @param usart_id USART identifier
+/// @param binary True for a binary session
+void port_usart_set_binary(uint32_t usart_id, bool binary);
+
+/// @brief Checks if the session is binary
+/// @param usart_id USART identifier
+/// @return True if the session is binary, false if it is text
+bool port_usart_get_binary(uint32_t usart_id);
+
 /// @brief Checks if USART can recieve data
 /// @param usart_id USART identifier
 /// @return TXE flag
@@ -120,11 +212,20 @@ void port_usart_reset_output_buffer(uint32_t usart_id);
 /// @param usart_id USART identifier
 void port_usart_store_data(uint32_t usart_id);
 
+/// @brief Stores in the input buffer the bytes that the DMA wrote to the circular buffer since the last call, one by
+/// one as port_usart_store_data(). It is called on the IDLE interrupt and on the half and full transfer interrupts.
+/// @param usart_id USART identifier
+void port_usart_store_dma_data(uint32_t usart_id);
+
+/// @brief Clears the IDLE flag (a read of SR followed by a read of DR)
+/// @param usart_id USART identifier
+void port_usart_clear_idle(uint32_t usart_id);
+
 /// @brief Writes data from output buffer to the data register
 /// @param usart_id USART identifier
 void port_usart_write_data(uint32_t usart_id);
 
-/// @brief Disables USART RX interrupts
+/// @brief Disables USART RX interrupts, and the DMA reception if it is used
 /// @param usart_id USART identifier
 void port_usart_disable_rx_interrupt(uint32_t usart_id);
 
@@ -132,7 +233,7 @@ void port_usart_disable_rx_interrupt(uint32_t usart_id);
 /// @param usart_id USART identifier
 void port_usart_disable_tx_interrupt(uint32_t usart_id);
 
-/// @brief Enables USART RX interrupts
+/// @brief Enables USART RX interrupts: RXNE, or the circular DMA reception and the IDLE interrupt if `rx_dma` is set
 /// @param usart_id USART identifier
 void port_usart_enable_rx_interrupt(uint32_t usart_id);
 
@@ -16,6 +16,7 @@
 #include "port_usart.h"
 #include "port_buzzer.h"
 #include "port_nec.h"
+#include "port_storage.h"
 
 /**
  * @brief Interrupt service routine for the System tick timer (SysTick).
@@ -52,24 +53,72 @@ void EXTI15_10_IRQHandler(void){
 /// @brief Handles UART3 interrupts
 /// @param  void
 void USART3_IRQHandler(void){
+  uint32_t cycles = port_system_get_cycles();
   USART_TypeDef *p_usart = usart_arr[USART_0_ID].p_usart;
-  if((p_usart -> SR && USART_SR_RXNE) && (p_usart -> CR1 && USART_CR1_RXNEIE)){
+  bool read_complete = usart_arr[USART_0_ID].read_complete;
+  if((p_usart -> SR & USART_SR_RXNE) && (p_usart -> CR1 & USART_CR1_RXNEIE)){
     port_system_systick_resume();
     port_usart_store_data(USART_0_ID);
   }
-  if((p_usart -> SR && USART_SR_TXE) && (p_usart -> CR1 && USART_CR1_TXEIE)){
+  // DMA reception: the line went idle after a burst
+  if((p_usart -> SR & USART_SR_IDLE) && (p_usart -> CR1 & USART_CR1_IDLEIE)){
+    port_system_systick_resume();
+    port_usart_clear_idle(USART_0_ID);
+    port_usart_store_dma_data(USART_0_ID);
+  }
+  // Timestamp the end character of a message: the origin of the command latency
+  if(!read_complete && usart_arr[USART_0_ID].read_complete){
+    usart_arr[USART_0_ID].rx_end_cycles = cycles;
+  }
+  if((p_usart -> SR & USART_SR_TXE) && (p_usart -> CR1 & USART_CR1_TXEIE)){
     port_system_systick_resume();
     port_usart_write_data(USART_0_ID);
   }
 }
 
+/// @brief Handles the DMA reception of UART3: half or all of the circular buffer was written within a burst
+/// @param  void
+void DMA1_Stream1_IRQHandler(void){
+  uint32_t cycles = port_system_get_cycles();
+  DMA1->LIFCR = DMA_LIFCR_CHTIF1 | DMA_LIFCR_CTCIF1;
+  port_system_systick_resume();
+  bool read_complete = usart_arr[USART_0_ID].read_complete;
+  port_usart_store_dma_data(USART_0_ID);
+  if(!read_complete && usart_arr[USART_0_ID].read_complete){
+    usart_arr[USART_0_ID].rx_end_cycles = cycles;
+  }
+}
+
+void DMA1_Stream3_IRQHandler(void){
+  // End of a read of the external flash
+  port_storage_end_read();
+}
+
 void TIM2_IRQHandler(void){
   // Clear the update interrupt flag
   TIM2->SR = ~TIM_SR_UIF;
-  buzzers_arr[0].note_end = true;
+  // A staged note starts right at the end of this one, without waiting for the player
+  for(uint32_t id = 0; id < BUZZERS_LENGTH; id++){
+    if(port_buzzer_start_staged_note(id)){
+      return;
+    }
+  }
+  // The note ends in every voice at once
+  for(uint32_t id = 0; id < BUZZERS_LENGTH; id++){
+    buzzers_arr[id].note_end = true;
+  }
 }
 
 void TIM4_IRQHandler(void){
   // Clear the update interrupt flag
   TIM4->SR = ~TIM_SR_UIF;
-}
\ No newline at end of file
+}
+
+void TIM5_IRQHandler(void){
+  // Clear the update interrupt flag
+  TIM5->SR = ~TIM_SR_UIF;
+  // Next tick of the envelope and the pitch effects of the note of each voice
+  for(uint32_t id = 0; id < BUZZERS_LENGTH; id++){
+    port_buzzer_control_tick(id);
+  }
+}
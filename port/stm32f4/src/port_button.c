@@ -14,9 +14,9 @@
 
 /* Global variables ------------------------------------------------------------*/
 
-port_button_hw_t buttons_arr[] = {
+PORT_BOARD_ARRAY(port_button_hw_t, buttons_arr, port_button_get_arr, BUTTON_0_ID + 1, {
     [BUTTON_0_ID] = {.p_port = BUTTON_0_GPIO, .pin = BUTTON_0_PIN, .flag_pressed = false}
-};
+});
 
 void port_button_init(uint32_t button_id){
     GPIO_TypeDef *p_port = buttons_arr[button_id].p_port;
@@ -27,6 +27,7 @@ void port_button_init(uint32_t button_id){
 }
 
 bool port_button_is_pressed(uint32_t button_id){
+    PORT_MODEL_POLL();
     return buttons_arr[button_id].flag_pressed;
 }
 
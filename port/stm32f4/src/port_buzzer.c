@@ -14,96 +14,236 @@
 
 #include "port_buzzer.h"
 
+/* Other libraries */
+
+#include "note_pwm.h"
+
 /* Defines and enums ----------------------------------------------------------*/
 /* Defines */
 
+#define ALT_FUNC1_TIM1 1
+
 #define ALT_FUNC2_TIM3 2
 
+#define ALT_FUNC3_TIM8 3
+
 #define TIM_AS_PWM1_MASK 96
 
 #define ARR_MAX 65535
 
+#define TIM_ENVELOPE_CLOCK_HZ 1000000
+
 /* Global variables */
 
-port_buzzer_hw_t buzzers_arr[] = {
+PORT_BOARD_ARRAY(port_buzzer_hw_t, buzzers_arr, port_buzzer_get_arr, BUZZERS_LENGTH, {
   [BUZZER_0_ID] = {.p_port = BUZZER_0_GPIO,
                    .pin = BUZZER_0_PIN,
                    .alt_func =  ALT_FUNC2_TIM3,
+                   .p_tim = BUZZER_0_TIM,
+                   .note_end = false
+                  },
+  [BUZZER_1_ID] = {.p_port = BUZZER_1_GPIO,
+                   .pin = BUZZER_1_PIN,
+                   .alt_func =  ALT_FUNC1_TIM1,
+                   .p_tim = BUZZER_1_TIM,
+                   .note_end = false
+                  },
+  [BUZZER_2_ID] = {.p_port = BUZZER_2_GPIO,
+                   .pin = BUZZER_2_PIN,
+                   .alt_func =  ALT_FUNC3_TIM8,
+                   .p_tim = BUZZER_2_TIM,
                    .note_end = false
                   }
-};
+});
 
 /* Private functions */
 
+/// @brief Enable the clock of a PWM timer: TIM3 is on APB1, TIM1 and TIM8 on APB2
+/// @param p_tim PWM timer
+static void _timer_clock_enable(TIM_TypeDef *p_tim){
+  if(p_tim == TIM3){
+    RCC->APB1ENR |= RCC_APB1ENR_TIM3EN;
+  }
+  else if(p_tim == TIM1){
+    RCC->APB2ENR |= RCC_APB2ENR_TIM1EN;
+  }
+  else if(p_tim == TIM8){
+    RCC->APB2ENR |= RCC_APB2ENR_TIM8EN;
+  }
+}
+
+/// @brief Check if any voice has an envelope that needs ticks
+/// @return true if the control timer must keep running
+static bool _is_envelope_active(void){
+  for(uint32_t id = 0; id < BUZZERS_LENGTH; id++){
+    if(envelope_is_active(&buzzers_arr[id].envelope)){
+      return true;
+    }
+  }
+  return false;
+}
+
+/// @brief Restart the ticks of the control timer from the start of a note, in step with the note duration timer
+static void _timer_control_restart(void){
+  TIM5->CR1 &= ~TIM_CR1_CEN;
+  TIM5->CNT = 0;
+  TIM5->SR = ~TIM_SR_UIF;
+  if(_is_envelope_active()){
+    TIM5->CR1 |= TIM_CR1_CEN;
+  }
+  PORT_MODEL_TIM_SYNC(TIM5);
+}
+
+/// @brief Silence a voice: its PWM stops, with its envelope and effects, and it no longer waits for the trigger
+/// @param buzzer_id The unique identifier of the buzzer
+static void _voice_stop(uint32_t buzzer_id){
+  port_buzzer_hw_t *p_buzzer = &buzzers_arr[buzzer_id];
+  TIM_TypeDef *p_tim = p_buzzer->p_tim;
+  p_tim->CR1 &= ~TIM_CR1_CEN;
+  p_tim->SMCR &= ~TIM_SMCR_SMS;
+  PORT_MODEL_TIM_SYNC(p_tim);
+  p_buzzer->armed = false;
+  envelope_stop(&p_buzzer->envelope);
+  note_fx_stop(&p_buzzer->fx);
+}
+
 /// @brief  Enables TIMER 2 to count notes duartion
 /// @param buzzer_id The unique identifier of the buzzer
 static void _timer_duration_setup(uint32_t buzzer_id)
 {
-  if (buzzer_id == BUZZER_0_ID)
-  {
-    // Enable the timer clock
-    RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
-    // Set clock source to internal
-    TIM2->CR1 &= ~TIM_CR1_CEN;
-    // Set counter to 0
-    TIM2->CNT = 0;
-    // Enable autoreload preload
-    TIM2->CR1 |= TIM_CR1_ARPE;
-    // Clear the update interrupt flag
-    TIM2->SR = ~TIM_SR_UIF;
-    // Enable update interrupt
-    TIM2->DIER |= TIM_DIER_UIE;
-    /* Configure interruptions */
-    NVIC_SetPriority(TIM2_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 3, 0)); 
-    NVIC_EnableIRQ(TIM2_IRQn);                                                        
-  }
-}
-
-/// @brief Enables TIMER 3 in PWM note to play frequencies trough buzzer
+  // Enable the timer clock
+  RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
+  // Set clock source to internal
+  TIM2->CR1 &= ~TIM_CR1_CEN;
+  // Set counter to 0
+  TIM2->CNT = 0;
+  // Enable autoreload preload
+  TIM2->CR1 |= TIM_CR1_ARPE;
+  // The counter enable is the trigger output, which starts the PWM of the armed voices
+  TIM2->CR2 = (TIM2->CR2 & ~TIM_CR2_MMS) | TIM_CR2_MMS_0;
+  // Clear the update interrupt flag
+  TIM2->SR = ~TIM_SR_UIF;
+  // Enable update interrupt
+  TIM2->DIER |= TIM_DIER_UIE;
+  /* Configure interruptions */
+  NVIC_SetPriority(TIM2_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 3, 0)); 
+  NVIC_EnableIRQ(TIM2_IRQn);                                                        
+}
+
+/// @brief Enables the timer of a voice in PWM note to play frequencies trough buzzer
 /// @param buzzer_id The unique identifier of the buzzer
 static void _timer_pwm_setup(uint32_t buzzer_id){
-  if (buzzer_id == BUZZER_0_ID)
-  {
-    // Enable the timer clock
-    RCC->APB1ENR |= RCC_APB1ENR_TIM3EN;
-    // Set clock source to internal
-    TIM3->CR1 &= ~TIM_CR1_CEN;
-    // Enable autoreload preload
-    TIM3->CR1 |= TIM_CR1_ARPE;
-    // Set counter to 0
-    TIM3->CNT = 0;
-    // Set ARR and PSC to 0
-    TIM3->ARR = 0;
-    TIM3->PSC = 0;
-    TIM2->EGR = TIM_EGR_UG;
-    // Disable output compare of channel 1
-    TIM3->CCER &= ~TIM_CCER_CC1E;
-    // Set mode to PWM1
-    TIM3->CCMR1 |= TIM_AS_PWM1_MASK;
-    // Enable preload
-    TIM3->CCMR1 |= TIM_CCMR1_OC1PE;                                                      
-  }   
+  TIM_TypeDef *p_tim = buzzers_arr[buzzer_id].p_tim;
+  // Enable the timer clock
+  _timer_clock_enable(p_tim);
+  // Set clock source to internal
+  p_tim->CR1 &= ~TIM_CR1_CEN;
+  // Enable autoreload preload
+  p_tim->CR1 |= TIM_CR1_ARPE;
+  // Set counter to 0
+  p_tim->CNT = 0;
+  // Set ARR and PSC to 0
+  p_tim->ARR = 0;
+  p_tim->PSC = 0;
+  p_tim->EGR = TIM_EGR_UG;
+  // The trigger is TIM2, ITR1 of TIM1, TIM3 and TIM8. The slave mode is only set while the voice is armed
+  p_tim->SMCR = (p_tim->SMCR & ~(TIM_SMCR_TS | TIM_SMCR_SMS)) | TIM_SMCR_TS_0;
+  // Disable output compare of channel 1
+  p_tim->CCER &= ~TIM_CCER_CC1E;
+  // Set mode to PWM1
+  p_tim->CCMR1 |= TIM_AS_PWM1_MASK;
+  // Enable preload
+  p_tim->CCMR1 |= TIM_CCMR1_OC1PE;
+  // The outputs of the advanced timers also need the main output enable
+  if((p_tim == TIM1) || (p_tim == TIM8)){
+    p_tim->BDTR |= TIM_BDTR_MOE;
+  }
+  PORT_MODEL_TIM_SYNC(p_tim);
 }
 
-/* Public functions -----------------------------------------------------------*/
+/// @brief Enables TIMER 5 to advance the envelope of the notes at its control rate
+/// @param buzzer_id The unique identifier of the buzzer
+static void _timer_envelope_setup(uint32_t buzzer_id){
+  // Enable the timer clock
+  RCC->APB1ENR |= RCC_APB1ENR_TIM5EN;
+  // Disable the timer: it only runs while an envelope needs ticks
+  TIM5->CR1 &= ~TIM_CR1_CEN;
+  // Count microseconds up to a tick of the envelope
+  TIM5->PSC = SystemCoreClock / TIM_ENVELOPE_CLOCK_HZ - 1;
+  TIM5->ARR = TIM_ENVELOPE_CLOCK_HZ / ENVELOPE_RATE_HZ - 1;
+  TIM5->CNT = 0;
+  // Values are loaded into active registers
+  TIM5->EGR = TIM_EGR_UG;
+  // Clear the update interrupt flag
+  TIM5->SR = ~TIM_SR_UIF;
+  // Enable update interrupt
+  TIM5->DIER |= TIM_DIER_UIE;
+  /* Configure interruptions */
+  NVIC_SetPriority(TIM5_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 3, 0));
+  NVIC_EnableIRQ(TIM5_IRQn);
+}
 
-void port_buzzer_init(uint32_t buzzer_id)
-{
-  port_buzzer_hw_t buzzer = buzzers_arr[buzzer_id];
-  GPIO_TypeDef *p_port = buzzer.p_port;
-  uint8_t pin = buzzer.pin;
-  uint8_t alt_func = buzzer.alt_func;
+/// @brief Load the PWM of a voice with its PSC and ARR and the duty cycle of the start of the envelope
+/// @param buzzer_id The unique identifier of the buzzer
+/// @param PSC Prescaler of the PWM timer
+/// @param ARR Auto-reload of the PWM timer
+/// @param level Level of the envelope (see `envelope_get_level()`)
+/// @param armed The PWM starts with the trigger of the note duration timer, not now
+static void _load_pwm(uint32_t buzzer_id, uint32_t PSC, uint32_t ARR, uint32_t level, bool armed){
+  port_buzzer_hw_t *p_buzzer = &buzzers_arr[buzzer_id];
+  TIM_TypeDef *p_tim = p_buzzer->p_tim;
+  uint32_t duty;
 
-  // Configure GPIO and alt function
-  port_system_gpio_config(p_port, pin, GPIO_MODE_ALTERNATE, GPIO_PUPDR_NOPULL);
-  port_system_gpio_config_alternate(p_port, pin, alt_func);
+  // Disable timer, and the trigger of a previous note
+  p_tim->CR1 &= ~TIM_CR1_CEN;
+  p_tim->SMCR &= ~TIM_SMCR_SMS;
+  // Reset counter
+  p_tim->CNT = 0;
+  // Load autoreload register
+  p_tim->ARR = ARR;
+  // Load prescaler register
+  p_tim->PSC = PSC;
+  // Set PWM width: the output is high for CCR1 of the ARR + 1 counts of a period. The envelope starts the attack
+  // and TIM5 changes it from then on.
+  duty = envelope_note_on(&p_buzzer->envelope, level);
+  // A fixed pitch until `port_buzzer_set_note_effects()` says otherwise
+  note_fx_stop(&p_buzzer->fx);
+  p_tim->CCR1 = (duty * (ARR + 1)) >> ENVELOPE_DUTY_BITS;
+  // Values are loaded into active registers
+  p_tim->EGR = TIM_EGR_UG;
+  // Enable output compare
+  p_tim->CCER |= TIM_CCER_CC1E;
+  p_buzzer->armed = armed;
+  if(armed){
+    // Trigger mode: the rising edge of the counter enable of TIM2 sets the counter enable of this timer
+    p_tim->SMCR |= TIM_SMCR_SMS_2 | TIM_SMCR_SMS_1;
+    PORT_MODEL_TIM_SYNC(p_tim);
+    return;
+  }
+  // Enable timer
+  p_tim->CR1 |= TIM_CR1_CEN;
+  PORT_MODEL_TIM_SYNC(p_tim);
+  _timer_control_restart();
+}
 
-  // Call local functions
-  _timer_duration_setup(buzzer_id);
-  _timer_pwm_setup(buzzer_id);
+/// @brief Load the PWM of a voice: PSC and ARR of the frequency and the duty cycle of the start of the envelope
+/// @param buzzer_id The unique identifier of the buzzer
+/// @param frequency_hz The desired frequency, not 0
+/// @param volume Volume of the note
+/// @param armed The PWM starts with the trigger of the note duration timer, not now
+static void _set_pwm(uint32_t buzzer_id, double frequency_hz, double volume, bool armed){
+  // PSC and ARR with the smallest error in cents: from the table for the notes of melodies.h, solved otherwise
+  uint32_t PSC;
+  uint32_t ARR;
+  note_pwm_find(SystemCoreClock, frequency_hz, &PSC, &ARR);
+  _load_pwm(buzzer_id, PSC, ARR, envelope_get_level(volume), armed);
 }
 
-void port_buzzer_set_note_duration(uint32_t buzzer_id, uint32_t duration_ms){
+/// @brief Work out the PSC and ARR of the note duration timer for a duration
+/// @param duration_ms Desired duration
+/// @param p_psc Pointer to store the PSC
+/// @param p_arr Pointer to store the ARR
+static void _get_duration_values(uint32_t duration_ms, uint32_t *p_psc, uint32_t *p_arr){
   double sysclk_as_double = (double)SystemCoreClock;
   double ms_as_double = (double)duration_ms;
   double s_as_double = ms_as_double/1000;
@@ -121,99 +261,321 @@ void port_buzzer_set_note_duration(uint32_t buzzer_id, uint32_t duration_ms){
     // Calculate the PSC value for max ARR value
     ARR = round((sysclk_as_double * s_as_double) / (PSC + 1)) - 1;
   }
+  *p_psc = (uint32_t)round(PSC);
+  *p_arr = (uint32_t)round(ARR);
+}
 
-  switch (buzzer_id)
-  {
-    case 0:
-      // Disable timer
-      TIM2->CR1 &= ~TIM_CR1_CEN;
-      // Reset counter
-      TIM2->CNT = 0;
-      // Load autoreload register
-      TIM2->ARR = (uint32_t)round(ARR);
-      // Load prescaler register
-      TIM2->PSC = (uint32_t)round(PSC);
-      // Values are loaded into active registers
-      TIM2->EGR = TIM_EGR_UG;
-      //Se note end flag to false
-      buzzers_arr[buzzer_id].note_end = false;
-      // Enable timer
-      TIM2->CR1 |= TIM_CR1_CEN;
-      break;
-    
-    default:
-      break;
+/// @brief Start the note duration timer with its PSC and ARR, and with it the armed voices
+/// @param PSC Prescaler of the note duration timer
+/// @param ARR Auto-reload of the note duration timer
+/// @param duration_ms Duration of the note, for the release of the envelopes
+static void _start_duration(uint32_t PSC, uint32_t ARR, uint32_t duration_ms){
+  // Disable timer
+  TIM2->CR1 &= ~TIM_CR1_CEN;
+  PORT_MODEL_TIM_SYNC(TIM2);
+  // Reset counter
+  TIM2->CNT = 0;
+  // Load autoreload register
+  TIM2->ARR = ARR;
+  // Load prescaler register
+  TIM2->PSC = PSC;
+  // Values are loaded into active registers. This update event is not the end of a note
+  TIM2->EGR = TIM_EGR_UG;
+  TIM2->SR = ~TIM_SR_UIF;
+  bool armed = false;
+  for(uint32_t id = 0; id < BUZZERS_LENGTH; id++){
+    //Se note end flag to false
+    buzzers_arr[id].note_end = false;
+    // The release of the envelopes ends with the note
+    if(envelope_is_active(&buzzers_arr[id].envelope)){
+      envelope_set_gate(&buzzers_arr[id].envelope, duration_ms);
+    }
+    armed = armed || buzzers_arr[id].armed;
+  }
+  // Enable timer: its trigger output starts the armed voices at the same clock edge
+  TIM2->CR1 |= TIM_CR1_CEN;
+  PORT_MODEL_TIM_SYNC(TIM2);
+  if(armed){
+    for(uint32_t id = 0; id < BUZZERS_LENGTH; id++){
+      buzzers_arr[id].armed = false;
+    }
+    _timer_control_restart();
   }
 }
 
+/* Public functions -----------------------------------------------------------*/
+
+void port_buzzer_init(uint32_t buzzer_id)
+{
+  if(buzzer_id >= BUZZERS_LENGTH){
+    return;
+  }
+  port_buzzer_hw_t buzzer = buzzers_arr[buzzer_id];
+  GPIO_TypeDef *p_port = buzzer.p_port;
+  uint8_t pin = buzzer.pin;
+  uint8_t alt_func = buzzer.alt_func;
+
+  // Configure GPIO and alt function
+  port_system_gpio_config(p_port, pin, GPIO_MODE_ALTERNATE, GPIO_PUPDR_NOPULL);
+  port_system_gpio_config_alternate(p_port, pin, alt_func);
+
+  // Call local functions. The note duration and control timers are shared by the voices
+  _timer_duration_setup(buzzer_id);
+  _timer_pwm_setup(buzzer_id);
+  _timer_envelope_setup(buzzer_id);
+
+  // Default envelope, in silence
+  envelope_config_t config = {.attack_ms = ENVELOPE_DEFAULT_ATTACK_MS, .decay_ms = ENVELOPE_DEFAULT_DECAY_MS,
+                              .release_ms = ENVELOPE_DEFAULT_RELEASE_MS, .sustain_db = ENVELOPE_DEFAULT_SUSTAIN_DB};
+  envelope_init(&buzzers_arr[buzzer_id].envelope, &config);
+}
+
+void port_buzzer_set_note_duration(uint32_t buzzer_id, uint32_t duration_ms){
+  uint32_t PSC;
+  uint32_t ARR;
+  _get_duration_values(duration_ms, &PSC, &ARR);
+  if(buzzer_id >= BUZZERS_LENGTH){
+    return;
+  }
+  // A new note: the stage was for the end of the previous one
+  buzzers_arr[buzzer_id].stage_ready = false;
+  _start_duration(PSC, ARR, duration_ms);
+}
+
 bool port_buzzer_get_note_timeout(uint32_t buzzer_id){
+  PORT_MODEL_POLL();
   return buzzers_arr[buzzer_id].note_end;
 }
 
 void port_buzzer_set_note_frequency(uint32_t buzzer_id, double frequency_hz, double volume){
+  if(buzzer_id >= BUZZERS_LENGTH){
+    return;
+  }
   // Check if frequency is 0
   if(frequency_hz == 0){
      // Activate PWM mode
     port_buzzer_stop(buzzer_id);
     return;
   }
+  _set_pwm(buzzer_id, frequency_hz, volume, false);
+}
 
-  double sysclk_as_double = (double)SystemCoreClock;
-  double pwm_period = 1 / frequency_hz;
-  double ARR = ARR_MAX;
-  double PSC;
-  // Calculate the PSC value for max ARR value
-  PSC = round((sysclk_as_double * pwm_period) / (ARR + 1)) - 1;
-  // Calculate the PSC value for max ARR value
-  ARR = round((sysclk_as_double * pwm_period) / (PSC + 1)) - 1;
+void port_buzzer_arm_note(uint32_t buzzer_id, double frequency_hz, double volume){
+  if(buzzer_id >= BUZZERS_LENGTH){
+    return;
+  }
+  // A rest of this voice: it must not start with the others
+  if(frequency_hz == 0){
+    _voice_stop(buzzer_id);
+    return;
+  }
+  _set_pwm(buzzer_id, frequency_hz, volume, true);
+}
 
-  // Check if ARR is greater than its maximum value
-  if(ARR > ARR_MAX){
-    PSC++;
-    // Calculate the PSC value for max ARR value
-    ARR = round((sysclk_as_double * pwm_period) / (PSC + 1)) - 1;
-  }
-
-  switch (buzzer_id)
-  {
-    case 0:
-      // Disable timer
-      TIM3->CR1 &= ~TIM_CR1_CEN;
-      // Reset counter
-      TIM3->CNT = 0;
-      // Load autoreload register
-      TIM3->ARR = (uint32_t)round(ARR);
-      // Load prescaler register
-      TIM3->PSC = (uint32_t)round(PSC);
-      // Set PWM width
-      TIM3->CCR1 = (uint32_t)round(ARR * volume);
-      // Values are loaded into active registers
-      TIM3->EGR = TIM_EGR_UG;
-      // Enable output compare
-      TIM3->CCER |= TIM_CCER_CC1E;
-      // Enable timer
-      TIM3->CR1 |= TIM_CR1_CEN;
-
-      break;
-    
-    default:
-      break;
+double port_buzzer_get_note_frequency(uint32_t buzzer_id){
+  if(buzzer_id >= BUZZERS_LENGTH){
+    return 0;
+  }
+  TIM_TypeDef *p_tim = buzzers_arr[buzzer_id].p_tim;
+  if(!(p_tim->CR1 & TIM_CR1_CEN) && !buzzers_arr[buzzer_id].armed){
+    return 0;
   }
+  return (double)SystemCoreClock / (((double)p_tim->PSC + 1) * ((double)p_tim->ARR + 1));
+}
+
+void port_buzzer_pause_note(uint32_t buzzer_id){
+  if(buzzer_id >= BUZZERS_LENGTH){
+    return;
+  }
+  // Freeze the count of the note, then silence the PWM of every voice
+  TIM2->CR1 &= ~TIM_CR1_CEN;
+  PORT_MODEL_TIM_SYNC(TIM2);
+  buzzers_arr[buzzer_id].paused_cnt = TIM2->CNT;
+  for(uint32_t id = 0; id < BUZZERS_LENGTH; id++){
+    TIM_TypeDef *p_tim = buzzers_arr[id].p_tim;
+    buzzers_arr[id].paused_pwm = (p_tim->CR1 & TIM_CR1_CEN) != 0;
+    p_tim->CR1 &= ~TIM_CR1_CEN;
+    PORT_MODEL_TIM_SYNC(p_tim);
+  }
+  // The envelope waits for the note
+  TIM5->CR1 &= ~TIM_CR1_CEN;
+  PORT_MODEL_TIM_SYNC(TIM5);
+}
+
+void port_buzzer_resume_note(uint32_t buzzer_id){
+  if(buzzer_id >= BUZZERS_LENGTH){
+    return;
+  }
+  // ARR and PSC are those of the note: only the count is restored, without an update event that would clear it
+  TIM2->CNT = buzzers_arr[buzzer_id].paused_cnt;
+  // The voices that were sounding wait for the trigger, to start together again
+  for(uint32_t id = 0; id < BUZZERS_LENGTH; id++){
+    TIM_TypeDef *p_tim = buzzers_arr[id].p_tim;
+    if(buzzers_arr[id].paused_pwm){
+      p_tim->SMCR = (p_tim->SMCR & ~TIM_SMCR_SMS) | TIM_SMCR_SMS_2 | TIM_SMCR_SMS_1;
+    }
+  }
+  if(_is_envelope_active()){
+    TIM5->CR1 |= TIM_CR1_CEN;
+    PORT_MODEL_TIM_SYNC(TIM5);
+  }
+  TIM2->CR1 |= TIM_CR1_CEN;
+  PORT_MODEL_TIM_SYNC(TIM2);
+}
+
+uint32_t port_buzzer_get_note_remaining_us(uint32_t buzzer_id){
+  if(buzzer_id >= BUZZERS_LENGTH){
+    return 0;
+  }
+  PORT_MODEL_TIM_SYNC(TIM2);
+  if(buzzers_arr[buzzer_id].note_end || (TIM2->CNT > TIM2->ARR)){
+    return 0;
+  }
+  return (uint32_t)((double)(TIM2->ARR + 1 - TIM2->CNT) * ((double)TIM2->PSC + 1) * 1e6 / SystemCoreClock);
 }
 
 void port_buzzer_stop(uint32_t buzzer_id){
-  
-  switch (buzzer_id)
-  {
-    case 0:
-      // Disable timer
-      TIM3->CR1 &= ~TIM_CR1_CEN;
-      TIM2->CR1 &= ~TIM_CR1_CEN;
-
-      break;
-    
-    default:
-      break;
-  }
-  
-}
\ No newline at end of file
+  if(buzzer_id >= BUZZERS_LENGTH){
+    return;
+  }
+  // Disable timer
+  _voice_stop(buzzer_id);
+  port_buzzer_clear_stage(buzzer_id);
+  TIM2->CR1 &= ~TIM_CR1_CEN;
+  PORT_MODEL_TIM_SYNC(TIM2);
+  if(!_is_envelope_active()){
+    TIM5->CR1 &= ~TIM_CR1_CEN;
+    PORT_MODEL_TIM_SYNC(TIM5);
+  }
+}
+
+void port_buzzer_set_envelope(uint32_t buzzer_id, const envelope_config_t *p_config){
+  envelope_set_config(&buzzers_arr[buzzer_id].envelope, p_config);
+}
+
+void port_buzzer_set_note_effects(uint32_t buzzer_id, const note_fx_t *p_fx, double next_frequency_hz,
+                                  uint32_t duration_ms){
+  if(buzzer_id >= BUZZERS_LENGTH){
+    return;
+  }
+  note_fx_state_t *p_state = &buzzers_arr[buzzer_id].fx;
+  double frequency_hz = port_buzzer_get_note_frequency(buzzer_id);
+  // A silence has no pitch to change
+  if((p_fx == NULL) || (frequency_hz == 0)){
+    note_fx_stop(p_state);
+    return;
+  }
+  // The slide ends at the period of the next note
+  double next_ratio = (next_frequency_hz > 0) ? frequency_hz / next_frequency_hz : 0;
+  double longest = note_fx_start(p_state, p_fx, ENVELOPE_RATE_HZ, next_ratio, duration_ms);
+  if(!note_fx_is_active(p_state)){
+    return;
+  }
+
+  // Same period, with a prescaler large enough for the longest period of the effects to fit in ARR
+  TIM_TypeDef *p_tim = buzzers_arr[buzzer_id].p_tim;
+  uint32_t PSC = p_tim->PSC;
+  uint32_t old_ARR = p_tim->ARR;
+  double period = ((double)PSC + 1) * ((double)old_ARR + 1);
+  double min_PSC = ceil(period * longest / (ARR_MAX + 1)) - 1;
+  if(min_PSC > PSC){
+    PSC = (uint32_t)min_PSC;
+  }
+  uint32_t ARR = note_fx_set_count(p_state, period / (PSC + 1));
+  if(PSC != p_tim->PSC){
+    // The note has just started: the update event only restarts its first period
+    p_tim->CCR1 = (uint32_t)((uint64_t)p_tim->CCR1 * (ARR + 1) / (old_ARR + 1));
+    p_tim->ARR = ARR;
+    p_tim->PSC = PSC;
+    p_tim->EGR = TIM_EGR_UG;
+    PORT_MODEL_TIM_SYNC(p_tim);
+  }
+}
+
+void port_buzzer_stage_note(uint32_t buzzer_id, double frequency_hz, double volume){
+  if(buzzer_id >= BUZZERS_LENGTH){
+    return;
+  }
+  port_buzzer_hw_t *p_buzzer = &buzzers_arr[buzzer_id];
+  // The timer values are worked out now, while the current note sounds: the interrupt only loads them
+  p_buzzer->staged = (frequency_hz != 0);
+  if(p_buzzer->staged){
+    note_pwm_find(SystemCoreClock, frequency_hz, &p_buzzer->staged_psc, &p_buzzer->staged_arr);
+    p_buzzer->staged_level = envelope_get_level(volume);
+  }
+}
+
+void port_buzzer_stage_duration(uint32_t buzzer_id, uint32_t duration_ms){
+  if(buzzer_id >= BUZZERS_LENGTH){
+    return;
+  }
+  port_buzzer_hw_t *p_buzzer = &buzzers_arr[buzzer_id];
+  _get_duration_values(duration_ms, &p_buzzer->staged_duration_psc, &p_buzzer->staged_duration_arr);
+  p_buzzer->staged_duration_ms = duration_ms;
+  p_buzzer->stage_started = false;
+  p_buzzer->stage_ready = true;
+}
+
+bool port_buzzer_start_staged_note(uint32_t buzzer_id){
+  port_buzzer_hw_t *p_buzzer = &buzzers_arr[buzzer_id];
+  if(!p_buzzer->stage_ready){
+    return false;
+  }
+  p_buzzer->stage_ready = false;
+  // The staged voices are armed and the others silenced, then the note duration timer starts them together
+  for(uint32_t id = buzzer_id; id < BUZZERS_LENGTH; id++){
+    port_buzzer_hw_t *p_voice = &buzzers_arr[id];
+    if(p_voice->staged){
+      p_voice->staged = false;
+      _load_pwm(id, p_voice->staged_psc, p_voice->staged_arr, p_voice->staged_level, true);
+    }
+    else{
+      _voice_stop(id);
+    }
+  }
+  _start_duration(p_buzzer->staged_duration_psc, p_buzzer->staged_duration_arr, p_buzzer->staged_duration_ms);
+  p_buzzer->stage_started = true;
+  return true;
+}
+
+bool port_buzzer_get_staged_start(uint32_t buzzer_id){
+  if(buzzer_id >= BUZZERS_LENGTH){
+    return false;
+  }
+  bool started = buzzers_arr[buzzer_id].stage_started;
+  buzzers_arr[buzzer_id].stage_started = false;
+  return started;
+}
+
+void port_buzzer_clear_stage(uint32_t buzzer_id){
+  if(buzzer_id >= BUZZERS_LENGTH){
+    return;
+  }
+  buzzers_arr[buzzer_id].stage_ready = false;
+  buzzers_arr[buzzer_id].stage_started = false;
+  for(uint32_t id = buzzer_id; id < BUZZERS_LENGTH; id++){
+    buzzers_arr[id].staged = false;
+  }
+}
+
+void port_buzzer_control_tick(uint32_t buzzer_id){
+  port_buzzer_hw_t *p_buzzer = &buzzers_arr[buzzer_id];
+  if(envelope_is_active(&p_buzzer->envelope)){
+    TIM_TypeDef *p_tim = p_buzzer->p_tim;
+    uint32_t duty = envelope_tick(&p_buzzer->envelope);
+    // Loaded at the next update of the PWM timer (preload): a period is never cut
+    if(note_fx_is_active(&p_buzzer->fx)){
+      p_tim->ARR = note_fx_tick(&p_buzzer->fx);
+      PORT_MODEL_TIM_SYNC(p_tim);
+    }
+    p_tim->CCR1 = (duty * (p_tim->ARR + 1)) >> ENVELOPE_DUTY_BITS;
+    if(envelope_is_active(&p_buzzer->envelope)){
+      return;
+    }
+  }
+  // Silence reached in every voice: no more ticks until the next note
+  if(!_is_envelope_active()){
+    TIM5->CR1 &= ~TIM_CR1_CEN;
+    PORT_MODEL_TIM_SYNC(TIM5);
+  }
+}
@@ -0,0 +1,145 @@
+/**
+ * @file port_flash.c
+ * @brief Portable functions to erase and program the flash sectors of the melody store and of the settings (STM32F4).
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <string.h>
+
+/* HW dependent libraries */
+#include "port_flash.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define FLASH_SR_ERRORS (FLASH_SR_WRPERR | FLASH_SR_PGAERR | FLASH_SR_PGPERR | FLASH_SR_PGSERR) /*!< Error flags */
+
+// The size check of the build keeps the program before the settings; the store must come after them
+#if (PORT_FLASH_SETTINGS_ADDRESS + PORT_FLASH_SETTINGS_SECTORS * PORT_FLASH_SETTINGS_SIZE) > PORT_FLASH_STORE_ADDRESS
+#error "The settings overlap the melody store"
+#endif
+
+/* Private functions */
+
+/// @brief Unlock the control register
+static void _unlock(void)
+{
+  if (FLASH->CR & FLASH_CR_LOCK)
+  {
+    FLASH->KEYR = PORT_FLASH_KEY_1;
+    FLASH->KEYR = PORT_FLASH_KEY_2;
+  }
+}
+
+/// @brief Wait for the end of an operation and clear its flags
+/// @return true if the operation finished without errors
+static bool _wait(void)
+{
+  while (FLASH->SR & FLASH_SR_BSY)
+  {
+  }
+  uint32_t errors = FLASH->SR & FLASH_SR_ERRORS;
+  FLASH->SR = errors | FLASH_SR_EOP; // Write 1 to clear
+  return errors == 0;
+}
+
+/// @brief Reset the data cache, that may keep the bytes of the store as they were before an erase
+static void _reset_data_cache(void)
+{
+  FLASH->ACR &= ~FLASH_ACR_DCEN;
+  FLASH->ACR |= FLASH_ACR_DCRST;
+  FLASH->ACR &= ~FLASH_ACR_DCRST;
+  FLASH->ACR |= FLASH_ACR_DCEN;
+}
+
+/// @brief Erase a sector
+/// @param sector Number of the sector (FLASH_CR_SNB)
+/// @return true if the sector was erased without errors
+static bool _erase_sector(uint32_t sector)
+{
+  _unlock();
+  _wait();
+  // Erase by words (x32 parallelism, 2.7 V to 3.6 V)
+  FLASH->CR &= ~(FLASH_CR_PSIZE | FLASH_CR_SNB);
+  FLASH->CR |= FLASH_CR_PSIZE_1 | (sector << FLASH_CR_SNB_Pos) | FLASH_CR_SER;
+  FLASH->CR |= FLASH_CR_STRT;
+  bool ok = _wait();
+  FLASH->CR &= ~(FLASH_CR_SER | FLASH_CR_SNB);
+  FLASH->CR |= FLASH_CR_LOCK;
+  _reset_data_cache();
+  return ok;
+}
+
+/// @brief Program bytes of a sector, a halfword at a time
+/// @param address Address of the sector
+/// @param size Bytes of the sector
+/// @param offset Position in the sector, even
+/// @param p_data Pointer to the data
+/// @param length Bytes to program, even
+/// @return true if programmed without errors
+static bool _program(uint32_t address, uint32_t size, uint32_t offset, const void *p_data, uint32_t length)
+{
+  if ((offset % 2) || (length % 2) || (offset > size) || (length > size - offset))
+  {
+    return false;
+  }
+  _unlock();
+  _wait();
+  FLASH->CR &= ~FLASH_CR_PSIZE;
+  FLASH->CR |= FLASH_CR_PSIZE_0 | FLASH_CR_PG; // Halfwords (x16 parallelism)
+  bool ok = true;
+  volatile uint16_t *p_flash = (volatile uint16_t *)(address + offset);
+  const uint8_t *p_bytes = (const uint8_t *)p_data;
+  for (uint32_t i = 0; ok && (i < length); i += 2)
+  {
+    uint16_t halfword;
+    memcpy(&halfword, &p_bytes[i], sizeof(halfword)); // The data may be unaligned
+    *p_flash++ = halfword;
+    __DSB();
+    ok = _wait();
+  }
+  FLASH->CR &= ~FLASH_CR_PG;
+  FLASH->CR |= FLASH_CR_LOCK;
+  return ok;
+}
+
+/* Public functions */
+const uint8_t *port_flash_get_store(void)
+{
+  return (const uint8_t *)PORT_FLASH_STORE_ADDRESS;
+}
+
+bool port_flash_erase_store(void)
+{
+  return _erase_sector(PORT_FLASH_STORE_SECTOR);
+}
+
+bool port_flash_program(uint32_t offset, const void *p_data, uint32_t length)
+{
+  return _program(PORT_FLASH_STORE_ADDRESS, PORT_FLASH_STORE_SIZE, offset, p_data, length);
+}
+
+const uint8_t *port_flash_get_settings(uint32_t sector)
+{
+  return (const uint8_t *)(PORT_FLASH_SETTINGS_ADDRESS + sector * PORT_FLASH_SETTINGS_SIZE);
+}
+
+bool port_flash_erase_settings(uint32_t sector)
+{
+  if (sector >= PORT_FLASH_SETTINGS_SECTORS)
+  {
+    return false;
+  }
+  return _erase_sector(PORT_FLASH_SETTINGS_SECTOR + sector);
+}
+
+bool port_flash_program_settings(uint32_t sector, uint32_t offset, const void *p_data, uint32_t length)
+{
+  if (sector >= PORT_FLASH_SETTINGS_SECTORS)
+  {
+    return false;
+  }
+  return _program(PORT_FLASH_SETTINGS_ADDRESS + sector * PORT_FLASH_SETTINGS_SIZE, PORT_FLASH_SETTINGS_SIZE, offset,
+                  p_data, length);
+}
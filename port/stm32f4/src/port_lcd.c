@@ -2,11 +2,16 @@
 
 extern I2C_HandleTypeDef hi2c1;
 
-uint8_t dpFunction;
-uint8_t dpControl;
-uint8_t dpMode;
-uint8_t dpRows;
-uint8_t dpBacklight;
+PORT_BOARD_ARRAY(port_lcd_hw_t, lcds_arr, port_lcd_get_arr, LCD_0_ID + 1, {
+  [LCD_0_ID] = {0}
+});
+
+/* The driver keeps the names of its state */
+#define dpFunction (lcds_arr[LCD_0_ID].dpFunction)
+#define dpControl (lcds_arr[LCD_0_ID].dpControl)
+#define dpMode (lcds_arr[LCD_0_ID].dpMode)
+#define dpRows (lcds_arr[LCD_0_ID].dpRows)
+#define dpBacklight (lcds_arr[LCD_0_ID].dpBacklight)
 
 static void SendCommand(uint8_t);
 static void SendChar(uint8_t);
@@ -14,7 +19,6 @@ static void Send(uint8_t, uint8_t);
 static void Write4Bits(uint8_t);
 static void ExpanderWrite(uint8_t);
 static void PulseEnable(uint8_t);
-static void DelayInit(void);
 static void DelayUS(uint32_t);
 
 uint8_t special1[8] = {
@@ -57,7 +61,6 @@ void port_lcd_init(uint8_t rows)
   }
 
   /* Wait for initialization */
-  DelayInit();
   port_system_delay_ms(50);
 
   ExpanderWrite(dpBacklight);
@@ -268,29 +271,13 @@ static void PulseEnable(uint8_t _data)
   DelayUS(20);
 }
 
-static void DelayInit(void)
-{
-  CoreDebug->DEMCR &= ~CoreDebug_DEMCR_TRCENA_Msk;
-  CoreDebug->DEMCR |=  CoreDebug_DEMCR_TRCENA_Msk;
-
-  DWT->CTRL &= ~DWT_CTRL_CYCCNTENA_Msk; //~0x00000001;
-  DWT->CTRL |=  DWT_CTRL_CYCCNTENA_Msk; //0x00000001;
-
-  DWT->CYCCNT = 0;
-
-  /* 3 NO OPERATION instructions */
-  __ASM volatile ("NOP");
-  __ASM volatile ("NOP");
-  __ASM volatile ("NOP");
-}
-
+/* The cycle counter runs since port_system_init(): restarting it here would break the timestamps taken with it */
 static void DelayUS(uint32_t us) {
   uint32_t cycles = (SystemCoreClock/1000000L)*us;
-  uint32_t start = DWT->CYCCNT;
-  volatile uint32_t cnt;
+  uint32_t start = port_system_get_cycles();
 
-  do
+  PORT_MODEL_RUN_CPU(cycles);
+  while ((port_system_get_cycles() - start) < cycles)
   {
-    cnt = DWT->CYCCNT - start;
-  } while(cnt < cycles);
+  }
 }
@@ -21,7 +21,7 @@
 
 /* Global variables */
 
-port_NEC_hw_t NECs_arr[] = {
+PORT_BOARD_ARRAY(port_NEC_hw_t, NECs_arr, port_NEC_get_arr, NEC_0_ID + 1, {
   [NEC_0_ID] = {
                     .p_port = NEC_0_GPIO,
                     .pin = NEC_0_PIN,
@@ -29,7 +29,7 @@ port_NEC_hw_t NECs_arr[] = {
                     .event = false,
                     .decode = false
                 }
-};
+});
 
 /* Private functions */
 
@@ -108,6 +108,7 @@ void port_NEC_set_timer_duration(uint32_t NEC_id, uint32_t duration_ms){
       TIM4->EGR = TIM_EGR_UG;
       // Enable timer
       TIM4->CR1 |= TIM_CR1_CEN;
+      PORT_MODEL_TIM_SYNC(TIM4);
       break;
     
     default:
@@ -0,0 +1,132 @@
+/**
+ * @file port_storage.c
+ * @brief Portable functions to read the external SPI flash of the streamed melodies (STM32F4).
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+/* Includes ------------------------------------------------------------------*/
+/* HW dependent libraries */
+#include "port_system.h"
+#include "port_storage.h"
+
+/* Global variables */
+static volatile bool busy = false;              /*!< A read is in progress */
+static const uint8_t dummy = STORAGE_DUMMY;     /*!< Byte sent while receiving */
+
+/* Private functions */
+
+/// @brief Exchange a byte by polling
+/// @param byte Byte to send
+static void _transfer(uint8_t byte)
+{
+  while (!(STORAGE_SPI->SR & SPI_SR_TXE))
+  {
+  }
+  STORAGE_SPI->DR = byte;
+  while (!(STORAGE_SPI->SR & SPI_SR_RXNE))
+  {
+  }
+  (void)STORAGE_SPI->DR; // The byte received while sending the command is meaningless
+}
+
+/// @brief Configure a DMA stream, memory increment only for the reception
+/// @param p_stream DMA stream
+/// @param direction `DMA_SxCR_DIR_0` from memory to the SPI, 0 from the SPI to memory
+/// @param p_memory Pointer to the memory
+/// @param length Bytes to transfer
+static void _setup_stream(DMA_Stream_TypeDef *p_stream, uint32_t direction, const void *p_memory, uint32_t length)
+{
+  p_stream->CR &= ~DMA_SxCR_EN;
+  while (p_stream->CR & DMA_SxCR_EN)
+  {
+  }
+  p_stream->CR = ((uint32_t)STORAGE_DMA_CHANNEL << DMA_SxCR_CHSEL_Pos) | direction;
+  p_stream->PAR = (uint32_t)&STORAGE_SPI->DR;
+  p_stream->M0AR = (uint32_t)p_memory;
+  p_stream->NDTR = length;
+}
+
+/* Public functions */
+void port_storage_init(void)
+{
+  // Pins: chip select as an output, released; clock and data as SPI2
+  port_system_gpio_config(STORAGE_GPIO, STORAGE_PIN_CS, GPIO_MODE_OUT, GPIO_PUPDR_NOPULL);
+  port_system_gpio_write(STORAGE_GPIO, STORAGE_PIN_CS, true);
+  port_system_gpio_config(STORAGE_GPIO, STORAGE_PIN_SCK, GPIO_MODE_ALTERNATE, GPIO_PUPDR_NOPULL);
+  port_system_gpio_config(STORAGE_GPIO, STORAGE_PIN_MISO, GPIO_MODE_ALTERNATE, GPIO_PUPDR_PUP);
+  port_system_gpio_config(STORAGE_GPIO, STORAGE_PIN_MOSI, GPIO_MODE_ALTERNATE, GPIO_PUPDR_NOPULL);
+  port_system_gpio_config_alternate(STORAGE_GPIO, STORAGE_PIN_SCK, STORAGE_AF);
+  port_system_gpio_config_alternate(STORAGE_GPIO, STORAGE_PIN_MISO, STORAGE_AF);
+  port_system_gpio_config_alternate(STORAGE_GPIO, STORAGE_PIN_MOSI, STORAGE_AF);
+
+  // SPI2: master, mode 0, 8 bits, PCLK1 / 4, chip select by software
+  RCC->APB1ENR |= RCC_APB1ENR_SPI2EN;
+  RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN;
+  STORAGE_SPI->CR1 = 0;
+  STORAGE_SPI->CR1 = SPI_CR1_MSTR | SPI_CR1_BR_0 | SPI_CR1_SSM | SPI_CR1_SSI;
+  STORAGE_SPI->CR2 = 0;
+  STORAGE_SPI->CR1 |= SPI_CR1_SPE;
+
+  NVIC_SetPriority(STORAGE_DMA_IRQ, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 2, 2));
+  NVIC_EnableIRQ(STORAGE_DMA_IRQ);
+}
+
+uint32_t port_storage_get_size(void)
+{
+  return STORAGE_SIZE;
+}
+
+bool port_storage_start_read(uint32_t address, void *p_data, uint32_t length)
+{
+  if (busy || (length == 0) || (length > 0xFFFFU) || (address > STORAGE_SIZE) || (length > STORAGE_SIZE - address))
+  {
+    return false;
+  }
+  busy = true;
+  port_system_gpio_write(STORAGE_GPIO, STORAGE_PIN_CS, false);
+  _transfer(STORAGE_CMD_READ);
+  _transfer((uint8_t)(address >> 16));
+  _transfer((uint8_t)(address >> 8));
+  _transfer((uint8_t)address);
+
+  // The reception stream writes the data; the transmission stream sends a dummy byte for each one
+  _setup_stream(STORAGE_DMA_RX, 0, p_data, length);
+  STORAGE_DMA_RX->CR |= DMA_SxCR_MINC | DMA_SxCR_TCIE;
+  _setup_stream(STORAGE_DMA_TX, DMA_SxCR_DIR_0, &dummy, length);
+  DMA1->LIFCR = DMA_LIFCR_CTCIF3 | DMA_LIFCR_CHTIF3 | DMA_LIFCR_CTEIF3 | DMA_LIFCR_CDMEIF3 | DMA_LIFCR_CFEIF3;
+  DMA1->HIFCR = DMA_HIFCR_CTCIF4 | DMA_HIFCR_CHTIF4 | DMA_HIFCR_CTEIF4 | DMA_HIFCR_CDMEIF4 | DMA_HIFCR_CFEIF4;
+  STORAGE_DMA_RX->CR |= DMA_SxCR_EN;
+  STORAGE_DMA_TX->CR |= DMA_SxCR_EN;
+  STORAGE_SPI->CR2 |= SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+  return true;
+}
+
+bool port_storage_read(uint32_t address, void *p_data, uint32_t length)
+{
+  while (busy)
+  {
+  }
+  if (!port_storage_start_read(address, p_data, length))
+  {
+    return false;
+  }
+  while (busy)
+  {
+  }
+  return true;
+}
+
+bool port_storage_is_busy(void)
+{
+  return busy;
+}
+
+void port_storage_end_read(void)
+{
+  DMA1->LIFCR = DMA_LIFCR_CTCIF3;
+  // The last byte was received, so the SPI is idle: release the chip select
+  STORAGE_SPI->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+  port_system_gpio_write(STORAGE_GPIO, STORAGE_PIN_CS, true);
+  busy = false;
+}
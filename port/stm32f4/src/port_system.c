@@ -118,6 +118,11 @@ size_t port_system_init()
   /* Configure the system clock */
   system_clock_config();
 
+  /* Start the cycle counter of the core, used to measure latencies */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
   return 0;
 }
 
@@ -134,6 +139,25 @@ void port_system_set_millis(uint32_t ms)
   msTicks = ms;
 }
 
+uint32_t port_system_get_cycles(void)
+{
+  return DWT->CYCCNT;
+}
+
+bool port_system_log_put_char(char c)
+{
+  if (((ITM->TCR & ITM_TCR_ITMENA_Msk) == 0UL) || ((ITM->TER & 1UL) == 0UL))
+  {
+    return true;
+  }
+  if (ITM->PORT[0U].u32 == 0UL)
+  {
+    return false;
+  }
+  ITM->PORT[0U].u8 = (uint8_t)c;
+  return true;
+}
+
 void port_system_delay_ms(uint32_t ms)
 {
   uint32_t tickstart = port_system_get_millis();
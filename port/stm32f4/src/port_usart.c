@@ -14,9 +14,12 @@
 #include "port_system.h"
 #include "port_usart.h"
 
+/* Defines */
+#define USART_RX_BYTE_CYCLES 12 /*!< CPU time of the ISR to handle a received byte on the models: load, compares, store and index */
+
 /* Global variables */
 
-port_usart_hw_t usart_arr[] = {
+PORT_BOARD_ARRAY(port_usart_hw_t, usart_arr, port_usart_get_arr, USART_0_ID + 1, {
     [USART_0_ID] = {
         .p_usart = USART_0,
         .p_port_tx = USART_0_GPIO_TX,
@@ -25,13 +28,20 @@ port_usart_hw_t usart_arr[] = {
         .pin_rx = USART_0_PIN_RX,
         .alt_func_tx = USART_0_AF_TX,
         .alt_func_rx = USART_0_AF_RX,
+        .baud_rate = USART_0_BAUD_RATE,
+        .rx_dma = USART_0_RX_DMA,
+        .p_dma_stream = USART_0_DMA_STREAM,
+        .dma_channel = USART_0_DMA_CHANNEL,
+        .dma_irq = USART_0_DMA_IRQ,
+        .rx_dma_idx = 0,
         .i_idx = 0,
+        .rx_overflows = 0,
         .read_complete = false,
         .o_idx = 0,
         .write_complete = false
     }
     
-};
+});
 
 /* Private functions */
 
@@ -42,7 +52,131 @@ void _reset_buffer(char* buffer, uint32_t length){
     memset(buffer, EMPTY_BUFFER_CONSTANT, length);
 }
 
+/// @brief Store a byte of a binary session. Empty frames and frames longer than the buffer are dropped.
+/// @param usart_id USART identifier
+/// @param data Byte received
+static void _store_frame_data(uint32_t usart_id, uint8_t data){
+    if (data != USART_FRAME_DELIMITER){
+        if(usart_arr[usart_id].i_idx < USART_FRAME_BUFFER_LENGTH){
+            usart_arr[usart_id].frame_buffer[usart_arr[usart_id].i_idx] = data;
+        }
+        if(usart_arr[usart_id].i_idx == USART_FRAME_BUFFER_LENGTH){
+            usart_arr[usart_id].rx_overflows += 1;
+        }
+        if(usart_arr[usart_id].i_idx <= USART_FRAME_BUFFER_LENGTH){
+            usart_arr[usart_id].i_idx += 1;
+        }
+    } else{
+        if((usart_arr[usart_id].i_idx > 0) && (usart_arr[usart_id].i_idx <= USART_FRAME_BUFFER_LENGTH)){
+            usart_arr[usart_id].frame_length = usart_arr[usart_id].i_idx;
+            usart_arr[usart_id].read_complete = true;
+        }
+        usart_arr[usart_id].i_idx = 0;
+    }
+}
+
+/// @brief Get the clock of the bus of a USART: APB1 for USART2 to 5, APB2 for USART1 and USART6
+/// @param p_usart Pointer to USART struct
+/// @return Frequency in Hz
+static uint32_t _get_pclk_hz(USART_TypeDef *p_usart){
+    if ((p_usart == USART1) || (p_usart == USART6)){
+        return SystemCoreClock >> APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos];
+    }
+    return SystemCoreClock >> APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos];
+}
+
+/// @brief Store a received byte: in the frame buffer in a binary session, in the input buffer in a text session
+/// @param usart_id USART identifier
+/// @param data Byte received
+static void _store_byte(uint32_t usart_id, char data){
+    PORT_MODEL_RUN_CPU(USART_RX_BYTE_CYCLES);
+    if (usart_arr[usart_id].binary){
+        _store_frame_data(usart_id, (uint8_t)data);
+    } else if ((data == USART_FRAME_DELIMITER) && (usart_arr[usart_id].i_idx == 0)){
+        usart_arr[usart_id].binary = true; // Magic first byte: binary frames for the rest of the session
+    } else if (data != END_CHAR_CONSTANT){
+        if(usart_arr[usart_id].i_idx >= USART_INPUT_BUFFER_LENGTH){
+            usart_arr[usart_id].i_idx = 0;
+            usart_arr[usart_id].rx_overflows += 1;
+        }
+        usart_arr[usart_id].input_buffer[usart_arr[usart_id].i_idx] = data;
+        usart_arr[usart_id].i_idx += 1;
+    } else{
+        usart_arr[usart_id].read_complete = true;
+        usart_arr[usart_id].i_idx = 0;
+    }
+}
+
+/// @brief Start the circular DMA reception, unless it is running
+/// @param usart_id USART identifier
+static void _start_rx_dma(uint32_t usart_id){
+    DMA_Stream_TypeDef *p_stream = usart_arr[usart_id].p_dma_stream;
+    if (p_stream -> CR & DMA_SxCR_EN){
+        return;
+    }
+    // Peripheral to memory, bytes, circular, memory increment, half and full transfer interrupts
+    p_stream -> CR = ((uint32_t)usart_arr[usart_id].dma_channel << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_MINC | DMA_SxCR_CIRC | DMA_SxCR_HTIE | DMA_SxCR_TCIE;
+    p_stream -> PAR = (uintptr_t)&usart_arr[usart_id].p_usart -> DR;
+    p_stream -> M0AR = (uintptr_t)usart_arr[usart_id].rx_dma_buffer;
+    p_stream -> NDTR = USART_RX_DMA_BUFFER_LENGTH;
+    usart_arr[usart_id].rx_dma_idx = 0;
+    p_stream -> CR |= DMA_SxCR_EN;
+    usart_arr[usart_id].p_usart -> CR3 |= USART_CR3_DMAR;
+}
+
+/// @brief Stop the DMA reception
+/// @param usart_id USART identifier
+static void _stop_rx_dma(uint32_t usart_id){
+    DMA_Stream_TypeDef *p_stream = usart_arr[usart_id].p_dma_stream;
+    usart_arr[usart_id].p_usart -> CR3 &= ~USART_CR3_DMAR;
+    p_stream -> CR &= ~DMA_SxCR_EN;
+    while (p_stream -> CR & DMA_SxCR_EN){}
+}
+
 /* Public functions */
+uint32_t port_usart_compute_brr(uint32_t pclk_hz, uint32_t baud_rate){
+    if (baud_rate == 0){
+        return 0;
+    }
+    uint32_t brr = (pclk_hz + baud_rate / 2) / baud_rate; // USARTDIV x 16, rounded
+    if ((brr < 16) || (brr > 0xFFFF)){
+        return 0; // USARTDIV must be between 1 and 4095.9375
+    }
+    uint32_t obtained = pclk_hz / brr;
+    uint32_t error = (obtained > baud_rate) ? obtained - baud_rate : baud_rate - obtained;
+    if ((uint64_t)error * 1000 > (uint64_t)baud_rate * USART_BAUD_RATE_MAX_ERROR){
+        return 0;
+    }
+    return brr;
+}
+
+bool port_usart_check_baud_rate(uint32_t usart_id, uint32_t baud_rate){
+    return port_usart_compute_brr(_get_pclk_hz(usart_arr[usart_id].p_usart), baud_rate) != 0;
+}
+
+bool port_usart_set_baud_rate(uint32_t usart_id, uint32_t baud_rate){
+    USART_TypeDef *p_usart = usart_arr[usart_id].p_usart;
+    uint32_t brr = port_usart_compute_brr(_get_pclk_hz(p_usart), baud_rate);
+    if (brr == 0){
+        return false;
+    }
+    // The last byte written must leave the line at the old rate
+    while (!(p_usart -> SR & USART_SR_TC)){
+        PORT_MODEL_POLL();
+    }
+    uint32_t cr1 = p_usart -> CR1;
+    p_usart -> CR1 &= ~USART_CR1_UE;
+    p_usart -> BRR = brr;
+    p_usart -> CR1 = cr1;
+    PORT_MODEL_USART_SYNC(p_usart);
+    usart_arr[usart_id].baud_rate = baud_rate;
+    return true;
+}
+
+uint32_t port_usart_get_baud_rate(uint32_t usart_id){
+    return usart_arr[usart_id].baud_rate;
+}
+
 
 
 void port_usart_init(uint32_t usart_id)
@@ -64,7 +198,7 @@ void port_usart_init(uint32_t usart_id)
     // Enable USART clock
     if (p_usart == USART3) RCC -> APB1ENR |= RCC_APB1ENR_USART3EN;
     if (p_usart == USART1) RCC -> APB2ENR |= RCC_APB2ENR_USART1EN;
-    if (p_usart == USART1) RCC -> APB2ENR |= RCC_APB2ENR_USART6EN;  
+    if (p_usart == USART6) RCC -> APB2ENR |= RCC_APB2ENR_USART6EN;
     
     // Disable USART
     p_usart -> CR1 &= ~USART_CR1_UE;
@@ -82,13 +216,11 @@ void port_usart_init(uint32_t usart_id)
     p_usart -> CR1 &= ~USART_CR1_OVER8;
 
     /*
-        Set Baudrate to 9600:
-        USARTDIV = 16MHz / 8x(2-0)x9600 = 0d104.166
-        0d104 = 0x68
-        0d.166 = 0x2
-        USARTDIV = 0x0682
+        Set the baud rate from the clock of the bus, e.g. for 9600 at 16 MHz:
+        USARTDIV = 16MHz / (16 x 9600) = 0d104.1667
+        BRR = USARTDIV x 16 = 0d1666.67 -> 0d1667 = 0x0683
     */
-    p_usart -> BRR = 0x0683;
+    p_usart -> BRR = port_usart_compute_brr(_get_pclk_hz(p_usart), usart_arr[usart_id].baud_rate);
 
     // Enable tx and rx
     p_usart -> CR1 = USART_CR1_TE | USART_CR1_RE;
@@ -119,6 +251,13 @@ void port_usart_init(uint32_t usart_id)
         NVIC_EnableIRQ(USART6_IRQn);
     }
 
+    // DMA reception: clock of DMA1 and interrupt of the stream
+    if (usart_arr[usart_id].rx_dma){
+        RCC -> AHB1ENR |= RCC_AHB1ENR_DMA1EN;
+        NVIC_SetPriority(usart_arr[usart_id].dma_irq, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 2, 1));
+        NVIC_EnableIRQ(usart_arr[usart_id].dma_irq);
+    }
+
     // Enable the USART
     p_usart -> CR1 |= USART_CR1_UE;
 
@@ -132,7 +271,26 @@ void port_usart_get_from_input_buffer(uint32_t usart_id, char* p_buffer){
     memcpy(p_buffer, usart_arr[usart_id].input_buffer, USART_INPUT_BUFFER_LENGTH);
 }
 
+uint32_t port_usart_get_from_frame_buffer(uint32_t usart_id, uint8_t *p_buffer){
+    memcpy(p_buffer, usart_arr[usart_id].frame_buffer, usart_arr[usart_id].frame_length);
+    return usart_arr[usart_id].frame_length;
+}
+
+void port_usart_set_binary(uint32_t usart_id, bool binary){
+    usart_arr[usart_id].binary = binary;
+    usart_arr[usart_id].i_idx = 0;
+}
+
+uint32_t port_usart_get_rx_overflows(uint32_t usart_id){
+    return usart_arr[usart_id].rx_overflows;
+}
+
+bool port_usart_get_binary(uint32_t usart_id){
+    return usart_arr[usart_id].binary;
+}
+
 bool port_usart_get_txr_status(uint32_t usart_id){
+    PORT_MODEL_POLL();
     return ((usart_arr[usart_id].p_usart -> SR) & USART_SR_TXE);
 }
 
@@ -142,6 +300,7 @@ void port_usart_copy_to_output_buffer(uint32_t usart_id, char *p_data, uint32_t
 
 void port_usart_reset_input_buffer(uint32_t usart_id){
     _reset_buffer(usart_arr[usart_id].input_buffer, USART_INPUT_BUFFER_LENGTH);
+    usart_arr[usart_id].frame_length = 0;
     usart_arr[usart_id].read_complete = false;
 }
 
@@ -151,51 +310,80 @@ void port_usart_reset_output_buffer(uint32_t usart_id){
 }
 
 bool port_usart_rx_done(uint32_t usart_id){
+    PORT_MODEL_POLL();
     return usart_arr[usart_id].read_complete;
 }
 
+uint32_t port_usart_get_rx_end_cycles(uint32_t usart_id){
+    PORT_MODEL_POLL();
+    return usart_arr[usart_id].rx_end_cycles;
+}
+
 bool port_usart_tx_done(uint32_t usart_id){
+    PORT_MODEL_POLL();
     return usart_arr[usart_id].write_complete;
 }
 
 void port_usart_store_data(uint32_t usart_id){
-    char data = usart_arr[usart_id].p_usart -> DR;
-    if (data != END_CHAR_CONSTANT){
-        if(usart_arr[usart_id].i_idx >= USART_INPUT_BUFFER_LENGTH){
-            usart_arr[usart_id].i_idx = 0;
-        }
-        usart_arr[usart_id].input_buffer[usart_arr[usart_id].i_idx] = data;
-        usart_arr[usart_id].i_idx += 1;
-    } else{
-        usart_arr[usart_id].read_complete = true;
-        usart_arr[usart_id].i_idx = 0;
+    _store_byte(usart_id, PORT_MODEL_USART_READ_DR(usart_arr[usart_id].p_usart));
+}
+
+void port_usart_store_dma_data(uint32_t usart_id){
+    // The DMA writes at the position given by the items left to transfer
+    uint32_t head = (USART_RX_DMA_BUFFER_LENGTH - usart_arr[usart_id].p_dma_stream -> NDTR) % USART_RX_DMA_BUFFER_LENGTH;
+    PORT_MODEL_POLL();
+    while (usart_arr[usart_id].rx_dma_idx != head){
+        _store_byte(usart_id, (char)usart_arr[usart_id].rx_dma_buffer[usart_arr[usart_id].rx_dma_idx]);
+        usart_arr[usart_id].rx_dma_idx = (usart_arr[usart_id].rx_dma_idx + 1) % USART_RX_DMA_BUFFER_LENGTH;
     }
 }
 
+void port_usart_clear_idle(uint32_t usart_id){
+    (void)usart_arr[usart_id].p_usart -> SR;
+    (void)PORT_MODEL_USART_READ_DR(usart_arr[usart_id].p_usart);
+}
+
 void port_usart_write_data(uint32_t usart_id){
-    if ((usart_arr[usart_id].o_idx == USART_OUTPUT_BUFFER_LENGTH - 1) || (usart_arr[usart_id].output_buffer[usart_arr[usart_id].o_idx] == END_CHAR_CONSTANT)){
-        usart_arr[usart_id].p_usart -> DR = usart_arr[usart_id].output_buffer[usart_arr[usart_id].o_idx];
+    char end_char = usart_arr[usart_id].binary ? USART_FRAME_DELIMITER : END_CHAR_CONSTANT;
+    uint32_t o_idx = usart_arr[usart_id].o_idx;
+    // The replies to a batch of commands take several lines: the text ends at its last end character
+    bool last_line = usart_arr[usart_id].binary || (o_idx + 1 >= USART_OUTPUT_BUFFER_LENGTH) || (usart_arr[usart_id].output_buffer[o_idx + 1] == EMPTY_BUFFER_CONSTANT);
+    if ((o_idx == USART_OUTPUT_BUFFER_LENGTH - 1) || ((usart_arr[usart_id].output_buffer[o_idx] == end_char) && last_line)){
+        PORT_MODEL_USART_WRITE_DR(usart_arr[usart_id].p_usart, usart_arr[usart_id].output_buffer[usart_arr[usart_id].o_idx]);
         port_usart_disable_tx_interrupt(usart_id);
         usart_arr[usart_id].o_idx = 0;
         usart_arr[usart_id].write_complete = true;
     } else if(usart_arr[usart_id].output_buffer[usart_arr[usart_id].o_idx] != EMPTY_BUFFER_CONSTANT){
-        usart_arr[usart_id].p_usart -> DR = usart_arr[usart_id].output_buffer[usart_arr[usart_id].o_idx];
+        PORT_MODEL_USART_WRITE_DR(usart_arr[usart_id].p_usart, usart_arr[usart_id].output_buffer[usart_arr[usart_id].o_idx]);
         usart_arr[usart_id].o_idx += 1;
     }
 }
 
 void port_usart_disable_rx_interrupt(uint32_t usart_id){
-    usart_arr[usart_id].p_usart -> CR1 &= ~USART_CR1_RXNEIE;
+    usart_arr[usart_id].p_usart -> CR1 &= ~(USART_CR1_RXNEIE | USART_CR1_IDLEIE);
+    if (usart_arr[usart_id].rx_dma){
+        _stop_rx_dma(usart_id);
+    }
+    PORT_MODEL_USART_SYNC(usart_arr[usart_id].p_usart);
 }
 
 void port_usart_disable_tx_interrupt(uint32_t usart_id){
     usart_arr[usart_id].p_usart -> CR1 &= ~(USART_CR1_TXEIE | USART_CR1_TCIE);
+    PORT_MODEL_USART_SYNC(usart_arr[usart_id].p_usart);
 }
 
 void port_usart_enable_rx_interrupt(uint32_t usart_id){
-    usart_arr[usart_id].p_usart -> CR1 |= USART_CR1_RXNEIE;
+    if (usart_arr[usart_id].rx_dma){
+        // The DMA reads every byte: the CPU only hears of the end of a burst
+        _start_rx_dma(usart_id);
+        usart_arr[usart_id].p_usart -> CR1 |= USART_CR1_IDLEIE;
+    } else{
+        usart_arr[usart_id].p_usart -> CR1 |= USART_CR1_RXNEIE;
+    }
+    PORT_MODEL_USART_SYNC(usart_arr[usart_id].p_usart);
 }
 
 void port_usart_enable_tx_interrupt(uint32_t usart_id){
     usart_arr[usart_id].p_usart -> CR1 |= (USART_CR1_TXEIE | USART_CR1_TCIE);
+    PORT_MODEL_USART_SYNC(usart_arr[usart_id].p_usart);
 }
\ No newline at end of file
@@ -34,6 +34,7 @@
 #include <sys/times.h>
 
 #include "stm32f4xx.h"
+#include "port_system.h"
 
 /* Variables */
 #undef errno
@@ -70,6 +71,9 @@ void _exit (int status)
 /**
  * @brief Function able to use printf via SWO:ITM. It prints the messages on a terminal in VSCode.
  *
+ * It never waits for the ITM: the characters that find its FIFO full are dropped. The firmware logs through the
+ * buffer of fsm_log.h instead, which keeps them until the ITM takes them.
+ *
  * @param file
  * @param ptr
  * @param len
@@ -80,7 +84,7 @@ int _write(int file, char *ptr, int len)
     int i = 0;
     for (i = 0; i < len; i++)
     {
-        ITM_SendChar((*ptr++));
+        port_system_log_put_char(*ptr++);
     }
     return len;
 }
@@ -0,0 +1,58 @@
+/**
+ * @file sim_fleet.h
+ * @brief Header for sim_fleet.c file.
+ *
+ * A fleet is a set of independent jukeboxes, each one on its own simulated board (see port_sim_ctx_new()). Every
+ * jukebox follows a usage profile generated from its seed: it is powered on and then receives USART commands and
+ * button presses at random times. The same seed always produces the same run, whatever the thread that simulates it.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+#ifndef SIM_FLEET_H_
+#define SIM_FLEET_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define SIM_FLEET_MIN_GAP_MS 1000      /*!< Minimum time between two actions of the usage profile */
+#define SIM_FLEET_MAX_GAP_MS 120000    /*!< Maximum time between two actions of the usage profile */
+
+/* Typedefs --------------------------------------------------------------------*/
+/// @brief Statistics of one jukebox, or of a whole fleet when added up
+typedef struct
+{
+    uint32_t instances;         /*!< Jukeboxes simulated */
+    uint32_t halted;            /*!< Jukeboxes whose CPU went to sleep with nothing left to wake it */
+    uint64_t cycles;            /*!< Simulated time */
+    uint64_t sleep_cycles;      /*!< Simulated time with the CPU asleep */
+    uint64_t skipped_cycles;    /*!< Simulated time fast-forwarded by the harness */
+    uint64_t iterations;        /*!< Main loop iterations */
+    uint64_t isrs;              /*!< Interrupt service routines executed */
+    uint64_t commands;          /*!< Commands sent to the USART */
+    uint64_t presses;           /*!< Presses of the user button */
+    uint64_t tx_bytes;          /*!< Bytes transmitted by the USART */
+    uint64_t tx_hash;           /*!< FNV-1a of the USART output, added up over the fleet */
+} sim_fleet_stats_t;
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Simulate one jukebox on a new board context of the calling thread
+/// @param seed Seed of the usage profile
+/// @param duration_ms Simulated time after the board initialization
+/// @param p_stats Pointer to the statistics of the jukebox
+/// @return true on success, false if the board could not be created
+bool sim_fleet_run_instance(uint32_t seed, uint64_t duration_ms, sim_fleet_stats_t *p_stats);
+
+/// @brief Add the statistics of a jukebox to those of the fleet
+/// @param p_total Pointer to the statistics of the fleet
+/// @param p_stats Pointer to the statistics to add
+void sim_fleet_add(sim_fleet_stats_t *p_total, const sim_fleet_stats_t *p_stats);
+
+#endif /* SIM_FLEET_H_ */
@@ -0,0 +1,82 @@
+/**
+ * @file sim_jukebox.h
+ * @brief Header for sim_jukebox.c file.
+ *
+ * Runs the five FSMs of `main.c` on the native platform with a virtual clock. The main loop is the same as in
+ * `main.c`, but when an iteration leaves every FSM untouched and no interrupt ran, the clock jumps straight to the
+ * next pending event (note end, debounce timeout, SysTick, scripted input) instead of polling until it arrives.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+#ifndef SIM_JUKEBOX_H_
+#define SIM_JUKEBOX_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Other includes */
+#include "fsm.h"
+#include "fsm_button.h"
+#include "fsm_usart.h"
+#include "fsm_buzzer.h"
+#include "fsm_jukebox.h"
+#include "fsm_log.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define SIM_ON_OFF_PRESS_TIME_MS 1000       /*!< Same value as ON_OFF_PRESS_TIME_MS in main.c */
+#define SIM_NEXT_SONG_BUTTON_TIME_MS 500    /*!< Same value as NEXT_SONG_BUTTON_TIME_MS in main.c */
+#define SIM_IDLE_ITERATIONS 2               /*!< Iterations without changes before fast-forwarding the clock */
+
+/* Typedefs --------------------------------------------------------------------*/
+/// @brief Snapshot of the FSMs used to detect that an iteration changed nothing
+typedef struct
+{
+    fsm_button_t button;    /*!< Button FSM */
+    fsm_usart_t usart;      /*!< USART FSM */
+    fsm_buzzer_t buzzer;    /*!< Buzzer FSM */
+    fsm_jukebox_t jukebox;  /*!< Jukebox FSM */
+    fsm_log_t log;          /*!< Log FSM */
+} sim_jukebox_snapshot_t;
+
+/// @brief Jukebox system under simulation
+typedef struct
+{
+    fsm_t *p_fsm_button;                /*!< Button FSM */
+    fsm_t *p_fsm_usart;                 /*!< USART FSM */
+    fsm_t *p_fsm_buzzer;                /*!< Buzzer FSM */
+    fsm_t *p_fsm_jukebox;               /*!< Jukebox FSM */
+    fsm_t *p_fsm_log;                   /*!< Log FSM */
+    sim_jukebox_snapshot_t snapshot;    /*!< FSMs before the last iteration */
+    uint32_t idle_iterations;           /*!< Consecutive iterations that changed nothing */
+    uint64_t iterations;                /*!< Main loop iterations executed */
+    uint64_t skipped_cycles;            /*!< Cycles fast-forwarded while the FSMs were idle */
+    bool halted;                        /*!< The CPU went to sleep with nothing left to wake it */
+} sim_jukebox_t;
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Initialize the board selected by the calling thread and create the FSMs in the same order as `main.c`
+/// @param p_sim Pointer to the simulation
+void sim_jukebox_init(sim_jukebox_t *p_sim);
+
+/// @brief Run one iteration of the main loop, fast-forwarding the clock if the system is idle
+/// @param p_sim Pointer to the simulation
+/// @param limit The clock is never fast-forwarded beyond this cycle
+void sim_jukebox_step(sim_jukebox_t *p_sim, uint64_t limit);
+
+/// @brief Run the main loop until a given cycle or until the CPU halts
+/// @param p_sim Pointer to the simulation
+/// @param cycles Virtual time to stop at
+void sim_jukebox_run_until(sim_jukebox_t *p_sim, uint64_t cycles);
+
+/// @brief Destroy the FSMs
+/// @param p_sim Pointer to the simulation
+void sim_jukebox_destroy(sim_jukebox_t *p_sim);
+
+#endif /* SIM_JUKEBOX_H_ */
@@ -0,0 +1,56 @@
+/**
+ * @file sim_pool.h
+ * @brief Header for sim_pool.c file.
+ *
+ * Work-stealing pool of threads for independent tasks. The tasks are split in contiguous blocks, one per worker.
+ * Each worker takes its tasks from the bottom of its own deque and, when it runs out, steals from the top of the
+ * deques of the others, so a worker with long tasks does not keep the rest waiting.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+#ifndef SIM_POOL_H_
+#define SIM_POOL_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define SIM_POOL_MAX_WORKERS 256 /*!< Maximum number of threads of a pool */
+
+/* Typedefs --------------------------------------------------------------------*/
+/// @brief Task of the pool
+/// @param p_arg Argument given to sim_pool_run()
+/// @param worker Index of the worker executing the task
+/// @param task Index of the task
+typedef void (*sim_pool_task_cb_t)(void *p_arg, uint32_t worker, uint32_t task);
+
+/// @brief Statistics of a run of the pool
+typedef struct
+{
+    uint32_t workers;                           /*!< Threads used */
+    uint32_t executed[SIM_POOL_MAX_WORKERS];    /*!< Tasks executed by each worker */
+    uint32_t steals;                            /*!< Tasks executed by a worker other than their owner */
+} sim_pool_stats_t;
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Get the number of processors available
+/// @return Number of online processors, at least 1
+uint32_t sim_pool_get_cpus(void);
+
+/// @brief Run tasks `0 .. num_tasks - 1` in parallel and wait for all of them
+/// @param workers Number of threads. The calling thread is worker 0.
+/// @param num_tasks Number of tasks
+/// @param cb Task
+/// @param p_arg Argument of the task
+/// @param p_stats Pointer to the statistics of the run. It can be NULL.
+/// @return true on success, false if some thread could not be created. The other workers run its tasks anyway.
+bool sim_pool_run(uint32_t workers, uint32_t num_tasks, sim_pool_task_cb_t cb, void *p_arg, sim_pool_stats_t *p_stats);
+
+#endif /* SIM_POOL_H_ */
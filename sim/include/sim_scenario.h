@@ -0,0 +1,104 @@
+/**
+ * @file sim_scenario.h
+ * @brief Header for sim_scenario.c file.
+ *
+ * A scenario is a text file with one step per line: `<time> <action> [arguments]`. The time counts from the start
+ * of the main loop, after the board initialization of `main.c`. It is absolute, or relative to the previous step when
+ * it starts with `+`, and accepts the suffixes `ms` (default), `s`, `min` and `h`.
+ * Lines starting with `#` are comments. Actions:
+ *
+ * - `press <duration>`: press the user button for the given time.
+ * - `cmd <text>`: send a command to the USART, terminated with `\n`.
+ * - `expect lcd <row> <text>`: the row of the LCD shows the text (trailing blanks ignored).
+ * - `expect backlight on|off`: state of the LCD backlight.
+ * - `expect tx <text>`: the text was transmitted by the USART since the previous `expect tx`.
+ * - `expect state <button|usart|buzzer|jukebox> <STATE>[|<STATE>...]`: current state of an FSM.
+ * - `expect note <hz> [tolerance %]`: frequency of the buzzer PWM (0 for silence).
+ * - `end`: stop the simulation (implicit after the last step).
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+#ifndef SIM_SCENARIO_H_
+#define SIM_SCENARIO_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Other includes */
+#include "latency.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define SIM_SCENARIO_MAX_STEPS 256      /*!< Maximum number of steps of a scenario */
+#define SIM_SCENARIO_TEXT_LENGTH 96     /*!< Maximum length of the text argument of a step */
+#define SIM_SCENARIO_TX_LENGTH 4096     /*!< USART output kept for `expect tx` */
+#define SIM_SCENARIO_NOTE_TOLERANCE 1.0 /*!< Default tolerance of `expect note`, in percent */
+
+/* Enums */
+/// @brief Actions of a scenario step
+typedef enum
+{
+    SIM_STEP_PRESS = 0,         /*!< Press the user button */
+    SIM_STEP_CMD,               /*!< Send a command to the USART */
+    SIM_STEP_EXPECT_LCD,        /*!< Check a row of the LCD */
+    SIM_STEP_EXPECT_BACKLIGHT,  /*!< Check the LCD backlight */
+    SIM_STEP_EXPECT_TX,         /*!< Check the USART output */
+    SIM_STEP_EXPECT_STATE,      /*!< Check the state of an FSM */
+    SIM_STEP_EXPECT_NOTE,       /*!< Check the buzzer frequency */
+    SIM_STEP_END                /*!< End of the scenario */
+} sim_step_action_t;
+
+/* Typedefs --------------------------------------------------------------------*/
+/// @brief Step of a scenario
+typedef struct
+{
+    uint64_t cycles;                        /*!< Virtual time of the step */
+    sim_step_action_t action;               /*!< Action */
+    uint32_t line;                          /*!< Line of the scenario file */
+    uint32_t value;                         /*!< Press duration in ms, LCD row, FSM index or backlight state */
+    double hz;                              /*!< Expected frequency */
+    double tolerance;                       /*!< Frequency tolerance in percent */
+    char text[SIM_SCENARIO_TEXT_LENGTH];    /*!< Command, expected text or expected states */
+} sim_step_t;
+
+/// @brief Scenario loaded from a file
+typedef struct
+{
+    const char *p_name;                         /*!< File name */
+    sim_step_t steps[SIM_SCENARIO_MAX_STEPS];   /*!< Steps in chronological order */
+    uint32_t num_steps;                         /*!< Number of steps */
+} sim_scenario_t;
+
+/// @brief Outcome of a scenario
+typedef struct
+{
+    uint32_t checks;            /*!< Expectations evaluated */
+    uint32_t failures;          /*!< Expectations not met */
+    uint64_t cycles;            /*!< Simulated time */
+    uint64_t sleep_cycles;      /*!< Simulated time with the CPU asleep */
+    uint64_t skipped_cycles;    /*!< Simulated time fast-forwarded by the harness */
+    uint64_t iterations;        /*!< Main loop iterations */
+    uint32_t isrs;              /*!< Interrupt service routines executed */
+    latency_t latency;          /*!< Response time of the jukebox to the commands, in cycles */
+} sim_scenario_result_t;
+
+/* Function prototypes and explanation ---------------------------------------*/
+
+/// @brief Load a scenario file
+/// @param p_scenario Pointer to the scenario
+/// @param p_path Path of the file
+/// @return true on success. Errors are reported on stderr with the line number.
+bool sim_scenario_load(sim_scenario_t *p_scenario, const char *p_path);
+
+/// @brief Run a scenario on the jukebox
+/// @param p_scenario Pointer to the scenario
+/// @param trace Print the steps and the USART output as they happen
+/// @param p_result Pointer to the outcome
+void sim_scenario_run(const sim_scenario_t *p_scenario, bool trace, sim_scenario_result_t *p_result);
+
+#endif /* SIM_SCENARIO_H_ */
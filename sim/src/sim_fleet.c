@@ -0,0 +1,225 @@
+/**
+ * @file sim_fleet.c
+ * @brief Simulation of one jukebox of a fleet, with a random usage profile.
+ *
+ * Every action of the profile is an event of the virtual clock that performs the action and schedules the next one,
+ * so the jukebox sleeps between actions as it would in the field. The profile only uses its own generator. The game
+ * is left out: every command after it would be taken as a guess.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+
+#include "sim_fleet.h"
+#include "sim_jukebox.h"
+#include "port_system.h"
+#include "port_button.h"
+#include "port_usart.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define SIM_FLEET_POWER_PRESS_MS 1500   /*!< Press that turns the jukebox on or off */
+#define SIM_FLEET_SHORT_PRESS_MS 200    /*!< Short press of the user button */
+#define SIM_FLEET_FNV_OFFSET 2166136261U /*!< FNV-1a offset basis */
+#define SIM_FLEET_FNV_PRIME 16777619U   /*!< FNV-1a prime */
+
+/* Typedefs --------------------------------------------------------------------*/
+/// @brief Jukebox of the fleet in execution
+typedef struct
+{
+    sim_jukebox_t sim;          /*!< Jukebox */
+    sim_fleet_stats_t stats;    /*!< Statistics */
+    uint32_t rng;               /*!< State of the generator of the usage profile */
+    uint32_t tx_hash;           /*!< FNV-1a of the USART output */
+    uint64_t end;               /*!< Cycle at which the simulation stops */
+} sim_fleet_instance_t;
+
+/// @brief Action of the usage profile, with its weight
+typedef struct
+{
+    const char *p_command;  /*!< Command, or NULL for a short press of the button */
+    uint32_t weight;        /*!< Relative frequency */
+} sim_fleet_action_t;
+
+/* Commands fit the 16 bytes of the USART buffer, `\n` included */
+static const sim_fleet_action_t actions[] = {
+    {"play", 20},
+    {"next", 20},
+    {"stop", 8},
+    {"pause", 8},
+    {"volume 0.", 12},  /* Followed by a random digit */
+    {"select ", 12},    /* Followed by a random melody index */
+    {"info", 10},
+    {NULL, 10},
+};
+
+#define SIM_FLEET_NUM_ACTIONS (sizeof(actions) / sizeof(actions[0])) /*!< Number of actions of the profile */
+
+/* Private functions -----------------------------------------------------------*/
+/// @brief Next number of the xorshift32 generator of an instance
+/// @param p_instance Pointer to the instance
+/// @return Random number
+static uint32_t _random(sim_fleet_instance_t *p_instance)
+{
+    uint32_t x = p_instance->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    p_instance->rng = x;
+    return x;
+}
+
+/// @brief Random number in a range
+/// @param p_instance Pointer to the instance
+/// @param min Minimum value
+/// @param max Maximum value, excluded
+/// @return Random number
+static uint32_t _random_range(sim_fleet_instance_t *p_instance, uint32_t min, uint32_t max)
+{
+    return min + _random(p_instance) % (max - min);
+}
+
+/// @brief Event: release the user button
+static void _on_release(void *p_arg, uint32_t data)
+{
+    port_sim_gpio_set_input(BUTTON_0_GPIO, BUTTON_0_PIN, HIGH);
+}
+
+/// @brief Press the user button
+/// @param p_instance Pointer to the instance
+/// @param ms Duration of the press
+static void _press(sim_fleet_instance_t *p_instance, uint32_t ms)
+{
+    port_sim_gpio_set_input(BUTTON_0_GPIO, BUTTON_0_PIN, LOW);
+    port_sim_schedule(port_sim_get_cycles() + PORT_SIM_MS_TO_CYCLES(ms), _on_release, NULL, 0);
+    p_instance->stats.presses++;
+}
+
+/// @brief Event: perform a random action and schedule the next one
+/// @param p_arg Pointer to the instance
+/// @param data Unused
+static void _on_action(void *p_arg, uint32_t data)
+{
+    sim_fleet_instance_t *p_instance = (sim_fleet_instance_t *)p_arg;
+
+    uint64_t next = port_sim_get_cycles() +
+                    PORT_SIM_MS_TO_CYCLES(_random_range(p_instance, SIM_FLEET_MIN_GAP_MS, SIM_FLEET_MAX_GAP_MS));
+    if (next < p_instance->end)
+    {
+        port_sim_schedule(next, _on_action, p_instance, 0);
+    }
+
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < SIM_FLEET_NUM_ACTIONS; i++)
+    {
+        total += actions[i].weight;
+    }
+    uint32_t pick = _random_range(p_instance, 0, total);
+    const sim_fleet_action_t *p_action = actions;
+    while (pick >= p_action->weight)
+    {
+        pick -= p_action->weight;
+        p_action++;
+    }
+
+    if (!p_action->p_command)
+    {
+        _press(p_instance, SIM_FLEET_SHORT_PRESS_MS);
+        return;
+    }
+    char command[USART_INPUT_BUFFER_LENGTH + 1];
+    size_t length;
+    if (!strcmp(p_action->p_command, "volume 0.") || !strcmp(p_action->p_command, "select "))
+    {
+        length = (size_t)snprintf(command, sizeof(command), "%s%u\n", p_action->p_command,
+                                  (unsigned)_random_range(p_instance, 0, 10));
+    }
+    else
+    {
+        length = (size_t)snprintf(command, sizeof(command), "%s\n", p_action->p_command);
+    }
+    port_sim_usart_inject(USART_0, (const uint8_t *)command, length, port_sim_get_cycles());
+    p_instance->stats.commands++;
+}
+
+/// @brief Event: power on the jukebox
+/// @param p_arg Pointer to the instance
+/// @param data Unused
+static void _on_power(void *p_arg, uint32_t data)
+{
+    sim_fleet_instance_t *p_instance = (sim_fleet_instance_t *)p_arg;
+    _press(p_instance, SIM_FLEET_POWER_PRESS_MS);
+    _on_action(p_instance, 0);
+}
+
+/// @brief Hash the bytes transmitted by the USART
+static void _on_tx(void *p_arg, USART_TypeDef *p_usart, uint8_t byte, uint64_t cycles)
+{
+    sim_fleet_instance_t *p_instance = (sim_fleet_instance_t *)p_arg;
+    p_instance->tx_hash = (p_instance->tx_hash ^ byte) * SIM_FLEET_FNV_PRIME;
+    p_instance->stats.tx_bytes++;
+}
+
+/* Public functions -----------------------------------------------------------*/
+bool sim_fleet_run_instance(uint32_t seed, uint64_t duration_ms, sim_fleet_stats_t *p_stats)
+{
+    port_sim_ctx_t *p_ctx = port_sim_ctx_new();
+    if (!p_ctx)
+    {
+        return false;
+    }
+    port_sim_ctx_t *p_previous = port_sim_ctx_current();
+    port_sim_ctx_select(p_ctx);
+
+    sim_fleet_instance_t instance;
+    memset(&instance, 0, sizeof(instance));
+    /* Spread the seeds so that consecutive instances do not start with related sequences; 0 is not a valid state */
+    instance.rng = (seed + 1U) * 2654435761U;
+    if (!instance.rng)
+    {
+        instance.rng = 1;
+    }
+    instance.tx_hash = SIM_FLEET_FNV_OFFSET;
+    port_sim_usart_set_tx_hook(_on_tx, &instance);
+    sim_jukebox_init(&instance.sim);
+
+    uint64_t start = port_sim_get_cycles();
+    instance.end = start + PORT_SIM_MS_TO_CYCLES(duration_ms);
+    port_sim_schedule(start + PORT_SIM_MS_TO_CYCLES(_random_range(&instance, 0, SIM_FLEET_MIN_GAP_MS)), _on_power,
+                      &instance, 0);
+    sim_jukebox_run_until(&instance.sim, instance.end);
+
+    instance.stats.instances = 1;
+    instance.stats.halted = instance.sim.halted;
+    instance.stats.cycles = port_sim_get_cycles();
+    instance.stats.sleep_cycles = port_sim_get_sleep_cycles();
+    instance.stats.skipped_cycles = instance.sim.skipped_cycles;
+    instance.stats.iterations = instance.sim.iterations;
+    instance.stats.isrs = port_sim_get_isr_count();
+    instance.stats.tx_hash = instance.tx_hash;
+    *p_stats = instance.stats;
+
+    sim_jukebox_destroy(&instance.sim);
+    port_sim_ctx_destroy(p_ctx);
+    port_sim_ctx_select(p_previous);
+    return true;
+}
+
+void sim_fleet_add(sim_fleet_stats_t *p_total, const sim_fleet_stats_t *p_stats)
+{
+    p_total->instances += p_stats->instances;
+    p_total->halted += p_stats->halted;
+    p_total->cycles += p_stats->cycles;
+    p_total->sleep_cycles += p_stats->sleep_cycles;
+    p_total->skipped_cycles += p_stats->skipped_cycles;
+    p_total->iterations += p_stats->iterations;
+    p_total->isrs += p_stats->isrs;
+    p_total->commands += p_stats->commands;
+    p_total->presses += p_stats->presses;
+    p_total->tx_bytes += p_stats->tx_bytes;
+    p_total->tx_hash += p_stats->tx_hash;
+}
@@ -0,0 +1,277 @@
+/**
+ * @file sim_fleet_main.c
+ * @brief Command line of the fleet simulation: `jukebox_fleet [options]`
+ *
+ * Simulates a fleet of jukeboxes on a work-stealing pool of threads and prints the aggregated statistics.
+ *
+ * - `-n <instances>`: number of jukeboxes (default 1000).
+ * - `-d <seconds>`: simulated time of each jukebox (default 600).
+ * - `-t <threads>`: threads of the pool (default: one per processor).
+ * - `-s <seed>`: seed of the first jukebox; jukebox `i` uses `seed + i` (default 0).
+ * - `--check`: run the fleet with 1 thread and with `-t` threads, and fail if the statistics differ.
+ * - `--bench`: run the fleet with 1, 2, 4... threads up to `-t` and print the scaling efficiency.
+ *
+ * The firmware writes its messages on the standard output, so it is sent to `/dev/null` and the report goes to a
+ * copy of the original descriptor.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* fdopen, dup and clock_gettime are POSIX */
+#define _POSIX_C_SOURCE 200809L
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sim_fleet.h"
+#include "sim_pool.h"
+#include "port_system.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define SIM_FLEET_DEFAULT_INSTANCES 1000    /*!< Default number of jukeboxes */
+#define SIM_FLEET_DEFAULT_DURATION_S 600    /*!< Default simulated time of each jukebox */
+
+/* Typedefs --------------------------------------------------------------------*/
+/// @brief Fleet in execution, shared by the workers
+typedef struct
+{
+    uint32_t seed;                  /*!< Seed of the first jukebox */
+    uint64_t duration_ms;           /*!< Simulated time of each jukebox */
+    sim_fleet_stats_t *p_stats;     /*!< Statistics of each jukebox, indexed by task */
+    volatile bool failed;           /*!< Some board could not be created */
+} sim_fleet_run_t;
+
+/// @brief Outcome of a run of the fleet
+typedef struct
+{
+    sim_fleet_stats_t total;    /*!< Statistics added up in the order of the jukeboxes */
+    sim_pool_stats_t pool;      /*!< Statistics of the pool */
+    double wall_s;              /*!< Host time */
+} sim_fleet_result_t;
+
+static FILE *p_report; /*!< Standard output of the process, before the firmware output was discarded */
+
+/* Private functions -----------------------------------------------------------*/
+/// @brief Task of the pool: simulate one jukebox
+/// @param p_arg Pointer to the fleet
+/// @param worker Unused
+/// @param task Index of the jukebox
+static void _task(void *p_arg, uint32_t worker, uint32_t task)
+{
+    sim_fleet_run_t *p_run = (sim_fleet_run_t *)p_arg;
+    if (!sim_fleet_run_instance(p_run->seed + task, p_run->duration_ms, &p_run->p_stats[task]))
+    {
+        p_run->failed = true;
+    }
+}
+
+/// @brief Host time
+/// @return Seconds of a monotonic clock
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/// @brief Simulate the fleet
+/// @param p_run Pointer to the fleet
+/// @param instances Number of jukeboxes
+/// @param threads Threads of the pool
+/// @param p_result Pointer to the outcome
+/// @return true on success
+static bool _run(sim_fleet_run_t *p_run, uint32_t instances, uint32_t threads, sim_fleet_result_t *p_result)
+{
+    memset(p_result, 0, sizeof(sim_fleet_result_t));
+    memset(p_run->p_stats, 0, instances * sizeof(sim_fleet_stats_t));
+    p_run->failed = false;
+
+    double start = _now();
+    bool ok = sim_pool_run(threads, instances, _task, p_run, &p_result->pool);
+    p_result->wall_s = _now() - start;
+
+    /* Same order whatever the number of threads: the totals must not depend on the schedule */
+    for (uint32_t i = 0; i < instances; i++)
+    {
+        sim_fleet_add(&p_result->total, &p_run->p_stats[i]);
+    }
+    return ok && !p_run->failed;
+}
+
+/// @brief Print the outcome of a run
+/// @param p_result Pointer to the outcome
+static void _print_result(const sim_fleet_result_t *p_result)
+{
+    const sim_fleet_stats_t *p_total = &p_result->total;
+    double simulated_s = (double)p_total->cycles / PORT_SIM_CORE_CLOCK_HZ;
+    uint32_t min = UINT32_MAX;
+    uint32_t max = 0;
+    for (uint32_t w = 0; w < p_result->pool.workers; w++)
+    {
+        min = p_result->pool.executed[w] < min ? p_result->pool.executed[w] : min;
+        max = p_result->pool.executed[w] > max ? p_result->pool.executed[w] : max;
+    }
+
+    fprintf(p_report, "%u jukeboxes on %u threads: %.3f s of host time\n", (unsigned)p_total->instances,
+            (unsigned)p_result->pool.workers, p_result->wall_s);
+    fprintf(p_report, "  simulated %.1f h (x%.0f), %.1f jukeboxes/s\n", simulated_s / 3600.0,
+            p_result->wall_s > 0 ? simulated_s / p_result->wall_s : 0.0,
+            p_result->wall_s > 0 ? p_total->instances / p_result->wall_s : 0.0);
+    fprintf(p_report, "  %u stolen, %u to %u jukeboxes per thread\n", (unsigned)p_result->pool.steals, (unsigned)min,
+            (unsigned)max);
+    fprintf(p_report, "  %llu commands, %llu presses, %llu bytes sent (hash %016llx)\n",
+            (unsigned long long)p_total->commands, (unsigned long long)p_total->presses,
+            (unsigned long long)p_total->tx_bytes, (unsigned long long)p_total->tx_hash);
+    fprintf(p_report, "  %llu main loop iterations, %llu ISRs, CPU asleep %.1f%%, fast-forwarded %.1f%%, %u halted\n",
+            (unsigned long long)p_total->iterations, (unsigned long long)p_total->isrs,
+            p_total->cycles ? 100.0 * p_total->sleep_cycles / p_total->cycles : 0.0,
+            p_total->cycles ? 100.0 * p_total->skipped_cycles / p_total->cycles : 0.0, (unsigned)p_total->halted);
+}
+
+/// @brief Run the fleet with 1 thread and with more threads and compare the statistics
+/// @param p_run Pointer to the fleet
+/// @param instances Number of jukeboxes
+/// @param threads Threads of the parallel run
+/// @return true if both runs agree
+static bool _check(sim_fleet_run_t *p_run, uint32_t instances, uint32_t threads)
+{
+    sim_fleet_result_t serial;
+    sim_fleet_result_t parallel;
+    if (!_run(p_run, instances, 1, &serial) || !_run(p_run, instances, threads, &parallel))
+    {
+        fprintf(p_report, "FAIL: the fleet could not be simulated\n");
+        return false;
+    }
+    _print_result(&serial);
+    _print_result(&parallel);
+    bool ok = !memcmp(&serial.total, &parallel.total, sizeof(sim_fleet_stats_t));
+    fprintf(p_report, "%s: 1 and %u threads %s\n", ok ? "PASS" : "FAIL", (unsigned)parallel.pool.workers,
+            ok ? "agree" : "disagree");
+    return ok;
+}
+
+/// @brief Measure the scaling from 1 thread up to a number of threads
+/// @param p_run Pointer to the fleet
+/// @param instances Number of jukeboxes
+/// @param threads Maximum number of threads
+/// @return true if every run agrees with the one of 1 thread
+static bool _bench(sim_fleet_run_t *p_run, uint32_t instances, uint32_t threads)
+{
+    sim_fleet_result_t serial;
+    sim_fleet_result_t result;
+    bool ok = _run(p_run, instances, 1, &serial);
+
+    fprintf(p_report, "%8s %10s %12s %8s %10s\n", "threads", "host s", "jukeboxes/s", "speedup", "efficiency");
+    for (uint32_t n = 1; ok && n <= threads; n = (n < threads && n * 2 > threads) ? threads : n * 2)
+    {
+        const sim_fleet_result_t *p_result = &serial;
+        if (n > 1)
+        {
+            ok = _run(p_run, instances, n, &result) &&
+                 !memcmp(&serial.total, &result.total, sizeof(sim_fleet_stats_t));
+            p_result = &result;
+        }
+        double speedup = p_result->wall_s > 0 ? serial.wall_s / p_result->wall_s : 0.0;
+        fprintf(p_report, "%8u %10.3f %12.1f %8.2f %9.1f%%\n", (unsigned)n, p_result->wall_s,
+                p_result->wall_s > 0 ? instances / p_result->wall_s : 0.0, speedup, 100.0 * speedup / n);
+    }
+    if (!ok)
+    {
+        fprintf(p_report, "FAIL: the runs disagree or the fleet could not be simulated\n");
+    }
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t instances = SIM_FLEET_DEFAULT_INSTANCES;
+    uint32_t threads = sim_pool_get_cpus();
+    uint64_t duration_s = SIM_FLEET_DEFAULT_DURATION_S;
+    uint32_t seed = 0;
+    bool check = false;
+    bool bench = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = (i + 1 < argc);
+        if (!strcmp(argv[i], "-n") && has_value)
+        {
+            instances = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-d") && has_value)
+        {
+            duration_s = strtoull(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-t") && has_value)
+        {
+            threads = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-s") && has_value)
+        {
+            seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "--check"))
+        {
+            check = true;
+        }
+        else if (!strcmp(argv[i], "--bench"))
+        {
+            bench = true;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [-n instances] [-d seconds] [-t threads] [-s seed] [--check] [--bench]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (!instances || !threads)
+    {
+        fprintf(stderr, "%s: the fleet needs at least one jukebox and one thread\n", argv[0]);
+        return 1;
+    }
+
+    /* Keep the report, discard the messages of the firmware */
+    fflush(stdout);
+    int report_fd = dup(STDOUT_FILENO);
+    p_report = (report_fd >= 0) ? fdopen(report_fd, "w") : NULL;
+    if (!p_report || !freopen("/dev/null", "w", stdout))
+    {
+        fprintf(stderr, "%s: cannot redirect the standard output\n", argv[0]);
+        return 1;
+    }
+
+    sim_fleet_run_t run = {.seed = seed, .duration_ms = duration_s * 1000U};
+    run.p_stats = malloc(instances * sizeof(sim_fleet_stats_t));
+    if (!run.p_stats)
+    {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        return 1;
+    }
+
+    bool ok;
+    if (check)
+    {
+        ok = _check(&run, instances, threads);
+    }
+    else if (bench)
+    {
+        ok = _bench(&run, instances, threads);
+    }
+    else
+    {
+        sim_fleet_result_t result;
+        ok = _run(&run, instances, threads, &result);
+        _print_result(&result);
+    }
+
+    free(run.p_stats);
+    fclose(p_report);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file sim_jukebox.c
+ * @brief Jukebox FSMs of main.c running on the virtual clock of the native platform.
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
+#include "sim_jukebox.h"
+#include "port_system.h"
+#include "port_button.h"
+#include "port_usart.h"
+#include "port_buzzer.h"
+#include "port_lcd.h"
+
+/// @brief Idle hook: the CPU went to sleep with no interrupt left to wake it
+/// @param p_arg Pointer to the simulation of the board
+static void _on_idle(void *p_arg)
+{
+    ((sim_jukebox_t *)p_arg)->halted = true;
+}
+
+/// @brief Copy the FSMs into the snapshot
+/// @param p_sim Pointer to the simulation
+static void _take_snapshot(sim_jukebox_t *p_sim)
+{
+    memcpy(&p_sim->snapshot.button, p_sim->p_fsm_button, sizeof(fsm_button_t));
+    memcpy(&p_sim->snapshot.usart, p_sim->p_fsm_usart, sizeof(fsm_usart_t));
+    memcpy(&p_sim->snapshot.buzzer, p_sim->p_fsm_buzzer, sizeof(fsm_buzzer_t));
+    memcpy(&p_sim->snapshot.jukebox, p_sim->p_fsm_jukebox, sizeof(fsm_jukebox_t));
+    memcpy(&p_sim->snapshot.log, p_sim->p_fsm_log, sizeof(fsm_log_t));
+}
+
+/// @brief Check whether any FSM differs from the snapshot
+/// @param p_sim Pointer to the simulation
+/// @return true if something changed
+static bool _changed(sim_jukebox_t *p_sim)
+{
+    return memcmp(&p_sim->snapshot.button, p_sim->p_fsm_button, sizeof(fsm_button_t)) ||
+           memcmp(&p_sim->snapshot.usart, p_sim->p_fsm_usart, sizeof(fsm_usart_t)) ||
+           memcmp(&p_sim->snapshot.buzzer, p_sim->p_fsm_buzzer, sizeof(fsm_buzzer_t)) ||
+           memcmp(&p_sim->snapshot.jukebox, p_sim->p_fsm_jukebox, sizeof(fsm_jukebox_t)) ||
+           memcmp(&p_sim->snapshot.log, p_sim->p_fsm_log, sizeof(fsm_log_t));
+}
+
+void sim_jukebox_init(sim_jukebox_t *p_sim)
+{
+    memset(p_sim, 0, sizeof(sim_jukebox_t));
+    port_sim_set_idle_hook(_on_idle, p_sim);
+
+    /* The user button of the board has an external pull-up: the line idles high */
+    port_sim_gpio_set_input(BUTTON_0_GPIO, BUTTON_0_PIN, HIGH);
+
+    /* Same initialization as main.c */
+    port_system_init();
+    HAL_Init();
+    port_lcd_init(2);
+    port_lcd_clear();
+    port_lcd_no_backlight();
+
+    p_sim->p_fsm_button = fsm_button_new(BUTTON_0_DEBOUNCE_TIME_MS, BUTTON_0_ID);
+    p_sim->p_fsm_usart = fsm_usart_new(USART_0_ID);
+    p_sim->p_fsm_buzzer = fsm_buzzer_new(BUZZER_0_ID);
+    p_sim->p_fsm_log = fsm_log_new();
+    p_sim->p_fsm_jukebox = fsm_jukebox_new(p_sim->p_fsm_button, SIM_ON_OFF_PRESS_TIME_MS, p_sim->p_fsm_usart,
+                                           p_sim->p_fsm_buzzer, SIM_NEXT_SONG_BUTTON_TIME_MS, p_sim->p_fsm_log);
+    _take_snapshot(p_sim);
+}
+
+void sim_jukebox_step(sim_jukebox_t *p_sim, uint64_t limit)
+{
+    uint32_t isr_count = port_sim_get_isr_count();
+
+    fsm_fire(p_sim->p_fsm_button);
+    fsm_fire(p_sim->p_fsm_usart);
+    fsm_fire(p_sim->p_fsm_buzzer);
+    fsm_fire(p_sim->p_fsm_jukebox);
+    fsm_fire(p_sim->p_fsm_log);
+    p_sim->iterations++;
+
+    if (_changed(p_sim) || port_sim_get_isr_count() != isr_count)
+    {
+        _take_snapshot(p_sim);
+        p_sim->idle_iterations = 0;
+        return;
+    }
+    if (++p_sim->idle_iterations < SIM_IDLE_ITERATIONS)
+    {
+        return;
+    }
+
+    /* Nothing can change until the next event: polling up to it would only burn host time */
+    uint64_t now = port_sim_get_cycles();
+    uint64_t next = port_sim_next_event();
+    if (next > limit)
+    {
+        next = limit;
+    }
+    if (next > now)
+    {
+        port_sim_advance_to(next);
+        p_sim->skipped_cycles += next - now;
+    }
+}
+
+void sim_jukebox_run_until(sim_jukebox_t *p_sim, uint64_t cycles)
+{
+    while (!p_sim->halted && port_sim_get_cycles() < cycles)
+    {
+        sim_jukebox_step(p_sim, cycles);
+    }
+}
+
+void sim_jukebox_destroy(sim_jukebox_t *p_sim)
+{
+    fsm_destroy(p_sim->p_fsm_button);
+    fsm_destroy(p_sim->p_fsm_usart);
+    fsm_destroy(p_sim->p_fsm_buzzer);
+    fsm_destroy(p_sim->p_fsm_jukebox);
+    fsm_destroy(p_sim->p_fsm_log);
+    port_sim_set_idle_hook(NULL, NULL);
+}
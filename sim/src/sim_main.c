@@ -0,0 +1,96 @@
+/**
+ * @file sim_main.c
+ * @brief Command line of the jukebox simulation: `jukebox_sim [--trace] [--latency] <scenario>...`
+ *
+ * Runs every scenario from power-on and prints a summary. The exit status is the number of failed scenarios.
+ * `--latency` adds the response time of the jukebox to each command of the scenario (see latency.h), in virtual time.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "sim_scenario.h"
+#include "port_system.h"
+#include "port_usart.h"
+
+static sim_scenario_t scenario; /*!< Too large for the stack */
+
+/// @brief Print the outcome of a scenario
+/// @param p_name Scenario file
+/// @param p_result Pointer to the outcome
+/// @param wall_s Host time spent, in seconds
+static void _print_result(const char *p_name, const sim_scenario_result_t *p_result, double wall_s)
+{
+    double simulated_s = (double)p_result->cycles / PORT_SIM_CORE_CLOCK_HZ;
+    printf("%s: %s (%u/%u checks)\n", p_name, p_result->failures ? "FAIL" : "PASS",
+           (unsigned)(p_result->checks - p_result->failures), (unsigned)p_result->checks);
+    printf("  simulated %.3f s in %.3f ms of host time (x%.0f)\n", simulated_s, wall_s * 1000.0,
+           wall_s > 0 ? simulated_s / wall_s : 0.0);
+    printf("  %llu main loop iterations, %u ISRs, CPU asleep %.1f%%, fast-forwarded %.1f%%\n",
+           (unsigned long long)p_result->iterations, (unsigned)p_result->isrs,
+           p_result->cycles ? 100.0 * p_result->sleep_cycles / p_result->cycles : 0.0,
+           p_result->cycles ? 100.0 * p_result->skipped_cycles / p_result->cycles : 0.0);
+}
+
+/// @brief Print the latency of every command of a scenario
+/// @param p_result Pointer to the outcome
+static void _print_latency(const sim_scenario_result_t *p_result)
+{
+    char line[USART_OUTPUT_BUFFER_LENGTH];
+    for (uint32_t idx = 0; idx < latency_get_num_commands(&p_result->latency); idx++)
+    {
+        latency_format(&p_result->latency, idx, PORT_SIM_CORE_CLOCK_HZ, line, sizeof(line));
+        printf("  latency %s", line);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    bool trace = false;
+    bool latency = false;
+    int failed = 0;
+    int scenarios = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--trace"))
+        {
+            trace = true;
+            continue;
+        }
+        if (!strcmp(argv[i], "--latency"))
+        {
+            latency = true;
+            continue;
+        }
+        scenarios++;
+        if (!sim_scenario_load(&scenario, argv[i]))
+        {
+            failed++;
+            continue;
+        }
+        sim_scenario_result_t result;
+        clock_t start = clock();
+        sim_scenario_run(&scenario, trace, &result);
+        double wall_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+        _print_result(argv[i], &result, wall_s);
+        if (latency)
+        {
+            _print_latency(&result);
+        }
+        failed += (result.failures != 0);
+    }
+
+    if (!scenarios)
+    {
+        fprintf(stderr, "usage: %s [--trace] [--latency] <scenario>...\n", argv[0]);
+        return 1;
+    }
+    return failed;
+}
@@ -0,0 +1,204 @@
+/**
+ * @file sim_pool.c
+ * @brief Work-stealing pool of threads for the fleet simulation.
+ *
+ * The tasks are indices, so the deque of a worker is a range `[top, bottom)` of indices protected by a mutex. The
+ * owner takes from the bottom. A thief takes the upper half of the range of its victim, so the ranges split like
+ * the work of a recursive scheduler and a worker only steals a few times even with thousands of tasks.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* pthread and sysconf are POSIX */
+#define _POSIX_C_SOURCE 200809L
+
+/* Includes ------------------------------------------------------------------*/
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sim_pool.h"
+
+/* Typedefs --------------------------------------------------------------------*/
+/// @brief Deque of a worker. Aligned to a cache line so the workers do not share lines.
+typedef struct
+{
+    _Alignas(64) pthread_mutex_t lock;  /*!< Protects `top` and `bottom` */
+    uint32_t top;                       /*!< First task not taken: thieves take from here */
+    uint32_t bottom;                    /*!< One past the last task not taken: the owner takes from here */
+    uint32_t executed;                  /*!< Tasks executed by the worker */
+    uint32_t steals;                    /*!< Tasks taken from other workers */
+} sim_pool_deque_t;
+
+/// @brief Run of the pool
+typedef struct
+{
+    sim_pool_deque_t *p_deques;     /*!< One deque per worker */
+    uint32_t workers;               /*!< Number of workers */
+    sim_pool_task_cb_t cb;          /*!< Task */
+    void *p_arg;                    /*!< Argument of the task */
+} sim_pool_t;
+
+/// @brief Argument of a worker thread
+typedef struct
+{
+    sim_pool_t *p_pool; /*!< Pool */
+    uint32_t index;     /*!< Index of the worker */
+} sim_pool_worker_t;
+
+/* Private functions -----------------------------------------------------------*/
+/// @brief Take a task from the bottom of the own deque
+/// @param p_deque Deque of the worker
+/// @param p_task Pointer to the task taken
+/// @return true if there was a task
+static bool _pop(sim_pool_deque_t *p_deque, uint32_t *p_task)
+{
+    bool found = false;
+    pthread_mutex_lock(&p_deque->lock);
+    if (p_deque->top < p_deque->bottom)
+    {
+        *p_task = --p_deque->bottom;
+        found = true;
+    }
+    pthread_mutex_unlock(&p_deque->lock);
+    return found;
+}
+
+/// @brief Move the upper half of the tasks of a victim to the empty deque of a thief
+/// @param p_thief Deque of the thief
+/// @param p_victim Deque of the victim
+/// @return true if some task was stolen
+static bool _steal(sim_pool_deque_t *p_thief, sim_pool_deque_t *p_victim)
+{
+    uint32_t top = 0;
+    uint32_t count = 0;
+    pthread_mutex_lock(&p_victim->lock);
+    if (p_victim->top < p_victim->bottom)
+    {
+        count = (p_victim->bottom - p_victim->top + 1) / 2;
+        top = p_victim->top;
+        p_victim->top += count;
+    }
+    pthread_mutex_unlock(&p_victim->lock);
+    if (!count)
+    {
+        return false;
+    }
+    pthread_mutex_lock(&p_thief->lock);
+    p_thief->top = top;
+    p_thief->bottom = top + count;
+    p_thief->steals += count;
+    pthread_mutex_unlock(&p_thief->lock);
+    return true;
+}
+
+/// @brief Body of a worker: run its own tasks, then steal until every deque is empty
+/// @param p_arg Pointer to the worker
+/// @return NULL
+static void *_worker(void *p_arg)
+{
+    sim_pool_worker_t *p_worker = (sim_pool_worker_t *)p_arg;
+    sim_pool_t *p_pool = p_worker->p_pool;
+    sim_pool_deque_t *p_own = &p_pool->p_deques[p_worker->index];
+    uint32_t task;
+
+    for (;;)
+    {
+        while (_pop(p_own, &task))
+        {
+            p_pool->cb(p_pool->p_arg, p_worker->index, task);
+            p_own->executed++;
+        }
+        /* Tasks never create tasks: once a whole round finds every deque empty, the run is over */
+        bool stolen = false;
+        for (uint32_t i = 1; i < p_pool->workers && !stolen; i++)
+        {
+            stolen = _steal(p_own, &p_pool->p_deques[(p_worker->index + i) % p_pool->workers]);
+        }
+        if (!stolen)
+        {
+            return NULL;
+        }
+    }
+}
+
+/* Public functions -----------------------------------------------------------*/
+uint32_t sim_pool_get_cpus(void)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (uint32_t)cpus : 1U;
+}
+
+bool sim_pool_run(uint32_t workers, uint32_t num_tasks, sim_pool_task_cb_t cb, void *p_arg, sim_pool_stats_t *p_stats)
+{
+    if (workers < 1)
+    {
+        workers = 1;
+    }
+    if (workers > SIM_POOL_MAX_WORKERS)
+    {
+        workers = SIM_POOL_MAX_WORKERS;
+    }
+
+    sim_pool_t pool = {.workers = workers, .cb = cb, .p_arg = p_arg};
+    pool.p_deques = aligned_alloc(_Alignof(sim_pool_deque_t), workers * sizeof(sim_pool_deque_t));
+    sim_pool_worker_t *p_workers = malloc(workers * sizeof(sim_pool_worker_t));
+    pthread_t *p_threads = malloc(workers * sizeof(pthread_t));
+    if (!pool.p_deques || !p_workers || !p_threads)
+    {
+        free(pool.p_deques);
+        free(p_workers);
+        free(p_threads);
+        return false;
+    }
+
+    /* Contiguous blocks: neighbouring tasks stay on the same worker unless someone steals them */
+    for (uint32_t w = 0; w < workers; w++)
+    {
+        sim_pool_deque_t *p_deque = &pool.p_deques[w];
+        memset(p_deque, 0, sizeof(sim_pool_deque_t));
+        pthread_mutex_init(&p_deque->lock, NULL);
+        p_deque->top = (uint32_t)((uint64_t)num_tasks * w / workers);
+        p_deque->bottom = (uint32_t)((uint64_t)num_tasks * (w + 1) / workers);
+        p_workers[w] = (sim_pool_worker_t){.p_pool = &pool, .index = w};
+    }
+
+    uint32_t started = 1;
+    bool ok = true;
+    for (uint32_t w = 1; w < workers; w++, started++)
+    {
+        if (pthread_create(&p_threads[w], NULL, _worker, &p_workers[w]))
+        {
+            ok = false;
+            break;
+        }
+    }
+    /* The calling thread works too. If a thread could not be created, its tasks are stolen by the others. */
+    _worker(&p_workers[0]);
+    for (uint32_t w = 1; w < started; w++)
+    {
+        pthread_join(p_threads[w], NULL);
+    }
+
+    if (p_stats)
+    {
+        memset(p_stats, 0, sizeof(sim_pool_stats_t));
+        p_stats->workers = workers;
+        for (uint32_t w = 0; w < workers; w++)
+        {
+            p_stats->executed[w] = pool.p_deques[w].executed;
+            p_stats->steals += pool.p_deques[w].steals;
+        }
+    }
+    for (uint32_t w = 0; w < workers; w++)
+    {
+        pthread_mutex_destroy(&pool.p_deques[w].lock);
+    }
+    free(pool.p_deques);
+    free(p_workers);
+    free(p_threads);
+    return ok;
+}
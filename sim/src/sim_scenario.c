@@ -0,0 +1,617 @@
+/**
+ * @file sim_scenario.c
+ * @brief Scenario parser and runner of the jukebox simulation.
+ *
+ * Every step is an event of the virtual clock: stimuli (button, USART input) act on the peripheral models at their
+ * exact time. Expectations are evaluated at once if the CPU is asleep, or else at the end of the current iteration of
+ * the main loop, so they never see an FSM halfway through an action.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#include "sim_scenario.h"
+#include "sim_jukebox.h"
+#include "port_system.h"
+#include "port_button.h"
+#include "port_usart.h"
+#include "port_lcd.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define SIM_SCENARIO_LINE_LENGTH 256    /*!< Maximum length of a line of a scenario file */
+#define SIM_SCENARIO_MAX_STATES 6       /*!< Maximum number of states of the FSMs */
+#define SIM_SCENARIO_MARGIN_MS 1000     /*!< Simulated time allowed after the last step */
+
+/* Typedefs -------------------------------------------------------------------*/
+/// @brief State names of an FSM, as in its header
+typedef struct
+{
+    const char *p_name;                                 /*!< Name used in the scenarios */
+    const char *p_states[SIM_SCENARIO_MAX_STATES];      /*!< Name of every state, indexed by value */
+} sim_fsm_names_t;
+
+/// @brief Scenario in execution
+typedef struct
+{
+    const sim_scenario_t *p_scenario;           /*!< Scenario */
+    sim_jukebox_t sim;                          /*!< Jukebox under test */
+    sim_scenario_result_t *p_result;            /*!< Outcome */
+    bool trace;                                 /*!< Print the steps and the USART output */
+    bool done;                                  /*!< The `end` step was reached */
+    uint32_t pending[SIM_SCENARIO_MAX_STEPS];   /*!< Expectations due, waiting for the end of the iteration */
+    uint32_t num_pending;                       /*!< Number of expectations due */
+    char tx[SIM_SCENARIO_TX_LENGTH + 1];        /*!< USART output */
+    size_t tx_length;                           /*!< Bytes in `tx` */
+    size_t tx_checked;                          /*!< Bytes of `tx` already matched by `expect tx` */
+    size_t tx_line;                             /*!< Start of the line being traced */
+    uint64_t start;                             /*!< Cycle at which the main loop started: time 0 of the steps */
+} sim_runner_t;
+
+static const sim_fsm_names_t fsm_names[] = {
+    {"button", {"BUTTON_RELEASED", "BUTTON_PRESSED_WAIT", "BUTTON_PRESSED", "BUTTON_RELEASED_WAIT"}},
+    {"usart", {"WAIT_DATA", "SEND_DATA"}},
+    {"buzzer", {"WAIT_START", "PLAY_NOTE", "PAUSE_NOTE", "WAIT_NOTE", "WAIT_MELODY"}},
+    {"jukebox", {"OFF", "START_UP", "WAIT_COMMAND", "SLEEP_WHILE_OFF", "SLEEP_WHILE_ON", "SHUT_OFF"}},
+};
+
+#define SIM_SCENARIO_NUM_FSMS (sizeof(fsm_names) / sizeof(fsm_names[0])) /*!< FSMs that can be checked */
+
+static sim_runner_t runner; /*!< Scenarios run one after the other, on the board of the calling thread */
+
+//------------------------------------------------------
+// PARSER
+//------------------------------------------------------
+
+/// @brief Skip blanks
+/// @param p Pointer to the text
+/// @return Pointer to the first non blank character
+static char *_skip_blanks(char *p)
+{
+    while (*p && isspace((unsigned char)*p))
+    {
+        p++;
+    }
+    return p;
+}
+
+/// @brief Split the next word of a line
+/// @param pp Pointer to the text pointer, moved after the word
+/// @return The word (empty at the end of the line)
+static char *_next_word(char **pp)
+{
+    char *p_word = _skip_blanks(*pp);
+    char *p = p_word;
+    while (*p && !isspace((unsigned char)*p))
+    {
+        p++;
+    }
+    if (*p)
+    {
+        *p++ = '\0';
+    }
+    *pp = p;
+    return p_word;
+}
+
+/// @brief Parse a time such as `1500`, `+200ms`, `2.5s`, `+3min` or `1h`
+/// @param p_word Text of the time
+/// @param previous Time of the previous step, for relative times
+/// @param p_cycles Pointer to the parsed time in clock cycles
+/// @return true on success
+static bool _parse_time(const char *p_word, uint64_t previous, uint64_t *p_cycles)
+{
+    bool relative = (*p_word == '+');
+    char *p_end;
+    double value = strtod(relative ? p_word + 1 : p_word, &p_end);
+    double ms;
+    if (p_end == p_word + relative || value < 0)
+    {
+        return false;
+    }
+    if (!*p_end || !strcmp(p_end, "ms"))
+    {
+        ms = value;
+    }
+    else if (!strcmp(p_end, "s"))
+    {
+        ms = value * 1000.0;
+    }
+    else if (!strcmp(p_end, "min"))
+    {
+        ms = value * 60000.0;
+    }
+    else if (!strcmp(p_end, "h"))
+    {
+        ms = value * 3600000.0;
+    }
+    else
+    {
+        return false;
+    }
+    *p_cycles = (relative ? previous : 0) + (uint64_t)llround(ms * PORT_SIM_MS_TO_CYCLES(1));
+    return true;
+}
+
+/// @brief Find an FSM by name
+/// @param p_name Name used in the scenarios
+/// @return Index in `fsm_names`, or SIM_SCENARIO_NUM_FSMS if unknown
+static uint32_t _find_fsm(const char *p_name)
+{
+    uint32_t i;
+    for (i = 0; i < SIM_SCENARIO_NUM_FSMS; i++)
+    {
+        if (!strcmp(fsm_names[i].p_name, p_name))
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+/// @brief Find a state of an FSM by name
+/// @param fsm Index in `fsm_names`
+/// @param p_name Name of the state
+/// @param length Length of the name
+/// @return Value of the state, or -1 if unknown
+static int _find_state(uint32_t fsm, const char *p_name, size_t length)
+{
+    for (int i = 0; i < SIM_SCENARIO_MAX_STATES; i++)
+    {
+        const char *p_state = fsm_names[fsm].p_states[i];
+        if (p_state && strlen(p_state) == length && !strncmp(p_state, p_name, length))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/// @brief Copy the rest of a line as the text argument of a step
+/// @param p_step Pointer to the step
+/// @param p_text Text
+/// @return false if it does not fit
+static bool _set_text(sim_step_t *p_step, char *p_text)
+{
+    p_text = _skip_blanks(p_text);
+    size_t length = strlen(p_text);
+    while (length > 0 && isspace((unsigned char)p_text[length - 1]))
+    {
+        p_text[--length] = '\0';
+    }
+    if (length >= SIM_SCENARIO_TEXT_LENGTH)
+    {
+        return false;
+    }
+    strcpy(p_step->text, p_text);
+    return true;
+}
+
+/// @brief Parse the arguments of an `expect` step
+/// @param p_step Pointer to the step
+/// @param p_args Arguments
+/// @return An error message, or NULL on success
+static const char *_parse_expect(sim_step_t *p_step, char *p_args)
+{
+    char *p_what = _next_word(&p_args);
+    if (!strcmp(p_what, "lcd"))
+    {
+        char *p_row = _next_word(&p_args);
+        if (strcmp(p_row, "0") && strcmp(p_row, "1"))
+        {
+            return "LCD row must be 0 or 1";
+        }
+        p_step->action = SIM_STEP_EXPECT_LCD;
+        p_step->value = (uint32_t)atoi(p_row);
+        return _set_text(p_step, p_args) && strlen(p_step->text) <= LCD_COLUMNS ? NULL : "LCD text too long";
+    }
+    if (!strcmp(p_what, "backlight"))
+    {
+        char *p_level = _next_word(&p_args);
+        if (strcmp(p_level, "on") && strcmp(p_level, "off"))
+        {
+            return "backlight must be on or off";
+        }
+        p_step->action = SIM_STEP_EXPECT_BACKLIGHT;
+        p_step->value = !strcmp(p_level, "on");
+        return NULL;
+    }
+    if (!strcmp(p_what, "tx"))
+    {
+        p_step->action = SIM_STEP_EXPECT_TX;
+        if (!_set_text(p_step, p_args) || !p_step->text[0])
+        {
+            return "expected USART text missing or too long";
+        }
+        return NULL;
+    }
+    if (!strcmp(p_what, "state"))
+    {
+        p_step->action = SIM_STEP_EXPECT_STATE;
+        p_step->value = _find_fsm(_next_word(&p_args));
+        if (p_step->value >= SIM_SCENARIO_NUM_FSMS)
+        {
+            return "unknown FSM";
+        }
+        if (!_set_text(p_step, p_args) || !p_step->text[0])
+        {
+            return "expected states missing or too long";
+        }
+        for (const char *p = p_step->text; *p;)
+        {
+            size_t length = strcspn(p, "|");
+            if (_find_state(p_step->value, p, length) < 0)
+            {
+                return "unknown state";
+            }
+            p += length + (p[length] == '|');
+        }
+        return NULL;
+    }
+    if (!strcmp(p_what, "note"))
+    {
+        char *p_end;
+        char *p_hz = _next_word(&p_args);
+        char *p_tolerance = _next_word(&p_args);
+        p_step->action = SIM_STEP_EXPECT_NOTE;
+        p_step->hz = strtod(p_hz, &p_end);
+        if (p_end == p_hz || *p_end || p_step->hz < 0)
+        {
+            return "invalid frequency";
+        }
+        p_step->tolerance = SIM_SCENARIO_NOTE_TOLERANCE;
+        if (*p_tolerance)
+        {
+            p_step->tolerance = strtod(p_tolerance, &p_end);
+            if (p_end == p_tolerance || *p_end || p_step->tolerance < 0)
+            {
+                return "invalid tolerance";
+            }
+        }
+        return NULL;
+    }
+    return "unknown expectation";
+}
+
+bool sim_scenario_load(sim_scenario_t *p_scenario, const char *p_path)
+{
+    FILE *p_file = fopen(p_path, "r");
+    if (!p_file)
+    {
+        fprintf(stderr, "%s: cannot open the scenario\n", p_path);
+        return false;
+    }
+    memset(p_scenario, 0, sizeof(sim_scenario_t));
+    p_scenario->p_name = p_path;
+
+    char line[SIM_SCENARIO_LINE_LENGTH];
+    uint32_t line_number = 0;
+    uint64_t previous = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), p_file))
+    {
+        line_number++;
+        char *p = _skip_blanks(line);
+        if (!*p || *p == '#')
+        {
+            continue;
+        }
+        const char *p_error = NULL;
+        sim_step_t *p_step = &p_scenario->steps[p_scenario->num_steps];
+        char *p_time = _next_word(&p);
+        char *p_action = _next_word(&p);
+        memset(p_step, 0, sizeof(sim_step_t));
+        p_step->line = line_number;
+
+        if (p_scenario->num_steps >= SIM_SCENARIO_MAX_STEPS)
+        {
+            p_error = "too many steps";
+        }
+        else if (!_parse_time(p_time, previous, &p_step->cycles))
+        {
+            p_error = "invalid time";
+        }
+        else if (p_step->cycles < previous)
+        {
+            p_error = "steps must be in chronological order";
+        }
+        else if (!strcmp(p_action, "press"))
+        {
+            uint64_t duration;
+            p_step->action = SIM_STEP_PRESS;
+            if (!_parse_time(_next_word(&p), 0, &duration) || duration == 0)
+            {
+                p_error = "invalid press duration";
+            }
+            p_step->value = (uint32_t)(duration / PORT_SIM_MS_TO_CYCLES(1));
+        }
+        else if (!strcmp(p_action, "cmd"))
+        {
+            p_step->action = SIM_STEP_CMD;
+            if (!_set_text(p_step, p) || !p_step->text[0])
+            {
+                p_error = "command missing or too long";
+            }
+        }
+        else if (!strcmp(p_action, "expect"))
+        {
+            p_error = _parse_expect(p_step, p);
+        }
+        else if (!strcmp(p_action, "end"))
+        {
+            p_step->action = SIM_STEP_END;
+        }
+        else
+        {
+            p_error = "unknown action";
+        }
+
+        if (p_error)
+        {
+            fprintf(stderr, "%s:%u: %s\n", p_path, (unsigned)line_number, p_error);
+            ok = false;
+        }
+        else
+        {
+            previous = p_step->cycles;
+            p_scenario->num_steps++;
+        }
+    }
+    fclose(p_file);
+
+    /* The scenario ends with its last step if it does not say otherwise */
+    if (ok && (!p_scenario->num_steps || p_scenario->steps[p_scenario->num_steps - 1].action != SIM_STEP_END))
+    {
+        if (p_scenario->num_steps >= SIM_SCENARIO_MAX_STEPS)
+        {
+            fprintf(stderr, "%s: too many steps\n", p_path);
+            return false;
+        }
+        p_scenario->steps[p_scenario->num_steps++] = (sim_step_t){.cycles = previous, .action = SIM_STEP_END};
+    }
+    return ok;
+}
+
+//------------------------------------------------------
+// RUNNER
+//------------------------------------------------------
+
+/// @brief Get the time of the scenario
+/// @return Milliseconds since the main loop started
+static double _get_ms(void)
+{
+    return (double)(port_sim_get_cycles() - runner.start) / PORT_SIM_MS_TO_CYCLES(1);
+}
+
+/// @brief Print the time of the scenario at the start of a trace line
+static void _print_time(void)
+{
+    printf("[%12.3f ms] ", _get_ms());
+}
+
+/// @brief Report the outcome of an expectation
+/// @param p_step Pointer to the step
+/// @param ok The expectation was met
+/// @param p_got What was found instead (printed on failure)
+static void _report(const sim_step_t *p_step, bool ok, const char *p_got)
+{
+    runner.p_result->checks++;
+    if (!ok)
+    {
+        runner.p_result->failures++;
+        printf("%s:%u: FAIL at %.3f ms: got \"%s\"\n", runner.p_scenario->p_name, (unsigned)p_step->line, _get_ms(),
+               p_got);
+    }
+    else if (runner.trace)
+    {
+        _print_time();
+        printf("line %u: ok\n", (unsigned)p_step->line);
+    }
+}
+
+/// @brief Evaluate an expectation
+/// @param p_step Pointer to the step
+static void _check(const sim_step_t *p_step)
+{
+    char got[SIM_SCENARIO_TEXT_LENGTH];
+    switch (p_step->action)
+    {
+    case SIM_STEP_EXPECT_LCD:
+    {
+        snprintf(got, sizeof(got), "%s", port_lcd_get_row((uint8_t)p_step->value));
+        size_t length = strlen(got);
+        while (length > 0 && got[length - 1] == ' ')
+        {
+            got[--length] = '\0';
+        }
+        _report(p_step, !strcmp(got, p_step->text), got);
+        break;
+    }
+    case SIM_STEP_EXPECT_BACKLIGHT:
+    {
+        bool on = port_lcd_get_backlight();
+        _report(p_step, on == (bool)p_step->value, on ? "on" : "off");
+        break;
+    }
+    case SIM_STEP_EXPECT_TX:
+    {
+        char *p_match = strstr(runner.tx + runner.tx_checked, p_step->text);
+        if (p_match)
+        {
+            runner.tx_checked = (size_t)(p_match - runner.tx) + strlen(p_step->text);
+        }
+        snprintf(got, sizeof(got), "%s", runner.tx + runner.tx_checked);
+        _report(p_step, p_match != NULL, got);
+        break;
+    }
+    case SIM_STEP_EXPECT_STATE:
+    {
+        fsm_t *p_fsms[SIM_SCENARIO_NUM_FSMS] = {runner.sim.p_fsm_button, runner.sim.p_fsm_usart,
+                                                runner.sim.p_fsm_buzzer, runner.sim.p_fsm_jukebox};
+        int state = fsm_get_state(p_fsms[p_step->value]);
+        bool ok = false;
+        for (const char *p = p_step->text; *p && !ok;)
+        {
+            size_t length = strcspn(p, "|");
+            ok = (_find_state(p_step->value, p, length) == state);
+            p += length + (p[length] == '|');
+        }
+        const char *p_name = (state >= 0 && state < SIM_SCENARIO_MAX_STATES) ? fsm_names[p_step->value].p_states[state] : NULL;
+        _report(p_step, ok, p_name ? p_name : "?");
+        break;
+    }
+    case SIM_STEP_EXPECT_NOTE:
+    {
+        double hz = port_sim_tim_get_output_hz(TIM3);
+        bool ok = (p_step->hz == 0) ? (hz == 0) : (fabs(hz - p_step->hz) <= p_step->hz * p_step->tolerance / 100.0);
+        snprintf(got, sizeof(got), "%.2f Hz", hz);
+        _report(p_step, ok, got);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+/// @brief Evaluate the expectations that became due during the last iteration
+static void _check_pending(void)
+{
+    for (uint32_t i = 0; i < runner.num_pending; i++)
+    {
+        _check(&runner.p_scenario->steps[runner.pending[i]]);
+    }
+    runner.num_pending = 0;
+}
+
+/// @brief Event: release the user button
+static void _on_release(void *p_arg, uint32_t data)
+{
+    port_sim_gpio_set_input(BUTTON_0_GPIO, BUTTON_0_PIN, HIGH);
+}
+
+/// @brief Event: execute a step and schedule the next one
+/// @param p_arg Unused
+/// @param data Index of the step
+static void _on_step(void *p_arg, uint32_t data)
+{
+    const sim_step_t *p_step = &runner.p_scenario->steps[data];
+    if (data + 1 < runner.p_scenario->num_steps)
+    {
+        port_sim_schedule(runner.start + runner.p_scenario->steps[data + 1].cycles, _on_step, NULL, data + 1);
+    }
+    switch (p_step->action)
+    {
+    case SIM_STEP_PRESS:
+        if (runner.trace)
+        {
+            _print_time();
+            printf("press %u ms\n", (unsigned)p_step->value);
+        }
+        port_sim_gpio_set_input(BUTTON_0_GPIO, BUTTON_0_PIN, LOW);
+        port_sim_schedule(port_sim_get_cycles() + PORT_SIM_MS_TO_CYCLES(p_step->value), _on_release, NULL, 0);
+        break;
+    case SIM_STEP_CMD:
+    {
+        char command[SIM_SCENARIO_TEXT_LENGTH + 1];
+        size_t length = (size_t)snprintf(command, sizeof(command), "%s\n", p_step->text);
+        if (runner.trace)
+        {
+            _print_time();
+            printf("rx: %s", command);
+        }
+        port_sim_usart_inject(USART_0, (const uint8_t *)command, length, port_sim_get_cycles());
+        break;
+    }
+    case SIM_STEP_END:
+        runner.done = true;
+        break;
+    default:
+        /* Nothing changes while the CPU sleeps: no need to wait for it to wake up */
+        if (port_sim_is_sleeping())
+        {
+            _check(p_step);
+        }
+        else
+        {
+            runner.pending[runner.num_pending++] = data;
+        }
+        break;
+    }
+}
+
+/// @brief Capture the bytes transmitted by the USART
+static void _on_tx(void *p_arg, USART_TypeDef *p_usart, uint8_t byte, uint64_t cycles)
+{
+    if (p_usart != USART_0)
+    {
+        return;
+    }
+    if (runner.tx_length == SIM_SCENARIO_TX_LENGTH)
+    {
+        /* Keep the newest half: `expect tx` only looks at recent output */
+        size_t drop = SIM_SCENARIO_TX_LENGTH / 2;
+        memmove(runner.tx, runner.tx + drop, runner.tx_length - drop);
+        runner.tx_length -= drop;
+        runner.tx_checked = runner.tx_checked > drop ? runner.tx_checked - drop : 0;
+        runner.tx_line = runner.tx_line > drop ? runner.tx_line - drop : 0;
+    }
+    runner.tx[runner.tx_length++] = (char)byte;
+    runner.tx[runner.tx_length] = '\0';
+    if (runner.trace && byte == '\n')
+    {
+        _print_time();
+        printf("tx: %s", runner.tx + runner.tx_line);
+        runner.tx_line = runner.tx_length;
+    }
+}
+
+void sim_scenario_run(const sim_scenario_t *p_scenario, bool trace, sim_scenario_result_t *p_result)
+{
+    memset(&runner, 0, sizeof(runner));
+    memset(p_result, 0, sizeof(sim_scenario_result_t));
+    runner.p_scenario = p_scenario;
+    runner.p_result = p_result;
+    runner.trace = trace;
+
+    port_sim_reset();
+    port_sim_usart_set_tx_hook(_on_tx, NULL);
+    sim_jukebox_init(&runner.sim);
+
+    /* Scenario times count from the start of the main loop, after the board initialization */
+    runner.start = port_sim_get_cycles();
+    uint64_t limit = runner.start + PORT_SIM_MS_TO_CYCLES(SIM_SCENARIO_MARGIN_MS);
+    if (p_scenario->num_steps)
+    {
+        port_sim_schedule(runner.start + p_scenario->steps[0].cycles, _on_step, NULL, 0);
+        limit += p_scenario->steps[p_scenario->num_steps - 1].cycles;
+    }
+
+    while (!runner.done && !runner.sim.halted && port_sim_get_cycles() < limit)
+    {
+        sim_jukebox_step(&runner.sim, limit);
+        _check_pending();
+    }
+    _check_pending();
+    if (!runner.done)
+    {
+        printf("%s: stopped at %.3f ms before the end of the scenario\n", p_scenario->p_name, _get_ms());
+        p_result->failures++;
+    }
+
+    p_result->cycles = port_sim_get_cycles();
+    p_result->sleep_cycles = port_sim_get_sleep_cycles();
+    p_result->skipped_cycles = runner.sim.skipped_cycles;
+    p_result->iterations = runner.sim.iterations;
+    p_result->isrs = port_sim_get_isr_count();
+    p_result->latency = ((fsm_jukebox_t *)runner.sim.p_fsm_jukebox)->latency;
+
+    sim_jukebox_destroy(&runner.sim);
+    port_sim_usart_set_tx_hook(NULL, NULL);
+}
@@ -21,7 +21,7 @@ int main(void)
         uint32_t duration = fsm_button_get_duration(p_fsm_button);
         if (duration > 0)
         {
-            printf("Button %d pressed for %ld ms", BUTTON_0_ID, duration);
+            printf("Button %d pressed for %lu ms", BUTTON_0_ID, (unsigned long)duration);
             // If the button is pressed for more than CHANGE_MODE_BUTTON_TIME, we toggle the LED
             if (duration >= CHANGE_MODE_BUTTON_TIME) {
                 printf(" (long press detected)");
@@ -70,7 +70,7 @@ int main(void)
             if ((duration >= TEST_BUTTON_PAUSE_TIME) && (duration < TEST_BUTTON_PLAY_TIME))
             {
                 fsm_buzzer_set_action(p_fsm_buzzer, PAUSE);
-                printf("Duration: %ld ms. User action: PAUSE\n", duration);
+                printf("Duration: %lu ms. User action: PAUSE\n", (unsigned long)duration);
             }
             else if (duration >= TEST_BUTTON_PLAY_TIME && duration < TEST_BUTTON_STOP_TIME)
             {
@@ -82,12 +82,12 @@ int main(void)
                 if (previous_action == PAUSE)
                 {
                     fsm_buzzer_set_action(p_fsm_buzzer, PLAY);
-                    printf("Duration: %ld ms. User action: PLAY resuming from PAUSE\n", duration);
+                    printf("Duration: %lu ms. User action: PLAY resuming from PAUSE\n", (unsigned long)duration);
                 }
                 else if (previous_action == STOP)
                 {
                     fsm_buzzer_set_action(p_fsm_buzzer, PLAY);
-                    printf("Duration: %ld ms. User action: PLAY next song\n", duration);
+                    printf("Duration: %lu ms. User action: PLAY next song\n", (unsigned long)duration);
 
                     if (counter % 2 == 0)
                     {
@@ -104,7 +104,7 @@ int main(void)
             else if (duration >= TEST_BUTTON_STOP_TIME)
             {
                 fsm_buzzer_set_action(p_fsm_buzzer, STOP);
-                printf("Duration: %ld ms. User action: STOP\n", duration);
+                printf("Duration: %lu ms. User action: STOP\n", (unsigned long)duration);
             }
             fsm_button_reset_duration(p_fsm_button);
         }
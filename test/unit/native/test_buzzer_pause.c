@@ -0,0 +1,173 @@
+/**
+ * @file test_buzzer_pause.c
+ * @brief Unit test of the pause in the middle of a note: the melody is paused and resumed many times, at moments out
+ * of step with its notes, and it must sound for as long as when it plays straight. It reports the time gained or lost
+ * by each pause.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stdio.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+#include "port_buzzer.h"
+
+/* Other libraries */
+#include "melodies.h"
+#include "fsm_buzzer.h"
+
+/* Test dependencies */
+#include <unity.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define TEST_PAUSES 64                                  /*!< Pauses along the melody */
+#define TEST_PAUSE_CYCLES (PORT_SIM_CORE_CLOCK_HZ / 20) /*!< Time each pause lasts: 50 ms */
+#define TEST_PLAY_CYCLES 500000U                        /*!< Longest time between pauses: about 31 ms */
+#define TEST_MAX_ERROR_US 20                            /*!< Largest error of the sounding time per pause */
+
+/* Global variables */
+static fsm_t *p_fsm;                                    /*!< Buzzer under test */
+static const melody_t *p_melody = &megalovania_melody;   /*!< Melody under test: 19 notes of 250 ms */
+
+/**
+ * @brief Set the Up object. It is called before a test function is called.
+ *
+ */
+void setUp(void)
+{
+    port_sim_reset();
+    port_system_init();
+    p_fsm = fsm_buzzer_new(BUZZER_0_ID);
+    fsm_buzzer_set_melody(p_fsm, p_melody);
+}
+
+/**
+ * @brief Tear down the test. It is called after a test function is called.
+ *
+ */
+void tearDown(void)
+{
+    fsm_destroy(p_fsm);
+}
+
+/**
+ * @brief Play the melody to the end, as the jukebox does: fire the FSM and sleep until the next interrupt.
+ *
+ * @param pauses Pauses along the melody, each one `TEST_PAUSE_CYCLES` long
+ * @return Time the melody sounded, paused time excluded, in cycles
+ */
+static uint64_t _play(uint32_t pauses)
+{
+    uint32_t seed = 12345;
+    uint64_t start = port_sim_get_cycles();
+    uint64_t paused = 0;
+    uint64_t next_pause = start + TEST_PLAY_CYCLES / 2;
+    fsm_buzzer_set_action(p_fsm, PLAY);
+    while (fsm_buzzer_check_activity(p_fsm))
+    {
+        int state = fsm_get_state(p_fsm);
+        fsm_fire(p_fsm);
+        if (fsm_get_state(p_fsm) != state)
+        {
+            continue;
+        }
+        if ((pauses == 0) || (port_sim_get_cycles() < next_pause))
+        {
+            port_sim_wait_for_interrupt((pauses == 0) ? PORT_SIM_NEVER : next_pause);
+            continue;
+        }
+
+        // The note stops at once and, after the pause, the same note goes on at the same pitch
+        uint32_t note_index = fsm_buzzer_get_note_index(p_fsm);
+        double frequency = port_buzzer_get_note_frequency(BUZZER_0_ID);
+        bool in_note = (state == WAIT_NOTE);
+        uint32_t remaining_us = port_buzzer_get_note_remaining_us(BUZZER_0_ID);
+        fsm_buzzer_set_action(p_fsm, PAUSE);
+        fsm_fire(p_fsm);
+        TEST_ASSERT_EQUAL_INT(PAUSE_NOTE, fsm_get_state(p_fsm));
+        TEST_ASSERT_DOUBLE_WITHIN(0.0, 0.0, port_buzzer_get_note_frequency(BUZZER_0_ID));
+        uint64_t pause_start = port_sim_get_cycles();
+        port_sim_advance_to(pause_start + TEST_PAUSE_CYCLES);
+        if (in_note)
+        {
+            TEST_ASSERT_INT_WITHIN(TEST_MAX_ERROR_US, remaining_us, port_buzzer_get_note_remaining_us(BUZZER_0_ID));
+        }
+        fsm_buzzer_set_action(p_fsm, PLAY);
+        fsm_fire(p_fsm);
+        paused += port_sim_get_cycles() - pause_start;
+        if (in_note)
+        {
+            TEST_ASSERT_EQUAL_INT(WAIT_NOTE, fsm_get_state(p_fsm));
+            TEST_ASSERT_EQUAL_UINT32(note_index, fsm_buzzer_get_note_index(p_fsm));
+            TEST_ASSERT_DOUBLE_WITHIN(0.0, frequency, port_buzzer_get_note_frequency(BUZZER_0_ID));
+        }
+
+        // Next pause at a moment out of step with the notes
+        seed = seed * 1103515245U + 12345U;
+        next_pause = port_sim_get_cycles() + TEST_PLAY_CYCLES / 4 + (seed >> 8) % TEST_PLAY_CYCLES;
+        pauses--;
+    }
+    return port_sim_get_cycles() - start - paused;
+}
+
+/**
+ * @brief Test that many pauses in the middle of the notes keep the duration of the melody.
+ *
+ */
+void test_buzzer_pause_duration(void)
+{
+    uint64_t straight = _play(0);
+    uint64_t written = 0;
+    for (uint32_t i = 0; i < p_melody->melody_length; i++)
+    {
+        written += (uint64_t)p_melody->p_durations[i] * (PORT_SIM_CORE_CLOCK_HZ / 1000);
+    }
+    UNITY_TEST_ASSERT(straight >= written, __LINE__, "The melody should last at least as it is written");
+
+    uint64_t with_pauses = _play(TEST_PAUSES);
+    double error_us = ((double)with_pauses - (double)straight) * 1e6 / PORT_SIM_CORE_CLOCK_HZ;
+    printf("%s: %.3f s straight, %.3f s sounding with %u pauses, %+.2f us per pause\n", p_melody->p_name,
+           (double)straight / PORT_SIM_CORE_CLOCK_HZ, (double)with_pauses / PORT_SIM_CORE_CLOCK_HZ, TEST_PAUSES,
+           error_us / TEST_PAUSES);
+    TEST_ASSERT_DOUBLE_WITHIN(TEST_MAX_ERROR_US * TEST_PAUSES, 0.0, error_us);
+}
+
+/**
+ * @brief Test that a stop while paused drops the time left: the melody starts again from its first note.
+ *
+ */
+void test_buzzer_pause_stop(void)
+{
+    fsm_buzzer_set_action(p_fsm, PLAY);
+    fsm_fire(p_fsm);
+    TEST_ASSERT_EQUAL_INT(WAIT_NOTE, fsm_get_state(p_fsm));
+    port_sim_run_cpu(PORT_SIM_CORE_CLOCK_HZ / 10);
+    fsm_buzzer_set_action(p_fsm, PAUSE);
+    fsm_fire(p_fsm);
+    TEST_ASSERT_EQUAL_INT(PAUSE_NOTE, fsm_get_state(p_fsm));
+    TEST_ASSERT_INT_WITHIN(TEST_MAX_ERROR_US, 150000, port_buzzer_get_note_remaining_us(BUZZER_0_ID));
+
+    fsm_buzzer_set_action(p_fsm, STOP);
+    fsm_buzzer_set_action(p_fsm, PLAY);
+    fsm_fire(p_fsm);
+    TEST_ASSERT_EQUAL_INT(PLAY_NOTE, fsm_get_state(p_fsm));
+    fsm_fire(p_fsm);
+    TEST_ASSERT_EQUAL_INT(WAIT_NOTE, fsm_get_state(p_fsm));
+    TEST_ASSERT_EQUAL_UINT32(1, fsm_buzzer_get_note_index(p_fsm));
+    TEST_ASSERT_INT_WITHIN(TEST_MAX_ERROR_US, p_melody->p_durations[0] * 1000, port_buzzer_get_note_remaining_us(BUZZER_0_ID));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_buzzer_pause_duration);
+    RUN_TEST(test_buzzer_pause_stop);
+
+    return UNITY_END();
+}
@@ -0,0 +1,268 @@
+/**
+ * @file test_envelope.c
+ * @brief Unit test of the volume envelope: the levels of the table are evenly spaced in dB, every note of a melody
+ * starts and ends in silence, and TIM5 only ticks while a note needs it. It reports the ticks of the melody and the
+ * largest step of the duty cycle.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stdio.h>
+#include <math.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+#include "port_buzzer.h"
+
+/* Other libraries */
+#include "melodies.h"
+#include "fsm_buzzer.h"
+#include "envelope.h"
+
+/* Test dependencies */
+#include <unity.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define TEST_MAX_LEVEL_ERROR_DB 0.1     /*!< Largest error of a level of the table, from the rounding of its duty cycle */
+#define TEST_VOLUME_STEPS 10            /*!< Steps of the volume from 0.1 to 1 */
+#define TEST_EARLY_TICKS 3              /*!< Ticks a note may go silent early: its release is planned from its volume */
+#define TEST_PI 3.14159265358979323846  /*!< Pi, not in the C standard library */
+#define TEST_TICK_CYCLES (PORT_SIM_CORE_CLOCK_HZ / ENVELOPE_RATE_HZ)   /*!< Cycles between two ticks */
+
+/* Global variables */
+static fsm_t *p_fsm;                                    /*!< Buzzer under test */
+static const melody_t *p_melody = &megalovania_melody;   /*!< Melody under test: 19 notes of 250 ms */
+
+/**
+ * @brief Set the Up object. It is called before a test function is called.
+ *
+ */
+void setUp(void)
+{
+    port_sim_reset();
+    port_system_init();
+    p_fsm = fsm_buzzer_new(BUZZER_0_ID);
+    fsm_buzzer_set_melody(p_fsm, p_melody);
+    fsm_buzzer_set_volume(p_fsm, 1.0);
+}
+
+/**
+ * @brief Tear down the test. It is called after a test function is called.
+ *
+ */
+void tearDown(void)
+{
+    fsm_destroy(p_fsm);
+}
+
+/**
+ * @brief Loudness of a duty cycle: the amplitude of the fundamental of the square wave, relative to 50 %.
+ *
+ * @param duty Duty cycle, with `ENVELOPE_DUTY_BITS` fraction bits
+ * @return Loudness in dB
+ */
+static double _duty_db(uint32_t duty)
+{
+    return 20.0 * log10(sin(TEST_PI * duty / (1U << ENVELOPE_DUTY_BITS)));
+}
+
+/**
+ * @brief Test that the levels of the table and the steps of the volume are evenly spaced in dB.
+ *
+ */
+void test_envelope_levels(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(0, envelope_duty_table[0]);
+    TEST_ASSERT_EQUAL_UINT32(1U << (ENVELOPE_DUTY_BITS - 1), envelope_duty_table[ENVELOPE_LEVELS]);
+    for (uint32_t i = 1; i <= ENVELOPE_LEVELS; i++)
+    {
+        double expected = -(double)(ENVELOPE_LEVELS - i) * ENVELOPE_DB_PER_LEVEL;
+        TEST_ASSERT_DOUBLE_WITHIN(TEST_MAX_LEVEL_ERROR_DB, expected, _duty_db(envelope_duty_table[i]));
+    }
+
+    // The former volume, the duty cycle itself, was loudest at 0.5 and went down again up to 0.95
+    TEST_ASSERT_EQUAL_UINT32(0, envelope_get_level(0.0));
+    TEST_ASSERT_EQUAL_UINT32(0, envelope_get_level(-1.0));
+    TEST_ASSERT_EQUAL_UINT32(ENVELOPE_LEVELS, envelope_get_level(1.0));
+    TEST_ASSERT_EQUAL_UINT32(ENVELOPE_LEVELS, envelope_get_level(3.0));
+    double step_db = ENVELOPE_LEVELS * ENVELOPE_DB_PER_LEVEL / TEST_VOLUME_STEPS;
+    for (uint32_t i = 1; i < TEST_VOLUME_STEPS; i++)
+    {
+        double db = _duty_db(envelope_duty_table[envelope_get_level((double)i / TEST_VOLUME_STEPS)]);
+        double next_db = _duty_db(envelope_duty_table[envelope_get_level((double)(i + 1) / TEST_VOLUME_STEPS)]);
+        TEST_ASSERT_DOUBLE_WITHIN(ENVELOPE_DB_PER_LEVEL, step_db, next_db - db);
+    }
+}
+
+/**
+ * @brief Test the stages of an envelope tick by tick: attack, decay to the sustain, and a release that reaches silence
+ * a tick before the end of the note.
+ *
+ */
+void test_envelope_stages(void)
+{
+    envelope_t envelope;
+    envelope_config_t config = {.attack_ms = 10, .decay_ms = 96, .release_ms = 48, .sustain_db = 6};
+    envelope_init(&envelope, &config);
+    TEST_ASSERT_FALSE(envelope_is_active(&envelope));
+
+    uint32_t duration_ms = 100;
+    TEST_ASSERT_EQUAL_UINT32(0, envelope_note_on(&envelope, ENVELOPE_LEVELS));
+    envelope_set_gate(&envelope, duration_ms);
+    uint32_t duty = 0;
+    uint32_t tick = 0;
+    while (envelope_is_active(&envelope))
+    {
+        uint32_t previous = duty;
+        uint8_t stage = envelope.stage;
+        duty = envelope_tick(&envelope);
+        tick++;
+        // Ticks within a stage
+        switch ((envelope.stage == stage) ? stage : ENVELOPE_IDLE)
+        {
+        case ENVELOPE_ATTACK:
+            UNITY_TEST_ASSERT(duty > previous, __LINE__, "The attack should rise");
+            break;
+        case ENVELOPE_DECAY:
+            UNITY_TEST_ASSERT(duty <= previous, __LINE__, "The decay should fall");
+            break;
+        case ENVELOPE_SUSTAIN:
+            TEST_ASSERT_EQUAL_UINT32(envelope_duty_table[ENVELOPE_LEVELS - 12], duty);
+            break;
+        default:
+            break;
+        }
+        if (tick == 10)
+        {
+            // 10 ms of attack over the whole range
+            TEST_ASSERT_EQUAL_UINT32(envelope_duty_table[ENVELOPE_LEVELS], duty);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, duty);
+    UNITY_TEST_ASSERT(tick <= duration_ms - 1, __LINE__, "The release should end a tick before the note");
+
+    // Without a duration the note holds until its release
+    config.release_ms = 0;
+    envelope_set_config(&envelope, &config);
+    envelope_note_on(&envelope, ENVELOPE_LEVELS / 2);
+    envelope_set_gate(&envelope, 1);
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        duty = envelope_tick(&envelope);
+    }
+    TEST_ASSERT_EQUAL_INT(ENVELOPE_SUSTAIN, envelope.stage);
+    TEST_ASSERT_EQUAL_UINT32(envelope_duty_table[ENVELOPE_LEVELS / 2 - 12], duty);
+    envelope_note_off(&envelope);
+    TEST_ASSERT_FALSE(envelope_is_active(&envelope));
+
+    // A silent note needs no ticks
+    TEST_ASSERT_EQUAL_UINT32(0, envelope_note_on(&envelope, 0));
+    TEST_ASSERT_FALSE(envelope_is_active(&envelope));
+}
+
+/**
+ * @brief Test a melody as the jukebox plays it: every note starts and ends with the PWM in silence, so stopping and
+ * starting the PWM between notes makes no click, and TIM5 ticks only during the notes.
+ *
+ */
+void test_envelope_melody(void)
+{
+    uint32_t notes = 0;
+    uint32_t sounding_ms = 0;
+    double largest_step_db = 0;
+    uint32_t ccr1 = 0;
+    fsm_buzzer_set_action(p_fsm, PLAY);
+    while (fsm_buzzer_check_activity(p_fsm))
+    {
+        int state = fsm_get_state(p_fsm);
+        uint32_t index = fsm_buzzer_get_note_index(p_fsm);
+        uint32_t last_ccr1 = TIM3->CCR1;
+        fsm_fire(p_fsm);
+        if ((state == WAIT_NOTE) && (fsm_get_state(p_fsm) == PLAY_NOTE))
+        {
+            // The release reached silence before the PWM stopped
+            TEST_ASSERT_EQUAL_UINT32(0, last_ccr1);
+            TEST_ASSERT_FALSE(TIM5->CR1 & TIM_CR1_CEN);
+        }
+        if (fsm_buzzer_get_note_index(p_fsm) != index)
+        {
+            // The attack starts from silence
+            TEST_ASSERT_EQUAL_UINT32(0, TIM3->CCR1);
+            if (p_melody->p_notes[index] > 0)
+            {
+                notes++;
+                sounding_ms += p_melody->p_durations[index];
+            }
+        }
+        if (fsm_get_state(p_fsm) != state)
+        {
+            continue;
+        }
+        port_sim_wait_for_interrupt(PORT_SIM_NEVER);
+
+        // Largest change of the duty cycle from one tick to the next
+        if ((TIM3->CR1 & TIM_CR1_CEN) && (TIM3->CCR1 > 0) && (ccr1 > 0))
+        {
+            double step_db = fabs(_duty_db(((uint64_t)TIM3->CCR1 << ENVELOPE_DUTY_BITS) / (TIM3->ARR + 1)) -
+                                  _duty_db(((uint64_t)ccr1 << ENVELOPE_DUTY_BITS) / (TIM3->ARR + 1)));
+            largest_step_db = fmax(largest_step_db, step_db);
+        }
+        ccr1 = TIM3->CCR1;
+    }
+
+    // A tick per millisecond of the notes at most
+    uint32_t ticks = port_sim_get_irq_count(TIM5_IRQn);
+    printf("%s: %u notes, %u ms sounding, %u ticks of the envelope, largest step %.2f dB\n", p_melody->p_name,
+           (unsigned)notes, (unsigned)sounding_ms, (unsigned)ticks, largest_step_db);
+    TEST_ASSERT_TRUE(notes > 0);
+    UNITY_TEST_ASSERT(ticks <= sounding_ms, __LINE__, "TIM5 should only tick during the notes");
+    UNITY_TEST_ASSERT(ticks >= sounding_ms - notes * TEST_EARLY_TICKS, __LINE__, "The envelope should tick along every note");
+}
+
+/**
+ * @brief Test that a paused note keeps its envelope: TIM5 stops with the note and goes on when it resumes. A stop
+ * silences it.
+ *
+ */
+void test_envelope_pause(void)
+{
+    fsm_buzzer_set_action(p_fsm, PLAY);
+    fsm_fire(p_fsm);
+    TEST_ASSERT_EQUAL_INT(WAIT_NOTE, fsm_get_state(p_fsm));
+    port_sim_run_cpu(TEST_TICK_CYCLES * 50);
+    fsm_buzzer_set_action(p_fsm, PAUSE);
+    fsm_fire(p_fsm);
+    uint32_t ticks = port_sim_get_irq_count(TIM5_IRQn);
+    uint32_t ccr1 = TIM3->CCR1;
+    UNITY_TEST_ASSERT(ccr1 > 0, __LINE__, "The note should sound when paused");
+    port_sim_run_cpu(TEST_TICK_CYCLES * 100);
+    TEST_ASSERT_EQUAL_UINT32(ticks, port_sim_get_irq_count(TIM5_IRQn));
+
+    fsm_buzzer_set_action(p_fsm, PLAY);
+    fsm_fire(p_fsm);
+    TEST_ASSERT_EQUAL_INT(WAIT_NOTE, fsm_get_state(p_fsm));
+    TEST_ASSERT_TRUE(TIM5->CR1 & TIM_CR1_CEN);
+    port_sim_run_cpu(TEST_TICK_CYCLES * 10);
+    TEST_ASSERT_INT_WITHIN(1, ticks + 10, port_sim_get_irq_count(TIM5_IRQn));
+
+    // A stop silences the envelope at once
+    port_buzzer_stop(BUZZER_0_ID);
+    TEST_ASSERT_FALSE(TIM5->CR1 & TIM_CR1_CEN);
+    TEST_ASSERT_FALSE(envelope_is_active(&buzzers_arr[BUZZER_0_ID].envelope));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_envelope_levels);
+    RUN_TEST(test_envelope_stages);
+    RUN_TEST(test_envelope_melody);
+    RUN_TEST(test_envelope_pause);
+
+    return UNITY_END();
+}
@@ -0,0 +1,345 @@
+/**
+ * @file test_game.c
+ * @brief Unit test of the guess-the-song game: the bit-parallel edit distance against the textbook one, the closest
+ * name with the skipped and dropped names against all of them, the score and the streaks, the time limit and the
+ * excerpt. It reports the cost of a guess against hundreds of names in host time.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* clock_gettime is POSIX */
+#define _POSIX_C_SOURCE 200809L
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* Other libraries */
+#include "game.h"
+#include "melodies.h"
+
+/* Test dependencies */
+#include <unity.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define TEST_MAX_NAME_LENGTH 40U    /*!< Longest name of the random tests */
+#define TEST_PAIRS 20000U           /*!< Random pairs of the distance test */
+#define TEST_NUM_NAMES 256U         /*!< Names of the cost test, far more than the jukebox holds */
+#define TEST_GUESSES 2000U          /*!< Guesses of the cost test */
+
+/* Global variables */
+static game_t game;                 /*!< Game under test */
+static uint32_t random_state;       /*!< State of the generator of the random names */
+
+/**
+ * @brief Set the Up object. It is called before a test function is called.
+ *
+ */
+void setUp(void)
+{
+    game_init(&game);
+    random_state = 12345U;
+}
+
+/**
+ * @brief Tear down the test. It is called after a test function is called.
+ *
+ */
+void tearDown(void)
+{
+}
+
+/**
+ * @brief Host time.
+ *
+ * @return Nanoseconds of the monotonic clock
+ */
+static double _now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * @brief Draw a random number below a bound, from a xorshift32 generator.
+ *
+ * @param bound Number of values
+ * @return Random number
+ */
+static uint32_t _random(uint32_t bound)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state % bound;
+}
+
+/**
+ * @brief Fill a random name. A small alphabet, with upper case, makes close names likely.
+ *
+ * @param p_name Buffer of `TEST_MAX_NAME_LENGTH + 1` characters
+ * @param max_length Longest name
+ */
+static void _random_name(char *p_name, uint32_t max_length)
+{
+    static const char alphabet[] = "abcAB_1";
+    uint32_t length = _random(max_length + 1);
+    for (uint32_t i = 0; i < length; i++)
+    {
+        p_name[i] = alphabet[_random(sizeof(alphabet) - 1)];
+    }
+    p_name[length] = '\0';
+}
+
+/**
+ * @brief Edit distance by the whole matrix, ignoring case.
+ *
+ * @param p_a First name
+ * @param p_b Second name
+ * @return Edit distance
+ */
+static uint32_t _reference_distance(const char *p_a, const char *p_b)
+{
+    uint32_t row[TEST_MAX_NAME_LENGTH + 1];
+    uint32_t length_a = strlen(p_a);
+    uint32_t length_b = strlen(p_b);
+    for (uint32_t j = 0; j <= length_b; j++)
+    {
+        row[j] = j;
+    }
+    for (uint32_t i = 1; i <= length_a; i++)
+    {
+        uint32_t diagonal = row[0];
+        row[0] = i;
+        for (uint32_t j = 1; j <= length_b; j++)
+        {
+            uint32_t above = row[j];
+            uint32_t cost = (tolower((unsigned char)p_a[i - 1]) == tolower((unsigned char)p_b[j - 1])) ? 0 : 1;
+            uint32_t best = diagonal + cost;
+            best = (above + 1 < best) ? above + 1 : best;
+            best = (row[j - 1] + 1 < best) ? row[j - 1] + 1 : best;
+            row[j] = best;
+            diagonal = above;
+        }
+    }
+    return row[length_b];
+}
+
+/**
+ * @brief Test the edit distance on known pairs and against the whole matrix on random pairs, up to a guess of
+ * `GAME_MAX_GUESS_LENGTH` characters.
+ *
+ */
+void test_game_distance(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(3, game_distance("kitten", "sitting"));
+    TEST_ASSERT_EQUAL_UINT32(0, game_distance("TeTris", "tetris"));
+    TEST_ASSERT_EQUAL_UINT32(1, game_distance("megalovnia", "megalovania"));
+    TEST_ASSERT_EQUAL_UINT32(6, game_distance("", "iscale"));
+    TEST_ASSERT_EQUAL_UINT32(5, game_distance("scale", ""));
+    TEST_ASSERT_EQUAL_UINT32(1, game_distance("-", "-"));   // Not a character of the names
+
+    char guess[TEST_MAX_NAME_LENGTH + 1];
+    char name[TEST_MAX_NAME_LENGTH + 1];
+    for (uint32_t pair = 0; pair < TEST_PAIRS; pair++)
+    {
+        _random_name(guess, GAME_MAX_GUESS_LENGTH);
+        _random_name(name, TEST_MAX_NAME_LENGTH);
+        TEST_ASSERT_EQUAL_UINT32(_reference_distance(guess, name), game_distance(guess, name));
+    }
+}
+
+/**
+ * @brief Test the closest name: the names skipped by their length and the ones dropped early give the same name and
+ * distance as comparing all of them, the first one on a tie.
+ *
+ */
+void test_game_match(void)
+{
+    const char *names[] = {"scale", "happy_birthday", "tetris", "megalovania", "sailor", "espana", "mario", "iscale"};
+    uint32_t num_names = sizeof(names) / sizeof(names[0]);
+    uint32_t distance;
+    TEST_ASSERT_EQUAL_UINT32(3, game_match("megalovnia", names, num_names, &distance));
+    TEST_ASSERT_EQUAL_UINT32(1, distance);
+    TEST_ASSERT_EQUAL_UINT32(7, game_match("ISCALE", names, num_names, &distance));
+    TEST_ASSERT_EQUAL_UINT32(0, distance);
+    TEST_ASSERT_EQUAL_UINT32(0, game_match("scal", names, num_names, &distance));
+    TEST_ASSERT_EQUAL_UINT32(1, distance);
+    TEST_ASSERT_EQUAL_UINT32(GAME_NO_MATCH, game_match("scale", names, 0, &distance));
+
+    static char random_names[TEST_NUM_NAMES][TEST_MAX_NAME_LENGTH + 1];
+    const char *p_names[TEST_NUM_NAMES];
+    for (uint32_t idx = 0; idx < TEST_NUM_NAMES; idx++)
+    {
+        _random_name(random_names[idx], TEST_MAX_NAME_LENGTH);
+        p_names[idx] = random_names[idx];
+    }
+    char guess[TEST_MAX_NAME_LENGTH + 1];
+    for (uint32_t i = 0; i < TEST_GUESSES; i++)
+    {
+        _random_name(guess, GAME_MAX_GUESS_LENGTH);
+        uint32_t best = 0;
+        for (uint32_t idx = 1; idx < TEST_NUM_NAMES; idx++)
+        {
+            best = (_reference_distance(guess, p_names[idx]) < _reference_distance(guess, p_names[best])) ? idx : best;
+        }
+        TEST_ASSERT_EQUAL_UINT32(best, game_match(guess, p_names, TEST_NUM_NAMES, &distance));
+        TEST_ASSERT_EQUAL_UINT32(_reference_distance(guess, p_names[best]), distance);
+    }
+}
+
+/**
+ * @brief Test the score: the points lost per edit and per wrong guess, the least points, the bonus of the streak and
+ * the end of the streak.
+ *
+ */
+void test_game_score(void)
+{
+    uint32_t points;
+    game_start(&game, &tetris_melody, 2, 0, 0, 0);
+    TEST_ASSERT_TRUE(game_is_on(&game));
+    TEST_ASSERT_FALSE(game_is_timed(&game));
+    TEST_ASSERT_EQUAL_INT(GAME_WRONG, game_guess(&game, 3, 0, 6, 10, &points));   // Another melody
+    TEST_ASSERT_EQUAL_INT(GAME_WRONG, game_guess(&game, 2, 2, 6, 20, &points));   // Too far: one edit per 4 characters
+    TEST_ASSERT_EQUAL_UINT32(0, points);
+    TEST_ASSERT_EQUAL_INT(GAME_RIGHT, game_guess(&game, 2, 1, 6, 30, &points));
+    TEST_ASSERT_EQUAL_UINT32(GAME_POINTS - GAME_DISTANCE_PENALTY - 2 * GAME_WRONG_PENALTY, points);
+    TEST_ASSERT_FALSE(game_is_on(&game));
+    TEST_ASSERT_EQUAL_UINT32(1, game.streak);
+
+    // The second round in a row earns the bonus
+    game_start(&game, &tetris_melody, 2, 0, 0, 0);
+    TEST_ASSERT_EQUAL_INT(GAME_RIGHT, game_guess(&game, 2, 0, 6, 10, &points));
+    TEST_ASSERT_EQUAL_UINT32(GAME_POINTS + GAME_STREAK_BONUS, points);
+
+    // Never below the least points
+    game_start(&game, &tetris_melody, 2, 0, 0, 0);
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        game_guess(&game, 0, 0, 6, 10, &points);
+    }
+    TEST_ASSERT_EQUAL_INT(GAME_RIGHT, game_guess(&game, 2, 0, 6, 10, &points));
+    TEST_ASSERT_EQUAL_UINT32(GAME_MIN_POINTS + 2 * GAME_STREAK_BONUS, points);
+    TEST_ASSERT_EQUAL_UINT32(3, game.best_streak);
+
+    // Giving up ends the streak, and so does a new round over one in course
+    game_start(&game, &tetris_melody, 2, 0, 0, 0);
+    game_give_up(&game);
+    TEST_ASSERT_FALSE(game_is_on(&game));
+    TEST_ASSERT_EQUAL_UINT32(0, game.streak);
+    TEST_ASSERT_EQUAL_UINT32(3, game.best_streak);
+    game_start(&game, &tetris_melody, 2, 0, 0, 0);
+    game_start(&game, &mario_melody, 6, 0, 0, 0);
+    TEST_ASSERT_EQUAL_UINT32(6, game_get_answer(&game));
+    TEST_ASSERT_EQUAL_UINT32(5, game.rounds);
+    TEST_ASSERT_EQUAL_UINT32(3, game.wins);
+    TEST_ASSERT_EQUAL_UINT32(2 * GAME_POINTS + GAME_MIN_POINTS - GAME_DISTANCE_PENALTY - 2 * GAME_WRONG_PENALTY +
+                                 3 * GAME_STREAK_BONUS,
+                             game.score);
+}
+
+/**
+ * @brief Test the time limit, also across the wrap of the milliseconds.
+ *
+ */
+void test_game_time_up(void)
+{
+    uint32_t points;
+    uint32_t start_ms = 0xFFFFFF00U;
+    game_start(&game, &tetris_melody, 2, 0, 1000, start_ms);
+    TEST_ASSERT_TRUE(game_is_timed(&game));
+    TEST_ASSERT_FALSE(game_check_time_up(&game, start_ms + 999));
+    TEST_ASSERT_EQUAL_INT(GAME_WRONG, game_guess(&game, 0, 0, 6, start_ms + 999, &points));
+    TEST_ASSERT_EQUAL_INT(GAME_TIME_UP, game_guess(&game, 2, 0, 6, start_ms + 1000, &points));
+    TEST_ASSERT_EQUAL_UINT32(0, points);
+    TEST_ASSERT_FALSE(game_is_on(&game));
+    TEST_ASSERT_FALSE(game_check_time_up(&game, start_ms + 2000)); // Only once
+
+    game_start(&game, &tetris_melody, 2, 0, 1000, 0);
+    TEST_ASSERT_TRUE(game_check_time_up(&game, 5000));
+    TEST_ASSERT_FALSE(game_is_timed(&game));
+    TEST_ASSERT_EQUAL_UINT32(0, game.score);
+}
+
+/**
+ * @brief Test the excerpt: it points into the melody, with its effects and its voices, and it is moved back so that
+ * it ends with the melody.
+ *
+ */
+void test_game_excerpt(void)
+{
+    const melody_t *p_melody = &happy_birthday_melody;
+    const melody_t *p_excerpt = game_start(&game, p_melody, 1, 3, 0, 0);
+    TEST_ASSERT_EQUAL_UINT32(GAME_EXCERPT_NOTES, p_excerpt->melody_length);
+    TEST_ASSERT_TRUE(p_excerpt->p_notes == p_melody->p_notes + 3);
+    TEST_ASSERT_TRUE(p_excerpt->p_durations == p_melody->p_durations + 3);
+    TEST_ASSERT_EQUAL_UINT32(p_melody->num_tracks, p_excerpt->num_tracks);
+    for (uint32_t track = 0; track < p_excerpt->num_tracks; track++)
+    {
+        TEST_ASSERT_TRUE(p_excerpt->p_tracks[track] == p_melody->p_tracks[track] + 3);
+    }
+    TEST_ASSERT_TRUE(p_excerpt->p_name == p_melody->p_name);
+
+    p_excerpt = game_start(&game, p_melody, 1, p_melody->melody_length - 1, 0, 0);
+    TEST_ASSERT_TRUE(p_excerpt->p_notes == p_melody->p_notes + p_melody->melody_length - GAME_EXCERPT_NOTES);
+
+    // A melody shorter than the excerpt plays whole
+    melody_t short_melody = tetris_melody;
+    short_melody.melody_length = GAME_EXCERPT_NOTES / 2;
+    p_excerpt = game_start(&game, &short_melody, 2, 5, 0, 0);
+    TEST_ASSERT_EQUAL_UINT32(GAME_EXCERPT_NOTES / 2, p_excerpt->melody_length);
+    TEST_ASSERT_TRUE(p_excerpt->p_notes == short_melody.p_notes);
+    TEST_ASSERT_NULL(p_excerpt->p_tracks);
+}
+
+/**
+ * @brief Report the cost of a guess against `TEST_NUM_NAMES` names of up to `TEST_MAX_NAME_LENGTH` characters. It is
+ * host time, which depends on the machine and its load: it is printed, not checked. The cycles of a guess are
+ * measured by `bench_jukebox`.
+ *
+ */
+void test_game_cost(void)
+{
+    static char random_names[TEST_NUM_NAMES][TEST_MAX_NAME_LENGTH + 1];
+    const char *p_names[TEST_NUM_NAMES];
+    for (uint32_t idx = 0; idx < TEST_NUM_NAMES; idx++)
+    {
+        _random_name(random_names[idx], TEST_MAX_NAME_LENGTH);
+        p_names[idx] = random_names[idx];
+    }
+    static char guesses[TEST_GUESSES][TEST_MAX_NAME_LENGTH + 1];
+    for (uint32_t i = 0; i < TEST_GUESSES; i++)
+    {
+        _random_name(guesses[i], GAME_MAX_GUESS_LENGTH);
+    }
+
+    uint32_t distance;
+    double start = _now_ns();
+    for (uint32_t i = 0; i < TEST_GUESSES; i++)
+    {
+        game_match(guesses[i], p_names, TEST_NUM_NAMES, &distance);
+    }
+    double guess_ns = (_now_ns() - start) / TEST_GUESSES;
+
+    printf("game_match: %.1f ns/guess over %u names\n", guess_ns, TEST_NUM_NAMES);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_game_distance);
+    RUN_TEST(test_game_match);
+    RUN_TEST(test_game_score);
+    RUN_TEST(test_game_time_up);
+    RUN_TEST(test_game_excerpt);
+    RUN_TEST(test_game_cost);
+
+    return UNITY_END();
+}
@@ -0,0 +1,183 @@
+/**
+ * @file test_gapless.c
+ * @brief Unit test of the melodies that follow each other without a gap: the first note of the next melody must start
+ * at the clock edge at which the last note of the current one ends, not when the player gets round to it.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stdio.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+#include "port_buzzer.h"
+
+/* Other libraries */
+#include "melodies.h"
+#include "fsm_buzzer.h"
+
+/* Test dependencies */
+#include <unity.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define TEST_FREQ_TOLERANCE 0.001                       /*!< Largest relative error of the pitch of a note */
+#define TEST_MAX_GAP_CYCLES (PORT_SIM_CORE_CLOCK_HZ / 100000) /*!< Largest gap between the melodies: 10 us */
+
+/* Global variables */
+static fsm_t *p_fsm;                                    /*!< Buzzer under test */
+static const melody_t *p_first = &iscale_melody;        /*!< Melody that plays first */
+static const melody_t *p_second = &tetris_melody;       /*!< Melody that follows, from another note */
+
+/**
+ * @brief Set the Up object. It is called before a test function is called.
+ *
+ */
+void setUp(void)
+{
+    port_sim_reset();
+    port_system_init();
+    p_fsm = fsm_buzzer_new(BUZZER_0_ID);
+    fsm_buzzer_set_melody(p_fsm, p_first);
+}
+
+/**
+ * @brief Tear down the test. It is called after a test function is called.
+ *
+ */
+void tearDown(void)
+{
+    fsm_destroy(p_fsm);
+}
+
+/**
+ * @brief Fire the player until the last note of the melody starts.
+ *
+ * @return Virtual time at which the last note must end, in cycles
+ */
+static uint64_t _play_to_last_note(void)
+{
+    fsm_buzzer_set_action(p_fsm, PLAY);
+    while (fsm_buzzer_check_activity(p_fsm))
+    {
+        int state = fsm_get_state(p_fsm);
+        uint32_t note_index = fsm_buzzer_get_note_index(p_fsm);
+        fsm_fire(p_fsm);
+        if ((fsm_get_state(p_fsm) == WAIT_NOTE) && (state != WAIT_NOTE) && (note_index + 1U == p_first->melody_length))
+        {
+            break;
+        }
+        port_sim_run_cpu(PORT_SIM_POLL_CYCLES);
+    }
+    port_sim_tim_sync(TIM2);
+    uint64_t period = (uint64_t)(TIM2->PSC + 1U) * (TIM2->ARR + 1U);
+    return port_sim_tim_get_start_cycles(TIM2) + period;
+}
+
+/**
+ * @brief Get the time from the end of the last note to the start of the buzzer, and check its note.
+ *
+ * @param note_end Virtual time at which the last note ended, in cycles
+ * @return Gap in cycles
+ */
+static uint64_t _get_gap(uint64_t note_end)
+{
+    port_sim_tim_sync(BUZZER_0_TIM);
+    double output = port_sim_tim_get_output_hz(BUZZER_0_TIM);
+    TEST_ASSERT_DOUBLE_WITHIN(p_second->p_notes[0] * TEST_FREQ_TOLERANCE, p_second->p_notes[0], output);
+    uint64_t start = port_sim_tim_get_start_cycles(BUZZER_0_TIM);
+    TEST_ASSERT_TRUE(start >= note_end);
+    return start - note_end;
+}
+
+/**
+ * @brief Test that the next melody starts at the end of the last note, much sooner than when the player starts it.
+ *
+ */
+void test_gapless_gap(void)
+{
+    // Baseline: the next melody is started when the player has ended the current one
+    uint64_t note_end = _play_to_last_note();
+    while (fsm_buzzer_check_activity(p_fsm))
+    {
+        fsm_fire(p_fsm);
+        port_sim_run_cpu(PORT_SIM_POLL_CYCLES);
+    }
+    fsm_buzzer_set_melody(p_fsm, p_second);
+    fsm_buzzer_set_action(p_fsm, PLAY);
+    fsm_fire(p_fsm);
+    TEST_ASSERT_EQUAL_INT(WAIT_NOTE, fsm_get_state(p_fsm));
+    uint64_t baseline = _get_gap(note_end);
+    fsm_buzzer_set_action(p_fsm, STOP);
+    fsm_fire(p_fsm);
+
+    // Gapless: the next melody is staged along the last note
+    fsm_buzzer_set_melody(p_fsm, p_first);
+    fsm_buzzer_set_next_melody(p_fsm, p_second);
+    note_end = _play_to_last_note();
+    TEST_ASSERT_FALSE(fsm_buzzer_get_next_started(p_fsm));
+    port_sim_advance_to(note_end + PORT_SIM_POLL_CYCLES);
+    uint64_t gap = _get_gap(note_end);
+
+    // The player catches up afterwards, on the second note of the next melody
+    fsm_fire(p_fsm);
+    TEST_ASSERT_EQUAL_INT(WAIT_NOTE, fsm_get_state(p_fsm));
+    TEST_ASSERT_TRUE(fsm_buzzer_get_next_started(p_fsm));
+    TEST_ASSERT_FALSE(fsm_buzzer_get_next_started(p_fsm));
+    TEST_ASSERT_NULL(fsm_buzzer_get_next_melody(p_fsm));
+    TEST_ASSERT_EQUAL_UINT32(1, fsm_buzzer_get_note_index(p_fsm));
+
+    printf("%s to %s: %u cycles started by the player, %u cycles staged\n", p_first->p_name, p_second->p_name,
+           (unsigned)baseline, (unsigned)gap);
+    TEST_ASSERT_TRUE(gap < baseline);
+    TEST_ASSERT_TRUE(gap <= TEST_MAX_GAP_CYCLES);
+}
+
+/**
+ * @brief Test that a stop in the last note drops the next melody: the note ends as usual and the
+ * player goes silent.
+ *
+ */
+void test_gapless_stop(void)
+{
+    fsm_buzzer_set_next_melody(p_fsm, p_second);
+    uint64_t note_end = _play_to_last_note();
+    fsm_buzzer_set_action(p_fsm, STOP);
+    fsm_fire(p_fsm);
+    port_sim_advance_to(note_end + PORT_SIM_POLL_CYCLES);
+    port_sim_tim_sync(BUZZER_0_TIM);
+    double output = port_sim_tim_get_output_hz(BUZZER_0_TIM);
+    TEST_ASSERT_TRUE(output < p_second->p_notes[0] * (1.0 - TEST_FREQ_TOLERANCE));
+    fsm_fire(p_fsm);
+    fsm_fire(p_fsm);
+    TEST_ASSERT_EQUAL_INT(WAIT_START, fsm_get_state(p_fsm));
+    port_sim_tim_sync(BUZZER_0_TIM);
+    TEST_ASSERT_DOUBLE_WITHIN(0.0, 0.0, port_sim_tim_get_output_hz(BUZZER_0_TIM));
+    TEST_ASSERT_FALSE(fsm_buzzer_get_next_started(p_fsm));
+}
+
+/**
+ * @brief Test that a new melody drops the next one.
+ *
+ */
+void test_gapless_drop(void)
+{
+    fsm_buzzer_set_next_melody(p_fsm, p_second);
+    TEST_ASSERT_TRUE(fsm_buzzer_get_next_melody(p_fsm) == p_second);
+    fsm_buzzer_set_melody(p_fsm, p_first);
+    TEST_ASSERT_NULL(fsm_buzzer_get_next_melody(p_fsm));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_gapless_gap);
+    RUN_TEST(test_gapless_stop);
+    RUN_TEST(test_gapless_drop);
+
+    return UNITY_END();
+}
@@ -0,0 +1,275 @@
+/**
+ * @file test_melody_store.c
+ * @brief Unit test of the melody store on the flash model, backed by a file: melodies survive a reset, an upload cut
+ * in the middle leaves the stored ones intact, and the time spent programming the flash is measured per note.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stdio.h>
+#include <string.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+#include "port_flash.h"
+
+/* Other libraries */
+#include "melody_store.h"
+#include "frame.h"
+
+/* Test dependencies */
+#include <unity.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define TEST_FLASH_FILE "test_melody_store.flash"   /*!< File that backs the flash */
+#define TEST_NOTES 100                              /*!< Notes of the uploaded melodies */
+
+/* Global variables */
+/// @brief Notes as uploaded: frequency in tenths of Hz and duration in ms
+static uint8_t notes[TEST_NOTES * MELODY_STORE_NOTE_BYTES];
+
+/**
+ * @brief Set the Up object. It is called before a test function is called.
+ *
+ */
+void setUp(void)
+{
+    port_sim_reset();
+    port_system_init();
+    remove(TEST_FLASH_FILE);
+    port_flash_set_file(TEST_FLASH_FILE);
+}
+
+/**
+ * @brief Tear down the test. It is called after a test function is called.
+ *
+ */
+void tearDown(void)
+{
+    port_flash_set_file(NULL);
+    remove(TEST_FLASH_FILE);
+}
+
+/**
+ * @brief Fill the notes of a melody: a scale from `base` Hz.
+ *
+ * @param base First frequency, in Hz
+ */
+static void _fill_notes(uint16_t base)
+{
+    for (uint32_t i = 0; i < TEST_NOTES; i++)
+    {
+        uint16_t decihertz = (base + i) * 10 + 5;
+        uint16_t duration = 100 + i;
+        notes[i * MELODY_STORE_NOTE_BYTES] = decihertz & 0xFF;
+        notes[i * MELODY_STORE_NOTE_BYTES + 1] = decihertz >> 8;
+        notes[i * MELODY_STORE_NOTE_BYTES + 2] = duration & 0xFF;
+        notes[i * MELODY_STORE_NOTE_BYTES + 3] = duration >> 8;
+    }
+}
+
+/**
+ * @brief Upload the notes as the jukebox does: `FRAME_UPLOAD_NOTES` at a time.
+ *
+ * @param p_store Pointer to the store
+ * @param p_name Name of the melody
+ * @param sent Notes sent before the upload is cut; `TEST_NOTES` to commit it
+ * @param p_melody_idx Pointer to store the index of the melody
+ * @return Result of the commit, or of the last write if the upload is cut
+ */
+static melody_store_status_t _upload(melody_store_t *p_store, const char *p_name, uint16_t sent, uint32_t *p_melody_idx)
+{
+    melody_store_status_t status = melody_store_begin(p_store, p_name, TEST_NOTES);
+    for (uint16_t note = 0; (note < sent) && (status == MELODY_STORE_OK); note += FRAME_UPLOAD_NOTES)
+    {
+        uint16_t num_notes = ((sent - note) < FRAME_UPLOAD_NOTES) ? (sent - note) : FRAME_UPLOAD_NOTES;
+        status = melody_store_write(p_store, note, &notes[note * MELODY_STORE_NOTE_BYTES], num_notes);
+    }
+    if ((status != MELODY_STORE_OK) || (sent < TEST_NOTES))
+    {
+        return status;
+    }
+    return melody_store_end(p_store, frame_crc16(notes, sizeof(notes)), p_melody_idx);
+}
+
+/**
+ * @brief Reset the board: the RAM is lost and the flash is read again from its file.
+ *
+ * @param p_store Pointer to the store
+ */
+static void _reset(melody_store_t *p_store)
+{
+    port_flash_set_file(NULL);
+    port_sim_reset();
+    port_system_init();
+    TEST_ASSERT_TRUE(port_flash_set_file(TEST_FLASH_FILE));
+    melody_store_mount(p_store);
+}
+
+/**
+ * @brief Check a stored melody against the notes.
+ *
+ * @param p_melody Pointer to the melody
+ * @param p_name Name of the melody
+ */
+static void _check_melody(const melody_t *p_melody, const char *p_name)
+{
+    TEST_ASSERT_NOT_NULL(p_melody);
+    TEST_ASSERT_EQUAL_STRING(p_name, p_melody->p_name);
+    TEST_ASSERT_EQUAL_UINT32(TEST_NOTES, p_melody->melody_length);
+    for (uint32_t i = 0; i < TEST_NOTES; i++)
+    {
+        const uint8_t *p_note = &notes[i * MELODY_STORE_NOTE_BYTES];
+        TEST_ASSERT_DOUBLE_WITHIN(1e-9, (p_note[0] | (p_note[1] << 8)) / 10.0, p_melody->p_notes[i]);
+        TEST_ASSERT_EQUAL_UINT32(p_note[2] | (p_note[3] << 8), p_melody->p_durations[i]);
+    }
+}
+
+/**
+ * @brief Check that an uploaded melody is found and survives a reset.
+ *
+ */
+void test_upload_and_reset(void)
+{
+    melody_store_t store;
+    uint32_t melody_idx;
+    melody_store_mount(&store);
+    _fill_notes(200);
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_OK, _upload(&store, "Zelda", TEST_NOTES, &melody_idx));
+    TEST_ASSERT_EQUAL_UINT32(0, melody_idx);
+    TEST_ASSERT_EQUAL_UINT32(0, melody_store_find(&store, "zel", false));
+    TEST_ASSERT_EQUAL_UINT32(MELODY_STORE_NOT_FOUND, melody_store_find(&store, "zel", true));
+
+    _reset(&store);
+    TEST_ASSERT_EQUAL_UINT32(1, melody_store_get_num_melodies(&store));
+    _check_melody(melody_store_get(&store, 0), "Zelda");
+    TEST_ASSERT_NULL(melody_store_get(&store, 1));
+}
+
+/**
+ * @brief Check that cut and wrong uploads leave the stored melodies intact and are not committed.
+ *
+ */
+void test_partial_upload(void)
+{
+    melody_store_t store;
+    uint32_t melody_idx;
+    melody_store_mount(&store);
+    _fill_notes(200);
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_OK, _upload(&store, "Zelda", TEST_NOTES, &melody_idx));
+
+    // Cut by a reset: the same name, so it would replace the stored melody once committed
+    _fill_notes(300);
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_OK, _upload(&store, "Zelda", TEST_NOTES / 2, &melody_idx));
+    _reset(&store);
+    _fill_notes(200);
+    TEST_ASSERT_EQUAL_UINT32(1, melody_store_get_num_melodies(&store));
+    _check_melody(melody_store_get(&store, 0), "Zelda");
+
+    // Notes out of order, a retry, missing notes and a wrong CRC
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_OK, melody_store_begin(&store, "Pokemon", TEST_NOTES));
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_BAD_PARAM, melody_store_write(&store, 3, notes, 3));
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_OK, melody_store_write(&store, 0, notes, 3));
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_OK, melody_store_write(&store, 0, notes, 3));
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_BAD_PARAM, melody_store_end(&store, frame_crc16(notes, sizeof(notes)), &melody_idx));
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_OK, _upload(&store, "Pokemon", TEST_NOTES - 1, &melody_idx));
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_OK, melody_store_write(&store, TEST_NOTES - 1, &notes[(TEST_NOTES - 1) * MELODY_STORE_NOTE_BYTES], 1));
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_BAD_PARAM, melody_store_end(&store, frame_crc16(notes, sizeof(notes)) ^ 1, &melody_idx));
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_BAD_PARAM, melody_store_end(&store, frame_crc16(notes, sizeof(notes)), &melody_idx));
+    TEST_ASSERT_EQUAL_UINT32(1, melody_store_get_num_melodies(&store));
+
+    // The log goes on after the broken records
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_OK, _upload(&store, "Pokemon", TEST_NOTES, &melody_idx));
+    TEST_ASSERT_EQUAL_UINT32(1, melody_idx);
+    _reset(&store);
+    TEST_ASSERT_EQUAL_UINT32(2, melody_store_get_num_melodies(&store));
+    _check_melody(melody_store_get(&store, 0), "Zelda");
+    _check_melody(melody_store_get(&store, 1), "Pokemon");
+}
+
+/**
+ * @brief Check replacing, deleting and erasing melodies, and a full store.
+ *
+ */
+void test_replace_delete_and_erase(void)
+{
+    melody_store_t store;
+    uint32_t melody_idx;
+    melody_store_mount(&store);
+    _fill_notes(200);
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_OK, _upload(&store, "Zelda", TEST_NOTES, &melody_idx));
+    _fill_notes(400);
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_OK, _upload(&store, "Zelda", TEST_NOTES, &melody_idx));
+    TEST_ASSERT_EQUAL_UINT32(0, melody_idx);
+    _reset(&store);
+    TEST_ASSERT_EQUAL_UINT32(1, melody_store_get_num_melodies(&store));
+    _check_melody(melody_store_get(&store, 0), "Zelda");
+
+    // Fill the melodies; a new name does not fit, a stored one can still be replaced
+    char name[MELODY_STORE_NAME_LENGTH];
+    for (uint32_t i = 1; i < MELODY_STORE_MAX_MELODIES; i++)
+    {
+        sprintf(name, "Song_%lu", (unsigned long)i);
+        TEST_ASSERT_EQUAL_INT(MELODY_STORE_OK, _upload(&store, name, TEST_NOTES, &melody_idx));
+    }
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_NO_SPACE, melody_store_begin(&store, "Tetris", TEST_NOTES));
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_OK, _upload(&store, "Song_3", TEST_NOTES, &melody_idx));
+    TEST_ASSERT_EQUAL_UINT32(3, melody_idx);
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_BAD_PARAM, melody_store_begin(&store, "bad name", TEST_NOTES));
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_NO_SPACE, melody_store_begin(&store, "Song_1", 0xFFF0));
+
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_OK, melody_store_delete(&store, 0));
+    TEST_ASSERT_EQUAL_UINT32(MELODY_STORE_NOT_FOUND, melody_store_find(&store, "Zelda", true));
+    TEST_ASSERT_EQUAL_STRING("Song_1", melody_store_get(&store, 0)->p_name);
+    _reset(&store);
+    TEST_ASSERT_EQUAL_UINT32(MELODY_STORE_MAX_MELODIES - 1, melody_store_get_num_melodies(&store));
+    TEST_ASSERT_EQUAL_UINT32(MELODY_STORE_NOT_FOUND, melody_store_find(&store, "Zelda", true));
+
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_OK, melody_store_erase(&store));
+    TEST_ASSERT_EQUAL_UINT32(0, melody_store_get_num_melodies(&store));
+    TEST_ASSERT_EQUAL_UINT32(PORT_FLASH_STORE_SIZE, melody_store_get_free(&store));
+    _reset(&store);
+    TEST_ASSERT_EQUAL_UINT32(0, melody_store_get_num_melodies(&store));
+}
+
+/**
+ * @brief Measure the time spent programming the flash per uploaded note, and the space taken.
+ *
+ */
+void test_write_time(void)
+{
+    melody_store_t store;
+    uint32_t melody_idx;
+    melody_store_mount(&store);
+    _fill_notes(200);
+    uint64_t busy_cycles = port_flash_get_busy_cycles();
+    uint32_t free = melody_store_get_free(&store);
+    TEST_ASSERT_EQUAL_INT(MELODY_STORE_OK, _upload(&store, "Zelda", TEST_NOTES, &melody_idx));
+    busy_cycles = port_flash_get_busy_cycles() - busy_cycles;
+    free -= melody_store_get_free(&store);
+
+    double us_per_note = busy_cycles * 1e6 / SystemCoreClock / TEST_NOTES;
+    printf("%u notes: %lu bytes of flash, %.1f us programming per note (%.0f notes/s at most)\n", TEST_NOTES,
+           (unsigned long)free, us_per_note, 1e6 / us_per_note);
+
+    // A note is a double and a u16: 5 halfwords, plus the header spread over the melody
+    uint32_t halfwords = TEST_NOTES * (sizeof(double) + sizeof(uint16_t)) / 2;
+    UNITY_TEST_ASSERT(busy_cycles >= (uint64_t)halfwords * PORT_FLASH_PROGRAM_CYCLES, __LINE__, "Every note should be programmed");
+    UNITY_TEST_ASSERT(busy_cycles <= (uint64_t)(halfwords + sizeof(melody_store_header_t) / 2) * PORT_FLASH_PROGRAM_CYCLES, __LINE__,
+                      "Nothing but the notes and the header should be programmed");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+    RUN_TEST(test_upload_and_reset);
+    RUN_TEST(test_partial_upload);
+    RUN_TEST(test_replace_delete_and_erase);
+    RUN_TEST(test_write_time);
+    return UNITY_END();
+}
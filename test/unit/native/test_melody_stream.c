@@ -0,0 +1,228 @@
+/**
+ * @file test_melody_stream.c
+ * @brief Unit test of the melodies streamed from the external storage: the buzzer plays a melody much longer than the
+ * prefetch window while the main loop is held by bursts of work, as the LCD and the USART do. It reports the notes
+ * that were ready in time (hit rate) and the longest wait for a note (stall), with a NOR flash and with a storage
+ * too slow to keep up.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stdio.h>
+#include <string.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+#include "port_storage.h"
+#include "port_buzzer.h"
+
+/* Other libraries */
+#include "melody_stream.h"
+#include "fsm_buzzer.h"
+
+/* Test dependencies */
+#include <unity.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define TEST_STORAGE_FILE "test_melody_stream.bin"  /*!< File that backs the storage */
+#define TEST_NOTES 2000                             /*!< Notes of the long melody, 125 buffers of the window */
+#define TEST_NOTE_MS 5                              /*!< Duration of each note */
+#define TEST_BURST_CYCLES 48000U                    /*!< Main loop held by the LCD or the USART: 3 ms */
+#define TEST_BURST_PERIOD_CYCLES 272000U            /*!< Time between bursts: 17 ms, out of step with the notes */
+#define TEST_SLOW_ACCESS_CYCLES 1600000U            /*!< Access time of a slow storage: 100 ms, more than a buffer */
+
+/* Global variables */
+static fsm_t *p_fsm_buzzer;                         /*!< Buzzer that plays the stream */
+static melody_stream_t stream;                      /*!< Stream under test */
+
+/**
+ * @brief Write the image of the storage: a short melody and then the long one.
+ *
+ */
+static void _write_image(void)
+{
+    FILE *p_file = fopen(TEST_STORAGE_FILE, "wb");
+    TEST_ASSERT_NOT_NULL(p_file);
+    const uint32_t lengths[] = {3, TEST_NOTES};
+    const char *names[] = {"Short", "Long scale"};
+    for (uint32_t m = 0; m < 2; m++)
+    {
+        melody_stream_header_t header = {.magic = MELODY_STREAM_MAGIC, .length = lengths[m]};
+        strncpy(header.name, names[m], MELODY_STREAM_NAME_LENGTH - 1);
+        fwrite(&header, sizeof(header), 1, p_file);
+        for (uint32_t i = 0; i < lengths[m]; i++)
+        {
+            uint16_t decihertz = (uint16_t)((200 + i % 800) * 10);
+            uint8_t note[MELODY_STREAM_NOTE_BYTES] = {decihertz & 0xFF, decihertz >> 8, TEST_NOTE_MS, 0};
+            fwrite(note, sizeof(note), 1, p_file);
+        }
+    }
+    fclose(p_file);
+}
+
+/**
+ * @brief Set the Up object. It is called before a test function is called.
+ *
+ */
+void setUp(void)
+{
+    port_sim_reset();
+    port_system_init();
+    _write_image();
+    port_storage_set_file(TEST_STORAGE_FILE);
+    p_fsm_buzzer = fsm_buzzer_new(BUZZER_0_ID);
+    melody_stream_init(&stream);
+}
+
+/**
+ * @brief Tear down the test. It is called after a test function is called.
+ *
+ */
+void tearDown(void)
+{
+    fsm_destroy(p_fsm_buzzer);
+    port_storage_set_file(NULL);
+    remove(TEST_STORAGE_FILE);
+}
+
+/**
+ * @brief Play the long melody to the end, with the main loop held by a burst every `TEST_BURST_PERIOD_CYCLES`.
+ *
+ * @param p_name Name of the case, for the report
+ */
+static void _play_long(const char *p_name)
+{
+    uint32_t address;
+    TEST_ASSERT_TRUE(melody_stream_find(1, &address));
+    TEST_ASSERT_TRUE(melody_stream_open(&stream, address));
+    TEST_ASSERT_EQUAL_UINT32(TEST_NOTES, melody_stream_get_melody(&stream)->melody_length);
+    TEST_ASSERT_EQUAL_STRING("Long scale", melody_stream_get_melody(&stream)->p_name);
+
+    fsm_buzzer_set_stream(p_fsm_buzzer, &stream);
+    fsm_buzzer_set_action(p_fsm_buzzer, PLAY);
+    uint64_t start = port_sim_get_cycles();
+    uint64_t limit = start + (uint64_t)TEST_NOTES * TEST_NOTE_MS * 4 * (PORT_SIM_CORE_CLOCK_HZ / 1000);
+    uint64_t burst = start + TEST_BURST_PERIOD_CYCLES;
+    while (fsm_buzzer_check_activity(p_fsm_buzzer) && (port_sim_get_cycles() < limit))
+    {
+        int state = fsm_get_state(p_fsm_buzzer);
+        fsm_fire(p_fsm_buzzer);
+        if (fsm_get_state(p_fsm_buzzer) == state)
+        {
+            // Nothing to do until the end of the note or of a read, as the jukebox sleeps
+            port_sim_wait_for_interrupt(burst);
+        }
+        if (port_sim_get_cycles() >= burst)
+        {
+            port_sim_run_cpu(TEST_BURST_CYCLES);
+            burst += TEST_BURST_PERIOD_CYCLES;
+        }
+    }
+    TEST_ASSERT_FALSE(fsm_buzzer_check_activity(p_fsm_buzzer));
+
+    uint32_t hits = melody_stream_get_hits(&stream);
+    uint32_t stalls = melody_stream_get_stalls(&stream);
+    double seconds = (double)(port_sim_get_cycles() - start) / PORT_SIM_CORE_CLOCK_HZ;
+    printf("%s: %u notes in %.2f s, hit rate %.2f %% (%u stalls), worst stall %.1f us, %u reads\n",
+            p_name, TEST_NOTES, seconds, 100.0 * hits / TEST_NOTES, (unsigned)stalls,
+            melody_stream_get_max_stall_cycles(&stream) * 1e6 / PORT_SIM_CORE_CLOCK_HZ,
+            (unsigned)port_storage_get_reads());
+    TEST_ASSERT_EQUAL_UINT32(TEST_NOTES, hits + stalls);
+}
+
+/**
+ * @brief Test the headers: melodies are found in order, and past the last one there is none.
+ *
+ */
+void test_melody_stream_find(void)
+{
+    uint32_t address;
+    TEST_ASSERT_TRUE(melody_stream_find(0, &address));
+    TEST_ASSERT_EQUAL_UINT32(0, address);
+    TEST_ASSERT_TRUE(melody_stream_open(&stream, address));
+    TEST_ASSERT_EQUAL_STRING("Short", melody_stream_get_melody(&stream)->p_name);
+    TEST_ASSERT_EQUAL_UINT32(3, melody_stream_get_melody(&stream)->melody_length);
+    TEST_ASSERT_NULL(melody_stream_get_melody(&stream)->p_notes);
+
+    TEST_ASSERT_TRUE(melody_stream_find(1, &address));
+    TEST_ASSERT_EQUAL_UINT32(sizeof(melody_stream_header_t) + 3 * MELODY_STREAM_NOTE_BYTES, address);
+    TEST_ASSERT_FALSE(melody_stream_find(2, &address));
+    TEST_ASSERT_FALSE(melody_stream_open(&stream, address + 1));
+}
+
+/**
+ * @brief Test the notes of a stream: they are read in the background and come out as stored.
+ *
+ */
+void test_melody_stream_notes(void)
+{
+    uint32_t address;
+    double frequency;
+    uint32_t duration;
+    TEST_ASSERT_TRUE(melody_stream_find(1, &address));
+    TEST_ASSERT_TRUE(melody_stream_open(&stream, address));
+
+    // The first buffer is being read: a stall until its interrupt
+    TEST_ASSERT_FALSE(melody_stream_get_note(&stream, 0, &frequency, &duration));
+    TEST_ASSERT_EQUAL_UINT32(1, melody_stream_get_stalls(&stream));
+    port_sim_run_cpu(PORT_SIM_CORE_CLOCK_HZ / 1000);
+    for (uint32_t i = 0; i < 3 * MELODY_STREAM_CHUNK_NOTES; i++)
+    {
+        UNITY_TEST_ASSERT(melody_stream_get_note(&stream, i, &frequency, &duration), __LINE__, "Note not prefetched");
+        TEST_ASSERT_DOUBLE_WITHIN(1e-9, 200.0 + i, frequency);
+        TEST_ASSERT_EQUAL_UINT32(TEST_NOTE_MS, duration);
+        port_sim_run_cpu(PORT_SIM_CORE_CLOCK_HZ / 1000);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, melody_stream_get_stalls(&stream));
+    TEST_ASSERT_EQUAL_UINT32(3 * MELODY_STREAM_CHUNK_NOTES - 1, melody_stream_get_hits(&stream));
+
+    // A jump out of the window is a stall, and the notes there are read again
+    TEST_ASSERT_FALSE(melody_stream_is_ready(&stream, 1000));
+    port_sim_run_cpu(PORT_SIM_CORE_CLOCK_HZ / 1000);
+    TEST_ASSERT_TRUE(melody_stream_get_note(&stream, 1000, &frequency, &duration));
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 400.0, frequency);
+    TEST_ASSERT_EQUAL_UINT32(2, melody_stream_get_stalls(&stream));
+}
+
+/**
+ * @brief Test a long melody from a NOR flash: every note but the first one is ready in time, whatever the bursts.
+ *
+ */
+void test_melody_stream_flash(void)
+{
+    _play_long("NOR flash");
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(1, melody_stream_get_stalls(&stream));
+    // The only stall is the first buffer, one read of the SPI
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(PORT_SIM_CORE_CLOCK_HZ / 1000, melody_stream_get_max_stall_cycles(&stream));
+    // Each buffer is read once: the headers and then the window
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(4 + TEST_NOTES / MELODY_STREAM_CHUNK_NOTES, port_storage_get_reads());
+}
+
+/**
+ * @brief Test a long melody from a storage slower than the notes: the buzzer waits, but plays every note.
+ *
+ */
+void test_melody_stream_slow_storage(void)
+{
+    port_storage_set_access_cycles(TEST_SLOW_ACCESS_CYCLES);
+    _play_long("Slow storage");
+    UNITY_TEST_ASSERT(melody_stream_get_stalls(&stream) > TEST_NOTES / MELODY_STREAM_CHUNK_NOTES / 2, __LINE__,
+                      "A storage slower than the notes should stall the buzzer");
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(2 * TEST_SLOW_ACCESS_CYCLES, melody_stream_get_max_stall_cycles(&stream));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_melody_stream_find);
+    RUN_TEST(test_melody_stream_notes);
+    RUN_TEST(test_melody_stream_flash);
+    RUN_TEST(test_melody_stream_slow_storage);
+
+    return UNITY_END();
+}
@@ -0,0 +1,238 @@
+/**
+ * @file test_multi_buzzer.c
+ * @brief Unit test of the melodies on several buzzers: the voices of each note must start together, with the note
+ * duration timer that triggers them, whatever the time taken to set them up one after another.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stdio.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+#include "port_buzzer.h"
+
+/* Other libraries */
+#include "melodies.h"
+#include "fsm_buzzer.h"
+
+/* Test dependencies */
+#include <unity.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define TEST_FREQ_TOLERANCE 0.001                       /*!< Largest relative error of the pitch of a voice */
+#define TEST_PAUSE_CYCLES (PORT_SIM_CORE_CLOCK_HZ / 20) /*!< Time each pause lasts: 50 ms */
+#define TEST_SETUP_CYCLES 2000U                         /*!< Time between two voices armed by hand */
+
+/* Global variables */
+static fsm_t *p_fsm;                                    /*!< Buzzer under test */
+static const melody_t *p_melody = &happy_birthday_melody; /*!< Melody under test: the melody and two other tracks */
+
+/**
+ * @brief Set the Up object. It is called before a test function is called.
+ *
+ */
+void setUp(void)
+{
+    port_sim_reset();
+    port_system_init();
+    p_fsm = fsm_buzzer_new(BUZZER_0_ID);
+    fsm_buzzer_set_melody(p_fsm, p_melody);
+}
+
+/**
+ * @brief Tear down the test. It is called after a test function is called.
+ *
+ */
+void tearDown(void)
+{
+    fsm_destroy(p_fsm);
+}
+
+/**
+ * @brief Get the note of a voice of the melody under test.
+ *
+ * @param voice Voice: 0 for the melody, then its other tracks
+ * @param note_index Index of the note
+ * @return Frequency of the note in Hz, 0 for a rest
+ */
+static double _get_voice_note(uint32_t voice, uint32_t note_index)
+{
+    return (voice == 0) ? p_melody->p_notes[note_index] : p_melody->p_tracks[voice - 1][note_index];
+}
+
+/**
+ * @brief Check the voices of a note that has just started: each one sounds its note, from the clock edge at which
+ * the note duration timer started, to one tick of its own timer.
+ *
+ * @param note_index Index of the note
+ * @return Largest distance from the start of a voice to the one of the note, in cycles
+ */
+static uint64_t _check_note_start(uint32_t note_index)
+{
+    char msg[80];
+    uint64_t worst = 0;
+    port_sim_tim_sync(TIM2);
+    uint64_t note_start = port_sim_tim_get_start_cycles(TIM2);
+    for (uint32_t voice = 0; voice < BUZZERS_LENGTH; voice++)
+    {
+        TIM_TypeDef *p_tim = buzzers_arr[voice].p_tim;
+        port_sim_tim_sync(p_tim);
+        double expected = _get_voice_note(voice, note_index);
+        double output = port_sim_tim_get_output_hz(p_tim);
+        snprintf(msg, sizeof(msg), "Voice %u of note %u", voice, note_index);
+        UNITY_TEST_ASSERT_DOUBLE_WITHIN(expected * TEST_FREQ_TOLERANCE, expected, output, __LINE__, msg);
+        if (expected == 0)
+        {
+            continue;
+        }
+        uint64_t start = port_sim_tim_get_start_cycles(p_tim);
+        uint64_t distance = (start > note_start) ? start - note_start : note_start - start;
+        UNITY_TEST_ASSERT(distance <= p_tim->PSC + 1U, __LINE__, msg);
+        worst = (distance > worst) ? distance : worst;
+    }
+    return worst;
+}
+
+/**
+ * @brief Test that the three voices of each note start at the same tick of their timers.
+ *
+ */
+void test_multi_buzzer_sync_start(void)
+{
+    TEST_ASSERT_EQUAL_INT(3, p_melody->num_tracks + 1);
+    uint64_t worst = 0;
+    uint32_t notes = 0;
+    fsm_buzzer_set_action(p_fsm, PLAY);
+    while (fsm_buzzer_check_activity(p_fsm))
+    {
+        int state = fsm_get_state(p_fsm);
+        uint32_t note_index = fsm_buzzer_get_note_index(p_fsm);
+        fsm_fire(p_fsm);
+        if (fsm_get_state(p_fsm) == state)
+        {
+            port_sim_wait_for_interrupt(PORT_SIM_NEVER);
+            continue;
+        }
+        if (fsm_get_state(p_fsm) == WAIT_NOTE)
+        {
+            uint64_t distance = _check_note_start(note_index);
+            worst = (distance > worst) ? distance : worst;
+            notes++;
+        }
+    }
+    printf("%s: %u notes on %u buzzers, voices at most %u cycles apart\n", p_melody->p_name, notes, BUZZERS_LENGTH,
+           (unsigned)worst);
+    TEST_ASSERT_EQUAL_UINT32(p_melody->melody_length, notes);
+    for (uint32_t voice = 0; voice < BUZZERS_LENGTH; voice++)
+    {
+        TEST_ASSERT_DOUBLE_WITHIN(0.0, 0.0, port_sim_tim_get_output_hz(buzzers_arr[voice].p_tim));
+    }
+}
+
+/**
+ * @brief Test that an armed voice waits for the note duration timer, however late it is started.
+ *
+ */
+void test_multi_buzzer_armed_wait(void)
+{
+    port_buzzer_arm_note(BUZZER_0_ID, LA4, 0.5);
+    port_sim_run_cpu(TEST_SETUP_CYCLES);
+    port_buzzer_arm_note(BUZZER_1_ID, DO5, 0.5);
+    port_sim_run_cpu(TEST_SETUP_CYCLES);
+    port_buzzer_arm_note(BUZZER_2_ID, MI5, 0.5);
+    port_sim_run_cpu(TEST_SETUP_CYCLES);
+    for (uint32_t voice = 0; voice < BUZZERS_LENGTH; voice++)
+    {
+        port_sim_tim_sync(buzzers_arr[voice].p_tim);
+        TEST_ASSERT_DOUBLE_WITHIN(0.0, 0.0, port_sim_tim_get_output_hz(buzzers_arr[voice].p_tim));
+    }
+    TEST_ASSERT_DOUBLE_WITHIN(LA4 * TEST_FREQ_TOLERANCE, LA4, port_buzzer_get_note_frequency(BUZZER_0_ID));
+
+    port_buzzer_set_note_duration(BUZZER_0_ID, 100);
+    uint64_t note_start = port_sim_tim_get_start_cycles(TIM2);
+    for (uint32_t voice = 0; voice < BUZZERS_LENGTH; voice++)
+    {
+        port_sim_tim_sync(buzzers_arr[voice].p_tim);
+        TEST_ASSERT_EQUAL_UINT32((uint32_t)note_start, (uint32_t)port_sim_tim_get_start_cycles(buzzers_arr[voice].p_tim));
+    }
+    double output = port_sim_tim_get_output_hz(BUZZER_2_TIM);
+    TEST_ASSERT_DOUBLE_WITHIN(MI5 * TEST_FREQ_TOLERANCE, MI5, output);
+
+    // A rest of a voice: it stays silent when the others start
+    port_buzzer_arm_note(BUZZER_0_ID, LA4, 0.5);
+    port_buzzer_arm_note(BUZZER_1_ID, 0, 0.5);
+    port_buzzer_set_note_duration(BUZZER_0_ID, 100);
+    port_sim_tim_sync(BUZZER_1_TIM);
+    TEST_ASSERT_DOUBLE_WITHIN(0.0, 0.0, port_sim_tim_get_output_hz(BUZZER_1_TIM));
+}
+
+/**
+ * @brief Test that a pause silences every voice and that the resume starts again those that were sounding.
+ *
+ */
+void test_multi_buzzer_pause(void)
+{
+    fsm_buzzer_set_action(p_fsm, PLAY);
+    // Third note: F, A and D on the three buzzers
+    while (fsm_buzzer_get_note_index(p_fsm) < 3)
+    {
+        fsm_fire(p_fsm);
+        port_sim_run_cpu(PORT_SIM_POLL_CYCLES);
+    }
+    TEST_ASSERT_EQUAL_INT(WAIT_NOTE, fsm_get_state(p_fsm));
+    port_sim_run_cpu(PORT_SIM_CORE_CLOCK_HZ / 10);
+
+    fsm_buzzer_set_action(p_fsm, PAUSE);
+    fsm_fire(p_fsm);
+    TEST_ASSERT_EQUAL_INT(PAUSE_NOTE, fsm_get_state(p_fsm));
+    for (uint32_t voice = 0; voice < BUZZERS_LENGTH; voice++)
+    {
+        TEST_ASSERT_DOUBLE_WITHIN(0.0, 0.0, port_sim_tim_get_output_hz(buzzers_arr[voice].p_tim));
+    }
+    port_sim_advance_to(port_sim_get_cycles() + TEST_PAUSE_CYCLES);
+
+    fsm_buzzer_set_action(p_fsm, PLAY);
+    fsm_fire(p_fsm);
+    TEST_ASSERT_EQUAL_INT(WAIT_NOTE, fsm_get_state(p_fsm));
+    for (uint32_t voice = 0; voice < BUZZERS_LENGTH; voice++)
+    {
+        port_sim_tim_sync(buzzers_arr[voice].p_tim);
+        double expected = _get_voice_note(voice, 2);
+        double output = port_sim_tim_get_output_hz(buzzers_arr[voice].p_tim);
+        TEST_ASSERT_DOUBLE_WITHIN(expected * TEST_FREQ_TOLERANCE, expected, output);
+    }
+}
+
+/**
+ * @brief Test that a melody without other tracks leaves the other buzzers silent.
+ *
+ */
+void test_multi_buzzer_single_track(void)
+{
+    fsm_buzzer_set_melody(p_fsm, &scale_melody);
+    fsm_buzzer_set_action(p_fsm, PLAY);
+    fsm_fire(p_fsm);
+    TEST_ASSERT_EQUAL_INT(WAIT_NOTE, fsm_get_state(p_fsm));
+    port_sim_tim_sync(BUZZER_0_TIM);
+    double output = port_sim_tim_get_output_hz(BUZZER_0_TIM);
+    TEST_ASSERT_DOUBLE_WITHIN(scale_melody.p_notes[0] * TEST_FREQ_TOLERANCE, scale_melody.p_notes[0], output);
+    TEST_ASSERT_DOUBLE_WITHIN(0.0, 0.0, port_sim_tim_get_output_hz(BUZZER_1_TIM));
+    TEST_ASSERT_DOUBLE_WITHIN(0.0, 0.0, port_sim_tim_get_output_hz(BUZZER_2_TIM));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_multi_buzzer_sync_start);
+    RUN_TEST(test_multi_buzzer_armed_wait);
+    RUN_TEST(test_multi_buzzer_pause);
+    RUN_TEST(test_multi_buzzer_single_track);
+
+    return UNITY_END();
+}
@@ -0,0 +1,256 @@
+/**
+ * @file test_note_fx.c
+ * @brief Unit test of the pitch effects of a note: depth and rate of the vibrato, a slide that moves evenly in cents
+ * and lands on the next note, an arpeggio that changes note every `NOTE_FX_ARPEGGIO_MS`, and a melody with effects on
+ * the simulated TIM3. The cost of a tick is measured in cycles by `bench_jukebox`.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <math.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+#include "port_buzzer.h"
+
+/* Other libraries */
+#include "melodies.h"
+#include "fsm_buzzer.h"
+#include "note_fx.h"
+
+/* Test dependencies */
+#include <unity.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define TEST_COUNT 1000.0               /*!< Period of the note of the unit tests, in counts of the timer */
+#define TEST_MAX_ERROR_CENTS 2.0        /*!< Largest error of a pitch, from the rounding of ARR at `TEST_COUNT` */
+#define TEST_SIM_ERROR_CENTS 10.0       /*!< Largest error of a pitch on TIM3, which takes a new ARR every period */
+#define TEST_TICK_CYCLES (PORT_SIM_CORE_CLOCK_HZ / ENVELOPE_RATE_HZ)   /*!< Cycles between two ticks */
+#define TEST_NOTE_MS 200                /*!< Duration of each note of the melody */
+#define TEST_HALF_ARR (1U << 15)        /*!< Half the range of the 16-bit auto-reload */
+
+/* Global variables */
+/// @brief Notes of the melody with effects: a slide down an octave that needs a larger prescaler, a vibrato and a
+/// major arpeggio
+static const double test_notes[] = {DO4, DO3, LA4};
+static const uint16_t test_durations[] = {TEST_NOTE_MS, TEST_NOTE_MS, TEST_NOTE_MS};
+static const note_fx_t test_effects[] = {
+    {.flags = NOTE_FX_SLIDE},
+    {.flags = NOTE_FX_VIBRATO, .vibrato_cents = 50, .vibrato_rate = 60},
+    {.flags = NOTE_FX_ARPEGGIO, .arpeggio = {4, 7}},
+};
+static const melody_t test_melody = {.p_name = "effects",
+                                     .p_notes = (double *)test_notes,
+                                     .p_durations = (uint16_t *)test_durations,
+                                     .melody_length = sizeof(test_notes) / sizeof(test_notes[0]),
+                                     .p_effects = test_effects};
+
+static fsm_t *p_fsm;            /*!< Buzzer under test */
+
+/**
+ * @brief Set the Up object. It is called before a test function is called.
+ *
+ */
+void setUp(void)
+{
+    port_sim_reset();
+    port_system_init();
+    p_fsm = fsm_buzzer_new(BUZZER_0_ID);
+    fsm_buzzer_set_melody(p_fsm, &test_melody);
+    fsm_buzzer_set_volume(p_fsm, 1.0);
+}
+
+/**
+ * @brief Tear down the test. It is called after a test function is called.
+ *
+ */
+void tearDown(void)
+{
+    fsm_destroy(p_fsm);
+}
+
+/**
+ * @brief Pitch of an auto-reload relative to the one of `TEST_COUNT`.
+ *
+ * @param arr Auto-reload
+ * @return Cents above the note
+ */
+static double _cents(uint32_t arr)
+{
+    return 1200.0 * log2(TEST_COUNT / (arr + 1.0));
+}
+
+/**
+ * @brief Test the vibrato: it goes the depth above and below the note, as many times per second as its rate.
+ *
+ */
+void test_note_fx_vibrato(void)
+{
+    note_fx_state_t state;
+    note_fx_t fx = {.flags = NOTE_FX_VIBRATO, .vibrato_cents = 50, .vibrato_rate = 50};
+    double longest = note_fx_start(&state, &fx, ENVELOPE_RATE_HZ, 0, 1000);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, pow(2.0, 50.0 / 1200), longest);
+    TEST_ASSERT_EQUAL_UINT32(999, note_fx_set_count(&state, TEST_COUNT));
+    TEST_ASSERT_TRUE(note_fx_is_active(&state));
+
+    double highest = 0;
+    double lowest = 0;
+    uint32_t peaks = 0;
+    bool is_high = false;
+    for (uint32_t tick = 0; tick < ENVELOPE_RATE_HZ; tick++)
+    {
+        double cents = _cents(note_fx_tick(&state));
+        highest = fmax(highest, cents);
+        lowest = fmin(lowest, cents);
+        if (!is_high && (cents > 25))
+        {
+            peaks++;
+        }
+        is_high = cents > 25;
+    }
+    TEST_ASSERT_DOUBLE_WITHIN(TEST_MAX_ERROR_CENTS, 50, highest);
+    TEST_ASSERT_DOUBLE_WITHIN(TEST_MAX_ERROR_CENTS, -50, lowest);
+    TEST_ASSERT_EQUAL_UINT32(5, peaks);
+
+    note_fx_stop(&state);
+    TEST_ASSERT_FALSE(note_fx_is_active(&state));
+}
+
+/**
+ * @brief Test the slide: the same cents every tick, and the pitch of the next note on the last one. Without a next
+ * note there is no slide.
+ *
+ */
+void test_note_fx_slide(void)
+{
+    note_fx_state_t state;
+    note_fx_t fx = {.flags = NOTE_FX_SLIDE};
+    uint32_t duration_ms = 100;
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 1.0, note_fx_start(&state, &fx, ENVELOPE_RATE_HZ, 0.5, duration_ms));
+    note_fx_set_count(&state, TEST_COUNT);
+    uint32_t arr = 0;
+    for (uint32_t tick = 1; tick <= duration_ms; tick++)
+    {
+        arr = note_fx_tick(&state);
+        TEST_ASSERT_DOUBLE_WITHIN(TEST_MAX_ERROR_CENTS, 1200.0 * tick / duration_ms, _cents(arr));
+    }
+    TEST_ASSERT_EQUAL_UINT32(499, arr);
+    // The slide is over: the pitch holds
+    TEST_ASSERT_EQUAL_UINT32(499, note_fx_tick(&state));
+
+    // A slide down needs room for the longer period
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 2.0, note_fx_start(&state, &fx, ENVELOPE_RATE_HZ, 2.0, duration_ms));
+
+    // Nothing to slide to
+    note_fx_start(&state, &fx, ENVELOPE_RATE_HZ, 0, duration_ms);
+    TEST_ASSERT_FALSE(note_fx_is_active(&state));
+    note_fx_start(&state, NULL, ENVELOPE_RATE_HZ, 0.5, duration_ms);
+    TEST_ASSERT_FALSE(note_fx_is_active(&state));
+}
+
+/**
+ * @brief Test the arpeggio: the note and its two intervals in turns of `NOTE_FX_ARPEGGIO_MS`.
+ *
+ */
+void test_note_fx_arpeggio(void)
+{
+    note_fx_state_t state;
+    note_fx_t fx = {.flags = NOTE_FX_ARPEGGIO, .arpeggio = {4, 7}};
+    double longest = note_fx_start(&state, &fx, ENVELOPE_RATE_HZ, 0, 1000);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 1.0, longest);
+    note_fx_set_count(&state, TEST_COUNT);
+
+    const double chord_cents[NOTE_FX_CHORD_LENGTH] = {0, 400, 700};
+    uint32_t ticks_per_note = NOTE_FX_ARPEGGIO_MS * ENVELOPE_RATE_HZ / 1000U;
+    for (uint32_t tick = 1; tick < 4 * NOTE_FX_CHORD_LENGTH * ticks_per_note; tick++)
+    {
+        double expected = chord_cents[(tick / ticks_per_note) % NOTE_FX_CHORD_LENGTH];
+        double cents = _cents(note_fx_tick(&state));
+        TEST_ASSERT_DOUBLE_WITHIN(TEST_MAX_ERROR_CENTS, expected, cents);
+    }
+
+    // A chord below the note lengthens the period
+    fx.arpeggio[1] = -12;
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 2.0, note_fx_start(&state, &fx, ENVELOPE_RATE_HZ, 0, 1000));
+}
+
+/**
+ * @brief Test a melody with effects on TIM3: the slide of the first note lands on the second one, an octave below,
+ * with a larger prescaler, and the vibrato and the arpeggio change the frequency of the PWM as it plays.
+ *
+ */
+void test_note_fx_melody(void)
+{
+    fsm_buzzer_set_action(p_fsm, PLAY);
+    fsm_fire(p_fsm);
+    TEST_ASSERT_EQUAL_INT(WAIT_NOTE, fsm_get_state(p_fsm));
+    // The prescaler leaves room for the period an octave below
+    UNITY_TEST_ASSERT(TIM3->ARR < TEST_HALF_ARR, __LINE__, "The slide down an octave should need a larger prescaler");
+
+    // Along the slide: TIM3 takes the auto-reload of a tick at the end of its period, so the pitch lags up to a period
+    // and a tick behind
+    uint32_t ms = 0;
+    for (uint32_t checkpoint = TEST_NOTE_MS / 4; checkpoint < TEST_NOTE_MS; checkpoint += TEST_NOTE_MS / 4)
+    {
+        port_sim_run_cpu(TEST_TICK_CYCLES * (checkpoint - ms));
+        ms = checkpoint;
+        double hz = port_sim_tim_get_output_hz(TIM3);
+        double cents = 1200.0 * log2(hz / (DO4 * pow(2.0, -(double)ms / TEST_NOTE_MS)));
+        double lag_cents = 1200.0 * (1000.0 / hz + 1.0) / TEST_NOTE_MS;
+        UNITY_TEST_ASSERT((cents > -TEST_MAX_ERROR_CENTS) && (cents < lag_cents + TEST_MAX_ERROR_CENTS), __LINE__,
+                          "The slide should move evenly in cents");
+    }
+
+    // The vibrato and the arpeggio, note by note
+    for (uint32_t note = 1; note < test_melody.melody_length; note++)
+    {
+        while (fsm_buzzer_get_note_index(p_fsm) <= note)
+        {
+            fsm_fire(p_fsm);
+            port_sim_wait_for_interrupt(PORT_SIM_NEVER);
+        }
+        double highest = 0;
+        double lowest = 0;
+        for (uint32_t i = 0; i < TEST_NOTE_MS - 20; i++)
+        {
+            port_sim_run_cpu(TEST_TICK_CYCLES);
+            double cents = 1200.0 * log2(port_sim_tim_get_output_hz(TIM3) / test_notes[note]);
+            highest = fmax(highest, cents);
+            lowest = fmin(lowest, cents);
+        }
+        if (test_effects[note].flags & NOTE_FX_VIBRATO)
+        {
+            TEST_ASSERT_DOUBLE_WITHIN(TEST_SIM_ERROR_CENTS, test_effects[note].vibrato_cents, highest);
+            TEST_ASSERT_DOUBLE_WITHIN(TEST_SIM_ERROR_CENTS, -test_effects[note].vibrato_cents, lowest);
+        }
+        else
+        {
+            TEST_ASSERT_DOUBLE_WITHIN(TEST_SIM_ERROR_CENTS, 700, highest);
+            TEST_ASSERT_DOUBLE_WITHIN(TEST_SIM_ERROR_CENTS, 0, lowest);
+        }
+    }
+
+    // The end of the melody drops the effects
+    while (fsm_buzzer_check_activity(p_fsm))
+    {
+        fsm_fire(p_fsm);
+        port_sim_wait_for_interrupt(PORT_SIM_NEVER);
+    }
+    TEST_ASSERT_FALSE(note_fx_is_active(&buzzers_arr[BUZZER_0_ID].fx));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_note_fx_vibrato);
+    RUN_TEST(test_note_fx_slide);
+    RUN_TEST(test_note_fx_arpeggio);
+    RUN_TEST(test_note_fx_melody);
+
+    return UNITY_END();
+}
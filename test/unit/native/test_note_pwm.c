@@ -0,0 +1,204 @@
+/**
+ * @file test_note_pwm.c
+ * @brief Unit test of the timer registers of the notes: for every note from DO3 to SI5 it reports the pitch error of
+ * the former driver, which took the largest ARR and rounded, and of the table of `note_pwm.py`, and checks that the
+ * solver finds the best pair that an exhaustive search over every prescaler finds.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stdio.h>
+#include <math.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+#include "port_buzzer.h"
+
+/* Other libraries */
+#include "note_pwm.h"
+
+/* Test dependencies */
+#include <unity.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define TEST_MAX_CENTS 0.05             /*!< Largest error of a note of the table */
+#define TEST_EPSILON_CENTS 1e-9         /*!< Rounding of the comparison of two errors */
+
+/* Global variables */
+/// @brief Names of the semitones of an octave, as in melodies.h
+static const char *const semitone_names[] = {"DO", "DOs", "RE", "REs", "MI", "FA", "FAs", "SOL", "SOLs", "LA", "LAs", "SI"};
+
+/**
+ * @brief Set the Up object. It is called before a test function is called.
+ *
+ */
+void setUp(void)
+{
+}
+
+/**
+ * @brief Tear down the test. It is called after a test function is called.
+ *
+ */
+void tearDown(void)
+{
+}
+
+/**
+ * @brief Registers of the former driver: the PSC that gives the largest ARR, then the ARR rounded.
+ *
+ * @param clock_hz Clock of the timer
+ * @param frequency Frequency in Hz
+ * @param p_psc Pointer to store the prescaler
+ * @param p_arr Pointer to store the auto-reload
+ */
+static void _former_registers(uint32_t clock_hz, double frequency, uint32_t *p_psc, uint32_t *p_arr)
+{
+    double ticks = (double)clock_hz / frequency;
+    double psc = round(ticks / NOTE_PWM_MAX_COUNT) - 1;
+    double arr = round(ticks / (psc + 1)) - 1;
+    if (arr > NOTE_PWM_MAX_COUNT - 1)
+    {
+        psc++;
+        arr = round(ticks / (psc + 1)) - 1;
+    }
+    *p_psc = (uint32_t)psc;
+    *p_arr = (uint32_t)arr;
+}
+
+/**
+ * @brief Smallest error of any pair, trying every prescaler.
+ *
+ * @param clock_hz Clock of the timer
+ * @param frequency Frequency in Hz
+ * @return Error in cents, as an absolute value
+ */
+static double _exhaustive_cents(uint32_t clock_hz, double frequency)
+{
+    double best = INFINITY;
+    double ticks = (double)clock_hz / frequency;
+    for (uint32_t psc = 0; psc < NOTE_PWM_MAX_COUNT; psc++)
+    {
+        double count = round(ticks / (psc + 1.0));
+        for (double arr = count - 2; arr <= count; arr++)
+        {
+            if ((arr >= 1) && (arr < NOTE_PWM_MAX_COUNT))
+            {
+                best = fmin(best, fabs(note_pwm_get_cents(frequency, clock_hz, psc, (uint32_t)arr)));
+            }
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Test the notes from DO3 to SI5: the table is what the solver finds, never worse than the former driver, and
+ * the driver loads it into TIM3.
+ *
+ */
+void test_note_pwm_table(void)
+{
+    // No attack: the note starts at its volume
+    envelope_config_t config = {.attack_ms = 0, .decay_ms = ENVELOPE_DEFAULT_DECAY_MS,
+                                .release_ms = ENVELOPE_DEFAULT_RELEASE_MS, .sustain_db = 0};
+    port_buzzer_set_envelope(BUZZER_0_ID, &config);
+    TEST_ASSERT_EQUAL_UINT32(SystemCoreClock, note_pwm_table_clock_hz);
+    printf("%-6s %9s %14s %9s %14s %9s\n", "note", "Hz", "before PSC/ARR", "cents", "after PSC/ARR", "cents");
+    double before_max = 0;
+    double after_max = 0;
+    for (uint32_t i = 0; i < NOTE_PWM_TABLE_LENGTH; i++)
+    {
+        const note_pwm_t *p_note = &note_pwm_table[i];
+        uint32_t psc;
+        uint32_t arr;
+        note_pwm_solve(note_pwm_table_clock_hz, p_note->frequency, &psc, &arr);
+        TEST_ASSERT_EQUAL_UINT32(psc, p_note->psc);
+        TEST_ASSERT_EQUAL_UINT32(arr, p_note->arr);
+
+        uint32_t former_psc;
+        uint32_t former_arr;
+        _former_registers(SystemCoreClock, p_note->frequency, &former_psc, &former_arr);
+        double before = note_pwm_get_cents(p_note->frequency, SystemCoreClock, former_psc, former_arr);
+        double after = note_pwm_get_cents(p_note->frequency, SystemCoreClock, psc, arr);
+        char name[8];
+        snprintf(name, sizeof(name), "%s%u", semitone_names[i % 12], (unsigned)(3 + i / 12));
+        printf("%-6s %9.3f %6u/%-7u %+9.4f %6u/%-7u %+9.4f\n", name, p_note->frequency, (unsigned)former_psc,
+               (unsigned)former_arr, before, (unsigned)psc, (unsigned)arr, after);
+        UNITY_TEST_ASSERT(fabs(after) <= fabs(before) + TEST_EPSILON_CENTS, __LINE__, "A note is worse than before");
+        before_max = fmax(before_max, fabs(before));
+        after_max = fmax(after_max, fabs(after));
+
+        // The driver loads the pair, with the duty cycle over the whole period: half of it at the full volume
+        port_buzzer_set_note_frequency(BUZZER_0_ID, p_note->frequency, 1.0);
+        TEST_ASSERT_EQUAL_UINT32(psc, TIM3->PSC);
+        TEST_ASSERT_EQUAL_UINT32(arr, TIM3->ARR);
+        TEST_ASSERT_EQUAL_UINT32((arr + 1) / 2, TIM3->CCR1);
+        TEST_ASSERT_DOUBLE_WITHIN(1e-9, after, 1200.0 * log2(port_buzzer_get_note_frequency(BUZZER_0_ID) / p_note->frequency));
+    }
+    port_buzzer_stop(BUZZER_0_ID);
+    printf("Largest error: %.4f cents before, %.4f cents after\n", before_max, after_max);
+    UNITY_TEST_ASSERT(after_max <= TEST_MAX_CENTS, __LINE__, "A note of the table is out of tune");
+}
+
+/**
+ * @brief Test that the solver finds the smallest error of every pair, for frequencies out of the table and other
+ * clocks.
+ *
+ */
+void test_note_pwm_exhaustive(void)
+{
+    const uint32_t clocks[] = {16000000, 84000000, 100000000};
+    const double frequencies[] = {20.0, 61.735, 138.591 * 1.0594630943592953, 1234.5, 4186.009, 15000.0};
+    for (uint32_t c = 0; c < sizeof(clocks) / sizeof(clocks[0]); c++)
+    {
+        for (uint32_t f = 0; f < sizeof(frequencies) / sizeof(frequencies[0]); f++)
+        {
+            uint32_t psc;
+            uint32_t arr;
+            TEST_ASSERT_FALSE(note_pwm_find(clocks[c], frequencies[f], &psc, &arr));
+            double cents = fabs(note_pwm_get_cents(frequencies[f], clocks[c], psc, arr));
+            double best = _exhaustive_cents(clocks[c], frequencies[f]);
+            UNITY_TEST_ASSERT(cents <= best + TEST_EPSILON_CENTS, __LINE__, "The solver missed the best pair");
+            TEST_ASSERT_TRUE(psc < NOTE_PWM_MAX_COUNT);
+            TEST_ASSERT_TRUE((arr >= 1) && (arr < NOTE_PWM_MAX_COUNT));
+        }
+    }
+}
+
+/**
+ * @brief Test the lookup in the table and the frequencies out of the range of the timer.
+ *
+ */
+void test_note_pwm_find(void)
+{
+    uint32_t psc;
+    uint32_t arr;
+    TEST_ASSERT_TRUE(note_pwm_find(note_pwm_table_clock_hz, 440.0, &psc, &arr));
+    TEST_ASSERT_TRUE(note_pwm_find(note_pwm_table_clock_hz, note_pwm_table[0].frequency, &psc, &arr));
+    TEST_ASSERT_TRUE(note_pwm_find(note_pwm_table_clock_hz, note_pwm_table[NOTE_PWM_TABLE_LENGTH - 1].frequency, &psc, &arr));
+    TEST_ASSERT_FALSE(note_pwm_find(note_pwm_table_clock_hz, 440.001, &psc, &arr));
+    TEST_ASSERT_FALSE(note_pwm_find(note_pwm_table_clock_hz * 2, 440.0, &psc, &arr));
+
+    // Too high: the shortest period. Too low: the longest one.
+    note_pwm_solve(note_pwm_table_clock_hz, note_pwm_table_clock_hz, &psc, &arr);
+    TEST_ASSERT_EQUAL_UINT32(0, psc);
+    TEST_ASSERT_EQUAL_UINT32(1, arr);
+    note_pwm_solve(note_pwm_table_clock_hz, 0.0001, &psc, &arr);
+    TEST_ASSERT_EQUAL_UINT32(NOTE_PWM_MAX_COUNT - 1, (psc > arr) ? psc : arr);
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_note_pwm_table);
+    RUN_TEST(test_note_pwm_exhaustive);
+    RUN_TEST(test_note_pwm_find);
+
+    return UNITY_END();
+}
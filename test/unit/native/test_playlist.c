@@ -0,0 +1,243 @@
+/**
+ * @file test_playlist.c
+ * @brief Unit test of the playlist: the ring of the queue, the repeat modes, a shuffle without repeats whose rounds
+ * follow what `playlist_peek()` tells, and the uniformity of the shuffle and of the random numbers over a million
+ * draws. The cost of a draw is measured in cycles by `bench_jukebox`.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stdio.h>
+#include <string.h>
+
+/* Other libraries */
+#include "playlist.h"
+
+/* Test dependencies */
+#include <unity.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define TEST_NUM_SONGS 8U           /*!< Songs of the playlist under test */
+#define TEST_SEED 12345U            /*!< Seed of the generator: the same draws in every run */
+#define TEST_DRAWS 1000000U         /*!< Draws of the uniformity tests */
+#define TEST_BOUND 7U               /*!< Values of the random numbers, not a power of 2 */
+#define TEST_CHI2_POSITIONS 85.4    /*!< Chi-square of 49 degrees of freedom exceeded with a probability of 0.001 */
+#define TEST_CHI2_VALUES 22.5       /*!< Chi-square of 6 degrees of freedom exceeded with a probability of 0.001 */
+
+/* Global variables */
+static playlist_t playlist;         /*!< Playlist under test */
+
+/**
+ * @brief Set the Up object. It is called before a test function is called.
+ *
+ */
+void setUp(void)
+{
+    playlist_init(&playlist, TEST_NUM_SONGS, TEST_SEED);
+}
+
+/**
+ * @brief Tear down the test. It is called after a test function is called.
+ *
+ */
+void tearDown(void)
+{
+}
+
+/**
+ * @brief Test the queue: first in, first out across the end of the ring, and full at `PLAYLIST_QUEUE_LENGTH` songs.
+ *
+ */
+void test_playlist_queue(void)
+{
+    uint32_t song;
+    TEST_ASSERT_FALSE(playlist_dequeue(&playlist, &song));
+    TEST_ASSERT_FALSE(playlist_enqueue(&playlist, TEST_NUM_SONGS));
+
+    // Two songs in for each one out, around the end of the ring
+    uint32_t in = 0;
+    uint32_t out = 0;
+    while (playlist_get_queue_length(&playlist) < PLAYLIST_QUEUE_LENGTH)
+    {
+        TEST_ASSERT_TRUE(playlist_enqueue(&playlist, in++ % TEST_NUM_SONGS));
+        if (in % 2 == 0)
+        {
+            TEST_ASSERT_TRUE(playlist_dequeue(&playlist, &song));
+            TEST_ASSERT_EQUAL_UINT32(out++ % TEST_NUM_SONGS, song);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(PLAYLIST_QUEUE_LENGTH, playlist_get_queue_length(&playlist));
+    TEST_ASSERT_FALSE(playlist_enqueue(&playlist, 0));
+    TEST_ASSERT_EQUAL_UINT32(out % TEST_NUM_SONGS, playlist_get_queued(&playlist, 0));
+    TEST_ASSERT_EQUAL_UINT32((in - 1) % TEST_NUM_SONGS, playlist_get_queued(&playlist, PLAYLIST_QUEUE_LENGTH - 1));
+    TEST_ASSERT_EQUAL_UINT32(PLAYLIST_NONE, playlist_get_queued(&playlist, PLAYLIST_QUEUE_LENGTH));
+
+    // Fewer songs: the ones that are gone leave the queue, the others keep their order
+    playlist_set_num_songs(&playlist, 2);
+    uint32_t length = playlist_get_queue_length(&playlist);
+    TEST_ASSERT_EQUAL_UINT32(PLAYLIST_QUEUE_LENGTH / 4, length);
+    for (uint32_t i = 0; i < length; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(i % 2, playlist_get_queued(&playlist, i));
+    }
+
+    playlist_clear(&playlist);
+    TEST_ASSERT_EQUAL_UINT32(0, playlist_get_queue_length(&playlist));
+    TEST_ASSERT_FALSE(playlist_dequeue(&playlist, &song));
+}
+
+/**
+ * @brief Test the repeat modes in order, and that the queue and a skip come before them.
+ *
+ */
+void test_playlist_repeat(void)
+{
+    uint32_t last = TEST_NUM_SONGS - 1;
+    TEST_ASSERT_EQUAL_UINT32(0, playlist_peek(&playlist, PLAYLIST_NONE, false));
+    TEST_ASSERT_EQUAL_UINT32(4, playlist_advance(&playlist, 3, false));
+    TEST_ASSERT_EQUAL_UINT32(PLAYLIST_NONE, playlist_advance(&playlist, last, false));
+    TEST_ASSERT_EQUAL_UINT32(0, playlist_advance(&playlist, last, true));
+
+    playlist_set_repeat(&playlist, PLAYLIST_REPEAT_ALL);
+    TEST_ASSERT_EQUAL_UINT32(0, playlist_advance(&playlist, last, false));
+
+    playlist_set_repeat(&playlist, PLAYLIST_REPEAT_ONE);
+    TEST_ASSERT_EQUAL_UINT32(3, playlist_advance(&playlist, 3, false));
+    TEST_ASSERT_EQUAL_UINT32(4, playlist_advance(&playlist, 3, true));
+
+    // The queue goes first, but not before a song that repeats
+    playlist_enqueue(&playlist, 6);
+    playlist_enqueue(&playlist, 1);
+    TEST_ASSERT_EQUAL_UINT32(3, playlist_advance(&playlist, 3, false));
+    TEST_ASSERT_EQUAL_UINT32(2, playlist_get_queue_length(&playlist));
+    playlist_set_repeat(&playlist, PLAYLIST_REPEAT_OFF);
+    TEST_ASSERT_EQUAL_UINT32(6, playlist_peek(&playlist, 3, false));
+    TEST_ASSERT_EQUAL_UINT32(6, playlist_advance(&playlist, 3, false));
+    TEST_ASSERT_EQUAL_UINT32(1, playlist_advance(&playlist, last, false));
+    TEST_ASSERT_EQUAL_UINT32(2, playlist_advance(&playlist, 1, false));
+}
+
+/**
+ * @brief Test the shuffle: every round plays every song once, never the same song twice in a row, and
+ * `playlist_advance()` follows what `playlist_peek()` told, across rounds.
+ *
+ */
+void test_playlist_shuffle(void)
+{
+    playlist_set_repeat(&playlist, PLAYLIST_REPEAT_ALL);
+    playlist_set_shuffle(&playlist, true);
+    TEST_ASSERT_TRUE(playlist_get_shuffle(&playlist));
+    uint32_t current = 5;
+    for (uint32_t round = 0; round < 100; round++)
+    {
+        bool played[TEST_NUM_SONGS] = {false};
+        for (uint32_t i = 0; i < TEST_NUM_SONGS; i++)
+        {
+            uint32_t next = playlist_peek(&playlist, current, false);
+            TEST_ASSERT_EQUAL_UINT32(next, playlist_peek(&playlist, current, false));
+            TEST_ASSERT_EQUAL_UINT32(next, playlist_advance(&playlist, current, false));
+            TEST_ASSERT_TRUE(next < TEST_NUM_SONGS);
+            TEST_ASSERT_TRUE(next != current);
+            TEST_ASSERT_FALSE(played[next]);
+            played[next] = true;
+            current = next;
+        }
+    }
+
+    // Without repeat, nothing follows the end of a round but a skip
+    playlist_set_repeat(&playlist, PLAYLIST_REPEAT_OFF);
+    TEST_ASSERT_EQUAL_UINT32(PLAYLIST_NONE, playlist_peek(&playlist, current, false));
+    TEST_ASSERT_TRUE(playlist_advance(&playlist, current, true) < TEST_NUM_SONGS);
+}
+
+/**
+ * @brief Test the uniformity of the shuffle: over a million songs, each song is as likely in each position of a round,
+ * by the chi-square of the counts.
+ *
+ */
+void test_playlist_shuffle_uniform(void)
+{
+    static uint32_t counts[TEST_NUM_SONGS][TEST_NUM_SONGS];
+    memset(counts, 0, sizeof(counts));
+    playlist_set_repeat(&playlist, PLAYLIST_REPEAT_ALL);
+    playlist_set_shuffle(&playlist, true);
+    uint32_t current = PLAYLIST_NONE;
+    for (uint32_t i = 0; i < TEST_DRAWS; i++)
+    {
+        current = playlist_advance(&playlist, current, false);
+        counts[i % TEST_NUM_SONGS][current]++;
+    }
+
+    double expected = (double)TEST_DRAWS / (TEST_NUM_SONGS * TEST_NUM_SONGS);
+    double chi2 = 0;
+    for (uint32_t position = 0; position < TEST_NUM_SONGS; position++)
+    {
+        for (uint32_t song = 0; song < TEST_NUM_SONGS; song++)
+        {
+            double delta = counts[position][song] - expected;
+            chi2 += delta * delta / expected;
+        }
+    }
+    printf("Shuffle of %u songs, %u draws: chi-square %.1f (limit %.1f)\n", TEST_NUM_SONGS, TEST_DRAWS, chi2,
+           TEST_CHI2_POSITIONS);
+    TEST_ASSERT_TRUE(chi2 < TEST_CHI2_POSITIONS);
+}
+
+/**
+ * @brief Test the uniformity of the random numbers below a bound that is not a power of 2.
+ *
+ */
+void test_playlist_random(void)
+{
+    uint32_t counts[TEST_BOUND] = {0};
+    TEST_ASSERT_EQUAL_UINT32(0, playlist_random(&playlist, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, playlist_random(&playlist, 1));
+
+    for (uint32_t i = 0; i < TEST_DRAWS; i++)
+    {
+        counts[playlist_random(&playlist, TEST_BOUND)]++;
+    }
+
+    double expected = (double)TEST_DRAWS / TEST_BOUND;
+    double chi2 = 0;
+    for (uint32_t value = 0; value < TEST_BOUND; value++)
+    {
+        double delta = counts[value] - expected;
+        chi2 += delta * delta / expected;
+    }
+    printf("playlist_random: %u draws below %u, chi-square %.1f (limit %.1f)\n", TEST_DRAWS, TEST_BOUND, chi2,
+           TEST_CHI2_VALUES);
+    TEST_ASSERT_TRUE(chi2 < TEST_CHI2_VALUES);
+}
+
+/**
+ * @brief Test that the seed changes the shuffle and that 0 is a valid seed.
+ *
+ */
+void test_playlist_seed(void)
+{
+    playlist_t other;
+    playlist_init(&other, TEST_NUM_SONGS, 0);
+    TEST_ASSERT_TRUE(other.random_state != 0);
+    playlist_set_shuffle(&playlist, true);
+    playlist_set_shuffle(&other, true);
+    TEST_ASSERT_TRUE(memcmp(playlist.order, other.order, TEST_NUM_SONGS) != 0);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_playlist_queue);
+    RUN_TEST(test_playlist_repeat);
+    RUN_TEST(test_playlist_shuffle);
+    RUN_TEST(test_playlist_shuffle_uniform);
+    RUN_TEST(test_playlist_random);
+    RUN_TEST(test_playlist_seed);
+
+    return UNITY_END();
+}
@@ -0,0 +1,168 @@
+/**
+ * @file test_port_usart_dma.c
+ * @brief Unit test of the reception of the USART on the register model: an interrupt per byte (RXNE) against circular
+ * DMA with idle-line detection. It checks that the USART FSM receives the same commands in both modes, and measures
+ * the wakeups of the CPU and the ISR cycles per received command.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stdio.h>
+#include <string.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+#include "port_usart.h"
+
+/* Other libraries */
+#include "fsm_usart.h"
+
+/* Test dependencies */
+#include <unity.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define TEST_COMMANDS 40            /*!< Commands received in each mode: enough to wrap around the DMA buffer */
+#define TEST_TIMEOUT_MS 100         /*!< Longest wait for a command */
+
+/* Typedefs --------------------------------------------------------------------*/
+/// @brief Cost of receiving the commands
+typedef struct
+{
+    uint32_t bytes;         /*!< Bytes received */
+    uint32_t wakeups;       /*!< Times an interrupt woke the CPU up */
+    uint32_t isrs;          /*!< ISRs of the USART and of its DMA stream */
+    uint64_t isr_cycles;    /*!< CPU time in those ISRs */
+} rx_cost_t;
+
+/* Global variables */
+/// @brief Commands sent in a loop, each one in its own burst
+static const char *commands[] = {"volume 0.4\n", "info\n", "select 3\n", "next\n", "baud 115200\n"};
+
+/**
+ * @brief Set the Up object. It is called before a test function is called.
+ *
+ */
+void setUp(void)
+{
+    port_sim_reset();
+    port_system_init();
+}
+
+/**
+ * @brief Tear down the test. It is called after a test function is called.
+ *
+ */
+void tearDown(void)
+{
+}
+
+/**
+ * @brief Receive the commands through the USART FSM, sleeping between interrupts as the main loop does.
+ *
+ * @param dma Reception through circular DMA and the IDLE interrupt
+ * @param p_cost Pointer to the cost of the reception
+ */
+static void _receive(bool dma, rx_cost_t *p_cost)
+{
+    usart_arr[USART_0_ID].rx_dma = dma;
+    fsm_t *p_fsm = fsm_usart_new(USART_0_ID);
+    fsm_usart_enable_rx_interrupt(p_fsm);
+
+    memset(p_cost, 0, sizeof(rx_cost_t));
+    uint32_t wakeups = port_sim_get_wakeups();
+    uint32_t isrs = port_sim_get_irq_count(USART3_IRQn) + port_sim_get_irq_count(DMA1_Stream1_IRQn);
+    uint64_t isr_cycles = port_sim_get_irq_cycles(USART3_IRQn) + port_sim_get_irq_cycles(DMA1_Stream1_IRQn);
+
+    for (uint32_t i = 0; i < TEST_COMMANDS; i++)
+    {
+        const char *p_command = commands[i % (sizeof(commands) / sizeof(commands[0]))];
+        size_t length = strlen(p_command);
+        uint64_t start = port_sim_get_cycles();
+        port_sim_usart_inject(USART_0, (const uint8_t *)p_command, length, start + port_sim_usart_byte_cycles(USART_0));
+        p_cost->bytes += length;
+
+        // Only the USART can wake the CPU up: the SysTick is suspended before sleeping, as in port_system_sleep()
+        while (!fsm_usart_check_data_received(p_fsm))
+        {
+            port_system_systick_suspend();
+            UNITY_TEST_ASSERT(port_sim_wait_for_interrupt(start + PORT_SIM_MS_TO_CYCLES(TEST_TIMEOUT_MS)), __LINE__, "The command did not wake the CPU up");
+            fsm_fire(p_fsm);
+        }
+
+        char data[USART_INPUT_BUFFER_LENGTH + 1] = {0};
+        fsm_usart_get_in_data(p_fsm, data);
+        UNITY_TEST_ASSERT(!strncmp(data, p_command, length - 1) && (data[length - 1] == EMPTY_BUFFER_CONSTANT), __LINE__, "The command was not received intact");
+        fsm_usart_reset_input_data(p_fsm);
+
+        // Let the line go idle before the next burst
+        port_sim_advance_to(port_sim_get_cycles() + 2 * port_sim_usart_byte_cycles(USART_0));
+    }
+
+    p_cost->wakeups = port_sim_get_wakeups() - wakeups;
+    p_cost->isrs = port_sim_get_irq_count(USART3_IRQn) + port_sim_get_irq_count(DMA1_Stream1_IRQn) - isrs;
+    p_cost->isr_cycles = port_sim_get_irq_cycles(USART3_IRQn) + port_sim_get_irq_cycles(DMA1_Stream1_IRQn) - isr_cycles;
+
+    fsm_usart_disable_rx_interrupt(p_fsm);
+    fsm_destroy(p_fsm);
+}
+
+/**
+ * @brief Test the reception with an interrupt per byte: every byte wakes the CPU up.
+ *
+ */
+void test_rx_interrupt_per_byte(void)
+{
+    rx_cost_t cost;
+    _receive(false, &cost);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(cost.bytes, cost.wakeups, __LINE__, "Every byte should wake the CPU up");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(cost.bytes, cost.isrs, __LINE__, "Every byte should raise an interrupt");
+}
+
+/**
+ * @brief Test the reception through circular DMA: one wakeup per command, plus the half and full transfer interrupts
+ * of the buffer.
+ *
+ */
+void test_rx_dma(void)
+{
+    rx_cost_t cost;
+    _receive(true, &cost);
+    uint32_t buffer_events = 2 * (cost.bytes / USART_RX_DMA_BUFFER_LENGTH) + 1;
+    UNITY_TEST_ASSERT(cost.wakeups >= TEST_COMMANDS, __LINE__, "Every command should wake the CPU up");
+    UNITY_TEST_ASSERT(cost.wakeups <= TEST_COMMANDS + buffer_events, __LINE__, "Only the end of a burst and the half and full buffer should wake the CPU up");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, usart_arr[USART_0_ID].p_usart->CR1 & USART_CR1_RXNEIE, __LINE__, "RXNE should not raise interrupts with DMA");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, USART_0_DMA_STREAM->CR & DMA_SxCR_EN, __LINE__, "The DMA stream should stop with the reception");
+}
+
+/**
+ * @brief Compare the cost per command of both modes.
+ *
+ */
+void test_rx_cost_per_command(void)
+{
+    rx_cost_t byte_cost;
+    rx_cost_t dma_cost;
+    _receive(false, &byte_cost);
+    _receive(true, &dma_cost);
+
+    printf("%.1f bytes/command\n", (double)byte_cost.bytes / TEST_COMMANDS);
+    printf("RXNE: %5.2f wakeups/command, %7.1f ISR cycles/command\n", (double)byte_cost.wakeups / TEST_COMMANDS, (double)byte_cost.isr_cycles / TEST_COMMANDS);
+    printf("DMA:  %5.2f wakeups/command, %7.1f ISR cycles/command\n", (double)dma_cost.wakeups / TEST_COMMANDS, (double)dma_cost.isr_cycles / TEST_COMMANDS);
+
+    UNITY_TEST_ASSERT(dma_cost.wakeups * 4 < byte_cost.wakeups, __LINE__, "DMA should wake the CPU up several times less");
+    UNITY_TEST_ASSERT(dma_cost.isr_cycles < byte_cost.isr_cycles, __LINE__, "DMA should spend fewer cycles in ISRs");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+    RUN_TEST(test_rx_interrupt_per_byte);
+    RUN_TEST(test_rx_dma);
+    RUN_TEST(test_rx_cost_per_command);
+    return UNITY_END();
+}
@@ -0,0 +1,336 @@
+/**
+ * @file test_settings_store.c
+ * @brief Unit test of the settings store on the flash model, backed by a file: the values survive a reset, a burst of
+ * changes takes one record, the log is compacted into the other sector when it is full, a power cut at any point of a
+ * write keeps every value old or new, and mounting reads one block of records at most. The records written per erase
+ * are measured.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stdio.h>
+#include <string.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+#include "port_flash.h"
+
+/* Other libraries */
+#include "settings_store.h"
+
+/* Test dependencies */
+#include <unity.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define TEST_FLASH_FILE "test_settings_store.flash"         /*!< File that backs the flash */
+#define TEST_SNAPSHOT_FILE "test_settings_store.snapshot"   /*!< Copy of the flash before a write that is cut */
+#define TEST_KEYS 7U                                        /*!< Keys used, as many as the jukebox */
+#define TEST_VALUE_RECORD 8U                                /*!< Bytes of a record of a key */
+#define TEST_MAX_CUTS 64U                                   /*!< Cut points tried per write, more than it takes */
+
+/**
+ * @brief Set the Up object. It is called before a test function is called.
+ *
+ */
+void setUp(void)
+{
+    port_sim_reset();
+    port_system_init();
+    remove(TEST_FLASH_FILE);
+    port_flash_set_file(TEST_FLASH_FILE);
+}
+
+/**
+ * @brief Tear down the test. It is called after a test function is called.
+ *
+ */
+void tearDown(void)
+{
+    port_flash_set_file(NULL);
+    remove(TEST_FLASH_FILE);
+    remove(TEST_SNAPSHOT_FILE);
+}
+
+/**
+ * @brief Reset the board: the RAM is lost and the flash is read again from its file.
+ *
+ * @param p_store Pointer to the store
+ */
+static void _reset(settings_store_t *p_store)
+{
+    port_flash_set_file(NULL);
+    port_sim_reset();
+    port_system_init();
+    TEST_ASSERT_TRUE(port_flash_set_file(TEST_FLASH_FILE));
+    settings_store_mount(p_store);
+}
+
+/**
+ * @brief Copy a file.
+ *
+ * @param p_from Path of the file
+ * @param p_to Path of the copy
+ */
+static void _copy_file(const char *p_from, const char *p_to)
+{
+    static uint8_t buffer[4096];
+    FILE *p_in = fopen(p_from, "rb");
+    FILE *p_out = fopen(p_to, "wb");
+    TEST_ASSERT_NOT_NULL(p_in);
+    TEST_ASSERT_NOT_NULL(p_out);
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), p_in)) > 0)
+    {
+        fwrite(buffer, 1, length, p_out);
+    }
+    fclose(p_in);
+    fclose(p_out);
+}
+
+/**
+ * @brief Change one key and write it, as often as needed.
+ *
+ * @param p_store Pointer to the store
+ * @param change Number of the change: it picks the key and the value
+ */
+static void _change(settings_store_t *p_store, uint32_t change)
+{
+    settings_store_set(p_store, change % TEST_KEYS, change, change * SETTINGS_STORE_DELAY_MS);
+    TEST_ASSERT_EQUAL_INT(SETTINGS_STORE_OK, settings_store_flush(p_store, true));
+}
+
+/**
+ * @brief Check if the next record does not fit in the sector in use, so the next write compacts the log.
+ *
+ * @param p_store Pointer to the store
+ * @return true if the sector is full
+ */
+static bool _is_full(const settings_store_t *p_store)
+{
+    return (p_store->block == PORT_FLASH_SETTINGS_SIZE / SETTINGS_STORE_BLOCK_SIZE - 1) &&
+           (p_store->end + TEST_VALUE_RECORD > PORT_FLASH_SETTINGS_SIZE);
+}
+
+/**
+ * @brief Cut the power at every point of a write of every key, from the same flash each time. After the reset, each
+ * key must have its old value or its new one, and the store must take new writes.
+ *
+ * @param p_store Pointer to the store, mounted
+ * @return Cut points tried before the write was complete
+ */
+static uint32_t _check_cuts(settings_store_t *p_store)
+{
+    port_flash_set_file(NULL);
+    _copy_file(TEST_FLASH_FILE, TEST_SNAPSHOT_FILE);
+    uint32_t cut = 1;
+    for (; cut <= TEST_MAX_CUTS; cut++)
+    {
+        _copy_file(TEST_SNAPSHOT_FILE, TEST_FLASH_FILE);
+        _reset(p_store);
+        uint32_t old_values[TEST_KEYS];
+        for (uint32_t key = 0; key < TEST_KEYS; key++)
+        {
+            old_values[key] = settings_store_get(p_store, key, 0);
+            settings_store_set(p_store, key, old_values[key] + 1000 + key, 0);
+        }
+        port_flash_cut_power(cut);
+        settings_store_flush(p_store, true);
+        bool complete = !port_flash_is_power_cut();
+
+        _reset(p_store);
+        for (uint32_t key = 0; key < TEST_KEYS; key++)
+        {
+            uint32_t value = settings_store_get(p_store, key, 0);
+            uint32_t new_value = old_values[key] + 1000 + key;
+            UNITY_TEST_ASSERT(complete ? (value == new_value) : ((value == old_values[key]) || (value == new_value)),
+                              __LINE__, "A key should have its old value or its new one");
+        }
+        settings_store_set(p_store, 0, 777, 0);
+        TEST_ASSERT_EQUAL_INT(SETTINGS_STORE_OK, settings_store_flush(p_store, true));
+        _reset(p_store);
+        TEST_ASSERT_EQUAL_UINT32(777, settings_store_get(p_store, 0, 0));
+        if (complete)
+        {
+            break;
+        }
+    }
+    TEST_ASSERT_TRUE(cut <= TEST_MAX_CUTS);
+    return cut;
+}
+
+/**
+ * @brief Check the default values, and that the values survive a reset.
+ *
+ */
+void test_survive_reset(void)
+{
+    settings_store_t store;
+    settings_store_mount(&store);
+    TEST_ASSERT_EQUAL_UINT32(SETTINGS_STORE_NO_SECTOR, store.sector);
+    TEST_ASSERT_EQUAL_UINT32(50, settings_store_get(&store, 0, 50));
+    TEST_ASSERT_EQUAL_UINT32(7, settings_store_get(&store, SETTINGS_STORE_MAX_KEYS, 7));
+    TEST_ASSERT_EQUAL_INT(SETTINGS_STORE_OK, settings_store_flush(&store, false));
+    TEST_ASSERT_EQUAL_UINT32(0, store.written);
+
+    // The first write takes an erased sector: no erase
+    settings_store_set(&store, 0, 80, 0);
+    settings_store_set(&store, 2, 125, 0);
+    TEST_ASSERT_EQUAL_INT(SETTINGS_STORE_OK, settings_store_flush(&store, false));
+    TEST_ASSERT_EQUAL_UINT32(0, port_flash_get_erases());
+    settings_store_set(&store, 5, 0xDEADBEEF, 0);
+    TEST_ASSERT_EQUAL_INT(SETTINGS_STORE_OK, settings_store_flush(&store, false));
+
+    _reset(&store);
+    TEST_ASSERT_EQUAL_UINT32(80, settings_store_get(&store, 0, 50));
+    TEST_ASSERT_EQUAL_UINT32(125, settings_store_get(&store, 2, 100));
+    TEST_ASSERT_EQUAL_UINT32(0xDEADBEEF, settings_store_get(&store, 5, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, settings_store_get(&store, 1, 1));
+    TEST_ASSERT_FALSE(settings_store_is_pending(&store));
+
+    settings_store_set(&store, 0, 30, 0);
+    TEST_ASSERT_EQUAL_INT(SETTINGS_STORE_OK, settings_store_flush(&store, false));
+    _reset(&store);
+    TEST_ASSERT_EQUAL_UINT32(30, settings_store_get(&store, 0, 50));
+    TEST_ASSERT_EQUAL_UINT32(125, settings_store_get(&store, 2, 100));
+}
+
+/**
+ * @brief Check that the changes are due after a quiet time, and that a burst of changes of a key takes one record.
+ *
+ */
+void test_debounce(void)
+{
+    settings_store_t store;
+    settings_store_mount(&store);
+    settings_store_set(&store, 0, 1, 1000);
+    TEST_ASSERT_TRUE(settings_store_is_pending(&store));
+    TEST_ASSERT_FALSE(settings_store_is_due(&store, 1000 + SETTINGS_STORE_DELAY_MS - 1, true));
+    settings_store_set(&store, 0, 2, 2000);
+    settings_store_set(&store, 0, 3, 2500);
+    TEST_ASSERT_FALSE(settings_store_is_due(&store, 1000 + SETTINGS_STORE_DELAY_MS, true));
+    TEST_ASSERT_TRUE(settings_store_is_due(&store, 2500 + SETTINGS_STORE_DELAY_MS, true));
+    TEST_ASSERT_EQUAL_INT(SETTINGS_STORE_OK, settings_store_flush(&store, true));
+    uint32_t written = store.written;
+    TEST_ASSERT_FALSE(settings_store_is_pending(&store));
+
+    // The same value is no change
+    settings_store_set(&store, 0, 3, 9000);
+    TEST_ASSERT_FALSE(settings_store_is_pending(&store));
+    TEST_ASSERT_EQUAL_INT(SETTINGS_STORE_OK, settings_store_flush(&store, true));
+    TEST_ASSERT_EQUAL_UINT32(written, store.written);
+
+    settings_store_set(&store, 0, 4, 9000);
+    settings_store_set(&store, 0, 5, 9000);
+    TEST_ASSERT_EQUAL_INT(SETTINGS_STORE_OK, settings_store_flush(&store, true));
+    TEST_ASSERT_EQUAL_UINT32(written + 1, store.written);
+    _reset(&store);
+    TEST_ASSERT_EQUAL_UINT32(5, settings_store_get(&store, 0, 0));
+}
+
+/**
+ * @brief Write many changes across compactions: count the records per erase, check that an erase waits until it is
+ * allowed, and that mounting a full sector reads one block of records at most.
+ *
+ */
+void test_wear_leveling(void)
+{
+    settings_store_t store;
+    settings_store_mount(&store);
+    uint32_t change = 0;
+    // Fill both sectors: the next compaction needs an erase
+    while ((store.compactions < 2) || !_is_full(&store))
+    {
+        _change(&store, change++);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, port_flash_get_erases());
+
+    // Not allowed: the change waits in RAM, and is not due until it is allowed
+    settings_store_set(&store, 0, 0xCAFE, 0);
+    TEST_ASSERT_EQUAL_INT(SETTINGS_STORE_BUSY, settings_store_flush(&store, false));
+    TEST_ASSERT_TRUE(settings_store_is_pending(&store));
+    TEST_ASSERT_FALSE(settings_store_is_due(&store, SETTINGS_STORE_DELAY_MS, false));
+    TEST_ASSERT_TRUE(settings_store_is_due(&store, SETTINGS_STORE_DELAY_MS, true));
+    TEST_ASSERT_EQUAL_INT(SETTINGS_STORE_OK, settings_store_flush(&store, true));
+    TEST_ASSERT_EQUAL_UINT32(1, port_flash_get_erases());
+    TEST_ASSERT_EQUAL_UINT32(3, store.compactions);
+
+    // Another turn of both sectors: an erase per sector filled
+    uint32_t written = store.written;
+    while (store.compactions < 5)
+    {
+        _change(&store, change++);
+    }
+    uint32_t erases = port_flash_get_erases() - 1;
+    double per_erase = (double)(store.written - written) / erases;
+    printf("%lu records, %lu erases: %.0f records per erase\n", (unsigned long)(store.written - written),
+           (unsigned long)erases, per_erase);
+    // A sector takes a record of 8 bytes per change, less a checkpoint per block
+    UNITY_TEST_ASSERT(per_erase > 0.8 * PORT_FLASH_SETTINGS_SIZE / TEST_VALUE_RECORD, __LINE__,
+                      "A sector should take almost a record per 8 bytes before it is erased");
+
+    while (!_is_full(&store))
+    {
+        _change(&store, change++);
+    }
+    _reset(&store);
+    printf("Mount of a full sector: %lu records read\n", (unsigned long)store.replayed);
+    UNITY_TEST_ASSERT(store.replayed <= SETTINGS_STORE_BLOCK_SIZE / TEST_VALUE_RECORD, __LINE__,
+                      "Mounting should read one block of records at most");
+    for (uint32_t key = 0; key < TEST_KEYS; key++)
+    {
+        // The last change of the key
+        uint32_t last = change - 1 - (change - 1 - key) % TEST_KEYS;
+        TEST_ASSERT_EQUAL_UINT32(last, settings_store_get(&store, key, 0));
+    }
+}
+
+/**
+ * @brief Cut the power at every point of a write: records, a checkpoint at the start of a block, and a compaction with
+ * its erase.
+ *
+ */
+void test_power_loss(void)
+{
+    settings_store_t store;
+    settings_store_mount(&store);
+    uint32_t change = 0;
+    // No sector yet: the first compaction
+    uint32_t cuts = _check_cuts(&store);
+
+    // Records in the middle of a block
+    for (; change < 3 * TEST_KEYS; change++)
+    {
+        _change(&store, change);
+    }
+    cuts += _check_cuts(&store);
+
+    // The next record starts a block: a checkpoint first
+    while (store.end + TEST_VALUE_RECORD <= (store.block + 1) * SETTINGS_STORE_BLOCK_SIZE)
+    {
+        _change(&store, change++);
+    }
+    cuts += _check_cuts(&store);
+
+    // Both sectors full: a compaction with an erase
+    while ((store.compactions < 2) || !_is_full(&store))
+    {
+        _change(&store, change++);
+    }
+    cuts += _check_cuts(&store);
+    printf("%lu power cuts, every key old or new after each one\n", (unsigned long)cuts);
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+    RUN_TEST(test_survive_reset);
+    RUN_TEST(test_debounce);
+    RUN_TEST(test_wear_leveling);
+    RUN_TEST(test_power_loss);
+    return UNITY_END();
+}
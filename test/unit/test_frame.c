@@ -0,0 +1,155 @@
+/**
+ * @file test_frame.c
+ * @brief Unit test for the binary command protocol of the USART. It tests the COBS framing, the CRC and the replies.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <string.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+
+/* Other libraries */
+#include "frame.h"
+
+/* Test dependencies */
+#include <unity.h>
+
+/**
+ * @brief Set the Up object. It is called before a test function is called.
+ *
+ */
+void setUp(void)
+{
+}
+
+/**
+ * @brief Tear down the test. It is called after a test function is called.
+ *
+ */
+void tearDown(void)
+{
+}
+
+/**
+ * @brief Test the CRC against the check value of CRC-16/CCITT-FALSE.
+ *
+ */
+void test_crc(void)
+{
+    const uint8_t check[] = "123456789";
+    UNITY_TEST_ASSERT_EQUAL_HEX16(0x29B1, frame_crc16(check, 9), __LINE__, "Wrong CRC of the check string");
+    UNITY_TEST_ASSERT_EQUAL_HEX16(0xFFFF, frame_crc16(check, 0), __LINE__, "The CRC of nothing should be the initial value");
+}
+
+/**
+ * @brief Test COBS with zeros at both ends, in a row and without zeros.
+ *
+ */
+void test_cobs(void)
+{
+    const uint8_t data[] = {0x00, 0x11, 0x00, 0x00, 0x22, 0x33, 0x00};
+    const uint8_t expected[] = {0x01, 0x02, 0x11, 0x01, 0x03, 0x22, 0x33, 0x01};
+    uint8_t encoded[sizeof(data) + 2];
+    uint8_t decoded[sizeof(data)];
+
+    size_t length = frame_cobs_encode(data, sizeof(data), encoded);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(sizeof(expected), length, __LINE__, "COBS should add one byte");
+    UNITY_TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, encoded, sizeof(expected), __LINE__, "Wrong COBS encoding");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(sizeof(data), frame_cobs_decode(encoded, length, decoded, sizeof(decoded)), __LINE__, "Wrong length after decoding");
+    UNITY_TEST_ASSERT_EQUAL_HEX8_ARRAY(data, decoded, sizeof(data), __LINE__, "The data should survive a round trip");
+
+    // Every byte but 0x00 is copied
+    const uint8_t plain[] = {0x01, 0x02, 0xFF};
+    length = frame_cobs_encode(plain, sizeof(plain), encoded);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(4, length, __LINE__, "COBS should add one byte");
+    UNITY_TEST_ASSERT_EQUAL_HEX8(0x04, encoded[0], __LINE__, "Wrong COBS code");
+
+    // A zero inside the encoded data or a block longer than the data is not valid
+    const uint8_t broken[] = {0x03, 0x11, 0x00};
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, frame_cobs_decode(broken, sizeof(broken), decoded, sizeof(decoded)), __LINE__, "A zero should not be accepted");
+    const uint8_t short_block[] = {0x05, 0x11};
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, frame_cobs_decode(short_block, sizeof(short_block), decoded, sizeof(decoded)), __LINE__, "A truncated block should not be accepted");
+}
+
+/**
+ * @brief Test a frame through encoding and decoding, and the rejection of damaged frames.
+ *
+ */
+void test_frame_round_trip(void)
+{
+    frame_t request = {.opcode = FRAME_OP_SPEED, .seq = 7};
+    frame_t decoded;
+    uint8_t encoded[FRAME_MAX_ENCODED];
+
+    frame_put_u16(&request, 150);
+    size_t length = frame_encode(&request, encoded);
+    UNITY_TEST_ASSERT_EQUAL_HEX8(FRAME_DELIMITER, encoded[length - 1], __LINE__, "The frame should end with the delimiter");
+    for (size_t i = 0; i < length - 1; i++)
+    {
+        UNITY_TEST_ASSERT(encoded[i] != FRAME_DELIMITER, __LINE__, "The delimiter should only appear at the end");
+    }
+
+    UNITY_TEST_ASSERT(frame_decode(encoded, length - 1, &decoded), __LINE__, "The frame should be valid");
+    UNITY_TEST_ASSERT_EQUAL_HEX8(FRAME_OP_SPEED, decoded.opcode, __LINE__, "Wrong opcode");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(7, decoded.seq, __LINE__, "Wrong sequence number");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(2, decoded.length, __LINE__, "Wrong payload length");
+    UNITY_TEST_ASSERT_EQUAL_UINT16(150, frame_get_u16(&decoded, 0), __LINE__, "Wrong payload");
+    UNITY_TEST_ASSERT_EQUAL_UINT16(0, frame_get_u16(&decoded, 1), __LINE__, "A read beyond the payload should return 0");
+
+    // A bit flipped anywhere breaks the CRC or the COBS
+    encoded[2] ^= 0x01;
+    UNITY_TEST_ASSERT(!frame_decode(encoded, length - 1, &decoded), __LINE__, "A damaged frame should be rejected");
+    encoded[2] ^= 0x01;
+
+    // Too short to hold a header and a CRC
+    UNITY_TEST_ASSERT(!frame_decode(encoded, 2, &decoded), __LINE__, "A short frame should be rejected");
+}
+
+/**
+ * @brief Test the replies and the payload limits.
+ *
+ */
+void test_reply(void)
+{
+    frame_t request = {.opcode = FRAME_OP_INFO, .seq = 200};
+    frame_t reply;
+
+    frame_reply(&request, FRAME_STATUS_OK, &reply);
+    UNITY_TEST_ASSERT_EQUAL_HEX8(FRAME_OP_INFO | FRAME_REPLY, reply.opcode, __LINE__, "The reply should carry the opcode of the request");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(200, reply.seq, __LINE__, "The reply should carry the sequence number of the request");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(1, reply.length, __LINE__, "The reply should start with the status");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(FRAME_STATUS_OK, reply.payload[0], __LINE__, "Wrong status");
+    UNITY_TEST_ASSERT_EQUAL_STRING("info", frame_get_opcode_name(reply.opcode), __LINE__, "The name should ignore the reply flag");
+    UNITY_TEST_ASSERT_EQUAL_STRING("?", frame_get_opcode_name(0x50), __LINE__, "An unknown opcode should have no name");
+
+    // The payload never overflows
+    for (uint32_t i = 0; i < FRAME_MAX_PAYLOAD + 4; i++)
+    {
+        frame_put_u8(&reply, (uint8_t)i);
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT8(FRAME_MAX_PAYLOAD, reply.length, __LINE__, "The payload should be limited");
+    frame_put_u16(&reply, 0xFFFF);
+    UNITY_TEST_ASSERT_EQUAL_UINT8(FRAME_MAX_PAYLOAD, reply.length, __LINE__, "The payload should be limited");
+
+    // The longest frame fits in the buffers
+    uint8_t encoded[FRAME_MAX_ENCODED];
+    memset(reply.payload, 0xAA, sizeof(reply.payload));
+    UNITY_TEST_ASSERT(frame_encode(&reply, encoded) <= FRAME_MAX_ENCODED, __LINE__, "The longest frame should fit");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+    RUN_TEST(test_crc);
+    RUN_TEST(test_cobs);
+    RUN_TEST(test_frame_round_trip);
+    RUN_TEST(test_reply);
+    return UNITY_END();
+}
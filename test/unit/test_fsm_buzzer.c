@@ -62,8 +62,9 @@ void test_initial_config(void)
 
     UNITY_TEST_ASSERT_EQUAL_INT(WAIT_START, fsm_get_state(p_fsm), __LINE__, "The initial state of the FSM is not WAIT_START");
 
-    // It assumes there are 8 transitions in the table plus the null transition
-    fsm_trans_t *last_transition = &p_inner_fsm->p_tt[8];
+    // It assumes there are 12 transitions in the table plus the null transition: pause and resume in the middle of a
+    // note, and the next melody, started at the end of the last note or after it
+    fsm_trans_t *last_transition = &p_inner_fsm->p_tt[12];
 
     UNITY_TEST_ASSERT_EQUAL_INT(-1, last_transition->orig_state, __LINE__, "The origin state of the last transition of the FSM should be -1");
     UNITY_TEST_ASSERT_EQUAL_INT(NULL, last_transition->in, __LINE__, "The input condition function of the last transition of the FSM should be NULL");
@@ -419,6 +420,51 @@ void test_auxiliary_functions(void)
     UNITY_TEST_ASSERT_EQUAL_INT(2, (uint32_t)(((fsm_buzzer_t *)p_fsm)->player_speed), __LINE__, "The speed has not been set correctly in the function fsm_buzzer_set_speed()");
 }
 
+/**
+ * @brief Test the tempo and the transpose: they scale the next note started, not the melody.
+ *
+ */
+void test_tempo_transpose(void)
+{
+    printf("Testing the tempo and the transpose...\n");
+    const int32_t semitones[] = {12, -12, 7, -5, 24, -24};
+    const uint32_t tempos[] = {240, 60, 90, 120, 180, 30};
+    for (uint32_t i = 0; i < sizeof(semitones) / sizeof(semitones[0]); i++)
+    {
+        fsm_buzzer_set_transpose(p_fsm, semitones[i]);
+        fsm_buzzer_set_tempo(p_fsm, tempos[i]);
+        UNITY_TEST_ASSERT_EQUAL_INT(semitones[i], fsm_buzzer_get_transpose(p_fsm), __LINE__, "The transpose has not been set correctly in the function fsm_buzzer_set_transpose()");
+
+        fsm_set_state(p_fsm, PLAY_NOTE);
+        ((fsm_buzzer_t *)p_fsm)->p_melody = (melody_t *)(&scale_melody);
+        ((fsm_buzzer_t *)p_fsm)->note_index = 1;
+        ((fsm_buzzer_t *)p_fsm)->user_action = PLAY;
+        fsm_fire(p_fsm);
+
+        // The frequency moves by 2^(semitones/12), as far as the PWM timer resolves it
+        double freq = scale_melody.p_notes[1] * pow(2.0, semitones[i] / 12.0);
+        sprintf(msg, "ERROR: a note of %f Hz transposed %d semitones should sound at %f Hz", scale_melody.p_notes[1], (int)semitones[i], freq);
+        UNITY_TEST_ASSERT_DOUBLE_WITHIN(freq * 0.001, freq, port_buzzer_get_note_frequency(BUZZER_0_ID), __LINE__, msg);
+
+        // The duration scales by the nominal tempo over the tempo
+        uint32_t arr = BUZZER_TIM_DUR->ARR;
+        uint32_t psc = BUZZER_TIM_DUR->PSC;
+        double tim_note_dur_ms = (((double)(arr) + 1.0) / ((double)SystemCoreClock / 1000.0)) * ((double)(psc) + 1);
+        double dur = scale_melody.p_durations[1] * (double)FSM_BUZZER_NOMINAL_TEMPO_BPM / tempos[i];
+        sprintf(msg, "ERROR: a note of %d ms at %u bpm should last %f ms", scale_melody.p_durations[1], (unsigned)tempos[i], dur);
+        UNITY_TEST_ASSERT_INT_WITHIN(1, dur, tim_note_dur_ms, __LINE__, msg);
+    }
+
+    // Beyond two octaves the transpose saturates
+    fsm_buzzer_set_transpose(p_fsm, 40);
+    UNITY_TEST_ASSERT_EQUAL_INT(FSM_BUZZER_MAX_TRANSPOSE, fsm_buzzer_get_transpose(p_fsm), __LINE__, "The transpose should saturate at FSM_BUZZER_MAX_TRANSPOSE");
+    fsm_buzzer_set_transpose(p_fsm, -40);
+    UNITY_TEST_ASSERT_EQUAL_INT(-FSM_BUZZER_MAX_TRANSPOSE, fsm_buzzer_get_transpose(p_fsm), __LINE__, "The transpose should saturate at -FSM_BUZZER_MAX_TRANSPOSE");
+
+    fsm_buzzer_set_transpose(p_fsm, 0);
+    fsm_buzzer_set_tempo(p_fsm, FSM_BUZZER_NOMINAL_TEMPO_BPM);
+}
+
 /**
  * @brief Main test function. Read the terminal for instructions or notes.
  *
@@ -445,5 +491,6 @@ int main(void)
     RUN_TEST(test_resume_melody);
     RUN_TEST(test_restart_melody);
     RUN_TEST(test_auxiliary_functions);
+    RUN_TEST(test_tempo_transpose);
     return UNITY_END();
 }
@@ -0,0 +1,119 @@
+/**
+ * @file test_fsm_log.c
+ * @brief Unit test for the log FSM. It tests that the messages are queued without waiting, drained a few characters
+ * per pass, and dropped whole when the buffer is full.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <string.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+
+/* Other libraries */
+#include "fsm_log.h"
+
+/* Test dependencies */
+#include <unity.h>
+
+/* Global variables */
+static fsm_t *p_fsm;
+
+/**
+ * @brief Set the Up object. It is called before a test function is called.
+ *
+ */
+void setUp(void)
+{
+    p_fsm = fsm_log_new();
+}
+
+/**
+ * @brief Tear down the test. It is called after a test function is called.
+ *
+ */
+void tearDown(void)
+{
+    fsm_destroy(p_fsm);
+}
+
+/**
+ * @brief Test that a message is queued at once and drained `LOG_DRAIN_CHARS` characters per pass.
+ *
+ */
+void test_drain(void)
+{
+    UNITY_TEST_ASSERT_EQUAL_INT(LOG_IDLE, fsm_get_state(p_fsm), __LINE__, "The initial state should be LOG_IDLE");
+    UNITY_TEST_ASSERT(!fsm_log_check_activity(p_fsm), __LINE__, "An empty log should not be active");
+
+    fsm_log_printf(p_fsm, "%s %d\n", "Volume:", 50);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(strlen("Volume: 50\n"), fsm_log_get_pending(p_fsm), __LINE__, "The message should wait in the buffer");
+    UNITY_TEST_ASSERT(fsm_log_check_activity(p_fsm), __LINE__, "A log with characters should be active");
+
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_INT(LOG_DRAIN, fsm_get_state(p_fsm), __LINE__, "The FSM should be draining");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, fsm_log_get_pending(p_fsm), __LINE__, "A short message should be drained in one pass");
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_INT(LOG_IDLE, fsm_get_state(p_fsm), __LINE__, "The FSM should go back to LOG_IDLE");
+
+    // A long message takes several passes
+    char line[LOG_LINE_LENGTH];
+    memset(line, 'a', 3 * LOG_DRAIN_CHARS);
+    line[3 * LOG_DRAIN_CHARS] = '\0';
+    fsm_log_printf(p_fsm, "%s", line);
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2 * LOG_DRAIN_CHARS, fsm_log_get_pending(p_fsm), __LINE__, "Only LOG_DRAIN_CHARS characters should be drained per pass");
+    fsm_fire(p_fsm);
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, fsm_log_get_pending(p_fsm), __LINE__, "The message should be drained");
+}
+
+/**
+ * @brief Test that long messages are truncated and that a message that does not fit is dropped whole.
+ *
+ */
+void test_overflow(void)
+{
+    char line[2 * LOG_LINE_LENGTH];
+    memset(line, 'b', sizeof(line) - 1);
+    line[sizeof(line) - 1] = '\0';
+    fsm_log_printf(p_fsm, "%s", line);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(LOG_LINE_LENGTH - 1, fsm_log_get_pending(p_fsm), __LINE__, "A long message should be truncated");
+
+    // Fill the buffer without draining it
+    uint32_t messages = LOG_BUFFER_LENGTH / (LOG_LINE_LENGTH - 1);
+    for (uint32_t i = 1; i < messages; i++)
+    {
+        fsm_log_printf(p_fsm, "%s", line);
+    }
+    uint32_t pending = fsm_log_get_pending(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(messages * (LOG_LINE_LENGTH - 1), pending, __LINE__, "Every message that fits should be queued");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, fsm_log_get_dropped(p_fsm), __LINE__, "No message should be dropped yet");
+
+    fsm_log_printf(p_fsm, "%s", line);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(pending, fsm_log_get_pending(p_fsm), __LINE__, "Half a message should not be queued");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, fsm_log_get_dropped(p_fsm), __LINE__, "The message should be counted as dropped");
+
+    // Once drained, the ring buffer wraps around and takes messages again
+    while (fsm_log_check_activity(p_fsm))
+    {
+        fsm_fire(p_fsm);
+    }
+    fsm_log_printf(p_fsm, "%s", line);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(LOG_LINE_LENGTH - 1, fsm_log_get_pending(p_fsm), __LINE__, "The drained buffer should take messages again");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, fsm_log_get_dropped(p_fsm), __LINE__, "Wrong dropped messages");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+    RUN_TEST(test_drain);
+    RUN_TEST(test_overflow);
+    return UNITY_END();
+}
@@ -52,8 +52,8 @@ void test_initial_config(void)
 
     UNITY_TEST_ASSERT_EQUAL_INT(WAIT_DATA, fsm_get_state(p_fsm), __LINE__, "The initial state of the FSM is not WAIT_DATA");
 
-    // It assumes there are 3 transitions in the table plus the null transition
-    fsm_trans_t *last_transition = &p_inner_fsm->p_tt[3];
+    // It assumes there are 4 transitions in the table plus the null transition
+    fsm_trans_t *last_transition = &p_inner_fsm->p_tt[4];
 
     UNITY_TEST_ASSERT_EQUAL_INT(-1, last_transition->orig_state, __LINE__, "The origin state of the last transition of the FSM should be -1");
     UNITY_TEST_ASSERT_EQUAL_INT(NULL, last_transition->in, __LINE__, "The input condition function of the last transition of the FSM should be NULL");
@@ -118,7 +118,7 @@ void test_usart_tx()
     UNITY_TEST_ASSERT_EQUAL_INT(USART_CR1_TXEIE, usart_arr[USART_0_ID].p_usart->CR1 & USART_CR1_TXEIE, __LINE__, "The TXEIE bit has not been enabled correctly after sending the first and following chars");
     
     // Wait for the last char to be sent, leaving the ISR to send the rest of the chars.
-    while ((!usart_arr[USART_0_ID].write_complete))
+    while (!port_usart_tx_done(USART_0_ID))
     {        
     }
 
@@ -148,6 +148,100 @@ void test_usart_tx()
     UNITY_TEST_ASSERT_EQUAL_INT(false, usart_arr[USART_0_ID].write_complete, __LINE__, "The write_complete flag has not been cleared correctly in the transition to WAIT_DATA");
 }
 
+/**
+ * @brief Test the BRR computed from the bus clock and the negotiation of the baud rate.
+ * 
+ */
+void test_usart_baud_rate()
+{
+    // 16 MHz with 16x oversampling: 9600 is the 0x0683 of the original configuration
+    UNITY_TEST_ASSERT_EQUAL_INT(0x0683, port_usart_compute_brr(16000000, 9600), __LINE__, "Wrong BRR for 9600 baud");
+    UNITY_TEST_ASSERT_EQUAL_INT(139, port_usart_compute_brr(16000000, 115200), __LINE__, "Wrong BRR for 115200 baud");
+    UNITY_TEST_ASSERT_EQUAL_INT(16, port_usart_compute_brr(16000000, 1000000), __LINE__, "Wrong BRR for 1000000 baud");
+    UNITY_TEST_ASSERT_EQUAL_INT(0, port_usart_compute_brr(16000000, 2000000), __LINE__, "2000000 baud is above the limit of the oversampling");
+    UNITY_TEST_ASSERT_EQUAL_INT(0, port_usart_compute_brr(16000000, 100), __LINE__, "100 baud does not fit in BRR");
+    UNITY_TEST_ASSERT_EQUAL_INT(0, port_usart_compute_brr(16000000, 921600), __LINE__, "921600 baud has an error above the limit");
+
+    // The new rate waits for the next output to be sent
+    UNITY_TEST_ASSERT_EQUAL_INT(false, fsm_usart_set_baud_rate(p_fsm, 2000000), __LINE__, "An unreachable baud rate should be rejected");
+    UNITY_TEST_ASSERT_EQUAL_INT(true, fsm_usart_set_baud_rate(p_fsm, 115200), __LINE__, "115200 baud should be accepted");
+    UNITY_TEST_ASSERT_EQUAL_INT(USART_0_BAUD_RATE, port_usart_get_baud_rate(USART_0_ID), __LINE__, "The baud rate should not change before the acknowledgement is sent");
+    fsm_usart_set_out_data(p_fsm, "ok\n");
+    fsm_fire(p_fsm);
+    while (!port_usart_tx_done(USART_0_ID))
+    {
+    }
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_INT(115200, port_usart_get_baud_rate(USART_0_ID), __LINE__, "The baud rate should change after the acknowledgement");
+    UNITY_TEST_ASSERT_EQUAL_INT(139, usart_arr[USART_0_ID].p_usart->BRR, __LINE__, "Wrong BRR after the change");
+    UNITY_TEST_ASSERT_EQUAL_INT(true, fsm_usart_check_activity(p_fsm), __LINE__, "The FSM should stay awake until the baud rate is confirmed");
+
+    // Without a confirmation the previous rate comes back
+    port_system_delay_ms(USART_BAUD_RATE_CONFIRM_TIME_MS + 1);
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_INT(USART_0_BAUD_RATE, port_usart_get_baud_rate(USART_0_ID), __LINE__, "The baud rate should be restored without a confirmation");
+
+    // A confirmed rate stays
+    fsm_usart_set_baud_rate(p_fsm, 115200);
+    fsm_usart_set_out_data(p_fsm, "ok\n");
+    fsm_fire(p_fsm);
+    while (!port_usart_tx_done(USART_0_ID))
+    {
+    }
+    fsm_fire(p_fsm);
+    fsm_usart_confirm_baud_rate(p_fsm);
+    port_system_delay_ms(USART_BAUD_RATE_CONFIRM_TIME_MS + 1);
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_INT(115200, port_usart_get_baud_rate(USART_0_ID), __LINE__, "A confirmed baud rate should stay");
+
+    port_usart_set_baud_rate(USART_0_ID, USART_0_BAUD_RATE);
+}
+
+/**
+ * @brief Test the queue of frames sent while the USART is busy.
+ * 
+ */
+void test_usart_tx_queue()
+{
+    const uint8_t first[] = {0x03, 0x7E, 0x01, 0x00};
+    const uint8_t second[] = {0x02, 0x82, 0x00};
+    fsm_usart_set_binary(p_fsm, true); // Frames end at their delimiter
+    fsm_usart_set_out_frame(p_fsm, first, sizeof(first));
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_INT(SEND_DATA, fsm_get_state(p_fsm), __LINE__, "The FSM did not change to SEND_DATA");
+
+    // A frame set while another one is being sent waits for it instead of overwriting it
+    fsm_usart_set_out_frame(p_fsm, second, sizeof(second));
+    UNITY_TEST_ASSERT_EQUAL_MEMORY(first, ((fsm_usart_t *)p_fsm)->out_data, sizeof(first), __LINE__, "The frame being sent should not be overwritten");
+
+    // Fill the queue: the frames that do not fit are dropped and counted
+    uint32_t queued = USART_TX_QUEUE_LENGTH / (sizeof(second) + 1);
+    for (uint32_t i = 1; i < queued + 2; i++)
+    {
+        fsm_usart_set_out_frame(p_fsm, second, sizeof(second));
+    }
+    UNITY_TEST_ASSERT_EQUAL_INT(2, fsm_usart_get_tx_overflows(p_fsm), __LINE__, "The frames that do not fit should be counted");
+
+    // Every frame queued is sent in order
+    for (uint32_t i = 0; i < queued; i++)
+    {
+        while (!port_usart_tx_done(USART_0_ID))
+        {
+        }
+        fsm_fire(p_fsm);
+        UNITY_TEST_ASSERT_EQUAL_MEMORY(second, ((fsm_usart_t *)p_fsm)->out_data, sizeof(second), __LINE__, "The next frame of the queue should be sent");
+        fsm_fire(p_fsm);
+    }
+    while (!port_usart_tx_done(USART_0_ID))
+    {
+    }
+    fsm_fire(p_fsm);
+    UNITY_TEST_ASSERT_EQUAL_INT(WAIT_DATA, fsm_get_state(p_fsm), __LINE__, "The FSM should wait once the queue is empty");
+    UNITY_TEST_ASSERT_EQUAL_INT(EMPTY_BUFFER_CONSTANT, ((fsm_usart_t *)p_fsm)->out_data[0], __LINE__, "Nothing else should be sent");
+
+    fsm_usart_set_binary(p_fsm, false);
+}
+
 /**
  * @brief Main test function. Read the terminal for instructions or notes.
  * 
@@ -160,5 +254,7 @@ int main(void)
     RUN_TEST(test_initial_config);
     RUN_TEST(test_usart_rx);
     RUN_TEST(test_usart_tx);
+    RUN_TEST(test_usart_baud_rate);
+    RUN_TEST(test_usart_tx_queue);
     return UNITY_END();
 }
\ No newline at end of file
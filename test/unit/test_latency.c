@@ -0,0 +1,175 @@
+/**
+ * @file test_latency.c
+ * @brief Unit test for the latency tracker of the USART commands. It tests the distributions and the report.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <string.h>
+#include <stdio.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+
+/* Other libraries */
+#include "latency.h"
+
+/* Test dependencies */
+#include <unity.h>
+
+/* Global variables */
+static latency_t latency;
+
+/**
+ * @brief Set the Up object. It is called before a test function is called.
+ *
+ */
+void setUp(void)
+{
+    latency_init(&latency);
+}
+
+/**
+ * @brief Tear down the test. It is called after a test function is called.
+ *
+ */
+void tearDown(void)
+{
+}
+
+/**
+ * @brief Test that a new tracker has no measurements.
+ *
+ */
+void test_initial_config(void)
+{
+    latency_stats_t stats;
+    char line[100];
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, latency_get_num_commands(&latency), __LINE__, "A new tracker should have no commands");
+    UNITY_TEST_ASSERT(!latency_note_pending(&latency), __LINE__, "A new tracker should not wait for a note");
+    UNITY_TEST_ASSERT(!latency_get_stats(&latency, 0, LATENCY_GUARD, &stats), __LINE__, "A new tracker should have no statistics");
+    UNITY_TEST_ASSERT(!latency_format(&latency, 0, 16000000, line, sizeof(line)), __LINE__, "A new tracker should have nothing to report");
+
+    // A note without a command is not measured
+    latency_note(&latency, 100);
+    latency_executed(&latency, 100);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, latency_get_num_commands(&latency), __LINE__, "Nothing should be measured before the first command");
+}
+
+/**
+ * @brief Test the stages of a command, measured from the arrival of the end character.
+ *
+ */
+void test_stages(void)
+{
+    latency_stats_t stats;
+
+    latency_start(&latency, "play", 1000, 1080);
+    UNITY_TEST_ASSERT(latency_note_pending(&latency), __LINE__, "The command should wait for its first note");
+    latency_executed(&latency, 1500);
+    latency_note(&latency, 2000);
+    latency_note(&latency, 9000); // Only the first note after the command counts
+    UNITY_TEST_ASSERT(!latency_note_pending(&latency), __LINE__, "The command should not wait for a note after the first one");
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, latency_get_num_commands(&latency), __LINE__, "There should be one command");
+    UNITY_TEST_ASSERT(latency_get_stats(&latency, 0, LATENCY_GUARD, &stats), __LINE__, "The guard stage should be measured");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(80, stats.max, __LINE__, "Wrong latency of the guard");
+    UNITY_TEST_ASSERT(latency_get_stats(&latency, 0, LATENCY_EXECUTED, &stats), __LINE__, "The execution stage should be measured");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(500, stats.max, __LINE__, "Wrong latency of the execution");
+    UNITY_TEST_ASSERT(latency_get_stats(&latency, 0, LATENCY_NOTE, &stats), __LINE__, "The note stage should be measured");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, stats.count, __LINE__, "Only one note should be measured");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1000, stats.max, __LINE__, "Wrong latency of the note");
+
+    // A command without a note is closed by the next one
+    latency_start(&latency, "stop", 5000, 5010);
+    latency_executed(&latency, 5100);
+    latency_start(&latency, "play", 6000, 6040);
+    latency_note(&latency, 6500);
+    UNITY_TEST_ASSERT(!latency_get_stats(&latency, 1, LATENCY_NOTE, &stats), __LINE__, "The note of the next command should not count for the previous one");
+    UNITY_TEST_ASSERT(latency_get_stats(&latency, 0, LATENCY_NOTE, &stats), __LINE__, "The note should count for the last command");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, stats.count, __LINE__, "The same command should share its statistics");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(500, stats.min, __LINE__, "Wrong shortest latency of the note");
+
+    // The cycle counter wraps around
+    latency_start(&latency, "next", 0xFFFFFFF0, 0x10);
+    UNITY_TEST_ASSERT(latency_get_stats(&latency, 2, LATENCY_GUARD, &stats), __LINE__, "The guard stage should be measured");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0x20, stats.max, __LINE__, "The latency should survive the wrap around of the counter");
+}
+
+/**
+ * @brief Test the percentiles, computed over the latest samples, and the extremes, computed over every sample.
+ *
+ */
+void test_distribution(void)
+{
+    latency_stats_t stats;
+
+    // 1 to 100, then the latest LATENCY_SAMPLES
+    for (uint32_t i = 1; i <= 100; i++)
+    {
+        latency_start(&latency, "select 3", 0, i);
+    }
+    UNITY_TEST_ASSERT(latency_get_stats(&latency, 0, LATENCY_GUARD, &stats), __LINE__, "The guard stage should be measured");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(100, stats.count, __LINE__, "Wrong number of samples");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, stats.min, __LINE__, "Wrong minimum");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(100, stats.max, __LINE__, "Wrong maximum");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(50, stats.mean, __LINE__, "Wrong mean");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(100 - LATENCY_SAMPLES + 1 + LATENCY_SAMPLES / 2, stats.p50, __LINE__, "Wrong median of the latest samples");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(100 - LATENCY_SAMPLES + 1 + (LATENCY_SAMPLES * 9) / 10, stats.p90, __LINE__, "Wrong 90th percentile of the latest samples");
+}
+
+/**
+ * @brief Test that the commands that do not fit are counted together.
+ *
+ */
+void test_too_many_commands(void)
+{
+    char name[LATENCY_NAME_LENGTH];
+    char line[100];
+
+    for (uint32_t i = 0; i < LATENCY_MAX_COMMANDS + 3; i++)
+    {
+        snprintf(name, sizeof(name), "select %u", (unsigned)i);
+        latency_start(&latency, name, 0, 16);
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(LATENCY_MAX_COMMANDS, latency_get_num_commands(&latency), __LINE__, "The number of commands should be limited");
+    UNITY_TEST_ASSERT(latency_format(&latency, LATENCY_MAX_COMMANDS - 1, 16000000, line, sizeof(line)), __LINE__, "The last command should be reported");
+    UNITY_TEST_ASSERT_EQUAL_STRING("* n=4 guard 1/1/1 exec - note - us\n", line, __LINE__, "The commands that do not fit should be counted together");
+}
+
+/**
+ * @brief Test the line of the report.
+ *
+ */
+void test_format(void)
+{
+    char line[100];
+
+    latency_start(&latency, "next", 0, 160);
+    latency_executed(&latency, 16000);
+    latency_note(&latency, 1600000);
+    UNITY_TEST_ASSERT(latency_format(&latency, 0, 16000000, line, sizeof(line)), __LINE__, "The command should be reported");
+    UNITY_TEST_ASSERT_EQUAL_STRING("next n=1 guard 10/10/10 exec 1000/1000/1000 note 100000/100000/100000 us\n", line, __LINE__, "Wrong report");
+
+    // A short buffer keeps the end character
+    UNITY_TEST_ASSERT(latency_format(&latency, 0, 16000000, line, 20), __LINE__, "The command should be reported");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(19, strlen(line), __LINE__, "The line should fill the buffer");
+    UNITY_TEST_ASSERT_EQUAL_INT('\n', line[18], __LINE__, "The line should end with the end character");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+    RUN_TEST(test_initial_config);
+    RUN_TEST(test_stages);
+    RUN_TEST(test_distribution);
+    RUN_TEST(test_too_many_commands);
+    RUN_TEST(test_format);
+    return UNITY_END();
+}
@@ -0,0 +1,174 @@
+/**
+ * @file test_macro.c
+ * @brief Unit test for the macros of commands. It tests the bytecode, its decoding and the table of macros.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <string.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+
+/* Other libraries */
+#include "macro.h"
+#include "frame.h"
+
+/* Test dependencies */
+#include <unity.h>
+
+/**
+ * @brief Set the Up object. It is called before a test function is called.
+ *
+ */
+void setUp(void)
+{
+}
+
+/**
+ * @brief Tear down the test. It is called after a test function is called.
+ *
+ */
+void tearDown(void)
+{
+}
+
+/**
+ * @brief Test the bytecode of a batch and the rejection of the commands that cannot be stored.
+ *
+ */
+void test_compile(void)
+{
+    const uint8_t expected[] = {FRAME_OP_SELECT, 3, FRAME_OP_VOLUME, 30, FRAME_OP_SPEED, 150, 0, FRAME_OP_PLAY};
+    uint8_t code[MACRO_CODE_LENGTH];
+
+    size_t length = macro_compile("select 3;volume 0.3;speed 1.5;play", code, sizeof(code));
+    UNITY_TEST_ASSERT_EQUAL_UINT32(sizeof(expected), length, __LINE__, "Wrong length of the bytecode");
+    UNITY_TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, code, sizeof(expected), __LINE__, "Wrong bytecode");
+
+    // Spaces and empty commands are ignored; the volume saturates and the speed has a minimum, as the text commands
+    length = macro_compile("  volume 3 ; ;speed 0.01;", code, sizeof(code));
+    UNITY_TEST_ASSERT_EQUAL_UINT32(5, length, __LINE__, "Wrong length of the bytecode");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(100, code[1], __LINE__, "The volume should saturate at 100 %");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(10, code[3], __LINE__, "The speed should be at least 10 %");
+
+    // A melody name is stored as its index
+    length = macro_compile("select Tetris", code, sizeof(code));
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, length, __LINE__, "Wrong length of the bytecode");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(2, code[1], __LINE__, "The name should be stored as its index");
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, macro_compile("", code, sizeof(code)), __LINE__, "An empty macro should be rejected");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, macro_compile("play;baud 9600", code, sizeof(code)), __LINE__, "baud should not be stored");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, macro_compile("text", code, sizeof(code)), __LINE__, "text is not a text command");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, macro_compile("select", code, sizeof(code)), __LINE__, "select needs a parameter");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, macro_compile("select 256", code, sizeof(code)), __LINE__, "The index should fit in a byte");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, macro_compile("select zelda", code, sizeof(code)), __LINE__, "The melody should exist");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, macro_compile("volume loud", code, sizeof(code)), __LINE__, "The volume should be a number");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, macro_compile("play 2", code, sizeof(code)), __LINE__, "play takes no parameter");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, macro_compile("select 1 2", code, sizeof(code)), __LINE__, "Only one parameter");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, macro_compile("play;play;play", code, 2), __LINE__, "The bytecode should fit");
+}
+
+/**
+ * @brief Test that the instructions give the opcodes of the batch with their integer operands.
+ *
+ */
+void test_next(void)
+{
+    const uint16_t expected[][2] = {{FRAME_OP_SELECT, 3}, {FRAME_OP_VOLUME, 30}, {FRAME_OP_SPEED, 150}, {FRAME_OP_PLAY, 0}};
+    uint8_t opcode;
+    uint16_t operand;
+    uint8_t code[MACRO_CODE_LENGTH];
+    size_t length = macro_compile("select 3;volume 0.3;speed 1.5;play", code, sizeof(code));
+
+    size_t offset = 0;
+    for (uint32_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++)
+    {
+        offset = macro_next(code, length, offset, &opcode, &operand);
+        UNITY_TEST_ASSERT(offset > 0, __LINE__, "The bytecode should not end yet");
+        UNITY_TEST_ASSERT_EQUAL_UINT8(expected[i][0], opcode, __LINE__, "Wrong opcode");
+        UNITY_TEST_ASSERT_EQUAL_UINT16(expected[i][1], operand, __LINE__, "Wrong operand");
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, macro_next(code, length, offset, &opcode, &operand), __LINE__, "The bytecode should end");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, macro_next(code, 3, 2, &opcode, &operand), __LINE__, "A truncated instruction should not be read");
+}
+
+/**
+ * @brief Test that the decoded commands are the text commands of the batch.
+ *
+ */
+void test_decode(void)
+{
+    const char *expected[][2] = {{"select", "3"}, {"volume", "0.30"}, {"speed", "1.50"}, {"play", ""}};
+    char command[MACRO_COMMAND_LENGTH];
+    char param[MACRO_PARAM_LENGTH];
+    uint8_t code[MACRO_CODE_LENGTH];
+    size_t length = macro_compile("select 3;volume 0.3;speed 1.5;play", code, sizeof(code));
+
+    size_t offset = 0;
+    for (uint32_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++)
+    {
+        offset = macro_decode(code, length, offset, command, param);
+        UNITY_TEST_ASSERT(offset > 0, __LINE__, "The bytecode should not end yet");
+        UNITY_TEST_ASSERT_EQUAL_STRING(expected[i][0], command, __LINE__, "Wrong command");
+        UNITY_TEST_ASSERT_EQUAL_STRING(expected[i][1], param, __LINE__, "Wrong parameter");
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, macro_decode(code, length, offset, command, param), __LINE__, "The bytecode should end");
+
+    // An instruction cut by the end of the bytecode is not decoded
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, macro_decode(code, 1, 0, command, param), __LINE__, "A truncated instruction should not be decoded");
+}
+
+/**
+ * @brief Test the definition, replacement and deletion of macros.
+ *
+ */
+void test_table(void)
+{
+    macro_table_t table;
+    macro_table_init(&table);
+    UNITY_TEST_ASSERT_EQUAL_PTR(NULL, macro_find(&table, "party"), __LINE__, "The table should start empty");
+
+    const macro_t *p_macro = macro_define(&table, "party", "select 3;play");
+    UNITY_TEST_ASSERT(p_macro != NULL, __LINE__, "The macro should be stored");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(3, p_macro->length, __LINE__, "Wrong length of the bytecode");
+    UNITY_TEST_ASSERT_EQUAL_PTR(p_macro, macro_find(&table, "party"), __LINE__, "The macro should be found by its name");
+
+    // The same name replaces the macro; a wrong macro leaves the old one
+    UNITY_TEST_ASSERT_EQUAL_PTR(p_macro, macro_define(&table, "party", "stop"), __LINE__, "The macro should be replaced");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(1, p_macro->length, __LINE__, "The bytecode should be replaced");
+    UNITY_TEST_ASSERT_EQUAL_PTR(NULL, macro_define(&table, "party", "dance"), __LINE__, "A wrong macro should be rejected");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(FRAME_OP_STOP, p_macro->code[0], __LINE__, "A wrong macro should not replace the old one");
+
+    UNITY_TEST_ASSERT_EQUAL_PTR(NULL, macro_define(&table, "", "play"), __LINE__, "A name is needed");
+    UNITY_TEST_ASSERT_EQUAL_PTR(NULL, macro_define(&table, "verylongname", "play"), __LINE__, "The name should fit");
+
+    // The table is full with MACRO_MAX_MACROS macros until one is deleted
+    char name[MACRO_NAME_LENGTH];
+    for (uint32_t i = 1; i < MACRO_MAX_MACROS; i++)
+    {
+        name[0] = (char)('a' + i);
+        name[1] = '\0';
+        UNITY_TEST_ASSERT(macro_define(&table, name, "next") != NULL, __LINE__, "The macro should be stored");
+    }
+    UNITY_TEST_ASSERT_EQUAL_PTR(NULL, macro_define(&table, "extra", "next"), __LINE__, "The table should be full");
+    UNITY_TEST_ASSERT(macro_delete(&table, "party"), __LINE__, "The macro should be deleted");
+    UNITY_TEST_ASSERT(!macro_delete(&table, "party"), __LINE__, "The macro should not exist any more");
+    UNITY_TEST_ASSERT_EQUAL_PTR(NULL, macro_find(&table, "party"), __LINE__, "The macro should not exist any more");
+    UNITY_TEST_ASSERT(macro_define(&table, "extra", "next") != NULL, __LINE__, "The free slot should be used");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+    RUN_TEST(test_compile);
+    RUN_TEST(test_next);
+    RUN_TEST(test_decode);
+    RUN_TEST(test_table);
+    return UNITY_END();
+}
@@ -0,0 +1,143 @@
+/**
+ * @file test_melody_pack.c
+ * @brief Unit test of the compressed melodies: every built-in melody decodes to the same notes, note by note, in a
+ * container smaller than its arrays. It reports the compression ratio of each melody.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <stdio.h>
+#include <string.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+
+/* Other libraries */
+#include "melody_registry.h"
+#include "melody_pack.h"
+
+/* Test dependencies */
+#include <unity.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define TEST_CONTAINER_BYTES 16384      /*!< Buffer of the container */
+#define TEST_MIN_RATIO 4.0              /*!< Smallest compression of the built-in melodies */
+
+/* Global variables */
+static uint8_t container[TEST_CONTAINER_BYTES];    /*!< Container of the built-in melodies */
+static size_t container_size;                       /*!< Bytes of the container */
+static const melody_t *melodies_arr[MELODIES_LENGTH];  /*!< Built-in melodies, in the order of the container */
+static melody_pack_t pack;                          /*!< Decoder under test */
+
+/**
+ * @brief Set the Up object. It is called before a test function is called.
+ *
+ */
+void setUp(void)
+{
+    for (uint32_t m = 0; m < MELODIES_LENGTH; m++)
+    {
+        melodies_arr[m] = melody_registry_get(m);
+    }
+    container_size = melody_pack_encode(melodies_arr, MELODIES_LENGTH, container, sizeof(container));
+    TEST_ASSERT_TRUE(container_size > 0);
+}
+
+/**
+ * @brief Tear down the test. It is called after a test function is called.
+ *
+ */
+void tearDown(void)
+{
+}
+
+/**
+ * @brief Test that every built-in melody decodes to the same notes, and that the container is smaller than the arrays.
+ *
+ */
+void test_melody_pack_round_trip(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(MELODIES_LENGTH, melody_pack_get_num_melodies(container, container_size));
+    size_t raw = 0;
+    for (uint32_t m = 0; m < MELODIES_LENGTH; m++)
+    {
+        const melody_t *p_melody = melodies_arr[m];
+        TEST_ASSERT_TRUE(melody_pack_open(&pack, container, container_size, m));
+        TEST_ASSERT_EQUAL_STRING(p_melody->p_name, melody_pack_get_melody(&pack)->p_name);
+        TEST_ASSERT_EQUAL_UINT32(p_melody->melody_length, melody_pack_get_melody(&pack)->melody_length);
+        TEST_ASSERT_NULL(melody_pack_get_melody(&pack)->p_notes);
+        for (uint32_t i = 0; i < p_melody->melody_length; i++)
+        {
+            double frequency;
+            uint32_t duration;
+            UNITY_TEST_ASSERT(melody_pack_get_note(&pack, i, &frequency, &duration), __LINE__, "Note not decoded");
+            TEST_ASSERT_DOUBLE_WITHIN(0.0, p_melody->p_notes[i], frequency);
+            TEST_ASSERT_EQUAL_UINT32(p_melody->p_durations[i], duration);
+        }
+        raw += p_melody->melody_length * (sizeof(p_melody->p_notes[0]) + sizeof(p_melody->p_durations[0]));
+    }
+    double ratio = (double)raw / container_size;
+    printf("Built-in melodies: %u bytes as arrays, %u bytes packed, ratio %.2f\n", (unsigned)raw,
+           (unsigned)container_size, ratio);
+    UNITY_TEST_ASSERT(ratio >= TEST_MIN_RATIO, __LINE__, "The built-in melodies should pack to a quarter");
+}
+
+/**
+ * @brief Test the access out of order: going back decodes again from the first note, and past the end there is none.
+ *
+ */
+void test_melody_pack_random_access(void)
+{
+    const melody_t *p_melody = melodies_arr[4];
+    double frequency;
+    uint32_t duration;
+    TEST_ASSERT_TRUE(melody_pack_open(&pack, container, container_size, 4));
+    const uint32_t indexes[] = {100, 101, 50, p_melody->melody_length - 1, 0, 7};
+    for (uint32_t j = 0; j < sizeof(indexes) / sizeof(indexes[0]); j++)
+    {
+        TEST_ASSERT_TRUE(melody_pack_get_note(&pack, indexes[j], &frequency, &duration));
+        TEST_ASSERT_DOUBLE_WITHIN(0.0, p_melody->p_notes[indexes[j]], frequency);
+        TEST_ASSERT_EQUAL_UINT32(p_melody->p_durations[indexes[j]], duration);
+    }
+    TEST_ASSERT_FALSE(melody_pack_get_note(&pack, p_melody->melody_length, &frequency, &duration));
+    TEST_ASSERT_FALSE(melody_pack_open(&pack, container, container_size, MELODIES_LENGTH));
+}
+
+/**
+ * @brief Test the containers and melodies that cannot be packed or opened.
+ *
+ */
+void test_melody_pack_invalid(void)
+{
+    // A truncated container has the melodies before the cut only
+    TEST_ASSERT_FALSE(melody_pack_open(&pack, container, container_size - 1, MELODIES_LENGTH - 1));
+    TEST_ASSERT_TRUE(melody_pack_open(&pack, container, container_size - 1, 0));
+
+    container[0] ^= 0xFF;
+    TEST_ASSERT_EQUAL_UINT32(0, melody_pack_get_num_melodies(container, container_size));
+    TEST_ASSERT_FALSE(melody_pack_open(&pack, container, container_size, 0));
+
+    // Frequencies must be whole mHz, and the buffer must hold the container
+    double notes[] = {440.0, 440.0005};
+    uint16_t durations[] = {100, 100};
+    melody_t fractional = {.p_name = "Fractional", .p_notes = notes, .p_durations = durations, .melody_length = 2};
+    const melody_t *p_fractional = &fractional;
+    TEST_ASSERT_EQUAL_UINT32(0, melody_pack_encode(&p_fractional, 1, container, sizeof(container)));
+    TEST_ASSERT_EQUAL_UINT32(0, melody_pack_encode(melodies_arr, MELODIES_LENGTH, container, container_size - 1));
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_melody_pack_round_trip);
+    RUN_TEST(test_melody_pack_random_access);
+    RUN_TEST(test_melody_pack_invalid);
+
+    return UNITY_END();
+}
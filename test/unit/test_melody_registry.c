@@ -0,0 +1,105 @@
+/**
+ * @file test_melody_registry.c
+ * @brief Unit test for the melody registry. It tests the generated name index and the lookup by name and by the
+ * beginning of the name.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <string.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+
+/* Other libraries */
+#include "melody_registry.h"
+
+/* Test dependencies */
+#include <unity.h>
+
+/**
+ * @brief Set the Up object. It is called before a test function is called.
+ *
+ */
+void setUp(void)
+{
+}
+
+/**
+ * @brief Tear down the test. It is called after a test function is called.
+ *
+ */
+void tearDown(void)
+{
+}
+
+/**
+ * @brief Test that the generated index matches the registry: every melody is in the slot of its hash, once.
+ *
+ */
+void test_index(void)
+{
+    uint32_t used = 0;
+    for (uint32_t slot = 0; slot < MELODY_REGISTRY_SLOTS; slot++)
+    {
+        uint8_t melody_idx = melody_registry_slots[slot];
+        if (melody_idx == MELODY_REGISTRY_EMPTY)
+        {
+            continue;
+        }
+        UNITY_TEST_ASSERT(melody_idx < MELODIES_LENGTH, __LINE__, "The slot points out of the registry");
+        uint32_t hash = melody_registry_hash(melodies[melody_idx]->p_name, melody_registry_seed);
+        UNITY_TEST_ASSERT_EQUAL_UINT32(slot, hash & (MELODY_REGISTRY_SLOTS - 1), __LINE__, "The melody is not in the slot of its hash: regenerate the index");
+        used++;
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(MELODIES_LENGTH, used, __LINE__, "Every melody should have a slot");
+}
+
+/**
+ * @brief Test the lookup of whole names, ignoring case, and of indexes.
+ *
+ */
+void test_find(void)
+{
+    for (uint32_t melody_idx = 0; melody_idx < MELODIES_LENGTH; melody_idx++)
+    {
+        UNITY_TEST_ASSERT_EQUAL_PTR(melodies[melody_idx], melody_registry_get(melody_idx), __LINE__, "Wrong melody");
+        UNITY_TEST_ASSERT_EQUAL_UINT32(melody_idx, melody_registry_find(melodies[melody_idx]->p_name), __LINE__, "The melody should be found by its name");
+    }
+    UNITY_TEST_ASSERT_EQUAL_PTR(NULL, melody_registry_get(MELODIES_LENGTH), __LINE__, "There is no melody after the last one");
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, melody_registry_find("Tetris"), __LINE__, "The case should be ignored");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(3, melody_registry_find("MEGALOVANIA"), __LINE__, "The case should be ignored");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(MELODY_REGISTRY_NOT_FOUND, melody_registry_find("tetri"), __LINE__, "The beginning of a name is not the name");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(MELODY_REGISTRY_NOT_FOUND, melody_registry_find("tetriss"), __LINE__, "A longer name is not the name");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(MELODY_REGISTRY_NOT_FOUND, melody_registry_find(""), __LINE__, "An empty name is not found");
+}
+
+/**
+ * @brief Test the lookup by the beginning of the name.
+ *
+ */
+void test_find_prefix(void)
+{
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, melody_registry_find_prefix("tet"), __LINE__, "A single melody begins with tet");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, melody_registry_find_prefix("HAPPY"), __LINE__, "The case should be ignored");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, melody_registry_find_prefix("scale"), __LINE__, "A whole name should be found");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(4, melody_registry_find_prefix("sai"), __LINE__, "A single melody begins with sai");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(MELODY_REGISTRY_NOT_FOUND, melody_registry_find_prefix("s"), __LINE__, "scale and sailor begin with s");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(MELODY_REGISTRY_NOT_FOUND, melody_registry_find_prefix("zelda"), __LINE__, "There is no such melody");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(MELODY_REGISTRY_NOT_FOUND, melody_registry_find_prefix(""), __LINE__, "An empty name matches nothing");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+    RUN_TEST(test_index);
+    RUN_TEST(test_find);
+    RUN_TEST(test_find_prefix);
+    return UNITY_END();
+}
@@ -0,0 +1,211 @@
+/**
+ * @file test_telemetry.c
+ * @brief Unit test for the telemetry records. It tests the period, the delta encoding and the decoder of the host.
+ *
+ * @author Pablo Morales
+ * @author Noel Solis
+ * @date 19-10-2026
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C libraries */
+#include <string.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+
+/* Other libraries */
+#include "telemetry.h"
+#include "frame.h"
+
+/* Test dependencies */
+#include <unity.h>
+
+/**
+ * @brief Set the Up object. It is called before a test function is called.
+ *
+ */
+void setUp(void)
+{
+}
+
+/**
+ * @brief Tear down the test. It is called after a test function is called.
+ *
+ */
+void tearDown(void)
+{
+}
+
+/**
+ * @brief Fill a record with a value per field.
+ *
+ * @param p_record Pointer to the record
+ */
+static void _fill_record(telemetry_record_t *p_record)
+{
+    for (uint32_t i = 0; i < TELEMETRY_NUM_FIELDS; i++)
+    {
+        p_record->fields[i] = (uint16_t)(0x100 * i + i + 1);
+    }
+    p_record->fields[TELEMETRY_MELODY] = 3; // 8-bit fields
+    p_record->fields[TELEMETRY_VOLUME] = 50;
+}
+
+/**
+ * @brief Test the valid periods and the schedule of the records, also when they are late.
+ *
+ */
+void test_period(void)
+{
+    telemetry_t telemetry;
+    telemetry_record_t record;
+    frame_t frame;
+    _fill_record(&record);
+    telemetry_init(&telemetry);
+    UNITY_TEST_ASSERT(!telemetry_is_on(&telemetry), __LINE__, "The telemetry should start off");
+    UNITY_TEST_ASSERT(!telemetry_start(&telemetry, TELEMETRY_MIN_PERIOD_MS - 1, 0), __LINE__, "The period is too short");
+    UNITY_TEST_ASSERT(!telemetry_start(&telemetry, TELEMETRY_MAX_PERIOD_MS + 1, 0), __LINE__, "The period is too long");
+    UNITY_TEST_ASSERT(!telemetry_is_on(&telemetry), __LINE__, "A wrong period should not start the telemetry");
+
+    UNITY_TEST_ASSERT(telemetry_start(&telemetry, 100, 1000), __LINE__, "The period is valid");
+    UNITY_TEST_ASSERT(telemetry_is_due(&telemetry, 1000), __LINE__, "The first record should be sent at once");
+    telemetry_encode(&telemetry, &record, 1003, &frame);
+    UNITY_TEST_ASSERT(!telemetry_is_due(&telemetry, 1099), __LINE__, "The next record should wait for the period");
+    UNITY_TEST_ASSERT(telemetry_is_due(&telemetry, 1100), __LINE__, "The period should not drift with the delay");
+
+    // A record 350 ms late skips the ones missed instead of sending them in a burst
+    telemetry_encode(&telemetry, &record, 1450, &frame);
+    UNITY_TEST_ASSERT(!telemetry_is_due(&telemetry, 1549), __LINE__, "The records missed should be skipped");
+    UNITY_TEST_ASSERT(telemetry_is_due(&telemetry, 1550), __LINE__, "The next record should follow the late one");
+
+    telemetry_stop(&telemetry);
+    UNITY_TEST_ASSERT(!telemetry_is_due(&telemetry, 2000), __LINE__, "No record is due when the telemetry is off");
+}
+
+/**
+ * @brief Test the size of the records: every field in the first one and in the keyframes, only the changes between
+ * them.
+ *
+ */
+void test_delta(void)
+{
+    telemetry_t telemetry;
+    telemetry_record_t record;
+    frame_t frame;
+    uint8_t encoded[FRAME_MAX_ENCODED];
+    _fill_record(&record);
+    telemetry_init(&telemetry);
+    telemetry_start(&telemetry, 100, 0);
+
+    telemetry_encode(&telemetry, &record, 0, &frame);
+    UNITY_TEST_ASSERT_EQUAL_UINT8(FRAME_OP_RECORD, frame.opcode, __LINE__, "Wrong opcode");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(0, frame.seq, __LINE__, "Records should be numbered from 0");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(TELEMETRY_MAX_PAYLOAD, frame.length, __LINE__, "The first record should carry every field");
+    UNITY_TEST_ASSERT_EQUAL_HEX8(TELEMETRY_ALL_FIELDS, frame.payload[0], __LINE__, "Wrong mask");
+
+    telemetry_encode(&telemetry, &record, 100, &frame);
+    UNITY_TEST_ASSERT_EQUAL_UINT8(1, frame.seq, __LINE__, "Wrong sequence number");
+    UNITY_TEST_ASSERT_EQUAL_UINT8(1, frame.length, __LINE__, "A record without changes should be its mask");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(7, frame_encode(&frame, encoded), __LINE__, "Wrong bytes on the line");
+
+    record.fields[TELEMETRY_VOLUME] = 80;
+    record.fields[TELEMETRY_LOOPS] = 0x1234;
+    telemetry_encode(&telemetry, &record, 200, &frame);
+    const uint8_t expected[] = {(1U << TELEMETRY_VOLUME) | (1U << TELEMETRY_LOOPS), 80, 0x34, 0x12};
+    UNITY_TEST_ASSERT_EQUAL_UINT8(sizeof(expected), frame.length, __LINE__, "Only the changes should be sent");
+    UNITY_TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, frame.payload, sizeof(expected), __LINE__, "Wrong payload");
+
+    // Every TELEMETRY_KEYFRAME_INTERVAL-th record carries every field again
+    for (uint32_t i = 3; i < TELEMETRY_KEYFRAME_INTERVAL; i++)
+    {
+        telemetry_encode(&telemetry, &record, 100 * i, &frame);
+        UNITY_TEST_ASSERT_EQUAL_UINT8(1, frame.length, __LINE__, "A record without changes should be its mask");
+    }
+    telemetry_encode(&telemetry, &record, 100 * TELEMETRY_KEYFRAME_INTERVAL, &frame);
+    UNITY_TEST_ASSERT_EQUAL_UINT8(TELEMETRY_MAX_PAYLOAD, frame.length, __LINE__, "The keyframe should carry every field");
+}
+
+/**
+ * @brief Test that the decoder rebuilds the records, and that after a lost record it waits for the next keyframe.
+ *
+ */
+void test_decode(void)
+{
+    telemetry_t telemetry;
+    telemetry_decoder_t decoder;
+    telemetry_record_t record;
+    frame_t frame;
+    _fill_record(&record);
+    telemetry_init(&telemetry);
+    telemetry_decoder_init(&decoder);
+    telemetry_start(&telemetry, 100, 0);
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        record.fields[TELEMETRY_NOTE] = (uint16_t)(i * 300);
+        telemetry_encode(&telemetry, &record, 100 * i, &frame);
+        UNITY_TEST_ASSERT(telemetry_decode(&decoder, &frame), __LINE__, "The record should be decoded");
+        UNITY_TEST_ASSERT_EQUAL_HEX16_ARRAY(record.fields, decoder.record.fields, TELEMETRY_NUM_FIELDS, __LINE__, "Wrong record");
+    }
+
+    // Record 3 is lost: the fields it changed are unknown until the keyframe
+    record.fields[TELEMETRY_STATES] = 0x4321;
+    telemetry_encode(&telemetry, &record, 300, &frame);
+    uint32_t i;
+    for (i = 4; i < TELEMETRY_KEYFRAME_INTERVAL; i++)
+    {
+        telemetry_encode(&telemetry, &record, 100 * i, &frame);
+        UNITY_TEST_ASSERT(!telemetry_decode(&decoder, &frame), __LINE__, "The decoder should wait for a keyframe");
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, decoder.lost, __LINE__, "The lost record should be counted");
+    telemetry_encode(&telemetry, &record, 100 * i, &frame);
+    UNITY_TEST_ASSERT(telemetry_decode(&decoder, &frame), __LINE__, "The keyframe should resynchronise the decoder");
+    UNITY_TEST_ASSERT_EQUAL_HEX16_ARRAY(record.fields, decoder.record.fields, TELEMETRY_NUM_FIELDS, __LINE__, "Wrong record");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(TELEMETRY_KEYFRAME_INTERVAL, decoder.records, __LINE__, "Wrong number of records");
+
+    // Other frames and records shorter than their mask are not decoded
+    frame.payload[0] = TELEMETRY_ALL_FIELDS;
+    frame.length = 2;
+    UNITY_TEST_ASSERT(!telemetry_decode(&decoder, &frame), __LINE__, "A truncated record should not be decoded");
+    frame.opcode = FRAME_OP_INFO | FRAME_REPLY;
+    UNITY_TEST_ASSERT(!telemetry_decode(&decoder, &frame), __LINE__, "A reply is not a record");
+}
+
+/**
+ * @brief Test the count of iterations of the main loop per second.
+ *
+ */
+void test_loops(void)
+{
+    telemetry_t telemetry;
+    telemetry_init(&telemetry);
+    telemetry_start(&telemetry, 100, 0);
+    for (uint32_t ms = 0; ms < TELEMETRY_LOOPS_WINDOW_MS; ms++)
+    {
+        telemetry_count_loop(&telemetry, ms);
+        telemetry_count_loop(&telemetry, ms);
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT16(0, telemetry_get_loops_per_s(&telemetry), __LINE__, "The first window is not complete");
+    telemetry_count_loop(&telemetry, TELEMETRY_LOOPS_WINDOW_MS);
+    UNITY_TEST_ASSERT_EQUAL_UINT16(2001, telemetry_get_loops_per_s(&telemetry), __LINE__, "Wrong iterations per second");
+
+    // A loop that spins faster than 65535 iterations per second saturates
+    for (uint32_t i = 0; i < 70000; i++)
+    {
+        telemetry_count_loop(&telemetry, TELEMETRY_LOOPS_WINDOW_MS);
+    }
+    telemetry_count_loop(&telemetry, 2 * TELEMETRY_LOOPS_WINDOW_MS);
+    UNITY_TEST_ASSERT_EQUAL_UINT16(UINT16_MAX, telemetry_get_loops_per_s(&telemetry), __LINE__, "The count should saturate");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+    RUN_TEST(test_period);
+    RUN_TEST(test_delta);
+    RUN_TEST(test_decode);
+    RUN_TEST(test_loops);
+    return UNITY_END();
+}